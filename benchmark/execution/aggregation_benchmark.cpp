@@ -0,0 +1,210 @@
+#include <cstddef>
+#include <random>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "common/scoped_timer.h"
+#include "execution/sql/aggregation_hash_table.h"
+#include "execution/sql/aggregators.h"
+#include "execution/sql/direct_mapped_aggregation_table.h"
+#include "execution/sql/projected_columns_iterator.h"
+#include "execution/util/hash.h"
+#include "storage/projected_columns.h"
+#include "storage/storage_defs.h"
+
+namespace terrier {
+
+/**
+ * A TPC-H Q1-style hash aggregation: a few sums, averages and a count per group over a stream of input vectors. The
+ * aggregation is run tuple-at-a-time through ProcessBatch() and its hash, key-equality, init and advance functions,
+ * and vector-at-a-time through LookupOrCreateGroups() and the typed AdvanceBatch() kernels. The vectorized
+ * aggregation is also run in a DirectMappedAggregationTable, since the keys are in the small domain [0, groups). The
+ * argument is the number of groups: Q1 has four, the larger one doesn't fit in cache.
+ */
+class AggregationBenchmark : public benchmark::Fixture {
+ public:
+  /**
+   * The payload of a group
+   */
+  struct Group {
+    int64_t key_;
+    execution::sql::IntegerSumAggregate sum_qty_;
+    execution::sql::IntegerSumAggregate sum_price_;
+    execution::sql::AvgAggregate avg_qty_;
+    execution::sql::AvgAggregate avg_price_;
+    execution::sql::CountStarAggregate count_;
+  };
+
+  // The columns of the input
+  static constexpr uint32_t KEY_COL = 0;
+  static constexpr uint32_t QTY_COL = 1;
+  static constexpr uint32_t PRICE_COL = 2;
+
+  void SetUp(const benchmark::State &state) final {
+    const auto num_groups = static_cast<int64_t>(state.range(0));
+    const storage::BlockLayout layout({8, 8, 8, 8});
+    const std::vector<storage::col_id_t> col_ids{storage::col_id_t(1), storage::col_id_t(2), storage::col_id_t(3)};
+    storage::ProjectedColumnsInitializer pc_initializer(layout, col_ids, common::Constants::K_DEFAULT_VECTOR_SIZE);
+
+    std::mt19937 generator;
+    std::uniform_int_distribution<int64_t> key_distribution(0, num_groups - 1);
+    std::uniform_int_distribution<int64_t> val_distribution(1, 10000);
+    for (uint32_t vec = 0; vec < num_tuples_ / common::Constants::K_DEFAULT_VECTOR_SIZE; vec++) {
+      buffers_.push_back(common::AllocationUtil::AllocateAligned(pc_initializer.ProjectedColumnsSize()));
+      auto *pc = pc_initializer.Initialize(buffers_.back());
+      pc->SetNumTuples(common::Constants::K_DEFAULT_VECTOR_SIZE);
+      for (uint32_t col = KEY_COL; col <= PRICE_COL; col++) {
+        auto *vals = reinterpret_cast<int64_t *>(pc->ColumnStart(static_cast<uint16_t>(col)));
+        for (uint32_t idx = 0; idx < common::Constants::K_DEFAULT_VECTOR_SIZE; idx++) {
+          vals[idx] = (col == KEY_COL ? key_distribution(generator) : val_distribution(generator));
+        }
+      }
+      vectors_.push_back(pc);
+    }
+  }
+
+  void TearDown(const benchmark::State &state) final {
+    for (auto *buffer : buffers_) {
+      delete[] buffer;
+    }
+    buffers_.clear();
+    vectors_.clear();
+  }
+
+  static hash_t HashFn(void *input) {
+    auto *iters = reinterpret_cast<execution::sql::ProjectedColumnsIterator **>(input);
+    return execution::util::Hasher::Hash(*iters[0]->Get<int64_t, false>(KEY_COL, nullptr));
+  }
+
+  static bool KeyEqFn(const void *group, const void *input) {
+    auto *iters = reinterpret_cast<const execution::sql::ProjectedColumnsIterator *const *>(input);
+    return reinterpret_cast<const Group *>(group)->key_ == *iters[0]->Get<int64_t, false>(KEY_COL, nullptr);
+  }
+
+  static void InitGroupFn(void *group) {
+    auto *g = reinterpret_cast<Group *>(group);
+    new (&g->sum_qty_) execution::sql::IntegerSumAggregate();
+    new (&g->sum_price_) execution::sql::IntegerSumAggregate();
+    new (&g->avg_qty_) execution::sql::AvgAggregate();
+    new (&g->avg_price_) execution::sql::AvgAggregate();
+    new (&g->count_) execution::sql::CountStarAggregate();
+  }
+
+  static void AdvanceAggFn(void *group, void *input) {
+    auto *g = reinterpret_cast<Group *>(group);
+    auto *iters = reinterpret_cast<execution::sql::ProjectedColumnsIterator **>(input);
+    const execution::sql::Integer qty(*iters[0]->Get<int64_t, false>(QTY_COL, nullptr));
+    const execution::sql::Integer price(*iters[0]->Get<int64_t, false>(PRICE_COL, nullptr));
+    g->sum_qty_.Advance(qty);
+    g->sum_price_.Advance(price);
+    g->avg_qty_.Advance(qty);
+    g->avg_price_.Advance(price);
+    g->count_.Advance(qty);
+  }
+
+  static void InitAggFn(void *group, void *input) {
+    auto *iters = reinterpret_cast<execution::sql::ProjectedColumnsIterator **>(input);
+    reinterpret_cast<Group *>(group)->key_ = *iters[0]->Get<int64_t, false>(KEY_COL, nullptr);
+    InitGroupFn(group);
+    AdvanceAggFn(group, input);
+  }
+
+  /**
+   * Advance the aggregates of the groups of all selected tuples in the input vector
+   */
+  static void AdvanceBatch(const execution::sql::ProjectedColumnsIterator &pci, byte *groups[]) {
+    const uint32_t num_tuples = pci.NumSelected();
+    const uint32_t *sel = pci.GetSelectionVector();
+    const auto *qty = pci.GetColumnData<int64_t>(QTY_COL);
+    const auto *price = pci.GetColumnData<int64_t>(PRICE_COL);
+    execution::sql::IntegerSumAggregate::AdvanceBatch(num_tuples, groups, offsetof(Group, sum_qty_), qty, sel, nullptr);
+    execution::sql::IntegerSumAggregate::AdvanceBatch(num_tuples, groups, offsetof(Group, sum_price_), price, sel,
+                                                      nullptr);
+    execution::sql::AvgAggregate::AdvanceBatch(num_tuples, groups, offsetof(Group, avg_qty_), qty, sel, nullptr);
+    execution::sql::AvgAggregate::AdvanceBatch(num_tuples, groups, offsetof(Group, avg_price_), price, sel, nullptr);
+    execution::sql::CountStarAggregate::AdvanceBatch(num_tuples, groups, offsetof(Group, count_));
+  }
+
+  /**
+   * Aggregate all input vectors, either tuple-at-a-time or vector-at-a-time
+   */
+  void Aggregate(benchmark::State *state, const bool vectorized) {
+    // NOLINTNEXTLINE
+    for (auto _ : *state) {
+      execution::sql::MemoryPool memory(nullptr);
+      execution::sql::AggregationHashTable agg_table(&memory, sizeof(Group));
+      alignas(common::Constants::CACHELINE_SIZE) byte *groups[common::Constants::K_DEFAULT_VECTOR_SIZE];
+
+      uint64_t elapsed_ms;
+      {
+        common::ScopedTimer<std::chrono::milliseconds> timer(&elapsed_ms);
+        for (auto *pc : vectors_) {
+          execution::sql::ProjectedColumnsIterator pci(pc);
+          if (!vectorized) {
+            execution::sql::ProjectedColumnsIterator *iters[] = {&pci};
+            agg_table.ProcessBatch(iters, HashFn, KeyEqFn, InitAggFn, AdvanceAggFn);
+            continue;
+          }
+          agg_table.LookupOrCreateGroups<int64_t>(&pci, KEY_COL, offsetof(Group, key_), InitGroupFn, groups);
+          AdvanceBatch(pci, groups);
+        }
+      }
+      state->SetIterationTime(static_cast<double>(elapsed_ms) / 1000.0);
+    }
+    state->SetItemsProcessed(state->iterations() * num_tuples_);
+  }
+
+  /**
+   * Aggregate all input vectors vector-at-a-time in a direct-mapped table
+   */
+  void AggregateDirectMapped(benchmark::State *state) {
+    // NOLINTNEXTLINE
+    for (auto _ : *state) {
+      execution::sql::MemoryPool memory(nullptr);
+      execution::sql::DirectMappedAggregationTable agg_table(&memory, sizeof(Group), 0, state->range(0) - 1);
+      alignas(common::Constants::CACHELINE_SIZE) byte *groups[common::Constants::K_DEFAULT_VECTOR_SIZE];
+
+      uint64_t elapsed_ms;
+      {
+        common::ScopedTimer<std::chrono::milliseconds> timer(&elapsed_ms);
+        for (auto *pc : vectors_) {
+          execution::sql::ProjectedColumnsIterator pci(pc);
+          agg_table.LookupOrCreateGroups<int64_t>(&pci, KEY_COL, offsetof(Group, key_), InitGroupFn, groups);
+          AdvanceBatch(pci, groups);
+        }
+      }
+      state->SetIterationTime(static_cast<double>(elapsed_ms) / 1000.0);
+    }
+    state->SetItemsProcessed(state->iterations() * num_tuples_);
+  }
+
+  const uint32_t num_tuples_ = 1u << 23;
+  std::vector<byte *> buffers_;
+  std::vector<storage::ProjectedColumns *> vectors_;
+};
+
+// NOLINTNEXTLINE
+BENCHMARK_DEFINE_F(AggregationBenchmark, TupleAtATime)(benchmark::State &state) { Aggregate(&state, false); }
+
+// NOLINTNEXTLINE
+BENCHMARK_DEFINE_F(AggregationBenchmark, Vectorized)(benchmark::State &state) { Aggregate(&state, true); }
+
+// NOLINTNEXTLINE
+BENCHMARK_DEFINE_F(AggregationBenchmark, DirectMapped)(benchmark::State &state) { AggregateDirectMapped(&state); }
+
+BENCHMARK_REGISTER_F(AggregationBenchmark, TupleAtATime)
+    ->Unit(benchmark::kMillisecond)
+    ->UseManualTime()
+    ->Arg(4)
+    ->Arg(1 << 20);
+BENCHMARK_REGISTER_F(AggregationBenchmark, Vectorized)
+    ->Unit(benchmark::kMillisecond)
+    ->UseManualTime()
+    ->Arg(4)
+    ->Arg(1 << 20);
+BENCHMARK_REGISTER_F(AggregationBenchmark, DirectMapped)
+    ->Unit(benchmark::kMillisecond)
+    ->UseManualTime()
+    ->Arg(4)
+    ->Arg(1 << 16);
+}  // namespace terrier
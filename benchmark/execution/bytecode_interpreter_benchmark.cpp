@@ -0,0 +1,182 @@
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "catalog/catalog.h"
+#include "catalog/catalog_accessor.h"
+#include "common/scoped_timer.h"
+#include "execution/exec/execution_context.h"
+#include "execution/table_generator/sample_output.h"
+#include "execution/table_generator/table_generator.h"
+#include "execution/vm/bytecode_generator.h"
+#include "execution/vm/module.h"
+#include "execution/vm/module_compiler.h"
+#include "storage/garbage_collector.h"
+#include "transaction/deferred_action_manager.h"
+#include "transaction/transaction_manager.h"
+#include "transaction/transaction_util.h"
+
+namespace terrier {
+
+/**
+ * Interpreted TPL programs: the sample programs listed in sample_tpl/tpl_tests.txt, from tight loops, branches and
+ * calls to scans, aggregations, joins and sorts over the test tables. Each program is compiled with and without the
+ * BytecodeOptimizer, selected by the benchmark's argument, and run in the interpreter only. Programs that don't return
+ * the result the list expects fail the benchmark.
+ */
+class BytecodeInterpreterBenchmark : public benchmark::Fixture {
+ public:
+  void SetUp(const benchmark::State &state) final {
+    // The SQL programs run in a transaction over the test tables
+    timestamp_manager_ = std::make_unique<transaction::TimestampManager>();
+    deferred_action_manager_ = std::make_unique<transaction::DeferredActionManager>(timestamp_manager_.get());
+    txn_manager_ = std::make_unique<transaction::TransactionManager>(
+        timestamp_manager_.get(), deferred_action_manager_.get(), &buffer_pool_, true, DISABLED);
+    gc_ = std::make_unique<storage::GarbageCollector>(timestamp_manager_.get(), deferred_action_manager_.get(),
+                                                      txn_manager_.get(), nullptr);
+    catalog_ = std::make_unique<catalog::Catalog>(txn_manager_.get(), &block_store_);
+    txn_ = txn_manager_->BeginTransaction();
+    const auto db_oid = catalog_->CreateDatabase(txn_, "test_db", true);
+    auto accessor = catalog_->GetAccessor(txn_, db_oid);
+    const auto ns_oid = accessor->GetDefaultNamespace();
+    sample_output_.InitTestOutput();
+    exec_ctx_ = std::make_unique<execution::exec::ExecutionContext>(
+        db_oid, txn_, [](byte *, uint32_t, uint32_t) {}, sample_output_.GetSchema("schema10"), std::move(accessor));
+    execution::sql::TableGenerator table_generator{exec_ctx_.get(), &block_store_, ns_oid};
+    table_generator.GenerateTestTables();
+
+    const bool optimize = state.range(0) != 0;
+    std::ifstream tests(std::string(SAMPLE_TPL_DIR) + "/tpl_tests.txt");
+    std::string line;
+    while (std::getline(tests, line)) {
+      // Each line is: file name, whether the program needs an execution context, expected result
+      if (line.empty() || line[0] == '#') continue;
+      std::stringstream fields(line);
+      std::string file, is_sql, expected;
+      std::getline(fields, file, ',');
+      std::getline(fields, is_sql, ',');
+      std::getline(fields, expected, ',');
+
+      std::ifstream input(std::string(SAMPLE_TPL_DIR) + "/" + file);
+      std::stringstream src;
+      src << input.rdbuf();
+
+      // The modules refer to the types of their AST, so the compiler must outlive them
+      compilers_.push_back(std::make_unique<execution::vm::test::ModuleCompiler>());
+      auto *ast = compilers_.back()->CompileToAst(src.str());
+      if (compilers_.back()->HasErrors()) {
+        error_ = "cannot compile " + file;
+        return;
+      }
+      auto bytecode_module = execution::vm::BytecodeGenerator::Compile(ast, exec_ctx_.get(), file, optimize);
+      code_size_ += bytecode_module->InstructionCount();
+      programs_.push_back(
+          {file, is_sql == "true", std::stoll(expected),
+           std::make_unique<execution::vm::Module>(std::move(bytecode_module))});
+    }
+    if (programs_.empty()) error_ = "no programs in " + std::string(SAMPLE_TPL_DIR) + "/tpl_tests.txt";
+  }
+
+  void TearDown(const benchmark::State &state) final {
+    programs_.clear();
+    compilers_.clear();
+    code_size_ = 0;
+    error_.clear();
+    exec_ctx_.reset();
+    txn_manager_->Commit(txn_, transaction::TransactionUtil::EmptyCallback, nullptr);
+    catalog_->TearDown();
+    gc_->PerformGarbageCollection();
+    gc_->PerformGarbageCollection();
+    catalog_.reset();
+    gc_.reset();
+    txn_manager_.reset();
+    deferred_action_manager_.reset();
+    timestamp_manager_.reset();
+  }
+
+  /**
+   * Run the main function of every program
+   */
+  void Run(benchmark::State *state) {
+    if (!error_.empty()) {
+      state->SkipWithError(error_.c_str());
+      return;
+    }
+
+    std::vector<std::function<int64_t()>> mains(programs_.size());
+    for (uint32_t i = 0; i < programs_.size(); i++) {
+      auto &program = programs_[i];
+      if (program.is_sql_) {
+        std::function<int64_t(execution::exec::ExecutionContext *)> main;
+        program.module_->GetFunction("main", execution::vm::ExecutionMode::Interpret, &main);
+        mains[i] = [main, exec_ctx = exec_ctx_.get()]() { return main(exec_ctx); };
+      } else {
+        program.module_->GetFunction("main", execution::vm::ExecutionMode::Interpret, &mains[i]);
+      }
+      // Running every program once also checks the optimized bytecode
+      if (mains[i] == nullptr || mains[i]() != program.expected_) {
+        error_ = program.file_ + " doesn't return " + std::to_string(program.expected_);
+        state->SkipWithError(error_.c_str());
+        return;
+      }
+    }
+
+    int64_t result = 0;
+    // NOLINTNEXTLINE
+    for (auto _ : *state) {
+      uint64_t elapsed_ms;
+      {
+        common::ScopedTimer<std::chrono::milliseconds> timer(&elapsed_ms);
+        for (const auto &main : mains) {
+          result += main();
+        }
+      }
+      state->SetIterationTime(static_cast<double>(elapsed_ms) / 1000.0);
+    }
+    benchmark::DoNotOptimize(result);
+    state->counters["programs"] = static_cast<double>(programs_.size());
+    state->counters["code_bytes"] = static_cast<double>(code_size_);
+  }
+
+ private:
+  // A sample program, whether it takes an execution context and what it returns
+  struct Program {
+    std::string file_;
+    bool is_sql_;
+    int64_t expected_;
+    std::unique_ptr<execution::vm::Module> module_;
+  };
+
+  storage::RecordBufferSegmentPool buffer_pool_{100000, 100000};
+  storage::BlockStore block_store_{1000, 1000};
+  std::unique_ptr<transaction::TimestampManager> timestamp_manager_;
+  std::unique_ptr<transaction::DeferredActionManager> deferred_action_manager_;
+  std::unique_ptr<transaction::TransactionManager> txn_manager_;
+  std::unique_ptr<storage::GarbageCollector> gc_;
+  std::unique_ptr<catalog::Catalog> catalog_;
+  transaction::TransactionContext *txn_;
+  execution::exec::SampleOutput sample_output_;
+  std::unique_ptr<execution::exec::ExecutionContext> exec_ctx_;
+
+  std::vector<std::unique_ptr<execution::vm::test::ModuleCompiler>> compilers_;
+  std::vector<Program> programs_;
+  uint64_t code_size_ = 0;
+  std::string error_;
+};
+
+// NOLINTNEXTLINE
+BENCHMARK_DEFINE_F(BytecodeInterpreterBenchmark, Interpret)(benchmark::State &state) { Run(&state); }
+
+BENCHMARK_REGISTER_F(BytecodeInterpreterBenchmark, Interpret)
+    ->ArgName("optimize")
+    ->Arg(0)
+    ->Arg(1)
+    ->Unit(benchmark::kMillisecond)
+    ->UseManualTime();
+
+}  // namespace terrier
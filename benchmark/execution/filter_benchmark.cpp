@@ -0,0 +1,233 @@
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "common/scoped_timer.h"
+#include "execution/sql/projected_columns_iterator.h"
+#include "storage/projected_columns.h"
+#include "storage/storage_defs.h"
+
+namespace terrier {
+
+/**
+ * Selections on single columns of every filterable type, run by the vectorized kernels of the
+ * ProjectedColumnsIterator and, for comparison, by the combinations of simpler filters or the tuple-at-a-time
+ * loops they replace. Every column is a stream of vectors with the uniform values [0, 1000), or strings made of
+ * such a value behind a shared prefix. A tenth of the values of the nullable column are NULL.
+ */
+class FilterBenchmark : public benchmark::Fixture {
+ public:
+  void SetUp(const benchmark::State &state) final {
+    std::mt19937 generator;
+    std::uniform_int_distribution<int32_t> distribution(0, 999);
+
+    ints_ = MakeVectors(sizeof(int32_t), [&](byte *col, uint32_t idx) {
+      reinterpret_cast<int32_t *>(col)[idx] = distribution(generator);
+    });
+    reals_ = MakeVectors(sizeof(double), [&](byte *col, uint32_t idx) {
+      reinterpret_cast<double *>(col)[idx] = distribution(generator) / 10.0;
+    });
+    dates_ = MakeVectors(sizeof(uint32_t), [&](byte *col, uint32_t idx) {
+      reinterpret_cast<uint32_t *>(col)[idx] = static_cast<uint32_t>(distribution(generator));
+    });
+
+    // Half the strings are inlined, the other half share a long prefix
+    for (int32_t val = 0; val < 1000; val++) {
+      strings_.push_back((val % 2 == 0 ? "s" : "sharedprefix") + std::to_string(val));
+    }
+    varlens_ = MakeVectors(sizeof(storage::VarlenEntry), [&](byte *col, uint32_t idx) {
+      const std::string &str = strings_[distribution(generator)];
+      auto *content = reinterpret_cast<const byte *>(str.data());
+      const auto size = static_cast<uint32_t>(str.size());
+      reinterpret_cast<storage::VarlenEntry *>(col)[idx] =
+          size <= storage::VarlenEntry::InlineThreshold()
+              ? storage::VarlenEntry::CreateInline(content, size)
+              : storage::VarlenEntry::Create(const_cast<byte *>(content), size, false);
+    });
+
+    nullable_ints_ = MakeVectors(sizeof(int32_t), [&](byte *col, uint32_t idx) {
+      reinterpret_cast<int32_t *>(col)[idx] = distribution(generator);
+    });
+    for (auto *pc : nullable_ints_) {
+      for (uint32_t idx = 0; idx < common::Constants::K_DEFAULT_VECTOR_SIZE; idx++) {
+        pc->ColumnNullBitmap(0)->Set(idx, distribution(generator) >= 100);
+      }
+    }
+  }
+
+  void TearDown(const benchmark::State &state) final {
+    for (auto *buffer : buffers_) {
+      delete[] buffer;
+    }
+    buffers_.clear();
+    ints_.clear();
+    reals_.clear();
+    dates_.clear();
+    varlens_.clear();
+    nullable_ints_.clear();
+    strings_.clear();
+  }
+
+  /**
+   * Create the vectors of a column with values of the given size, set by the given function. No value is NULL.
+   */
+  template <typename F>
+  std::vector<storage::ProjectedColumns *> MakeVectors(const uint8_t attr_size, const F &set_value) {
+    const storage::BlockLayout layout({8, attr_size});
+    const std::vector<storage::col_id_t> col_ids{storage::col_id_t(1)};
+    storage::ProjectedColumnsInitializer pc_initializer(layout, col_ids, common::Constants::K_DEFAULT_VECTOR_SIZE);
+
+    std::vector<storage::ProjectedColumns *> vectors;
+    for (uint32_t vec = 0; vec < num_tuples_ / common::Constants::K_DEFAULT_VECTOR_SIZE; vec++) {
+      buffers_.push_back(common::AllocationUtil::AllocateAligned(pc_initializer.ProjectedColumnsSize()));
+      auto *pc = pc_initializer.Initialize(buffers_.back());
+      pc->SetNumTuples(common::Constants::K_DEFAULT_VECTOR_SIZE);
+      auto *null_bitmap = reinterpret_cast<byte *>(pc->ColumnNullBitmap(0));
+      std::memset(null_bitmap, 0xFF, common::Constants::K_DEFAULT_VECTOR_SIZE / common::Constants::K_BITS_PER_BYTE);
+      for (uint32_t idx = 0; idx < common::Constants::K_DEFAULT_VECTOR_SIZE; idx++) {
+        set_value(pc->ColumnStart(0), idx);
+      }
+      vectors.push_back(pc);
+    }
+    return vectors;
+  }
+
+  /**
+   * Run the given filter on every vector of the given column
+   */
+  template <typename F>
+  void Filter(benchmark::State *state, const std::vector<storage::ProjectedColumns *> &vectors, const F &filter) {
+    uint64_t num_selected = 0;
+    // NOLINTNEXTLINE
+    for (auto _ : *state) {
+      uint64_t elapsed_ms;
+      {
+        common::ScopedTimer<std::chrono::milliseconds> timer(&elapsed_ms);
+        for (auto *pc : vectors) {
+          execution::sql::ProjectedColumnsIterator pci(pc);
+          num_selected += filter(&pci);
+        }
+      }
+      state->SetIterationTime(static_cast<double>(elapsed_ms) / 1000.0);
+    }
+    benchmark::DoNotOptimize(num_selected);
+    state->SetItemsProcessed(state->iterations() * num_tuples_);
+  }
+
+  static execution::sql::ProjectedColumnsIterator::FilterVal IntVal(const int32_t val) {
+    return execution::sql::ProjectedColumnsIterator::FilterVal{.i_ = val};
+  }
+
+  static constexpr int64_t IN_LIST[] = {3, 141, 592, 653, 589, 793, 238, 462};
+
+  const uint32_t num_tuples_ = 1u << 22;
+  std::vector<byte *> buffers_;
+  std::vector<storage::ProjectedColumns *> ints_;
+  std::vector<storage::ProjectedColumns *> reals_;
+  std::vector<storage::ProjectedColumns *> dates_;
+  std::vector<storage::ProjectedColumns *> varlens_;
+  std::vector<storage::ProjectedColumns *> nullable_ints_;
+  std::vector<std::string> strings_;
+};
+
+// NOLINTNEXTLINE
+BENCHMARK_DEFINE_F(FilterBenchmark, IntegerBetween)(benchmark::State &state) {
+  Filter(&state, ints_, [](execution::sql::ProjectedColumnsIterator *pci) {
+    return pci->FilterColBetween(0, type::TypeId::INTEGER, IntVal(250), IntVal(749));
+  });
+}
+
+// NOLINTNEXTLINE
+BENCHMARK_DEFINE_F(FilterBenchmark, IntegerTwoComparisons)(benchmark::State &state) {
+  Filter(&state, ints_, [](execution::sql::ProjectedColumnsIterator *pci) {
+    pci->FilterColByVal<std::greater_equal>(0, type::TypeId::INTEGER, IntVal(250));
+    return pci->FilterColByVal<std::less_equal>(0, type::TypeId::INTEGER, IntVal(749));
+  });
+}
+
+// NOLINTNEXTLINE
+BENCHMARK_DEFINE_F(FilterBenchmark, IntegerIn)(benchmark::State &state) {
+  Filter(&state, ints_, [](execution::sql::ProjectedColumnsIterator *pci) {
+    return pci->FilterColIn(0, type::TypeId::INTEGER, IN_LIST, sizeof(IN_LIST) / sizeof(IN_LIST[0]));
+  });
+}
+
+// NOLINTNEXTLINE
+BENCHMARK_DEFINE_F(FilterBenchmark, IntegerInTupleAtATime)(benchmark::State &state) {
+  Filter(&state, ints_, [](execution::sql::ProjectedColumnsIterator *pci) {
+    pci->RunFilter([pci]() {
+      const int64_t val = *pci->Get<int32_t, false>(0, nullptr);
+      return std::find(std::begin(IN_LIST), std::end(IN_LIST), val) != std::end(IN_LIST);
+    });
+    return pci->NumSelected();
+  });
+}
+
+// NOLINTNEXTLINE
+BENCHMARK_DEFINE_F(FilterBenchmark, DecimalLt)(benchmark::State &state) {
+  Filter(&state, reals_, [](execution::sql::ProjectedColumnsIterator *pci) {
+    return pci->FilterColByVal<std::less>(0, type::TypeId::DECIMAL,
+                                          execution::sql::ProjectedColumnsIterator::FilterVal{.real_ = 50.0});
+  });
+}
+
+// NOLINTNEXTLINE
+BENCHMARK_DEFINE_F(FilterBenchmark, DateBetween)(benchmark::State &state) {
+  Filter(&state, dates_, [](execution::sql::ProjectedColumnsIterator *pci) {
+    return pci->FilterColBetween(0, type::TypeId::DATE,
+                                 execution::sql::ProjectedColumnsIterator::FilterVal{.date_ = 250},
+                                 execution::sql::ProjectedColumnsIterator::FilterVal{.date_ = 749});
+  });
+}
+
+// NOLINTNEXTLINE
+BENCHMARK_DEFINE_F(FilterBenchmark, StringEq)(benchmark::State &state) {
+  const std::string &val = strings_[501];
+  Filter(&state, varlens_, [&](execution::sql::ProjectedColumnsIterator *pci) {
+    return pci->FilterColStringEq(0, reinterpret_cast<const byte *>(val.data()), static_cast<uint32_t>(val.size()));
+  });
+}
+
+// NOLINTNEXTLINE
+BENCHMARK_DEFINE_F(FilterBenchmark, StringEqTupleAtATime)(benchmark::State &state) {
+  const std::string &val = strings_[501];
+  Filter(&state, varlens_, [&](execution::sql::ProjectedColumnsIterator *pci) {
+    pci->RunFilter([&]() {
+      const auto *entry = pci->Get<storage::VarlenEntry, false>(0, nullptr);
+      return entry->Size() == val.size() && std::memcmp(entry->Content(), val.data(), val.size()) == 0;
+    });
+    return pci->NumSelected();
+  });
+}
+
+// NOLINTNEXTLINE
+BENCHMARK_DEFINE_F(FilterBenchmark, StringPrefix)(benchmark::State &state) {
+  const std::string prefix = "sharedprefix1";
+  Filter(&state, varlens_, [&](execution::sql::ProjectedColumnsIterator *pci) {
+    return pci->FilterColStringPrefix(0, reinterpret_cast<const byte *>(prefix.data()),
+                                      static_cast<uint32_t>(prefix.size()));
+  });
+}
+
+// NOLINTNEXTLINE
+BENCHMARK_DEFINE_F(FilterBenchmark, NullableIntegerLt)(benchmark::State &state) {
+  Filter(&state, nullable_ints_, [](execution::sql::ProjectedColumnsIterator *pci) {
+    return pci->FilterColByVal<std::less>(0, type::TypeId::INTEGER, IntVal(500));
+  });
+}
+
+BENCHMARK_REGISTER_F(FilterBenchmark, IntegerBetween)->Unit(benchmark::kMillisecond)->UseManualTime();
+BENCHMARK_REGISTER_F(FilterBenchmark, IntegerTwoComparisons)->Unit(benchmark::kMillisecond)->UseManualTime();
+BENCHMARK_REGISTER_F(FilterBenchmark, IntegerIn)->Unit(benchmark::kMillisecond)->UseManualTime();
+BENCHMARK_REGISTER_F(FilterBenchmark, IntegerInTupleAtATime)->Unit(benchmark::kMillisecond)->UseManualTime();
+BENCHMARK_REGISTER_F(FilterBenchmark, DecimalLt)->Unit(benchmark::kMillisecond)->UseManualTime();
+BENCHMARK_REGISTER_F(FilterBenchmark, DateBetween)->Unit(benchmark::kMillisecond)->UseManualTime();
+BENCHMARK_REGISTER_F(FilterBenchmark, StringEq)->Unit(benchmark::kMillisecond)->UseManualTime();
+BENCHMARK_REGISTER_F(FilterBenchmark, StringEqTupleAtATime)->Unit(benchmark::kMillisecond)->UseManualTime();
+BENCHMARK_REGISTER_F(FilterBenchmark, StringPrefix)->Unit(benchmark::kMillisecond)->UseManualTime();
+BENCHMARK_REGISTER_F(FilterBenchmark, NullableIntegerLt)->Unit(benchmark::kMillisecond)->UseManualTime();
+}  // namespace terrier
@@ -0,0 +1,278 @@
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <dirent.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "benchmark/benchmark.h"
+#include "common/scoped_timer.h"
+#include "execution/exec/query_scheduler.h"
+#include "execution/sql/join_hash_table.h"
+#include "execution/sql/thread_state_container.h"
+#include "execution/util/hash.h"
+
+namespace terrier {
+
+/**
+ * Counts the last-level cache load misses of all threads of the process that exist when it's created, through perf
+ * events. Counts nothing if perf events aren't available, e.g. outside Linux or when perf_event_paranoid forbids them.
+ */
+class LlcMissCounter {
+ public:
+  LlcMissCounter() {
+#ifdef __linux__
+    perf_event_attr attr{};
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HW_CACHE;
+    attr.config =
+        PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8u) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16u);
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    // One counter per thread, as the scheduler's workers were started before the counter
+    DIR *const tasks = opendir("/proc/self/task");
+    if (tasks == nullptr) return;
+    while (const dirent *const task = readdir(tasks)) {
+      const auto tid = static_cast<pid_t>(std::strtol(task->d_name, nullptr, 10));
+      if (tid <= 0) continue;
+      const auto fd = static_cast<int>(syscall(__NR_perf_event_open, &attr, tid, -1, -1, 0));
+      if (fd >= 0) fds_.push_back(fd);
+    }
+    closedir(tasks);
+#endif
+  }
+
+  ~LlcMissCounter() {
+#ifdef __linux__
+    for (const auto fd : fds_) close(fd);
+#endif
+  }
+
+  DISALLOW_COPY_AND_MOVE(LlcMissCounter);
+
+  /**
+   * @return True if misses are counted
+   */
+  bool IsAvailable() const { return !fds_.empty(); }
+
+  /**
+   * Reset the counts and start counting
+   */
+  void Start() {
+#ifdef __linux__
+    for (const auto fd : fds_) {
+      ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+      ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+  }
+
+  /**
+   * Stop counting
+   * @return The misses of all threads since the last call to Start()
+   */
+  uint64_t Stop() {
+    uint64_t misses = 0;
+#ifdef __linux__
+    for (const auto fd : fds_) {
+      ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+      uint64_t count;
+      if (read(fd, &count, sizeof(count)) == sizeof(count)) misses += count;
+    }
+#endif
+    return misses;
+  }
+
+ private:
+  std::vector<int> fds_;
+};
+
+/**
+ * Parallel join hash table builds, with and without radix partitioning, for build sides of 1M to 100M rows. The
+ * partitioned build should incur far fewer cache misses once the build side is larger than the last-level cache; the
+ * last-level cache misses of the timed phase are reported per iteration as llc_misses.
+ *
+ * All phases run on the query scheduler's workers, as a query limited to num_threads_ threads. The parallel loops
+ * inside MergeParallel inherit that limit from the query they're called from.
+ */
+class JoinHashTableBenchmark : public benchmark::Fixture {
+ public:
+  /**
+   * The build tuple
+   */
+  struct Tuple {
+    uint64_t key_, col_a_, col_b_, col_c_;
+  };
+
+  static hash_t HashOf(const uint64_t key) {
+    return execution::util::Hasher::Hash(reinterpret_cast<const uint8_t *>(&key), sizeof(key));
+  }
+
+  static bool KeyEq(UNUSED_ATTRIBUTE void *ctx, void *probe_tuple, void *table_tuple) {
+    return reinterpret_cast<const Tuple *>(probe_tuple)->key_ == reinterpret_cast<const Tuple *>(table_tuple)->key_;
+  }
+
+  /**
+   * Fill one thread-local table per thread with a disjoint slice of the build keys
+   */
+  void Populate(execution::sql::ThreadStateContainer *container, const uint64_t num_rows, const bool concise) {
+    container->Reset(
+        sizeof(execution::sql::JoinHashTable),
+        [](void *ctx, void *s) {
+          auto *const args = reinterpret_cast<std::pair<execution::sql::MemoryPool *, bool> *>(ctx);
+          new (s) execution::sql::JoinHashTable(args->first, sizeof(Tuple), args->second);
+        },
+        [](UNUSED_ATTRIBUTE void *ctx, void *s) {
+          reinterpret_cast<execution::sql::JoinHashTable *>(s)->~JoinHashTable();
+        },
+        &table_args_);
+    table_args_.second = concise;
+
+    execution::exec::QueryScheduler::Instance()->ParallelFor(num_threads_, [&](const uint64_t id) {
+      auto *jht = container->AccessThreadStateOfCurrentThreadAs<execution::sql::JoinHashTable>();
+      for (uint64_t key = id; key < num_rows; key += num_threads_) {
+        auto *tuple = reinterpret_cast<Tuple *>(jht->AllocInputTuple(HashOf(key)));
+        tuple->key_ = key;
+      }
+    });
+  }
+
+  /**
+   * Look up every build key once, in parallel
+   */
+  void ProbeAll(const execution::sql::JoinHashTable &jht, const uint64_t num_rows, const bool concise) {
+    execution::exec::QueryScheduler::Instance()->ParallelFor(num_threads_, [&](const uint64_t id) {
+      uint64_t num_matches = 0;
+      for (uint64_t key = id; key < num_rows; key += num_threads_) {
+        Tuple probe_tuple = {key, 0, 0, 0};
+        for (auto iter = concise ? jht.Lookup<true>(HashOf(key)) : jht.Lookup<false>(HashOf(key));
+             iter.HasNext(KeyEq, nullptr, &probe_tuple);) {
+          iter.NextMatch();
+          num_matches++;
+        }
+      }
+      benchmark::DoNotOptimize(num_matches);
+    });
+  }
+
+  /**
+   * Run a function as a query of the scheduler limited to num_threads_ threads, so that the parallel loops it runs use
+   * at most that many threads
+   */
+  void RunWithThreads(const std::function<void()> &fn) {
+    auto *const scheduler = execution::exec::QueryScheduler::Instance();
+    auto query = std::make_shared<execution::exec::QueryScheduler::Query>(
+        execution::exec::QueryScheduler::K_DEFAULT_PRIORITY, num_threads_);
+    query->AddPipeline(1, [&](UNUSED_ATTRIBUTE uint64_t morsel) { fn(); });
+    scheduler->Submit(query);
+    scheduler->Wait(query.get());
+  }
+
+  /**
+   * Time building a table from num_rows rows, or probing it with every key once
+   */
+  void BuildOrProbe(benchmark::State *state, const bool concise, const bool partitioned, const bool probe) {
+    const auto num_rows = static_cast<uint64_t>(state->range(0));
+    // Start the workers before counting misses, so that their threads are counted
+    execution::exec::QueryScheduler::Instance();
+    LlcMissCounter llc_misses;
+    uint64_t total_llc_misses = 0;
+    // NOLINTNEXTLINE
+    for (auto _ : *state) {
+      execution::sql::MemoryPool memory(nullptr);
+      table_args_.first = &memory;
+      execution::sql::ThreadStateContainer container(&memory);
+      execution::sql::JoinHashTable jht(&memory, sizeof(Tuple), concise);
+      jht.SetPartitionedBuild(partitioned);
+      RunWithThreads([&] {
+        Populate(&container, num_rows, concise);
+        if (probe) {
+          jht.MergeParallel(&container, 0);
+        }
+      });
+
+      uint64_t elapsed_ms;
+      llc_misses.Start();
+      {
+        common::ScopedTimer<std::chrono::milliseconds> timer(&elapsed_ms);
+        RunWithThreads([&] {
+          if (probe) {
+            ProbeAll(jht, num_rows, concise);
+          } else {
+            jht.MergeParallel(&container, 0);
+          }
+        });
+      }
+      total_llc_misses += llc_misses.Stop();
+      state->SetIterationTime(static_cast<double>(elapsed_ms) / 1000.0);
+    }
+    state->SetItemsProcessed(state->iterations() * num_rows);
+    if (llc_misses.IsAvailable() && state->iterations() > 0) {
+      state->counters["llc_misses"] = static_cast<double>(total_llc_misses) / static_cast<double>(state->iterations());
+    }
+  }
+
+  const uint32_t num_threads_ = 4;
+  std::pair<execution::sql::MemoryPool *, bool> table_args_;
+};
+
+// NOLINTNEXTLINE
+BENCHMARK_DEFINE_F(JoinHashTableBenchmark, SharedBuild)(benchmark::State &state) {
+  BuildOrProbe(&state, false, false, false);
+}
+
+// NOLINTNEXTLINE
+BENCHMARK_DEFINE_F(JoinHashTableBenchmark, PartitionedBuild)(benchmark::State &state) {
+  BuildOrProbe(&state, false, true, false);
+}
+
+// NOLINTNEXTLINE
+BENCHMARK_DEFINE_F(JoinHashTableBenchmark, PartitionedConciseBuild)(benchmark::State &state) {
+  BuildOrProbe(&state, true, true, false);
+}
+
+// NOLINTNEXTLINE
+BENCHMARK_DEFINE_F(JoinHashTableBenchmark, SharedBuildProbe)(benchmark::State &state) {
+  BuildOrProbe(&state, false, false, true);
+}
+
+// NOLINTNEXTLINE
+BENCHMARK_DEFINE_F(JoinHashTableBenchmark, PartitionedBuildProbe)(benchmark::State &state) {
+  BuildOrProbe(&state, false, true, true);
+}
+
+BENCHMARK_REGISTER_F(JoinHashTableBenchmark, SharedBuild)
+    ->Unit(benchmark::kMillisecond)
+    ->UseManualTime()
+    ->RangeMultiplier(10)
+    ->Range(1000000, 100000000);
+BENCHMARK_REGISTER_F(JoinHashTableBenchmark, PartitionedBuild)
+    ->Unit(benchmark::kMillisecond)
+    ->UseManualTime()
+    ->RangeMultiplier(10)
+    ->Range(1000000, 100000000);
+BENCHMARK_REGISTER_F(JoinHashTableBenchmark, PartitionedConciseBuild)
+    ->Unit(benchmark::kMillisecond)
+    ->UseManualTime()
+    ->RangeMultiplier(10)
+    ->Range(1000000, 100000000);
+BENCHMARK_REGISTER_F(JoinHashTableBenchmark, SharedBuildProbe)
+    ->Unit(benchmark::kMillisecond)
+    ->UseManualTime()
+    ->RangeMultiplier(10)
+    ->Range(1000000, 100000000);
+BENCHMARK_REGISTER_F(JoinHashTableBenchmark, PartitionedBuildProbe)
+    ->Unit(benchmark::kMillisecond)
+    ->UseManualTime()
+    ->RangeMultiplier(10)
+    ->Range(1000000, 100000000);
+}  // namespace terrier
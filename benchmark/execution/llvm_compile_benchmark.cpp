@@ -0,0 +1,104 @@
+#include <fstream>
+#include <memory>
+#include <string>
+
+#include "benchmark/benchmark.h"
+#include "common/scoped_timer.h"
+#include "execution/vm/bytecode_generator.h"
+#include "execution/vm/llvm_engine.h"
+#include "execution/vm/module_compiler.h"
+
+namespace terrier {
+
+/**
+ * The time the LLVMEngine takes to compile a large query module: a synthetic module of 100 pipelines, each a loop
+ * over a ProjectedColumnsIterator with a few filters and counters. The argument is the number of threads the module is
+ * optimized and compiled on; one compiles the whole module on a single thread. The benchmark must run from the
+ * directory holding the bytecode handlers' bitcode.
+ */
+class LLVMCompileBenchmark : public benchmark::Fixture {
+ public:
+  static constexpr uint32_t NUM_PIPELINES = 100;
+
+  void SetUp(const benchmark::State &state) final {
+    execution::vm::LLVMEngine::Initialize();
+
+    std::string src = R"(
+      struct State {
+        count: int64
+        matched: int64
+      })";
+    for (uint32_t i = 0; i < NUM_PIPELINES; i++) {
+      src += Pipeline(i);
+    }
+    src += R"(
+      fun main() -> int32 {
+        return 0
+      })";
+
+    compiler_ = std::make_unique<execution::vm::test::ModuleCompiler>();
+    auto *ast = compiler_->CompileToAst(src);
+    bytecode_module_ = execution::vm::BytecodeGenerator::Compile(ast, nullptr, "pipelines");
+  }
+
+  void TearDown(const benchmark::State &state) final {
+    bytecode_module_.reset();
+    compiler_.reset();
+  }
+
+ protected:
+  // The source of a pipeline with the given number
+  static std::string Pipeline(const uint32_t i) {
+    const std::string n = std::to_string(i);
+    return R"(
+      fun pipeline)" + n + R"((state: *State, pci: *ProjectedColumnsIterator) -> nil {
+        var count = 0
+        var matched = 0
+        for (; @pciHasNext(pci); @pciAdvance(pci)) {
+          var a = @pciGetInt(pci, 0)
+          var b = @pciGetInt(pci, 1)
+          if (a < @intToSql()" + n + R"() and b >= @intToSql()" + std::to_string(i * 7) + R"()) {
+            count = count + 1
+          } else if (a == b or @sqlToBool(b > a)) {
+            matched = matched + )" + std::to_string(i + 1) + R"(
+          }
+        }
+        @pciReset(pci)
+        state.count = state.count + count
+        state.matched = state.matched + matched
+      })";
+  }
+
+  std::unique_ptr<execution::vm::test::ModuleCompiler> compiler_;
+  std::unique_ptr<execution::vm::BytecodeModule> bytecode_module_;
+};
+
+// NOLINTNEXTLINE
+BENCHMARK_DEFINE_F(LLVMCompileBenchmark, Compile)(benchmark::State &state) {
+  execution::vm::LLVMEngine::CompilerOptions options;
+  options.SetCompileThreads(static_cast<uint32_t>(state.range(0)));
+  if (!std::ifstream(options.GetBytecodeHandlersBcPath()).good()) {
+    state.SkipWithError("The bytecode handlers' bitcode isn't in the working directory");
+    return;
+  }
+
+  // NOLINTNEXTLINE
+  for (auto _ : state) {
+    uint64_t elapsed_ms;
+    {
+      common::ScopedTimer<std::chrono::milliseconds> timer(&elapsed_ms);
+      auto compiled_module = execution::vm::LLVMEngine::Compile(*bytecode_module_, options);
+      benchmark::DoNotOptimize(compiled_module.get());
+    }
+    state.SetIterationTime(static_cast<double>(elapsed_ms) / 1000.0);
+  }
+}
+
+BENCHMARK_REGISTER_F(LLVMCompileBenchmark, Compile)
+    ->ArgName("threads")
+    ->RangeMultiplier(2)
+    ->Range(1, 8)
+    ->Unit(benchmark::kMillisecond)
+    ->UseManualTime();
+
+}  // namespace terrier
@@ -1,9 +1,12 @@
+#include <algorithm>
 #include <memory>
+#include <random>
 #include <vector>
 
 #include "benchmark/benchmark.h"
 #include "common/scoped_timer.h"
 #include "libcuckoo/cuckoohash_map.hh"
+#include "storage/index/partitioned_hash_map.h"
 #include "test_util/multithread_test_util.h"
 #include "xxHash/xxh3.h"
 
@@ -253,4 +256,272 @@ BENCHMARK_REGISTER_F(CuckooMapBenchmark, SequentialInsertSequentialRead)
     ->Unit(benchmark::kMillisecond)
     ->UseManualTime()
     ->MinTime(3);
+
+// The same workloads over the PartitionedHashMap backing HashIndex, to compare against the cuckoo map above
+
+class PartitionedHashMapBenchmark : public benchmark::Fixture {
+ public:
+  using HashMap = storage::index::PartitionedHashMap<int64_t, int64_t>;
+
+  void SetUp(const benchmark::State &state) final {
+    key_permutation_.resize(num_keys_);
+    for (uint32_t i = 0; i < num_keys_; i++) {
+      key_permutation_[i] = i;
+    }
+    std::shuffle(key_permutation_.begin(), key_permutation_.end(), generator_);
+  }
+
+  void TearDown(const benchmark::State &state) final {}
+
+  /**
+   * Benchmarks have no concurrent readers left once the threads are joined, so retired memory can be freed right away
+   */
+  static void FreeRetired(std::vector<HashMap::RetiredList> *const retired) {
+    for (auto &list : *retired) {
+      for (byte *const ptr : list) delete[] ptr;
+      list.clear();
+    }
+  }
+
+  // Workload
+  const uint32_t num_keys_ = 10000000;
+  const uint32_t num_threads_ = 4;
+
+  // Test infrastructure
+  std::default_random_engine generator_;
+  std::vector<int64_t> key_permutation_;
+};
+
+// NOLINTNEXTLINE
+BENCHMARK_DEFINE_F(PartitionedHashMapBenchmark, RandomInsert)(benchmark::State &state) {
+  common::WorkerPool thread_pool(num_threads_, {});
+  // NOLINTNEXTLINE
+  for (auto _ : state) {
+    auto *const index = new HashMap(256);
+
+    std::vector<HashMap::RetiredList> retired(num_threads_);
+
+    auto workload = [&](uint32_t id) {
+      uint32_t start_key = num_keys_ / num_threads_ * id;
+      uint32_t end_key = start_key + num_keys_ / num_threads_;
+
+      for (uint32_t i = start_key; i < end_key; i++) {
+        index->Insert(key_permutation_[i], key_permutation_[i], &retired[id]);
+      }
+    };
+
+    uint64_t elapsed_ms;
+    {
+      common::ScopedTimer<std::chrono::milliseconds> timer(&elapsed_ms);
+      MultiThreadTestUtil::RunThreadsUntilFinish(&thread_pool, num_threads_, workload);
+    }
+    delete index;
+    FreeRetired(&retired);
+    state.SetIterationTime(static_cast<double>(elapsed_ms) / 1000.0);
+  }
+  state.SetItemsProcessed(state.iterations() * num_keys_);
+}
+
+// NOLINTNEXTLINE
+BENCHMARK_DEFINE_F(PartitionedHashMapBenchmark, SequentialInsert)(benchmark::State &state) {
+  common::WorkerPool thread_pool(num_threads_, {});
+  // NOLINTNEXTLINE
+  for (auto _ : state) {
+    auto *const index = new HashMap(256);
+
+    std::vector<HashMap::RetiredList> retired(num_threads_);
+
+    auto workload = [&](uint32_t id) {
+      uint32_t start_key = num_keys_ / num_threads_ * id;
+      uint32_t end_key = start_key + num_keys_ / num_threads_;
+
+      for (uint32_t i = start_key; i < end_key; i++) {
+        index->Insert(i, i, &retired[id]);
+      }
+    };
+
+    uint64_t elapsed_ms;
+    {
+      common::ScopedTimer<std::chrono::milliseconds> timer(&elapsed_ms);
+      MultiThreadTestUtil::RunThreadsUntilFinish(&thread_pool, num_threads_, workload);
+    }
+    delete index;
+    FreeRetired(&retired);
+    state.SetIterationTime(static_cast<double>(elapsed_ms) / 1000.0);
+  }
+  state.SetItemsProcessed(state.iterations() * num_keys_);
+}
+
+// NOLINTNEXTLINE
+BENCHMARK_DEFINE_F(PartitionedHashMapBenchmark, RandomInsertRandomRead)(benchmark::State &state) {
+  common::WorkerPool thread_pool(num_threads_, {});
+  auto *const index = new HashMap(256);
+  std::vector<HashMap::RetiredList> retired(1);
+  for (uint32_t i = 0; i < num_keys_; i++) {
+    index->Insert(key_permutation_[i], key_permutation_[i], &retired[0]);
+  }
+  FreeRetired(&retired);
+
+  // NOLINTNEXTLINE
+  for (auto _ : state) {
+    auto workload = [&](uint32_t id) {
+      uint32_t start_key = num_keys_ / num_threads_ * id;
+      uint32_t end_key = start_key + num_keys_ / num_threads_;
+
+      std::vector<int64_t> values;
+      values.reserve(1);
+
+      for (uint32_t i = start_key; i < end_key; i++) {
+        index->Find(key_permutation_[i], &values);
+        values.clear();
+      }
+    };
+
+    uint64_t elapsed_ms;
+    {
+      common::ScopedTimer<std::chrono::milliseconds> timer(&elapsed_ms);
+      MultiThreadTestUtil::RunThreadsUntilFinish(&thread_pool, num_threads_, workload);
+    }
+    state.SetIterationTime(static_cast<double>(elapsed_ms) / 1000.0);
+  }
+
+  delete index;
+  state.SetItemsProcessed(state.iterations() * num_keys_);
+}
+
+// NOLINTNEXTLINE
+BENCHMARK_DEFINE_F(PartitionedHashMapBenchmark, RandomInsertSequentialRead)(benchmark::State &state) {
+  common::WorkerPool thread_pool(num_threads_, {});
+  auto *const index = new HashMap(256);
+  std::vector<HashMap::RetiredList> retired(1);
+  for (uint32_t i = 0; i < num_keys_; i++) {
+    index->Insert(key_permutation_[i], key_permutation_[i], &retired[0]);
+  }
+  FreeRetired(&retired);
+
+  // NOLINTNEXTLINE
+  for (auto _ : state) {
+    auto workload = [&](uint32_t id) {
+      uint32_t start_key = num_keys_ / num_threads_ * id;
+      uint32_t end_key = start_key + num_keys_ / num_threads_;
+
+      std::vector<int64_t> values;
+      values.reserve(1);
+
+      for (uint32_t i = start_key; i < end_key; i++) {
+        index->Find(i, &values);
+        values.clear();
+      }
+    };
+
+    uint64_t elapsed_ms;
+    {
+      common::ScopedTimer<std::chrono::milliseconds> timer(&elapsed_ms);
+      MultiThreadTestUtil::RunThreadsUntilFinish(&thread_pool, num_threads_, workload);
+    }
+    state.SetIterationTime(static_cast<double>(elapsed_ms) / 1000.0);
+  }
+
+  delete index;
+  state.SetItemsProcessed(state.iterations() * num_keys_);
+}
+
+// NOLINTNEXTLINE
+BENCHMARK_DEFINE_F(PartitionedHashMapBenchmark, SequentialInsertRandomRead)(benchmark::State &state) {
+  common::WorkerPool thread_pool(num_threads_, {});
+  auto *const index = new HashMap(256);
+  std::vector<HashMap::RetiredList> retired(1);
+  for (uint32_t i = 0; i < num_keys_; i++) {
+    index->Insert(i, i, &retired[0]);
+  }
+  FreeRetired(&retired);
+
+  // NOLINTNEXTLINE
+  for (auto _ : state) {
+    auto workload = [&](uint32_t id) {
+      uint32_t start_key = num_keys_ / num_threads_ * id;
+      uint32_t end_key = start_key + num_keys_ / num_threads_;
+
+      std::vector<int64_t> values;
+      values.reserve(1);
+
+      for (uint32_t i = start_key; i < end_key; i++) {
+        index->Find(key_permutation_[i], &values);
+        values.clear();
+      }
+    };
+
+    uint64_t elapsed_ms;
+    {
+      common::ScopedTimer<std::chrono::milliseconds> timer(&elapsed_ms);
+      MultiThreadTestUtil::RunThreadsUntilFinish(&thread_pool, num_threads_, workload);
+    }
+    state.SetIterationTime(static_cast<double>(elapsed_ms) / 1000.0);
+  }
+
+  delete index;
+  state.SetItemsProcessed(state.iterations() * num_keys_);
+}
+
+// NOLINTNEXTLINE
+BENCHMARK_DEFINE_F(PartitionedHashMapBenchmark, SequentialInsertSequentialRead)(benchmark::State &state) {
+  common::WorkerPool thread_pool(num_threads_, {});
+  auto *const index = new HashMap(256);
+  std::vector<HashMap::RetiredList> retired(1);
+  for (uint32_t i = 0; i < num_keys_; i++) {
+    index->Insert(i, i, &retired[0]);
+  }
+  FreeRetired(&retired);
+
+  // NOLINTNEXTLINE
+  for (auto _ : state) {
+    auto workload = [&](uint32_t id) {
+      uint32_t start_key = num_keys_ / num_threads_ * id;
+      uint32_t end_key = start_key + num_keys_ / num_threads_;
+
+      std::vector<int64_t> values;
+      values.reserve(1);
+
+      for (uint32_t i = start_key; i < end_key; i++) {
+        index->Find(i, &values);
+        values.clear();
+      }
+    };
+
+    uint64_t elapsed_ms;
+    {
+      common::ScopedTimer<std::chrono::milliseconds> timer(&elapsed_ms);
+      MultiThreadTestUtil::RunThreadsUntilFinish(&thread_pool, num_threads_, workload);
+    }
+    state.SetIterationTime(static_cast<double>(elapsed_ms) / 1000.0);
+  }
+
+  delete index;
+  state.SetItemsProcessed(state.iterations() * num_keys_);
+}
+
+BENCHMARK_REGISTER_F(PartitionedHashMapBenchmark, RandomInsert)
+    ->Unit(benchmark::kMillisecond)
+    ->UseManualTime()
+    ->MinTime(10);
+BENCHMARK_REGISTER_F(PartitionedHashMapBenchmark, SequentialInsert)
+    ->Unit(benchmark::kMillisecond)
+    ->UseManualTime()
+    ->MinTime(10);
+BENCHMARK_REGISTER_F(PartitionedHashMapBenchmark, RandomInsertRandomRead)
+    ->Unit(benchmark::kMillisecond)
+    ->UseManualTime()
+    ->MinTime(3);
+BENCHMARK_REGISTER_F(PartitionedHashMapBenchmark, RandomInsertSequentialRead)
+    ->Unit(benchmark::kMillisecond)
+    ->UseManualTime()
+    ->MinTime(3);
+BENCHMARK_REGISTER_F(PartitionedHashMapBenchmark, SequentialInsertRandomRead)
+    ->Unit(benchmark::kMillisecond)
+    ->UseManualTime()
+    ->MinTime(3);
+BENCHMARK_REGISTER_F(PartitionedHashMapBenchmark, SequentialInsertSequentialRead)
+    ->Unit(benchmark::kMillisecond)
+    ->UseManualTime()
+    ->MinTime(3);
 }  // namespace terrier
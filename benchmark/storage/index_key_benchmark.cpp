@@ -0,0 +1,327 @@
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "bwtree/bwtree.h"
+#include "catalog/index_schema.h"
+#include "common/scoped_timer.h"
+#include "storage/index/compact_ints_key.h"
+#include "storage/index/generic_key.h"
+#include "storage/index/index_metadata.h"
+#include "storage/index/string_key.h"
+#include "storage/projected_columns.h"
+#include "test_util/storage_test_util.h"
+
+namespace terrier {
+
+/**
+ * Compares GenericKey and StringKey for a VARCHAR(64) key, e.g. an email address or user name. Reports lookup
+ * throughput in a BwTree as items processed, and the size of the key type as the bytes_per_key counter.
+ */
+class IndexKeyBenchmark : public benchmark::Fixture {
+ public:
+  void SetUp(const benchmark::State &state) final {
+    std::vector<catalog::IndexSchema::Column> key_cols;
+    key_cols.emplace_back("", type::TypeId::VARCHAR, MAX_VARLEN_SIZE, false,
+                          parser::ConstantValueExpression(type::TransientValueFactory::GetNull(type::TypeId::VARCHAR)));
+    StorageTestUtil::ForceOid(&(key_cols.back()), catalog::indexkeycol_oid_t(1));
+    metadata_ = std::make_unique<storage::index::IndexMetadata>(
+        catalog::IndexSchema(key_cols, storage::index::IndexType::BWTREE, false, false, false, true));
+
+    // random lowercase strings with a common suffix, which is what real emails tend to look like
+    std::uniform_int_distribution<uint32_t> length_dist(8, MAX_VARLEN_SIZE - 12);
+    std::uniform_int_distribution<int> char_dist('a', 'z');
+    strings_.clear();
+    strings_.reserve(num_keys_);
+    for (uint32_t i = 0; i < num_keys_; i++) {
+      std::string string(length_dist(generator_), ' ');
+      std::generate(string.begin(), string.end(), [&] { return static_cast<char>(char_dist(generator_)); });
+      strings_.emplace_back(string + "@example.com");
+    }
+
+    const auto &initializer = metadata_->GetProjectedRowInitializer();
+    pr_buffer_ = common::AllocationUtil::AllocateAligned(initializer.ProjectedRowSize());
+    pr_ = initializer.InitializeRow(pr_buffer_);
+  }
+
+  void TearDown(const benchmark::State &state) final {
+    delete[] pr_buffer_;
+    metadata_.reset();
+  }
+
+  /**
+   * Builds a BwTree with all of the keys, then looks every key up in random order.
+   * @tparam KeyType index key type to benchmark
+   */
+  template <typename KeyType>
+  void RandomRead(benchmark::State *const state) {
+    std::vector<KeyType> keys(num_keys_);
+    for (uint32_t i = 0; i < num_keys_; i++) SetKey(&keys[i], i);
+
+    auto *const tree = new third_party::bwtree::BwTree<KeyType, storage::TupleSlot>(false);
+    for (uint32_t i = 0; i < num_keys_; i++) {
+      tree->Insert(keys[i], storage::TupleSlot(nullptr, i));
+    }
+    std::shuffle(keys.begin(), keys.end(), generator_);
+
+    std::vector<storage::TupleSlot> values;
+    values.reserve(1);
+    // NOLINTNEXTLINE
+    for (auto _ : *state) {
+      uint64_t elapsed_ms;
+      {
+        common::ScopedTimer<std::chrono::milliseconds> timer(&elapsed_ms);
+        for (const auto &key : keys) {
+          tree->GetValue(key, values);
+          values.clear();
+        }
+      }
+      state->SetIterationTime(static_cast<double>(elapsed_ms) / 1000.0);
+    }
+
+    delete tree;
+    state->SetItemsProcessed(state->iterations() * num_keys_);
+    state->counters["bytes_per_key"] = sizeof(KeyType);
+  }
+
+  // Workload
+  static constexpr uint16_t MAX_VARLEN_SIZE = 64;
+  const uint32_t num_keys_ = 1000000;
+
+  // Test infrastructure
+  std::default_random_engine generator_;
+  std::vector<std::string> strings_;
+  std::unique_ptr<storage::index::IndexMetadata> metadata_;
+  byte *pr_buffer_;
+  storage::ProjectedRow *pr_;
+
+ private:
+  template <typename KeyType>
+  void SetKey(KeyType *const key, const uint32_t i) {
+    auto &string = strings_[i];
+    *reinterpret_cast<storage::VarlenEntry *>(pr_->AccessForceNotNull(0)) = storage::VarlenEntry::Create(
+        reinterpret_cast<byte *>(string.data()), static_cast<uint32_t>(string.size()), false);
+    key->SetFromProjectedRow(*pr_, *metadata_);
+  }
+};
+
+// NOLINTNEXTLINE
+BENCHMARK_DEFINE_F(IndexKeyBenchmark, GenericKeyRandomRead)(benchmark::State &state) {
+  RandomRead<storage::index::GenericKey<128>>(&state);
+}
+
+// NOLINTNEXTLINE
+BENCHMARK_DEFINE_F(IndexKeyBenchmark, StringKeyRandomRead)(benchmark::State &state) {
+  RandomRead<storage::index::StringKey<80>>(&state);
+}
+
+BENCHMARK_REGISTER_F(IndexKeyBenchmark, GenericKeyRandomRead)
+    ->Unit(benchmark::kMillisecond)
+    ->UseManualTime()
+    ->MinTime(3);
+BENCHMARK_REGISTER_F(IndexKeyBenchmark, StringKeyRandomRead)
+    ->Unit(benchmark::kMillisecond)
+    ->UseManualTime()
+    ->MinTime(3);
+
+/**
+ * Builds CompactIntsKeys for a TPC-C ORDER_LINE-like primary key (W_ID, D_ID, O_ID, OL_NUMBER) one ProjectedRow at a
+ * time and in batches from ProjectedColumns, then inserts and looks up the keys in a BwTree.
+ */
+class CompactIntsKeyBenchmark : public benchmark::Fixture {
+ public:
+  using KeyType = storage::index::CompactIntsKey<16>;
+
+  void SetUp(const benchmark::State &state) final {
+    std::vector<catalog::IndexSchema::Column> key_cols;
+    const std::vector<type::TypeId> types{type::TypeId::INTEGER, type::TypeId::TINYINT, type::TypeId::INTEGER,
+                                          type::TypeId::TINYINT};
+    for (uint32_t i = 0; i < types.size(); i++) {
+      key_cols.emplace_back("", types[i], false,
+                            parser::ConstantValueExpression(type::TransientValueFactory::GetNull(types[i])));
+      StorageTestUtil::ForceOid(&(key_cols.back()), catalog::indexkeycol_oid_t(i + 1));
+    }
+    metadata_ = std::make_unique<storage::index::IndexMetadata>(
+        catalog::IndexSchema(key_cols, storage::index::IndexType::BWTREE, true, true, false, true));
+
+    // the same columns in a table, read into a batch with the index's key columns in any order
+    const storage::BlockLayout layout({8, 4, 4, 1, 1});
+    const std::vector<storage::col_id_t> col_ids{storage::col_id_t(1), storage::col_id_t(2), storage::col_id_t(3),
+                                                 storage::col_id_t(4)};
+    storage::ProjectedColumnsInitializer pc_initializer(layout, col_ids, common::Constants::K_DEFAULT_VECTOR_SIZE);
+    pc_buffer_ = common::AllocationUtil::AllocateAligned(pc_initializer.ProjectedColumnsSize());
+    pc_ = pc_initializer.Initialize(pc_buffer_);
+    column_offsets_ = {0, 2, 1, 3};
+
+    const auto &initializer = metadata_->GetProjectedRowInitializer();
+    pr_buffer_ = common::AllocationUtil::AllocateAligned(initializer.ProjectedRowSize());
+    pr_ = initializer.InitializeRow(pr_buffer_);
+
+    rows_.clear();
+    rows_.reserve(num_keys_);
+    for (int32_t w_id = 1; rows_.size() < num_keys_; w_id++) {
+      for (int8_t d_id = 1; d_id <= 10 && rows_.size() < num_keys_; d_id++) {
+        for (int32_t o_id = 1; o_id <= 3000 && rows_.size() < num_keys_; o_id++) {
+          for (int8_t ol_number = 1; ol_number <= 10 && rows_.size() < num_keys_; ol_number++) {
+            rows_.push_back({w_id, o_id, d_id, ol_number});
+          }
+        }
+      }
+    }
+    std::shuffle(rows_.begin(), rows_.end(), generator_);
+  }
+
+  void TearDown(const benchmark::State &state) final {
+    delete[] pc_buffer_;
+    delete[] pr_buffer_;
+    metadata_.reset();
+  }
+
+  /**
+   * Builds every key and inserts it into a BwTree, then looks every key up
+   * @param batched true to build the keys from ProjectedColumns, false to build them from a ProjectedRow each
+   */
+  void InsertAndRead(benchmark::State *const state, const bool batched) {
+    std::vector<KeyType> keys(num_keys_);
+    std::vector<storage::TupleSlot> values;
+    values.reserve(1);
+    // NOLINTNEXTLINE
+    for (auto _ : *state) {
+      auto *const tree = new third_party::bwtree::BwTree<KeyType, storage::TupleSlot>(false);
+      uint64_t elapsed_ms;
+      {
+        common::ScopedTimer<std::chrono::milliseconds> timer(&elapsed_ms);
+        if (batched) {
+          BuildKeysBatched(&keys);
+        } else {
+          BuildKeys(&keys);
+        }
+        for (uint32_t i = 0; i < num_keys_; i++) tree->Insert(keys[i], storage::TupleSlot(nullptr, i));
+        for (const auto &key : keys) {
+          tree->GetValue(key, values);
+          values.clear();
+        }
+      }
+      delete tree;
+      state->SetIterationTime(static_cast<double>(elapsed_ms) / 1000.0);
+    }
+    state->SetItemsProcessed(state->iterations() * num_keys_);
+  }
+
+  /**
+   * Only builds the keys, to isolate the cost of key extraction
+   * @param batched true to build the keys from ProjectedColumns, false to build them from a ProjectedRow each
+   */
+  void Extract(benchmark::State *const state, const bool batched) {
+    std::vector<KeyType> keys(num_keys_);
+    // NOLINTNEXTLINE
+    for (auto _ : *state) {
+      uint64_t elapsed_ms;
+      {
+        common::ScopedTimer<std::chrono::milliseconds> timer(&elapsed_ms);
+        if (batched) {
+          BuildKeysBatched(&keys);
+        } else {
+          BuildKeys(&keys);
+        }
+      }
+      state->SetIterationTime(static_cast<double>(elapsed_ms) / 1000.0);
+    }
+    state->SetItemsProcessed(state->iterations() * num_keys_);
+  }
+
+  // Workload
+  const uint32_t num_keys_ = 1000000;
+
+  // Test infrastructure
+  std::default_random_engine generator_;
+  std::unique_ptr<storage::index::IndexMetadata> metadata_;
+  byte *pr_buffer_;
+  storage::ProjectedRow *pr_;
+  byte *pc_buffer_;
+  storage::ProjectedColumns *pc_;
+  std::vector<uint16_t> column_offsets_;
+
+ private:
+  struct Row {
+    int32_t w_id_, o_id_;
+    int8_t d_id_, ol_number_;
+  };
+
+  // the way a caller fills the index's ProjectedRow today, one tuple at a time
+  void BuildKeys(std::vector<KeyType> *const keys) {
+    const auto &oid_offset_map = metadata_->GetKeyOidToOffsetMap();
+    for (uint32_t i = 0; i < num_keys_; i++) {
+      const auto &row = rows_[i];
+      *reinterpret_cast<int32_t *>(pr_->AccessForceNotNull(oid_offset_map.at(catalog::indexkeycol_oid_t(1)))) =
+          row.w_id_;
+      *reinterpret_cast<int8_t *>(pr_->AccessForceNotNull(oid_offset_map.at(catalog::indexkeycol_oid_t(2)))) =
+          row.d_id_;
+      *reinterpret_cast<int32_t *>(pr_->AccessForceNotNull(oid_offset_map.at(catalog::indexkeycol_oid_t(3)))) =
+          row.o_id_;
+      *reinterpret_cast<int8_t *>(pr_->AccessForceNotNull(oid_offset_map.at(catalog::indexkeycol_oid_t(4)))) =
+          row.ol_number_;
+      (*keys)[i].SetFromProjectedRow(*pr_, *metadata_);
+    }
+  }
+
+  // fill a vector's worth of tuples, as a sequential scan would, and build all of their keys at once
+  void BuildKeysBatched(std::vector<KeyType> *const keys) {
+    const uint32_t batch_size = pc_->MaxTuples();
+    for (uint32_t start = 0; start < num_keys_; start += batch_size) {
+      const uint32_t num_tuples = std::min(batch_size, num_keys_ - start);
+      auto *const w_ids = reinterpret_cast<int32_t *>(pc_->ColumnStart(column_offsets_[0]));
+      auto *const d_ids = reinterpret_cast<int8_t *>(pc_->ColumnStart(column_offsets_[1]));
+      auto *const o_ids = reinterpret_cast<int32_t *>(pc_->ColumnStart(column_offsets_[2]));
+      auto *const ol_numbers = reinterpret_cast<int8_t *>(pc_->ColumnStart(column_offsets_[3]));
+      for (uint32_t i = 0; i < num_tuples; i++) {
+        const auto &row = rows_[start + i];
+        w_ids[i] = row.w_id_;
+        d_ids[i] = row.d_id_;
+        o_ids[i] = row.o_id_;
+        ol_numbers[i] = row.ol_number_;
+      }
+      pc_->SetNumTuples(num_tuples);
+      KeyType::SetFromProjectedColumns(keys->data() + start, pc_, column_offsets_, *metadata_);
+    }
+  }
+
+  std::vector<Row> rows_;
+};
+
+// NOLINTNEXTLINE
+BENCHMARK_DEFINE_F(CompactIntsKeyBenchmark, ExtractRowAtATime)(benchmark::State &state) { Extract(&state, false); }
+
+// NOLINTNEXTLINE
+BENCHMARK_DEFINE_F(CompactIntsKeyBenchmark, ExtractBatched)(benchmark::State &state) { Extract(&state, true); }
+
+// NOLINTNEXTLINE
+BENCHMARK_DEFINE_F(CompactIntsKeyBenchmark, InsertAndReadRowAtATime)(benchmark::State &state) {
+  InsertAndRead(&state, false);
+}
+
+// NOLINTNEXTLINE
+BENCHMARK_DEFINE_F(CompactIntsKeyBenchmark, InsertAndReadBatched)(benchmark::State &state) {
+  InsertAndRead(&state, true);
+}
+
+BENCHMARK_REGISTER_F(CompactIntsKeyBenchmark, ExtractRowAtATime)
+    ->Unit(benchmark::kMillisecond)
+    ->UseManualTime()
+    ->MinTime(3);
+BENCHMARK_REGISTER_F(CompactIntsKeyBenchmark, ExtractBatched)
+    ->Unit(benchmark::kMillisecond)
+    ->UseManualTime()
+    ->MinTime(3);
+BENCHMARK_REGISTER_F(CompactIntsKeyBenchmark, InsertAndReadRowAtATime)
+    ->Unit(benchmark::kMillisecond)
+    ->UseManualTime()
+    ->MinTime(3);
+BENCHMARK_REGISTER_F(CompactIntsKeyBenchmark, InsertAndReadBatched)
+    ->Unit(benchmark::kMillisecond)
+    ->UseManualTime()
+    ->MinTime(3);
+}  // namespace terrier
@@ -130,7 +130,10 @@ fun main(execCtx: *ExecutionContext) -> int {
   @tlsReset(&tls, @sizeOf(ThreadState_1), p1_worker_initThreadState, p1_worker_tearDownThreadState, execCtx)
 
   // Parallel Scan
-  @iterateTableParallel("test_1", &state, &tls, p1_worker)
+  var col_oids: [2]uint32
+  col_oids[0] = 1
+  col_oids[1] = 2
+  @iterateTableParallel(execCtx, "test_1", col_oids, &state, &tls, p1_worker)
 
   // ---- Pipeline 1 End ---- // 
 
@@ -0,0 +1,20 @@
+// Perform (in vectorized fashion)
+//
+// SELECT colA FROM test_1 WHERE colA BETWEEN 1000 AND 2999
+//
+// Should return 2000 (number of output rows)
+
+fun main(execCtx: *ExecutionContext) -> int64 {
+  var ret = 0
+  var tvi: TableVectorIterator
+  var oids: [1]uint32
+  oids[0] = 1 // colA
+  @tableIterInitBind(&tvi, execCtx, "test_1", oids)
+  for (; @tableIterAdvance(&tvi);) {
+    var pci = @tableIterGetPCI(&tvi)
+    ret = ret + @filterBetween(pci, 0, 4, 1000, 2999)
+    @pciReset(pci)
+  }
+  @tableIterClose(&tvi)
+  return ret
+}
@@ -0,0 +1,26 @@
+// Perform (in vectorized fashion)
+//
+// SELECT colA FROM test_1 WHERE colA IN (1, 10, 100, 1000, 10000)
+//
+// Should return 4 (number of output rows)
+
+fun main(execCtx: *ExecutionContext) -> int64 {
+  var ret = 0
+  var vals: [5]int64
+  vals[0] = 1
+  vals[1] = 10
+  vals[2] = 100
+  vals[3] = 1000
+  vals[4] = 10000
+  var tvi: TableVectorIterator
+  var oids: [1]uint32
+  oids[0] = 1 // colA
+  @tableIterInitBind(&tvi, execCtx, "test_1", oids)
+  for (; @tableIterAdvance(&tvi);) {
+    var pci = @tableIterGetPCI(&tvi)
+    ret = ret + @filterIn(pci, 0, 4, vals)
+    @pciReset(pci)
+  }
+  @tableIterClose(&tvi)
+  return ret
+}
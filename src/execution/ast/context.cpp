@@ -18,6 +18,7 @@
 #include "execution/ast/type.h"
 #include "execution/sql/aggregation_hash_table.h"
 #include "execution/sql/aggregators.h"
+#include "execution/sql/direct_mapped_aggregation_table.h"
 #include "execution/sql/filter_manager.h"
 #include "execution/sql/index_iterator.h"
 #include "execution/sql/join_hash_table.h"
@@ -6,6 +6,7 @@
 #include "execution/exec/execution_context.h"
 #include "execution/sql/aggregation_hash_table.h"
 #include "execution/sql/aggregators.h"
+#include "execution/sql/direct_mapped_aggregation_table.h"
 #include "execution/sql/filter_manager.h"
 #include "execution/sql/hash_table_entry.h"
 #include "execution/sql/index_iterator.h"
@@ -5,6 +5,7 @@
 #include <chrono>  // NOLINT
 #include <cmath>
 #include <limits>
+#include <memory>
 #include <vector>
 
 #include "execution/bandit/agent.h"
@@ -16,6 +17,29 @@ namespace terrier::execution::bandit {
 Policy::Policy(Kind kind)
     : kind_(kind), generator_(std::chrono::high_resolution_clock::now().time_since_epoch().count()) {}
 
+std::unique_ptr<Policy> Policy::Create(const Kind kind) {
+  switch (kind) {
+    case Kind::EpsilonGreedy: {
+      return std::make_unique<EpsilonGreedyPolicy>(EpsilonGreedyPolicy::K_DEFAULT_EPSILON);
+    }
+    case Kind::Greedy: {
+      return std::make_unique<GreedyPolicy>();
+    }
+    case Kind::Random: {
+      return std::make_unique<RandomPolicy>();
+    }
+    case Kind::UCB: {
+      return std::make_unique<UCBPolicy>(UCBPolicy::K_DEFAULT_UCB_HYPER_PARAM);
+    }
+    case Kind::FixedAction: {
+      return std::make_unique<FixedActionPolicy>(0);
+    }
+    default: {
+      UNREACHABLE("Impossible bandit policy kind");
+    }
+  }
+}
+
 namespace {
 
 /**
@@ -0,0 +1,1289 @@
+#include "execution/compiler/compiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "catalog/catalog_accessor.h"
+#include "execution/sql/direct_mapped_aggregation_table.h"
+#include "loggers/execution_logger.h"
+#include "optimizer/statistics/stats_storage.h"
+#include "parser/expression/aggregate_expression.h"
+#include "parser/expression/column_value_expression.h"
+#include "parser/expression/constant_value_expression.h"
+#include "parser/expression/derived_value_expression.h"
+#include "planner/plannodes/aggregate_plan_node.h"
+#include "planner/plannodes/hash_join_plan_node.h"
+#include "planner/plannodes/limit_plan_node.h"
+#include "planner/plannodes/order_by_plan_node.h"
+#include "planner/plannodes/projection_plan_node.h"
+#include "planner/plannodes/seq_scan_plan_node.h"
+#include "storage/sql_table.h"
+#include "type/transient_value_peeker.h"
+#include "type/type_util.h"
+
+namespace terrier::execution::compiler {
+
+namespace {
+
+// The TPL operator of a comparison, or nullptr if the expression isn't one
+const char *ComparisonOperator(const parser::ExpressionType type) {
+  switch (type) {
+    case parser::ExpressionType::COMPARE_EQUAL:
+      return "==";
+    case parser::ExpressionType::COMPARE_NOT_EQUAL:
+      return "!=";
+    case parser::ExpressionType::COMPARE_LESS_THAN:
+      return "<";
+    case parser::ExpressionType::COMPARE_LESS_THAN_OR_EQUAL_TO:
+      return "<=";
+    case parser::ExpressionType::COMPARE_GREATER_THAN:
+      return ">";
+    case parser::ExpressionType::COMPARE_GREATER_THAN_OR_EQUAL_TO:
+      return ">=";
+    default:
+      return nullptr;
+  }
+}
+
+// The vectorized filter builtin evaluating a comparison, or nullptr if there is none
+const char *FilterBuiltin(const parser::ExpressionType type) {
+  switch (type) {
+    case parser::ExpressionType::COMPARE_EQUAL:
+      return "@filterEq";
+    case parser::ExpressionType::COMPARE_NOT_EQUAL:
+      return "@filterNe";
+    case parser::ExpressionType::COMPARE_LESS_THAN:
+      return "@filterLt";
+    case parser::ExpressionType::COMPARE_LESS_THAN_OR_EQUAL_TO:
+      return "@filterLe";
+    case parser::ExpressionType::COMPARE_GREATER_THAN:
+      return "@filterGt";
+    case parser::ExpressionType::COMPARE_GREATER_THAN_OR_EQUAL_TO:
+      return "@filterGe";
+    default:
+      return nullptr;
+  }
+}
+
+// The comparison with its operands swapped: a < b is b > a
+parser::ExpressionType MirrorComparison(const parser::ExpressionType type) {
+  switch (type) {
+    case parser::ExpressionType::COMPARE_LESS_THAN:
+      return parser::ExpressionType::COMPARE_GREATER_THAN;
+    case parser::ExpressionType::COMPARE_LESS_THAN_OR_EQUAL_TO:
+      return parser::ExpressionType::COMPARE_GREATER_THAN_OR_EQUAL_TO;
+    case parser::ExpressionType::COMPARE_GREATER_THAN:
+      return parser::ExpressionType::COMPARE_LESS_THAN;
+    case parser::ExpressionType::COMPARE_GREATER_THAN_OR_EQUAL_TO:
+      return parser::ExpressionType::COMPARE_LESS_THAN_OR_EQUAL_TO;
+    default:
+      return type;
+  }
+}
+
+// The TPL operator of an arithmetic expression, or nullptr if the expression isn't one
+const char *ArithmeticOperator(const parser::ExpressionType type) {
+  switch (type) {
+    case parser::ExpressionType::OPERATOR_PLUS:
+      return "+";
+    case parser::ExpressionType::OPERATOR_MINUS:
+      return "-";
+    case parser::ExpressionType::OPERATOR_MULTIPLY:
+      return "*";
+    case parser::ExpressionType::OPERATOR_DIVIDE:
+      return "/";
+    case parser::ExpressionType::OPERATOR_MOD:
+      return "%";
+    default:
+      return nullptr;
+  }
+}
+
+bool IsIntegerType(const type::TypeId type) {
+  return type == type::TypeId::TINYINT || type == type::TypeId::SMALLINT || type == type::TypeId::INTEGER ||
+         type == type::TypeId::BIGINT;
+}
+
+// The value of an integer constant, or false if the constant isn't a non-NULL integer
+bool PeekInteger(const type::TransientValue &value, int64_t *out) {
+  if (value.Null()) return false;
+  switch (value.Type()) {
+    case type::TypeId::TINYINT:
+      *out = type::TransientValuePeeker::PeekTinyInt(value);
+      return true;
+    case type::TypeId::SMALLINT:
+      *out = type::TransientValuePeeker::PeekSmallInt(value);
+      return true;
+    case type::TypeId::INTEGER:
+      *out = type::TransientValuePeeker::PeekInteger(value);
+      return true;
+    case type::TypeId::BIGINT:
+      *out = type::TransientValuePeeker::PeekBigInt(value);
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Does the value fit in a column of the given integer type?
+bool FitsIn(const int64_t value, const type::TypeId type) {
+  switch (type) {
+    case type::TypeId::TINYINT:
+      return value <= std::numeric_limits<int8_t>::max();
+    case type::TypeId::SMALLINT:
+      return value <= std::numeric_limits<int16_t>::max();
+    default:
+      return value <= std::numeric_limits<int32_t>::max();
+  }
+}
+
+bool IsCountStar(const parser::AggregateExpression &term) {
+  return term.GetExpressionType() == parser::ExpressionType::AGGREGATE_COUNT &&
+         (term.GetChildrenSize() == 0 || term.GetChild(0)->GetExpressionType() == parser::ExpressionType::STAR);
+}
+
+// Collect the oids of the columns an expression refers to
+void CollectColumnOids(const parser::AbstractExpression &expr, std::vector<catalog::col_oid_t> *oids) {
+  if (expr.GetExpressionType() == parser::ExpressionType::COLUMN_VALUE) {
+    oids->push_back(static_cast<const parser::ColumnValueExpression &>(expr).GetColumnOid());
+  }
+  for (const auto &child : expr.GetChildren()) {
+    CollectColumnOids(*child, oids);
+  }
+}
+
+// Split a predicate into the terms of its top-level conjunctions
+void SplitConjuncts(const common::ManagedPointer<parser::AbstractExpression> expr,
+                    std::vector<common::ManagedPointer<parser::AbstractExpression>> *conjuncts) {
+  if (expr->GetExpressionType() == parser::ExpressionType::CONJUNCTION_AND) {
+    for (const auto &child : expr->GetChildren()) {
+      SplitConjuncts(child, conjuncts);
+    }
+    return;
+  }
+  conjuncts->push_back(expr);
+}
+
+}  // namespace
+
+std::string Compiler::Compile() {
+  const auto output_schema = plan_.GetOutputSchema();
+  if (output_schema == nullptr) {
+    Unsupported("plan without an output schema");
+    return "";
+  }
+
+  // The result is written to the output buffer in the layout of the output schema
+  Row output;
+  for (const auto &column : output_schema->GetColumns()) {
+    Value value;
+    if (IsIntegerType(column.GetType())) {
+      value.type_ = SqlType::Integer;
+    } else if (column.GetType() == type::TypeId::DECIMAL) {
+      value.type_ = SqlType::Real;
+    } else {
+      Unsupported("output column of type " + type::TypeUtil::TypeIdToString(column.GetType()));
+    }
+    output_types_.push_back(value.type_);
+    output.push_back(value);
+  }
+  DeclareRowStruct("OutputRow", output, "c");
+  const auto num_rows = AddStateField("numRows", "int64");
+  set_up_.push_back(num_rows + " = 0");
+  // For the functions that pipelines call with the state alone
+  const auto exec_ctx = AddStateField("execCtx", "*ExecutionContext");
+  set_up_.push_back(exec_ctx + " = execCtx");
+
+  BeginPipeline();
+  Produce(plan_, [this](const Row &row) { ConsumeOutput(row); });
+  EndPipeline({});
+
+  if (!unsupported_reason_.empty()) {
+    EXECUTION_LOG_DEBUG("Can't compile plan: {}", unsupported_reason_);
+    return "";
+  }
+
+  std::string src;
+  for (const auto &decl : structs_) {
+    src += decl + "\n";
+  }
+  src += "struct State {\n";
+  for (const auto &field : state_fields_) {
+    src += "  " + field + "\n";
+  }
+  src += "}\n\n";
+  for (const auto &function : functions_) {
+    src += function + "\n";
+  }
+  src += "fun setUpState(execCtx: *ExecutionContext, state: *State) -> nil {\n";
+  for (const auto &stmt : set_up_) {
+    src += "  " + stmt + "\n";
+  }
+  src += "}\n\nfun tearDownState(state: *State) -> nil {\n";
+  for (const auto &stmt : tear_down_) {
+    src += "  " + stmt + "\n";
+  }
+  src += "}\n\n";
+  for (const auto &pipeline : pipelines_) {
+    src += pipeline + "\n";
+  }
+  // The entry points of a caller running the pipelines itself, on a State it allocates
+  src += "fun stateSize() -> uint32 {\n";
+  src += "  return @sizeOf(State)\n";
+  src += "}\n\nfun finishQuery(execCtx: *ExecutionContext, state: *State) -> int64 {\n";
+  src += "  @outputFinalize(execCtx)\n";
+  src += "  var numRows = state.numRows\n";
+  src += "  tearDownState(state)\n";
+  src += "  return numRows\n";
+  src += "}\n\n";
+  src += "fun main(execCtx: *ExecutionContext) -> int64 {\n";
+  src += "  var state: State\n";
+  src += "  setUpState(execCtx, &state)\n";
+  for (const auto &stmt : main_steps_) {
+    src += "  " + stmt + "\n";
+  }
+  src += "  return finishQuery(execCtx, &state)\n";
+  src += "}\n";
+  return src;
+}
+
+void Compiler::Produce(const planner::AbstractPlanNode &node, const Consumer &consume) {
+  if (!unsupported_reason_.empty()) return;
+
+  const auto type = node.GetPlanNodeType();
+  const bool has_child = node.GetChildrenSize() > 0;
+  switch (type) {
+    case planner::PlanNodeType::SEQSCAN:
+      ProduceSeqScan(static_cast<const planner::SeqScanPlanNode &>(node), consume);
+      return;
+    case planner::PlanNodeType::PROJECTION:
+      if (has_child) ProduceProjection(static_cast<const planner::ProjectionPlanNode &>(node), consume);
+      break;
+    case planner::PlanNodeType::LIMIT:
+      if (has_child) {
+        const auto &limit = static_cast<const planner::LimitPlanNode &>(node);
+        ProduceLimit(*node.GetChild(0), limit.GetLimit(), limit.GetOffset(), consume);
+      }
+      break;
+    case planner::PlanNodeType::AGGREGATE:
+      if (has_child) ProduceAggregate(static_cast<const planner::AggregatePlanNode &>(node), consume);
+      break;
+    case planner::PlanNodeType::ORDERBY:
+      if (has_child) ProduceOrderBy(static_cast<const planner::OrderByPlanNode &>(node), consume);
+      break;
+    case planner::PlanNodeType::HASHJOIN:
+      if (node.GetChildrenSize() == 2) {
+        ProduceHashJoin(static_cast<const planner::HashJoinPlanNode &>(node), consume);
+      } else {
+        Unsupported("hash join without two children");
+      }
+      return;
+    case planner::PlanNodeType::HASH:
+      // The join above computes the keys itself, a hash node only passes its child's rows on
+      if (has_child) Produce(*node.GetChild(0), consume);
+      break;
+    case planner::PlanNodeType::INSERT:
+    case planner::PlanNodeType::UPDATE:
+    case planner::PlanNodeType::DELETE:
+      // There are no builtins to write tuples to a table and maintain its indexes from TPL
+      Unsupported("modifying plan node of type " + std::to_string(static_cast<int>(type)));
+      return;
+    default:
+      Unsupported("plan node of type " + std::to_string(static_cast<int>(type)));
+      return;
+  }
+  if (!has_child) {
+    Unsupported("plan node of type " + std::to_string(static_cast<int>(type)) + " without a child");
+  }
+}
+
+void Compiler::ProduceSeqScan(const planner::SeqScanPlanNode &node, const Consumer &consume) {
+  const auto table_oid = node.GetTableOid();
+  const auto table = accessor_->GetTable(table_oid);
+  if (table == nullptr) {
+    Unsupported("scan of unknown table " + std::to_string(!table_oid));
+    return;
+  }
+  scanned_tables_.push_back(table_oid);
+  const auto &schema = accessor_->GetSchema(table_oid);
+  const auto &output_schema = *node.GetOutputSchema();
+  const auto predicate = node.GetScanPredicate();
+
+  // Read the columns the scan outputs and those its predicate refers to
+  std::vector<catalog::col_oid_t> col_oids;
+  for (const auto &column : output_schema.GetColumns()) {
+    col_oids.push_back(column.GetOid());
+  }
+  for (const auto &target : output_schema.GetTargets()) {
+    CollectColumnOids(*target.GetColumn().GetExpression(), &col_oids);
+  }
+  if (predicate != nullptr) {
+    CollectColumnOids(*predicate, &col_oids);
+  }
+  std::sort(col_oids.begin(), col_oids.end());
+  col_oids.erase(std::unique(col_oids.begin(), col_oids.end()), col_oids.end());
+  col_oids.erase(std::remove_if(col_oids.begin(), col_oids.end(),
+                                [&](catalog::col_oid_t oid) {
+                                  const auto &columns = schema.GetColumns();
+                                  return std::none_of(columns.begin(), columns.end(),
+                                                      [&](const auto &column) { return column.Oid() == oid; });
+                                }),
+                 col_oids.end());
+  // A scan must read some column to iterate over the table's tuples
+  if (col_oids.empty()) col_oids.push_back(schema.GetColumns()[0].Oid());
+  const auto projection_map = table->ProjectionMapForOids(col_oids);
+
+  const auto tvi = NewName("tvi");
+  const auto oids = NewName("oids");
+  const auto pci = NewName("pci");
+  Line("var " + tvi + ": TableVectorIterator");
+  Line("var " + oids + ": [" + std::to_string(col_oids.size()) + "]uint32");
+  for (uint32_t i = 0; i < col_oids.size(); i++) {
+    Line(oids + "[" + std::to_string(i) + "] = " + std::to_string(!col_oids[i]));
+  }
+  Line("@tableIterInit(&" + tvi + ", execCtx, " + std::to_string(!table_oid) + ", " + oids + ")");
+  // The consumers of the scan's rows may attach dynamic filters to it, which are only known once they are generated
+  const auto pipeline = pipeline_stack_.size() - 1;
+  scan_hooks_[tvi];
+  const auto scan_loop = OpenLoop("", "@tableIterAdvance(&" + tvi + ")", "");
+  Line("var " + pci + " = @tableIterGetPCI(&" + tvi + ")");
+
+  // Comparisons of non-nullable integer columns with constants are evaluated on the whole vector, the rest of the
+  // predicate on each tuple that passes them
+  std::vector<common::ManagedPointer<parser::AbstractExpression>> conjuncts, residual;
+  if (predicate != nullptr) SplitConjuncts(predicate, &conjuncts);
+  bool filtered = false;
+  for (const auto &conjunct : conjuncts) {
+    auto type = conjunct->GetExpressionType();
+    if (FilterBuiltin(type) == nullptr || conjunct->GetChildrenSize() != 2) {
+      residual.push_back(conjunct);
+      continue;
+    }
+    auto column = conjunct->GetChild(0);
+    auto constant = conjunct->GetChild(1);
+    if (column->GetExpressionType() != parser::ExpressionType::COLUMN_VALUE) {
+      std::swap(column, constant);
+      type = MirrorComparison(type);
+    }
+    int64_t value;
+    if (column->GetExpressionType() != parser::ExpressionType::COLUMN_VALUE ||
+        constant->GetExpressionType() != parser::ExpressionType::VALUE_CONSTANT ||
+        !PeekInteger(constant.CastManagedPointerTo<parser::ConstantValueExpression>()->GetValue(), &value)) {
+      residual.push_back(conjunct);
+      continue;
+    }
+    const auto oid = column.CastManagedPointerTo<parser::ColumnValueExpression>()->GetColumnOid();
+    if (projection_map.count(oid) == 0) {
+      residual.push_back(conjunct);
+      continue;
+    }
+    const auto &column_def = schema.GetColumn(oid);
+    if (!IsIntegerType(column_def.Type()) || column_def.Nullable() || value < 0 || !FitsIn(value, column_def.Type())) {
+      residual.push_back(conjunct);
+      continue;
+    }
+    Line(std::string(FilterBuiltin(type)) + "(" + pci + ", " + std::to_string(projection_map.at(oid)) + ", " +
+         std::to_string(static_cast<int>(column_def.Type())) + ", " + std::to_string(value) + ")");
+    filtered = true;
+  }
+
+  // The loop over the vector depends on whether any filter is attached, so it is emitted once the consumers are
+  const auto loop_pos = pipeline_stack_[pipeline].body_.size();
+  const auto loop_depth = pipeline_stack_[pipeline].depth_++;
+  Row columns;
+  for (const auto oid : col_oids) {
+    const auto &column = schema.GetColumn(oid);
+    Value value;
+    std::string getter;
+    switch (column.Type()) {
+      case type::TypeId::TINYINT:
+        getter = "@pciGetTinyInt";
+        break;
+      case type::TypeId::SMALLINT:
+        getter = "@pciGetSmallInt";
+        break;
+      case type::TypeId::INTEGER:
+        getter = "@pciGetInt";
+        break;
+      case type::TypeId::BIGINT:
+        getter = "@pciGetBigInt";
+        break;
+      case type::TypeId::DECIMAL:
+        getter = "@pciGetDouble";
+        value.type_ = SqlType::Real;
+        break;
+      default:
+        Unsupported("scan of a column of type " + type::TypeUtil::TypeIdToString(column.Type()));
+        return;
+    }
+    if (column.Nullable()) getter += "Null";
+    value.expr_ = NewName("col");
+    value.nullable_ = column.Nullable();
+    value.oid_ = oid;
+    value.table_oid_ = table_oid;
+    value.scan_ = tvi;
+    value.scan_col_idx_ = projection_map.at(oid);
+    value.scan_col_type_ = column.Type();
+    Line("var " + value.expr_ + " = " + getter + "(" + pci + ", " + std::to_string(projection_map.at(oid)) + ")");
+    columns.push_back(value);
+  }
+  for (const auto &conjunct : residual) {
+    OpenIf(CompileExpression(*conjunct, {&columns}));
+  }
+  consume(ComputeOutput(output_schema, {&columns}));
+  for (uint32_t i = 0; i < residual.size(); i++) {
+    Close();
+  }
+
+  // Dynamic filters leave the vector filtered
+  const auto hooks = std::move(scan_hooks_[tvi]);
+  scan_hooks_.erase(tvi);
+  filtered |= !hooks.empty();
+  const auto vector_loop =
+      filtered ? LoopHeader("", "@pciHasNextFiltered(" + pci + ")", "@pciAdvanceFiltered(" + pci + ")")
+               : LoopHeader("", "@pciHasNext(" + pci + ")", "@pciAdvance(" + pci + ")");
+  pipeline_stack_[pipeline].body_.insert(loop_pos, std::string(2 * loop_depth, ' ') + vector_loop + "\n");
+
+  Close();
+  Line(filtered ? "@pciResetFiltered(" + pci + ")" : "@pciReset(" + pci + ")");
+  CloseLoop(scan_loop);
+  std::string hook_lines;
+  for (const auto &hook : hooks) {
+    hook_lines += std::string(2 * scan_loop.depth_, ' ') + hook + "\n";
+  }
+  pipeline_stack_[pipeline].body_.insert(scan_loop.pos_, hook_lines);
+  Line("@tableIterClose(&" + tvi + ")");
+}
+
+void Compiler::ProduceProjection(const planner::ProjectionPlanNode &node, const Consumer &consume) {
+  Produce(*node.GetChild(0),
+          [&](const Row &row) { consume(ComputeOutput(*node.GetOutputSchema(), {&row})); });
+}
+
+void Compiler::ProduceLimit(const planner::AbstractPlanNode &node, const uint64_t limit, const uint64_t offset,
+                            const Consumer &consume) {
+  Produce(node, [&](const Row &row) { ConsumeLimited(limit, offset, row, consume); });
+}
+
+void Compiler::ConsumeLimited(const uint64_t limit, const uint64_t offset, const Row &row, const Consumer &consume) {
+  constexpr uint64_t max_literal = std::numeric_limits<int32_t>::max();
+  if (offset > max_literal) {
+    Unsupported("offset " + std::to_string(offset));
+    return;
+  }
+  // The number of rows seen so far
+  const auto count = AddStateField(NewName("limitCount"), "int64");
+  set_up_.push_back(count + " = 0");
+  Line(count + " = " + count + " + 1");
+  std::string condition = count + " > " + std::to_string(offset);
+  if (limit <= max_literal - offset) {
+    condition += " and " + count + " <= " + std::to_string(offset + limit);
+    // The loops feeding the limit stop once it has all its rows
+    pipeline_stack_.back().stop_.push_back(count + " < " + std::to_string(offset + limit));
+  }
+  Open("if (" + condition + ") {");
+  // Every row must be counted, so no dynamic filter may drop rows of the scans below the limit
+  Row limited = row;
+  for (auto &value : limited) {
+    value.scan_.clear();
+  }
+  consume(limited);
+  Close();
+}
+
+void Compiler::ProduceAggregate(const planner::AggregatePlanNode &node, const Consumer &consume) {
+  if (node.GetGroupByTerms().empty()) {
+    ProducePlainAggregate(node, consume);
+  } else {
+    ProduceHashAggregate(node, consume);
+  }
+}
+
+void Compiler::ProducePlainAggregate(const planner::AggregatePlanNode &node, const Consumer &consume) {
+  const auto &terms = node.GetAggregateTerms();
+
+  // The aggregators live in the state, updated by the input's pipeline
+  std::vector<std::string> aggregators(terms.size());
+  Row results(terms.size());
+  BeginPipeline();
+  Produce(*node.GetChild(0), [&](const Row &row) {
+    for (uint32_t i = 0; i < terms.size(); i++) {
+      const auto input = AggregateInput(*terms[i], {&row});
+      aggregators[i] = AddStateField(NewName("agg"), AggregatorType(*terms[i], input.type_, &results[i]));
+      set_up_.push_back("@aggInit(&" + aggregators[i] + ")");
+      const auto input_var = NewName("aggInput");
+      Line("var " + input_var + " = " + input.expr_);
+      Line("@aggAdvance(&" + aggregators[i] + ", &" + input_var + ")");
+    }
+  });
+  EndPipeline({});
+
+  for (uint32_t i = 0; i < terms.size(); i++) {
+    results[i].expr_ = "@aggResult(&" + aggregators[i] + ")";
+  }
+  const Row group_by;
+  const auto having = node.GetHavingClausePredicate();
+  if (having != nullptr) OpenIf(CompileExpression(*having, {&group_by, &results}));
+  consume(ComputeOutput(*node.GetOutputSchema(), {&group_by, &results}, &results));
+  if (having != nullptr) Close();
+}
+
+void Compiler::ProduceHashAggregate(const planner::AggregatePlanNode &node, const Consumer &consume) {
+  const auto &group_by_terms = node.GetGroupByTerms();
+  const auto &terms = node.GetAggregateTerms();
+  const auto payload = NewName("AggPayload");
+  const auto values = NewName("AggValues");
+  const auto key_check = NewName("aggKeyCheck");
+  const auto table = AddStateField(NewName("aggTable"), "AggregationHashTable");
+  set_up_.push_back("@aggHTInit(&" + table + ", @execCtxGetMem(execCtx), @sizeOf(" + payload + "))");
+  tear_down_.push_back("@aggHTFree(&" + table + ")");
+
+  // The input's pipeline finds or creates the group of each tuple and advances its aggregators. If the statistics bound
+  // a single integer key to a small domain, the groups are kept in a direct-mapped table instead. Keys outside of the
+  // domain, which the statistics may have missed, still go to the hash table.
+  Row keys;
+  Row results(terms.size());
+  std::string dm_table;
+  BeginPipeline();
+  Produce(*node.GetChild(0), [&](const Row &row) {
+    Row inputs;
+    std::vector<std::string> aggregators;
+    for (const auto &term : group_by_terms) {
+      keys.push_back(CompileExpression(*term, {&row}));
+      if (keys.back().nullable_ || keys.back().type_ == SqlType::Boolean) {
+        Unsupported("grouping by a nullable or boolean value");
+      }
+    }
+    for (uint32_t i = 0; i < terms.size(); i++) {
+      inputs.push_back(AggregateInput(*terms[i], {&row}));
+      aggregators.push_back(AggregatorType(*terms[i], inputs.back().type_, &results[i]));
+    }
+    if (!unsupported_reason_.empty()) return;
+
+    std::string payload_decl = "struct " + payload + " {\n";
+    std::string values_decl = "struct " + values + " {\n";
+    std::string key_check_fn = "fun " + key_check + "(payload: *" + payload + ", values: *" + values + ") -> bool {\n";
+    key_check_fn += "  return ";
+    for (uint32_t i = 0; i < keys.size(); i++) {
+      const auto field = "g" + std::to_string(i);
+      payload_decl += "  " + field + ": " + TypeName(keys[i].type_) + "\n";
+      values_decl += "  " + field + ": " + TypeName(keys[i].type_) + "\n";
+      key_check_fn += std::string(i == 0 ? "" : " and ") + "@sqlToBool(payload." + field + " == values." + field + ")";
+    }
+    for (uint32_t i = 0; i < terms.size(); i++) {
+      payload_decl += "  a" + std::to_string(i) + ": " + aggregators[i] + "\n";
+      values_decl += "  v" + std::to_string(i) + ": " + TypeName(inputs[i].type_) + "\n";
+    }
+    structs_.push_back(payload_decl + "}\n");
+    structs_.push_back(values_decl + "}\n");
+    functions_.push_back(key_check_fn + "\n}\n");
+
+    int64_t min_key = 0;
+    int64_t max_key = 0;
+    if (keys.size() == 1 && SmallKeyDomain(keys[0], &min_key, &max_key)) {
+      dm_table = AddStateField(NewName("dmAggTable"), "DirectMappedAggregationTable");
+      set_up_.push_back("@dmAggTableInit(&" + dm_table + ", @execCtxGetMem(execCtx), @sizeOf(" + payload + "), " +
+                        std::to_string(min_key) + ", " + std::to_string(max_key) + ")");
+      tear_down_.push_back("@dmAggTableFree(&" + dm_table + ")");
+    }
+
+    const auto vals = NewName("aggValues");
+    const auto hash = NewName("aggHash");
+    const auto agg = NewName("aggPayload");
+    Line("var " + vals + ": " + values);
+    for (uint32_t i = 0; i < keys.size(); i++) {
+      Line(vals + ".g" + std::to_string(i) + " = " + keys[i].expr_);
+    }
+    for (uint32_t i = 0; i < terms.size(); i++) {
+      Line(vals + ".v" + std::to_string(i) + " = " + inputs[i].expr_);
+    }
+    // Emit the code creating the group if the lookup didn't find it
+    const auto find_group = [&](const std::string &lookup, const std::string &insert) {
+      Line(agg + " = @ptrCast(*" + payload + ", " + lookup + ")");
+      Open("if (" + agg + " == nil) {");
+      Line(agg + " = @ptrCast(*" + payload + ", " + insert + ")");
+      for (uint32_t i = 0; i < keys.size(); i++) {
+        Line(agg + ".g" + std::to_string(i) + " = " + vals + ".g" + std::to_string(i));
+      }
+      for (uint32_t i = 0; i < terms.size(); i++) {
+        Line("@aggInit(&" + agg + ".a" + std::to_string(i) + ")");
+      }
+      Close();
+    };
+    Line("var " + agg + ": *" + payload);
+    if (!dm_table.empty()) {
+      Open("if (@dmAggTableInDomain(&" + dm_table + ", " + vals + ".g0)) {");
+      find_group("@dmAggTableLookup(&" + dm_table + ", " + vals + ".g0)",
+                 "@dmAggTableInsert(&" + dm_table + ", " + vals + ".g0)");
+      pipeline_stack_.back().depth_--;
+      Open("} else {");
+    }
+    std::string hash_call = "@hash(";
+    for (uint32_t i = 0; i < keys.size(); i++) {
+      hash_call += std::string(i == 0 ? "" : ", ") + vals + ".g" + std::to_string(i);
+    }
+    Line("var " + hash + " = " + hash_call + ")");
+    find_group("@aggHTLookup(&" + table + ", " + hash + ", " + key_check + ", &" + vals + ")",
+               "@aggHTInsert(&" + table + ", " + hash + ")");
+    if (!dm_table.empty()) Close();
+    for (uint32_t i = 0; i < terms.size(); i++) {
+      Line("@aggAdvance(&" + agg + ".a" + std::to_string(i) + ", &" + vals + ".v" + std::to_string(i) + ")");
+    }
+  });
+  EndPipeline({});
+
+  // This pipeline iterates over the groups, those of the direct-mapped table first
+  const auto iter = NewName("aggIter");
+  const auto dm_iter = NewName("dmAggIter");
+  const auto group = NewName("aggGroup");
+  Line("var " + iter + ": AggregationHashTableIterator");
+  std::string init = "@aggHTIterInit(&" + iter + ", &" + table + ")";
+  std::string condition = "@aggHTIterHasNext(&" + iter + ")";
+  std::string step = "@aggHTIterNext(&" + iter + ")";
+  if (!dm_table.empty()) {
+    // Both iterators are advanced in the loop's body, so that the rows are consumed in one place
+    Line("var " + dm_iter + ": DirectMappedAggregationTableIterator");
+    Line("@dmAggTableIterInit(&" + dm_iter + ", &" + dm_table + ")");
+    Line(init);
+    init.clear();
+    condition = "(@dmAggTableIterHasNext(&" + dm_iter + ") or " + condition + ")";
+    step.clear();
+  }
+  const auto loop = OpenLoop(init, condition, step);
+  if (dm_table.empty()) {
+    Line("var " + group + " = @ptrCast(*" + payload + ", @aggHTIterGetRow(&" + iter + "))");
+  } else {
+    Line("var " + group + ": *" + payload);
+    Open("if (@dmAggTableIterHasNext(&" + dm_iter + ")) {");
+    Line(group + " = @ptrCast(*" + payload + ", @dmAggTableIterGetRow(&" + dm_iter + "))");
+    Line("@dmAggTableIterNext(&" + dm_iter + ")");
+    pipeline_stack_.back().depth_--;
+    Open("} else {");
+    Line(group + " = @ptrCast(*" + payload + ", @aggHTIterGetRow(&" + iter + "))");
+    Line("@aggHTIterNext(&" + iter + ")");
+    Close();
+  }
+  for (uint32_t i = 0; i < keys.size(); i++) {
+    keys[i].expr_ = group + ".g" + std::to_string(i);
+  }
+  for (uint32_t i = 0; i < terms.size(); i++) {
+    results[i].expr_ = "@aggResult(&" + group + ".a" + std::to_string(i) + ")";
+  }
+  Row group_row = keys;
+  group_row.insert(group_row.end(), results.begin(), results.end());
+  const auto having = node.GetHavingClausePredicate();
+  if (having != nullptr) OpenIf(CompileExpression(*having, {&keys, &results}));
+  consume(ComputeOutput(*node.GetOutputSchema(), {&keys, &results}, &group_row));
+  if (having != nullptr) Close();
+  CloseLoop(loop);
+  Line("@aggHTIterClose(&" + iter + ")");
+  if (!dm_table.empty()) Line("@dmAggTableIterClose(&" + dm_iter + ")");
+}
+
+void Compiler::ProduceOrderBy(const planner::OrderByPlanNode &node, const Consumer &consume) {
+  const auto sort_row = NewName("SortRow");
+  const auto compare = NewName("sortCompare");
+  const auto sorter = AddStateField(NewName("sorter"), "Sorter");
+  set_up_.push_back("@sorterInit(&" + sorter + ", @execCtxGetMem(execCtx), " + compare + ", @sizeOf(" + sort_row +
+                    "))");
+  tear_down_.push_back("@sorterFree(&" + sorter + ")");
+
+  // With a limit, the input's pipeline only keeps the top K = offset + limit rows in the sorter, as a heap. If the
+  // leading sort key is an integer column of the scan feeding the pipeline, the heap's K-th key is also used as a
+  // filter on that scan, which drops the rows that can't make it into the top K before they reach the sorter.
+  constexpr uint64_t max_top_k = std::numeric_limits<int32_t>::max();
+  const bool top_k = node.HasLimit() && node.GetLimit() > 0 && node.GetLimit() <= max_top_k &&
+                     node.GetOffset() <= max_top_k - node.GetLimit();
+
+  // The input's pipeline materializes its rows into the sorter
+  Row stored;
+  BeginPipeline();
+  Produce(*node.GetChild(0), [&](const Row &row) {
+    stored = row;
+    DeclareRowStruct(sort_row, row, "c");
+
+    std::string compare_fn = "fun " + compare + "(lhs: *" + sort_row + ", rhs: *" + sort_row + ") -> int32 {\n";
+    for (const auto &[oid, ordering] : node.GetSortKeys()) {
+      const auto key = std::find_if(row.begin(), row.end(), [&](const Value &value) { return value.oid_ == oid; });
+      if (key == row.end() || key->nullable_ || key->type_ == SqlType::Boolean) {
+        Unsupported("sort on a missing, nullable or boolean column");
+        return;
+      }
+      const auto field = "c" + std::to_string(key - row.begin());
+      const bool asc = ordering == optimizer::OrderByOrderingType::ASC;
+      compare_fn += "  if (lhs." + field + " < rhs." + field + ") {\n    return " + (asc ? "-1" : "1") + "\n  }\n";
+      compare_fn += "  if (lhs." + field + " > rhs." + field + ") {\n    return " + (asc ? "1" : "-1") + "\n  }\n";
+    }
+    functions_.push_back(compare_fn + "  return 0\n}\n");
+
+    const auto insert = NewName("sortRow");
+    if (!top_k) {
+      Line("var " + insert + " = @ptrCast(*" + sort_row + ", @sorterInsert(&" + sorter + "))");
+      for (uint32_t i = 0; i < row.size(); i++) {
+        Line(insert + ".c" + std::to_string(i) + " = " + row[i].expr_);
+      }
+      return;
+    }
+
+    const auto &[leading_oid, leading_ordering] = node.GetSortKeys()[0];
+    const auto key =
+        std::find_if(row.begin(), row.end(), [&](const Value &value) { return value.oid_ == leading_oid; });
+    const auto type = key->scan_col_type_;
+    if (type == type::TypeId::SMALLINT || type == type::TypeId::INTEGER || type == type::TypeId::BIGINT) {
+      const auto threshold = NewName("topKThreshold");
+      const auto key_idx = std::to_string(key - row.begin());
+      if (AddScanHook(*key, "@tableIterSetTopKThreshold(&" + key->scan_ + ", &state." + threshold + ", " +
+                                std::to_string(key->scan_col_idx_) + ", " + std::to_string(static_cast<int>(type)) +
+                                ")")) {
+        AddStateField(threshold, "TopKThreshold");
+        const bool asc = leading_ordering == optimizer::OrderByOrderingType::ASC;
+        set_up_.push_back("@topKThresholdInit(&state." + threshold + ", " + (asc ? "true" : "false") + ")");
+        set_up_.push_back("@sorterSetTopKThreshold(&" + sorter + ", &state." + threshold + ", @offsetOf(" + sort_row +
+                          ", c" + key_idx + "))");
+      }
+    }
+
+    const auto k = NewName("topK");
+    Line("var " + k + ": uint64 = " + std::to_string(node.GetOffset() + node.GetLimit()));
+    Line("var " + insert + " = @ptrCast(*" + sort_row + ", @sorterInsertTopK(&" + sorter + ", " + k + "))");
+    for (uint32_t i = 0; i < row.size(); i++) {
+      Line(insert + ".c" + std::to_string(i) + " = " + row[i].expr_);
+    }
+    Line("@sorterInsertTopKFinish(&" + sorter + ", " + k + ")");
+  });
+  EndPipeline({"@sorterSort(&" + sorter + ")"});
+
+  // This pipeline iterates over the sorted rows
+  const auto iter = NewName("sortIter");
+  const auto sorted = NewName("sortRow");
+  Line("var " + iter + ": SorterIterator");
+  const auto loop = OpenLoop("@sorterIterInit(&" + iter + ", &" + sorter + ")", "@sorterIterHasNext(&" + iter + ")",
+                             "@sorterIterNext(&" + iter + ")");
+  Line("var " + sorted + " = @ptrCast(*" + sort_row + ", @sorterIterGetRow(&" + iter + "))");
+  for (uint32_t i = 0; i < stored.size(); i++) {
+    stored[i].expr_ = sorted + ".c" + std::to_string(i);
+  }
+  const auto emit = [&](const Row &row) { consume(ComputeOutput(*node.GetOutputSchema(), {&row})); };
+  if (node.HasLimit()) {
+    ConsumeLimited(node.GetLimit(), node.GetOffset(), stored, emit);
+  } else {
+    emit(stored);
+  }
+  CloseLoop(loop);
+  Line("@sorterIterClose(&" + iter + ")");
+}
+
+void Compiler::ProduceHashJoin(const planner::HashJoinPlanNode &node, const Consumer &consume) {
+  const auto &left_keys = node.GetLeftHashKeys();
+  const auto &right_keys = node.GetRightHashKeys();
+  if (node.GetLogicalJoinType() != planner::LogicalJoinType::INNER) {
+    Unsupported("hash join other than an inner join");
+    return;
+  }
+  if (left_keys.empty() || left_keys.size() != right_keys.size()) {
+    Unsupported("hash join without matching keys");
+    return;
+  }
+
+  const auto build_row = NewName("BuildRow");
+  const auto probe_row = NewName("ProbeRow");
+  const auto key_check = NewName("joinKeyCheck");
+  const auto probe_fn = NewName("joinProbe");
+  const auto table = AddStateField(NewName("joinTable"), "JoinHashTable");
+  set_up_.push_back("@joinHTInit(&" + table + ", @execCtxGetMem(execCtx), @sizeOf(" + build_row + "))");
+  set_up_.push_back("@joinHTEnableSpilling(&" + table + ")");
+  tear_down_.push_back("@joinHTFree(&" + table + ")");
+
+  // The right child's pipeline materializes its rows into the hash table, built once it's done
+  Row build;
+  BeginPipeline();
+  Produce(*node.GetChild(1), [&](const Row &row) {
+    build = row;
+    DeclareRowStruct(build_row, row, "c");
+    const auto hash = NewName("joinHash");
+    const auto insert = NewName("buildRow");
+    std::string hash_call = "@hash(";
+    for (uint32_t i = 0; i < right_keys.size(); i++) {
+      const auto key = NewName("joinKey");
+      Line("var " + key + " = " + CompileExpression(*right_keys[i], {nullptr, &row}).expr_);
+      hash_call += std::string(i == 0 ? "" : ", ") + key;
+    }
+    Line("var " + hash + " = " + hash_call + ")");
+    Line("var " + insert + " = @ptrCast(*" + build_row + ", @joinHTInsert(&" + table + ", " + hash + "))");
+    for (uint32_t i = 0; i < row.size(); i++) {
+      Line(insert + ".c" + std::to_string(i) + " = " + row[i].expr_);
+    }
+  });
+  EndPipeline({"@joinHTBuild(&" + table + ")"});
+  const auto build_pipeline = pipelines_.size() - 1;
+
+  // The left child's pipeline probes the table with each of its rows. The matches of a probe row are found and
+  // consumed by a function of their own, which the pipeline calls for rows whose build partition is in memory. The
+  // others are deferred, and joined by the same function once the pipeline is done and the partitions are read back.
+  const auto probe_pipeline = pipeline_stack_.size() - 1;
+  Produce(*node.GetChild(0), [&](const Row &row) {
+    // The keys of the build side, evaluated over a row in the table
+    Row build_fields = build;
+    for (uint32_t i = 0; i < build_fields.size(); i++) {
+      build_fields[i].expr_ = "build.c" + std::to_string(i);
+    }
+    Row probe_keys;
+    std::string key_check_fn = "fun " + key_check + "(execCtx: *ExecutionContext, probe: *" + probe_row +
+                               ", build: *" + build_row + ") -> bool {\n  return ";
+    for (uint32_t i = 0; i < left_keys.size(); i++) {
+      probe_keys.push_back(CompileExpression(*left_keys[i], {&row, nullptr}));
+      const auto build_key = CompileExpression(*right_keys[i], {nullptr, &build_fields});
+      if (probe_keys.back().type_ != build_key.type_ || build_key.type_ == SqlType::Boolean) {
+        Unsupported("hash join on keys of different or boolean types");
+        return;
+      }
+      key_check_fn += std::string(i == 0 ? "" : " and ") + "@sqlToBool(probe.k" + std::to_string(i) +
+                      " == " + build_key.expr_ + ")";
+    }
+    functions_.push_back(key_check_fn + "\n}\n");
+
+    // A join on an integer column of the scan feeding the probe side filters the scan by a Bloom filter over the
+    // hashes of the build keys, which drops most probe rows without a match before they are hashed and probed. The
+    // filter is built once, by the build pipeline, and the scans only attach it.
+    const auto type = probe_keys[0].scan_col_type_;
+    if (probe_keys.size() == 1 && (type == type::TypeId::TINYINT || type == type::TypeId::SMALLINT ||
+                                   type == type::TypeId::INTEGER || type == type::TypeId::BIGINT)) {
+      if (AddScanHook(probe_keys[0], "@tableIterAddRuntimeFilter(&" + probe_keys[0].scan_ + ", &" + table + ", " +
+                                         std::to_string(probe_keys[0].scan_col_idx_) + ", " +
+                                         std::to_string(static_cast<int>(type)) + ")")) {
+        AddFinishStep(build_pipeline, "@joinHTBuildBloomFilter(&" + table + ")");
+      }
+    }
+
+    // The probe row carries the keys and the whole row of the left child, since it may be read back from disk
+    std::string probe_decl = "struct " + probe_row + " {\n";
+    for (uint32_t i = 0; i < probe_keys.size(); i++) {
+      probe_decl += "  k" + std::to_string(i) + ": " + TypeName(probe_keys[i].type_) + "\n";
+    }
+    for (uint32_t i = 0; i < row.size(); i++) {
+      probe_decl += "  p" + std::to_string(i) + ": " + TypeName(row[i].type_) + "\n";
+    }
+    structs_.push_back(probe_decl + "}\n");
+
+    const auto probe = NewName("probeRow");
+    const auto hash = NewName("joinHash");
+    Line("var " + probe + ": " + probe_row);
+    std::string hash_call = "@hash(";
+    for (uint32_t i = 0; i < probe_keys.size(); i++) {
+      Line(probe + ".k" + std::to_string(i) + " = " + probe_keys[i].expr_);
+      hash_call += std::string(i == 0 ? "" : ", ") + probe + ".k" + std::to_string(i);
+    }
+    for (uint32_t i = 0; i < row.size(); i++) {
+      Line(probe + ".p" + std::to_string(i) + " = " + row[i].expr_);
+    }
+    Line("var " + hash + " = " + hash_call + ")");
+    Open("if (@joinHTIsSpilled(&" + table + ", " + hash + ")) {");
+    Line("@joinHTDeferProbe(&" + table + ", " + hash + ", &" + probe + ", @sizeOf(" + probe_row + "))");
+    pipeline_stack_.back().depth_--;
+    Open("} else {");
+    Line(probe_fn + "(state, &" + table + ", " + hash + ", &" + probe + ")");
+    Close();
+
+    // The probe function, generated like a pipeline of its own
+    const auto iter = NewName("joinIter");
+    const auto match = NewName("buildRow");
+    pipeline_stack_.push_back(Pipeline{"", 1, {}, {}, {}});
+    Line("var execCtx = state.execCtx");
+    Line("var " + iter + ": JoinHashTableIterator");
+    const auto loop = OpenLoop("@joinHTIterInit(&" + iter + ", table, hash)",
+                               "@joinHTIterHasNext(&" + iter + ", " + key_check + ", execCtx, probe)", "");
+    Line("var " + match + " = @ptrCast(*" + build_row + ", @joinHTIterGetRow(&" + iter + "))");
+    Row left = row;
+    for (uint32_t i = 0; i < left.size(); i++) {
+      left[i].expr_ = "probe.p" + std::to_string(i);
+    }
+    Row right = build;
+    for (uint32_t i = 0; i < right.size(); i++) {
+      right[i].expr_ = match + ".c" + std::to_string(i);
+    }
+    const auto predicate = node.GetJoinPredicate();
+    if (predicate != nullptr) OpenIf(CompileExpression(*predicate, {&left, &right}));
+    consume(ComputeOutput(*node.GetOutputSchema(), {&left, &right}));
+    if (predicate != nullptr) Close();
+    CloseLoop(loop);
+    Line("@joinHTIterClose(&" + iter + ")");
+    functions_.push_back("fun " + probe_fn + "(state: *State, table: *JoinHashTable, hash: uint64, probe: *" +
+                         probe_row + ") -> nil {\n" + pipeline_stack_.back().body_ + "}\n");
+    // A LIMIT above the join also ends the loops of the probe pipeline, which also depends on any pipeline ended by
+    // the operators above the join
+    auto stop = std::move(pipeline_stack_.back().stop_);
+    auto dependencies = std::move(pipeline_stack_.back().dependencies_);
+    pipeline_stack_.pop_back();
+    pipeline_stack_.back().stop_.insert(pipeline_stack_.back().stop_.end(), stop.begin(), stop.end());
+    pipeline_stack_.back().dependencies_.insert(pipeline_stack_.back().dependencies_.end(), dependencies.begin(),
+                                                dependencies.end());
+  });
+  pipeline_stack_[probe_pipeline].finish_.push_back("@joinHTJoinSpilled(&" + table + ", state, " + probe_fn + ")");
+}
+
+void Compiler::ConsumeOutput(const Row &row) {
+  if (row.size() != output_types_.size()) {
+    Unsupported("result rows don't match the output schema");
+    return;
+  }
+  const auto out = NewName("out");
+  Line("var " + out + " = @ptrCast(*OutputRow, @outputAlloc(execCtx))");
+  for (uint32_t i = 0; i < row.size(); i++) {
+    if (row[i].type_ != output_types_[i]) {
+      Unsupported("result column " + std::to_string(i) + " doesn't have the type of the output schema");
+      return;
+    }
+    Line(out + ".c" + std::to_string(i) + " = " + row[i].expr_);
+  }
+  Line("state.numRows = state.numRows + 1");
+}
+
+Compiler::Row Compiler::ComputeOutput(const planner::OutputSchema &schema, const std::vector<const Row *> &inputs,
+                                      const Row *default_row) {
+  const auto &columns = schema.GetColumns();
+  Row row(columns.size());
+  std::vector<bool> computed(columns.size(), false);
+  for (const auto &target : schema.GetTargets()) {
+    if (target.GetOffset() >= columns.size()) continue;
+    auto value = CompileExpression(*target.GetColumn().GetExpression(), inputs);
+    // Compute the expression once, it may be used more than once above
+    const auto var = NewName("expr");
+    Line("var " + var + " = " + value.expr_);
+    value.expr_ = var;
+    row[target.GetOffset()] = value;
+    computed[target.GetOffset()] = true;
+  }
+  for (const auto &[offset, source] : schema.GetDirectMapList()) {
+    const auto &[tuple_idx, value_idx] = source;
+    if (offset >= columns.size() || computed[offset]) continue;
+    if (tuple_idx >= inputs.size() || inputs[tuple_idx] == nullptr || value_idx >= inputs[tuple_idx]->size()) {
+      Unsupported("direct map from a missing column");
+      return row;
+    }
+    row[offset] = (*inputs[tuple_idx])[value_idx];
+    computed[offset] = true;
+  }
+  for (uint32_t i = 0; i < columns.size(); i++) {
+    if (!computed[i]) {
+      if (default_row == nullptr) {
+        row[i] = LookupColumn(columns[i].GetOid(), inputs);
+      } else if (i < default_row->size()) {
+        row[i] = (*default_row)[i];
+      } else {
+        Unsupported("output column " + std::to_string(i) + " without a source");
+      }
+    }
+    row[i].oid_ = columns[i].GetOid();
+  }
+  return row;
+}
+
+Compiler::Value Compiler::CompileExpression(const parser::AbstractExpression &expr,
+                                            const std::vector<const Row *> &inputs) {
+  const auto type = expr.GetExpressionType();
+  switch (type) {
+    case parser::ExpressionType::COLUMN_VALUE:
+      return LookupColumn(static_cast<const parser::ColumnValueExpression &>(expr).GetColumnOid(), inputs);
+    case parser::ExpressionType::VALUE_TUPLE: {
+      const auto &derived = static_cast<const parser::DerivedValueExpression &>(expr);
+      const auto tuple_idx = derived.GetTupleIdx();
+      const auto value_idx = derived.GetValueIdx();
+      if (tuple_idx < 0 || static_cast<size_t>(tuple_idx) >= inputs.size() || inputs[tuple_idx] == nullptr ||
+          value_idx < 0 || static_cast<size_t>(value_idx) >= inputs[tuple_idx]->size()) {
+        Unsupported("derived value of a missing column");
+        return {};
+      }
+      return (*inputs[tuple_idx])[value_idx];
+    }
+    case parser::ExpressionType::VALUE_CONSTANT:
+      return CompileConstant(expr);
+    default:
+      break;
+  }
+
+  Row children;
+  for (const auto &child : expr.GetChildren()) {
+    children.push_back(CompileExpression(*child, inputs));
+  }
+  if (!unsupported_reason_.empty()) return {};
+  const bool nullable = std::any_of(children.begin(), children.end(), [](const Value &v) { return v.nullable_; });
+  const bool boolean = std::all_of(children.begin(), children.end(),
+                                   [](const Value &v) { return v.type_ == SqlType::Boolean; });
+
+  if (const char *op = ComparisonOperator(type); op != nullptr) {
+    if (children.size() != 2 || children[0].type_ != children[1].type_ || children[0].type_ == SqlType::Boolean) {
+      Unsupported("comparison of values of different or boolean types");
+      return {};
+    }
+    return {"(" + children[0].expr_ + " " + op + " " + children[1].expr_ + ")", SqlType::Boolean, nullable};
+  }
+
+  if (const char *op = ArithmeticOperator(type); op != nullptr) {
+    if (children.size() != 2 || children[0].type_ != children[1].type_ || children[0].type_ == SqlType::Boolean) {
+      Unsupported("arithmetic on values of different or boolean types");
+      return {};
+    }
+    // Division by zero produces NULL
+    const bool may_be_null = nullable || type == parser::ExpressionType::OPERATOR_DIVIDE ||
+                             type == parser::ExpressionType::OPERATOR_MOD;
+    return {"(" + children[0].expr_ + " " + op + " " + children[1].expr_ + ")", children[0].type_, may_be_null};
+  }
+
+  switch (type) {
+    case parser::ExpressionType::CONJUNCTION_AND:
+    case parser::ExpressionType::CONJUNCTION_OR: {
+      if (children.size() < 2 || !boolean) break;
+      // A NULL operand is false, which gives the predicate the right outcome as long as it isn't negated
+      const std::string op = type == parser::ExpressionType::CONJUNCTION_AND ? " and " : " or ";
+      std::string conjunction;
+      for (uint32_t i = 0; i < children.size(); i++) {
+        conjunction += (i == 0 ? "" : op) + "@sqlToBool(" + children[i].expr_ + ")";
+      }
+      return {"@boolToSql(" + conjunction + ")", SqlType::Boolean, nullable};
+    }
+    case parser::ExpressionType::OPERATOR_NOT:
+      if (children.size() != 1 || !boolean || nullable) break;
+      return {"@boolToSql(!@sqlToBool(" + children[0].expr_ + "))", SqlType::Boolean, false};
+    case parser::ExpressionType::OPERATOR_IS_NULL:
+    case parser::ExpressionType::OPERATOR_IS_NOT_NULL:
+      // There is no NULL test in TPL, only values that can't be NULL are supported
+      if (children.size() != 1 || nullable) break;
+      return {type == parser::ExpressionType::OPERATOR_IS_NULL ? "@boolToSql(false)" : "@boolToSql(true)",
+              SqlType::Boolean, false};
+    case parser::ExpressionType::OPERATOR_UNARY_MINUS:
+      if (children.size() != 1 || boolean) break;
+      return {std::string("(") + (children[0].type_ == SqlType::Integer ? "@intToSql(0)" : "@floatToSql(0.0)") + " - " +
+                  children[0].expr_ + ")",
+              children[0].type_, nullable};
+    default:
+      break;
+  }
+  Unsupported("expression of type " + parser::ExpressionTypeToString(type, true));
+  return {};
+}
+
+Compiler::Value Compiler::CompileConstant(const parser::AbstractExpression &expr) {
+  const auto value = static_cast<const parser::ConstantValueExpression &>(expr).GetValue();
+  if (value.Null()) {
+    Unsupported("NULL constant");
+    return {};
+  }
+  int64_t integer;
+  if (PeekInteger(value, &integer)) {
+    // TPL integer literals are 32 bits wide
+    if (integer < std::numeric_limits<int32_t>::min() || integer > std::numeric_limits<int32_t>::max()) {
+      Unsupported("integer constant out of range");
+      return {};
+    }
+    return {"@intToSql(" + std::to_string(integer) + ")", SqlType::Integer, false};
+  }
+  switch (value.Type()) {
+    case type::TypeId::BOOLEAN:
+      return {std::string("@boolToSql(") + (type::TransientValuePeeker::PeekBoolean(value) ? "true" : "false") + ")",
+              SqlType::Boolean, false};
+    case type::TypeId::DECIMAL: {
+      std::ostringstream literal;
+      literal << std::fixed << std::setprecision(std::numeric_limits<double>::max_digits10)
+              << type::TransientValuePeeker::PeekDecimal(value);
+      return {"@floatToSql(" + literal.str() + ")", SqlType::Real, false};
+    }
+    default:
+      Unsupported("constant of type " + type::TypeUtil::TypeIdToString(value.Type()));
+      return {};
+  }
+}
+
+Compiler::Value Compiler::LookupColumn(const catalog::col_oid_t oid, const std::vector<const Row *> &inputs) {
+  for (const auto *input : inputs) {
+    if (input == nullptr) continue;
+    for (const auto &value : *input) {
+      if (value.oid_ == oid) return value;
+    }
+  }
+  Unsupported("column " + std::to_string(!oid) + " that no child produces");
+  return {};
+}
+
+Compiler::Value Compiler::AggregateInput(const parser::AggregateExpression &term,
+                                         const std::vector<const Row *> &inputs) {
+  // COUNT(*) counts every row, whatever it's advanced with
+  if (IsCountStar(term)) return {"@intToSql(0)", SqlType::Integer, false};
+  if (term.GetChildrenSize() != 1) {
+    Unsupported("aggregate without exactly one argument");
+    return {};
+  }
+  return CompileExpression(*term.GetChild(0), inputs);
+}
+
+std::string Compiler::AggregatorType(const parser::AggregateExpression &term, const SqlType input_type,
+                                     Value *result) {
+  if (term.IsDistinct()) {
+    Unsupported("DISTINCT aggregate");
+    return "";
+  }
+  const bool real = input_type == SqlType::Real;
+  const auto type = term.GetExpressionType();
+  if (type == parser::ExpressionType::AGGREGATE_COUNT) {
+    *result = {"", SqlType::Integer, false};
+    return IsCountStar(term) ? "CountStarAggregate" : "CountAggregate";
+  }
+  if (input_type == SqlType::Boolean) {
+    Unsupported("aggregate of a boolean value");
+    return "";
+  }
+  // Aggregates other than COUNT are NULL over no rows
+  *result = {"", input_type, true};
+  switch (type) {
+    case parser::ExpressionType::AGGREGATE_SUM:
+      return real ? "RealSumAggregate" : "IntegerSumAggregate";
+    case parser::ExpressionType::AGGREGATE_MIN:
+      return real ? "RealMinAggregate" : "IntegerMinAggregate";
+    case parser::ExpressionType::AGGREGATE_MAX:
+      return real ? "RealMaxAggregate" : "IntegerMaxAggregate";
+    case parser::ExpressionType::AGGREGATE_AVG:
+      result->type_ = SqlType::Real;
+      return real ? "RealAvgAggregate" : "IntegerAvgAggregate";
+    default:
+      Unsupported("aggregate of type " + parser::ExpressionTypeToString(type, true));
+      return "";
+  }
+}
+
+void Compiler::OpenIf(const Value &predicate) {
+  if (predicate.type_ != SqlType::Boolean) {
+    Unsupported("predicate that isn't a boolean");
+  }
+  Open("if (@sqlToBool(" + predicate.expr_ + ")) {");
+}
+
+void Compiler::DeclareRowStruct(const std::string &name, const Row &row, const std::string &field_prefix) {
+  std::string decl = "struct " + name + " {\n";
+  for (uint32_t i = 0; i < row.size(); i++) {
+    decl += "  " + field_prefix + std::to_string(i) + ": " + TypeName(row[i].type_) + "\n";
+  }
+  structs_.push_back(decl + "}\n");
+}
+
+std::string Compiler::AddStateField(const std::string &name, const std::string &type) {
+  state_fields_.push_back(name + ": " + type);
+  return "state." + name;
+}
+
+bool Compiler::AddScanHook(const Value &value, const std::string &statement) {
+  const auto hooks = scan_hooks_.find(value.scan_);
+  if (value.scan_.empty() || hooks == scan_hooks_.end()) {
+    return false;
+  }
+  hooks->second.push_back(statement);
+  return true;
+}
+
+void Compiler::BeginPipeline() { pipeline_stack_.push_back(Pipeline{"", 1, {}, {}, {}}); }
+
+void Compiler::EndPipeline(const std::vector<std::string> &then) {
+  const auto name = NewName("pipeline");
+  auto &pipeline = pipeline_stack_.back();
+  for (const auto &stmt : pipeline.finish_) Line(stmt);
+  for (const auto &stmt : then) Line(stmt);
+  pipelines_.push_back("fun " + name + "(execCtx: *ExecutionContext, state: *State) -> nil {\n" + pipeline.body_ +
+                       "}\n");
+  main_steps_.push_back(name + "(execCtx, &state)");
+  const auto id = static_cast<uint32_t>(pipeline_infos_.size());
+  pipeline_infos_.push_back({name, std::move(pipeline.dependencies_)});
+  pipeline_stack_.pop_back();
+  // The enclosing pipeline reads what this one produced
+  if (!pipeline_stack_.empty()) pipeline_stack_.back().dependencies_.push_back(id);
+}
+
+void Compiler::AddFinishStep(const std::size_t pipeline, const std::string &statement) {
+  // The function of an ended pipeline closes with "}\n", after its last finish step
+  auto &function = pipelines_[pipeline];
+  function.insert(function.size() - 2, "  " + statement + "\n");
+}
+
+void Compiler::Line(const std::string &line) {
+  auto &pipeline = pipeline_stack_.back();
+  pipeline.body_ += std::string(2 * pipeline.depth_, ' ') + line + "\n";
+}
+
+void Compiler::Open(const std::string &line) {
+  Line(line);
+  pipeline_stack_.back().depth_++;
+}
+
+void Compiler::Close() {
+  pipeline_stack_.back().depth_--;
+  Line("}");
+}
+
+std::string Compiler::LoopHeader(const std::string &init, const std::string &condition,
+                                 const std::string &step) const {
+  std::string guarded;
+  for (const auto &stop : pipeline_stack_.back().stop_) {
+    guarded += stop + " and ";
+  }
+  guarded += condition;
+  if (init.empty() && step.empty()) return "for (" + guarded + ") {";
+  return "for (" + init + "; " + guarded + "; " + step + ") {";
+}
+
+Compiler::Loop Compiler::OpenLoop(const std::string &init, const std::string &condition, const std::string &step) {
+  const auto &pipeline = pipeline_stack_.back();
+  Loop loop{pipeline.body_.size(), pipeline.depth_, init, condition, step};
+  Open(LoopHeader(init, condition, step));
+  return loop;
+}
+
+void Compiler::CloseLoop(const Loop &loop) {
+  Close();
+  // Conditions added by the loop's body, e.g. by a LIMIT, end it early
+  auto &body = pipeline_stack_.back().body_;
+  const auto start = loop.pos_ + 2 * loop.depth_;
+  body.replace(start, body.find('\n', start) - start, LoopHeader(loop.init_, loop.condition_, loop.step_));
+}
+
+std::string Compiler::NewName(const std::string &prefix) { return prefix + std::to_string(next_id_++); }
+
+bool Compiler::SmallKeyDomain(const Value &key, int64_t *min_key, int64_t *max_key) const {
+  if (stats_storage_ == nullptr || key.type_ != SqlType::Integer || key.oid_ == catalog::INVALID_COLUMN_OID ||
+      key.table_oid_ == catalog::INVALID_TABLE_OID) {
+    return false;
+  }
+  const auto table_stats = stats_storage_->GetTableStats(db_oid_, key.table_oid_);
+  if (table_stats == nullptr) return false;
+  const auto column_stats = table_stats->GetColumnStats(key.oid_);
+  if (column_stats == nullptr || column_stats->GetHistogramBounds().empty()) return false;
+
+  // The bounds are doubles; domains reaching the limits of int64_t are not worth mapping
+  const double min_bound = std::floor(column_stats->GetHistogramBounds().front());
+  const double max_bound = std::ceil(column_stats->GetHistogramBounds().back());
+  if (!(min_bound > static_cast<double>(std::numeric_limits<int64_t>::min()) &&
+        max_bound < static_cast<double>(std::numeric_limits<int64_t>::max()))) {
+    return false;
+  }
+  *min_key = static_cast<int64_t>(min_bound);
+  *max_key = static_cast<int64_t>(max_bound);
+  return sql::DirectMappedAggregationTable::IsDomainSmallEnough(*min_key, *max_key);
+}
+
+void Compiler::Unsupported(const std::string &reason) {
+  if (unsupported_reason_.empty()) unsupported_reason_ = reason;
+}
+
+const char *Compiler::TypeName(const SqlType type) {
+  switch (type) {
+    case SqlType::Integer:
+      return "Integer";
+    case SqlType::Real:
+      return "Real";
+    default:
+      return "Boolean";
+  }
+}
+
+}  // namespace terrier::execution::compiler
@@ -0,0 +1,136 @@
+#include "execution/compiler/executable_query.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "common/scoped_timer.h"
+#include "common/thread_context.h"
+#include "execution/compiler/compiler.h"
+#include "execution/exec/execution_context.h"
+#include "execution/exec/query_scheduler.h"
+#include "execution/parsing/parser.h"
+#include "execution/parsing/scanner.h"
+#include "execution/sema/sema.h"
+#include "execution/vm/bytecode_generator.h"
+#include "loggers/execution_logger.h"
+#include "metrics/metrics_store.h"
+#include "optimizer/statistics/stats_storage.h"
+
+namespace terrier::execution::compiler {
+
+namespace {
+
+// The number of tuples the scans of a plan read according to the statistics of their tables, or
+// LLVMEngine::K_UNKNOWN_CARDINALITY if a table has none
+uint64_t EstimateCardinality(const std::vector<catalog::table_oid_t> &tables, exec::ExecutionContext *exec_ctx) {
+  const auto stats_storage = exec_ctx->GetStatsStorage();
+  if (stats_storage == nullptr) return vm::LLVMEngine::K_UNKNOWN_CARDINALITY;
+  uint64_t num_tuples = 0;
+  for (const auto table_oid : tables) {
+    const auto table_stats = stats_storage->GetTableStats(exec_ctx->DBOid(), table_oid);
+    if (table_stats == nullptr) return vm::LLVMEngine::K_UNKNOWN_CARDINALITY;
+    num_tuples += table_stats->GetNumRows();
+  }
+  return num_tuples;
+}
+
+}  // namespace
+
+ExecutableQuery::ExecutableQuery(const planner::AbstractPlanNode &plan, exec::ExecutionContext *exec_ctx)
+    : region_("query-ast"),
+      error_region_("query-error"),
+      error_reporter_(&error_region_),
+      ast_ctx_(&region_, &error_reporter_) {
+  Compiler compiler(plan, exec_ctx->GetAccessor(), exec_ctx->DBOid(), exec_ctx->GetStatsStorage());
+  tpl_source_ = compiler.Compile();
+  if (tpl_source_.empty()) return;
+  pipelines_ = compiler.GetPipelines();
+
+  parsing::Scanner scanner(tpl_source_.data(), tpl_source_.length());
+  parsing::Parser parser(&scanner, &ast_ctx_);
+  ast::AstNode *root = parser.Parse();
+  if (!error_reporter_.HasErrors()) {
+    sema::Sema type_check(&ast_ctx_);
+    type_check.Run(root);
+  }
+  if (error_reporter_.HasErrors()) {
+    EXECUTION_LOG_ERROR("Errors in the TPL compiled from a plan:\n{}\n{}", error_reporter_.SerializeErrors(),
+                        tpl_source_);
+    return;
+  }
+
+  module_ = std::make_unique<vm::Module>(vm::BytecodeGenerator::Compile(root, exec_ctx, "query"));
+  // Let the module weigh how hard to optimize its code against the work the query does
+  module_->SetEstimatedCardinality(EstimateCardinality(compiler.GetScannedTables(), exec_ctx));
+}
+
+int64_t ExecutableQuery::Run(exec::ExecutionContext *exec_ctx, const vm::ExecutionMode mode) {
+  TERRIER_ASSERT(IsCompiled(), "Running a query that isn't compiled");
+  std::function<uint32_t()> state_size;
+  std::function<void(exec::ExecutionContext *, void *)> set_up;
+  std::function<void(void *)> tear_down;
+  std::function<int64_t(exec::ExecutionContext *, void *)> finish;
+  std::vector<std::function<void(exec::ExecutionContext *, void *)>> pipelines(pipelines_.size());
+  bool found = module_->GetFunction("stateSize", mode, &state_size) &&
+               module_->GetFunction("setUpState", mode, &set_up) &&
+               module_->GetFunction("tearDownState", mode, &tear_down) &&
+               module_->GetFunction("finishQuery", mode, &finish);
+  for (uint32_t i = 0; found && i < pipelines_.size(); i++) {
+    found = module_->GetFunction(pipelines_[i].function_, mode, &pipelines[i]);
+  }
+  if (!found) {
+    EXECUTION_LOG_ERROR("Missing the entry functions of the pipelines of a compiled query");
+    return 0;
+  }
+
+  uint64_t elapsed_us = 0;
+  int64_t num_rows;
+  {
+    common::ScopedTimer<std::chrono::microseconds> timer(&elapsed_us);
+    // The state the pipelines share
+    const uint32_t size = state_size();
+    void *const state = exec_ctx->GetMemoryPool()->AllocateAligned(size, alignof(std::max_align_t), true);
+    bool set_up_done = false;
+    try {
+      set_up(exec_ctx, state);
+      set_up_done = true;
+
+      // Each pipeline is a single morsel. Those whose dependencies finished run at the same time, and parallelize
+      // their scans and breakers further within the same limits.
+      auto query = std::make_shared<exec::QueryScheduler::Query>(exec_ctx->GetPriority(), exec_ctx->GetMaxDop());
+      for (uint32_t i = 0; i < pipelines_.size(); i++) {
+        query->AddPipeline(1, [&, i](uint64_t) { pipelines[i](exec_ctx, state); }, pipelines_[i].dependencies_);
+      }
+      auto *const scheduler = exec::QueryScheduler::Instance();
+      scheduler->Submit(query);
+      scheduler->Wait(query.get());
+    } catch (...) {
+      // A failed pipeline, e.g., one going past the memory limit, leaves the hash tables, sorters and spill files of
+      // the query behind. The scheduler only rethrows once the query's other morsels stopped using them. A state that
+      // failed to set up can't be torn down; what its operators allocated goes away with the memory pool.
+      if (set_up_done) tear_down(state);
+      exec_ctx->GetMemoryPool()->Deallocate(state, size);
+      throw;
+    }
+
+    num_rows = finish(exec_ctx, state);
+    exec_ctx->GetMemoryPool()->Deallocate(state, size);
+  }
+
+  const auto metrics_store = common::thread_context.metrics_store_;
+  if (metrics_store != nullptr && metrics_store->ComponentEnabled(metrics::MetricsComponent::EXECUTION)) {
+    auto *const tracker = exec_ctx->GetMemoryTracker();
+    const uint64_t allocated = tracker->GetAllocatedSize();
+    // The published peak lags behind the threads' own counters, which are exact now that the query is done
+    metrics_store->RecordQueryData(elapsed_us, std::max<uint64_t>(tracker->GetPeakAllocatedSize(), allocated),
+                                   allocated, tracker->GetNumAllocations(), exec_ctx->GetMemoryBudget());
+  }
+  return num_rows;
+}
+
+}  // namespace terrier::execution::compiler
@@ -1,10 +1,17 @@
 #include "execution/exec/output.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
 #include "execution/sql/value.h"
 #include "loggers/execution_logger.h"
+#include "portable_endian/portable_endian.h"
 
 namespace terrier::execution::exec {
 
-OutputBuffer::~OutputBuffer() { memory_pool_->Deallocate(tuples_, BATCH_SIZE * tuple_size_); }
+OutputBuffer::~OutputBuffer() { memory_pool_->Deallocate(tuples_, batch_size_ * tuple_size_); }
 
 void OutputBuffer::Finalize() {
   if (num_tuples_ > 0) {
@@ -84,4 +91,255 @@ void OutputPrinter::operator()(byte *tuples, uint32_t num_tuples, uint32_t tuple
   EXECUTION_LOG_INFO("Ouptut batch {}: \n{}", printed_, ss.str());
   printed_++;
 }
+
+namespace {
+
+// The type of Postgres DataRow messages
+constexpr char K_DATA_ROW_TYPE = 'D';
+
+// The most bytes a value of a fixed-size type takes in the text format
+constexpr uint32_t K_MAX_TEXT_WIDTH = 32;
+
+// Dates are sent as days since 2000-01-01 in the binary format
+constexpr date::sys_days K_POSTGRES_EPOCH = date::sys_days(date::year(2000) / date::January / 1);
+
+template <typename T>
+void WriteBigEndian(char *dst, T val) {
+  static_assert(sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8, "Invalid size for integer");
+  if constexpr (sizeof(T) == 2) {
+    val = static_cast<T>(htobe16(static_cast<uint16_t>(val)));
+  } else if constexpr (sizeof(T) == 4) {
+    val = static_cast<T>(htobe32(static_cast<uint32_t>(val)));
+  } else if constexpr (sizeof(T) == 8) {
+    val = static_cast<T>(htobe64(static_cast<uint64_t>(val)));
+  }
+  std::memcpy(dst, &val, sizeof(T));
+}
+
+// The number of bytes an integer of the given type takes in the binary format. Postgres has no one byte integer.
+uint32_t BinaryIntegerWidth(const type::TypeId type) {
+  switch (type) {
+    case type::TypeId::TINYINT:
+    case type::TypeId::SMALLINT:
+      return sizeof(int16_t);
+    case type::TypeId::INTEGER:
+      return sizeof(int32_t);
+    default:
+      return sizeof(int64_t);
+  }
+}
+
+// Format a date as yyyy-mm-dd. Returns the number of characters written.
+int32_t FormatDate(const sql::Date &date, char *dst) {
+  const auto year = static_cast<int>(date.ymd_.year());
+  const auto month = static_cast<unsigned>(date.ymd_.month());
+  const auto day = static_cast<unsigned>(date.ymd_.day());
+  if (year < 0 || year > 9999) {
+    return std::snprintf(dst, K_MAX_TEXT_WIDTH, "%04d-%02u-%02u", year, month, day);
+  }
+  dst[0] = static_cast<char>('0' + year / 1000);
+  dst[1] = static_cast<char>('0' + year / 100 % 10);
+  dst[2] = static_cast<char>('0' + year / 10 % 10);
+  dst[3] = static_cast<char>('0' + year % 10);
+  dst[4] = '-';
+  dst[5] = static_cast<char>('0' + month / 10);
+  dst[6] = static_cast<char>('0' + month % 10);
+  dst[7] = '-';
+  dst[8] = static_cast<char>('0' + day / 10);
+  dst[9] = static_cast<char>('0' + day % 10);
+  return 10;
+}
+
+// Format a double the way Postgres does. Returns the number of characters written.
+int32_t FormatReal(const double val, char *dst) {
+  if (std::isnan(val)) {
+    std::memcpy(dst, "NaN", 3);
+    return 3;
+  }
+  if (std::isinf(val)) {
+    return val > 0 ? (std::memcpy(dst, "Infinity", 8), 8) : (std::memcpy(dst, "-Infinity", 9), 9);
+  }
+  return std::snprintf(dst, K_MAX_TEXT_WIDTH, "%.17g", val);
+}
+
+// Format an integer in decimal. Returns the number of characters written.
+int32_t FormatInteger(const int64_t val, char *dst) {
+  // Negate in unsigned arithmetic so that the smallest int64_t doesn't overflow
+  uint64_t magnitude = val < 0 ? 0 - static_cast<uint64_t>(val) : static_cast<uint64_t>(val);
+  char digits[20];
+  int32_t num_digits = 0;
+  do {
+    digits[num_digits++] = static_cast<char>('0' + magnitude % 10);
+    magnitude /= 10;
+  } while (magnitude != 0);
+
+  int32_t len = 0;
+  if (val < 0) dst[len++] = '-';
+  while (num_digits > 0) dst[len++] = digits[--num_digits];
+  return len;
+}
+
+}  // namespace
+
+PostgresOutputWriter::PostgresOutputWriter(const planner::OutputSchema *schema, const bool binary, OutputSink sink)
+    : schema_(schema), binary_(binary), sink_(std::move(sink)), columns_(schema->GetColumns().size()) {
+  uint32_t offset = 0;
+  for (const auto &col : schema_->GetColumns()) {
+    offsets_.push_back(offset);
+    offset += sql::ValUtil::GetSqlSize(col.GetType());
+  }
+}
+
+void PostgresOutputWriter::SerializeColumn(const uint16_t col, const byte *const tuples, const uint32_t num_tuples,
+                                           const uint32_t tuple_size, ColumnValues *const values) const {
+  const type::TypeId type = schema_->GetColumns()[col].GetType();
+  const byte *const base = tuples + offsets_[col];
+  auto &lens = values->lens_;
+  auto &ptrs = values->ptrs_;
+  lens.resize(num_tuples);
+  ptrs.resize(num_tuples);
+
+  // Strings are sent as they are in both formats
+  if (type == type::TypeId::VARCHAR) {
+    for (uint32_t row = 0; row < num_tuples; row++) {
+      const auto *val = reinterpret_cast<const sql::StringVal *>(base + row * tuple_size);
+      lens[row] = val->is_null_ ? -1 : static_cast<int32_t>(val->len_);
+      ptrs[row] = val->Content();
+    }
+    return;
+  }
+
+  values->data_.resize(num_tuples * K_MAX_TEXT_WIDTH);
+  char *data = values->data_.data();
+  for (uint32_t row = 0; row < num_tuples; row++) {
+    ptrs[row] = data + row * K_MAX_TEXT_WIDTH;
+  }
+
+  switch (type) {
+    case type::TypeId::TINYINT:
+    case type::TypeId::SMALLINT:
+    case type::TypeId::INTEGER:
+    case type::TypeId::BIGINT: {
+      const uint32_t width = BinaryIntegerWidth(type);
+      for (uint32_t row = 0; row < num_tuples; row++) {
+        const auto *val = reinterpret_cast<const sql::Integer *>(base + row * tuple_size);
+        char *dst = data + row * K_MAX_TEXT_WIDTH;
+        if (val->is_null_) {
+          lens[row] = -1;
+        } else if (!binary_) {
+          lens[row] = FormatInteger(val->val_, dst);
+        } else {
+          lens[row] = static_cast<int32_t>(width);
+          if (width == sizeof(int16_t)) {
+            WriteBigEndian(dst, static_cast<int16_t>(val->val_));
+          } else if (width == sizeof(int32_t)) {
+            WriteBigEndian(dst, static_cast<int32_t>(val->val_));
+          } else {
+            WriteBigEndian(dst, val->val_);
+          }
+        }
+      }
+      break;
+    }
+    case type::TypeId::BOOLEAN: {
+      for (uint32_t row = 0; row < num_tuples; row++) {
+        const auto *val = reinterpret_cast<const sql::BoolVal *>(base + row * tuple_size);
+        char *dst = data + row * K_MAX_TEXT_WIDTH;
+        if (val->is_null_) {
+          lens[row] = -1;
+        } else {
+          lens[row] = 1;
+          *dst = binary_ ? static_cast<char>(val->val_) : (val->val_ ? 't' : 'f');
+        }
+      }
+      break;
+    }
+    case type::TypeId::DECIMAL: {
+      for (uint32_t row = 0; row < num_tuples; row++) {
+        const auto *val = reinterpret_cast<const sql::Real *>(base + row * tuple_size);
+        char *dst = data + row * K_MAX_TEXT_WIDTH;
+        if (val->is_null_) {
+          lens[row] = -1;
+        } else if (!binary_) {
+          lens[row] = FormatReal(val->val_, dst);
+        } else {
+          // Sent as a float8
+          uint64_t bits;
+          std::memcpy(&bits, &val->val_, sizeof(bits));
+          WriteBigEndian(dst, bits);
+          lens[row] = sizeof(bits);
+        }
+      }
+      break;
+    }
+    case type::TypeId::DATE: {
+      for (uint32_t row = 0; row < num_tuples; row++) {
+        const auto *val = reinterpret_cast<const sql::Date *>(base + row * tuple_size);
+        char *dst = data + row * K_MAX_TEXT_WIDTH;
+        if (val->is_null_) {
+          lens[row] = -1;
+        } else if (!binary_) {
+          lens[row] = FormatDate(*val, dst);
+        } else {
+          const auto days = (date::sys_days(val->ymd_) - K_POSTGRES_EPOCH).count();
+          WriteBigEndian(dst, static_cast<int32_t>(days));
+          lens[row] = sizeof(int32_t);
+        }
+      }
+      break;
+    }
+    default:
+      UNREACHABLE("Cannot output unsupported type!!!");
+  }
+}
+
+void PostgresOutputWriter::operator()(byte *tuples, uint32_t num_tuples, uint32_t tuple_size) {
+  const auto num_cols = static_cast<uint16_t>(columns_.size());
+  for (uint16_t col = 0; col < num_cols; col++) {
+    SerializeColumn(col, tuples, num_tuples, tuple_size, &columns_[col]);
+  }
+
+  // Every message is its type, its length, the number of columns, then the length and bytes of every value
+  constexpr uint32_t header_size = sizeof(char) + sizeof(int32_t) + sizeof(int16_t);
+  cursors_.assign(num_tuples, header_size + num_cols * sizeof(int32_t));
+  for (const auto &column : columns_) {
+    for (uint32_t row = 0; row < num_tuples; row++) {
+      cursors_[row] += static_cast<uint32_t>(std::max(column.lens_[row], 0));
+    }
+  }
+
+  // Lay the messages out back to back, writing their headers
+  uint32_t total_size = 0;
+  for (uint32_t row = 0; row < num_tuples; row++) {
+    total_size += cursors_[row];
+  }
+  buffer_.resize(total_size);
+  char *out = buffer_.data();
+  uint32_t offset = 0;
+  for (uint32_t row = 0; row < num_tuples; row++) {
+    const uint32_t message_size = cursors_[row];
+    out[offset] = K_DATA_ROW_TYPE;
+    // The length doesn't count the type
+    WriteBigEndian(out + offset + sizeof(char), static_cast<int32_t>(message_size - sizeof(char)));
+    WriteBigEndian(out + offset + sizeof(char) + sizeof(int32_t), static_cast<int16_t>(num_cols));
+    cursors_[row] = offset + header_size;
+    offset += message_size;
+  }
+
+  // Copy the values in, a column at a time
+  for (const auto &column : columns_) {
+    for (uint32_t row = 0; row < num_tuples; row++) {
+      const int32_t len = column.lens_[row];
+      char *dst = out + cursors_[row];
+      WriteBigEndian(dst, len);
+      if (len > 0) {
+        std::memcpy(dst + sizeof(int32_t), column.ptrs_[row], static_cast<std::size_t>(len));
+      }
+      cursors_[row] += sizeof(int32_t) + static_cast<uint32_t>(std::max(len, 0));
+    }
+  }
+
+  sink_(out, total_size);
+}
+
 }  // namespace terrier::execution::exec
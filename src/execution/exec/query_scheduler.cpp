@@ -0,0 +1,346 @@
+#include "execution/exec/query_scheduler.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <memory>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "execution/util/cpu_info.h"
+
+namespace terrier::execution::exec {
+
+namespace {
+
+// The service a morsel is worth, divided by the priority of its query
+constexpr uint64_t K_STRIDE = uint64_t{1} << 20;
+
+// The query the calling thread is running a morsel of, if any
+thread_local QueryScheduler::Query *current_query = nullptr;
+
+// The NUMA node the calling thread runs on
+uint32_t CurrentNode() {
+#ifdef __linux__
+  const int core = sched_getcpu();
+  if (core >= 0) return CpuInfo::Instance()->GetNumaNodeOfCore(static_cast<uint32_t>(core));
+#endif
+  return 0;
+}
+
+}  // namespace
+
+/**
+ * A pipeline of a query. The cursors of its ranges are claimed from without any latch, all its other fields are
+ * protected by the scheduler's latch.
+ */
+class QueryScheduler::Pipeline {
+ public:
+  // The morsels of a NUMA node, those in [next, end) aren't claimed yet. The cursor may run past the end.
+  struct Range {
+    std::atomic<uint64_t> next_;
+    uint64_t end_;
+  };
+
+  Pipeline(const uint64_t num_morsels, MorselFn fn, const uint32_t num_nodes)
+      : fn_(std::move(fn)), ranges_(num_nodes), num_unfinished_(num_morsels) {
+    for (uint32_t node = 0; node < num_nodes; node++) {
+      ranges_[node].next_.store(num_morsels * node / num_nodes, std::memory_order_relaxed);
+      ranges_[node].end_ = num_morsels * (node + 1) / num_nodes;
+    }
+  }
+
+  // Claim a morsel, those of the given node first, then steal those of the other nodes. Returns false if none is left.
+  bool Claim(const uint32_t node, uint64_t *const morsel) {
+    const auto num_nodes = static_cast<uint32_t>(ranges_.size());
+    for (uint32_t i = 0; i < num_nodes; i++) {
+      auto &range = ranges_[(node + i) % num_nodes];
+      if (range.next_.load(std::memory_order_relaxed) >= range.end_) continue;
+      const uint64_t claimed = range.next_.fetch_add(1, std::memory_order_relaxed);
+      if (claimed < range.end_) {
+        *morsel = claimed;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // True if some morsel is left to claim
+  bool HasUnclaimed() const {
+    return std::any_of(ranges_.begin(), ranges_.end(), [](const Range &range) {
+      return range.next_.load(std::memory_order_relaxed) < range.end_;
+    });
+  }
+
+  // Drop the morsels left to claim, returning how many there were
+  uint64_t DropUnclaimed() {
+    uint64_t num_dropped = 0;
+    for (auto &range : ranges_) {
+      const uint64_t next = range.next_.exchange(range.end_, std::memory_order_relaxed);
+      num_dropped += range.end_ - std::min(next, range.end_);
+    }
+    return num_dropped;
+  }
+
+  MorselFn fn_;
+  std::vector<Range> ranges_;
+  // The morsels that didn't finish running
+  uint64_t num_unfinished_;
+  // The pipelines that can't start before this one finished
+  std::vector<Pipeline *> dependents_;
+  uint32_t num_pending_dependencies_{0};
+  bool runnable_{false};
+  bool finished_{false};
+};
+
+// ---------------------------------------------------------
+// Query
+// ---------------------------------------------------------
+
+QueryScheduler::Query::Query(const uint32_t priority, const uint32_t max_dop)
+    : priority_(std::max(priority, 1u)), max_dop_(max_dop) {}
+
+QueryScheduler::Query::~Query() = default;
+
+uint32_t QueryScheduler::Query::AddPipeline(const uint64_t num_morsels, MorselFn fn,
+                                            const std::vector<uint32_t> &dependencies) {
+  const auto id = static_cast<uint32_t>(pipelines_.size());
+  auto pipeline = std::make_unique<Pipeline>(num_morsels, std::move(fn), CpuInfo::Instance()->GetNumNumaNodes());
+  for (const auto dependency : dependencies) {
+    TERRIER_ASSERT(dependency < id, "A pipeline can only depend on pipelines added before it");
+    pipelines_[dependency]->dependents_.push_back(pipeline.get());
+    pipeline->num_pending_dependencies_++;
+  }
+  pipelines_.emplace_back(std::move(pipeline));
+  num_pending_pipelines_++;
+  return id;
+}
+
+bool QueryScheduler::Query::ClaimMorsel(const uint32_t node, Pipeline **pipeline, uint64_t *morsel) {
+  if (error_ != nullptr) return false;
+  for (const auto &candidate : pipelines_) {
+    if (!candidate->runnable_ || candidate->finished_) continue;
+    if (candidate->Claim(node, morsel)) {
+      *pipeline = candidate.get();
+      return true;
+    }
+  }
+  return false;
+}
+
+bool QueryScheduler::Query::HasUnclaimedMorsels() const {
+  if (error_ != nullptr) return false;
+  return std::any_of(pipelines_.begin(), pipelines_.end(), [](const auto &pipeline) {
+    return pipeline->runnable_ && !pipeline->finished_ && pipeline->HasUnclaimed();
+  });
+}
+
+namespace {
+
+// Finish a pipeline whose morsels all ran, starting the pipelines depending on it
+void FinishPipeline(QueryScheduler::Pipeline *pipeline, uint32_t *num_pending_pipelines);
+
+// Let a pipeline whose dependencies all finished run
+void StartPipeline(QueryScheduler::Pipeline *pipeline, uint32_t *num_pending_pipelines) {
+  pipeline->runnable_ = true;
+  if (pipeline->num_unfinished_ == 0) FinishPipeline(pipeline, num_pending_pipelines);
+}
+
+void FinishPipeline(QueryScheduler::Pipeline *pipeline, uint32_t *num_pending_pipelines) {
+  pipeline->finished_ = true;
+  (*num_pending_pipelines)--;
+  for (auto *dependent : pipeline->dependents_) {
+    // A failed query finishes the pipelines that didn't start itself
+    if (dependent->finished_) continue;
+    if (--dependent->num_pending_dependencies_ == 0) StartPipeline(dependent, num_pending_pipelines);
+  }
+}
+
+}  // namespace
+
+// ---------------------------------------------------------
+// Scheduler
+// ---------------------------------------------------------
+
+QueryScheduler *QueryScheduler::Instance() {
+  static QueryScheduler instance(std::max(CpuInfo::Instance()->GetNumCores(), 1u));
+  return &instance;
+}
+
+QueryScheduler::QueryScheduler(const uint32_t num_workers) {
+  const auto *cpu_info = CpuInfo::Instance();
+  const uint32_t num_cores = std::max(cpu_info->GetNumCores(), 1u);
+  workers_.reserve(num_workers);
+  for (uint32_t i = 0; i < num_workers; i++) {
+    const uint32_t node = cpu_info->GetNumaNodeOfCore(i % num_cores);
+    workers_.emplace_back([this, node] { RunWorker(node); });
+#ifdef __linux__
+    // Keep each worker on the cores of its node, so the morsels it prefers are local
+    if (cpu_info->GetNumNumaNodes() > 1) {
+      cpu_set_t cores;
+      CPU_ZERO(&cores);
+      for (uint32_t core = 0; core < num_cores; core++) {
+        if (cpu_info->GetNumaNodeOfCore(core) == node) CPU_SET(core, &cores);
+      }
+      pthread_setaffinity_np(workers_.back().native_handle(), sizeof(cores), &cores);
+    }
+#endif
+  }
+}
+
+QueryScheduler::~QueryScheduler() {
+  {
+    std::lock_guard<std::mutex> lock(latch_);
+    shutdown_ = true;
+  }
+  work_cv_.notify_all();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+}
+
+void QueryScheduler::Submit(std::shared_ptr<Query> query) {
+  std::unique_lock<std::mutex> lock(latch_);
+  // A new query starts level with the least served one, neither ahead nor owed the time it didn't run
+  query->pass_ = 0;
+  if (!queries_.empty()) {
+    query->pass_ = (*std::min_element(queries_.begin(), queries_.end(), [](const auto &a, const auto &b) {
+                     return a->pass_ < b->pass_;
+                   }))->pass_;
+  }
+  for (const auto &pipeline : query->pipelines_) {
+    if (pipeline->num_pending_dependencies_ == 0) StartPipeline(pipeline.get(), &query->num_pending_pipelines_);
+  }
+  if (query->num_pending_pipelines_ == 0) {
+    query->done_ = true;
+    return;
+  }
+  queries_.emplace_back(std::move(query));
+  lock.unlock();
+  work_cv_.notify_all();
+}
+
+void QueryScheduler::Wait(Query *const query) {
+  const uint32_t node = CurrentNode();
+  std::unique_lock<std::mutex> lock(latch_);
+  while (!query->done_) {
+    const bool has_room = query->max_dop_ == 0 || query->num_active_ < query->max_dop_;
+    if (!has_room || !RunMorsels(query, node, &lock)) {
+      query->progress_cv_.wait(lock);
+    }
+  }
+  if (query->error_ != nullptr) {
+    std::rethrow_exception(query->error_);
+  }
+}
+
+void QueryScheduler::ParallelFor(const uint64_t n, const MorselFn &fn, uint32_t max_dop) {
+  // A single call isn't worth a query
+  if (n == 1 || max_dop == 1) {
+    for (uint64_t i = 0; i < n; i++) fn(i);
+    return;
+  }
+  // The calls may not use more threads than the query they belong to
+  if (current_query != nullptr && current_query->max_dop_ != 0) {
+    max_dop = max_dop == 0 ? current_query->max_dop_ : std::min(max_dop, current_query->max_dop_);
+  }
+  auto query = std::make_shared<Query>(current_query != nullptr ? current_query->priority_ : K_DEFAULT_PRIORITY,
+                                       max_dop);
+  query->AddPipeline(n, fn);
+  Submit(query);
+  Wait(query.get());
+}
+
+void QueryScheduler::RunWorker(const uint32_t node) {
+  std::unique_lock<std::mutex> lock(latch_);
+  while (!shutdown_) {
+    auto query = PickQuery();
+    if (query == nullptr || !RunMorsels(query.get(), node, &lock)) {
+      work_cv_.wait(lock);
+    }
+  }
+}
+
+std::shared_ptr<QueryScheduler::Query> QueryScheduler::PickQuery() const {
+  std::shared_ptr<Query> picked;
+  for (const auto &query : queries_) {
+    if (query->max_dop_ != 0 && query->num_active_ >= query->max_dop_) continue;
+    if (picked != nullptr && picked->pass_ <= query->pass_) continue;
+    if (query->HasUnclaimedMorsels()) picked = query;
+  }
+  return picked;
+}
+
+bool QueryScheduler::RunMorsels(Query *const query, const uint32_t node, std::unique_lock<std::mutex> *const lock) {
+  Pipeline *pipeline;
+  uint64_t morsel;
+  if (!query->ClaimMorsel(node, &pipeline, &morsel)) return false;
+  query->num_active_++;
+  // Charge the first morsel right away, so that other threads picking a query meanwhile see it
+  query->pass_ += K_STRIDE / query->priority_;
+
+  lock->unlock();
+  auto *const outer_query = current_query;
+  current_query = query;
+  // The pipeline can't finish while its claimed morsels aren't accounted for, so it's safe to claim more without the
+  // latch. A failed query drops the morsels left, which ends the slice.
+  const auto slice_end = std::chrono::steady_clock::now() + K_TIME_SLICE;
+  uint64_t num_run = 0;
+  std::exception_ptr error;
+  try {
+    do {
+      num_run++;
+      pipeline->fn_(morsel);
+    } while (std::chrono::steady_clock::now() < slice_end && pipeline->Claim(node, &morsel));
+  } catch (...) {
+    error = std::current_exception();
+  }
+  current_query = outer_query;
+  lock->lock();
+
+  const bool was_at_limit = query->max_dop_ != 0 && query->num_active_ == query->max_dop_;
+  query->num_active_--;
+  query->pass_ += (num_run - 1) * (K_STRIDE / query->priority_);
+  bool finished_pipeline = false;
+  pipeline->num_unfinished_ -= num_run;
+  if (pipeline->num_unfinished_ == 0) {
+    FinishPipeline(pipeline, &query->num_pending_pipelines_);
+    finished_pipeline = true;
+  }
+
+  // A failed query drops the morsels that didn't start
+  if (error != nullptr && query->error_ == nullptr) {
+    query->error_ = error;
+    for (const auto &other : query->pipelines_) {
+      if (other->finished_) continue;
+      other->num_unfinished_ -= other->DropUnclaimed();
+      if (other->num_unfinished_ == 0) {
+        other->finished_ = true;
+        query->num_pending_pipelines_--;
+      }
+    }
+  }
+
+  if (query->num_pending_pipelines_ == 0 && !query->done_) {
+    query->done_ = true;
+    queries_.erase(std::find_if(queries_.begin(), queries_.end(), [=](const auto &q) { return q.get() == query; }));
+  }
+
+  // Other threads may now be able to run a morsel of this query, or the query they're waiting for finished. Morsels
+  // that merely ran wake nobody.
+  if (finished_pipeline || query->done_) {
+    work_cv_.notify_all();
+  } else if (was_at_limit) {
+    work_cv_.notify_one();
+  }
+  if (finished_pipeline || query->done_ || was_at_limit) {
+    query->progress_cv_.notify_all();
+  }
+  return true;
+}
+
+}  // namespace terrier::execution::exec
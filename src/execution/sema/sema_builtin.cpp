@@ -3,6 +3,7 @@
 #include "execution/ast/ast_node_factory.h"
 #include "execution/ast/context.h"
 #include "execution/ast/type.h"
+#include "execution/sql/projected_columns_iterator.h"
 
 namespace terrier::execution::sema {
 
@@ -120,8 +121,12 @@ void Sema::CheckBuiltinSqlConversionCall(ast::CallExpr *call, ast::Builtin built
   }
 }
 
-void Sema::CheckBuiltinFilterCall(ast::CallExpr *call) {
-  if (!CheckArgCount(call, 4)) {
+void Sema::CheckBuiltinFilterCall(ast::CallExpr *call, ast::Builtin builtin) {
+  // String filters have no type argument
+  const bool is_string_filter =
+      (builtin == ast::Builtin::FilterStringEq || builtin == ast::Builtin::FilterStringPrefix);
+  const uint32_t expected_arg_count = (builtin == ast::Builtin::FilterBetween ? 5 : is_string_filter ? 3 : 4);
+  if (!CheckArgCount(call, expected_arg_count)) {
     return;
   }
 
@@ -141,6 +146,16 @@ void Sema::CheckBuiltinFilterCall(ast::CallExpr *call) {
     return;
   }
 
+  // The third call argument of a string filter is the string literal to compare with
+  if (is_string_filter) {
+    if (!args[2]->IsStringLiteral()) {
+      ReportIncorrectCallArg(call, 2, ast::StringType::Get(GetContext()));
+      return;
+    }
+    call->SetType(GetBuiltinType(ast::BuiltinType::Int64));
+    return;
+  }
+
   // The third call argument must be an type represented by an integer.
   // TODO(Amadou): This is subject to change. Ideally, there should be a builtin for every type like for PCIGet.
   if (!args[2]->IsIntegerLiteral()) {
@@ -148,6 +163,30 @@ void Sema::CheckBuiltinFilterCall(ast::CallExpr *call) {
     return;
   }
 
+  if (builtin == ast::Builtin::FilterIn) {
+    // The list of values is a fixed length int64 array
+    auto *arr_type = args[3]->GetType()->SafeAs<ast::ArrayType>();
+    if (arr_type == nullptr || !arr_type->HasKnownLength() ||
+        !arr_type->ElementType()->IsSpecificBuiltin(ast::BuiltinType::Int64)) {
+      ReportIncorrectCallArg(call, 3, "Fourth argument should be a fixed length int64 array");
+      return;
+    }
+    static_assert(sql::ProjectedColumnsIterator::K_MAX_IN_LIST_SIZE == 256, "Update the error message below");
+    if (arr_type->Length() > sql::ProjectedColumnsIterator::K_MAX_IN_LIST_SIZE) {
+      ReportIncorrectCallArg(call, 3, "Fourth argument should have at most 256 values");
+      return;
+    }
+  } else {
+    // The filter values are numeric literals
+    for (uint32_t arg_idx = 3; arg_idx < expected_arg_count; arg_idx++) {
+      auto *lit = args[arg_idx]->SafeAs<ast::LitExpr>();
+      if (lit == nullptr || (!lit->IsIntLitExpr() && !lit->IsFloatLitExpr())) {
+        ReportIncorrectCallArg(call, arg_idx, GetBuiltinType(ast::BuiltinType::Int64));
+        return;
+      }
+    }
+  }
+
   // Set return type
   call->SetType(GetBuiltinType(ast::BuiltinType::Int64));
 }
@@ -401,6 +440,133 @@ void Sema::CheckBuiltinAggPartIterCall(ast::CallExpr *call, ast::Builtin builtin
   }
 }
 
+void Sema::CheckBuiltinDirectMappedAggTableCall(ast::CallExpr *call, ast::Builtin builtin) {
+  if (!CheckArgCountAtLeast(call, 1)) {
+    return;
+  }
+
+  const auto &args = call->Arguments();
+
+  const auto dm_agg_kind = ast::BuiltinType::DirectMappedAggregationTable;
+  if (!IsPointerToSpecificBuiltin(args[0]->GetType(), dm_agg_kind)) {
+    ReportIncorrectCallArg(call, 0, GetBuiltinType(dm_agg_kind)->PointerTo());
+    return;
+  }
+
+  switch (builtin) {
+    case ast::Builtin::DirectMappedAggTableInit: {
+      if (!CheckArgCount(call, 5)) {
+        return;
+      }
+      // Second argument is a memory pool pointer
+      const auto mem_pool_kind = ast::BuiltinType::MemoryPool;
+      if (!IsPointerToSpecificBuiltin(args[1]->GetType(), mem_pool_kind)) {
+        ReportIncorrectCallArg(call, 1, GetBuiltinType(mem_pool_kind)->PointerTo());
+        return;
+      }
+      // Third argument is the payload size, a 32-bit value
+      const auto uint_kind = ast::BuiltinType::Uint32;
+      if (!args[2]->GetType()->IsSpecificBuiltin(uint_kind)) {
+        ReportIncorrectCallArg(call, 2, GetBuiltinType(uint_kind));
+        return;
+      }
+      // Last two arguments are the inclusive key domain bounds
+      const auto int64_kind = ast::BuiltinType::Int64;
+      for (uint32_t idx = 3; idx < 5; idx++) {
+        if (!args[idx]->GetType()->IsSpecificBuiltin(int64_kind)) {
+          ReportIncorrectCallArg(call, idx, GetBuiltinType(int64_kind));
+          return;
+        }
+      }
+      call->SetType(GetBuiltinType(ast::BuiltinType::Nil));
+      break;
+    }
+    case ast::Builtin::DirectMappedAggTableInDomain:
+    case ast::Builtin::DirectMappedAggTableLookup:
+    case ast::Builtin::DirectMappedAggTableInsert: {
+      if (!CheckArgCount(call, 2)) {
+        return;
+      }
+      // Second argument is the SQL integer grouping key
+      const auto int_kind = ast::BuiltinType::Integer;
+      if (!args[1]->GetType()->IsSpecificBuiltin(int_kind)) {
+        ReportIncorrectCallArg(call, 1, GetBuiltinType(int_kind));
+        return;
+      }
+      if (builtin == ast::Builtin::DirectMappedAggTableInDomain) {
+        call->SetType(GetBuiltinType(ast::BuiltinType::Bool));
+      } else {
+        call->SetType(GetBuiltinType(ast::BuiltinType::Uint8)->PointerTo());
+      }
+      break;
+    }
+    case ast::Builtin::DirectMappedAggTableFree: {
+      if (!CheckArgCount(call, 1)) {
+        return;
+      }
+      call->SetType(GetBuiltinType(ast::BuiltinType::Nil));
+      break;
+    }
+    default: {
+      UNREACHABLE("Impossible direct-mapped aggregation table call");
+    }
+  }
+}
+
+void Sema::CheckBuiltinDirectMappedAggTableIterCall(ast::CallExpr *call, ast::Builtin builtin) {
+  if (!CheckArgCountAtLeast(call, 1)) {
+    return;
+  }
+
+  const auto &args = call->Arguments();
+
+  const auto dm_iter_kind = ast::BuiltinType::DirectMappedAggregationTableIterator;
+  if (!IsPointerToSpecificBuiltin(args[0]->GetType(), dm_iter_kind)) {
+    ReportIncorrectCallArg(call, 0, GetBuiltinType(dm_iter_kind)->PointerTo());
+    return;
+  }
+
+  switch (builtin) {
+    case ast::Builtin::DirectMappedAggTableIterInit: {
+      if (!CheckArgCount(call, 2)) {
+        return;
+      }
+      const auto dm_agg_kind = ast::BuiltinType::DirectMappedAggregationTable;
+      if (!IsPointerToSpecificBuiltin(args[1]->GetType(), dm_agg_kind)) {
+        ReportIncorrectCallArg(call, 1, GetBuiltinType(dm_agg_kind)->PointerTo());
+        return;
+      }
+      call->SetType(GetBuiltinType(ast::BuiltinType::Nil));
+      break;
+    }
+    case ast::Builtin::DirectMappedAggTableIterHasNext: {
+      if (!CheckArgCount(call, 1)) {
+        return;
+      }
+      call->SetType(GetBuiltinType(ast::BuiltinType::Bool));
+      break;
+    }
+    case ast::Builtin::DirectMappedAggTableIterGetRow: {
+      if (!CheckArgCount(call, 1)) {
+        return;
+      }
+      call->SetType(GetBuiltinType(ast::BuiltinType::Uint8)->PointerTo());
+      break;
+    }
+    case ast::Builtin::DirectMappedAggTableIterNext:
+    case ast::Builtin::DirectMappedAggTableIterClose: {
+      if (!CheckArgCount(call, 1)) {
+        return;
+      }
+      call->SetType(GetBuiltinType(ast::BuiltinType::Nil));
+      break;
+    }
+    default: {
+      UNREACHABLE("Impossible direct-mapped aggregation table iterator call");
+    }
+  }
+}
+
 void Sema::CheckBuiltinAggregatorCall(ast::CallExpr *call, ast::Builtin builtin) {
   const auto &args = call->Arguments();
   switch (builtin) {
@@ -574,7 +740,8 @@ void Sema::CheckBuiltinJoinHashTableBuild(ast::CallExpr *call, ast::Builtin buil
   }
 
   switch (builtin) {
-    case ast::Builtin::JoinHashTableBuild: {
+    case ast::Builtin::JoinHashTableBuild:
+    case ast::Builtin::JoinHashTableBuildBloomFilter: {
       break;
     }
     case ast::Builtin::JoinHashTableBuildParallel: {
@@ -622,6 +789,91 @@ void Sema::CheckBuiltinJoinHashTableFree(ast::CallExpr *call) {
   call->SetType(GetBuiltinType(ast::BuiltinType::Nil));
 }
 
+void Sema::CheckBuiltinJoinHashTableSpillCall(ast::CallExpr *call, ast::Builtin builtin) {
+  if (!CheckArgCountAtLeast(call, 1)) {
+    return;
+  }
+
+  const auto &args = call->Arguments();
+
+  // The first argument is always a pointer to a JoinHashTable
+  const auto jht_kind = ast::BuiltinType::JoinHashTable;
+  if (!IsPointerToSpecificBuiltin(args[0]->GetType(), jht_kind)) {
+    ReportIncorrectCallArg(call, 0, GetBuiltinType(jht_kind)->PointerTo());
+    return;
+  }
+
+  switch (builtin) {
+    case ast::Builtin::JoinHashTableEnableSpilling: {
+      if (!CheckArgCount(call, 1)) {
+        return;
+      }
+      call->SetType(GetBuiltinType(ast::BuiltinType::Nil));
+      break;
+    }
+    case ast::Builtin::JoinHashTableIsSpilled: {
+      if (!CheckArgCount(call, 2)) {
+        return;
+      }
+      // Second argument is the 64-bit unsigned hash value of the probe tuple
+      if (!args[1]->GetType()->IsSpecificBuiltin(ast::BuiltinType::Uint64)) {
+        ReportIncorrectCallArg(call, 1, GetBuiltinType(ast::BuiltinType::Uint64));
+        return;
+      }
+      call->SetType(GetBuiltinType(ast::BuiltinType::Bool));
+      break;
+    }
+    case ast::Builtin::JoinHashTableDeferProbe: {
+      if (!CheckArgCount(call, 4)) {
+        return;
+      }
+      // Second argument is the 64-bit unsigned hash value of the probe tuple
+      if (!args[1]->GetType()->IsSpecificBuiltin(ast::BuiltinType::Uint64)) {
+        ReportIncorrectCallArg(call, 1, GetBuiltinType(ast::BuiltinType::Uint64));
+        return;
+      }
+      // Third argument is a pointer to the probe tuple
+      if (!args[2]->GetType()->IsPointerType()) {
+        ReportIncorrectCallArg(call, 2, GetBuiltinType(ast::BuiltinType::Uint8)->PointerTo());
+        return;
+      }
+      // Fourth argument is the size of the probe tuple
+      if (!args[3]->GetType()->IsIntegerType()) {
+        ReportIncorrectCallArg(call, 3, GetBuiltinType(ast::BuiltinType::Uint32));
+        return;
+      }
+      call->SetType(GetBuiltinType(ast::BuiltinType::Nil));
+      break;
+    }
+    case ast::Builtin::JoinHashTableJoinSpilled: {
+      if (!CheckArgCount(call, 3)) {
+        return;
+      }
+      // Second argument is an opaque context pointer
+      if (!args[1]->GetType()->IsPointerType()) {
+        ReportIncorrectCallArg(call, 1, GetBuiltinType(ast::BuiltinType::Uint8)->PointerTo());
+        return;
+      }
+      // Third argument is the function probing a deferred probe tuple
+      auto *const probe_fn_type = args[2]->GetType()->SafeAs<ast::FunctionType>();
+      if (probe_fn_type == nullptr || probe_fn_type->NumParams() != 4 ||
+          !probe_fn_type->ReturnType()->IsNilType() || !probe_fn_type->Params()[0].type_->IsPointerType() ||
+          !IsPointerToSpecificBuiltin(probe_fn_type->Params()[1].type_, jht_kind) ||
+          !probe_fn_type->Params()[2].type_->IsSpecificBuiltin(ast::BuiltinType::Uint64) ||
+          !probe_fn_type->Params()[3].type_->IsPointerType()) {
+        GetErrorReporter()->Report(call->Position(), ErrorMessages::kBadProbeFunctionForJHTJoinSpilled,
+                                   args[2]->GetType(), 2);
+        return;
+      }
+      call->SetType(GetBuiltinType(ast::BuiltinType::Nil));
+      break;
+    }
+    default: {
+      UNREACHABLE("Impossible join hash table spilling call");
+    }
+  }
+}
+
 void Sema::CheckBuiltinJoinHashTableIterInit(ast::CallExpr *call) {
   if (!CheckArgCount(call, 3)) {
     return;
@@ -909,6 +1161,50 @@ void Sema::CheckBuiltinTableIterCall(ast::CallExpr *call, ast::Builtin builtin)
       call->SetType(GetBuiltinType(ast::BuiltinType::Nil));
       break;
     }
+    case ast::Builtin::TableIterSetTopKThreshold: {
+      if (!CheckArgCount(call, 4)) {
+        return;
+      }
+      // The second argument is the threshold of the Top-K the scan feeds
+      const auto threshold_kind = ast::BuiltinType::TopKThreshold;
+      if (!IsPointerToSpecificBuiltin(call_args[1]->GetType(), threshold_kind)) {
+        ReportIncorrectCallArg(call, 1, GetBuiltinType(threshold_kind)->PointerTo());
+        return;
+      }
+      // The third argument is the index of the sort key column, and the fourth its type
+      if (!call_args[2]->IsIntegerLiteral()) {
+        ReportIncorrectCallArg(call, 2, GetBuiltinType(ast::BuiltinType::Int32));
+        return;
+      }
+      if (!call_args[3]->IsIntegerLiteral()) {
+        ReportIncorrectCallArg(call, 3, GetBuiltinType(ast::BuiltinType::Int32));
+        return;
+      }
+      call->SetType(GetBuiltinType(ast::BuiltinType::Nil));
+      break;
+    }
+    case ast::Builtin::TableIterAddRuntimeFilter: {
+      if (!CheckArgCount(call, 4)) {
+        return;
+      }
+      // The second argument is the join hash table whose build keys the scanned tuples probe
+      const auto jht_kind = ast::BuiltinType::JoinHashTable;
+      if (!IsPointerToSpecificBuiltin(call_args[1]->GetType(), jht_kind)) {
+        ReportIncorrectCallArg(call, 1, GetBuiltinType(jht_kind)->PointerTo());
+        return;
+      }
+      // The third argument is the index of the probe key column, and the fourth its type
+      if (!call_args[2]->IsIntegerLiteral()) {
+        ReportIncorrectCallArg(call, 2, GetBuiltinType(ast::BuiltinType::Int32));
+        return;
+      }
+      if (!call_args[3]->IsIntegerLiteral()) {
+        ReportIncorrectCallArg(call, 3, GetBuiltinType(ast::BuiltinType::Int32));
+        return;
+      }
+      call->SetType(GetBuiltinType(ast::BuiltinType::Nil));
+      break;
+    }
     default: {
       UNREACHABLE("Impossible table iteration call");
     }
@@ -916,36 +1212,51 @@ void Sema::CheckBuiltinTableIterCall(ast::CallExpr *call, ast::Builtin builtin)
 }
 
 void Sema::CheckBuiltinTableIterParCall(ast::CallExpr *call) {
-  if (!CheckArgCount(call, 4)) {
+  if (!CheckArgCount(call, 6)) {
     return;
   }
 
   const auto &call_args = call->Arguments();
 
-  // First argument is table name as a string literal
-  if (!call_args[0]->IsStringLiteral()) {
-    ReportIncorrectCallArg(call, 0, ast::StringType::Get(GetContext()));
+  // First argument is the execution context
+  const auto exec_ctx_kind = ast::BuiltinType::ExecutionContext;
+  if (!IsPointerToSpecificBuiltin(call_args[0]->GetType(), exec_ctx_kind)) {
+    ReportIncorrectCallArg(call, 0, GetBuiltinType(exec_ctx_kind)->PointerTo());
     return;
   }
 
-  // Second argument is an opaque query state. For now, check it's a pointer.
+  // Second argument is table name as a string literal
+  if (!call_args[1]->IsStringLiteral()) {
+    ReportIncorrectCallArg(call, 1, ast::StringType::Get(GetContext()));
+    return;
+  }
+
+  // Third argument is the array of the oids of the columns to scan
+  auto *arr_type = call_args[2]->GetType()->SafeAs<ast::ArrayType>();
+  if (arr_type == nullptr || !arr_type->ElementType()->IsSpecificBuiltin(ast::BuiltinType::Uint32) ||
+      !arr_type->HasKnownLength()) {
+    ReportIncorrectCallArg(call, 2, "Third argument should be a fixed length uint32 array");
+    return;
+  }
+
+  // Fourth argument is an opaque query state. For now, check it's a pointer.
   const auto void_kind = ast::BuiltinType::Nil;
-  if (!call_args[1]->GetType()->IsPointerType()) {
-    ReportIncorrectCallArg(call, 1, GetBuiltinType(void_kind)->PointerTo());
+  if (!call_args[3]->GetType()->IsPointerType()) {
+    ReportIncorrectCallArg(call, 3, GetBuiltinType(void_kind)->PointerTo());
     return;
   }
 
-  // Third argument is the thread state container
+  // Fifth argument is the thread state container
   const auto tls_kind = ast::BuiltinType::ThreadStateContainer;
-  if (!IsPointerToSpecificBuiltin(call_args[2]->GetType(), tls_kind)) {
-    ReportIncorrectCallArg(call, 2, GetBuiltinType(tls_kind)->PointerTo());
+  if (!IsPointerToSpecificBuiltin(call_args[4]->GetType(), tls_kind)) {
+    ReportIncorrectCallArg(call, 4, GetBuiltinType(tls_kind)->PointerTo());
     return;
   }
 
-  // Third argument is scanner function
-  auto *scan_fn_type = call_args[3]->GetType()->SafeAs<ast::FunctionType>();
+  // Sixth argument is scanner function
+  auto *scan_fn_type = call_args[5]->GetType()->SafeAs<ast::FunctionType>();
   if (scan_fn_type == nullptr) {
-    GetErrorReporter()->Report(call->Position(), ErrorMessages::kBadParallelScanFunction, call_args[3]->GetType());
+    GetErrorReporter()->Report(call->Position(), ErrorMessages::kBadParallelScanFunction, call_args[5]->GetType());
     return;
   }
   // Check type
@@ -953,7 +1264,7 @@ void Sema::CheckBuiltinTableIterParCall(ast::CallExpr *call) {
   const auto &params = scan_fn_type->Params();
   if (params.size() != 3 || !params[0].type_->IsPointerType() || !params[1].type_->IsPointerType() ||
       !IsPointerToSpecificBuiltin(params[2].type_, tvi_kind)) {
-    GetErrorReporter()->Report(call->Position(), ErrorMessages::kBadParallelScanFunction, call_args[3]->GetType());
+    GetErrorReporter()->Report(call->Position(), ErrorMessages::kBadParallelScanFunction, call_args[5]->GetType());
     return;
   }
 
@@ -1160,6 +1471,38 @@ void Sema::CheckBuiltinSizeOfCall(ast::CallExpr *call) {
   call->SetType(GetBuiltinType(ast::BuiltinType::Uint32));
 }
 
+void Sema::CheckBuiltinOffsetOfCall(ast::CallExpr *call) {
+  if (!CheckArgCount(call, 2)) {
+    return;
+  }
+
+  // The first argument is a struct type
+  auto *type = Resolve(call->Arguments()[0]);
+  if (type == nullptr) {
+    return;
+  }
+  auto *struct_type = type->SafeAs<ast::StructType>();
+  if (struct_type == nullptr) {
+    ReportIncorrectCallArg(call, 0, "First argument should be a struct type");
+    return;
+  }
+
+  // The second argument is the name of one of its fields. It names a field,
+  // not a variable, so it isn't resolved.
+  auto *field = call->Arguments()[1]->SafeAs<ast::IdentifierExpr>();
+  if (field == nullptr) {
+    ReportIncorrectCallArg(call, 1, "Second argument should be a field name");
+    return;
+  }
+  if (struct_type->LookupFieldByName(field->Name()) == nullptr) {
+    GetErrorReporter()->Report(field->Position(), ErrorMessages::kFieldObjectDoesNotExist, field->Name(), type);
+    return;
+  }
+
+  // This call returns an unsigned 32-bit value for the offset of the field
+  call->SetType(GetBuiltinType(ast::BuiltinType::Uint32));
+}
+
 void Sema::CheckBuiltinPtrCastCall(ast::CallExpr *call) {
   if (!CheckArgCount(call, 2)) {
     return;
@@ -1239,8 +1582,8 @@ void Sema::CheckBuiltinSorterInit(ast::CallExpr *call) {
   call->SetType(GetBuiltinType(ast::BuiltinType::Nil));
 }
 
-void Sema::CheckBuiltinSorterInsert(ast::CallExpr *call) {
-  if (!CheckArgCount(call, 1)) {
+void Sema::CheckBuiltinSorterInsert(ast::CallExpr *call, ast::Builtin builtin) {
+  if (!CheckArgCount(call, builtin == ast::Builtin::SorterInsert ? 1 : 2)) {
     return;
   }
 
@@ -1251,8 +1594,21 @@ void Sema::CheckBuiltinSorterInsert(ast::CallExpr *call) {
     return;
   }
 
-  // This call returns nothing
-  call->SetType(GetBuiltinType(ast::BuiltinType::Uint8)->PointerTo());
+  // Top-K inserts take the K
+  if (builtin != ast::Builtin::SorterInsert) {
+    const auto uint64_kind = ast::BuiltinType::Uint64;
+    if (!call->Arguments()[1]->GetType()->IsSpecificBuiltin(uint64_kind)) {
+      ReportIncorrectCallArg(call, 1, GetBuiltinType(uint64_kind));
+      return;
+    }
+  }
+
+  // Inserts return a pointer to the tuple to fill. Finishing a Top-K insert returns nothing.
+  if (builtin == ast::Builtin::SorterInsertTopKFinish) {
+    call->SetType(GetBuiltinType(ast::BuiltinType::Nil));
+  } else {
+    call->SetType(GetBuiltinType(ast::BuiltinType::Uint8)->PointerTo());
+  }
 }
 
 void Sema::CheckBuiltinSorterSort(ast::CallExpr *call, ast::Builtin builtin) {
@@ -1329,6 +1685,60 @@ void Sema::CheckBuiltinSorterFree(ast::CallExpr *call) {
   call->SetType(GetBuiltinType(ast::BuiltinType::Nil));
 }
 
+void Sema::CheckBuiltinTopKThresholdCall(ast::CallExpr *call, ast::Builtin builtin) {
+  const auto &args = call->Arguments();
+  const auto threshold_kind = ast::BuiltinType::TopKThreshold;
+
+  switch (builtin) {
+    case ast::Builtin::TopKThresholdInit: {
+      if (!CheckArgCount(call, 2)) {
+        return;
+      }
+      // First argument must be a pointer to a TopKThreshold
+      if (!IsPointerToSpecificBuiltin(args[0]->GetType(), threshold_kind)) {
+        ReportIncorrectCallArg(call, 0, GetBuiltinType(threshold_kind)->PointerTo());
+        return;
+      }
+      // Second argument is whether the leading sort key is ascending
+      const auto bool_kind = ast::BuiltinType::Bool;
+      if (!args[1]->GetType()->IsSpecificBuiltin(bool_kind)) {
+        ReportIncorrectCallArg(call, 1, GetBuiltinType(bool_kind));
+        return;
+      }
+      break;
+    }
+    case ast::Builtin::SorterSetTopKThreshold: {
+      if (!CheckArgCount(call, 3)) {
+        return;
+      }
+      // First argument must be a pointer to a Sorter
+      const auto sorter_kind = ast::BuiltinType::Sorter;
+      if (!IsPointerToSpecificBuiltin(args[0]->GetType(), sorter_kind)) {
+        ReportIncorrectCallArg(call, 0, GetBuiltinType(sorter_kind)->PointerTo());
+        return;
+      }
+      // Second argument must be a pointer to a TopKThreshold
+      if (!IsPointerToSpecificBuiltin(args[1]->GetType(), threshold_kind)) {
+        ReportIncorrectCallArg(call, 1, GetBuiltinType(threshold_kind)->PointerTo());
+        return;
+      }
+      // Third argument is the offset of the SQL integer holding the leading sort key
+      const auto uint32_kind = ast::BuiltinType::Uint32;
+      if (!args[2]->GetType()->IsSpecificBuiltin(uint32_kind)) {
+        ReportIncorrectCallArg(call, 2, GetBuiltinType(uint32_kind));
+        return;
+      }
+      break;
+    }
+    default: {
+      UNREACHABLE("Impossible Top-K threshold call");
+    }
+  }
+
+  // This call returns nothing
+  call->SetType(GetBuiltinType(ast::BuiltinType::Nil));
+}
+
 void Sema::CheckBuiltinSorterIterCall(ast::CallExpr *call, ast::Builtin builtin) {
   if (!CheckArgCountAtLeast(call, 1)) {
     return;
@@ -1634,6 +2044,11 @@ void Sema::CheckBuiltinCall(ast::CallExpr *call) {
     return;
   }
 
+  if (builtin == ast::Builtin::OffsetOf) {
+    CheckBuiltinOffsetOfCall(call);
+    return;
+  }
+
   // First, resolve all call arguments. If any fail, exit immediately.
   for (auto *arg : call->Arguments()) {
     auto *resolved_type = Resolve(arg);
@@ -1658,8 +2073,12 @@ void Sema::CheckBuiltinCall(ast::CallExpr *call) {
     case ast::Builtin::FilterGt:
     case ast::Builtin::FilterLt:
     case ast::Builtin::FilterNe:
-    case ast::Builtin::FilterLe: {
-      CheckBuiltinFilterCall(call);
+    case ast::Builtin::FilterLe:
+    case ast::Builtin::FilterBetween:
+    case ast::Builtin::FilterIn:
+    case ast::Builtin::FilterStringEq:
+    case ast::Builtin::FilterStringPrefix: {
+      CheckBuiltinFilterCall(call, builtin);
       break;
     }
     case ast::Builtin::ExecutionContextGetMemoryPool: {
@@ -1677,7 +2096,9 @@ void Sema::CheckBuiltinCall(ast::CallExpr *call) {
     case ast::Builtin::TableIterInitBind:
     case ast::Builtin::TableIterAdvance:
     case ast::Builtin::TableIterGetPCI:
-    case ast::Builtin::TableIterClose: {
+    case ast::Builtin::TableIterClose:
+    case ast::Builtin::TableIterSetTopKThreshold:
+    case ast::Builtin::TableIterAddRuntimeFilter: {
       CheckBuiltinTableIterCall(call, builtin);
       break;
     }
@@ -1749,6 +2170,22 @@ void Sema::CheckBuiltinCall(ast::CallExpr *call) {
       CheckBuiltinAggPartIterCall(call, builtin);
       break;
     }
+    case ast::Builtin::DirectMappedAggTableInit:
+    case ast::Builtin::DirectMappedAggTableInDomain:
+    case ast::Builtin::DirectMappedAggTableLookup:
+    case ast::Builtin::DirectMappedAggTableInsert:
+    case ast::Builtin::DirectMappedAggTableFree: {
+      CheckBuiltinDirectMappedAggTableCall(call, builtin);
+      break;
+    }
+    case ast::Builtin::DirectMappedAggTableIterInit:
+    case ast::Builtin::DirectMappedAggTableIterHasNext:
+    case ast::Builtin::DirectMappedAggTableIterNext:
+    case ast::Builtin::DirectMappedAggTableIterGetRow:
+    case ast::Builtin::DirectMappedAggTableIterClose: {
+      CheckBuiltinDirectMappedAggTableIterCall(call, builtin);
+      break;
+    }
     case ast::Builtin::AggInit:
     case ast::Builtin::AggAdvance:
     case ast::Builtin::AggMerge:
@@ -1782,7 +2219,8 @@ void Sema::CheckBuiltinCall(ast::CallExpr *call) {
       break;
     }
     case ast::Builtin::JoinHashTableBuild:
-    case ast::Builtin::JoinHashTableBuildParallel: {
+    case ast::Builtin::JoinHashTableBuildParallel:
+    case ast::Builtin::JoinHashTableBuildBloomFilter: {
       CheckBuiltinJoinHashTableBuild(call, builtin);
       break;
     }
@@ -1790,12 +2228,21 @@ void Sema::CheckBuiltinCall(ast::CallExpr *call) {
       CheckBuiltinJoinHashTableFree(call);
       break;
     }
+    case ast::Builtin::JoinHashTableEnableSpilling:
+    case ast::Builtin::JoinHashTableIsSpilled:
+    case ast::Builtin::JoinHashTableDeferProbe:
+    case ast::Builtin::JoinHashTableJoinSpilled: {
+      CheckBuiltinJoinHashTableSpillCall(call, builtin);
+      break;
+    }
     case ast::Builtin::SorterInit: {
       CheckBuiltinSorterInit(call);
       break;
     }
-    case ast::Builtin::SorterInsert: {
-      CheckBuiltinSorterInsert(call);
+    case ast::Builtin::SorterInsert:
+    case ast::Builtin::SorterInsertTopK:
+    case ast::Builtin::SorterInsertTopKFinish: {
+      CheckBuiltinSorterInsert(call, builtin);
       break;
     }
     case ast::Builtin::SorterSort:
@@ -1808,6 +2255,11 @@ void Sema::CheckBuiltinCall(ast::CallExpr *call) {
       CheckBuiltinSorterFree(call);
       break;
     }
+    case ast::Builtin::SorterSetTopKThreshold:
+    case ast::Builtin::TopKThresholdInit: {
+      CheckBuiltinTopKThresholdCall(call, builtin);
+      break;
+    }
     case ast::Builtin::SorterIterInit:
     case ast::Builtin::SorterIterHasNext:
     case ast::Builtin::SorterIterNext:
@@ -1,18 +1,19 @@
 #include "execution/sql/aggregation_hash_table.h"
 
 #include <algorithm>
+#include <cstring>
 #include <utility>
 #include <vector>
 
-#include "tbb/tbb.h"
-
 #include "libcount/hll.h"
 
 #include "common/math_util.h"
+#include "execution/exec/query_scheduler.h"
 #include "execution/sql/projected_columns_iterator.h"
 #include "execution/sql/thread_state_container.h"
 #include "execution/util/bit_util.h"
 #include "execution/util/cpu_info.h"
+#include "execution/util/hash.h"
 #include "execution/util/timer.h"
 #include "execution/util/vector_util.h"
 #include "loggers/execution_logger.h"
@@ -34,6 +35,10 @@ AggregationHashTable::AggregationHashTable(MemoryPool *memory, const std::size_t
       partition_tails_(nullptr),
       partition_estimates_(nullptr),
       partition_tables_(nullptr),
+      partition_sizes_(nullptr),
+      partition_spills_(nullptr),
+      spill_files_(memory_),
+      spill_pending_(false),
       partition_shift_bits_(util::BitUtil::CountLeadingZeros(uint64_t(K_DEFAULT_NUM_PARTITIONS) - 1)) {
   hash_table_.SetSize(initial_size);
   max_fill_ =
@@ -73,6 +78,15 @@ AggregationHashTable::~AggregationHashTable() {
     }
     memory_->DeallocateArray(partition_tables_, K_DEFAULT_NUM_PARTITIONS);
   }
+  if (partition_sizes_ != nullptr) {
+    memory_->DeallocateArray(partition_sizes_, K_DEFAULT_NUM_PARTITIONS);
+  }
+  if (partition_spills_ != nullptr) {
+    for (uint32_t i = 0; i < K_DEFAULT_NUM_PARTITIONS; i++) {
+      partition_spills_[i].~SpilledRunList();
+    }
+    memory_->DeallocateArray(partition_spills_, K_DEFAULT_NUM_PARTITIONS);
+  }
 }
 
 void AggregationHashTable::Grow() {
@@ -111,6 +125,12 @@ byte *AggregationHashTable::Insert(const hash_t hash) {
 }
 
 byte *AggregationHashTable::InsertPartitioned(const hash_t hash) {
+  // The flush that put us over budget handed out an entry the caller was
+  // still going to write, so the spill couldn't happen then
+  if (UNLIKELY(spill_pending_)) {
+    SpillOverflowPartitions();
+  }
+
   byte *ret = Insert(hash);
   if (hash_table_.NumElements() >= flush_threshold_) {
     FlushToOverflowPartitions();
@@ -131,11 +151,14 @@ void AggregationHashTable::FlushToOverflowPartitions() {
     if (UNLIKELY(partition_tails_[part_idx] == nullptr)) {
       partition_tails_[part_idx] = entry;
     }
+    partition_sizes_[part_idx]++;
     partition_estimates_[part_idx]->Update(entry->hash_);
   });
 
   // Update stats
   stats_.num_flushes_++;
+
+  spill_pending_ = OverflowExceedsBudget();
 }
 
 void AggregationHashTable::AllocateOverflowPartitions() {
@@ -150,6 +173,7 @@ void AggregationHashTable::AllocateOverflowPartitions() {
       partition_estimates_[i] = libcount::HLL::Create(K_DEFAULT_HLL_PRECISION);
     }
     partition_tables_ = memory_->AllocateArray<AggregationHashTable *>(K_DEFAULT_NUM_PARTITIONS, true);
+    partition_sizes_ = memory_->AllocateArray<uint64_t>(K_DEFAULT_NUM_PARTITIONS, true);
   }
 }
 
@@ -237,6 +261,12 @@ void AggregationHashTable::ComputeHashAndLoadInitialImpl(ProjectedColumnsIterato
   iters[0]->Reset();
 
   // Load entries
+  LoadChainHeads<Prefetch>(num_elems, hashes, entries);
+}
+
+template <bool Prefetch>
+void AggregationHashTable::LoadChainHeads(const uint32_t num_elems, const hash_t hashes[],
+                                          HashTableEntry *entries[]) const {
   for (uint32_t idx = 0, prefetch_idx = common::Constants::K_PREFETCH_DISTANCE; idx < num_elems;
        idx++, prefetch_idx++) {
     // NOLINTNEXTLINE: bugprone-suspicious-semicolon: seems like a false positive because of constexpr
@@ -269,6 +299,11 @@ void AggregationHashTable::FollowNextLoop(ProjectedColumnsIterator *iters[], uin
                               key_eq_fn(entries[group_sel[idx]]->payload_, iters);
       const bool has_next = entries[group_sel[idx]]->next_ != nullptr;
 
+      // The end of the chain without a match means the group doesn't exist
+      if (!keys_match && !has_next) {
+        entries[group_sel[idx]] = nullptr;
+      }
+
       group_sel[write_idx] = group_sel[idx];
       write_idx += static_cast<uint32_t>(!keys_match && has_next);
     }
@@ -334,6 +369,275 @@ void AggregationHashTable::AdvanceGroups(ProjectedColumnsIterator *iters[], uint
   }
 }
 
+template <typename KeyType>
+void AggregationHashTable::LookupOrCreateGroups(const ProjectedColumnsIterator *iter, const uint32_t key_col_idx,
+                                                const std::size_t key_offset, const InitGroupFn init_group_fn,
+                                                byte *groups[]) {
+  TERRIER_ASSERT(key_offset + sizeof(KeyType) <= payload_size_, "Key does not fit in the payload");
+  const uint32_t num_elems = iter->NumSelected();
+  const uint32_t *sel = iter->GetSelectionVector();
+  const KeyType *key_col = iter->GetColumnData<KeyType>(key_col_idx);
+
+  // Gather the keys into a dense vector, and hash them
+  alignas(common::Constants::CACHELINE_SIZE) KeyType keys[common::Constants::K_DEFAULT_VECTOR_SIZE];
+  alignas(common::Constants::CACHELINE_SIZE) hash_t hashes[common::Constants::K_DEFAULT_VECTOR_SIZE];
+  alignas(common::Constants::CACHELINE_SIZE) HashTableEntry *entries[common::Constants::K_DEFAULT_VECTOR_SIZE];
+  if (sel == nullptr) {
+    std::memcpy(keys, key_col, num_elems * sizeof(KeyType));
+  } else {
+    for (uint32_t idx = 0; idx < num_elems; idx++) {
+      keys[idx] = key_col[sel[idx]];
+    }
+  }
+  for (uint32_t idx = 0; idx < num_elems; idx++) {
+    hashes[idx] = util::Hasher::Hash(keys[idx]);
+  }
+
+  // Load the candidate groups, prefetching if the table is larger than cache
+  if (hash_table_.GetTotalMemoryUsage() > CpuInfo::Instance()->GetCacheSize(CpuInfo::L3_CACHE)) {
+    LoadChainHeads<true>(num_elems, hashes, entries);
+  } else {
+    LoadChainHeads<false>(num_elems, hashes, entries);
+  }
+
+  const auto find_group = [&](HashTableEntry *entry, const uint32_t idx) -> byte * {
+    for (; entry != nullptr; entry = entry->next_) {
+      if (entry->hash_ == hashes[idx] &&
+          *reinterpret_cast<const KeyType *>(entry->payload_ + key_offset) == keys[idx]) {
+        return entry->payload_;
+      }
+    }
+    return nullptr;
+  };
+
+  // Resolve the groups that exist
+  alignas(common::Constants::CACHELINE_SIZE) uint32_t missing_sel[common::Constants::K_DEFAULT_VECTOR_SIZE];
+  uint32_t num_missing = 0;
+  for (uint32_t idx = 0; idx < num_elems; idx++) {
+    groups[idx] = find_group(entries[idx], idx);
+    missing_sel[num_missing] = idx;
+    num_missing += static_cast<uint32_t>(groups[idx] == nullptr);
+  }
+
+  // Create the missing groups. An earlier tuple of the vector may have created
+  // the group already, and inserts may have grown the table, so look again.
+  for (uint32_t i = 0; i < num_missing; i++) {
+    const uint32_t idx = missing_sel[i];
+    byte *group = find_group(hash_table_.FindChainHead(hashes[idx]), idx);
+    if (group == nullptr) {
+      group = Insert(hashes[idx]);
+      *reinterpret_cast<KeyType *>(group + key_offset) = keys[idx];
+      init_group_fn(group);
+    }
+    groups[idx] = group;
+  }
+}
+
+template void AggregationHashTable::LookupOrCreateGroups<int8_t>(const ProjectedColumnsIterator *, uint32_t,
+                                                                 std::size_t, InitGroupFn, byte *[]);
+template void AggregationHashTable::LookupOrCreateGroups<int16_t>(const ProjectedColumnsIterator *, uint32_t,
+                                                                  std::size_t, InitGroupFn, byte *[]);
+template void AggregationHashTable::LookupOrCreateGroups<int32_t>(const ProjectedColumnsIterator *, uint32_t,
+                                                                  std::size_t, InitGroupFn, byte *[]);
+template void AggregationHashTable::LookupOrCreateGroups<int64_t>(const ProjectedColumnsIterator *, uint32_t,
+                                                                  std::size_t, InitGroupFn, byte *[]);
+
+void AggregationHashTable::AllocateSpillPartitions() {
+  if (partition_spills_ == nullptr) {
+    partition_spills_ = memory_->AllocateArray<SpilledRunList>(K_DEFAULT_NUM_PARTITIONS, false);
+    for (uint32_t i = 0; i < K_DEFAULT_NUM_PARTITIONS; i++) {
+      new (&partition_spills_[i]) SpilledRunList();
+    }
+  }
+}
+
+bool AggregationHashTable::OverflowExceedsBudget() const {
+  const uint64_t budget = memory_->GetMemoryBudget();
+  if (budget == 0) {
+    return false;
+  }
+  // The other operators of the query may hold most of the memory
+  if (memory_->ExceedsMemoryBudget()) {
+    return true;
+  }
+  uint64_t num_entries = entries_.size();
+  for (const auto &owned : owned_entries_) {
+    num_entries += owned.size();
+  }
+  return num_entries * entries_.ElementSize() > budget;
+}
+
+void AggregationHashTable::SpillOverflowPartitions() {
+  TERRIER_ASSERT(hash_table_.NumElements() == 0, "Only entries in overflow partitions can be spilled");
+  spill_pending_ = false;
+  AllocateSpillPartitions();
+
+  const std::size_t entry_size = entries_.ElementSize();
+
+  // Partitions that are already on disk go first, since they will be read back
+  // from disk anyway. Then go the largest ones, which free up the most memory
+  // per file.
+  std::vector<uint32_t> victims;
+  uint64_t num_resident = 0;
+  for (uint32_t part_idx = 0; part_idx < K_DEFAULT_NUM_PARTITIONS; part_idx++) {
+    if (partition_sizes_[part_idx] > 0) {
+      victims.push_back(part_idx);
+      num_resident += partition_sizes_[part_idx];
+    }
+  }
+  std::sort(victims.begin(), victims.end(), [this](const uint32_t a, const uint32_t b) {
+    if (IsSpilled(a) != IsSpilled(b)) {
+      return IsSpilled(a);
+    }
+    return partition_sizes_[a] > partition_sizes_[b];
+  });
+
+  // Each spill appends one run per spilled partition to the spill file. Leave
+  // some headroom so that the next flushes don't immediately spill again.
+  if (spill_files_.empty()) {
+    spill_files_.emplace_back(std::make_unique<SpillFile>());
+  }
+  SpillFile *file = spill_files_.back().get();
+  // If the query as a whole is over budget, release everything this table holds
+  const uint64_t max_resident = memory_->ExceedsMemoryBudget() ? 0 : memory_->GetMemoryBudget() / 2 / entry_size;
+  for (const uint32_t part_idx : victims) {
+    if (num_resident <= max_resident) {
+      break;
+    }
+    const uint64_t offset = file->Size();
+    for (HashTableEntry *entry = partition_heads_[part_idx]; entry != nullptr; entry = entry->next_) {
+      file->Append(entry, entry_size);
+    }
+    partition_spills_[part_idx].push_back({file, offset, partition_sizes_[part_idx] * entry_size});
+    num_resident -= partition_sizes_[part_idx];
+    partition_heads_[part_idx] = partition_tails_[part_idx] = nullptr;
+    partition_sizes_[part_idx] = 0;
+  }
+  file->Flush();
+
+  // The entries of the spilled partitions are spread out over all chunks, so
+  // copy the ones staying in memory into fresh chunks and release the old ones.
+  decltype(entries_) resident_entries(entry_size, MemoryPoolAllocator<byte>(memory_));
+  for (uint32_t part_idx = 0; part_idx < K_DEFAULT_NUM_PARTITIONS; part_idx++) {
+    HashTableEntry *head = nullptr, *tail = nullptr;
+    for (HashTableEntry *entry = partition_heads_[part_idx]; entry != nullptr; entry = entry->next_) {
+      auto *copy = reinterpret_cast<HashTableEntry *>(resident_entries.Append());
+      std::memcpy(static_cast<void *>(copy), entry, entry_size);
+      copy->next_ = nullptr;
+      if (tail == nullptr) {
+        head = copy;
+      } else {
+        tail->next_ = copy;
+      }
+      tail = copy;
+    }
+    partition_heads_[part_idx] = head;
+    partition_tails_[part_idx] = tail;
+  }
+  entries_ = std::move(resident_entries);
+  owned_entries_.clear();
+
+  // Update stats
+  stats_.num_spills_++;
+}
+
+template <typename F>
+void AggregationHashTable::ReadSpilledEntries(const SpillRun &run, const F &consumer) {
+  const std::size_t entry_size = entries_.ElementSize();
+  const std::size_t batch_size = entry_size * K_SPILL_READ_BATCH_SIZE;
+  auto *batch = reinterpret_cast<byte *>(memory_->AllocateAligned(batch_size, alignof(HashTableEntry), false));
+
+  ReadSpillRun(run, entry_size, batch, batch_size, [&](byte *const entries, const std::size_t num_entries) {
+    // Chain the entries in the order they were read
+    for (std::size_t i = 0; i < num_entries; i++) {
+      auto *entry = reinterpret_cast<HashTableEntry *>(entries + i * entry_size);
+      entry->next_ =
+          (i + 1 < num_entries ? reinterpret_cast<HashTableEntry *>(entries + (i + 1) * entry_size) : nullptr);
+    }
+    consumer(reinterpret_cast<HashTableEntry *>(entries));
+  });
+
+  memory_->Deallocate(batch, batch_size);
+}
+
+void AggregationHashTable::ScanSpilledPartition(void *const query_state, void *const thread_state,
+                                                const AggregationHashTable::ScanPartitionFn scan_fn,
+                                                HashTableEntry *chain, const SpilledRunList &runs,
+                                                libcount::HLL *const estimate, const uint32_t level) {
+  const std::size_t entry_size = entries_.ElementSize();
+  const uint64_t estimated_size = estimate->Estimate();
+  const uint64_t budget = memory_->GetMemoryBudget();
+  const uint32_t consumed_bits = (level + 1) * K_SPILL_FANOUT_BITS;
+
+  // If the groups fit, or we're out of hash bits to split on, aggregate the
+  // whole partition in one table
+  if (budget == 0 || estimated_size * entry_size <= budget || consumed_bits > partition_shift_bits_) {
+    AggregationHashTable agg_table(memory_, payload_size_, static_cast<uint32_t>(estimated_size));
+    const auto merge = [&](HashTableEntry *head) {
+      AggregationOverflowPartitionIterator iter(&head, &head + 1);
+      merge_partition_fn_(query_state, &agg_table, &iter);
+    };
+    if (chain != nullptr) {
+      merge(chain);
+    }
+    for (const auto &run : runs) {
+      ReadSpilledEntries(run, merge);
+    }
+    scan_fn(query_state, thread_state, &agg_table);
+    return;
+  }
+
+  // Too many groups. Split the partition on the next hash bits below the ones
+  // that got us here into a new spill file, and aggregate each piece on its
+  // own. Entries are staged per piece so that pieces are written in large runs.
+  constexpr uint32_t fanout = 1u << K_SPILL_FANOUT_BITS;
+  const uint64_t shift_bits = partition_shift_bits_ - consumed_bits;
+  const uint32_t staging_capacity = K_SPILL_SPLIT_BUFFER_SIZE / entry_size * entry_size;
+  auto *staging = reinterpret_cast<byte *>(memory_->Allocate(fanout * staging_capacity, false));
+  uint32_t staged[fanout] = {0};
+  SpillFile split_file;
+  SpilledRunList split_runs[fanout];
+  std::unique_ptr<libcount::HLL> split_estimates[fanout];
+
+  const auto write_staged = [&](const uint32_t split_idx) {
+    if (staged[split_idx] > 0) {
+      const uint64_t offset = split_file.Append(staging + split_idx * staging_capacity, staged[split_idx]);
+      split_runs[split_idx].push_back({&split_file, offset, staged[split_idx]});
+      staged[split_idx] = 0;
+    }
+  };
+  const auto split = [&](HashTableEntry *head) {
+    for (HashTableEntry *entry = head; entry != nullptr; entry = entry->next_) {
+      const auto split_idx = static_cast<uint32_t>((entry->hash_ >> shift_bits) & (fanout - 1));
+      if (staged[split_idx] == staging_capacity) {
+        write_staged(split_idx);
+      }
+      std::memcpy(staging + split_idx * staging_capacity + staged[split_idx], static_cast<void *>(entry), entry_size);
+      staged[split_idx] += entry_size;
+      if (split_estimates[split_idx] == nullptr) {
+        split_estimates[split_idx].reset(libcount::HLL::Create(K_DEFAULT_HLL_PRECISION));
+      }
+      split_estimates[split_idx]->Update(entry->hash_);
+    }
+  };
+  split(chain);
+  for (const auto &run : runs) {
+    ReadSpilledEntries(run, split);
+  }
+  for (uint32_t split_idx = 0; split_idx < fanout; split_idx++) {
+    write_staged(split_idx);
+  }
+  split_file.Flush();
+  memory_->Deallocate(staging, fanout * staging_capacity);
+
+  for (uint32_t split_idx = 0; split_idx < fanout; split_idx++) {
+    if (!split_runs[split_idx].empty()) {
+      ScanSpilledPartition(query_state, thread_state, scan_fn, nullptr, split_runs[split_idx],
+                           split_estimates[split_idx].get(), level + 1);
+    }
+  }
+}
+
 void AggregationHashTable::TransferMemoryAndPartitions(
     ThreadStateContainer *const thread_states, const std::size_t agg_ht_offset,
     const AggregationHashTable::MergePartitionFn merge_partition_fn) {
@@ -364,12 +668,21 @@ void AggregationHashTable::TransferMemoryAndPartitions(
     // Now, move over their memory
     owned_entries_.emplace_back(std::move(table->entries_));
 
+    // And the files their partitions were spilled to
+    for (auto &file : table->spill_files_) {
+      spill_files_.emplace_back(std::move(file));
+    }
+
     TERRIER_ASSERT(table->owned_entries_.empty(),
                    "A thread-local aggregation table should not have any owned "
                    "entries themselves. Nested/recursive aggregations not supported.");
 
     // Now, move over their overflow partitions list
     for (uint32_t part_idx = 0; part_idx < K_DEFAULT_NUM_PARTITIONS; part_idx++) {
+      if (table->partition_heads_[part_idx] != nullptr || table->IsSpilled(part_idx)) {
+        // Update the partition's unique-count estimate
+        partition_estimates_[part_idx]->Merge(table->partition_estimates_[part_idx]);
+      }
       if (table->partition_heads_[part_idx] != nullptr) {
         // Link in the partition list
         table->partition_tails_[part_idx]->next_ = partition_heads_[part_idx];
@@ -377,11 +690,21 @@ void AggregationHashTable::TransferMemoryAndPartitions(
         if (partition_tails_[part_idx] == nullptr) {
           partition_tails_[part_idx] = table->partition_tails_[part_idx];
         }
-        // Update the partition's unique-count estimate
-        partition_estimates_[part_idx]->Merge(table->partition_estimates_[part_idx]);
+        partition_sizes_[part_idx] += table->partition_sizes_[part_idx];
+      }
+      if (table->IsSpilled(part_idx)) {
+        // Link in the partition's spilled runs
+        AllocateSpillPartitions();
+        const auto &runs = table->partition_spills_[part_idx];
+        partition_spills_[part_idx].insert(partition_spills_[part_idx].end(), runs.begin(), runs.end());
       }
     }
   }
+
+  // All thread-local partitions together may not fit
+  if (OverflowExceedsBudget()) {
+    SpillOverflowPartitions();
+  }
 }
 
 AggregationHashTable *AggregationHashTable::BuildTableOverPartition(void *const query_state,
@@ -439,11 +762,29 @@ void AggregationHashTable::ExecuteParallelPartitionedScan(void *query_state, Thr
 
   // Determine the non-empty overflow partitions
   alignas(common::Constants::CACHELINE_SIZE) uint32_t nonempty_parts[K_DEFAULT_NUM_PARTITIONS];
-  uint32_t num_nonempty_parts =
-      util::VectorUtil::FilterNe(reinterpret_cast<const intptr_t *>(partition_heads_), K_DEFAULT_NUM_PARTITIONS,
-                                 intptr_t(0), nonempty_parts, nullptr);
+  uint32_t num_nonempty_parts = 0;
+  if (partition_spills_ == nullptr) {
+    num_nonempty_parts =
+        util::VectorUtil::FilterNe(reinterpret_cast<const intptr_t *>(partition_heads_), K_DEFAULT_NUM_PARTITIONS,
+                                   intptr_t(0), nonempty_parts, nullptr);
+  } else {
+    for (uint32_t part_idx = 0; part_idx < K_DEFAULT_NUM_PARTITIONS; part_idx++) {
+      if (partition_heads_[part_idx] != nullptr || IsSpilled(part_idx)) {
+        nonempty_parts[num_nonempty_parts++] = part_idx;
+      }
+    }
+  }
+
+  exec::QueryScheduler::Instance()->ParallelFor(num_nonempty_parts, [&](const uint64_t nonempty_idx) {
+    const uint32_t part_idx = nonempty_parts[nonempty_idx];
+    // Spilled partitions are read back from disk every time they're scanned,
+    // and their tables are dropped as soon as the scan is done
+    if (IsSpilled(part_idx)) {
+      ScanSpilledPartition(query_state, thread_states->AccessThreadStateOfCurrentThread(), scan_fn,
+                           partition_heads_[part_idx], partition_spills_[part_idx], partition_estimates_[part_idx], 0);
+      return;
+    }
 
-  tbb::parallel_for_each(nonempty_parts, nonempty_parts + num_nonempty_parts, [&](const uint32_t part_idx) {
     // Build a hash table over the given partition
     auto *agg_table_part = BuildTableOverPartition(query_state, part_idx);
 
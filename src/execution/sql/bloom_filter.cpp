@@ -16,8 +16,11 @@ BloomFilter::BloomFilter(MemoryPool *memory)
 BloomFilter::BloomFilter(MemoryPool *memory, uint32_t num_elems) : BloomFilter() { Init(memory, num_elems); }
 
 BloomFilter::~BloomFilter() {
-  const auto num_bytes = GetNumBlocks() * sizeof(Block);
-  memory_->Deallocate(blocks_, num_bytes);
+  // Filters that were never initialized have no memory
+  if (blocks_ != nullptr) {
+    const auto num_bytes = GetNumBlocks() * sizeof(Block);
+    memory_->Deallocate(blocks_, num_bytes);
+  }
 }
 
 void BloomFilter::Init(MemoryPool *memory, uint32_t num_elems) {
@@ -0,0 +1,123 @@
+#include "execution/sql/direct_mapped_aggregation_table.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+#include "common/math_util.h"
+#include "execution/exec/query_scheduler.h"
+#include "execution/sql/thread_state_container.h"
+
+namespace terrier::execution::sql {
+
+namespace {
+
+// The number of occupancy bitmap words a task of a parallel merge covers
+constexpr uint64_t K_MERGE_MORSEL_WORDS = 64;
+
+}  // namespace
+
+DirectMappedAggregationTable::DirectMappedAggregationTable(MemoryPool *memory, const std::size_t payload_size,
+                                                           const int64_t min_key, const int64_t max_key)
+    : memory_(memory),
+      payload_size_(common::MathUtil::AlignTo(payload_size, alignof(std::max_align_t))),
+      min_key_(min_key),
+      num_slots_(static_cast<uint64_t>(max_key) - static_cast<uint64_t>(min_key) + 1),
+      payloads_(nullptr),
+      occupied_(nullptr),
+      num_groups_(0) {
+  TERRIER_ASSERT(IsDomainSmallEnough(min_key, max_key), "Domain is too large for a direct-mapped table");
+  payloads_ = reinterpret_cast<byte *>(
+      memory_->AllocateAligned(num_slots_ * payload_size_, alignof(std::max_align_t), false));
+  occupied_ = memory_->AllocateArray<uint32_t>(util::BitUtil::Num32BitWordsFor(num_slots_), true);
+}
+
+DirectMappedAggregationTable::~DirectMappedAggregationTable() {
+  memory_->Deallocate(payloads_, num_slots_ * payload_size_);
+  memory_->DeallocateArray(occupied_, util::BitUtil::Num32BitWordsFor(num_slots_));
+}
+
+byte *DirectMappedAggregationTable::Insert(const int64_t key) {
+  const auto slot = static_cast<uint32_t>(SlotOf(key));
+  TERRIER_ASSERT(!util::BitUtil::Test(occupied_, slot), "Group already exists");
+  util::BitUtil::Set(occupied_, slot);
+  num_groups_++;
+  return PayloadAt(slot);
+}
+
+template <typename KeyType>
+void DirectMappedAggregationTable::LookupOrCreateGroups(const ProjectedColumnsIterator *iter,
+                                                        const uint32_t key_col_idx, const std::size_t key_offset,
+                                                        const InitGroupFn init_group_fn, byte *groups[]) {
+  TERRIER_ASSERT(key_offset + sizeof(KeyType) <= payload_size_, "Key does not fit in the payload");
+  const uint32_t num_elems = iter->NumSelected();
+  const uint32_t *sel = iter->GetSelectionVector();
+  const KeyType *key_col = iter->GetColumnData<KeyType>(key_col_idx);
+
+  for (uint32_t idx = 0; idx < num_elems; idx++) {
+    const KeyType key = key_col[sel == nullptr ? idx : sel[idx]];
+    const auto slot = static_cast<uint32_t>(SlotOf(key));
+    byte *group = PayloadAt(slot);
+    if (UNLIKELY(!util::BitUtil::Test(occupied_, slot))) {
+      util::BitUtil::Set(occupied_, slot);
+      num_groups_++;
+      *reinterpret_cast<KeyType *>(group + key_offset) = key;
+      init_group_fn(group);
+    }
+    groups[idx] = group;
+  }
+}
+
+template void DirectMappedAggregationTable::LookupOrCreateGroups<int8_t>(const ProjectedColumnsIterator *, uint32_t,
+                                                                         std::size_t, InitGroupFn, byte *[]);
+template void DirectMappedAggregationTable::LookupOrCreateGroups<int16_t>(const ProjectedColumnsIterator *, uint32_t,
+                                                                          std::size_t, InitGroupFn, byte *[]);
+template void DirectMappedAggregationTable::LookupOrCreateGroups<int32_t>(const ProjectedColumnsIterator *, uint32_t,
+                                                                          std::size_t, InitGroupFn, byte *[]);
+template void DirectMappedAggregationTable::LookupOrCreateGroups<int64_t>(const ProjectedColumnsIterator *, uint32_t,
+                                                                          std::size_t, InitGroupFn, byte *[]);
+
+void DirectMappedAggregationTable::MergeSlots(const DirectMappedAggregationTable &source, const uint64_t begin_word,
+                                              const uint64_t end_word, const MergeGroupFn merge_group_fn) {
+  for (uint64_t word_idx = begin_word; word_idx < end_word; word_idx++) {
+    // Only look at the slots with a group in the source
+    for (uint32_t bits = source.occupied_[word_idx]; bits != 0; bits &= bits - 1) {
+      const auto slot = static_cast<uint32_t>(word_idx * util::BitUtil::K_BIT_WORD_SIZE + __builtin_ctz(bits));
+      if (util::BitUtil::Test(occupied_, slot)) {
+        merge_group_fn(PayloadAt(slot), source.PayloadAt(slot));
+      } else {
+        std::memcpy(PayloadAt(slot), source.PayloadAt(slot), payload_size_);
+        util::BitUtil::Set(occupied_, slot);
+      }
+    }
+  }
+}
+
+void DirectMappedAggregationTable::MergeParallel(const ThreadStateContainer *const thread_states,
+                                                 const std::size_t table_offset,
+                                                 const DirectMappedAggregationTable::MergeGroupFn merge_group_fn) {
+  std::vector<DirectMappedAggregationTable *> tl_tables;
+  thread_states->CollectThreadLocalStateElementsAs(&tl_tables, table_offset);
+
+  // Each task merges the same whole words of the occupancy bitmaps of all
+  // thread-local tables, so tasks never touch the same slot or bitmap word
+  const uint64_t num_words = util::BitUtil::Num32BitWordsFor(num_slots_);
+  const uint64_t num_morsels = (num_words + K_MERGE_MORSEL_WORDS - 1) / K_MERGE_MORSEL_WORDS;
+  exec::QueryScheduler::Instance()->ParallelFor(num_morsels, [&](const uint64_t morsel) {
+    const uint64_t begin = morsel * K_MERGE_MORSEL_WORDS;
+    const uint64_t end = std::min(begin + K_MERGE_MORSEL_WORDS, num_words);
+    for (const auto *table : tl_tables) {
+      TERRIER_ASSERT(table->min_key_ == min_key_ && table->num_slots_ == num_slots_, "Domains must match");
+      TERRIER_ASSERT(table->payload_size_ == payload_size_, "Payload sizes must match");
+      MergeSlots(*table, begin, end, merge_group_fn);
+    }
+  });
+
+  num_groups_ = 0;
+  for (uint64_t word_idx = 0; word_idx < num_words; word_idx++) {
+    num_groups_ += static_cast<uint64_t>(__builtin_popcount(occupied_[word_idx]));
+  }
+}
+
+}  // namespace terrier::execution::sql
@@ -1,5 +1,7 @@
 #include "execution/sql/filter_manager.h"
 
+#include <algorithm>
+#include <limits>
 #include <memory>
 #include <numeric>
 #include <utility>
@@ -14,35 +16,7 @@
 
 namespace terrier::execution::sql {
 
-namespace {
-
-// TODO(pmenon): Move to some Policy Factory
-std::unique_ptr<bandit::Policy> CreatePolicy(bandit::Policy::Kind policy_kind) {
-  switch (policy_kind) {
-    case bandit::Policy::Kind::EpsilonGreedy: {
-      return std::make_unique<bandit::EpsilonGreedyPolicy>(bandit::EpsilonGreedyPolicy::K_DEFAULT_EPSILON);
-    }
-    case bandit::Policy::Kind::Greedy: {
-      return std::make_unique<bandit::GreedyPolicy>();
-    }
-    case bandit::Policy::Kind::Random: {
-      return std::make_unique<bandit::RandomPolicy>();
-    }
-    case bandit::Policy::Kind::UCB: {
-      return std::make_unique<bandit::UCBPolicy>(bandit::UCBPolicy::K_DEFAULT_UCB_HYPER_PARAM);
-    }
-    case bandit::Policy::Kind::FixedAction: {
-      return std::make_unique<bandit::FixedActionPolicy>(0);
-    }
-    default: {
-      UNREACHABLE("Impossible bandit policy kind");
-    }
-  }
-}
-
-}  // namespace
-
-FilterManager::FilterManager(const bandit::Policy::Kind policy_kind) : policy_(CreatePolicy(policy_kind)) {}
+FilterManager::FilterManager(const bandit::Policy::Kind policy_kind) : policy_(bandit::Policy::Create(policy_kind)) {}
 
 FilterManager::~FilterManager() = default;
 
@@ -71,6 +45,7 @@ void FilterManager::Finalize() {
   for (uint32_t idx = 0; idx < clauses_.size(); idx++) {
     agents_.emplace_back(policy_.get(), ClauseAt(idx)->NumFlavors());
   }
+  clause_stats_.resize(clauses_.size());
 
   finalized_ = true;
 }
@@ -78,10 +53,31 @@ void FilterManager::Finalize() {
 void FilterManager::RunFilters(ProjectedColumnsIterator *const pci) {
   TERRIER_ASSERT(finalized_, "Must finalize the filter before it can be used");
 
-  // Execute the clauses in what we currently believe to be the optimal order
+  // The first vectors of every resampling interval run each clause first in
+  // turn. Otherwise, a clause would only ever be measured over the tuples the
+  // clauses ahead of it let through, and could never move ahead of them if its
+  // selectivity changes.
+  const uint64_t phase = num_runs_++ % K_RESAMPLE_INTERVAL;
+  const bool resample = clauses_.size() > 1 && phase < clauses_.size();
+  if (resample) {
+    RunFilterClause(pci, static_cast<uint32_t>(phase));
+  }
+
+  // Execute the clauses in what we currently believe to be the optimal order,
+  // until no tuple is left
   for (const uint32_t opt_clause_idx : optimal_clause_order_) {
+    if (pci->NumSelected() == 0) {
+      break;
+    }
+    if (resample && opt_clause_idx == phase) {
+      continue;
+    }
     RunFilterClause(pci, opt_clause_idx);
   }
+
+  if (resample) {
+    ReorderClauses();
+  }
 }
 
 void FilterManager::RunFilterClause(ProjectedColumnsIterator *const pci, const uint32_t clause_index) {
@@ -102,14 +98,47 @@ void FilterManager::RunFilterClause(ProjectedColumnsIterator *const pci, const u
   const auto opt_match_func = ClauseAt(clause_index)->flavors_[opt_flavor_idx];
 
   // Run the filter
+  const uint32_t num_input = pci->NumSelected();
   // NOLINTNEXTLINE
-  auto [_, exec_ms] = RunFilterClauseImpl(pci, opt_match_func);
-  (void)_;
+  auto [num_selected, exec_ms] = RunFilterClauseImpl(pci, opt_match_func);
 
   // Update the agent's state
   double reward = bandit::MultiArmedBandit::ExecutionTimeToReward(exec_ms);
   agent->Observe(reward);
   EXECUTION_LOG_DEBUG("Clause {} observed reward {}", clause_index, reward);
+
+  // Update the clause's statistics
+  if (num_input == 0) {
+    return;
+  }
+  const double cost_per_tuple = exec_ms / num_input;
+  const double selectivity = static_cast<double>(num_selected) / num_input;
+  ClauseStats *stats = &clause_stats_[clause_index];
+  if (stats->sampled_) {
+    stats->cost_per_tuple_ += K_STATS_WEIGHT * (cost_per_tuple - stats->cost_per_tuple_);
+    stats->selectivity_ += K_STATS_WEIGHT * (selectivity - stats->selectivity_);
+  } else {
+    stats->cost_per_tuple_ = cost_per_tuple;
+    stats->selectivity_ = selectivity;
+    stats->sampled_ = true;
+  }
+}
+
+void FilterManager::ReorderClauses() {
+  // Rank every clause by its cost per tuple it filters out. For independent
+  // clauses, running them in increasing rank order is optimal. Clauses that
+  // filter out nothing, or weren't measured yet, go last.
+  std::vector<double> ranks(clauses_.size(), std::numeric_limits<double>::infinity());
+  for (uint32_t idx = 0; idx < clauses_.size(); idx++) {
+    const ClauseStats &stats = clause_stats_[idx];
+    if (stats.sampled_ && stats.selectivity_ < 1.0) {
+      ranks[idx] = stats.cost_per_tuple_ / (1.0 - stats.selectivity_);
+    }
+  }
+
+  // The sort is stable to not flip between clauses with equal ranks
+  std::stable_sort(optimal_clause_order_.begin(), optimal_clause_order_.end(),
+                   [&](const uint32_t left, const uint32_t right) { return ranks[left] < ranks[right]; });
 }
 
 std::pair<uint32_t, double> FilterManager::RunFilterClauseImpl(ProjectedColumnsIterator *const pci,
@@ -9,14 +9,14 @@ GenericHashTable::GenericHashTable(float load_factor) noexcept : load_factor_(lo
 
 GenericHashTable::~GenericHashTable() {
   if (entries_ != nullptr) {
-    util::FreeHugeArray(entries_, Capacity());
+    util::FreeHugeIfLarge(entries_, sizeof(*entries_) * Capacity());
   }
 }
 
 void GenericHashTable::SetSize(uint64_t new_size) {
   TERRIER_ASSERT(new_size > 0, "New size cannot be zero!");
   if (entries_ != nullptr) {
-    util::FreeHugeArray(entries_, Capacity());
+    util::FreeHugeIfLarge(entries_, sizeof(*entries_) * Capacity());
   }
 
   auto next_size = static_cast<double>(common::MathUtil::PowerOf2Ceil(new_size));
@@ -27,7 +27,7 @@ void GenericHashTable::SetSize(uint64_t new_size) {
   capacity_ = static_cast<uint64_t>(next_size);
   mask_ = capacity_ - 1;
   num_elems_ = 0;
-  entries_ = util::MallocHugeArray<std::atomic<HashTableEntry *>>(capacity_);
+  entries_ = static_cast<std::atomic<HashTableEntry *> *>(util::MallocHugeIfLarge(sizeof(*entries_) * capacity_));
 }
 
 }  // namespace terrier::execution::sql
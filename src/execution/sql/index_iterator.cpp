@@ -1,14 +1,30 @@
+#include <utility>
+#include <vector>
+
+#include "execution/exec/query_scheduler.h"
 #include "execution/sql/index_iterator.h"
+#include "execution/sql/thread_state_container.h"
 #include "execution/sql/value.h"
 
 namespace terrier::execution::sql {
 
 IndexIterator::IndexIterator(exec::ExecutionContext *exec_ctx, uint32_t table_oid, uint32_t index_oid,
                              uint32_t *col_oids, uint32_t num_oids)
+    : IndexIterator(exec_ctx, catalog::table_oid_t(table_oid), catalog::index_oid_t(index_oid),
+                    std::vector<catalog::col_oid_t>(col_oids, col_oids + num_oids),
+                    exec_ctx->GetAccessor()->GetIndex(catalog::index_oid_t(index_oid)),
+                    exec_ctx->GetAccessor()->GetTable(catalog::table_oid_t(table_oid))) {}
+
+IndexIterator::IndexIterator(exec::ExecutionContext *exec_ctx, const catalog::table_oid_t table_oid,
+                             const catalog::index_oid_t index_oid, std::vector<catalog::col_oid_t> col_oids,
+                             const common::ManagedPointer<storage::index::Index> index,
+                             const common::ManagedPointer<storage::SqlTable> table)
     : exec_ctx_(exec_ctx),
-      col_oids_(col_oids, col_oids + num_oids),
-      index_(exec_ctx_->GetAccessor()->GetIndex(catalog::index_oid_t(index_oid))),
-      table_(exec_ctx_->GetAccessor()->GetTable(catalog::table_oid_t(table_oid))) {}
+      table_oid_(table_oid),
+      index_oid_(index_oid),
+      col_oids_(std::move(col_oids)),
+      index_(index),
+      table_(table) {}
 
 void IndexIterator::Init() {
   // Initialize projected rows for the index and the table
@@ -22,6 +38,9 @@ void IndexIterator::Init() {
   auto &index_pri = index_->GetProjectedRowInitializer();
   index_buffer_ = exec_ctx_->GetMemoryPool()->AllocateAligned(index_pri.ProjectedRowSize(), alignof(uint64_t), false);
   index_pr_ = index_pri.InitializeRow(index_buffer_);
+  hi_index_buffer_ =
+      exec_ctx_->GetMemoryPool()->AllocateAligned(index_pri.ProjectedRowSize(), alignof(uint64_t), false);
+  hi_index_pr_ = index_pri.InitializeRow(hi_index_buffer_);
 }
 
 void IndexIterator::ScanKey() {
@@ -31,6 +50,42 @@ void IndexIterator::ScanKey() {
   index_->ScanKey(*exec_ctx_->GetTxn(), *index_pr_, &tuples_);
 }
 
+void IndexIterator::ScanAscending() {
+  // Scan the index
+  tuples_.clear();
+  curr_index_ = 0;
+  index_->ScanAscending(*exec_ctx_->GetTxn(), *index_pr_, *hi_index_pr_, &tuples_);
+}
+
+bool IndexIterator::ParallelScanAscending(void *const query_state, ThreadStateContainer *const thread_states,
+                                          const ScanFn scan_fn, const uint32_t num_partitions) {
+  // Split the range. Indexes that can't split it are scanned serially, through this iterator.
+  storage::index::IndexRangePartitions partitions;
+  if (!index_->PartitionRange(*index_pr_, *hi_index_pr_, num_partitions, &partitions) || partitions.size() < 2) {
+    ScanAscending();
+    scan_fn(query_state, thread_states->AccessThreadStateOfCurrentThread(), this);
+    return true;
+  }
+  const auto num_ranges = static_cast<uint32_t>(partitions.size() - 1);
+
+  // Scan the sub-ranges in parallel, each one through its own iterator. The catalog accessor isn't thread-safe, so
+  // they share the index and table this iterator looked up.
+  exec::QueryScheduler::Instance()->ParallelFor(num_ranges, [&](const uint64_t partition) {
+    IndexIterator iter(exec_ctx_, table_oid_, index_oid_, col_oids_, index_, table_);
+    iter.Init();
+    iter.ScanPartition(partitions, static_cast<uint32_t>(partition));
+    scan_fn(query_state, thread_states->AccessThreadStateOfCurrentThread(), &iter);
+  });
+  return true;
+}
+
+void IndexIterator::ScanPartition(const storage::index::IndexRangePartitions &partitions, const uint32_t partition) {
+  // Scan the index
+  tuples_.clear();
+  curr_index_ = 0;
+  index_->ScanAscendingPartition(*exec_ctx_->GetTxn(), partitions, partition, &tuples_);
+}
+
 bool IndexIterator::Advance() {
   if (curr_index_ < tuples_.size()) {
     table_->Select(exec_ctx_->GetTxn(), tuples_[curr_index_], table_pr_);
@@ -44,5 +99,6 @@ IndexIterator::~IndexIterator() {
   // Free allocated buffers
   exec_ctx_->GetMemoryPool()->Deallocate(table_buffer_, table_pr_->Size());
   exec_ctx_->GetMemoryPool()->Deallocate(index_buffer_, index_pr_->Size());
+  exec_ctx_->GetMemoryPool()->Deallocate(hi_index_buffer_, hi_index_pr_->Size());
 }
 }  // namespace terrier::execution::sql
@@ -1,37 +1,71 @@
 #include "execution/sql/join_hash_table.h"
 
 #include <algorithm>
+#include <cstring>
 #include <limits>
 #include <utility>
 #include <vector>
 
-#include "tbb/tbb.h"
-
 #include "libcount/hll.h"
 
+#include "execution/exec/query_scheduler.h"
 #include "execution/sql/memory_pool.h"
 #include "execution/sql/thread_state_container.h"
 #include "execution/util/cpu_info.h"
 #include "execution/util/memory.h"
+#include "execution/util/stage_timer.h"
 #include "execution/util/timer.h"
 #include "loggers/execution_logger.h"
 
 namespace terrier::execution::sql {
 
 JoinHashTable::JoinHashTable(MemoryPool *memory, uint32_t tuple_size, bool use_concise_ht)
-    : entries_(sizeof(HashTableEntry) + tuple_size, MemoryPoolAllocator<byte>(memory)),
+    : memory_(memory),
+      entries_(sizeof(HashTableEntry) + tuple_size, MemoryPoolAllocator<byte>(memory)),
       owned_(memory),
       concise_hash_table_(0),
+      has_bloom_filter_(false),
       hll_estimator_(libcount::HLL::Create(K_DEFAULT_HLL_PRECISION)),
       built_(false),
-      use_concise_ht_(use_concise_ht) {}
-
-// Needed because we forward-declared HLL from libcount
-JoinHashTable::~JoinHashTable() = default;
+      use_concise_ht_(use_concise_ht),
+      max_buffered_tuples_(std::numeric_limits<uint64_t>::max()),
+      spill_level_(0),
+      partition_sizes_{0},
+      spilled_partitions_(0),
+      spill_files_(memory),
+      probe_file_(nullptr),
+      probe_tuple_size_(0),
+      staging_(nullptr),
+      staged_bytes_{0},
+      partitioned_build_(true),
+      num_build_partitions_(0),
+      build_partition_shift_(0),
+      build_partition_mask_(0),
+      partition_tables_(nullptr) {}
+
+JoinHashTable::~JoinHashTable() {
+  if (staging_ != nullptr) {
+    memory_->Deallocate(staging_, K_NUM_SPILL_PARTITIONS * K_SPILL_STAGING_SIZE);
+  }
+  if (partition_tables_ != nullptr) {
+    for (uint32_t part_idx = 0; part_idx < num_build_partitions_; part_idx++) {
+      partition_tables_[part_idx]->~JoinHashTable();
+      memory_->Deallocate(partition_tables_[part_idx], sizeof(JoinHashTable));
+    }
+    memory_->DeallocateArray(partition_tables_, num_build_partitions_);
+  }
+}
 
 byte *JoinHashTable::AllocInputTuple(const hash_t hash) {
+  // The tuple handed out by the previous call has been written by now, so
+  // buffered tuples can be moved to disk
+  if (UNLIKELY(entries_.size() >= max_buffered_tuples_)) {
+    SpillLargestPartitions();
+  }
+
   // Add to unique_count estimation
   hll_estimator_->Update(hash);
+  partition_sizes_[SpillPartitionOf(hash)]++;
 
   // Allocate space for a new tuple
   auto *entry = reinterpret_cast<HashTableEntry *>(entries_.Append());
@@ -62,8 +96,9 @@ void JoinHashTable::BuildGenericHashTableInternal() noexcept {
 }
 
 void JoinHashTable::BuildGenericHashTable() noexcept {
-  // Setup based on number of buffered build-size tuples
-  generic_hash_table_.SetSize(NumElements());
+  // Setup based on number of buffered build-size tuples. All of them may have
+  // been spilled.
+  generic_hash_table_.SetSize(std::max(uint64_t{1}, NumElements()));
 
   // Dispatch to appropriate build code based on GHT size
   uint64_t l3_cache_size = CpuInfo::Instance()->GetCacheSize(CpuInfo::L3_CACHE);
@@ -575,6 +610,13 @@ void JoinHashTable::Build() {
     return;
   }
 
+  // Spilled partitions are joined later, so their last tuples go to disk too
+  if (HasSpilledPartitions()) {
+    SpillPartitions(spilled_partitions_);
+    EXECUTION_LOG_DEBUG("JHT: {} of {} partitions spilled, {} bytes on disk", __builtin_popcountll(spilled_partitions_),
+                        K_NUM_SPILL_PARTITIONS, GetSpilledBytes());
+  }
+
   EXECUTION_LOG_DEBUG("Unique estimate: {}", hll_estimator_->Estimate());
 
   util::Timer<> timer;
@@ -594,6 +636,42 @@ void JoinHashTable::Build() {
   built_ = true;
 }
 
+const BloomFilter *JoinHashTable::BuildBloomFilter() {
+  TERRIER_ASSERT(IsBuilt(), "The table must be built before its Bloom filter");
+  if (HasSpilledPartitions()) {
+    return nullptr;
+  }
+  if (has_bloom_filter_) {
+    return &bloom_filter_;
+  }
+
+  // The build tuples are in this table, in the tables it took over, or in the
+  // tables of its build partitions
+  std::vector<decltype(entries_) *> all_entries{&entries_};
+  for (auto &owned : owned_) {
+    all_entries.push_back(&owned);
+  }
+  for (uint32_t part_idx = 0; partition_tables_ != nullptr && part_idx < num_build_partitions_; part_idx++) {
+    all_entries.push_back(&partition_tables_[part_idx]->entries_);
+  }
+
+  uint64_t num_tuples = 0;
+  for (const auto *entries : all_entries) {
+    num_tuples += entries->size();
+  }
+  bloom_filter_.Init(memory_, static_cast<uint32_t>(std::min<uint64_t>(std::max<uint64_t>(num_tuples, 1),
+                                                                        std::numeric_limits<uint32_t>::max())));
+  for (auto *entries : all_entries) {
+    for (const byte *untyped_entry : *entries) {
+      bloom_filter_.Add(reinterpret_cast<const HashTableEntry *>(untyped_entry)->hash_);
+    }
+  }
+  has_bloom_filter_ = true;
+
+  EXECUTION_LOG_DEBUG("JHT: Bloom filter of {} bytes over {} tuples", bloom_filter_.GetSizeInBytes(), num_tuples);
+  return &bloom_filter_;
+}
+
 template <bool Prefetch>
 void JoinHashTable::LookupBatchInGenericHashTableInternal(uint32_t num_tuples, const hash_t hashes[],
                                                           const HashTableEntry *results[]) const {
@@ -650,10 +728,36 @@ void JoinHashTable::LookupBatchInConciseHashTable(uint32_t num_tuples, const has
   }
 }
 
+void JoinHashTable::LookupBatchInPartitions(uint32_t num_tuples, const hash_t hashes[],
+                                            const HashTableEntry *results[]) const {
+  for (uint32_t idx = 0, prefetch_idx = common::Constants::K_PREFETCH_DISTANCE; idx < num_tuples;
+       idx++, prefetch_idx++) {
+    if (LIKELY(prefetch_idx < num_tuples)) {
+      const JoinHashTable *prefetch_table = partition_tables_[BuildPartitionOf(hashes[prefetch_idx])];
+      if (UseConciseHashTable()) {
+        prefetch_table->concise_hash_table_.PrefetchSlotGroup<true>(hashes[prefetch_idx]);
+      } else {
+        prefetch_table->generic_hash_table_.PrefetchChainHead<true>(hashes[prefetch_idx]);
+      }
+    }
+
+    const JoinHashTable *table = partition_tables_[BuildPartitionOf(hashes[idx])];
+    if (UseConciseHashTable()) {
+      // NOLINTNEXTLINE
+      const auto [found, entry_idx] = table->concise_hash_table_.Lookup(hashes[idx]);
+      results[idx] = (found ? table->EntryAt(entry_idx) : nullptr);
+    } else {
+      results[idx] = table->generic_hash_table_.FindChainHead(hashes[idx]);
+    }
+  }
+}
+
 void JoinHashTable::LookupBatch(uint32_t num_tuples, const hash_t hashes[], const HashTableEntry *results[]) const {
   TERRIER_ASSERT(IsBuilt(), "Cannot perform lookup before table is built!");
 
-  if (UseConciseHashTable()) {
+  if (partition_tables_ != nullptr) {
+    LookupBatchInPartitions(num_tuples, hashes, results);
+  } else if (UseConciseHashTable()) {
     LookupBatchInConciseHashTable(num_tuples, hashes, results);
   } else {
     LookupBatchInGenericHashTable(num_tuples, hashes, results);
@@ -697,7 +801,66 @@ void JoinHashTable::MergeParallel(const ThreadStateContainer *thread_state_conta
     hll_estimator_->Merge(jht->hll_estimator_.get());
   }
 
-  uint64_t num_elem_estimate = hll_estimator_->Estimate();
+  // A partition spilled by any thread-local table has to be spilled by all of
+  // them. Together, the partitions left in memory may still exceed the budget,
+  // in which case the largest ones are spilled too.
+  uint64_t partitions = 0;
+  for (auto *jht : tl_join_tables) {
+    partitions |= jht->spilled_partitions_;
+    for (uint32_t part_idx = 0; part_idx < K_NUM_SPILL_PARTITIONS; part_idx++) {
+      partition_sizes_[part_idx] += jht->partition_sizes_[part_idx];
+    }
+  }
+  uint64_t num_resident = 0;
+  for (uint32_t part_idx = 0; part_idx < K_NUM_SPILL_PARTITIONS; part_idx++) {
+    if ((partitions & (uint64_t{1} << part_idx)) == 0) {
+      num_resident += partition_sizes_[part_idx];
+    }
+  }
+  while (num_resident > max_buffered_tuples_) {
+    uint32_t largest = 0;
+    for (uint32_t part_idx = 0; part_idx < K_NUM_SPILL_PARTITIONS; part_idx++) {
+      if ((partitions & (uint64_t{1} << part_idx)) == 0 && partition_sizes_[part_idx] > partition_sizes_[largest]) {
+        largest = part_idx;
+      }
+    }
+    partitions |= uint64_t{1} << largest;
+    num_resident -= partition_sizes_[largest];
+  }
+
+  if (partitions != 0) {
+    exec::QueryScheduler::Instance()->ParallelFor(
+        tl_join_tables.size(), [&](const uint64_t tl_idx) { tl_join_tables[tl_idx]->SpillPartitions(partitions); });
+
+    // Take over the spilled runs and their files
+    for (auto *jht : tl_join_tables) {
+      for (uint32_t part_idx = 0; part_idx < K_NUM_SPILL_PARTITIONS; part_idx++) {
+        auto &runs = jht->build_runs_[part_idx];
+        build_runs_[part_idx].insert(build_runs_[part_idx].end(), runs.begin(), runs.end());
+      }
+      for (auto &file : jht->spill_files_) {
+        spill_files_.emplace_back(std::move(file));
+      }
+    }
+    for (uint32_t part_idx = 0; part_idx < K_NUM_SPILL_PARTITIONS; part_idx++) {
+      if ((partitions & (uint64_t{1} << part_idx)) != 0) {
+        partition_sizes_[part_idx] = 0;
+      }
+    }
+    spilled_partitions_ = partitions;
+  }
+
+  // Tables that don't fit in cache are built partition by partition. Concise
+  // tables can't be merged, so they always are.
+  const uint64_t l3_size = CpuInfo::Instance()->GetCacheSize(CpuInfo::L3_CACHE);
+  if (partitioned_build_ && (UseConciseHashTable() || num_resident * entries_.ElementSize() > l3_size)) {
+    MergeParallelPartitioned(tl_join_tables, num_resident);
+    built_ = true;
+    return;
+  }
+
+  // The HLL estimate includes the tuples on disk
+  uint64_t num_elem_estimate = std::min(hll_estimator_->Estimate(), std::max(uint64_t{1}, num_resident));
   EXECUTION_LOG_INFO("Global unique count: {}", num_elem_estimate);
 
   // Set size
@@ -709,18 +872,325 @@ void JoinHashTable::MergeParallel(const ThreadStateContainer *thread_state_conta
   owned_.reserve(tl_join_tables.size());
 
   // Is the global hash table out of cache? If so, we'll prefetch during build.
-  const uint64_t l3_size = CpuInfo::Instance()->GetCacheSize(CpuInfo::L3_CACHE);
   const bool out_of_cache = (generic_hash_table_.GetTotalMemoryUsage() > l3_size);
 
   // Merge all in parallel
-  tbb::task_scheduler_init sched;
-  tbb::parallel_for_each(tl_join_tables.begin(), tl_join_tables.end(), [this, out_of_cache](JoinHashTable *source) {
+  exec::QueryScheduler::Instance()->ParallelFor(tl_join_tables.size(), [&](const uint64_t tl_idx) {
+    JoinHashTable *source = tl_join_tables[tl_idx];
     if (out_of_cache) {
       MergeIncomplete<true, true>(source);
     } else {
       MergeIncomplete<false, true>(source);
     }
   });
+
+  built_ = true;
+}
+
+void JoinHashTable::MergeParallelPartitioned(const std::vector<JoinHashTable *> &tl_join_tables,
+                                             const uint64_t num_tuples) {
+  // Use as many partitions as possible while keeping each above the minimum
+  // size, which also keeps the directory of each partition in cache
+  const std::size_t entry_size = entries_.ElementSize();
+  uint32_t partition_bits = 0;
+  while (partition_bits < K_MAX_BUILD_PARTITION_BITS &&
+         (num_tuples >> (partition_bits + 1)) >= K_MIN_BUILD_PARTITION_TUPLES) {
+    partition_bits++;
+  }
+  num_build_partitions_ = 1u << partition_bits;
+  build_partition_shift_ = sizeof(hash_t) * 8 - K_SPILL_PARTITION_BITS - partition_bits;
+  build_partition_mask_ = num_build_partitions_ - 1;
+
+  util::StageTimer<std::milli> timer;
+  auto *scheduler = exec::QueryScheduler::Instance();
+
+  // -------------------------------------------------------
+  // 1. Count the tuples of every thread-local table in each partition
+  // -------------------------------------------------------
+
+  timer.EnterStage("Build Partition Histograms");
+
+  // offsets[i][p] counts the tuples of table 'i' in partition 'p', and once the
+  // partitions are allocated, the position table 'i' writes its next tuple of
+  // partition 'p' to
+  std::vector<std::vector<uint64_t>> offsets(tl_join_tables.size(), std::vector<uint64_t>(num_build_partitions_, 0));
+  scheduler->ParallelFor(tl_join_tables.size(), [&](const uint64_t tl_idx) {
+    auto &histogram = offsets[tl_idx];
+    for (const byte *untyped_entry : tl_join_tables[tl_idx]->entries_) {
+      histogram[BuildPartitionOf(reinterpret_cast<const HashTableEntry *>(untyped_entry)->hash_)]++;
+    }
+  });
+
+  timer.ExitStage();
+
+  // -------------------------------------------------------
+  // 2. Allocate the table of every partition with room for all its tuples
+  // -------------------------------------------------------
+
+  timer.EnterStage("Allocate Partitions");
+
+  const auto tuple_size = static_cast<uint32_t>(entry_size - sizeof(HashTableEntry));
+  partition_tables_ = memory_->AllocateArray<JoinHashTable *>(num_build_partitions_, true);
+  scheduler->ParallelFor(num_build_partitions_, [&](const uint64_t part_idx) {
+    auto *table = new (memory_->AllocateAligned(sizeof(JoinHashTable), alignof(JoinHashTable), false))
+        JoinHashTable(memory_, tuple_size, use_concise_ht_);
+    uint64_t num_part_tuples = 0;
+    for (auto &tl_offsets : offsets) {
+      const uint64_t count = tl_offsets[part_idx];
+      tl_offsets[part_idx] = num_part_tuples;
+      num_part_tuples += count;
+    }
+    for (uint64_t i = 0; i < num_part_tuples; i++) {
+      table->entries_.Append();
+    }
+    partition_tables_[part_idx] = table;
+  });
+
+  timer.ExitStage();
+
+  // -------------------------------------------------------
+  // 3. Scatter the tuples into their partitions
+  // -------------------------------------------------------
+
+  timer.EnterStage("Scatter Tuples");
+
+  // Every thread-local table writes into its own range of each partition, so
+  // no synchronization is needed
+  scheduler->ParallelFor(tl_join_tables.size(), [&](const uint64_t tl_idx) {
+    JoinHashTable *source = tl_join_tables[tl_idx];
+    auto &write_pos = offsets[tl_idx];
+    for (const byte *untyped_entry : source->entries_) {
+      const uint32_t part_idx = BuildPartitionOf(reinterpret_cast<const HashTableEntry *>(untyped_entry)->hash_);
+      std::memcpy(partition_tables_[part_idx]->entries_[write_pos[part_idx]++], untyped_entry, entry_size);
+    }
+    // The copies are all that's needed from now on
+    source->entries_ = decltype(entries_)(entry_size, MemoryPoolAllocator<byte>(source->memory_));
+  });
+
+  timer.ExitStage();
+
+  // -------------------------------------------------------
+  // 4. Build every partition's table
+  // -------------------------------------------------------
+
+  timer.EnterStage("Build Partitions");
+
+  scheduler->ParallelFor(num_build_partitions_,
+                         [this](const uint64_t part_idx) { partition_tables_[part_idx]->Build(); });
+
+  timer.ExitStage();
+
+  EXECUTION_LOG_DEBUG("Partitioned Build: {} tuples in {} partitions", num_tuples, num_build_partitions_);
+  for (const auto &stage : timer.GetStages()) {
+    EXECUTION_LOG_DEBUG("  {}: {:.2f} ms", stage.Name(), stage.Time());
+  }
+}
+
+// ---------------------------------------------------------
+// Spilling
+// ---------------------------------------------------------
+
+void JoinHashTable::SpillLargestPartitions() {
+  // Partitions that are already spilled go first, as their tuples have to go
+  // to disk anyway. Then the largest ones, until half the budget is free, so
+  // that we don't have to spill again right away.
+  uint64_t partitions = spilled_partitions_;
+  uint64_t num_resident = entries_.size();
+  for (uint32_t part_idx = 0; part_idx < K_NUM_SPILL_PARTITIONS; part_idx++) {
+    if ((partitions & (uint64_t{1} << part_idx)) != 0) {
+      num_resident -= partition_sizes_[part_idx];
+    }
+  }
+  while (num_resident > max_buffered_tuples_ / 2) {
+    uint32_t largest = 0;
+    uint64_t largest_size = 0;
+    for (uint32_t part_idx = 0; part_idx < K_NUM_SPILL_PARTITIONS; part_idx++) {
+      if ((partitions & (uint64_t{1} << part_idx)) == 0 && partition_sizes_[part_idx] > largest_size) {
+        largest = part_idx;
+        largest_size = partition_sizes_[part_idx];
+      }
+    }
+    if (largest_size == 0) {
+      break;
+    }
+    partitions |= uint64_t{1} << largest;
+    num_resident -= largest_size;
+  }
+
+  SpillPartitions(partitions);
+}
+
+void JoinHashTable::WriteStagedRun(const uint32_t part_idx, SpillFile *const file, std::vector<SpillRun> *const runs) {
+  if (staged_bytes_[part_idx] > 0) {
+    const uint64_t offset = file->Append(staging_ + part_idx * K_SPILL_STAGING_SIZE, staged_bytes_[part_idx]);
+    runs->push_back({file, offset, staged_bytes_[part_idx]});
+    staged_bytes_[part_idx] = 0;
+  }
+}
+
+void JoinHashTable::SpillPartitions(const uint64_t partitions) {
+  TERRIER_ASSERT(!IsBuilt(), "Cannot spill build tuples of a built table");
+  TERRIER_ASSERT(probe_file_ == nullptr, "Cannot spill build tuples while probing");
+  spilled_partitions_ |= partitions;
+
+  uint64_t num_spilled = 0;
+  for (uint32_t part_idx = 0; part_idx < K_NUM_SPILL_PARTITIONS; part_idx++) {
+    if ((partitions & (uint64_t{1} << part_idx)) != 0) {
+      num_spilled += partition_sizes_[part_idx];
+    }
+  }
+  if (num_spilled == 0) {
+    return;
+  }
+
+  if (spill_files_.empty()) {
+    spill_files_.emplace_back(std::make_unique<SpillFile>());
+  }
+  if (staging_ == nullptr) {
+    staging_ = reinterpret_cast<byte *>(memory_->Allocate(K_NUM_SPILL_PARTITIONS * K_SPILL_STAGING_SIZE, false));
+  }
+  SpillFile *file = spill_files_.back().get();
+  const std::size_t entry_size = entries_.ElementSize();
+  const uint32_t staging_capacity = K_SPILL_STAGING_SIZE / entry_size * entry_size;
+
+  // Stage the tuples of spilled partitions so that each partition is written
+  // in large runs, and copy the rest into fresh chunks so the memory of the
+  // spilled ones is released
+  decltype(entries_) resident_entries(entry_size, MemoryPoolAllocator<byte>(memory_));
+  for (const byte *untyped_entry : entries_) {
+    const auto *entry = reinterpret_cast<const HashTableEntry *>(untyped_entry);
+    const uint32_t part_idx = SpillPartitionOf(entry->hash_);
+    if ((partitions & (uint64_t{1} << part_idx)) == 0) {
+      std::memcpy(resident_entries.Append(), untyped_entry, entry_size);
+      continue;
+    }
+    if (UNLIKELY(entry_size > K_SPILL_STAGING_SIZE)) {
+      // Tuples too wide to stage are written out as runs of their own
+      build_runs_[part_idx].push_back({file, file->Append(untyped_entry, entry_size), entry_size});
+      continue;
+    }
+    if (staged_bytes_[part_idx] + entry_size > staging_capacity) {
+      WriteStagedRun(part_idx, file, &build_runs_[part_idx]);
+    }
+    TERRIER_ASSERT(staged_bytes_[part_idx] + entry_size <= K_SPILL_STAGING_SIZE, "Staged tuple overflows its buffer");
+    std::memcpy(staging_ + part_idx * K_SPILL_STAGING_SIZE + staged_bytes_[part_idx], untyped_entry, entry_size);
+    staged_bytes_[part_idx] += entry_size;
+  }
+  for (uint32_t part_idx = 0; part_idx < K_NUM_SPILL_PARTITIONS; part_idx++) {
+    WriteStagedRun(part_idx, file, &build_runs_[part_idx]);
+    if ((partitions & (uint64_t{1} << part_idx)) != 0) {
+      partition_sizes_[part_idx] = 0;
+    }
+  }
+  file->Flush();
+
+  entries_ = std::move(resident_entries);
+  EXECUTION_LOG_DEBUG("JHT: spilled {} tuples, {} left in memory", num_spilled, entries_.size());
+}
+
+void JoinHashTable::EnableSpilling() {
+  TERRIER_ASSERT(entries_.empty(), "Spilling must be enabled before inserting tuples");
+  if (const uint64_t budget = memory_->GetMemoryBudget(); budget != 0) {
+    max_buffered_tuples_ = std::max(uint64_t{1}, budget / entries_.ElementSize());
+  }
+}
+
+void JoinHashTable::DeferProbeTuple(const hash_t hash, const byte *const probe_tuple,
+                                    const uint32_t probe_tuple_size) {
+  TERRIER_ASSERT(IsSpilled(hash), "Only probes of spilled partitions should be deferred");
+  common::SpinLatch::ScopedSpinLatch latch(&probe_latch_);
+
+  if (UNLIKELY(probe_file_ == nullptr)) {
+    spill_files_.emplace_back(std::make_unique<SpillFile>());
+    probe_file_ = spill_files_.back().get();
+    probe_tuple_size_ = probe_tuple_size;
+    if (staging_ == nullptr) {
+      staging_ = reinterpret_cast<byte *>(memory_->Allocate(K_NUM_SPILL_PARTITIONS * K_SPILL_STAGING_SIZE, false));
+    }
+  }
+  TERRIER_ASSERT(probe_tuple_size == probe_tuple_size_, "All deferred probe tuples must have the same size");
+
+  // Probe records are the hash followed by the tuple
+  const uint32_t record_size = sizeof(hash_t) + probe_tuple_size_;
+  const uint32_t part_idx = SpillPartitionOf(hash);
+  if (UNLIKELY(record_size > K_SPILL_STAGING_SIZE)) {
+    // Records too wide to stage are written out as runs of their own. The tuple is appended right after the hash.
+    const uint64_t offset = probe_file_->Append(&hash, sizeof(hash_t));
+    probe_file_->Append(probe_tuple, probe_tuple_size_);
+    probe_runs_[part_idx].push_back({probe_file_, offset, record_size});
+    return;
+  }
+  if (staged_bytes_[part_idx] + record_size > K_SPILL_STAGING_SIZE) {
+    WriteStagedRun(part_idx, probe_file_, &probe_runs_[part_idx]);
+  }
+  TERRIER_ASSERT(staged_bytes_[part_idx] + record_size <= K_SPILL_STAGING_SIZE, "Staged record overflows its buffer");
+  byte *record = staging_ + part_idx * K_SPILL_STAGING_SIZE + staged_bytes_[part_idx];
+  std::memcpy(record, &hash, sizeof(hash_t));
+  std::memcpy(record + sizeof(hash_t), probe_tuple, probe_tuple_size_);
+  staged_bytes_[part_idx] += record_size;
+}
+
+void JoinHashTable::JoinSpilledPartitions(void *const ctx, const JoinHashTable::SpilledProbeFn probe_fn) {
+  if (probe_file_ == nullptr) {
+    // Nothing probed a spilled partition
+    return;
+  }
+
+  for (uint32_t part_idx = 0; part_idx < K_NUM_SPILL_PARTITIONS; part_idx++) {
+    WriteStagedRun(part_idx, probe_file_, &probe_runs_[part_idx]);
+  }
+  probe_file_->Flush();
+
+  const std::size_t entry_size = entries_.ElementSize();
+  const std::size_t tuple_size = entry_size - sizeof(HashTableEntry);
+  const std::size_t record_size = sizeof(hash_t) + probe_tuple_size_;
+  // The read buffer holds at least one tuple of either side
+  const std::size_t buffer_size = std::max({std::size_t{K_SPILL_READ_BATCH_SIZE}, entry_size, record_size});
+  auto *buffer = reinterpret_cast<byte *>(memory_->Allocate(buffer_size, false));
+
+  for (uint32_t part_idx = 0; part_idx < K_NUM_SPILL_PARTITIONS; part_idx++) {
+    if (probe_runs_[part_idx].empty()) {
+      continue;
+    }
+
+    // Load the build side of the partition into a table of its own, which is
+    // partitioned on the next bits of the hash and spills in turn if the
+    // partition still doesn't fit. At the last level, it's loaded whole.
+    JoinHashTable partition_table(memory_, static_cast<uint32_t>(tuple_size), use_concise_ht_);
+    partition_table.spill_level_ = spill_level_ + 1;
+    if (partition_table.spill_level_ < K_MAX_SPILL_LEVELS) {
+      partition_table.max_buffered_tuples_ = max_buffered_tuples_;
+    }
+    for (const auto &run : build_runs_[part_idx]) {
+      ReadSpillRun(run, entry_size, buffer, buffer_size, [&](byte *entries, std::size_t num_entries) {
+        for (std::size_t i = 0; i < num_entries; i++) {
+          const auto *entry = reinterpret_cast<const HashTableEntry *>(entries + i * entry_size);
+          std::memcpy(partition_table.AllocInputTuple(entry->hash_), entry->payload_, tuple_size);
+        }
+      });
+    }
+    partition_table.Build();
+
+    // Probe it, deferring the probes of its own spilled partitions, which are
+    // joined recursively
+    for (const auto &run : probe_runs_[part_idx]) {
+      ReadSpillRun(run, record_size, buffer, buffer_size, [&](byte *records, std::size_t num_records) {
+        for (std::size_t i = 0; i < num_records; i++) {
+          const byte *record = records + i * record_size;
+          hash_t hash;
+          std::memcpy(&hash, record, sizeof(hash_t));
+          if (partition_table.IsSpilled(hash)) {
+            partition_table.DeferProbeTuple(hash, record + sizeof(hash_t), probe_tuple_size_);
+          } else {
+            probe_fn(ctx, &partition_table, hash, record + sizeof(hash_t));
+          }
+        }
+      });
+    }
+    partition_table.JoinSpilledPartitions(ctx, probe_fn);
+  }
+
+  memory_->Deallocate(buffer, buffer_size);
 }
 
 }  // namespace terrier::execution::sql
@@ -1,27 +1,239 @@
 #include "execution/sql/memory_pool.h"
 
+#include <array>
 #include <cstdlib>
 #include <memory>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include "common/constants.h"
+#include "common/strong_typedef.h"
+#include "execution/sql/memory_tracker.h"
 #include "execution/util/memory.h"
+#include "tbb/enumerable_thread_specific.h"
 
 namespace terrier::execution::sql {
 
 // If the allocation size is larger than this value, use huge pages
-std::atomic<uint64_t> MemoryPool::k_mmap_threshold = 64 * common::Constants::MB;
+std::atomic<uint64_t> MemoryPool::k_mmap_threshold = util::K_HUGE_PAGE_SIZE;
 
 // Minimum alignment to abide by
 static constexpr uint32_t K_MIN_MALLOC_ALIGNMENT = 8;
 
-MemoryPool::MemoryPool(MemoryTracker *tracker) : tracker_(tracker) {}
+namespace {
+
+// The smallest arena block. All size classes are multiples of it, so every block is aligned to it.
+constexpr std::size_t K_MIN_BLOCK_SIZE = common::Constants::CACHELINE_SIZE;
+
+// The largest arena block. Larger allocations go to the system allocator.
+constexpr std::size_t K_MAX_BLOCK_SIZE = 256 * common::Constants::KB;
+
+// The size of the slabs arena blocks are carved from
+constexpr std::size_t K_SLAB_SIZE = common::Constants::MB;
+
+// The number of free slabs kept for later queries
+constexpr std::size_t K_MAX_CACHED_SLABS = 64;
+
+// Size classes are 64, 128, 192 and 256 bytes, then four per power of two up to K_MAX_BLOCK_SIZE, so that no more
+// than a quarter of a block is wasted
+constexpr uint32_t K_NUM_SIZE_CLASSES = 44;
+
+uint32_t SizeClass(const std::size_t size) {
+  if (size <= 4 * K_MIN_BLOCK_SIZE) {
+    return size == 0 ? 0 : static_cast<uint32_t>((size - 1) / K_MIN_BLOCK_SIZE);
+  }
+  const uint64_t last_byte = size - 1;
+  const auto log = static_cast<uint32_t>(63 - __builtin_clzll(last_byte));
+  return 4 + (log - 8) * 4 + static_cast<uint32_t>((last_byte >> (log - 2)) & 3);
+}
+
+std::size_t ClassSize(const uint32_t size_class) {
+  if (size_class < 4) {
+    return (size_class + 1) * K_MIN_BLOCK_SIZE;
+  }
+  const uint32_t log = 8 + (size_class - 4) / 4;
+  return std::size_t{5 + (size_class - 4) % 4} << (log - 2);
+}
+
+/**
+ * Free slabs, shared by all pools
+ */
+class SlabCache {
+ public:
+  static SlabCache *Instance() {
+    static SlabCache instance;
+    return &instance;
+  }
+
+  ~SlabCache() {
+    for (void *slab : slabs_) std::free(slab);
+  }
+
+  void *Get() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!slabs_.empty()) {
+        void *slab = slabs_.back();
+        slabs_.pop_back();
+        return slab;
+      }
+    }
+    return util::MallocAligned(K_SLAB_SIZE, K_MIN_BLOCK_SIZE);
+  }
+
+  void Put(const std::vector<void *> &slabs) {
+    auto iter = slabs.begin();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (; iter != slabs.end() && slabs_.size() < K_MAX_CACHED_SLABS; ++iter) {
+        slabs_.push_back(*iter);
+      }
+    }
+    for (; iter != slabs.end(); ++iter) {
+      std::free(*iter);
+    }
+  }
+
+ private:
+  std::mutex mutex_;
+  std::vector<void *> slabs_;
+};
+
+}  // namespace
+
+/**
+ * The per-thread arenas of a pool. A thread bumps through its current slab, and reuses the blocks freed on it.
+ */
+class MemoryPool::Arena {
+ public:
+  ~Arena() {
+    for (auto &thread_arena : thread_arenas_) {
+      SlabCache::Instance()->Put(thread_arena.slabs_);
+    }
+  }
+
+  void *Allocate(const std::size_t size) {
+    ThreadArena &arena = thread_arenas_.local();
+    const uint32_t size_class = SizeClass(size);
+    if (void *block = arena.free_blocks_[size_class]; block != nullptr) {
+      arena.free_blocks_[size_class] = *static_cast<void **>(block);
+      return block;
+    }
+    const std::size_t block_size = ClassSize(size_class);
+    if (static_cast<std::size_t>(arena.end_ - arena.pos_) < block_size) {
+      NextSlab(&arena);
+    }
+    void *block = arena.pos_;
+    arena.pos_ += block_size;
+    return block;
+  }
+
+  void Deallocate(void *const ptr, const std::size_t size) {
+    if (num_over_aligned_.load(std::memory_order_relaxed) != 0 && DeallocateOverAligned(ptr)) {
+      return;
+    }
+    ThreadArena &arena = thread_arenas_.local();
+    const uint32_t size_class = SizeClass(size);
+    *static_cast<void **>(ptr) = arena.free_blocks_[size_class];
+    arena.free_blocks_[size_class] = ptr;
+  }
+
+  // Small allocations aligned beyond a cache line come from the system allocator. They are rare, so they are only
+  // looked up on deallocation while some are live.
+  void *AllocateOverAligned(const std::size_t size, const std::size_t alignment) {
+    void *buf = util::MallocAligned(size, alignment);
+    std::lock_guard<std::mutex> lock(over_aligned_mutex_);
+    over_aligned_.insert(buf);
+    num_over_aligned_.fetch_add(1, std::memory_order_relaxed);
+    return buf;
+  }
+
+#ifndef NDEBUG
+  void TrackAllocation(void *const ptr, const std::size_t size) {
+    std::lock_guard<std::mutex> lock(live_mutex_);
+    live_[ptr] = size;
+  }
+
+  void CheckDeallocation(void *const ptr, const std::size_t size) {
+    std::lock_guard<std::mutex> lock(live_mutex_);
+    auto iter = live_.find(ptr);
+    TERRIER_ASSERT(iter != live_.end(), "Deallocating memory that wasn't allocated by this pool");
+    TERRIER_ASSERT(iter->second == size, "Memory must be deallocated with the size it was allocated with");
+    live_.erase(iter);
+  }
+#endif
+
+ private:
+  struct ThreadArena {
+    // The heads of the lists of free blocks, one per size class. A free block stores the next one.
+    std::array<void *, K_NUM_SIZE_CLASSES> free_blocks_{};
+    // The unused part of the current slab
+    byte *pos_{nullptr};
+    byte *end_{nullptr};
+    std::vector<void *> slabs_;
+  };
+
+  static void NextSlab(ThreadArena *const arena) {
+    // The end of the current slab is too small for this block, but not for smaller ones
+    while (static_cast<std::size_t>(arena->end_ - arena->pos_) >= K_MIN_BLOCK_SIZE) {
+      const std::size_t remaining = std::min(static_cast<std::size_t>(arena->end_ - arena->pos_), K_MAX_BLOCK_SIZE);
+      const std::size_t block_size = std::size_t{1} << (63 - __builtin_clzll(remaining));
+      const uint32_t size_class = SizeClass(block_size);
+      *reinterpret_cast<void **>(arena->pos_) = arena->free_blocks_[size_class];
+      arena->free_blocks_[size_class] = arena->pos_;
+      arena->pos_ += block_size;
+    }
+    void *slab = SlabCache::Instance()->Get();
+    arena->slabs_.push_back(slab);
+    arena->pos_ = static_cast<byte *>(slab);
+    arena->end_ = arena->pos_ + K_SLAB_SIZE;
+  }
+
+  bool DeallocateOverAligned(void *const ptr) {
+    {
+      std::lock_guard<std::mutex> lock(over_aligned_mutex_);
+      if (over_aligned_.erase(ptr) == 0) {
+        return false;
+      }
+    }
+    num_over_aligned_.fetch_sub(1, std::memory_order_relaxed);
+    std::free(ptr);
+    return true;
+  }
+
+  tbb::enumerable_thread_specific<ThreadArena> thread_arenas_;
+
+  std::mutex over_aligned_mutex_;
+  std::unordered_set<void *> over_aligned_;
+  std::atomic<uint64_t> num_over_aligned_{0};
+
+#ifndef NDEBUG
+  // The size of every live allocation, to catch deallocations with the wrong size
+  std::mutex live_mutex_;
+  std::unordered_map<void *, std::size_t> live_;
+#endif
+};
+
+MemoryPool::MemoryPool(MemoryTracker *tracker) : tracker_(tracker), arena_(std::make_unique<Arena>()) {}
+
+MemoryPool::~MemoryPool() = default;
 
 void *MemoryPool::Allocate(const std::size_t size, const bool clear) { return AllocateAligned(size, 0, clear); }
 
 void *MemoryPool::AllocateAligned(const std::size_t size, const std::size_t alignment, const bool clear) {
+  const bool huge = size >= k_mmap_threshold.load(std::memory_order_relaxed);
+
+  // Account first, so an allocation taking the query past its limit fails before memory is acquired. Arena allocations
+  // are charged for the whole block they take.
+  if (tracker_ != nullptr) {
+    tracker_->Increment(!huge && size <= K_MAX_BLOCK_SIZE ? ClassSize(SizeClass(size)) : size);
+  }
+
   void *buf = nullptr;
 
-  if (size >= k_mmap_threshold.load(std::memory_order_relaxed)) {
+  if (huge) {
     buf = util::MallocHuge(size);
     TERRIER_ASSERT(buf != nullptr, "Null memory pointer");
     // No need to clear memory on Linux
@@ -30,6 +242,13 @@ void *MemoryPool::AllocateAligned(const std::size_t size, const std::size_t alig
       std::memset(buf, 0, size);
     }
 #endif
+  } else if (size <= K_MAX_BLOCK_SIZE) {
+    // Arena blocks are aligned to a cache line at most
+    buf = alignment <= K_MIN_BLOCK_SIZE ? arena_->Allocate(size) : arena_->AllocateOverAligned(size, alignment);
+    // Blocks are recycled, so they must always be cleared
+    if (clear) {
+      std::memset(buf, 0, size);
+    }
   } else {
     if (alignment < K_MIN_MALLOC_ALIGNMENT) {
       if (clear) {
@@ -45,18 +264,38 @@ void *MemoryPool::AllocateAligned(const std::size_t size, const std::size_t alig
     }
   }
 
+#ifndef NDEBUG
+  arena_->TrackAllocation(buf, size);
+#endif
+
   // Done
   return buf;
 }
 
 void MemoryPool::Deallocate(void *ptr, std::size_t size) {
-  if (size >= k_mmap_threshold.load(std::memory_order_relaxed)) {
+  if (ptr == nullptr) {
+    return;
+  }
+#ifndef NDEBUG
+  arena_->CheckDeallocation(ptr, size);
+#endif
+  const bool huge = size >= k_mmap_threshold.load(std::memory_order_relaxed);
+  if (tracker_ != nullptr) {
+    tracker_->Decrement(!huge && size <= K_MAX_BLOCK_SIZE ? ClassSize(SizeClass(size)) : size);
+  }
+  if (huge) {
     util::FreeHuge(ptr, size);
+  } else if (size <= K_MAX_BLOCK_SIZE) {
+    arena_->Deallocate(ptr, size);
   } else {
     std::free(ptr);
   }
 }
 
+bool MemoryPool::ExceedsMemoryBudget() const {
+  return budget_ != 0 && tracker_ != nullptr && tracker_->GetApproxAllocatedSize() > budget_;
+}
+
 void MemoryPool::SetMMapSizeThreshold(const std::size_t size) { k_mmap_threshold = size; }
 
 }  // namespace terrier::execution::sql
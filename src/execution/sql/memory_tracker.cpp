@@ -0,0 +1,38 @@
+#include "execution/sql/memory_tracker.h"
+
+#include <stdexcept>
+#include <string>
+
+namespace terrier::execution::sql {
+
+std::size_t MemoryTracker::GetAllocatedSize() const {
+  int64_t allocated = 0;
+  for (const auto &stats : stats_) {
+    allocated += stats.allocated_.load(std::memory_order_relaxed);
+  }
+  return static_cast<std::size_t>(std::max(int64_t{0}, allocated));
+}
+
+uint64_t MemoryTracker::GetNumAllocations() const {
+  uint64_t num_allocations = 0;
+  for (const auto &stats : stats_) {
+    num_allocations += stats.num_allocations_.load(std::memory_order_relaxed);
+  }
+  return num_allocations;
+}
+
+void MemoryTracker::Flush(Stats *const stats) {
+  const int64_t allocated = allocated_.fetch_add(stats->unflushed_, std::memory_order_relaxed) + stats->unflushed_;
+  stats->unflushed_ = 0;
+
+  int64_t peak = peak_.load(std::memory_order_relaxed);
+  while (allocated > peak && !peak_.compare_exchange_weak(peak, allocated, std::memory_order_relaxed)) {
+  }
+}
+
+void MemoryTracker::ThrowOverLimit(const std::size_t size) const {
+  throw std::runtime_error("Allocating " + std::to_string(size) + " bytes takes the query past its memory limit of " +
+                           std::to_string(limit_) + " bytes");
+}
+
+}  // namespace terrier::execution::sql
@@ -1,4 +1,9 @@
 #include "execution/sql/projected_columns_iterator.h"
+
+#include <algorithm>
+
+#include "execution/sql/bloom_filter.h"
+#include "execution/util/hash.h"
 #include "execution/util/vector_util.h"
 #include "storage/projected_columns.h"
 #include "type/type_id.h"
@@ -23,8 +28,41 @@ void ProjectedColumnsIterator::SetProjectedColumn(storage::ProjectedColumns *pro
   selection_vector_write_idx_ = 0;
 }
 
+bool ProjectedColumnsIterator::ColumnHasNulls(const uint32_t col_idx) const {
+  // A set bit means the value is not NULL
+  const auto *bitmap =
+      reinterpret_cast<const uint8_t *>(projected_column_->ColumnNullBitmap(static_cast<uint16_t>(col_idx)));
+  const uint32_t num_tuples = projected_column_->NumTuples();
+  uint8_t all_set = 0xFF;
+  for (uint32_t i = 0; i < num_tuples / 8; i++) {
+    all_set &= bitmap[i];
+  }
+  if (num_tuples % 8 != 0) {
+    all_set &= static_cast<uint8_t>(bitmap[num_tuples / 8] | (0xFF << (num_tuples % 8)));
+  }
+  return all_set != 0xFF;
+}
+
+void ProjectedColumnsIterator::FilterNulls(const uint32_t col_idx) {
+  // Most columns have no NULLs, which is cheap to find out
+  if (!ColumnHasNulls(col_idx)) {
+    return;
+  }
+
+  const auto *bitmap =
+      reinterpret_cast<const uint8_t *>(projected_column_->ColumnNullBitmap(static_cast<uint16_t>(col_idx)));
+  const uint32_t *sel_vec = (IsFiltered() ? selection_vector_ : nullptr);
+  selection_vector_write_idx_ = util::VectorUtil::FilterByBitmap(bitmap, num_selected_, selection_vector_, sel_vec);
+  ResetFiltered();
+}
+
 template <typename T, template <typename> typename Op>
 uint32_t ProjectedColumnsIterator::FilterColByColImpl(const uint32_t col_idx_1, const uint32_t col_idx_2) {
+  // NULLs never pass, and are removed first so that their garbage values are
+  // never compared
+  FilterNulls(col_idx_1);
+  FilterNulls(col_idx_2);
+
   // Get the input column's data
   const auto *input_1 = reinterpret_cast<const T *>(projected_column_->ColumnStart(static_cast<uint16_t>(col_idx_1)));
   const auto *input_2 = reinterpret_cast<const T *>(projected_column_->ColumnStart(static_cast<uint16_t>(col_idx_2)));
@@ -50,6 +88,9 @@ uint32_t ProjectedColumnsIterator::FilterColByColImpl(const uint32_t col_idx_1,
 // Filter an entire column's data by the provided constant value
 template <typename T, template <typename> typename Op>
 uint32_t ProjectedColumnsIterator::FilterColByValImpl(uint32_t col_idx, T val) {
+  // NULLs never pass
+  FilterNulls(col_idx);
+
   // Get the input column's data
   const auto *input = reinterpret_cast<const T *>(projected_column_->ColumnStart(static_cast<uint16_t>(col_idx)));
 
@@ -75,6 +116,9 @@ uint32_t ProjectedColumnsIterator::FilterColByValImpl(uint32_t col_idx, T val) {
 template <template <typename> typename Op>
 uint32_t ProjectedColumnsIterator::FilterColByVal(uint32_t col_idx, type::TypeId type, FilterVal val) {
   switch (type) {
+    case type::TypeId::TINYINT: {
+      return FilterColByValImpl<int8_t, Op>(col_idx, val.ti_);
+    }
     case type::TypeId::SMALLINT: {
       return FilterColByValImpl<int16_t, Op>(col_idx, val.si_);
     }
@@ -84,6 +128,171 @@ uint32_t ProjectedColumnsIterator::FilterColByVal(uint32_t col_idx, type::TypeId
     case type::TypeId::BIGINT: {
       return FilterColByValImpl<int64_t, Op>(col_idx, val.bi_);
     }
+    case type::TypeId::DATE: {
+      return FilterColByValImpl<uint32_t, Op>(col_idx, val.date_);
+    }
+    case type::TypeId::DECIMAL: {
+      return FilterColByValImpl<double, Op>(col_idx, val.real_);
+    }
+    default: {
+      throw std::runtime_error("Filter not supported on type");
+    }
+  }
+}
+
+template <typename T>
+uint32_t ProjectedColumnsIterator::FilterColBetweenImpl(const uint32_t col_idx, const T lo, const T hi) {
+  FilterNulls(col_idx);
+
+  const auto *input = reinterpret_cast<const T *>(projected_column_->ColumnStart(static_cast<uint16_t>(col_idx)));
+  const uint32_t *sel_vec = (IsFiltered() ? selection_vector_ : nullptr);
+  selection_vector_write_idx_ =
+      util::VectorUtil::FilterVectorBetween<T>(input, num_selected_, lo, hi, selection_vector_, sel_vec);
+  ResetFiltered();
+  return NumSelected();
+}
+
+uint32_t ProjectedColumnsIterator::FilterColBetween(const uint32_t col_idx, const type::TypeId type,
+                                                    const FilterVal lo, const FilterVal hi) {
+  switch (type) {
+    case type::TypeId::TINYINT: {
+      return FilterColBetweenImpl<int8_t>(col_idx, lo.ti_, hi.ti_);
+    }
+    case type::TypeId::SMALLINT: {
+      return FilterColBetweenImpl<int16_t>(col_idx, lo.si_, hi.si_);
+    }
+    case type::TypeId::INTEGER: {
+      return FilterColBetweenImpl<int32_t>(col_idx, lo.i_, hi.i_);
+    }
+    case type::TypeId::BIGINT: {
+      return FilterColBetweenImpl<int64_t>(col_idx, lo.bi_, hi.bi_);
+    }
+    case type::TypeId::DATE: {
+      return FilterColBetweenImpl<uint32_t>(col_idx, lo.date_, hi.date_);
+    }
+    case type::TypeId::DECIMAL: {
+      return FilterColBetweenImpl<double>(col_idx, lo.real_, hi.real_);
+    }
+    default: {
+      throw std::runtime_error("Filter not supported on type");
+    }
+  }
+}
+
+template <typename T>
+uint32_t ProjectedColumnsIterator::FilterColInImpl(const uint32_t col_idx, const int64_t *const vals,
+                                                   const uint32_t num_vals) {
+  TERRIER_ASSERT(num_vals <= K_MAX_IN_LIST_SIZE, "IN list too long");
+  FilterNulls(col_idx);
+
+  // Convert the list to the type of the column once per vector, on the stack
+  T typed_vals[K_MAX_IN_LIST_SIZE];
+  std::copy(vals, vals + num_vals, typed_vals);
+
+  const auto *input = reinterpret_cast<const T *>(projected_column_->ColumnStart(static_cast<uint16_t>(col_idx)));
+  const uint32_t *sel_vec = (IsFiltered() ? selection_vector_ : nullptr);
+  selection_vector_write_idx_ =
+      util::VectorUtil::FilterVectorIn<T>(input, num_selected_, typed_vals, num_vals, selection_vector_, sel_vec);
+  ResetFiltered();
+  return NumSelected();
+}
+
+uint32_t ProjectedColumnsIterator::FilterColIn(const uint32_t col_idx, const type::TypeId type,
+                                               const int64_t *const vals, const uint32_t num_vals) {
+  switch (type) {
+    case type::TypeId::TINYINT: {
+      return FilterColInImpl<int8_t>(col_idx, vals, num_vals);
+    }
+    case type::TypeId::SMALLINT: {
+      return FilterColInImpl<int16_t>(col_idx, vals, num_vals);
+    }
+    case type::TypeId::INTEGER: {
+      return FilterColInImpl<int32_t>(col_idx, vals, num_vals);
+    }
+    case type::TypeId::BIGINT: {
+      return FilterColInImpl<int64_t>(col_idx, vals, num_vals);
+    }
+    case type::TypeId::DATE: {
+      return FilterColInImpl<uint32_t>(col_idx, vals, num_vals);
+    }
+    default: {
+      throw std::runtime_error("Filter not supported on type");
+    }
+  }
+}
+
+uint32_t ProjectedColumnsIterator::FilterColStringEq(const uint32_t col_idx, const byte *const val,
+                                                     const uint32_t val_len) {
+  // NULL entries must be removed before their garbage contents are read
+  FilterNulls(col_idx);
+
+  const auto *input =
+      reinterpret_cast<const storage::VarlenEntry *>(projected_column_->ColumnStart(static_cast<uint16_t>(col_idx)));
+  const uint32_t *sel_vec = (IsFiltered() ? selection_vector_ : nullptr);
+  selection_vector_write_idx_ =
+      util::VectorUtil::FilterStringEq(input, num_selected_, val, val_len, selection_vector_, sel_vec);
+  ResetFiltered();
+  return NumSelected();
+}
+
+uint32_t ProjectedColumnsIterator::FilterColStringPrefix(const uint32_t col_idx, const byte *const prefix,
+                                                         const uint32_t prefix_len) {
+  // NULL entries must be removed before their garbage contents are read
+  FilterNulls(col_idx);
+
+  const auto *input =
+      reinterpret_cast<const storage::VarlenEntry *>(projected_column_->ColumnStart(static_cast<uint16_t>(col_idx)));
+  const uint32_t *sel_vec = (IsFiltered() ? selection_vector_ : nullptr);
+  selection_vector_write_idx_ =
+      util::VectorUtil::FilterStringPrefix(input, num_selected_, prefix, prefix_len, selection_vector_, sel_vec);
+  ResetFiltered();
+  return NumSelected();
+}
+
+template <typename T>
+uint32_t ProjectedColumnsIterator::FilterColByBloomFilterImpl(const uint32_t col_idx,
+                                                             const BloomFilter *const bloom_filter) {
+  const auto *input = reinterpret_cast<const T *>(projected_column_->ColumnStart(static_cast<uint16_t>(col_idx)));
+  const auto *null_bitmap = projected_column_->ColumnNullBitmap(static_cast<uint16_t>(col_idx));
+  const uint32_t *sel_vec = (IsFiltered() ? selection_vector_ : nullptr);
+
+  // Hash all values first, in a tight loop without branches
+  hash_t hashes[common::Constants::K_DEFAULT_VECTOR_SIZE];
+  for (uint32_t idx = 0; idx < num_selected_; idx++) {
+    const uint32_t pos = (sel_vec == nullptr ? idx : sel_vec[idx]);
+    hashes[idx] = util::Hasher::Hash<util::HashMethod::Crc>(static_cast<int64_t>(input[pos]));
+  }
+
+  // Probe the filter. The output position never passes the input position, so
+  // the selection vector can be compacted in place.
+  uint32_t out_pos = 0;
+  for (uint32_t idx = 0; idx < num_selected_; idx++) {
+    const uint32_t pos = (sel_vec == nullptr ? idx : sel_vec[idx]);
+    const bool keep = null_bitmap->Test(pos) && bloom_filter->Contains(hashes[idx]);
+    selection_vector_[out_pos] = pos;
+    out_pos += static_cast<uint32_t>(keep);
+  }
+  selection_vector_write_idx_ = out_pos;
+
+  ResetFiltered();
+  return NumSelected();
+}
+
+uint32_t ProjectedColumnsIterator::FilterColByBloomFilter(const uint32_t col_idx, const type::TypeId type,
+                                                          const BloomFilter *const bloom_filter) {
+  switch (type) {
+    case type::TypeId::TINYINT: {
+      return FilterColByBloomFilterImpl<int8_t>(col_idx, bloom_filter);
+    }
+    case type::TypeId::SMALLINT: {
+      return FilterColByBloomFilterImpl<int16_t>(col_idx, bloom_filter);
+    }
+    case type::TypeId::INTEGER: {
+      return FilterColByBloomFilterImpl<int32_t>(col_idx, bloom_filter);
+    }
+    case type::TypeId::BIGINT: {
+      return FilterColByBloomFilterImpl<int64_t>(col_idx, bloom_filter);
+    }
     default: {
       throw std::runtime_error("Filter not supported on type");
     }
@@ -96,6 +305,9 @@ uint32_t ProjectedColumnsIterator::FilterColByCol(const uint32_t col_idx_1, type
   TERRIER_ASSERT(type_1 == type_2, "Incompatible column types for filter");
 
   switch (type_1) {
+    case type::TypeId::TINYINT: {
+      return FilterColByColImpl<int8_t, Op>(col_idx_1, col_idx_2);
+    }
     case type::TypeId::SMALLINT: {
       return FilterColByColImpl<int16_t, Op>(col_idx_1, col_idx_2);
     }
@@ -105,6 +317,12 @@ uint32_t ProjectedColumnsIterator::FilterColByCol(const uint32_t col_idx_1, type
     case type::TypeId::BIGINT: {
       return FilterColByColImpl<int64_t, Op>(col_idx_1, col_idx_2);
     }
+    case type::TypeId::DATE: {
+      return FilterColByColImpl<uint32_t, Op>(col_idx_1, col_idx_2);
+    }
+    case type::TypeId::DECIMAL: {
+      return FilterColByColImpl<double, Op>(col_idx_1, col_idx_2);
+    }
     default: {
       throw std::runtime_error("Filter not supported on type");
     }
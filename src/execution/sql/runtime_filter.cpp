@@ -0,0 +1,38 @@
+#include "execution/sql/runtime_filter.h"
+
+#include "execution/bandit/multi_armed_bandit.h"
+#include "execution/sql/projected_columns_iterator.h"
+#include "execution/util/timer.h"
+
+namespace terrier::execution::sql {
+
+RuntimeFilter::RuntimeFilter(const BloomFilter *const bloom_filter, const uint32_t col_idx,
+                             const type::TypeId col_type, const bandit::Policy::Kind policy_kind,
+                             const double probe_cost_ns)
+    : bloom_filter_(bloom_filter),
+      col_idx_(col_idx),
+      col_type_(col_type),
+      probe_cost_ms_(probe_cost_ns / 1e6),
+      policy_(bandit::Policy::Create(policy_kind)),
+      agent_(policy_.get(), 2),
+      num_filtered_(0) {}
+
+uint32_t RuntimeFilter::Run(ProjectedColumnsIterator *const pci) {
+  const uint32_t num_input = pci->NumSelected();
+
+  if (agent_.NextAction() == Action::Skip) {
+    agent_.Observe(bandit::MultiArmedBandit::ExecutionTimeToReward(num_input * probe_cost_ms_));
+    return num_input;
+  }
+
+  util::Timer<> timer;
+  timer.Start();
+  const uint32_t num_selected = pci->FilterColByBloomFilter(col_idx_, col_type_, bloom_filter_);
+  timer.Stop();
+
+  num_filtered_ += num_input - num_selected;
+  agent_.Observe(bandit::MultiArmedBandit::ExecutionTimeToReward(timer.Elapsed() + num_selected * probe_cost_ms_));
+  return num_selected;
+}
+
+}  // namespace terrier::execution::sql
@@ -1,16 +1,16 @@
 #include "execution/sql/sorter.h"
 
 #include <algorithm>
+#include <limits>
 #include <queue>
 #include <utility>
 #include <vector>
 
-#include "tbb/tbb.h"
-
 #include "llvm/ADT/STLExtras.h"
 
 #include "ips4o/ips4o.hpp"
 
+#include "execution/exec/query_scheduler.h"
 #include "execution/sql/thread_state_container.h"
 #include "execution/util/stage_timer.h"
 #include "loggers/execution_logger.h"
@@ -18,21 +18,56 @@
 namespace terrier::execution::sql {
 
 Sorter::Sorter(MemoryPool *memory, ComparisonFunction cmp_fn, uint32_t tuple_size)
-    : tuple_storage_(tuple_size, MemoryPoolAllocator<byte>(memory)),
+    : memory_(memory),
+      tuple_size_(tuple_size),
+      key_size_(0),
+      tuple_storage_(tuple_size, MemoryPoolAllocator<byte>(memory)),
       owned_tuples_(memory),
       cmp_fn_(cmp_fn),
       tuples_(memory),
-      sorted_(false) {}
+      sorted_(false),
+      max_buffered_tuples_(std::numeric_limits<uint64_t>::max()),
+      runs_(memory),
+      spill_files_(memory),
+      num_spilled_tuples_(0),
+      merge_limit_(std::numeric_limits<uint64_t>::max()),
+      top_k_free_slot_(nullptr),
+      top_k_threshold_(nullptr),
+      top_k_key_offset_(0) {
+  if (const uint64_t budget = memory_->GetMemoryBudget(); budget != 0) {
+    max_buffered_tuples_ = std::max(uint64_t{1}, budget / (tuple_size_ + sizeof(const byte *)));
+  }
+}
 
 Sorter::~Sorter() = default;
 
-byte *Sorter::AllocInputTuple() {
+byte *Sorter::AppendTuple() {
   byte *ret = tuple_storage_.Append();
   tuples_.push_back(ret);
   return ret;
 }
 
-byte *Sorter::AllocInputTupleTopK(UNUSED_ATTRIBUTE uint64_t top_k) { return AllocInputTuple(); }
+byte *Sorter::AllocInputTuple() {
+  // The tuple handed out by the previous call has been written by now, so the
+  // buffered tuples can be written out as a run
+  if (UNLIKELY(tuples_.size() >= max_buffered_tuples_)) {
+    SpillSortedRun();
+  }
+  return AppendTuple();
+}
+
+// The Top-K heap never holds more than K tuples, so it never spills
+byte *Sorter::AllocInputTupleTopK(UNUSED_ATTRIBUTE uint64_t top_k) {
+  // Reuse the storage of the tuple the heap dropped last, so that the heap
+  // only ever needs storage for K + 1 tuples
+  if (top_k_free_slot_ != nullptr) {
+    byte *ret = top_k_free_slot_;
+    top_k_free_slot_ = nullptr;
+    tuples_.push_back(ret);
+    return ret;
+  }
+  return AppendTuple();
+}
 
 void Sorter::AllocInputTupleTopKFinish(const uint64_t top_k) {
   // If the number of buffered tuples is less than top_k, we're done
@@ -44,6 +79,7 @@ void Sorter::AllocInputTupleTopKFinish(const uint64_t top_k) {
   // this will only ever be done once!
   if (tuples_.size() == top_k) {
     BuildHeap();
+    PublishTopKThreshold();
     return;
   }
 
@@ -63,6 +99,10 @@ void Sorter::AllocInputTupleTopKFinish(const uint64_t top_k) {
     // maximum and sift it down.
     tuples_.front() = last_insert;
     HeapSiftDown();
+    PublishTopKThreshold();
+    top_k_free_slot_ = const_cast<byte *>(heap_top);
+  } else {
+    top_k_free_slot_ = const_cast<byte *>(last_insert);
   }
 }
 
@@ -99,12 +139,52 @@ void Sorter::HeapSiftDown() {
   tuples_[idx] = top;
 }
 
+void Sorter::SortBufferedTuples() {
+  const auto compare = [this](const byte *left, const byte *right) { return CompareTuples(left, right) < 0; };
+  ips4o::sort(tuples_.begin(), tuples_.end(), compare);
+}
+
+void Sorter::SpillSortedRun() {
+  if (tuples_.empty()) {
+    return;
+  }
+
+  SortBufferedTuples();
+
+  if (spill_files_.empty()) {
+    spill_files_.emplace_back(std::make_unique<SpillFile>());
+  }
+  SpillFile *file = spill_files_.back().get();
+  const uint64_t offset = file->Size();
+  for (const byte *tuple : tuples_) {
+    file->Append(tuple, tuple_size_);
+  }
+  file->Flush();
+  runs_.push_back({file, offset, tuples_.size() * tuple_size_});
+  num_spilled_tuples_ += tuples_.size();
+
+  EXECUTION_LOG_DEBUG("Sorter: spilled run of {} tuples", tuples_.size());
+
+  // Release the memory of the spilled tuples
+  tuples_.clear();
+  tuple_storage_ = util::ChunkedVector<MemoryPoolAllocator<byte>>(tuple_size_, MemoryPoolAllocator<byte>(memory_));
+}
+
 void Sorter::Sort() {
   // Exit if the input tuples have already been sorted
   if (IsSorted()) {
     return;
   }
 
+  // If runs were spilled, the buffered tuples form the last run, and the runs
+  // are merged when iterated
+  if (HasSpilledRuns()) {
+    SortBufferedTuples();
+    sorted_ = true;
+    EXECUTION_LOG_DEBUG("Sorted {} tuples in {} runs", NumTuples(), runs_.size() + (tuples_.empty() ? 0 : 1));
+    return;
+  }
+
   // Exit if there are no input tuples
   if (tuples_.empty()) {
     return;
@@ -115,8 +195,7 @@ void Sorter::Sort() {
   timer.Start();
 
   // Sort the sucker
-  const auto compare = [this](const byte *left, const byte *right) { return cmp_fn_(left, right) < 0; };
-  ips4o::sort(tuples_.begin(), tuples_.end(), compare);
+  SortBufferedTuples();
 
   timer.Stop();
 
@@ -159,6 +238,19 @@ void Sorter::SortParallel(const ThreadStateContainer *thread_state_container, co
     return;
   }
 
+  // If any thread-local sorter spilled, or all of them together exceed the
+  // budget, sort externally
+  uint64_t num_buffered_tuples = 0;
+  bool spilled = false;
+  for (const auto *tl_sorter : tl_sorters) {
+    num_buffered_tuples += tl_sorter->tuples_.size();
+    spilled |= tl_sorter->HasSpilledRuns();
+  }
+  if (spilled || num_buffered_tuples > max_buffered_tuples_) {
+    SortParallelExternal(tl_sorters);
+    return;
+  }
+
   // -------------------------------------------------------
   // 1. Make room in this sorter for all result tuples
   // -------------------------------------------------------
@@ -179,8 +271,8 @@ void Sorter::SortParallel(const ThreadStateContainer *thread_state_container, co
 
   timer.EnterStage("Parallel Sort Thread-Local Instances");
 
-  tbb::task_scheduler_init sched;
-  tbb::parallel_for_each(tl_sorters.begin(), tl_sorters.end(), [](Sorter *const sorter) { sorter->Sort(); });
+  auto *scheduler = exec::QueryScheduler::Instance();
+  scheduler->ParallelFor(tl_sorters.size(), [&](const uint64_t sorter_idx) { tl_sorters[sorter_idx]->Sort(); });
 
   timer.ExitStage();
 
@@ -275,6 +367,13 @@ void Sorter::SortParallel(const ThreadStateContainer *thread_state_container, co
       // Bump new write position
       write_pos += part_size;
     }
+
+    // A single sorter has no splitters; its whole run is the only merge input
+    if (tl_sorters.size() == 1) {
+      std::vector<MergeWork<SeqTypeIter>::Range> input_ranges;
+      input_ranges.emplace_back(tl_sorters[0]->tuples_.begin(), tl_sorters[0]->tuples_.end());
+      merge_work.emplace_back(std::move(input_ranges), write_pos);
+    }
   }
 
   timer.ExitStage();
@@ -289,7 +388,8 @@ void Sorter::SortParallel(const ThreadStateContainer *thread_state_container, co
     return cmp_fn_(*l.first, *r.first) >= 0;
   };
 
-  tbb::parallel_for_each(merge_work.begin(), merge_work.end(), [&heap_cmp](const MergeWork<SeqTypeIter> &work) {
+  scheduler->ParallelFor(merge_work.size(), [&](const uint64_t work_idx) {
+    const auto &work = merge_work[work_idx];
     std::priority_queue<MergeWorkType::Range, std::vector<MergeWorkType::Range>, decltype(heap_cmp)> heap(
         heap_cmp, work.input_ranges_);
     SeqTypeIter dest = work.destination_;
@@ -315,6 +415,7 @@ void Sorter::SortParallel(const ThreadStateContainer *thread_state_container, co
   for (auto *tl_sorter : tl_sorters) {
     owned_tuples_.emplace_back(std::move(tl_sorter->tuple_storage_));
     tl_sorter->tuples_.clear();
+    tl_sorter->top_k_free_slot_ = nullptr;
   }
 
   timer.ExitStage();
@@ -331,13 +432,190 @@ void Sorter::SortParallel(const ThreadStateContainer *thread_state_container, co
   }
 }
 
+void Sorter::SortParallelExternal(const std::vector<Sorter *> &tl_sorters) {
+  // Every thread-local sorter writes its buffered tuples out as a last run
+  exec::QueryScheduler::Instance()->ParallelFor(
+      tl_sorters.size(), [&](const uint64_t sorter_idx) { tl_sorters[sorter_idx]->SpillSortedRun(); });
+
+  // Take over all runs and their files
+  for (auto *tl_sorter : tl_sorters) {
+    runs_.insert(runs_.end(), tl_sorter->runs_.begin(), tl_sorter->runs_.end());
+    for (auto &file : tl_sorter->spill_files_) {
+      spill_files_.emplace_back(std::move(file));
+    }
+    num_spilled_tuples_ += tl_sorter->num_spilled_tuples_;
+    tl_sorter->runs_.clear();
+    tl_sorter->spill_files_.clear();
+    tl_sorter->num_spilled_tuples_ = 0;
+  }
+
+  sorted_ = true;
+
+  EXECUTION_LOG_DEBUG("Parallel Sort: {} tuples in {} spilled runs", NumTuples(), runs_.size());
+}
+
 void Sorter::SortTopKParallel(const ThreadStateContainer *thread_state_container, const uint32_t sorter_offset,
                               const uint64_t top_k) {
-  // Parallel sort
-  SortParallel(thread_state_container, sorter_offset);
+  std::vector<Sorter *> tl_sorters;
+  thread_state_container->CollectThreadLocalStateElementsAs(&tl_sorters, sorter_offset);
+  llvm::erase_if(tl_sorters, [](Sorter *const sorter) { return sorter->NumTuples() == 0; });
+
+  // Thread-local sorters that spilled, or hold more than K tuples, weren't
+  // filled as Top-K heaps. Sort everything in parallel, and only keep or merge
+  // the top-K.
+  const bool not_heaps = std::any_of(tl_sorters.begin(), tl_sorters.end(), [&](const Sorter *sorter) {
+    return sorter->HasSpilledRuns() || sorter->NumTuples() > top_k;
+  });
+  if (not_heaps) {
+    SortParallel(thread_state_container, sorter_offset);
+    if (HasSpilledRuns()) {
+      merge_limit_ = top_k;
+    } else if (tuples_.size() > top_k) {
+      tuples_.resize(top_k);
+    }
+    return;
+  }
+
+  // Take over the candidates of all thread-local heaps. There are at most K
+  // per thread, so selecting and sorting the top-K serially beats a full
+  // parallel sort.
+  for (auto *tl_sorter : tl_sorters) {
+    tuples_.insert(tuples_.end(), tl_sorter->tuples_.begin(), tl_sorter->tuples_.end());
+    owned_tuples_.emplace_back(std::move(tl_sorter->tuple_storage_));
+    tl_sorter->tuples_.clear();
+    tl_sorter->top_k_free_slot_ = nullptr;
+  }
 
-  // Trim to top-K
-  tuples_.resize(top_k);
+  if (tuples_.size() > top_k) {
+    const auto compare = [this](const byte *left, const byte *right) { return CompareTuples(left, right) < 0; };
+    std::nth_element(tuples_.begin(), tuples_.begin() + top_k, tuples_.end(), compare);
+    tuples_.resize(top_k);
+  }
+  SortBufferedTuples();
+  sorted_ = true;
+
+  EXECUTION_LOG_DEBUG("Parallel Top-K: {} tuples from {} thread-local sorters", tuples_.size(), tl_sorters.size());
+}
+
+// ---------------------------------------------------------
+// Sorted Run Merger
+// ---------------------------------------------------------
+
+SortedRunMerger::SortedRunMerger(const Sorter *sorter)
+    : sorter_(sorter),
+      buffer_size_(Sorter::K_MERGE_BUFFER_SIZE / sorter->tuple_size_ * sorter->tuple_size_),
+      cursors_(sorter->memory_),
+      tree_(sorter->memory_),
+      current_(nullptr),
+      remaining_(0) {
+  // Tuples larger than the buffer are read one at a time
+  buffer_size_ = std::max(buffer_size_, sorter->tuple_size_);
+  for (const auto &run : sorter_->runs_) {
+    // Short runs don't need a full buffer
+    const auto buffer_size = static_cast<uint32_t>(std::min<uint64_t>(buffer_size_, run.size_));
+    auto *buffer = reinterpret_cast<byte *>(sorter_->memory_->Allocate(buffer_size, false));
+    cursors_.push_back({nullptr, nullptr, nullptr, &run, 0, buffer, buffer_size, 0, 0});
+  }
+  if (!sorter_->tuples_.empty()) {
+    cursors_.push_back({nullptr, nullptr, nullptr, nullptr, 0, nullptr, 0, 0, 0});
+  }
+  tree_.resize(cursors_.size());
+}
+
+SortedRunMerger::~SortedRunMerger() {
+  for (auto &cursor : cursors_) {
+    if (cursor.buffer_ != nullptr) {
+      sorter_->memory_->Deallocate(cursor.buffer_, cursor.buffer_size_);
+    }
+  }
+}
+
+void SortedRunMerger::Reset() {
+  for (auto &cursor : cursors_) {
+    if (cursor.run_ == nullptr) {
+      cursor.next_ = sorter_->tuples_.data();
+      cursor.end_ = sorter_->tuples_.data() + sorter_->tuples_.size();
+    } else {
+      cursor.read_pos_ = 0;
+      cursor.buffer_pos_ = cursor.buffer_end_ = 0;
+      // Get the first block of every run on its way
+      cursor.run_->file_->Prefetch(cursor.run_->offset_, cursor.buffer_size_);
+    }
+  }
+  for (auto &cursor : cursors_) {
+    Advance(&cursor);
+  }
+
+  remaining_ = std::min(sorter_->NumTuples(), sorter_->merge_limit_);
+  current_ = nullptr;
+  if (!cursors_.empty()) {
+    tree_[0] = BuildTree(1);
+    current_ = cursors_[tree_[0]].tuple_;
+  }
+}
+
+uint32_t SortedRunMerger::BuildTree(const uint32_t node) {
+  const auto num_runs = static_cast<uint32_t>(cursors_.size());
+  if (node >= num_runs) {
+    return node - num_runs;
+  }
+  const uint32_t left = BuildTree(2 * node), right = BuildTree(2 * node + 1);
+  if (Less(right, left)) {
+    tree_[node] = left;
+    return right;
+  }
+  tree_[node] = right;
+  return left;
+}
+
+void SortedRunMerger::Advance(SortedRunMerger::Cursor *cursor) {
+  // In-memory run
+  if (cursor->run_ == nullptr) {
+    cursor->tuple_ = cursor->next_ == cursor->end_ ? nullptr : *cursor->next_++;
+    return;
+  }
+
+  // Run on disk, refill the buffer if it's been consumed
+  if (cursor->buffer_pos_ == cursor->buffer_end_) {
+    const SpillRun &run = *cursor->run_;
+    if (cursor->read_pos_ == run.size_) {
+      cursor->tuple_ = nullptr;
+      return;
+    }
+    const auto read_size =
+        static_cast<uint32_t>(std::min<uint64_t>(cursor->buffer_size_, run.size_ - cursor->read_pos_));
+    run.file_->Read(run.offset_ + cursor->read_pos_, cursor->buffer_, read_size);
+    cursor->read_pos_ += read_size;
+    cursor->buffer_pos_ = 0;
+    cursor->buffer_end_ = read_size;
+
+    // Read ahead the next block while this one is consumed
+    if (cursor->read_pos_ < run.size_) {
+      run.file_->Prefetch(run.offset_ + cursor->read_pos_,
+                          std::min<uint64_t>(cursor->buffer_size_, run.size_ - cursor->read_pos_));
+    }
+  }
+
+  cursor->tuple_ = cursor->buffer_ + cursor->buffer_pos_;
+  cursor->buffer_pos_ += sorter_->tuple_size_;
+}
+
+void SortedRunMerger::Next() {
+  TERRIER_ASSERT(HasNext(), "Advancing an exhausted merge");
+  remaining_--;
+
+  // Replace the winner by the next tuple of its run, and replay its matches up
+  // to the root
+  const auto num_runs = static_cast<uint32_t>(cursors_.size());
+  uint32_t winner = tree_[0];
+  Advance(&cursors_[winner]);
+  for (uint32_t node = (winner + num_runs) / 2; node > 0; node /= 2) {
+    if (Less(tree_[node], winner)) {
+      std::swap(tree_[node], winner);
+    }
+  }
+  tree_[0] = winner;
+  current_ = cursors_[winner].tuple_;
 }
 
 }  // namespace terrier::execution::sql
@@ -0,0 +1,97 @@
+#include "execution/sql/spill_file.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "loggers/execution_logger.h"
+
+namespace terrier::execution::sql {
+
+namespace {
+
+[[noreturn]] void ThrowIOError(const char *operation) {
+  auto error_msg = fmt::format("Spill file {} failed: {}", operation, strerror(errno));
+  EXECUTION_LOG_ERROR("{}", error_msg);
+  throw std::runtime_error(error_msg);
+}
+
+}  // namespace
+
+SpillFile::SpillFile() : fd_(-1), buffer_(std::make_unique<byte[]>(K_BUFFER_SIZE)), buffer_size_(0), size_(0) {
+  const char *dir = std::getenv("TMPDIR");
+  std::string path_template = std::string(dir != nullptr && dir[0] != '\0' ? dir : "/tmp") + "/terrier-spill-XXXXXX";
+  std::vector<char> path(path_template.begin(), path_template.end());
+  path.push_back('\0');
+
+  fd_ = mkstemp(path.data());
+  if (fd_ == -1) {
+    ThrowIOError("create");
+  }
+  // Nobody else needs to find the file, and this way it can't be leaked
+  unlink(path.data());
+}
+
+SpillFile::~SpillFile() { close(fd_); }
+
+uint64_t SpillFile::Append(const void *const data, const std::size_t size) {
+  const uint64_t offset = size_;
+  const auto *src = reinterpret_cast<const byte *>(data);
+  std::size_t remaining = size;
+  while (remaining > 0) {
+    if (buffer_size_ == K_BUFFER_SIZE) {
+      Flush();
+    }
+    const auto n = static_cast<uint32_t>(std::min<std::size_t>(remaining, K_BUFFER_SIZE - buffer_size_));
+    std::memcpy(buffer_.get() + buffer_size_, src, n);
+    buffer_size_ += n;
+    src += n;
+    remaining -= n;
+  }
+  size_ += size;
+  return offset;
+}
+
+void SpillFile::Flush() {
+  uint32_t written = 0;
+  while (written < buffer_size_) {
+    const ssize_t n = write(fd_, buffer_.get() + written, buffer_size_ - written);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      ThrowIOError("write");
+    }
+    written += static_cast<uint32_t>(n);
+  }
+  buffer_size_ = 0;
+}
+
+void SpillFile::Read(const uint64_t offset, void *const data, const std::size_t size) const {
+  TERRIER_ASSERT(offset + size <= size_ - buffer_size_, "Reading data that hasn't been flushed");
+  auto *dest = reinterpret_cast<byte *>(data);
+  std::size_t total = 0;
+  while (total < size) {
+    const ssize_t n = pread(fd_, dest + total, size - total, static_cast<off_t>(offset + total));
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      ThrowIOError("read");
+    }
+    if (n == 0) {
+      errno = EIO;
+      ThrowIOError("read");
+    }
+    total += static_cast<std::size_t>(n);
+  }
+}
+
+void SpillFile::Prefetch(const uint64_t offset, const std::size_t size) const {
+  // Only a hint, so errors don't matter
+  posix_fadvise(fd_, static_cast<off_t>(offset), static_cast<off_t>(size), POSIX_FADV_WILLNEED);
+}
+
+}  // namespace terrier::execution::sql
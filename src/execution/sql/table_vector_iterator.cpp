@@ -1,12 +1,15 @@
+#include <algorithm>
+#include <functional>
 #include <memory>
 #include <vector>
 
 #include "execution/exec/execution_context.h"
+#include "execution/exec/query_scheduler.h"
+#include "execution/sql/runtime_filter.h"
+#include "execution/sql/sorter.h"
 #include "execution/sql/table_vector_iterator.h"
+#include "execution/sql/thread_state_container.h"
 #include "execution/util/timer.h"
-#include "tbb/blocked_range.h"
-#include "tbb/parallel_for.h"
-#include "tbb/task_scheduler_init.h"
 
 namespace terrier::execution::sql {
 TableVectorIterator::TableVectorIterator(exec::ExecutionContext *exec_ctx, uint32_t table_oid, uint32_t *col_oids,
@@ -18,8 +21,8 @@ TableVectorIterator::~TableVectorIterator() {
 }
 
 bool TableVectorIterator::Init() {
-  // Find the table
-  table_ = exec_ctx_->GetAccessor()->GetTable(table_oid_);
+  // Find the table, unless a parallel scan already did
+  if (table_ == nullptr) table_ = exec_ctx_->GetAccessor()->GetTable(table_oid_);
   TERRIER_ASSERT(table_ != nullptr, "Table must exist!!");
 
   // Initialize the projected column
@@ -36,21 +39,79 @@ bool TableVectorIterator::Init() {
 
 bool TableVectorIterator::Advance() {
   if (!initialized_) return false;
-  // First check if the iterator ended.
-  if (*iter_ == table_->end()) {
-    return false;
+  do {
+    // First check if the iterator ended, then scan the table to set the projected column.
+    if (range_end_ != nullptr) {
+      if (*iter_ == *range_end_) return false;
+      table_->Scan(exec_ctx_->GetTxn(), iter_.get(), *range_end_, projected_columns_);
+    } else {
+      if (*iter_ == table_->end()) return false;
+      table_->Scan(exec_ctx_->GetTxn(), iter_.get(), projected_columns_);
+    }
+    pci_.SetProjectedColumn(projected_columns_);
+  } while (!FilterByTopKThreshold() || !FilterByRuntimeFilters());
+  // Whether a dynamic filter ran on this vector or not, the scan iterates over
+  // the PCI as a filtered one
+  if (has_dynamic_filters_) {
+    pci_.SelectAll();
   }
-  // Scan the table to set the projected column.
-  table_->Scan(exec_ctx_->GetTxn(), iter_.get(), projected_columns_);
-  pci_.SetProjectedColumn(projected_columns_);
   return true;
 }
 
-bool TableVectorIterator::ParallelScan(uint32_t db_oid, uint32_t table_oid, void *const query_state,
+void TableVectorIterator::AddRuntimeFilter(const BloomFilter *const bloom_filter, const uint32_t col_idx,
+                                           const type::TypeId col_type) {
+  if (bloom_filter == nullptr) {
+    has_dynamic_filters_ = true;
+    return;
+  }
+  owned_runtime_filters_.push_back(std::make_unique<RuntimeFilter>(bloom_filter, col_idx, col_type));
+  AddRuntimeFilter(owned_runtime_filters_.back().get());
+}
+
+bool TableVectorIterator::FilterByTopKThreshold() {
+  if (top_k_threshold_ == nullptr || !top_k_threshold_->IsSet()) {
+    return true;
+  }
+  // The bound is a key of a tuple read from this column, so it fits its type
+  const auto bound = pci_.MakeFilterVal(top_k_threshold_->GetBound(), top_k_col_type_);
+  if (top_k_threshold_->IsAscending()) {
+    return pci_.FilterColByVal<std::less_equal>(top_k_col_idx_, top_k_col_type_, bound) != 0;
+  }
+  return pci_.FilterColByVal<std::greater_equal>(top_k_col_idx_, top_k_col_type_, bound) != 0;
+}
+
+bool TableVectorIterator::FilterByRuntimeFilters() {
+  for (auto *filter : runtime_filters_) {
+    if (filter->Run(&pci_) == 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool TableVectorIterator::ParallelScan(exec::ExecutionContext *const exec_ctx, const uint32_t table_oid,
+                                       uint32_t *const col_oids, const uint32_t num_oids, void *const query_state,
                                        ThreadStateContainer *const thread_states, const ScanFn scan_fn,
                                        const uint32_t min_grain_size) {
-  // TODO(Amadou): Implement Me!!
-  return false;
+  const auto table = exec_ctx->GetAccessor()->GetTable(catalog::table_oid_t(table_oid));
+  if (table == nullptr) return false;
+  const auto boundaries = table->BlockRangeBoundaries(std::max(min_grain_size, 1u));
+
+  // Every range of blocks is a morsel, scanned through its own iterator. The catalog accessor isn't thread-safe, so
+  // they share the table looked up here.
+  auto query = std::make_shared<exec::QueryScheduler::Query>(exec_ctx->GetPriority(), exec_ctx->GetMaxDop());
+  query->AddPipeline(boundaries.size() - 1, [&](const uint64_t range) {
+    TableVectorIterator iter(exec_ctx, table_oid, col_oids, num_oids);
+    iter.table_ = table;
+    iter.Init();
+    *iter.iter_ = boundaries[range];
+    iter.range_end_ = std::make_unique<storage::DataTable::SlotIterator>(boundaries[range + 1]);
+    scan_fn(query_state, thread_states->AccessThreadStateOfCurrentThread(), &iter);
+  });
+  auto *const scheduler = exec::QueryScheduler::Instance();
+  scheduler->Submit(query);
+  scheduler->Wait(query.get());
+  return true;
 }
 
 }  // namespace terrier::execution::sql
@@ -56,6 +56,7 @@ void CpuInfo::ParseCpuFlags(llvm::StringRef flags) {
 CpuInfo::CpuInfo() {
   InitCpuInfo();
   InitCacheInfo();
+  InitNumaInfo();
 }
 
 void CpuInfo::InitCpuInfo() {
@@ -134,6 +135,32 @@ void CpuInfo::InitCacheInfo() {
 #endif
 }
 
+void CpuInfo::InitNumaInfo() {
+  num_numa_nodes_ = 1;
+  core_numa_nodes_.assign(num_cores_, 0);
+#ifndef __APPLE__
+  // Every node lists its cores in sysfs as ranges, e.g. "0-7,16-23"
+  for (uint32_t node = 0;; node++) {
+    std::ifstream infile("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+    std::string line;
+    if (!infile || !std::getline(infile, line)) break;
+    num_numa_nodes_ = node + 1;
+    llvm::SmallVector<llvm::StringRef, 8> ranges;
+    llvm::StringRef(line).trim().split(ranges, ',', -1, false);
+    for (const auto range : ranges) {
+      // NOLINTNEXTLINE
+      auto [first, last] = range.split('-');
+      uint32_t begin = 0, end = 0;
+      if (first.getAsInteger(10, begin)) continue;
+      if (last.empty() || last.getAsInteger(10, end)) end = begin;
+      for (uint32_t core = begin; core <= end && core < num_cores_; core++) {
+        core_numa_nodes_[core] = node;
+      }
+    }
+  }
+#endif
+}
+
 std::string CpuInfo::PrettyPrintInfo() const {
   std::stringstream ss;
 
@@ -141,6 +168,7 @@ std::string CpuInfo::PrettyPrintInfo() const {
   ss << "CPU Info: " << std::endl;
   ss << "  Model:  " << model_name_ << std::endl;
   ss << "  Cores:  " << num_cores_ << std::endl;
+  ss << "  Nodes:  " << num_numa_nodes_ << std::endl;
   ss << "  Mhz:    " << std::fixed << std::setprecision(2) << cpu_mhz_ << std::endl;
   ss << "  Caches: " << std::endl;
   ss << "    L1: " << (cache_sizes_[L1_CACHE] / 1024.0) << " common::Constants::KB (" << cache_line_sizes_[L1_CACHE] << " byte line)" << std::endl;  // NOLINT
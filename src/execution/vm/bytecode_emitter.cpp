@@ -263,9 +263,9 @@ void BytecodeEmitter::EmitAddCol(Bytecode bytecode, LocalVar iter, uint32_t col_
   EmitAll(bytecode, iter, col_oid);
 }
 
-void BytecodeEmitter::EmitParallelTableScan(uint32_t db_oid, uint32_t table_oid, LocalVar ctx, LocalVar thread_states,
-                                            FunctionId scan_fn) {
-  EmitAll(Bytecode::ParallelScanTable, db_oid, table_oid, ctx, thread_states, scan_fn);
+void BytecodeEmitter::EmitParallelTableScan(LocalVar exec_ctx, uint32_t table_oid, LocalVar col_oids, uint32_t num_oids,
+                                            LocalVar query_state, LocalVar thread_states, FunctionId scan_fn) {
+  EmitAll(Bytecode::ParallelScanTable, exec_ctx, table_oid, col_oids, num_oids, query_state, thread_states, scan_fn);
 }
 
 void BytecodeEmitter::EmitPCIGet(Bytecode bytecode, LocalVar out, LocalVar pci, uint16_t col_idx) {
@@ -277,6 +277,21 @@ void BytecodeEmitter::EmitPCIVectorFilter(Bytecode bytecode, LocalVar selected,
   EmitAll(bytecode, selected, pci, col_idx, type, val);
 }
 
+void BytecodeEmitter::EmitPCIVectorFilterBetween(LocalVar selected, LocalVar pci, uint32_t col_idx, int8_t type,
+                                                 int64_t lo, int64_t hi) {
+  EmitAll(Bytecode::PCIFilterBetween, selected, pci, col_idx, type, lo, hi);
+}
+
+void BytecodeEmitter::EmitPCIVectorFilterIn(LocalVar selected, LocalVar pci, uint32_t col_idx, int8_t type,
+                                            LocalVar vals, uint32_t num_vals) {
+  EmitAll(Bytecode::PCIFilterIn, selected, pci, col_idx, type, vals, num_vals);
+}
+
+void BytecodeEmitter::EmitPCIStringFilter(Bytecode bytecode, LocalVar selected, LocalVar pci, uint32_t col_idx,
+                                          uint32_t data, uint32_t length) {
+  EmitAll(bytecode, selected, pci, col_idx, data, length);
+}
+
 void BytecodeEmitter::EmitFilterManagerInsertFlavor(LocalVar fmb, FunctionId func) {
   EmitAll(Bytecode::FilterManagerInsertFlavor, fmb, func);
 }
@@ -307,6 +322,11 @@ void BytecodeEmitter::EmitJoinHashTableIterHasNext(LocalVar has_more, LocalVar i
   EmitAll(Bytecode::JoinHashTableIterHasNext, has_more, iterator, key_eq, opaque_ctx, probe_tuple);
 }
 
+void BytecodeEmitter::EmitJoinHashTableJoinSpilledPartitions(LocalVar join_hash_table, LocalVar ctx,
+                                                             FunctionId probe_fn) {
+  EmitAll(Bytecode::JoinHashTableJoinSpilledPartitions, join_hash_table, ctx, probe_fn);
+}
+
 void BytecodeEmitter::EmitSorterInit(Bytecode bytecode, LocalVar sorter, LocalVar region, FunctionId cmp_fn,
                                      LocalVar tuple_size) {
   EmitAll(bytecode, sorter, region, cmp_fn, tuple_size);
@@ -337,7 +357,7 @@ void BytecodeEmitter::EmitIndexIteratorSetKey(Bytecode bytecode, LocalVar iter,
   EmitAll(bytecode, iter, col_idx, val);
 }
 
-void BytecodeEmitter::EmitInitString(Bytecode bytecode, LocalVar out, uint64_t length, uintptr_t data) {
+void BytecodeEmitter::EmitInitString(Bytecode bytecode, LocalVar out, uint64_t length, uint32_t data) {
   EmitAll(bytecode, out, length, data);
 }
 
@@ -1,3 +1,4 @@
+#include <cstring>
 #include <memory>
 #include <string>
 #include <utility>
@@ -11,8 +12,10 @@
 #include "execution/exec/execution_context.h"
 #include "execution/vm/bytecode_label.h"
 #include "execution/vm/bytecode_module.h"
+#include "execution/vm/bytecode_optimizer.h"
 #include "execution/vm/control_flow_builders.h"
 #include "loggers/execution_logger.h"
+#include "type/type_id.h"
 
 namespace terrier::execution::vm {
 
@@ -464,13 +467,10 @@ void BytecodeGenerator::VisitSqlConversionCall(ast::CallExpr *call, ast::Builtin
     }
     case ast::Builtin::StringToSql: {
       auto dest = ExecutionResult()->GetOrCreateDestination(ast::BuiltinType::Get(ctx, ast::BuiltinType::StringVal));
-      // Copy data into the execution context's buffer.
+      // The literal lives in the module's static data, so the bytecode doesn't depend on where it is at runtime
       auto input = call->Arguments()[0]->As<ast::LitExpr>()->RawStringVal();
       auto input_length = input.Length();
-      auto *data = exec_ctx_->GetStringAllocator()->Allocate(input_length);
-      std::memcpy(data, input.Data(), input_length);
-      // Assign the pointer to a local variable
-      Emitter()->EmitInitString(Bytecode::InitString, dest, input_length, reinterpret_cast<uintptr_t>(data));
+      Emitter()->EmitInitString(Bytecode::InitString, dest, input_length, NewStaticString(input));
       break;
     }
     case ast::Builtin::VarlenToSql: {
@@ -548,6 +548,20 @@ void BytecodeGenerator::VisitBuiltinTableIterCall(ast::CallExpr *call, ast::Buil
       Emitter()->Emit(Bytecode::TableVectorIteratorFree, iter);
       break;
     }
+    case ast::Builtin::TableIterSetTopKThreshold: {
+      LocalVar threshold = VisitExpressionForRValue(call->Arguments()[1]);
+      LocalVar col_idx = VisitExpressionForRValue(call->Arguments()[2]);
+      LocalVar col_type = VisitExpressionForRValue(call->Arguments()[3]);
+      Emitter()->Emit(Bytecode::TableVectorIteratorSetTopKThreshold, iter, threshold, col_idx, col_type);
+      break;
+    }
+    case ast::Builtin::TableIterAddRuntimeFilter: {
+      LocalVar join_hash_table = VisitExpressionForRValue(call->Arguments()[1]);
+      LocalVar col_idx = VisitExpressionForRValue(call->Arguments()[2]);
+      LocalVar col_type = VisitExpressionForRValue(call->Arguments()[3]);
+      Emitter()->Emit(Bytecode::TableVectorIteratorAddRuntimeFilter, iter, join_hash_table, col_idx, col_type);
+      break;
+    }
     default: {
       UNREACHABLE("Impossible table iteration call");
     }
@@ -555,7 +569,23 @@ void BytecodeGenerator::VisitBuiltinTableIterCall(ast::CallExpr *call, ast::Buil
 }
 
 void BytecodeGenerator::VisitBuiltinTableIterParallelCall(ast::CallExpr *call) {
-  UNREACHABLE("Parallel scan is not implemented yet!");
+  // The first argument is the execution context
+  LocalVar exec_ctx = VisitExpressionForRValue(call->Arguments()[0]);
+  // The second argument is the table name
+  ast::Identifier table_name = call->Arguments()[1]->As<ast::LitExpr>()->RawStringVal();
+  auto ns_oid = exec_ctx_->GetAccessor()->GetDefaultNamespace();
+  auto table_oid = exec_ctx_->GetAccessor()->GetTableOid(ns_oid, table_name.Data());
+  TERRIER_ASSERT(table_oid != terrier::catalog::INVALID_TABLE_OID, "Table does not exists");
+  // The third argument is the array of column oids
+  auto *arr_type = call->Arguments()[2]->GetType()->As<ast::ArrayType>();
+  LocalVar col_oids = VisitExpressionForLValue(call->Arguments()[2]);
+  // The fourth and fifth arguments are the query state and the thread state container
+  LocalVar query_state = VisitExpressionForRValue(call->Arguments()[3]);
+  LocalVar thread_states = VisitExpressionForRValue(call->Arguments()[4]);
+  // The last argument is the function scanning a range of the table
+  FunctionId scan_fn = LookupFuncIdByName(call->Arguments()[5]->As<ast::IdentifierExpr>()->Name().Data());
+  Emitter()->EmitParallelTableScan(exec_ctx, !table_oid, col_oids, static_cast<uint32_t>(arr_type->Length()),
+                                   query_state, thread_states, scan_fn);
 }
 
 void BytecodeGenerator::VisitBuiltinPCICall(ast::CallExpr *call, ast::Builtin builtin) {
@@ -706,38 +736,40 @@ void BytecodeGenerator::VisitBuiltinHashCall(ast::CallExpr *call, UNUSED_ATTRIBU
                  "Hash value size (from return type of @hash) doesn't match actual "
                  "size of hash_t type");
 
-  // hash_val is where we accumulate all the hash values passed to the @hash()
+  // hash_val is where we accumulate all the hash values passed to the @hash().
+  // It starts out as the hash of the first value, so that the hash of a single
+  // integer is the one runtime filters compute for its column.
   LocalVar hash_val = ExecutionResult()->GetOrCreateDestination(call->GetType());
 
-  // Initialize it to 1
-  Emitter()->EmitAssignImm8(hash_val, 1);
-
   // tmp is a temporary variable we use to store individual hash values. We
-  // combine all values into hash_val above
+  // combine all other values into hash_val above
   LocalVar tmp = CurrentFunction()->NewLocal(call->GetType());
 
   for (uint32_t idx = 0; idx < call->NumArgs(); idx++) {
+    const LocalVar hash = idx == 0 ? hash_val : tmp;
     LocalVar input = VisitExpressionForLValue(call->Arguments()[idx]);
     TERRIER_ASSERT(call->Arguments()[idx]->GetType()->IsSqlValueType(), "Input to hash must be a SQL value type");
     auto *type = call->Arguments()[idx]->GetType()->As<ast::BuiltinType>();
     switch (type->GetKind()) {
       case ast::BuiltinType::Integer: {
-        Emitter()->Emit(Bytecode::HashInt, tmp, input);
+        Emitter()->Emit(Bytecode::HashInt, hash, input);
         break;
       }
       case ast::BuiltinType::Real: {
-        Emitter()->Emit(Bytecode::HashReal, tmp, input);
+        Emitter()->Emit(Bytecode::HashReal, hash, input);
         break;
       }
       case ast::BuiltinType::StringVal: {
-        Emitter()->Emit(Bytecode::HashString, tmp, input);
+        Emitter()->Emit(Bytecode::HashString, hash, input);
         break;
       }
       default: {
         UNREACHABLE("Hashing this type isn't supported!");
       }
     }
-    Emitter()->Emit(Bytecode::HashCombine, hash_val, tmp.ValueOf());
+    if (idx != 0) {
+      Emitter()->Emit(Bytecode::HashCombine, hash_val, tmp.ValueOf());
+    }
   }
   ExecutionResult()->SetDestination(hash_val.ValueOf());
 }
@@ -788,14 +820,51 @@ void BytecodeGenerator::VisitBuiltinFilterCall(ast::CallExpr *call, ast::Builtin
     ret_val = CurrentFunction()->NewLocal(call->GetType());
   }
 
-  // Collect the three call arguments
+  // Collect the call arguments
   // Projected Column Iterator
   LocalVar pci = VisitExpressionForRValue(call->Arguments()[0]);
   // Column index
   auto col_idx = static_cast<uint16_t>(call->Arguments()[1]->As<ast::LitExpr>()->Int64Val());
+
+  // String filters compare with the literal in the module's static data
+  if (builtin == ast::Builtin::FilterStringEq || builtin == ast::Builtin::FilterStringPrefix) {
+    auto input = call->Arguments()[2]->As<ast::LitExpr>()->RawStringVal();
+    auto input_length = static_cast<uint32_t>(input.Length());
+    const Bytecode bytecode =
+        builtin == ast::Builtin::FilterStringEq ? Bytecode::PCIFilterStringEq : Bytecode::PCIFilterStringPrefix;
+    Emitter()->EmitPCIStringFilter(bytecode, ret_val, pci, col_idx, NewStaticString(input), input_length);
+    return;
+  }
+
   auto col_type = static_cast<int8_t>(call->Arguments()[2]->As<ast::LitExpr>()->Int64Val());
-  // Filter value
-  int64_t val = call->Arguments()[3]->As<ast::LitExpr>()->Int64Val();
+
+  // The values of an IN list are in a fixed length array
+  if (builtin == ast::Builtin::FilterIn) {
+    auto *arr_type = call->Arguments()[3]->GetType()->As<ast::ArrayType>();
+    LocalVar vals = VisitExpressionForLValue(call->Arguments()[3]);
+    Emitter()->EmitPCIVectorFilterIn(ret_val, pci, col_idx, col_type, vals, static_cast<uint32_t>(arr_type->Length()));
+    return;
+  }
+
+  // Filter values are passed as 64-bit immediates. DECIMAL values are doubles,
+  // which are passed by their bits.
+  auto filter_val = [col_type](ast::Expr *arg) -> int64_t {
+    auto *lit = arg->As<ast::LitExpr>();
+    if (static_cast<type::TypeId>(col_type) != type::TypeId::DECIMAL) {
+      return lit->Int64Val();
+    }
+    const double real_val = lit->IsFloatLitExpr() ? lit->Float64Val() : static_cast<double>(lit->Int64Val());
+    int64_t bits;
+    std::memcpy(&bits, &real_val, sizeof(bits));
+    return bits;
+  };
+  int64_t val = filter_val(call->Arguments()[3]);
+
+  if (builtin == ast::Builtin::FilterBetween) {
+    int64_t hi = filter_val(call->Arguments()[4]);
+    Emitter()->EmitPCIVectorFilterBetween(ret_val, pci, col_idx, col_type, val, hi);
+    return;
+  }
 
   Bytecode bytecode;
   switch (builtin) {
@@ -964,6 +1033,90 @@ void BytecodeGenerator::VisitBuiltinAggPartIterCall(ast::CallExpr *call, ast::Bu
   }
 }
 
+void BytecodeGenerator::VisitBuiltinDirectMappedAggTableCall(ast::CallExpr *call, ast::Builtin builtin) {
+  switch (builtin) {
+    case ast::Builtin::DirectMappedAggTableInit: {
+      LocalVar table = VisitExpressionForRValue(call->Arguments()[0]);
+      LocalVar memory = VisitExpressionForRValue(call->Arguments()[1]);
+      LocalVar payload_size = VisitExpressionForRValue(call->Arguments()[2]);
+      LocalVar min_key = VisitExpressionForRValue(call->Arguments()[3]);
+      LocalVar max_key = VisitExpressionForRValue(call->Arguments()[4]);
+      Emitter()->Emit(Bytecode::DirectMappedAggregationTableInit, table, memory, payload_size, min_key, max_key);
+      break;
+    }
+    case ast::Builtin::DirectMappedAggTableInDomain: {
+      LocalVar in_domain = ExecutionResult()->GetOrCreateDestination(call->GetType());
+      LocalVar table = VisitExpressionForRValue(call->Arguments()[0]);
+      LocalVar key = VisitExpressionForLValue(call->Arguments()[1]);
+      Emitter()->Emit(Bytecode::DirectMappedAggregationTableInDomain, in_domain, table, key);
+      ExecutionResult()->SetDestination(in_domain.ValueOf());
+      break;
+    }
+    case ast::Builtin::DirectMappedAggTableLookup: {
+      LocalVar dest = ExecutionResult()->GetOrCreateDestination(call->GetType());
+      LocalVar table = VisitExpressionForRValue(call->Arguments()[0]);
+      LocalVar key = VisitExpressionForLValue(call->Arguments()[1]);
+      Emitter()->Emit(Bytecode::DirectMappedAggregationTableLookup, dest, table, key);
+      ExecutionResult()->SetDestination(dest.ValueOf());
+      break;
+    }
+    case ast::Builtin::DirectMappedAggTableInsert: {
+      LocalVar dest = ExecutionResult()->GetOrCreateDestination(call->GetType());
+      LocalVar table = VisitExpressionForRValue(call->Arguments()[0]);
+      LocalVar key = VisitExpressionForLValue(call->Arguments()[1]);
+      Emitter()->Emit(Bytecode::DirectMappedAggregationTableInsert, dest, table, key);
+      ExecutionResult()->SetDestination(dest.ValueOf());
+      break;
+    }
+    case ast::Builtin::DirectMappedAggTableFree: {
+      LocalVar table = VisitExpressionForRValue(call->Arguments()[0]);
+      Emitter()->Emit(Bytecode::DirectMappedAggregationTableFree, table);
+      break;
+    }
+    default: {
+      UNREACHABLE("Impossible direct-mapped aggregation table bytecode");
+    }
+  }
+}
+
+void BytecodeGenerator::VisitBuiltinDirectMappedAggTableIterCall(ast::CallExpr *call, ast::Builtin builtin) {
+  switch (builtin) {
+    case ast::Builtin::DirectMappedAggTableIterInit: {
+      LocalVar iter = VisitExpressionForRValue(call->Arguments()[0]);
+      LocalVar table = VisitExpressionForRValue(call->Arguments()[1]);
+      Emitter()->Emit(Bytecode::DirectMappedAggregationTableIteratorInit, iter, table);
+      break;
+    }
+    case ast::Builtin::DirectMappedAggTableIterHasNext: {
+      LocalVar has_more = ExecutionResult()->GetOrCreateDestination(call->GetType());
+      LocalVar iter = VisitExpressionForRValue(call->Arguments()[0]);
+      Emitter()->Emit(Bytecode::DirectMappedAggregationTableIteratorHasNext, has_more, iter);
+      ExecutionResult()->SetDestination(has_more.ValueOf());
+      break;
+    }
+    case ast::Builtin::DirectMappedAggTableIterNext: {
+      LocalVar iter = VisitExpressionForRValue(call->Arguments()[0]);
+      Emitter()->Emit(Bytecode::DirectMappedAggregationTableIteratorNext, iter);
+      break;
+    }
+    case ast::Builtin::DirectMappedAggTableIterGetRow: {
+      LocalVar row_ptr = ExecutionResult()->GetOrCreateDestination(call->GetType());
+      LocalVar iter = VisitExpressionForRValue(call->Arguments()[0]);
+      Emitter()->Emit(Bytecode::DirectMappedAggregationTableIteratorGetRow, row_ptr, iter);
+      ExecutionResult()->SetDestination(row_ptr.ValueOf());
+      break;
+    }
+    case ast::Builtin::DirectMappedAggTableIterClose: {
+      LocalVar iter = VisitExpressionForRValue(call->Arguments()[0]);
+      Emitter()->Emit(Bytecode::DirectMappedAggregationTableIteratorFree, iter);
+      break;
+    }
+    default: {
+      UNREACHABLE("Impossible direct-mapped aggregation table iteration bytecode");
+    }
+  }
+}
+
 namespace {
 
 #define AGG_CODES(F)                                                                                                   \
@@ -1138,6 +1291,11 @@ void BytecodeGenerator::VisitBuiltinJoinHashTableCall(ast::CallExpr *call, ast::
       Emitter()->Emit(Bytecode::JoinHashTableBuild, join_hash_table);
       break;
     }
+    case ast::Builtin::JoinHashTableBuildBloomFilter: {
+      LocalVar join_hash_table = VisitExpressionForRValue(call->Arguments()[0]);
+      Emitter()->Emit(Bytecode::JoinHashTableBuildBloomFilter, join_hash_table);
+      break;
+    }
     case ast::Builtin::JoinHashTableIterInit: {
       LocalVar iterator = VisitExpressionForRValue(call->Arguments()[0]);
       LocalVar join_hash_table = VisitExpressionForRValue(call->Arguments()[1]);
@@ -1179,6 +1337,34 @@ void BytecodeGenerator::VisitBuiltinJoinHashTableCall(ast::CallExpr *call, ast::
       Emitter()->Emit(Bytecode::JoinHashTableFree, join_hash_table);
       break;
     }
+    case ast::Builtin::JoinHashTableEnableSpilling: {
+      LocalVar join_hash_table = VisitExpressionForRValue(call->Arguments()[0]);
+      Emitter()->Emit(Bytecode::JoinHashTableEnableSpilling, join_hash_table);
+      break;
+    }
+    case ast::Builtin::JoinHashTableIsSpilled: {
+      LocalVar is_spilled = ExecutionResult()->GetOrCreateDestination(call->GetType());
+      LocalVar join_hash_table = VisitExpressionForRValue(call->Arguments()[0]);
+      LocalVar hash = VisitExpressionForRValue(call->Arguments()[1]);
+      Emitter()->Emit(Bytecode::JoinHashTableIsSpilled, is_spilled, join_hash_table, hash);
+      ExecutionResult()->SetDestination(is_spilled.ValueOf());
+      break;
+    }
+    case ast::Builtin::JoinHashTableDeferProbe: {
+      LocalVar join_hash_table = VisitExpressionForRValue(call->Arguments()[0]);
+      LocalVar hash = VisitExpressionForRValue(call->Arguments()[1]);
+      LocalVar probe_tuple = VisitExpressionForRValue(call->Arguments()[2]);
+      LocalVar probe_tuple_size = VisitExpressionForRValue(call->Arguments()[3]);
+      Emitter()->Emit(Bytecode::JoinHashTableDeferProbeTuple, join_hash_table, hash, probe_tuple, probe_tuple_size);
+      break;
+    }
+    case ast::Builtin::JoinHashTableJoinSpilled: {
+      LocalVar join_hash_table = VisitExpressionForRValue(call->Arguments()[0]);
+      LocalVar ctx = VisitExpressionForRValue(call->Arguments()[1]);
+      const std::string probe_fn_name = call->Arguments()[2]->As<ast::IdentifierExpr>()->Name().Data();
+      Emitter()->EmitJoinHashTableJoinSpilledPartitions(join_hash_table, ctx, LookupFuncIdByName(probe_fn_name));
+      break;
+    }
     default: {
       UNREACHABLE("Impossible bytecode");
     }
@@ -1203,6 +1389,19 @@ void BytecodeGenerator::VisitBuiltinSorterCall(ast::CallExpr *call, ast::Builtin
       Emitter()->Emit(Bytecode::SorterAllocTuple, dest, sorter);
       break;
     }
+    case ast::Builtin::SorterInsertTopK: {
+      LocalVar dest = ExecutionResult()->GetOrCreateDestination(call->GetType());
+      LocalVar sorter = VisitExpressionForRValue(call->Arguments()[0]);
+      LocalVar top_k = VisitExpressionForRValue(call->Arguments()[1]);
+      Emitter()->Emit(Bytecode::SorterAllocTupleTopK, dest, sorter, top_k);
+      break;
+    }
+    case ast::Builtin::SorterInsertTopKFinish: {
+      LocalVar sorter = VisitExpressionForRValue(call->Arguments()[0]);
+      LocalVar top_k = VisitExpressionForRValue(call->Arguments()[1]);
+      Emitter()->Emit(Bytecode::SorterAllocTupleTopKFinish, sorter, top_k);
+      break;
+    }
     case ast::Builtin::SorterSort: {
       LocalVar sorter = VisitExpressionForRValue(call->Arguments()[0]);
       Emitter()->Emit(Bytecode::SorterSort, sorter);
@@ -1228,6 +1427,19 @@ void BytecodeGenerator::VisitBuiltinSorterCall(ast::CallExpr *call, ast::Builtin
       Emitter()->Emit(Bytecode::SorterFree, sorter);
       break;
     }
+    case ast::Builtin::SorterSetTopKThreshold: {
+      LocalVar sorter = VisitExpressionForRValue(call->Arguments()[0]);
+      LocalVar threshold = VisitExpressionForRValue(call->Arguments()[1]);
+      LocalVar key_offset = VisitExpressionForRValue(call->Arguments()[2]);
+      Emitter()->Emit(Bytecode::SorterSetTopKThreshold, sorter, threshold, key_offset);
+      break;
+    }
+    case ast::Builtin::TopKThresholdInit: {
+      LocalVar threshold = VisitExpressionForRValue(call->Arguments()[0]);
+      LocalVar ascending = VisitExpressionForRValue(call->Arguments()[1]);
+      Emitter()->Emit(Bytecode::TopKThresholdInit, threshold, ascending);
+      break;
+    }
     default: {
       UNREACHABLE("Impossible bytecode");
     }
@@ -1375,6 +1587,15 @@ void BytecodeGenerator::VisitBuiltinSizeOfCall(ast::CallExpr *call) {
   ExecutionResult()->SetDestination(size_var.ValueOf());
 }
 
+void BytecodeGenerator::VisitBuiltinOffsetOfCall(ast::CallExpr *call) {
+  auto *struct_type = call->Arguments()[0]->GetType()->As<ast::StructType>();
+  auto field_name = call->Arguments()[1]->As<ast::IdentifierExpr>()->Name();
+  LocalVar offset_var = ExecutionResult()->GetOrCreateDestination(
+      ast::BuiltinType::Get(struct_type->GetContext(), ast::BuiltinType::Uint32));
+  Emitter()->EmitAssignImm4(offset_var, struct_type->GetOffsetOfFieldByName(field_name));
+  ExecutionResult()->SetDestination(offset_var.ValueOf());
+}
+
 void BytecodeGenerator::VisitBuiltinOutputCall(ast::CallExpr *call, ast::Builtin builtin) {
   LocalVar exec_ctx = VisitExpressionForRValue(call->Arguments()[0]);
   switch (builtin) {
@@ -1621,7 +1842,11 @@ void BytecodeGenerator::VisitBuiltinCallExpr(ast::CallExpr *call) {
     case ast::Builtin::FilterGe:
     case ast::Builtin::FilterLt:
     case ast::Builtin::FilterLe:
-    case ast::Builtin::FilterNe: {
+    case ast::Builtin::FilterNe:
+    case ast::Builtin::FilterBetween:
+    case ast::Builtin::FilterIn:
+    case ast::Builtin::FilterStringEq:
+    case ast::Builtin::FilterStringPrefix: {
       VisitBuiltinFilterCall(call, builtin);
       break;
     }
@@ -1640,7 +1865,9 @@ void BytecodeGenerator::VisitBuiltinCallExpr(ast::CallExpr *call) {
     case ast::Builtin::TableIterInitBind:
     case ast::Builtin::TableIterAdvance:
     case ast::Builtin::TableIterGetPCI:
-    case ast::Builtin::TableIterClose: {
+    case ast::Builtin::TableIterClose:
+    case ast::Builtin::TableIterSetTopKThreshold:
+    case ast::Builtin::TableIterAddRuntimeFilter: {
       VisitBuiltinTableIterCall(call, builtin);
       break;
     }
@@ -1704,6 +1931,22 @@ void BytecodeGenerator::VisitBuiltinCallExpr(ast::CallExpr *call) {
       VisitBuiltinAggPartIterCall(call, builtin);
       break;
     }
+    case ast::Builtin::DirectMappedAggTableInit:
+    case ast::Builtin::DirectMappedAggTableInDomain:
+    case ast::Builtin::DirectMappedAggTableLookup:
+    case ast::Builtin::DirectMappedAggTableInsert:
+    case ast::Builtin::DirectMappedAggTableFree: {
+      VisitBuiltinDirectMappedAggTableCall(call, builtin);
+      break;
+    }
+    case ast::Builtin::DirectMappedAggTableIterInit:
+    case ast::Builtin::DirectMappedAggTableIterHasNext:
+    case ast::Builtin::DirectMappedAggTableIterNext:
+    case ast::Builtin::DirectMappedAggTableIterGetRow:
+    case ast::Builtin::DirectMappedAggTableIterClose: {
+      VisitBuiltinDirectMappedAggTableIterCall(call, builtin);
+      break;
+    }
     case ast::Builtin::AggHashTableIterInit:
     case ast::Builtin::AggHashTableIterHasNext:
     case ast::Builtin::AggHashTableIterNext:
@@ -1728,16 +1971,25 @@ void BytecodeGenerator::VisitBuiltinCallExpr(ast::CallExpr *call) {
     case ast::Builtin::JoinHashTableIterClose:
     case ast::Builtin::JoinHashTableBuild:
     case ast::Builtin::JoinHashTableBuildParallel:
-    case ast::Builtin::JoinHashTableFree: {
+    case ast::Builtin::JoinHashTableBuildBloomFilter:
+    case ast::Builtin::JoinHashTableFree:
+    case ast::Builtin::JoinHashTableEnableSpilling:
+    case ast::Builtin::JoinHashTableIsSpilled:
+    case ast::Builtin::JoinHashTableDeferProbe:
+    case ast::Builtin::JoinHashTableJoinSpilled: {
       VisitBuiltinJoinHashTableCall(call, builtin);
       break;
     }
     case ast::Builtin::SorterInit:
     case ast::Builtin::SorterInsert:
+    case ast::Builtin::SorterInsertTopK:
+    case ast::Builtin::SorterInsertTopKFinish:
     case ast::Builtin::SorterSort:
     case ast::Builtin::SorterSortParallel:
     case ast::Builtin::SorterSortTopKParallel:
-    case ast::Builtin::SorterFree: {
+    case ast::Builtin::SorterFree:
+    case ast::Builtin::SorterSetTopKThreshold:
+    case ast::Builtin::TopKThresholdInit: {
       VisitBuiltinSorterCall(call, builtin);
       break;
     }
@@ -1764,6 +2016,10 @@ void BytecodeGenerator::VisitBuiltinCallExpr(ast::CallExpr *call) {
       VisitBuiltinSizeOfCall(call);
       break;
     }
+    case ast::Builtin::OffsetOf: {
+      VisitBuiltinOffsetOfCall(call);
+      break;
+    }
     case ast::Builtin::PtrCast: {
       Visit(call->Arguments()[1]);
       break;
@@ -2384,6 +2640,21 @@ void BytecodeGenerator::VisitExpressionForTest(ast::Expr *expr, BytecodeLabel *t
   }
 }
 
+uint32_t BytecodeGenerator::NewStaticString(const ast::Identifier string) {
+  // Equal literals share their copy
+  std::string contents(string.Data(), string.Length());
+  if (auto iter = static_strings_.find(contents); iter != static_strings_.end()) {
+    return iter->second;
+  }
+
+  // Every string is NUL-terminated, so that even empty strings have an address within the data
+  const auto offset = static_cast<uint32_t>(static_data_.size());
+  static_data_.insert(static_data_.end(), contents.begin(), contents.end());
+  static_data_.push_back(0);
+  static_strings_.emplace(std::move(contents), offset);
+  return offset;
+}
+
 Bytecode BytecodeGenerator::GetIntTypedBytecode(Bytecode bytecode, ast::Type *type) {
   TERRIER_ASSERT(type->IsIntegerType(), "Type must be integer type");
   auto int_kind = type->SafeAs<ast::BuiltinType>()->GetKind();
@@ -2393,13 +2664,18 @@ Bytecode BytecodeGenerator::GetIntTypedBytecode(Bytecode bytecode, ast::Type *ty
 
 // static
 std::unique_ptr<BytecodeModule> BytecodeGenerator::Compile(ast::AstNode *root, exec::ExecutionContext *exec_ctx,
-                                                           const std::string &name) {
+                                                           const std::string &name, const bool optimize) {
   BytecodeGenerator generator{exec_ctx};
   generator.Visit(root);
 
+  if (optimize) {
+    BytecodeOptimizer::Optimize(&generator.bytecode_, &generator.functions_);
+  }
+
   // Create the bytecode module. Note that we move the bytecode and functions
   // array from the generator into the module.
-  return std::make_unique<BytecodeModule>(name, std::move(generator.bytecode_), std::move(generator.functions_));
+  return std::make_unique<BytecodeModule>(name, std::move(generator.bytecode_), std::move(generator.static_data_),
+                                          std::move(generator.functions_));
 }
 
 }  // namespace terrier::execution::vm
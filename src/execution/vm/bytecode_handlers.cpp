@@ -37,6 +37,20 @@ void OpTableVectorIteratorFree(terrier::execution::sql::TableVectorIterator *ite
   iter->~TableVectorIterator();
 }
 
+void OpTableVectorIteratorSetTopKThreshold(terrier::execution::sql::TableVectorIterator *iter,
+                                           const terrier::execution::sql::TopKThreshold *threshold,
+                                           const uint32_t col_idx, const int32_t col_type) {
+  iter->SetTopKThreshold(threshold, col_idx, static_cast<terrier::type::TypeId>(col_type));
+}
+
+void OpTableVectorIteratorAddRuntimeFilter(terrier::execution::sql::TableVectorIterator *iter,
+                                           terrier::execution::sql::JoinHashTable *join_hash_table,
+                                           const uint32_t col_idx, const int32_t col_type) {
+  // The filter was built with the table. There is none once build partitions were spilled, since all their probe
+  // tuples must be deferred.
+  iter->AddRuntimeFilter(join_hash_table->GetBloomFilter(), col_idx, static_cast<terrier::type::TypeId>(col_type));
+}
+
 void OpPCIFilterEqual(uint64_t *size, terrier::execution::sql::ProjectedColumnsIterator *iter, uint32_t col_idx,
                       int8_t type, int64_t val) {
   auto sql_type = static_cast<terrier::type::TypeId>(type);
@@ -79,6 +93,18 @@ void OpPCIFilterNotEqual(uint64_t *size, terrier::execution::sql::ProjectedColum
   *size = iter->FilterColByVal<std::not_equal_to>(col_idx, sql_type, v);
 }
 
+void OpPCIFilterBetween(uint64_t *size, terrier::execution::sql::ProjectedColumnsIterator *iter, uint32_t col_idx,
+                        int8_t type, int64_t lo, int64_t hi) {
+  auto sql_type = static_cast<terrier::type::TypeId>(type);
+  *size = iter->FilterColBetween(col_idx, sql_type, iter->MakeFilterVal(lo, sql_type),
+                                 iter->MakeFilterVal(hi, sql_type));
+}
+
+void OpPCIFilterIn(uint64_t *size, terrier::execution::sql::ProjectedColumnsIterator *iter, uint32_t col_idx,
+                   int8_t type, const int64_t *vals, uint32_t num_vals) {
+  *size = iter->FilterColIn(col_idx, static_cast<terrier::type::TypeId>(type), vals, num_vals);
+}
+
 // ---------------------------------------------------------
 // Filter Manager
 // ---------------------------------------------------------
@@ -116,6 +142,10 @@ void OpJoinHashTableInit(terrier::execution::sql::JoinHashTable *join_hash_table
 
 void OpJoinHashTableBuild(terrier::execution::sql::JoinHashTable *join_hash_table) { join_hash_table->Build(); }
 
+void OpJoinHashTableBuildBloomFilter(terrier::execution::sql::JoinHashTable *join_hash_table) {
+  join_hash_table->BuildBloomFilter();
+}
+
 void OpJoinHashTableBuildParallel(terrier::execution::sql::JoinHashTable *join_hash_table,
                                   terrier::execution::sql::ThreadStateContainer *thread_state_container,
                                   uint32_t jht_offset) {
@@ -124,6 +154,20 @@ void OpJoinHashTableBuildParallel(terrier::execution::sql::JoinHashTable *join_h
 
 void OpJoinHashTableFree(terrier::execution::sql::JoinHashTable *join_hash_table) { join_hash_table->~JoinHashTable(); }
 
+void OpJoinHashTableEnableSpilling(terrier::execution::sql::JoinHashTable *join_hash_table) {
+  join_hash_table->EnableSpilling();
+}
+
+void OpJoinHashTableDeferProbeTuple(terrier::execution::sql::JoinHashTable *join_hash_table, terrier::hash_t hash,
+                                    const terrier::byte *probe_tuple, uint32_t probe_tuple_size) {
+  join_hash_table->DeferProbeTuple(hash, probe_tuple, probe_tuple_size);
+}
+
+void OpJoinHashTableJoinSpilledPartitions(terrier::execution::sql::JoinHashTable *join_hash_table, void *ctx,
+                                          terrier::execution::sql::JoinHashTable::SpilledProbeFn probe_fn) {
+  join_hash_table->JoinSpilledPartitions(ctx, probe_fn);
+}
+
 // ---------------------------------------------------------
 // Aggregation Hash Table
 // ---------------------------------------------------------
@@ -147,6 +191,30 @@ void OpAggregationHashTableIteratorFree(terrier::execution::sql::AggregationHash
   iter->~AggregationHashTableIterator();
 }
 
+// ---------------------------------------------------------
+// Direct-Mapped Aggregation Table
+// ---------------------------------------------------------
+
+void OpDirectMappedAggregationTableInit(terrier::execution::sql::DirectMappedAggregationTable *const table,
+                                        terrier::execution::sql::MemoryPool *const memory, const uint32_t payload_size,
+                                        const int64_t min_key, const int64_t max_key) {
+  new (table) terrier::execution::sql::DirectMappedAggregationTable(memory, payload_size, min_key, max_key);
+}
+
+void OpDirectMappedAggregationTableFree(terrier::execution::sql::DirectMappedAggregationTable *const table) {
+  table->~DirectMappedAggregationTable();
+}
+
+void OpDirectMappedAggregationTableIteratorInit(terrier::execution::sql::DirectMappedAggregationTableIterator *iter,
+                                                terrier::execution::sql::DirectMappedAggregationTable *table) {
+  TERRIER_ASSERT(table != nullptr, "Null table");
+  new (iter) terrier::execution::sql::DirectMappedAggregationTableIterator(*table);
+}
+
+void OpDirectMappedAggregationTableIteratorFree(terrier::execution::sql::DirectMappedAggregationTableIterator *iter) {
+  iter->~DirectMappedAggregationTableIterator();
+}
+
 // ---------------------------------------------------------
 // Sorters
 // ---------------------------------------------------------
@@ -172,6 +240,19 @@ void OpSorterSortTopKParallel(terrier::execution::sql::Sorter *sorter,
 
 void OpSorterFree(terrier::execution::sql::Sorter *sorter) { sorter->~Sorter(); }
 
+void OpSorterSetTopKThreshold(terrier::execution::sql::Sorter *sorter,
+                              terrier::execution::sql::TopKThreshold *threshold, const uint32_t key_offset) {
+  // The key is a SQL integer, whose raw value the sorter publishes
+  const terrier::execution::sql::Integer key(0);
+  const auto *key_start = reinterpret_cast<const terrier::byte *>(&key);
+  const auto val_offset = static_cast<uint32_t>(reinterpret_cast<const terrier::byte *>(&key.val_) - key_start);
+  sorter->SetTopKThreshold(threshold, key_offset + val_offset);
+}
+
+void OpTopKThresholdInit(terrier::execution::sql::TopKThreshold *threshold, const bool ascending) {
+  new (threshold) terrier::execution::sql::TopKThreshold(ascending);
+}
+
 void OpSorterIteratorInit(terrier::execution::sql::SorterIterator *iter, terrier::execution::sql::Sorter *sorter) {
   new (iter) terrier::execution::sql::SorterIterator(sorter);
 }
@@ -135,6 +135,16 @@ uint16_t BytecodeIterator::GetFunctionIdOperand(uint32_t operand_index) const {
   return *reinterpret_cast<const uint16_t *>(operand_address);
 }
 
+uint32_t BytecodeIterator::GetStaticLocalOperand(uint32_t operand_index) const {
+  TERRIER_ASSERT(OperandTypes::IsStaticLocal(Bytecodes::GetNthOperandType(CurrentBytecode(), operand_index)),
+                 "Operand type is not a static local");
+
+  const uint8_t *operand_address =
+      bytecodes_.data() + curr_offset_ + Bytecodes::GetNthOperandOffset(CurrentBytecode(), operand_index);
+
+  return *reinterpret_cast<const uint32_t *>(operand_address);
+}
+
 uint32_t BytecodeIterator::CurrentBytecodeSize() const {
   Bytecode bytecode = CurrentBytecode();
   uint32_t size = sizeof(std::underlying_type_t<Bytecode>);
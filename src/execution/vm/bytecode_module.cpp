@@ -11,8 +11,12 @@
 
 namespace terrier::execution::vm {
 
-BytecodeModule::BytecodeModule(std::string name, std::vector<uint8_t> &&code, std::vector<FunctionInfo> &&functions)
-    : name_(std::move(name)), code_(std::move(code)), functions_(std::move(functions)) {}
+BytecodeModule::BytecodeModule(std::string name, std::vector<uint8_t> &&code, std::vector<uint8_t> &&static_data,
+                               std::vector<FunctionInfo> &&functions)
+    : name_(std::move(name)),
+      code_(std::move(code)),
+      static_data_(std::move(static_data)),
+      functions_(std::move(functions)) {}
 
 namespace {
 
@@ -0,0 +1,1001 @@
+#include "execution/vm/bytecode_optimizer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/SmallVector.h"
+
+#include "common/macros.h"
+#include "common/math_util.h"
+#include "execution/ast/type.h"
+#include "execution/vm/bytecode_iterator.h"
+#include "execution/vm/bytecode_traits.h"
+#include "execution/vm/bytecodes.h"
+
+namespace terrier::execution::vm {
+
+namespace {
+
+// The most instructions a loop's test may have, besides its conditional jump, for it to be copied to the loop's end
+constexpr const uint32_t K_MAX_ROTATED_TEST_SIZE = 4;
+
+// The most jumps followed when threading a jump. Jumps may form cycles.
+constexpr const uint32_t K_MAX_THREADING_HOPS = 16;
+
+// The most rounds of jump threading. Each round may expose new opportunities to the next.
+constexpr const uint32_t K_MAX_THREADING_ROUNDS = 4;
+
+// An ID that no instruction has
+constexpr const uint32_t K_INVALID_ID = std::numeric_limits<uint32_t>::max();
+
+// The number of integer types each typed primitive bytecode exists for
+constexpr const uint32_t K_NUM_INT_TYPES = 8;
+
+// The comparisons, in the order they are listed in both the primitive comparisons and the fused comparison jumps
+enum class Comparison : uint32_t { GreaterThan, GreaterThanEqual, Equal, LessThan, LessThanEqual, NotEqual };
+
+// The number of comparisons
+constexpr const uint32_t K_NUM_COMPARISONS = 6;
+
+// Return the comparison that holds exactly when the given one doesn't
+Comparison Negate(const Comparison comparison) {
+  switch (comparison) {
+    case Comparison::GreaterThan:
+      return Comparison::LessThanEqual;
+    case Comparison::GreaterThanEqual:
+      return Comparison::LessThan;
+    case Comparison::Equal:
+      return Comparison::NotEqual;
+    case Comparison::LessThan:
+      return Comparison::GreaterThanEqual;
+    case Comparison::LessThanEqual:
+      return Comparison::GreaterThan;
+    case Comparison::NotEqual:
+      return Comparison::Equal;
+  }
+  UNREACHABLE("Impossible comparison");
+}
+
+// Is the bytecode in the block of typed bytecodes, for all comparisons and integer types, starting at the given one?
+bool IsInComparisonBlock(const Bytecode bytecode, const Bytecode first) {
+  return bytecode >= first &&
+         Bytecodes::ToByte(bytecode) < Bytecodes::ToByte(first) + K_NUM_COMPARISONS * K_NUM_INT_TYPES;
+}
+
+// Is the bytecode a primitive integer comparison?
+bool IsComparison(const Bytecode bytecode) {
+  return IsInComparisonBlock(bytecode, GET_BASE_FOR_INT_TYPES(Bytecode::GreaterThan));
+}
+
+// Is the bytecode a fused primitive integer comparison and conditional jump?
+bool IsComparisonJump(const Bytecode bytecode) {
+  return IsInComparisonBlock(bytecode, GET_BASE_FOR_INT_TYPES(Bytecode::JumpIfGreaterThan));
+}
+
+// Move the given bytecode from the block of comparison bytecodes starting at 'from' to the one starting at 'to',
+// keeping its integer type. The comparison is negated if requested.
+Bytecode MoveComparison(const Bytecode bytecode, const Bytecode from, const Bytecode to, const bool negate) {
+  const uint32_t idx = Bytecodes::ToByte(bytecode) - Bytecodes::ToByte(from);
+  auto comparison = static_cast<Comparison>(idx / K_NUM_INT_TYPES);
+  if (negate) {
+    comparison = Negate(comparison);
+  }
+  const uint32_t type_idx = idx % K_NUM_INT_TYPES;
+  return Bytecodes::FromByte(Bytecodes::ToByte(to) + static_cast<uint32_t>(comparison) * K_NUM_INT_TYPES + type_idx);
+}
+
+// If the given bytecode is a conditional jump with an exact inverse, a conditional jump that is taken exactly when it
+// isn't, store the inverse and return true
+bool InvertConditionalJump(const Bytecode bytecode, Bytecode *inverse) {
+  if (IsComparisonJump(bytecode)) {
+    const Bytecode first = GET_BASE_FOR_INT_TYPES(Bytecode::JumpIfGreaterThan);
+    *inverse = MoveComparison(bytecode, first, first, true);
+    return true;
+  }
+  switch (bytecode) {
+    case Bytecode::JumpIfTrue:
+      *inverse = Bytecode::JumpIfFalse;
+      return true;
+    case Bytecode::JumpIfFalse:
+      *inverse = Bytecode::JumpIfTrue;
+      return true;
+    case Bytecode::JumpIfTruth:
+      *inverse = Bytecode::JumpIfNotTruth;
+      return true;
+    case Bytecode::JumpIfNotTruth:
+      *inverse = Bytecode::JumpIfTruth;
+      return true;
+    default:
+      return false;
+  }
+}
+
+// If the bytecode writes a primitive value in full into the local its first operand points to, and doesn't keep the
+// pointer around, return the size of the value. Return zero otherwise.
+uint32_t WrittenSize(const Bytecode bytecode) {
+  // Arithmetic on all integer types, followed by comparisons, are listed first. Each bytecode has a variant for
+  // int8_t, int16_t, int32_t and int64_t, then the unsigned types of the same sizes.
+  if (IsComparison(bytecode)) {
+    return sizeof(bool);
+  }
+  if (bytecode >= GET_BASE_FOR_INT_TYPES(Bytecode::Add) && bytecode < GET_BASE_FOR_INT_TYPES(Bytecode::GreaterThan)) {
+    const uint32_t idx = Bytecodes::ToByte(bytecode) - Bytecodes::ToByte(GET_BASE_FOR_INT_TYPES(Bytecode::Add));
+    const uint32_t type_idx = idx % K_NUM_INT_TYPES;
+    return 1u << (type_idx % 4);
+  }
+  switch (bytecode) {
+    case Bytecode::Not:
+    case Bytecode::IsNullPtr:
+    case Bytecode::IsNotNullPtr:
+    case Bytecode::ForceBoolTruth:
+    case Bytecode::PCIIsFiltered:
+    case Bytecode::PCIHasNext:
+    case Bytecode::PCIHasNextFiltered:
+    case Bytecode::TableVectorIteratorNext:
+      return sizeof(bool);
+    case Bytecode::Deref1:
+    case Bytecode::Assign1:
+    case Bytecode::AssignImm1:
+      return 1;
+    case Bytecode::Deref2:
+    case Bytecode::Assign2:
+    case Bytecode::AssignImm2:
+      return 2;
+    case Bytecode::Deref4:
+    case Bytecode::Assign4:
+    case Bytecode::AssignImm4:
+    case Bytecode::AssignImm4F:
+      return 4;
+    case Bytecode::Deref8:
+    case Bytecode::Assign8:
+    case Bytecode::AssignImm8:
+    case Bytecode::AssignImm8F:
+    case Bytecode::Lea:
+    case Bytecode::LeaScaled:
+    case Bytecode::ExecutionContextGetMemoryPool:
+    case Bytecode::TableVectorIteratorGetPCI:
+      return sizeof(void *);
+    default:
+      return 0;
+  }
+}
+
+// Is writing its result the only effect of the bytecode? If so, it can be removed when the result is never read.
+bool IsPure(const Bytecode bytecode) {
+  return WrittenSize(bytecode) != 0 && bytecode != Bytecode::TableVectorIteratorNext;
+}
+
+// The bytecode that assigns an integer immediate of the given size
+bool GetAssignImmediate(const uint32_t size, Bytecode *bytecode) {
+  switch (size) {
+    case 1:
+      *bytecode = Bytecode::AssignImm1;
+      return true;
+    case 2:
+      *bytecode = Bytecode::AssignImm2;
+      return true;
+    case 4:
+      *bytecode = Bytecode::AssignImm4;
+      return true;
+    case 8:
+      *bytecode = Bytecode::AssignImm8;
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Is the bytecode a copy from a local, and if so, of how many bytes?
+uint32_t CopySize(const Bytecode bytecode) {
+  switch (bytecode) {
+    case Bytecode::Assign1:
+      return 1;
+    case Bytecode::Assign2:
+      return 2;
+    case Bytecode::Assign4:
+      return 4;
+    case Bytecode::Assign8:
+      return 8;
+    default:
+      return 0;
+  }
+}
+
+// Is the bytecode an assignment of an integer immediate?
+bool IsIntAssignImmediate(const Bytecode bytecode) {
+  return bytecode == Bytecode::AssignImm1 || bytecode == Bytecode::AssignImm2 || bytecode == Bytecode::AssignImm4 ||
+         bytecode == Bytecode::AssignImm8;
+}
+
+// Append the raw bytes of a value to the bytecode
+template <typename T>
+void Append(std::vector<uint8_t> *code, const T val) {
+  const auto *bytes = reinterpret_cast<const uint8_t *>(&val);
+  code->insert(code->end(), bytes, bytes + sizeof(T));
+}
+
+// An operand of a decoded instruction
+struct Operand {
+  // The raw bits of an immediate or function ID, the encoded local, or the ID of the instruction a jump goes to
+  uint64_t value = 0;
+  // The locals of a local count
+  std::vector<LocalVar> locals;
+};
+
+// A decoded bytecode instruction
+struct Instruction {
+  // The local at the given operand
+  LocalVar Local(const uint32_t idx) const { return LocalVar::Decode(static_cast<uint32_t>(operands[idx].value)); }
+
+  // The ID of the instruction this jump goes to
+  uint32_t Target() const {
+    return static_cast<uint32_t>(operands[Bytecodes::GetJumpOffsetOperandIndex(bytecode)].value);
+  }
+
+  // Make this jump go to the instruction with the given ID
+  void SetTarget(const uint32_t id) { operands[Bytecodes::GetJumpOffsetOperandIndex(bytecode)].value = id; }
+
+  Bytecode bytecode;
+  // The ID of the instruction, used by jumps to refer to it
+  uint32_t id;
+  llvm::SmallVector<Operand, 4> operands;
+};
+
+/**
+ * Optimizes the bytecode of a single function. The bytecode is decoded into a list of instructions first. Jumps refer
+ * to the ID of the instruction they go to, so instructions can be added and removed freely. The list is encoded back
+ * once all passes have run.
+ */
+class FunctionOptimizer {
+ public:
+  explicit FunctionOptimizer(const FunctionInfo &func) : func_(func) {}
+
+  // Decode the function's bytecode. Return false if the bytecode isn't in the shape the optimizer expects, in which
+  // case the function should be left as it is.
+  bool Decode(const std::vector<uint8_t> &code);
+
+  // Run all passes, but the coalescing of locals
+  void Run();
+
+  // Lay out the locals in the frame, coalescing those that can share a slot, and rewrite all references to them.
+  // Return the new locals, and the new frame size in 'frame_size'.
+  std::vector<LocalInfo> LayOutLocals(std::size_t *frame_size);
+
+  // Append the bytecode of the function to 'code'
+  void Encode(std::vector<uint8_t> *code) const;
+
+ private:
+  // Map the ID of each instruction to its position in the list
+  std::unordered_map<uint32_t, uint32_t> BuildIndex() const;
+
+  // Collect the positions of the instructions that may run right after the one at the given position
+  void GetSuccessors(const std::unordered_map<uint32_t, uint32_t> &index, uint32_t pos,
+                     llvm::SmallVectorImpl<uint32_t> *successors) const;
+
+  // Remove the instructions at the positions set in 'remove'. Jumps to a removed instruction go to the first
+  // instruction after it that is kept.
+  void RemoveInstructions(const llvm::BitVector &remove);
+
+  // Replace the 'count' instructions at the given position by a single instruction, which keeps the ID of the first
+  void Replace(uint32_t pos, uint32_t count, Bytecode bytecode, llvm::SmallVector<Operand, 4> operands);
+
+  // The passes
+  bool ThreadJumps();
+  bool RotateLoops();
+  bool RemoveJumpsToNext();
+  bool RemoveUnreachable();
+  void CombineInstructions();
+  bool CombineAt(uint32_t pos, const std::unordered_set<uint32_t> &targets);
+  void EliminateDeadStores();
+
+  // The index of the local at the given offset in the function's list of locals
+  uint32_t LocalIndex(LocalVar local) const { return local_indexes_.at(local.GetOffset()); }
+
+  // Find the locals whose address is only ever taken by instructions writing them in full. The analyses only
+  // consider these locals.
+  void FindTrackedLocals();
+
+  // If the instruction writes a tracked local in full, store its index and return true
+  bool GetDefinedLocal(const Instruction &inst, uint32_t *local) const;
+
+  // Call the function with the index of every tracked local the instruction reads
+  template <typename F>
+  void ForEachUsedLocal(const Instruction &inst, F &&f) const;
+
+  // Compute the tracked locals that are live after each instruction
+  void ComputeLiveness();
+
+  // Is the local tracked, and dead after the instruction at the given position?
+  bool IsDeadAfter(LocalVar local, uint32_t pos) const {
+    const uint32_t idx = LocalIndex(local);
+    return tracked_[idx] && !live_out_[pos][idx];
+  }
+
+ private:
+  const FunctionInfo &func_;
+  // The instructions of the function, in order
+  std::vector<Instruction> insts_;
+  // The ID of the next instruction created
+  uint32_t next_id_ = 0;
+  // The index of each local by its offset in the frame
+  std::unordered_map<uint32_t, uint32_t> local_indexes_;
+  // The locals the analyses consider
+  llvm::BitVector tracked_;
+  // The tracked locals live after each instruction, and live on entry to the function
+  std::vector<llvm::BitVector> live_out_;
+  llvm::BitVector live_on_entry_;
+};
+
+bool FunctionOptimizer::Decode(const std::vector<uint8_t> &code) {
+  for (uint32_t i = 0; i < func_.Locals().size(); i++) {
+    local_indexes_[func_.Locals()[i].Offset()] = i;
+  }
+
+  const auto [start, end] = func_.BytecodeRange();
+  std::unordered_map<std::size_t, uint32_t> ids;
+  for (BytecodeIterator iter(code, start, end); !iter.Done(); iter.Advance()) {
+    const Bytecode bytecode = iter.CurrentBytecode();
+    ids[iter.GetPosition()] = next_id_;
+
+    Instruction inst{bytecode, next_id_++, {}};
+    for (uint32_t i = 0; i < Bytecodes::NumOperands(bytecode); i++) {
+      Operand operand;
+      switch (Bytecodes::GetNthOperandType(bytecode, i)) {
+        case OperandType::JumpOffset: {
+          // The position of the target for now, its ID once all instructions are known
+          operand.value =
+              iter.GetPosition() + Bytecodes::GetNthOperandOffset(bytecode, i) + iter.GetJumpOffsetOperand(i);
+          break;
+        }
+        case OperandType::LocalCount: {
+          iter.GetLocalCountOperand(i, &operand.locals);
+          for (const auto local : operand.locals) {
+            if (local_indexes_.count(local.GetOffset()) == 0) {
+              return false;
+            }
+          }
+          break;
+        }
+        default: {
+          const std::size_t operand_pos = start + iter.GetPosition() + Bytecodes::GetNthOperandOffset(bytecode, i);
+          const auto size = static_cast<std::size_t>(Bytecodes::GetNthOperandSize(bytecode, i));
+          std::memcpy(&operand.value, &code[operand_pos], size);
+          if (Bytecodes::GetNthOperandType(bytecode, i) == OperandType::Local &&
+              local_indexes_.count(LocalVar::Decode(static_cast<uint32_t>(operand.value)).GetOffset()) == 0) {
+            return false;
+          }
+          break;
+        }
+      }
+      inst.operands.push_back(std::move(operand));
+    }
+    insts_.push_back(std::move(inst));
+  }
+
+  // Every function ends in a return or jump, and all jumps go to an instruction of the function
+  if (insts_.empty() || !Bytecodes::IsTerminal(insts_.back().bytecode)) {
+    return false;
+  }
+  for (auto &inst : insts_) {
+    if (Bytecodes::IsJump(inst.bytecode)) {
+      auto iter = ids.find(inst.Target());
+      if (iter == ids.end()) {
+        return false;
+      }
+      inst.SetTarget(iter->second);
+    }
+  }
+  return true;
+}
+
+void FunctionOptimizer::Run() {
+  for (uint32_t round = 0; round < K_MAX_THREADING_ROUNDS; round++) {
+    bool changed = ThreadJumps();
+    changed |= RotateLoops();
+    changed |= RemoveJumpsToNext();
+    changed |= RemoveUnreachable();
+    if (!changed) {
+      break;
+    }
+  }
+  CombineInstructions();
+  EliminateDeadStores();
+}
+
+std::unordered_map<uint32_t, uint32_t> FunctionOptimizer::BuildIndex() const {
+  std::unordered_map<uint32_t, uint32_t> index;
+  for (uint32_t pos = 0; pos < insts_.size(); pos++) {
+    index[insts_[pos].id] = pos;
+  }
+  return index;
+}
+
+void FunctionOptimizer::GetSuccessors(const std::unordered_map<uint32_t, uint32_t> &index, const uint32_t pos,
+                                      llvm::SmallVectorImpl<uint32_t> *successors) const {
+  const Instruction &inst = insts_[pos];
+  if (Bytecodes::IsJump(inst.bytecode)) {
+    successors->push_back(index.at(inst.Target()));
+  }
+  if (!Bytecodes::IsTerminal(inst.bytecode) && pos + 1 < insts_.size()) {
+    successors->push_back(pos + 1);
+  }
+}
+
+void FunctionOptimizer::RemoveInstructions(const llvm::BitVector &remove) {
+  // Where jumps to each removed instruction go instead
+  std::unordered_map<uint32_t, uint32_t> forward;
+  uint32_t next_kept = K_INVALID_ID;
+  for (uint32_t pos = insts_.size(); pos-- > 0;) {
+    if (remove[pos]) {
+      forward[insts_[pos].id] = next_kept;
+    } else {
+      next_kept = insts_[pos].id;
+    }
+  }
+
+  std::vector<Instruction> kept;
+  for (uint32_t pos = 0; pos < insts_.size(); pos++) {
+    if (remove[pos]) {
+      continue;
+    }
+    Instruction &inst = insts_[pos];
+    if (Bytecodes::IsJump(inst.bytecode)) {
+      if (auto iter = forward.find(inst.Target()); iter != forward.end()) {
+        TERRIER_ASSERT(iter->second != K_INVALID_ID, "Jump to the end of the function");
+        inst.SetTarget(iter->second);
+      }
+    }
+    kept.push_back(std::move(inst));
+  }
+  insts_ = std::move(kept);
+}
+
+void FunctionOptimizer::Replace(const uint32_t pos, const uint32_t count, const Bytecode bytecode,
+                                llvm::SmallVector<Operand, 4> operands) {
+  insts_[pos].bytecode = bytecode;
+  insts_[pos].operands = std::move(operands);
+  insts_.erase(insts_.begin() + pos + 1, insts_.begin() + pos + count);
+  // The replacement is followed by the same instructions as the last instruction replaced
+  if (!live_out_.empty()) {
+    live_out_[pos] = live_out_[pos + count - 1];
+    live_out_.erase(live_out_.begin() + pos + 1, live_out_.begin() + pos + count);
+  }
+}
+
+bool FunctionOptimizer::ThreadJumps() {
+  const auto index = BuildIndex();
+  bool changed = false;
+  for (auto &inst : insts_) {
+    if (!Bytecodes::IsJump(inst.bytecode)) {
+      continue;
+    }
+
+    const bool is_simple_conditional = inst.bytecode == Bytecode::JumpIfTrue || inst.bytecode == Bytecode::JumpIfFalse;
+    uint32_t target = index.at(inst.Target());
+    for (uint32_t hops = 0; hops < K_MAX_THREADING_HOPS; hops++) {
+      const Instruction &next = insts_[target];
+      if (next.bytecode == Bytecode::Jump) {
+        // Go straight to where the next jump goes
+        target = index.at(next.Target());
+      } else if (is_simple_conditional &&
+                 (next.bytecode == Bytecode::JumpIfTrue || next.bytecode == Bytecode::JumpIfFalse) &&
+                 next.Local(0) == inst.Local(0)) {
+        // The next jump tests the same condition, so we know whether it's taken
+        target = next.bytecode == inst.bytecode ? index.at(next.Target()) : target + 1;
+      } else {
+        break;
+      }
+    }
+
+    if (insts_[target].id != inst.Target()) {
+      inst.SetTarget(insts_[target].id);
+      changed = true;
+    }
+
+    // A jump to a return might as well return
+    if (inst.bytecode == Bytecode::Jump && insts_[target].bytecode == Bytecode::Return) {
+      inst.bytecode = Bytecode::Return;
+      inst.operands.clear();
+      changed = true;
+    }
+  }
+  return changed;
+}
+
+bool FunctionOptimizer::RotateLoops() {
+  //
+  // A loop is laid out as its test, which jumps to the loop's exit when it fails, followed by its body, which jumps
+  // back to the test. Each iteration thus runs two jumps. When the test is short, we replace the jump back by a copy
+  // of the test, inverted to jump back into the body while it passes and to fall through to the exit otherwise.
+  //
+
+  const auto index = BuildIndex();
+  bool changed = false;
+  std::vector<Instruction> rotated;
+  for (uint32_t pos = 0; pos < insts_.size(); pos++) {
+    const Instruction &inst = insts_[pos];
+    if (inst.bytecode != Bytecode::Jump || pos + 1 == insts_.size()) {
+      rotated.push_back(inst);
+      continue;
+    }
+
+    // The test is a few straight-line instructions, then a conditional jump to the instruction after this jump
+    const uint32_t test_start = index.at(inst.Target());
+    uint32_t test_end = test_start;
+    while (test_end < insts_.size() && test_end - test_start < K_MAX_ROTATED_TEST_SIZE &&
+           !Bytecodes::IsJump(insts_[test_end].bytecode) && !Bytecodes::IsTerminal(insts_[test_end].bytecode)) {
+      test_end++;
+    }
+    Bytecode inverse;
+    if (test_end + 1 >= insts_.size() || !InvertConditionalJump(insts_[test_end].bytecode, &inverse) ||
+        insts_[test_end].Target() != insts_[pos + 1].id) {
+      rotated.push_back(inst);
+      continue;
+    }
+
+    // The copy starts with the ID of the jump, in case other jumps go to it
+    for (uint32_t test_pos = test_start; test_pos <= test_end; test_pos++) {
+      rotated.push_back(insts_[test_pos]);
+      rotated.back().id = test_pos == test_start ? inst.id : next_id_++;
+    }
+    rotated.back().bytecode = inverse;
+    rotated.back().SetTarget(insts_[test_end + 1].id);
+    changed = true;
+  }
+  insts_ = std::move(rotated);
+  return changed;
+}
+
+bool FunctionOptimizer::RemoveJumpsToNext() {
+  llvm::BitVector remove(insts_.size());
+  for (uint32_t pos = 0; pos + 1 < insts_.size(); pos++) {
+    const Instruction &inst = insts_[pos];
+    if ((inst.bytecode == Bytecode::Jump || inst.bytecode == Bytecode::JumpIfTrue ||
+         inst.bytecode == Bytecode::JumpIfFalse) &&
+        inst.Target() == insts_[pos + 1].id) {
+      remove.set(pos);
+    }
+  }
+  if (remove.none()) {
+    return false;
+  }
+  RemoveInstructions(remove);
+  return true;
+}
+
+bool FunctionOptimizer::RemoveUnreachable() {
+  const auto index = BuildIndex();
+  llvm::BitVector reached(insts_.size());
+  llvm::SmallVector<uint32_t, 16> stack = {0};
+  reached.set(0);
+  while (!stack.empty()) {
+    const uint32_t pos = stack.pop_back_val();
+    llvm::SmallVector<uint32_t, 2> successors;
+    GetSuccessors(index, pos, &successors);
+    for (const uint32_t successor : successors) {
+      if (!reached[successor]) {
+        reached.set(successor);
+        stack.push_back(successor);
+      }
+    }
+  }
+  if (reached.all()) {
+    return false;
+  }
+  reached.flip();
+  RemoveInstructions(reached);
+  return true;
+}
+
+void FunctionOptimizer::CombineInstructions() {
+  ComputeLiveness();
+
+  // Instructions that jumps go to must stay at the start of a combination
+  std::unordered_set<uint32_t> targets;
+  for (const auto &inst : insts_) {
+    if (Bytecodes::IsJump(inst.bytecode)) {
+      targets.insert(inst.Target());
+    }
+  }
+
+  for (uint32_t pos = 0; pos < insts_.size(); pos++) {
+    while (CombineAt(pos, targets)) {
+    }
+  }
+  live_out_.clear();
+}
+
+bool FunctionOptimizer::CombineAt(const uint32_t pos, const std::unordered_set<uint32_t> &targets) {
+  // Can the instructions after the one at the given position be combined into it?
+  const auto can_combine = [&](const uint32_t count) {
+    if (pos + count > insts_.size()) {
+      return false;
+    }
+    for (uint32_t i = 1; i < count; i++) {
+      if (targets.count(insts_[pos + i].id) != 0) {
+        return false;
+      }
+    }
+    return true;
+  };
+
+  // Does the instruction at the given position jump on the value of 'cond', computed only for this jump?
+  const auto jumps_on = [&](const uint32_t jump_pos, const LocalVar cond) {
+    const Instruction &jump = insts_[jump_pos];
+    return (jump.bytecode == Bytecode::JumpIfTrue || jump.bytecode == Bytecode::JumpIfFalse) &&
+           cond.GetAddressMode() == LocalVar::AddressMode::Address && jump.Local(0) == cond.ValueOf() &&
+           IsDeadAfter(cond, jump_pos);
+  };
+
+  const Instruction &inst = insts_[pos];
+
+  // Advance a PCI, check for more tuples and jump back into the loop if there are
+  if ((inst.bytecode == Bytecode::PCIAdvance || inst.bytecode == Bytecode::PCIAdvanceFiltered) && can_combine(3)) {
+    const bool filtered = inst.bytecode == Bytecode::PCIAdvanceFiltered;
+    const Instruction &has_next = insts_[pos + 1];
+    const Instruction &jump = insts_[pos + 2];
+    if (has_next.bytecode == (filtered ? Bytecode::PCIHasNextFiltered : Bytecode::PCIHasNext) &&
+        has_next.Local(1) == inst.Local(0) && jump.bytecode == Bytecode::JumpIfTrue &&
+        jumps_on(pos + 2, has_next.Local(0))) {
+      Replace(pos, 3, filtered ? Bytecode::PCIAdvanceFilteredJumpIfHasNext : Bytecode::PCIAdvanceJumpIfHasNext,
+              {inst.operands[0], jump.operands[1]});
+      return true;
+    }
+  }
+
+  // Compare two integers and jump on the result
+  if (IsComparison(inst.bytecode) && can_combine(2) && jumps_on(pos + 1, inst.Local(0))) {
+    const Instruction &jump = insts_[pos + 1];
+    const Bytecode bytecode =
+        MoveComparison(inst.bytecode, GET_BASE_FOR_INT_TYPES(Bytecode::GreaterThan),
+                       GET_BASE_FOR_INT_TYPES(Bytecode::JumpIfGreaterThan), jump.bytecode == Bytecode::JumpIfFalse);
+    Replace(pos, 2, bytecode, {inst.operands[1], inst.operands[2], jump.operands[1]});
+    return true;
+  }
+
+  // Force the truth of a SQL boolean and jump on it
+  if (inst.bytecode == Bytecode::ForceBoolTruth && can_combine(2) && jumps_on(pos + 1, inst.Local(0))) {
+    const Instruction &jump = insts_[pos + 1];
+    const Bytecode bytecode = jump.bytecode == Bytecode::JumpIfTrue ? Bytecode::JumpIfTruth : Bytecode::JumpIfNotTruth;
+    Replace(pos, 2, bytecode, {inst.operands[1], jump.operands[1]});
+    return true;
+  }
+
+  // Compute a temporary, then copy it elsewhere. Compute it there directly instead.
+  uint32_t temp;
+  if (can_combine(2) && GetDefinedLocal(inst, &temp) && IsPure(inst.bytecode)) {
+    const Instruction &copy = insts_[pos + 1];
+    const uint32_t copy_size = CopySize(copy.bytecode);
+    const uint32_t temp_size = func_.Locals()[temp].Size();
+    if (copy_size != 0 && copy.Local(1) == inst.Local(0).ValueOf() &&
+        copy.Local(0).GetOffset() != inst.Local(0).GetOffset() && IsDeadAfter(inst.Local(0), pos + 1)) {
+      if (copy_size == temp_size) {
+        llvm::SmallVector<Operand, 4> operands = inst.operands;
+        operands[0] = copy.operands[0];
+        Replace(pos, 2, inst.bytecode, std::move(operands));
+        return true;
+      }
+      // The copy reads the low bytes of an integer immediate, so we assign those directly
+      Bytecode assign;
+      if (copy_size < temp_size && IsIntAssignImmediate(inst.bytecode) && GetAssignImmediate(copy_size, &assign)) {
+        Replace(pos, 2, assign, {copy.operands[0], inst.operands[1]});
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+void FunctionOptimizer::EliminateDeadStores() {
+  // Removing a store may make the stores of the values it reads dead too
+  while (true) {
+    ComputeLiveness();
+    llvm::BitVector remove(insts_.size());
+    for (uint32_t pos = 0; pos < insts_.size(); pos++) {
+      uint32_t local;
+      if (IsPure(insts_[pos].bytecode) && GetDefinedLocal(insts_[pos], &local) && !live_out_[pos][local]) {
+        remove.set(pos);
+      }
+    }
+    live_out_.clear();
+    if (remove.none()) {
+      break;
+    }
+    RemoveInstructions(remove);
+  }
+}
+
+void FunctionOptimizer::FindTrackedLocals() {
+  const auto &locals = func_.Locals();
+  tracked_ = llvm::BitVector(locals.size(), true);
+  for (uint32_t i = 0; i < locals.size(); i++) {
+    if (locals[i].IsParameter()) {
+      tracked_.reset(i);
+    }
+  }
+
+  for (const auto &inst : insts_) {
+    for (uint32_t i = 0; i < inst.operands.size(); i++) {
+      switch (Bytecodes::GetNthOperandType(inst.bytecode, i)) {
+        case OperandType::Local: {
+          const LocalVar local = inst.Local(i);
+          const uint32_t idx = LocalIndex(local);
+          if (local.GetAddressMode() == LocalVar::AddressMode::Address &&
+              (i != 0 || WrittenSize(inst.bytecode) != locals[idx].Size())) {
+            tracked_.reset(idx);
+          }
+          break;
+        }
+        case OperandType::LocalCount: {
+          for (const auto local : inst.operands[i].locals) {
+            if (local.GetAddressMode() == LocalVar::AddressMode::Address) {
+              tracked_.reset(LocalIndex(local));
+            }
+          }
+          break;
+        }
+        default:
+          break;
+      }
+    }
+  }
+}
+
+bool FunctionOptimizer::GetDefinedLocal(const Instruction &inst, uint32_t *local) const {
+  if (WrittenSize(inst.bytecode) == 0 || inst.Local(0).GetAddressMode() != LocalVar::AddressMode::Address) {
+    return false;
+  }
+  *local = LocalIndex(inst.Local(0));
+  return tracked_[*local];
+}
+
+template <typename F>
+void FunctionOptimizer::ForEachUsedLocal(const Instruction &inst, F &&f) const {
+  const auto use = [&](const LocalVar local) {
+    if (local.GetAddressMode() == LocalVar::AddressMode::Value) {
+      if (const uint32_t idx = LocalIndex(local); tracked_[idx]) {
+        f(idx);
+      }
+    }
+  };
+  for (uint32_t i = 0; i < inst.operands.size(); i++) {
+    const OperandType type = Bytecodes::GetNthOperandType(inst.bytecode, i);
+    if (type == OperandType::Local) {
+      use(inst.Local(i));
+    } else if (type == OperandType::LocalCount) {
+      for (const auto local : inst.operands[i].locals) {
+        use(local);
+      }
+    }
+  }
+}
+
+void FunctionOptimizer::ComputeLiveness() {
+  FindTrackedLocals();
+
+  const auto index = BuildIndex();
+  const uint32_t num_locals = func_.Locals().size();
+  std::vector<llvm::BitVector> live_in(insts_.size(), llvm::BitVector(num_locals));
+  live_out_.assign(insts_.size(), llvm::BitVector(num_locals));
+
+  // Iterate backwards until nothing changes. Each round takes the liveness one loop further back.
+  for (bool changed = true; changed;) {
+    changed = false;
+    for (uint32_t pos = insts_.size(); pos-- > 0;) {
+      llvm::SmallVector<uint32_t, 2> successors;
+      GetSuccessors(index, pos, &successors);
+      llvm::BitVector live = llvm::BitVector(num_locals);
+      for (const uint32_t successor : successors) {
+        live |= live_in[successor];
+      }
+      live_out_[pos] = live;
+
+      uint32_t defined;
+      if (GetDefinedLocal(insts_[pos], &defined)) {
+        live.reset(defined);
+      }
+      ForEachUsedLocal(insts_[pos], [&](const uint32_t used) { live.set(used); });
+      if (live != live_in[pos]) {
+        live_in[pos] = std::move(live);
+        changed = true;
+      }
+    }
+  }
+
+  live_on_entry_ = insts_.empty() ? llvm::BitVector(num_locals) : live_in[0];
+}
+
+std::vector<LocalInfo> FunctionOptimizer::LayOutLocals(std::size_t *frame_size) {
+  ComputeLiveness();
+  const auto &locals = func_.Locals();
+  const uint32_t num_locals = locals.size();
+
+  // The locals instructions refer to
+  llvm::BitVector referenced(num_locals);
+  for (const auto &inst : insts_) {
+    for (uint32_t i = 0; i < inst.operands.size(); i++) {
+      const OperandType type = Bytecodes::GetNthOperandType(inst.bytecode, i);
+      if (type == OperandType::Local) {
+        referenced.set(LocalIndex(inst.Local(i)));
+      } else if (type == OperandType::LocalCount) {
+        for (const auto local : inst.operands[i].locals) {
+          referenced.set(LocalIndex(local));
+        }
+      }
+    }
+  }
+
+  // Two locals interfere if one is written while the other is live
+  std::vector<llvm::BitVector> interferes(num_locals, llvm::BitVector(num_locals));
+  for (uint32_t pos = 0; pos < insts_.size(); pos++) {
+    uint32_t defined;
+    if (GetDefinedLocal(insts_[pos], &defined)) {
+      for (const uint32_t live : live_out_[pos].set_bits()) {
+        if (live != defined) {
+          interferes[defined].set(live);
+          interferes[live].set(defined);
+        }
+      }
+    }
+  }
+
+  // Assign locals to slots. Tracked locals that may be read before they are written are never shared.
+  struct Slot {
+    ast::Type *type;
+    bool shared;
+    llvm::BitVector locals;
+    uint32_t offset;
+  };
+  std::vector<Slot> slots;
+  std::vector<uint32_t> slot_of_local(num_locals, K_INVALID_ID);
+  for (uint32_t idx = 0; idx < num_locals; idx++) {
+    if (locals[idx].IsParameter() || !referenced[idx]) {
+      continue;
+    }
+    const bool shared = tracked_[idx] && !live_on_entry_[idx];
+    if (shared) {
+      for (uint32_t slot_idx = 0; slot_idx < slots.size(); slot_idx++) {
+        Slot &slot = slots[slot_idx];
+        if (slot.shared && slot.type == locals[idx].GetType() && !interferes[idx].anyCommon(slot.locals)) {
+          slot.locals.set(idx);
+          slot_of_local[idx] = slot_idx;
+          break;
+        }
+      }
+    }
+    if (slot_of_local[idx] == K_INVALID_ID) {
+      slot_of_local[idx] = slots.size();
+      slots.push_back(Slot{locals[idx].GetType(), shared, llvm::BitVector(num_locals), 0});
+      slots.back().locals.set(idx);
+    }
+  }
+
+  // Lay out the slots after the parameters, the most aligned first to waste the least space on padding
+  std::vector<uint32_t> order(slots.size());
+  for (uint32_t i = 0; i < order.size(); i++) {
+    order[i] = i;
+  }
+  std::stable_sort(order.begin(), order.end(), [&](const uint32_t a, const uint32_t b) {
+    return slots[a].type->Alignment() > slots[b].type->Alignment();
+  });
+  std::size_t frame_end = func_.ParamsSize();
+  for (const uint32_t slot_idx : order) {
+    Slot &slot = slots[slot_idx];
+    frame_end = common::MathUtil::AlignTo(frame_end, slot.type->Alignment());
+    slot.offset = static_cast<uint32_t>(frame_end);
+    frame_end += slot.type->Size();
+  }
+  *frame_size = frame_end;
+
+  // The new locals, and the new offset of each old one
+  std::vector<LocalInfo> new_locals;
+  std::unordered_map<uint32_t, uint32_t> new_offsets;
+  for (uint32_t idx = 0; idx < num_locals; idx++) {
+    const LocalInfo &local = locals[idx];
+    if (local.IsParameter()) {
+      new_locals.push_back(local);
+      new_offsets[local.Offset()] = local.Offset();
+    } else if (slot_of_local[idx] != K_INVALID_ID) {
+      const uint32_t offset = slots[slot_of_local[idx]].offset;
+      new_locals.emplace_back(local.Name(), local.GetType(), offset, LocalInfo::Kind::Var);
+      new_offsets[local.Offset()] = offset;
+    }
+  }
+
+  const auto relocate = [&](const LocalVar local) {
+    return LocalVar(new_offsets.at(local.GetOffset()), local.GetAddressMode());
+  };
+  for (auto &inst : insts_) {
+    for (uint32_t i = 0; i < inst.operands.size(); i++) {
+      const OperandType type = Bytecodes::GetNthOperandType(inst.bytecode, i);
+      if (type == OperandType::Local) {
+        inst.operands[i].value = relocate(inst.Local(i)).Encode();
+      } else if (type == OperandType::LocalCount) {
+        for (auto &local : inst.operands[i].locals) {
+          local = relocate(local);
+        }
+      }
+    }
+  }
+
+  live_out_.clear();
+  return new_locals;
+}
+
+void FunctionOptimizer::Encode(std::vector<uint8_t> *code) const {
+  std::unordered_map<uint32_t, std::size_t> positions;
+  // The position of each jump offset, and the ID of the instruction the jump goes to
+  std::vector<std::pair<std::size_t, uint32_t>> jumps;
+
+  for (const auto &inst : insts_) {
+    positions[inst.id] = code->size();
+    Append(code, static_cast<std::underlying_type_t<Bytecode>>(inst.bytecode));
+    for (uint32_t i = 0; i < inst.operands.size(); i++) {
+      const Operand &operand = inst.operands[i];
+      switch (Bytecodes::GetNthOperandType(inst.bytecode, i)) {
+        case OperandType::JumpOffset: {
+          jumps.emplace_back(code->size(), static_cast<uint32_t>(operand.value));
+          Append(code, int32_t{0});
+          break;
+        }
+        case OperandType::LocalCount: {
+          Append(code, static_cast<uint16_t>(operand.locals.size()));
+          for (const auto local : operand.locals) {
+            Append(code, local.Encode());
+          }
+          break;
+        }
+        default: {
+          const auto *bytes = reinterpret_cast<const uint8_t *>(&operand.value);
+          const auto size = static_cast<std::size_t>(Bytecodes::GetNthOperandSize(inst.bytecode, i));
+          code->insert(code->end(), bytes, bytes + size);
+          break;
+        }
+      }
+    }
+  }
+
+  // Jump offsets are relative to the position of the offset
+  for (const auto &[offset_pos, target] : jumps) {
+    const auto delta =
+        static_cast<int32_t>(static_cast<int64_t>(positions.at(target)) - static_cast<int64_t>(offset_pos));
+    std::memcpy(&(*code)[offset_pos], &delta, sizeof(delta));
+  }
+}
+
+}  // namespace
+
+void BytecodeOptimizer::Optimize(std::vector<uint8_t> *code, std::vector<FunctionInfo> *functions) {
+  std::vector<uint8_t> optimized_code;
+  optimized_code.reserve(code->size());
+
+  for (auto &func : *functions) {
+    const std::size_t start = optimized_code.size();
+
+    FunctionOptimizer optimizer(func);
+    if (optimizer.Decode(*code)) {
+      optimizer.Run();
+      std::size_t frame_size = 0;
+      func.locals_ = optimizer.LayOutLocals(&frame_size);
+      func.frame_size_ = frame_size;
+      optimizer.Encode(&optimized_code);
+    } else {
+      const auto [func_start, func_end] = func.BytecodeRange();
+      optimized_code.insert(optimized_code.end(), code->begin() + func_start, code->begin() + func_end);
+    }
+
+    func.SetBytecodeRange(start, optimized_code.size());
+  }
+
+  *code = std::move(optimized_code);
+}
+
+}  // namespace terrier::execution::vm
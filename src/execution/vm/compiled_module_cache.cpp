@@ -0,0 +1,324 @@
+#include "execution/vm/compiled_module_cache.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "llvm/Config/llvm-config.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include "execution/ast/type.h"
+#include "execution/util/cpu_info.h"
+#include "execution/vm/bytecode_module.h"
+#include "loggers/execution_logger.h"
+
+namespace terrier::execution::vm {
+
+namespace {
+
+// Bumped whenever the fingerprint or the file format changes
+constexpr const uint32_t K_FORMAT_VERSION = 1;
+
+// The first bytes of every cache file
+constexpr const uint64_t K_FILE_MAGIC = 0x45484341434c5054ull;  // "TPLCACHE"
+
+constexpr const char K_FILE_EXTENSION[] = ".tplcache";
+
+template <typename T>
+void AppendValue(std::string *out, const T &val) {
+  out->append(reinterpret_cast<const char *>(&val), sizeof(T));
+}
+
+void AppendString(std::string *out, const std::string &str) {
+  AppendValue(out, static_cast<uint64_t>(str.size()));
+  out->append(str);
+}
+
+// The hash of the bitcode file of the bytecode handlers. Every module is compiled against it, so a new build of the
+// handlers must not reuse old code. The files don't change while the process runs, so each is only read once.
+hash_t BytecodeHandlersHash(const std::string &path) {
+  static std::mutex mutex;
+  static std::unordered_map<std::string, hash_t> hashes;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  if (auto iter = hashes.find(path); iter != hashes.end()) {
+    return iter->second;
+  }
+  hash_t handlers_hash = 0;
+  if (auto file = llvm::MemoryBuffer::getFile(path)) {
+    handlers_hash = util::Hasher::Hash<util::HashMethod::xxHash3>(
+        reinterpret_cast<const uint8_t *>((*file)->getBufferStart()), static_cast<uint32_t>((*file)->getBufferSize()));
+  }
+  hashes.emplace(path, handlers_hash);
+  return handlers_hash;
+}
+
+bool IsCacheFile(const std::string &path) { return llvm::sys::path::extension(path) == K_FILE_EXTENSION; }
+
+}  // namespace
+
+CompiledModuleCache::CompiledModuleCache(const uint64_t max_memory, std::string disk_dir,
+                                         const uint32_t max_disk_entries)
+    : max_memory_(max_memory),
+      disk_dir_(std::move(disk_dir)),
+      max_disk_entries_(max_disk_entries),
+      memory_usage_(0),
+      num_hits_(0),
+      num_disk_hits_(0),
+      num_misses_(0),
+      num_evictions_(0) {
+  if (!disk_dir_.empty()) {
+    if (std::error_code error = llvm::sys::fs::create_directories(disk_dir_)) {
+      EXECUTION_LOG_ERROR("CompiledModuleCache: Could not create directory '{}': {}", disk_dir_, error.message());
+    }
+  }
+}
+
+CompiledModuleCache *CompiledModuleCache::Instance() {
+  static CompiledModuleCache instance = []() {
+    const char *dir = std::getenv("TERRIER_CODE_CACHE_DIR");
+    return CompiledModuleCache(K_DEFAULT_MAX_MEMORY, dir != nullptr ? dir : "");
+  }();
+  return &instance;
+}
+
+std::string CompiledModuleCache::Fingerprint(const BytecodeModule &module, const LLVMEngine::CompilerOptions &options) {
+  std::string fingerprint;
+  fingerprint.reserve(module.Code().size() + module.StaticData().size() + 1024);
+
+  // What the code is generated for and with
+  AppendValue(&fingerprint, K_FORMAT_VERSION);
+  AppendValue(&fingerprint, static_cast<uint32_t>(LLVM_VERSION_MAJOR));
+  AppendValue(&fingerprint, static_cast<uint32_t>(LLVM_VERSION_MINOR));
+  AppendValue(&fingerprint, static_cast<uint32_t>(LLVM_VERSION_PATCH));
+  for (const auto feature : {CpuInfo::SSE_4_2, CpuInfo::AVX, CpuInfo::AVX2, CpuInfo::AVX512}) {
+    AppendValue(&fingerprint, CpuInfo::Instance()->HasFeature(feature));
+  }
+  AppendValue(&fingerprint, options.IsDebug());
+  AppendValue(&fingerprint, static_cast<uint8_t>(options.GetOptimizationLevel()));
+  AppendValue(&fingerprint, BytecodeHandlersHash(options.GetBytecodeHandlersBcPath()));
+
+  // The functions compiled, if not all of them
+  AppendValue(&fingerprint, static_cast<uint64_t>(options.GetFunctions().size()));
+  for (const auto func_id : options.GetFunctions()) {
+    AppendValue(&fingerprint, func_id);
+  }
+
+  // The functions, their frames and the types of everything in them. The module's name isn't part of the code.
+  AppendValue(&fingerprint, static_cast<uint64_t>(module.NumFunctions()));
+  for (const auto &func : module.Functions()) {
+    AppendString(&fingerprint, func.Name());
+    AppendValue(&fingerprint, static_cast<uint64_t>(func.BytecodeRange().first));
+    AppendValue(&fingerprint, static_cast<uint64_t>(func.BytecodeRange().second));
+    AppendString(&fingerprint, func.FuncType() != nullptr ? ast::Type::ToString(func.FuncType()) : "");
+    AppendValue(&fingerprint, static_cast<uint64_t>(func.Locals().size()));
+    for (const auto &local : func.Locals()) {
+      AppendValue(&fingerprint, local.Offset());
+      AppendValue(&fingerprint, local.Size());
+      AppendValue(&fingerprint, local.IsParameter());
+      AppendString(&fingerprint, local.GetType() != nullptr ? ast::Type::ToString(local.GetType()) : "");
+    }
+  }
+
+  // The bytecode itself
+  AppendValue(&fingerprint, static_cast<uint64_t>(module.Code().size()));
+  fingerprint.append(reinterpret_cast<const char *>(module.Code().data()), module.Code().size());
+
+  // And the constants it refers to. Literals are kept there rather than as addresses in the code, so equal modules
+  // compiled for different queries get the same fingerprint.
+  AppendValue(&fingerprint, static_cast<uint64_t>(module.StaticData().size()));
+  fingerprint.append(reinterpret_cast<const char *>(module.StaticData().data()), module.StaticData().size());
+
+  return fingerprint;
+}
+
+hash_t CompiledModuleCache::Key(const std::string &fingerprint) {
+  return util::Hasher::Hash<util::HashMethod::xxHash3>(fingerprint);
+}
+
+std::unique_ptr<llvm::MemoryBuffer> CompiledModuleCache::Lookup(const std::string &fingerprint) {
+  const hash_t key = Key(fingerprint);
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (auto iter = index_.find(key); iter != index_.end() && iter->second->fingerprint == fingerprint) {
+      // Move the entry to the front of the LRU list
+      entries_.splice(entries_.begin(), entries_, iter->second);
+      num_hits_.fetch_add(1, std::memory_order_relaxed);
+      return llvm::MemoryBuffer::getMemBufferCopy(iter->second->object_code);
+    }
+  }
+
+  std::string object_code;
+  if (!disk_dir_.empty() && ReadFromDisk(key, fingerprint, &object_code)) {
+    num_disk_hits_.fetch_add(1, std::memory_order_relaxed);
+    auto result = llvm::MemoryBuffer::getMemBufferCopy(object_code);
+    std::lock_guard<std::mutex> lock(mutex_);
+    InsertInMemory(key, fingerprint, std::move(object_code));
+    return result;
+  }
+
+  num_misses_.fetch_add(1, std::memory_order_relaxed);
+  return nullptr;
+}
+
+void CompiledModuleCache::Insert(const std::string &fingerprint, const llvm::MemoryBuffer &object_code) {
+  const hash_t key = Key(fingerprint);
+  std::string code(object_code.getBufferStart(), object_code.getBufferSize());
+
+  if (!disk_dir_.empty()) {
+    WriteToDisk(key, fingerprint, code);
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  InsertInMemory(key, fingerprint, std::move(code));
+}
+
+void CompiledModuleCache::Clear() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+    index_.clear();
+    memory_usage_ = 0;
+  }
+
+  if (disk_dir_.empty()) {
+    return;
+  }
+  std::error_code error;
+  for (llvm::sys::fs::directory_iterator iter(disk_dir_, error), end; iter != end && !error; iter.increment(error)) {
+    if (IsCacheFile(iter->path())) {
+      llvm::sys::fs::remove(iter->path());
+    }
+  }
+}
+
+uint32_t CompiledModuleCache::NumEntries() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return static_cast<uint32_t>(entries_.size());
+}
+
+uint64_t CompiledModuleCache::MemoryUsage() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return memory_usage_;
+}
+
+void CompiledModuleCache::InsertInMemory(const hash_t key, const std::string &fingerprint, std::string object_code) {
+  if (auto iter = index_.find(key); iter != index_.end()) {
+    RemoveFromMemory(iter->second);
+  }
+
+  // Code too large to ever fit isn't kept, and doesn't push out everything else
+  const uint64_t size = fingerprint.size() + object_code.size();
+  if (size > max_memory_) {
+    return;
+  }
+
+  while (memory_usage_ + size > max_memory_) {
+    RemoveFromMemory(std::prev(entries_.end()));
+    num_evictions_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  entries_.push_front(Entry{fingerprint, std::move(object_code)});
+  index_[key] = entries_.begin();
+  memory_usage_ += size;
+}
+
+void CompiledModuleCache::RemoveFromMemory(const std::list<Entry>::iterator iter) {
+  memory_usage_ -= iter->fingerprint.size() + iter->object_code.size();
+  index_.erase(Key(iter->fingerprint));
+  entries_.erase(iter);
+}
+
+std::string CompiledModuleCache::DiskPath(const hash_t key) const {
+  char name[32];
+  std::snprintf(name, sizeof(name), "%016" PRIx64 "%s", key, K_FILE_EXTENSION);
+  llvm::SmallString<128> path(disk_dir_);
+  llvm::sys::path::append(path, name);
+  return path.str().str();
+}
+
+bool CompiledModuleCache::ReadFromDisk(const hash_t key, const std::string &fingerprint,
+                                       std::string *object_code) const {
+  auto file = llvm::MemoryBuffer::getFile(DiskPath(key));
+  if (!file) {
+    return false;
+  }
+
+  // Check the header and the whole fingerprint, in case of a collision or a file from an older version
+  const llvm::StringRef contents = (*file)->getBuffer();
+  const std::size_t header_size = sizeof(K_FILE_MAGIC) + sizeof(uint64_t);
+  if (contents.size() < header_size + fingerprint.size()) {
+    return false;
+  }
+  uint64_t magic, fingerprint_size;
+  std::memcpy(&magic, contents.data(), sizeof(magic));
+  std::memcpy(&fingerprint_size, contents.data() + sizeof(magic), sizeof(fingerprint_size));
+  if (magic != K_FILE_MAGIC || fingerprint_size != fingerprint.size() ||
+      contents.substr(header_size, fingerprint.size()) != fingerprint) {
+    return false;
+  }
+
+  *object_code = contents.substr(header_size + fingerprint.size()).str();
+  return true;
+}
+
+void CompiledModuleCache::WriteToDisk(const hash_t key, const std::string &fingerprint,
+                                      const std::string &object_code) const {
+  // Write to a temporary file first and rename it, so that readers never see a partial file
+  llvm::SmallString<128> temp_path;
+  int fd;
+  if (std::error_code error =
+          llvm::sys::fs::createUniqueFile(llvm::Twine(disk_dir_) + "/tplcache-%%%%%%%%.tmp", fd, temp_path)) {
+    EXECUTION_LOG_ERROR("CompiledModuleCache: Could not create file in '{}': {}", disk_dir_, error.message());
+    return;
+  }
+  {
+    std::string header;
+    AppendValue(&header, K_FILE_MAGIC);
+    AppendString(&header, fingerprint);
+    llvm::raw_fd_ostream out(fd, true);
+    out << header << object_code;
+    out.close();
+    if (out.has_error()) {
+      EXECUTION_LOG_ERROR("CompiledModuleCache: Could not write file '{}'", temp_path.str().str());
+      out.clear_error();
+      llvm::sys::fs::remove(temp_path);
+      return;
+    }
+  }
+  if (std::error_code error = llvm::sys::fs::rename(temp_path, DiskPath(key))) {
+    EXECUTION_LOG_ERROR("CompiledModuleCache: Could not rename file '{}': {}", temp_path.str().str(), error.message());
+    llvm::sys::fs::remove(temp_path);
+    return;
+  }
+
+  // Remove the oldest files beyond the limit
+  std::vector<std::pair<llvm::sys::TimePoint<>, std::string>> files;
+  std::error_code error;
+  for (llvm::sys::fs::directory_iterator iter(disk_dir_, error), end; iter != end && !error; iter.increment(error)) {
+    llvm::sys::fs::file_status status;
+    if (IsCacheFile(iter->path()) && !llvm::sys::fs::status(iter->path(), status)) {
+      files.emplace_back(status.getLastModificationTime(), iter->path());
+    }
+  }
+  if (files.size() <= max_disk_entries_) {
+    return;
+  }
+  const auto num_removed = files.size() - max_disk_entries_;
+  std::partial_sort(files.begin(), files.begin() + num_removed, files.end());
+  for (std::size_t i = 0; i < num_removed; i++) {
+    llvm::sys::fs::remove(files[i].second);
+  }
+}
+
+}  // namespace terrier::execution::vm
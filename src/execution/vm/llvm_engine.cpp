@@ -1,16 +1,23 @@
 #include "execution/vm/llvm_engine.h"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <map>
 #include <memory>
 #include <string>
+#include <thread>  // NOLINT
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
 #include "llvm/ADT/StringMap.h"
 #include "llvm/Analysis/TargetLibraryInfo.h"
 #include "llvm/Analysis/TargetTransformInfo.h"
+#include "llvm/BinaryFormat/Magic.h"
 #include "llvm/Bitcode/BitcodeReader.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
 #include "llvm/ExecutionEngine/RuntimeDyld.h"
 #include "llvm/ExecutionEngine/SectionMemoryManager.h"
 #include "llvm/IR/IRBuilder.h"
@@ -18,6 +25,7 @@
 #include "llvm/IR/LegacyPassManager.h"
 #include "llvm/IR/Verifier.h"
 #include "llvm/MC/MCContext.h"
+#include "llvm/Object/Archive.h"
 #include "llvm/Support/DynamicLibrary.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/SmallVectorMemoryBuffer.h"
@@ -27,11 +35,15 @@
 #include "llvm/Transforms/IPO.h"
 #include "llvm/Transforms/IPO/AlwaysInliner.h"
 #include "llvm/Transforms/IPO/PassManagerBuilder.h"
+#include "llvm/Transforms/InstCombine/InstCombine.h"
 #include "llvm/Transforms/Scalar.h"
+#include "llvm/Transforms/Utils/Cloning.h"
 
 #include "execution/ast/type.h"
+#include "execution/exec/query_scheduler.h"
 #include "execution/vm/bytecode_module.h"
 #include "execution/vm/bytecode_traits.h"
+#include "execution/vm/compiled_module_cache.h"
 #include "loggers/execution_logger.h"
 
 extern void *__dso_handle __attribute__((__visibility__("hidden")));  // NOLINT
@@ -50,6 +62,183 @@ bool FunctionHasDirectReturn(const ast::FunctionType *func_type) {
   return (!ret_type->IsNilType() && ret_type->Size() <= sizeof(int64_t));
 }
 
+// The number of times the instructions of a loop are assumed to run per level of nesting, when the plan doesn't
+// estimate how many tuples the query processes
+constexpr const double K_DEFAULT_LOOP_TRIP_COUNT = 1000.0;
+
+// The deepest nesting of loops that adds to the work of an instruction
+constexpr const uint32_t K_MAX_LOOP_DEPTH = 3;
+
+// The approximate time, in nanoseconds, compiling a bytecode instruction takes at each optimization level
+constexpr const double K_COMPILE_NS_PER_INSTRUCTION[] = {5000.0, 15000.0, 40000.0};
+
+// The approximate time, in nanoseconds, running a bytecode instruction compiled at each optimization level takes
+constexpr const double K_RUN_NS_PER_INSTRUCTION[] = {3.0, 1.0, 0.6};
+
+// The fewest instructions of TPL functions worth optimizing and generating code for on a thread of their own
+constexpr const uint64_t K_MIN_INSTRUCTIONS_PER_PARTITION = 2000;
+
+// Create a target machine for the host, generating code at the given optimization level. Generating code isn't
+// thread-safe, so each thread needs its own.
+std::unique_ptr<llvm::TargetMachine> CreateHostTargetMachine(const LLVMEngine::OptimizationLevel opt_level) {
+  const std::string target_triple = llvm::sys::getProcessTriple();
+
+  std::string error;
+  auto *target = llvm::TargetRegistry::lookupTarget(target_triple, error);
+  if (target == nullptr) {
+    EXECUTION_LOG_ERROR("LLVM: Unable to find target with target_triple {}", target_triple);
+    return nullptr;
+  }
+
+  // Collect CPU features
+  llvm::StringMap<bool> feature_map;
+  if (bool success = llvm::sys::getHostCPUFeatures(feature_map); !success) {
+    EXECUTION_LOG_ERROR("LLVM: Unable to find all CPU features");
+    return nullptr;
+  }
+
+  llvm::SubtargetFeatures target_features;
+  for (const auto &entry : feature_map) {
+    target_features.AddFeature(entry.getKey(), entry.getValue());
+  }
+
+  EXECUTION_LOG_TRACE("LLVM: Discovered CPU features: {}", target_features.getString());
+
+  // At the fastest level, instructions are selected in a single pass over each block, without the DAG
+  llvm::CodeGenOpt::Level codegen_opt_level = llvm::CodeGenOpt::Default;
+  llvm::TargetOptions target_options;
+  switch (opt_level) {
+    case LLVMEngine::OptimizationLevel::Fast:
+      codegen_opt_level = llvm::CodeGenOpt::None;
+      target_options.EnableFastISel = true;
+      break;
+    case LLVMEngine::OptimizationLevel::Light:
+      codegen_opt_level = llvm::CodeGenOpt::Less;
+      break;
+    case LLVMEngine::OptimizationLevel::Full:
+      break;
+  }
+
+  // Both relocation=PIC or JIT=true work. Use the latter for now.
+  llvm::Optional<llvm::Reloc::Model> reloc;
+  return std::unique_ptr<llvm::TargetMachine>(
+      target->createTargetMachine(target_triple, llvm::sys::getHostCPUName(), target_features.getString(),
+                                  target_options, reloc, {}, codegen_opt_level, true));
+}
+
+// Run the optimization passes of the given level over the given LLVM module, holding the code of the given TPL module
+void OptimizeModule(llvm::Module *module, llvm::TargetMachine *target_machine, const BytecodeModule &tpl_module,
+                    const LLVMEngine::OptimizationLevel opt_level) {
+  // The bytecode handlers are already inlined, which is all the fastest level does
+  if (opt_level == LLVMEngine::OptimizationLevel::Fast) {
+    return;
+  }
+
+  //
+  // The function optimization passes ...
+  //
+
+  llvm::legacy::FunctionPassManager function_pm(module);
+  function_pm.add(llvm::createTargetTransformInfoWrapperPass(target_machine->getTargetIRAnalysis()));
+
+  //
+  // The module-level optimization passes ...
+  //
+
+  llvm::legacy::PassManager module_pm;
+  module_pm.add(llvm::createTargetTransformInfoWrapperPass(target_machine->getTargetIRAnalysis()));
+
+  if (opt_level == LLVMEngine::OptimizationLevel::Light) {
+    //
+    // The light level promotes the handlers' locals to registers, and removes
+    // the redundant loads, stores and branches left over from inlining them.
+    // Each function is optimized on its own, and no module-level passes run.
+    //
+
+    function_pm.add(llvm::createSROAPass());
+    function_pm.add(llvm::createEarlyCSEPass());
+    function_pm.add(llvm::createInstructionCombiningPass());
+    function_pm.add(llvm::createCFGSimplificationPass());
+    function_pm.add(llvm::createAggressiveDCEPass());
+  } else {
+    //
+    // The optimization passes we use are somewhat ad-hoc, but were found to
+    // provide a nice balance of performance and compilation times. We use an
+    // aggressive function inlining pass followed by a CFG simplification pass
+    // that should clean up work done during earlier inlining and DCE work.
+    //
+
+    llvm::PassManagerBuilder pm_builder;
+    pm_builder.Inliner = llvm::createFunctionInliningPass(3, 0, false);
+
+    function_pm.add(llvm::createCFGSimplificationPass());
+    function_pm.add(llvm::createAggressiveDCEPass());
+    function_pm.add(llvm::createCFGSimplificationPass());
+
+    pm_builder.populateFunctionPassManager(function_pm);
+    pm_builder.populateModulePassManager(module_pm);
+  }
+
+  //
+  // First, run the function-level optimizations on the TPL functions defined in the module
+  //
+
+  function_pm.doInitialization();
+  for (const auto &func_info : tpl_module.Functions()) {
+    if (auto *func = module->getFunction(func_info.Name()); func != nullptr && !func->isDeclaration()) {
+      function_pm.run(*func);
+    }
+  }
+  function_pm.doFinalization();
+
+  //
+  // Now, run the module-level optimizations
+  //
+
+  module_pm.run(*module);
+}
+
+// Generate an in-memory object file from the given LLVM module
+std::unique_ptr<llvm::MemoryBuffer> EmitObjectCode(llvm::Module *module, llvm::TargetMachine *target_machine) {
+  // Buffer holding the machine code. The returned buffer will take ownership of
+  // this one when we return
+  llvm::SmallString<4096> obj_buffer;
+
+  // The pass manager we insert the EmitMC pass into
+  llvm::legacy::PassManager pass_manager;
+  pass_manager.add(new llvm::TargetLibraryInfoWrapperPass(target_machine->getTargetTriple()));
+  pass_manager.add(llvm::createTargetTransformInfoWrapperPass(target_machine->getTargetIRAnalysis()));
+
+  llvm::MCContext *mc_ctx;
+  llvm::raw_svector_ostream obj_buffer_stream(obj_buffer);
+  if (target_machine->addPassesToEmitMC(pass_manager, mc_ctx, obj_buffer_stream)) {
+    EXECUTION_LOG_ERROR("The target LLVM machine cannot emit a file of this type");
+    return nullptr;
+  }
+
+  // Generate code
+  pass_manager.run(*module);
+
+  return std::make_unique<llvm::SmallVectorMemoryBuffer>(std::move(obj_buffer));
+}
+
+// Pack the object files of the partitions of a module into a single buffer, a Unix archive holding all of them. The
+// archive has no symbol table: it is never linked statically, its members are loaded one by one.
+std::unique_ptr<llvm::MemoryBuffer> PackObjectCode(const std::vector<std::unique_ptr<llvm::MemoryBuffer>> &objects) {
+  std::string archive = "!<arch>\n";
+  for (uint32_t i = 0; i < objects.size(); i++) {
+    // The member's name, modification time, owner, group, mode and size, space-padded to fixed widths
+    const llvm::StringRef object = objects[i]->getBuffer();
+    archive += fmt::format("{:<16}{:<12}{:<6}{:<6}{:<8}{:<10}`\n", fmt::format("part{}.o/", i), 0, 0, 0, 644,
+                           object.size());
+    archive.append(object.data(), object.size());
+    if (object.size() % 2 != 0) {
+      archive += '\n';
+    }
+  }
+  return llvm::MemoryBuffer::getMemBufferCopy(archive);
+}
+
 }  // namespace
 
 // ---------------------------------------------------------
@@ -58,6 +247,10 @@ bool FunctionHasDirectReturn(const ast::FunctionType *func_type) {
 
 class LLVMEngine::TPLMemoryManager : public llvm::SectionMemoryManager {
  public:
+  void AddSymbol(const std::string &name, void *address) {
+    symbols_[name] = llvm::JITEvaluatedSymbol(reinterpret_cast<uint64_t>(address), llvm::JITSymbolFlags::Exported);
+  }
+
   llvm::JITSymbol findSymbol(const std::string &name) override {
     EXECUTION_LOG_INFO("Resolving symbol '{}' ...", name);
 
@@ -321,6 +514,10 @@ LLVMEngine::FunctionLocalsMap::FunctionLocalsMap(const FunctionInfo &func_info,
 
   for (; local_idx < func_info.Locals().size(); local_idx++) {
     const LocalInfo &local_info = func_locals[local_idx];
+    // Locals of the same type may share a slot in the frame
+    if (locals_.count(local_info.Offset()) != 0) {
+      continue;
+    }
     llvm::Type *llvm_type = type_map->GetLLVMType(local_info.GetType());
     llvm::Value *val = ir_builder->CreateAlloca(llvm_type);
     locals_[local_info.Offset()] = val;
@@ -381,6 +578,17 @@ class LLVMEngine::CompiledModuleBuilder {
   // Perform finalization logic and create a compiled module
   std::unique_ptr<CompiledModule> Finalize();
 
+  // The number of partitions to split the module into, to optimize them and
+  // generate their code in parallel. One if the module is too small for it to
+  // pay off.
+  uint32_t NumPartitions() const;
+
+  // Split the module into the given number of partitions, optimize each and
+  // generate its code on a thread of its own, and create a compiled module
+  // holding the code of all partitions. This replaces Optimize() and
+  // Finalize(). Returns null if any partition couldn't be compiled.
+  std::unique_ptr<CompiledModule> OptimizeAndFinalizeInParallel(uint32_t num_partitions);
+
   // Print the contents of the module to a string and return it
   std::string DumpModuleIR();
 
@@ -404,6 +612,10 @@ class LLVMEngine::CompiledModuleBuilder {
   // Write the given object to the file system
   void PersistObjectToFile(const llvm::MemoryBuffer &obj_buffer);
 
+  // Split the module by function into the given number of partitions, and
+  // return the bitcode of each
+  std::vector<std::string> SplitModule(uint32_t num_partitions);
+
   // -----------------------------------------------------
   // Accessors
   // -----------------------------------------------------
@@ -429,6 +641,7 @@ class LLVMEngine::CompiledModuleBuilder {
   std::unique_ptr<llvm::LLVMContext> context_;
   std::unique_ptr<llvm::Module> llvm_module_;
   std::unique_ptr<TypeMap> type_map_;
+  llvm::GlobalVariable *static_data_{nullptr};
 };
 
 // ---------------------------------------------------------
@@ -453,36 +666,9 @@ LLVMEngine::CompiledModuleBuilder::CompiledModuleBuilder(const CompilerOptions &
   // TODO(pmenon): Alter the flags as need be
   //
 
-  const std::string target_triple = llvm::sys::getProcessTriple();
-
-  {
-    std::string error;
-    auto *target = llvm::TargetRegistry::lookupTarget(target_triple, error);
-    if (target == nullptr) {
-      EXECUTION_LOG_ERROR("LLVM: Unable to find target with target_triple {}", target_triple);
-      return;
-    }
-
-    // Collect CPU features
-    llvm::StringMap<bool> feature_map;
-    if (bool success = llvm::sys::getHostCPUFeatures(feature_map); !success) {
-      EXECUTION_LOG_ERROR("LLVM: Unable to find all CPU features");
-      return;
-    }
-
-    llvm::SubtargetFeatures target_features;
-    for (const auto &entry : feature_map) {
-      target_features.AddFeature(entry.getKey(), entry.getValue());
-    }
-
-    EXECUTION_LOG_TRACE("LLVM: Discovered CPU features: {}", target_features.getString());
-
-    // Both relocation=PIC or JIT=true work. Use the latter for now.
-    llvm::TargetOptions target_options;
-    llvm::Optional<llvm::Reloc::Model> reloc;
-    target_machine_.reset(target->createTargetMachine(
-        target_triple, llvm::sys::getHostCPUName(), target_features.getString(), target_options, reloc, {}, {}, true));
-    TERRIER_ASSERT(target_machine_ != nullptr, "LLVM: Unable to find a suitable target machine!");
+  target_machine_ = CreateHostTargetMachine(options.GetOptimizationLevel());
+  if (target_machine_ == nullptr) {
+    return;
   }
 
   //
@@ -509,7 +695,7 @@ LLVMEngine::CompiledModuleBuilder::CompiledModuleBuilder(const CompilerOptions &
     llvm_module_->setModuleIdentifier(tpl_module.Name());
     llvm_module_->setSourceFileName(tpl_module.Name() + ".tpl");
     llvm_module_->setDataLayout(target_machine_->createDataLayout());
-    llvm_module_->setTargetTriple(target_triple);
+    llvm_module_->setTargetTriple(target_machine_->getTargetTriple().str());
   }
 
   type_map_ = std::make_unique<TypeMap>(llvm_module_.get());
@@ -559,8 +745,9 @@ void LLVMEngine::CompiledModuleBuilder::BuildSimpleCFG(const FunctionInfo &func_
       if (Bytecodes::IsTerminal(bytecode)) {
         if (Bytecodes::IsJump(bytecode)) {
           // Unconditional Jump
-          std::size_t branch_target_pos =
-              iter.GetPosition() + Bytecodes::GetNthOperandOffset(bytecode, 0) + iter.GetJumpOffsetOperand(0);
+          const uint32_t offset_idx = Bytecodes::GetJumpOffsetOperandIndex(bytecode);
+          std::size_t branch_target_pos = iter.GetPosition() + Bytecodes::GetNthOperandOffset(bytecode, offset_idx) +
+                                          iter.GetJumpOffsetOperand(offset_idx);
 
           if (blocks->find(branch_target_pos) == blocks->end()) {
             (*blocks)[branch_target_pos] = nullptr;
@@ -580,8 +767,9 @@ void LLVMEngine::CompiledModuleBuilder::BuildSimpleCFG(const FunctionInfo &func_
           (*blocks)[fallthrough_pos] = nullptr;
         }
 
-        std::size_t branch_target_pos =
-            iter.GetPosition() + Bytecodes::GetNthOperandOffset(bytecode, 1) + iter.GetJumpOffsetOperand(1);
+        const uint32_t offset_idx = Bytecodes::GetJumpOffsetOperandIndex(bytecode);
+        std::size_t branch_target_pos = iter.GetPosition() + Bytecodes::GetNthOperandOffset(bytecode, offset_idx) +
+                                        iter.GetJumpOffsetOperand(offset_idx);
 
         if (blocks->find(branch_target_pos) == blocks->end()) {
           bb_begin_positions.push_back(branch_target_pos);
@@ -711,6 +899,12 @@ void LLVMEngine::CompiledModuleBuilder::DefineFunction(const FunctionInfo &func_
           }
           break;
         }
+        case OperandType::StaticLocal: {
+          TERRIER_ASSERT(static_data_ != nullptr, "Module has no static data");
+          args.push_back(ir_builder->CreateConstInBoundsGEP2_32(static_data_->getValueType(), static_data_, 0,
+                                                                iter.GetStaticLocalOperand(i)));
+          break;
+        }
       }
     }
 
@@ -826,7 +1020,28 @@ void LLVMEngine::CompiledModuleBuilder::DefineFunction(const FunctionInfo &func_
         //
 
         llvm::Function *handler = LookupBytecodeHandler(bytecode);
-        issue_call(handler, args);
+        llvm::Value *result = issue_call(handler, args);
+
+        //
+        // The handlers of superinstructions that end in a conditional jump
+        // return whether the jump is taken. We branch on the result as for
+        // the plain conditional jumps above.
+        //
+
+        if (Bytecodes::IsConditionalJump(bytecode)) {
+          const uint32_t offset_idx = Bytecodes::GetJumpOffsetOperandIndex(bytecode);
+          std::size_t fallthrough_bb_pos = iter.GetPosition() + iter.CurrentBytecodeSize();
+          std::size_t branch_target_bb_pos = iter.GetPosition() + Bytecodes::GetNthOperandOffset(bytecode, offset_idx) +
+                                             iter.GetJumpOffsetOperand(offset_idx);
+          TERRIER_ASSERT(blocks[fallthrough_bb_pos] != nullptr,
+                         "Branch fallthrough does not point to valid basic block");
+          TERRIER_ASSERT(blocks[branch_target_bb_pos] != nullptr, "Branch target does not point to valid basic block");
+
+          if (!result->getType()->isIntegerTy(1)) {
+            result = ir_builder->CreateICmpNE(result, llvm::ConstantInt::get(result->getType(), 0, false));
+          }
+          ir_builder->CreateCondBr(result, blocks[branch_target_bb_pos], blocks[fallthrough_bb_pos]);
+        }
         break;
       }
     }
@@ -853,9 +1068,23 @@ void LLVMEngine::CompiledModuleBuilder::DefineFunctions() {
   // their LLVM equivalents into the current module.
   //
 
+  //
+  // The static data of the module becomes a constant in the module, so code
+  // refers to it by relocations instead of by addresses of this process.
+  //
+
+  if (!TplModule().StaticData().empty()) {
+    auto *data = llvm::ConstantDataArray::get(GetContext(), llvm::makeArrayRef(TplModule().StaticData()));
+    static_data_ = new llvm::GlobalVariable(*Module(), data->getType(), true, llvm::GlobalValue::PrivateLinkage, data,
+                                            "tpl.static_data");
+    static_data_->setUnnamedAddr(llvm::GlobalValue::UnnamedAddr::Global);
+  }
+
   llvm::IRBuilder<> ir_builder(GetContext());
   for (const auto &func_info : TplModule().Functions()) {
-    DefineFunction(func_info, &ir_builder);
+    if (Options().ShouldCompileFunction(func_info.Id())) {
+      DefineFunction(func_info, &ir_builder);
+    }
   }
 }
 
@@ -882,85 +1111,162 @@ void LLVMEngine::CompiledModuleBuilder::Simplify() {
 }
 
 void LLVMEngine::CompiledModuleBuilder::Optimize() {
-  //
-  // The optimization passes we use are somewhat ad-hoc, but were found to
-  // provide a nice balance of performance and compilation times. We use an
-  // aggressive function inlining pass followed by a CFG simplification pass
-  // that should clean up work done during earlier inlining and DCE work.
-  //
+  OptimizeModule(Module(), TargetMachine(), TplModule(), Options().GetOptimizationLevel());
+}
 
-  llvm::PassManagerBuilder pm_builder;
-  pm_builder.Inliner = llvm::createFunctionInliningPass(3, 0, false);
+std::unique_ptr<LLVMEngine::CompiledModule> LLVMEngine::CompiledModuleBuilder::Finalize() {
+  std::unique_ptr<llvm::MemoryBuffer> obj = EmitObject();
 
-  //
-  // The function optimization passes ...
-  //
+  if (Options().ShouldPersistObjectFile()) {
+    PersistObjectToFile(*obj);
+  }
 
-  llvm::legacy::FunctionPassManager function_pm(Module());
-  function_pm.add(llvm::createTargetTransformInfoWrapperPass(TargetMachine()->getTargetIRAnalysis()));
-  function_pm.add(llvm::createCFGSimplificationPass());
-  function_pm.add(llvm::createAggressiveDCEPass());
-  function_pm.add(llvm::createCFGSimplificationPass());
+  return std::make_unique<CompiledModule>(std::move(obj));
+}
 
-  //
-  // The module-level optimization passes ...
-  //
+uint32_t LLVMEngine::CompiledModuleBuilder::NumPartitions() const {
+  // Splitting the module up takes longer than generating code at the fastest level
+  if (Options().GetOptimizationLevel() == OptimizationLevel::Fast) {
+    return 1;
+  }
 
-  llvm::legacy::PassManager module_pm;
-  module_pm.add(llvm::createTargetTransformInfoWrapperPass(TargetMachine()->getTargetIRAnalysis()));
+  uint64_t num_threads = Options().GetCompileThreads();
+  if (num_threads == 0) {
+    num_threads = std::max(1u, std::thread::hardware_concurrency());
+  }
 
-  pm_builder.populateFunctionPassManager(function_pm);
-  pm_builder.populateModulePassManager(module_pm);
+  uint64_t num_funcs = 0, num_instructions = 0;
+  for (const auto &func_info : TplModule().Functions()) {
+    if (auto *func = Module().getFunction(func_info.Name()); func != nullptr && !func->isDeclaration()) {
+      num_funcs++;
+      num_instructions += func->getInstructionCount();
+    }
+  }
+
+  return static_cast<uint32_t>(
+      std::max<uint64_t>(1, std::min({num_threads, num_funcs, num_instructions / K_MIN_INSTRUCTIONS_PER_PARTITION})));
+}
 
+std::vector<std::string> LLVMEngine::CompiledModuleBuilder::SplitModule(const uint32_t num_partitions) {
   //
-  // First, run the function-level optimizations
+  // Each TPL function is defined in exactly one partition. We assign the
+  // largest first, each to the partition with the fewest instructions so far.
   //
 
-  function_pm.doInitialization();
+  std::vector<llvm::Function *> tpl_funcs;
   for (const auto &func_info : TplModule().Functions()) {
-    auto *func = Module()->getFunction(func_info.Name());
-    function_pm.run(*func);
+    if (auto *func = Module()->getFunction(func_info.Name()); func != nullptr && !func->isDeclaration()) {
+      tpl_funcs.push_back(func);
+    }
+  }
+  std::stable_sort(tpl_funcs.begin(), tpl_funcs.end(), [](llvm::Function *a, llvm::Function *b) {
+    return a->getInstructionCount() > b->getInstructionCount();
+  });
+
+  std::unordered_map<const llvm::GlobalValue *, uint32_t> partition_of;
+  std::vector<uint64_t> partition_sizes(num_partitions, 0);
+  for (auto *func : tpl_funcs) {
+    const auto partition = static_cast<uint32_t>(
+        std::min_element(partition_sizes.begin(), partition_sizes.end()) - partition_sizes.begin());
+    partition_of[func] = partition;
+    partition_sizes[partition] += func->getInstructionCount();
   }
-  function_pm.doFinalization();
 
   //
-  // Now, run the module-level optimizations
+  // Everything else left over from the bytecode handlers is defined in the
+  // first partition. The other partitions get a copy of all functions they may
+  // want to inline, but don't emit them. Local definitions are copied into
+  // every partition, except for mutable variables which all partitions must
+  // share. The first partition must also keep the definitions it doesn't use
+  // itself. So, we make both external.
   //
 
-  module_pm.run(*Module());
-}
+  for (auto &global : Module()->global_values()) {
+    if (global.isDeclaration() || partition_of.count(&global) != 0) {
+      continue;
+    }
+    const auto *var = llvm::dyn_cast<llvm::GlobalVariable>(&global);
+    const bool is_mutable_local = var != nullptr && var->hasLocalLinkage() && !var->isConstant();
+    if (is_mutable_local || (!global.hasLocalLinkage() && global.isDiscardableIfUnused())) {
+      global.setLinkage(llvm::GlobalValue::ExternalLinkage);
+      if (!global.hasName()) {
+        global.setName("tpl.shared");
+      }
+    }
+  }
 
-std::unique_ptr<LLVMEngine::CompiledModule> LLVMEngine::CompiledModuleBuilder::Finalize() {
-  std::unique_ptr<llvm::MemoryBuffer> obj = EmitObject();
+  std::vector<std::string> partitions(num_partitions);
+  for (uint32_t partition = 0; partition < num_partitions; partition++) {
+    llvm::ValueToValueMapTy value_map;
+    auto clone = llvm::CloneModule(*Module(), value_map, [&](const llvm::GlobalValue *global) {
+      if (auto iter = partition_of.find(global); iter != partition_of.end()) {
+        return iter->second == partition;
+      }
+      return partition == 0 || global->hasLocalLinkage() || llvm::isa<llvm::Function>(global);
+    });
+
+    if (partition != 0) {
+      for (auto &func : *clone) {
+        if (!func.isDeclaration() && !func.hasLocalLinkage() &&
+            partition_of.count(Module()->getFunction(func.getName())) == 0) {
+          func.setLinkage(llvm::GlobalValue::AvailableExternallyLinkage);
+          func.setComdat(nullptr);
+        }
+      }
+    }
 
-  if (Options().ShouldPersistObjectFile()) {
-    PersistObjectToFile(*obj);
+    llvm::raw_string_ostream stream(partitions[partition]);
+    llvm::WriteBitcodeToFile(*clone, stream);
+    stream.flush();
   }
 
-  return std::make_unique<CompiledModule>(std::move(obj));
+  return partitions;
 }
 
-std::unique_ptr<llvm::MemoryBuffer> LLVMEngine::CompiledModuleBuilder::EmitObject() {
-  // Buffer holding the machine code. The returned buffer will take ownership of
-  // this one when we return
-  llvm::SmallString<4096> obj_buffer;
+std::unique_ptr<LLVMEngine::CompiledModule> LLVMEngine::CompiledModuleBuilder::OptimizeAndFinalizeInParallel(
+    const uint32_t num_partitions) {
+  const std::vector<std::string> partitions = SplitModule(num_partitions);
 
-  // The pass manager we insert the EmitMC pass into
-  llvm::legacy::PassManager pass_manager;
-  pass_manager.add(new llvm::TargetLibraryInfoWrapperPass(TargetMachine()->getTargetTriple()));
-  pass_manager.add(llvm::createTargetTransformInfoWrapperPass(TargetMachine()->getTargetIRAnalysis()));
+  //
+  // An LLVM context may only be used by one thread at a time, so each thread
+  // reads its partition's bitcode into a context of its own.
+  //
 
-  llvm::MCContext *mc_ctx;
-  llvm::raw_svector_ostream obj_buffer_stream(obj_buffer);
-  if (TargetMachine()->addPassesToEmitMC(pass_manager, mc_ctx, obj_buffer_stream)) {
-    EXECUTION_LOG_ERROR("The target LLVM machine cannot emit a file of this type");
+  std::vector<std::unique_ptr<llvm::MemoryBuffer>> objects(num_partitions);
+  const auto compile_partition = [&](const uint64_t partition) {
+    llvm::LLVMContext context;
+    auto module = llvm::parseBitcodeFile(llvm::MemoryBufferRef(partitions[partition], TplModule().Name()), context);
+    if (!module) {
+      EXECUTION_LOG_ERROR("LLVM: Could not read partition {} of module '{}': {}", partition, TplModule().Name(),
+                          llvm::toString(module.takeError()));
+      return;
+    }
+
+    auto target_machine = CreateHostTargetMachine(Options().GetOptimizationLevel());
+    if (target_machine == nullptr) {
+      return;
+    }
+
+    OptimizeModule(module->get(), target_machine.get(), TplModule(), Options().GetOptimizationLevel());
+    objects[partition] = EmitObjectCode(module->get(), target_machine.get());
+  };
+  exec::QueryScheduler::Instance()->ParallelFor(num_partitions, compile_partition, Options().GetCompileThreads());
+
+  if (std::any_of(objects.begin(), objects.end(), [](const auto &object) { return object == nullptr; })) {
     return nullptr;
   }
 
-  // Generate code
-  pass_manager.run(*llvm_module_);
+  std::unique_ptr<llvm::MemoryBuffer> obj = PackObjectCode(objects);
 
-  return std::make_unique<llvm::SmallVectorMemoryBuffer>(std::move(obj_buffer));
+  if (Options().ShouldPersistObjectFile()) {
+    PersistObjectToFile(*obj);
+  }
+
+  return std::make_unique<CompiledModule>(std::move(obj));
+}
+
+std::unique_ptr<llvm::MemoryBuffer> LLVMEngine::CompiledModuleBuilder::EmitObject() {
+  return EmitObjectCode(Module(), TargetMachine());
 }
 
 void LLVMEngine::CompiledModuleBuilder::PersistObjectToFile(const llvm::MemoryBuffer &obj_buffer) {
@@ -1023,6 +1329,12 @@ void *LLVMEngine::CompiledModule::GetFunctionPointer(const std::string &name) co
   return nullptr;
 }
 
+void LLVMEngine::CompiledModule::AddExternalSymbol(const std::string &name, void *address) {
+  memory_manager_->AddSymbol(name, address);
+  // Needed for mac
+  memory_manager_->AddSymbol('_' + name, address);
+}
+
 void LLVMEngine::CompiledModule::Load(const BytecodeModule &module) {
   // If already loaded, do nothing
   if (IsLoaded()) {
@@ -1055,22 +1367,62 @@ void LLVMEngine::CompiledModule::Load(const BytecodeModule &module) {
                       static_cast<double>(GetModuleObjectCodeSizeInBytes()) / 1024.0);
 
   //
-  // We've loaded the object file into an in-memory buffer. We need to convert
-  // it into an object file, load it, and link it into our address space to make
-  // its functions available for execution.
+  // The object code of a module compiled in partitions is an archive of the
+  // object files of all partitions. Otherwise, it's a single object file.
   //
 
-  auto object = llvm::object::ObjectFile::createObjectFile(object_code_->getMemBufferRef());
-  if (auto error = object.takeError()) {
-    EXECUTION_LOG_ERROR("LLVMEngine: Error constructing object file '{}'", llvm::toString(std::move(error)));
-    return;
+  std::vector<llvm::MemoryBufferRef> object_buffers;
+  if (llvm::identify_magic(object_code_->getBuffer()) == llvm::file_magic::archive) {
+    auto archive = llvm::object::Archive::create(object_code_->getMemBufferRef());
+    if (auto error = archive.takeError()) {
+      EXECUTION_LOG_ERROR("LLVMEngine: Error reading object archive '{}'", llvm::toString(std::move(error)));
+      return;
+    }
+    bool has_member_error = false;
+    llvm::Error error = llvm::Error::success();
+    for (const auto &member : archive.get()->children(error)) {
+      auto member_buffer = member.getMemoryBufferRef();
+      if (!member_buffer) {
+        EXECUTION_LOG_ERROR("LLVMEngine: Error reading archive member '{}'",
+                            llvm::toString(member_buffer.takeError()));
+        has_member_error = true;
+        break;
+      }
+      object_buffers.push_back(member_buffer.get());
+    }
+    if (error) {
+      EXECUTION_LOG_ERROR("LLVMEngine: Error reading object archive '{}'", llvm::toString(std::move(error)));
+      return;
+    }
+    if (has_member_error) {
+      return;
+    }
+  } else {
+    object_buffers.push_back(object_code_->getMemBufferRef());
   }
 
+  //
+  // We've loaded the object files into in-memory buffers. We need to convert
+  // them into object files, load them, and link them into our address space to
+  // make their functions available for execution. Symbols defined in one
+  // object are resolved in all others.
+  //
+
   llvm::RuntimeDyld loader(*memory_manager_, *memory_manager_);
-  loader.loadObject(*object.get());
-  if (loader.hasError()) {
-    EXECUTION_LOG_ERROR("LLVMEngine: Error loading object file {}", loader.getErrorString().str());
-    return;
+  std::vector<std::unique_ptr<llvm::object::ObjectFile>> objects;
+  for (const auto &object_buffer : object_buffers) {
+    auto object = llvm::object::ObjectFile::createObjectFile(object_buffer);
+    if (auto error = object.takeError()) {
+      EXECUTION_LOG_ERROR("LLVMEngine: Error constructing object file '{}'", llvm::toString(std::move(error)));
+      return;
+    }
+
+    loader.loadObject(*object.get());
+    if (loader.hasError()) {
+      EXECUTION_LOG_ERROR("LLVMEngine: Error loading object file {}", loader.getErrorString().str());
+      return;
+    }
+    objects.push_back(std::move(object.get()));
   }
   loader.finalizeWithMemoryManagerLocking();
 
@@ -1108,8 +1460,93 @@ void LLVMEngine::Initialize() {
 
 void LLVMEngine::Shutdown() { llvm::llvm_shutdown(); }
 
+LLVMEngine::OptimizationLevel LLVMEngine::ChooseOptimizationLevel(const BytecodeModule &module,
+                                                                   const uint64_t num_tuples) {
+  //
+  // An instruction in a loop runs once per tuple the query processes, or a
+  // fixed number of times per level of nesting if no plan estimates how many.
+  // Loops are recognized by their jumps back to an earlier instruction.
+  //
+
+  double num_instructions = 0, work = 0;
+  for (const auto &func_info : module.Functions()) {
+    std::vector<std::pair<std::size_t, std::size_t>> loops;
+    std::vector<std::size_t> positions;
+    for (auto iter = module.BytecodeForFunction(func_info); !iter.Done(); iter.Advance()) {
+      const Bytecode bytecode = iter.CurrentBytecode();
+      positions.push_back(iter.GetPosition());
+      if (Bytecodes::IsJump(bytecode)) {
+        const uint32_t offset_idx = Bytecodes::GetJumpOffsetOperandIndex(bytecode);
+        if (const int32_t offset = iter.GetJumpOffsetOperand(offset_idx); offset < 0) {
+          const std::size_t target = iter.GetPosition() + Bytecodes::GetNthOperandOffset(bytecode, offset_idx) + offset;
+          loops.emplace_back(target, iter.GetPosition());
+        }
+      }
+    }
+
+    for (const auto pos : positions) {
+      const auto depth = static_cast<uint32_t>(std::count_if(
+          loops.begin(), loops.end(), [&](const auto &loop) { return loop.first <= pos && pos <= loop.second; }));
+      double runs = 1.0;
+      if (depth > 0) {
+        runs = num_tuples != K_UNKNOWN_CARDINALITY
+                   ? static_cast<double>(std::max<uint64_t>(1, num_tuples))
+                   : std::pow(K_DEFAULT_LOOP_TRIP_COUNT, std::min(depth, K_MAX_LOOP_DEPTH));
+      }
+      num_instructions += 1.0;
+      work += runs;
+    }
+  }
+
+  //
+  // Pick the level with the least compile time and run time
+  //
+
+  auto best_level = OptimizationLevel::Fast;
+  double best_time = std::numeric_limits<double>::max();
+  for (const auto level : {OptimizationLevel::Fast, OptimizationLevel::Light, OptimizationLevel::Full}) {
+    const auto idx = static_cast<uint32_t>(level);
+    const double time = num_instructions * K_COMPILE_NS_PER_INSTRUCTION[idx] + work * K_RUN_NS_PER_INSTRUCTION[idx];
+    if (time < best_time) {
+      best_level = level;
+      best_time = time;
+    }
+  }
+
+  EXECUTION_LOG_DEBUG("Compiling module '{}' at level {}: {} instructions, estimated work {}", module.Name(),
+                      static_cast<uint32_t>(best_level), num_instructions, work);
+  return best_level;
+}
+
 std::unique_ptr<LLVMEngine::CompiledModule> LLVMEngine::Compile(const BytecodeModule &module,
                                                                 const CompilerOptions &options) {
+  // Calls to the functions that aren't compiled go to their current implementations
+  const auto load = [&](CompiledModule *compiled_module) {
+    if (!options.GetFunctions().empty()) {
+      for (const auto &func_info : module.Functions()) {
+        if (!options.ShouldCompileFunction(func_info.Id())) {
+          compiled_module->AddExternalSymbol(func_info.Name(), options.ResolveFunction(func_info.Id()));
+        }
+      }
+    }
+    compiled_module->Load(module);
+  };
+
+  // If the module was compiled before, load its code and skip code generation entirely
+  CompiledModuleCache *cache = options.ShouldPersistObjectFile() ? nullptr : options.GetModuleCache();
+  std::string fingerprint;
+  if (cache != nullptr) {
+    fingerprint = CompiledModuleCache::Fingerprint(module, options);
+    if (auto object_code = cache->Lookup(fingerprint)) {
+      auto compiled_module = std::make_unique<CompiledModule>(std::move(object_code));
+      load(compiled_module.get());
+      if (compiled_module->IsLoaded()) {
+        return compiled_module;
+      }
+      EXECUTION_LOG_ERROR("LLVMEngine: Could not load cached code of module '{}', compiling it", module.Name());
+    }
+  }
+
   CompiledModuleBuilder builder(options, module);
 
   builder.DeclareFunctions();
@@ -1120,11 +1557,22 @@ std::unique_ptr<LLVMEngine::CompiledModule> LLVMEngine::Compile(const BytecodeMo
 
   builder.Verify();
 
-  builder.Optimize();
+  // Large modules are optimized and compiled in partitions, in parallel
+  std::unique_ptr<CompiledModule> compiled_module;
+  if (const uint32_t num_partitions = builder.NumPartitions(); num_partitions > 1) {
+    compiled_module = builder.OptimizeAndFinalizeInParallel(num_partitions);
+  }
 
-  auto compiled_module = builder.Finalize();
+  if (compiled_module == nullptr) {
+    builder.Optimize();
+    compiled_module = builder.Finalize();
+  }
+
+  load(compiled_module.get());
 
-  compiled_module->Load(module);
+  if (cache != nullptr && compiled_module->IsLoaded()) {
+    cache->Insert(fingerprint, *compiled_module->GetObjectCode());
+  }
 
   return compiled_module;
 }
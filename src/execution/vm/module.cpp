@@ -1,10 +1,13 @@
 #include "execution/vm/module.h"
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "common/constants.h"
+#include "execution/vm/compiled_module_cache.h"
 #include "tbb/task.h"
 
 #define XBYAK_NO_OP_NAMES
@@ -13,25 +16,27 @@
 namespace terrier::execution::vm {
 
 // ---------------------------------------------------------
-// Async Compile Task
+// Tiered Compile Task
 // ---------------------------------------------------------
 
-// This class encapsulates the ability to asynchronously JIT compile a module.
-class Module::AsyncCompileTask : public tbb::task {
+// This class encapsulates the ability to JIT compile some functions of a
+// module in the background.
+class Module::TieredCompileTask : public tbb::task {
  public:
-  // Construct an asynchronous compilation task to compile the the module
-  explicit AsyncCompileTask(Module *module) : module_(module) {}
+  // Construct a task to compile the given functions of the module
+  TieredCompileTask(Module *module, std::vector<FunctionId> func_ids)
+      : module_(module), func_ids_(std::move(func_ids)) {}
 
   // Execute
   tbb::task *execute() override {
-    // This simply invokes Module::CompileToMachineCode() asynchronously.
-    module_->CompileToMachineCode();
+    module_->CompileFunctions(func_ids_);
     // Done. There's no next task, so return null.
     return nullptr;
   }
 
  private:
   Module *module_;
+  std::vector<FunctionId> func_ids_;
 };
 
 // ---------------------------------------------------------
@@ -44,10 +49,12 @@ Module::Module(std::unique_ptr<BytecodeModule> bytecode_module, std::unique_ptr<
     : bytecode_module_(std::move(bytecode_module)),
       jit_module_(std::move(llvm_module)),
       functions_(std::make_unique<std::atomic<void *>[]>(bytecode_module_->NumFunctions())),
-      bytecode_trampolines_(std::make_unique<Trampoline[]>(bytecode_module_->NumFunctions())) {
+      bytecode_trampolines_(std::make_unique<Trampoline[]>(bytecode_module_->NumFunctions())),
+      tier_state_(std::make_unique<TierState[]>(bytecode_module_->NumFunctions())) {
   // Create the trampolines for all bytecode functions
   for (const auto &func : bytecode_module_->Functions()) {
     CreateFunctionTrampoline(func.Id());
+    tier_state_[func.Id()].simple_ = HasSimpleSignature(func.Id());
   }
 
   // If a compiled module wasn't provided, all internal function stubs point to
@@ -66,6 +73,11 @@ Module::Module(std::unique_ptr<BytecodeModule> bytecode_module, std::unique_ptr<
   }
 }
 
+Module::~Module() {
+  std::unique_lock<std::mutex> lock(tier_mutex_);
+  tier_cv_.wait(lock, [this]() { return num_pending_compiles_ == 0; });
+}
+
 namespace {
 
 // TODO(pmenon): Implement generator for non x86_64 machines
@@ -274,8 +286,11 @@ void Module::CompileToMachineCode() {
       return;
     }
 
-    // JIT
+    // JIT at the level the module's work is worth, reusing the code of an
+    // identical module compiled before
     LLVMEngine::CompilerOptions options;
+    options.SetModuleCache(CompiledModuleCache::Instance());
+    options.SetOptimizationLevel(LLVMEngine::ChooseOptimizationLevel(*bytecode_module_, estimated_cardinality_));
     jit_module_ = LLVMEngine::Compile(*bytecode_module_, options);
 
     // Setup function pointers
@@ -287,9 +302,104 @@ void Module::CompileToMachineCode() {
   });
 }
 
-void Module::CompileToMachineCodeAsync() {
-  auto *compile_task = new (tbb::task::allocate_root()) AsyncCompileTask(this);
+void Module::RecordHotness(const FunctionId func_id, const uint32_t count) const {
+  TierState &state = tier_state_[func_id];
+  if (!tiering_enabled_.load(std::memory_order_relaxed) || state.queued_.load(std::memory_order_relaxed)) {
+    return;
+  }
+
+  // Once a function is queued, it is no longer counted, so that the counter
+  // doesn't bounce between the cores running it
+  const uint32_t hotness = state.hotness_.fetch_add(count, std::memory_order_relaxed) + count;
+  if (hotness < hotness_threshold_ || state.queued_.exchange(true)) {
+    return;
+  }
+
+  std::vector<FunctionId> func_ids = CollectTierGroup(func_id);
+  {
+    std::lock_guard<std::mutex> lock(tier_mutex_);
+    num_pending_compiles_++;
+  }
+  // The compiled code only replaces the function pointers, which are atomic
+  auto *self = const_cast<Module *>(this);
+  auto *compile_task = new (tbb::task::allocate_root()) TieredCompileTask(self, std::move(func_ids));
   tbb::task::enqueue(*compile_task);
 }
 
+bool Module::HasSimpleSignature(const FunctionId func_id) const {
+  const auto is_simple = [](const ast::Type *type) {
+    return type->Size() <= sizeof(int64_t) && (type->IsIntegerType() || type->IsBoolType() || type->IsPointerType());
+  };
+  const ast::FunctionType *func_type = GetFuncInfoById(func_id)->FuncType();
+  const ast::Type *return_type = func_type->ReturnType();
+  if (func_type->NumParams() > K_MAX_SIMPLE_PARAMS || (!return_type->IsNilType() && !is_simple(return_type))) {
+    return false;
+  }
+  return std::all_of(func_type->Params().begin(), func_type->Params().end(),
+                     [&](const ast::Field &param) { return is_simple(param.type_); });
+}
+
+std::vector<FunctionId> Module::CollectTierGroup(const FunctionId func_id) const {
+  //
+  // The hot function is compiled together with the functions it calls, or
+  // refers to, that either haven't been compiled yet and are warm, or that
+  // can't be called through a trampoline. All other functions are called
+  // through their current implementation, interpreted or compiled.
+  //
+
+  std::vector<FunctionId> group{func_id};
+  for (std::size_t idx = 0; idx < group.size(); idx++) {
+    const FunctionInfo *func_info = GetFuncInfoById(group[idx]);
+    for (auto iter = bytecode_module_->BytecodeForFunction(*func_info); !iter.Done(); iter.Advance()) {
+      const Bytecode bytecode = iter.CurrentBytecode();
+      for (uint32_t i = 0; i < Bytecodes::NumOperands(bytecode); i++) {
+        if (Bytecodes::GetNthOperandType(bytecode, i) != OperandType::FunctionId) {
+          continue;
+        }
+        const FunctionId callee_id = iter.GetFunctionIdOperand(i);
+        const TierState &callee_state = tier_state_[callee_id];
+        if (std::find(group.begin(), group.end(), callee_id) != group.end() ||
+            callee_state.compiled_.load(std::memory_order_acquire) != nullptr) {
+          continue;
+        }
+        const bool warm = callee_state.hotness_.load(std::memory_order_relaxed) >= hotness_threshold_ / 2 &&
+                          !callee_state.queued_.load(std::memory_order_relaxed);
+        if (warm || !callee_state.simple_) {
+          tier_state_[callee_id].queued_.store(true, std::memory_order_relaxed);
+          group.push_back(callee_id);
+        }
+      }
+    }
+  }
+  return group;
+}
+
+void Module::CompileFunctions(const std::vector<FunctionId> &func_ids) {
+  // Functions only get here once they've proven hot, so they are always
+  // compiled at the highest optimization level
+  LLVMEngine::CompilerOptions options;
+  options.SetModuleCache(CompiledModuleCache::Instance());
+  options.SetFunctions(func_ids, [this](const FunctionId callee_id) {
+    return functions_[callee_id].load(std::memory_order_acquire);
+  });
+  auto compiled_module = LLVMEngine::Compile(*bytecode_module_, options);
+
+  // Swap in the compiled functions one at a time
+  if (compiled_module->IsLoaded()) {
+    for (const auto id : func_ids) {
+      void *compiled = compiled_module->GetFunctionPointer(GetFuncInfoById(id)->Name());
+      TERRIER_ASSERT(compiled != nullptr, "Missing function in compiled module!");
+      functions_[id].store(compiled, std::memory_order_release);
+      tier_state_[id].compiled_.store(compiled, std::memory_order_release);
+    }
+    EXECUTION_LOG_DEBUG("Compiled {} hot function(s), starting with '{}'", func_ids.size(),
+                        GetFuncInfoById(func_ids[0])->Name());
+  }
+
+  std::lock_guard<std::mutex> lock(tier_mutex_);
+  tier_modules_.push_back(std::move(compiled_module));
+  num_pending_compiles_--;
+  tier_cv_.notify_all();
+}
+
 }  // namespace terrier::execution::vm
@@ -1,5 +1,6 @@
 #include "execution/vm/vm.h"
 
+#include <algorithm>
 #include <numeric>
 #include <string>
 #include <vector>
@@ -88,6 +89,10 @@ static constexpr const uint32_t K_MAX_STACK_ALLOC_SIZE = 1ull << 14ull;
 // requires less, use the stack.
 static constexpr const uint32_t K_SOFT_MAX_STACK_ALLOC_SIZE = 1ull << 12ull;
 
+// The number of loop back-edges a function takes between two updates of its
+// hotness in the module. Batching keeps the counter out of the inner loop.
+static constexpr const uint32_t K_BACK_EDGE_BATCH_SIZE = 256;
+
 VM::VM(const Module *module) : module_(module) {}
 
 // static
@@ -95,6 +100,19 @@ void VM::InvokeFunction(const Module *module, const FunctionId func_id, const ui
   // The function's info
   const FunctionInfo *func_info = module->GetFuncInfoById(func_id);
   TERRIER_ASSERT(func_info != nullptr, "Function doesn't exist in module!");
+
+  // If the function has been compiled, run the compiled code instead
+  if (void *compiled = module->GetTieredImpl(func_id); compiled != nullptr) {
+    uint64_t params[Module::K_MAX_SIMPLE_PARAMS + 1] = {0};
+    for (uint32_t i = 0; i < func_info->NumParams(); i++) {
+      const LocalInfo &param_info = func_info->Locals()[i];
+      std::memcpy(&params[i], args + param_info.Offset() - func_info->ParamsStartPos(), param_info.Size());
+    }
+    CallCompiled(*func_info, compiled, params);
+    return;
+  }
+  module->RecordHotness(func_id, 1);
+
   const std::size_t frame_size = func_info->FrameSize();
   // Let's try to get some space
   bool used_heap = false;
@@ -121,7 +139,7 @@ void VM::InvokeFunction(const Module *module, const FunctionId func_id, const ui
   const uint8_t *bytecode = module->GetBytecodeModule()->GetBytecodeForFunction(*func_info);
   TERRIER_ASSERT(bytecode != nullptr, "Bytecode cannot be null");
   Frame frame(raw_frame, frame_size);
-  vm.Interpret(bytecode, &frame);
+  vm.Interpret(bytecode, &frame, func_id);
 
   // Cleanup
   if (used_heap) {
@@ -152,7 +170,7 @@ inline ALWAYS_INLINE T Peek(const uint8_t **ip) {
 }  // namespace
 
 // NOLINTNEXTLINE (google-readability-function-size,readability-function-size)
-void VM::Interpret(const uint8_t *ip, Frame *frame) {
+void VM::Interpret(const uint8_t *ip, Frame *frame, const FunctionId func_id) {
   static void *kDispatchTable[] = {
 #define ENTRY(name, ...) &&op_##name,
       BYTECODE_LIST(ENTRY)
@@ -186,6 +204,7 @@ void VM::Interpret(const uint8_t *ip, Frame *frame) {
 #define READ_LOCAL_ID() Read<uint32_t>(&ip)
 #define READ_OP() Read<std::underlying_type_t<Bytecode>>(&ip)
 #define READ_FUNC_ID() READ_UIMM2()
+#define READ_STATIC_LOCAL() module_->GetBytecodeModule()->AccessStaticData(Read<uint32_t>(&ip))
 
 #define OP(name) op_##name
 #define DISPATCH_NEXT()           \
@@ -221,6 +240,9 @@ void VM::Interpret(const uint8_t *ip, Frame *frame) {
    *
    ****************************************************************************/
 
+  // The loop back-edges taken since the hotness was last updated
+  uint32_t back_edges = 0;
+
   // Jump to the first instruction
   DISPATCH_NEXT();
 
@@ -310,36 +332,92 @@ void VM::Interpret(const uint8_t *ip, Frame *frame) {
   // Jumps
   // -------------------------------------------------------
 
+  // Only loops jump backwards. Their back-edges count towards the hotness of
+  // the function.
+#define TAKE_JUMP(skip)                                                   \
+  do {                                                                    \
+    if ((skip) < 0 && UNLIKELY(++back_edges == K_BACK_EDGE_BATCH_SIZE)) { \
+      module_->RecordHotness(func_id, back_edges);                        \
+      back_edges = 0;                                                     \
+    }                                                                     \
+    ip += (skip);                                                         \
+  } while (false)
+
+  // Take the jump if the condition holds, or skip over its offset otherwise
+#define CONDITIONAL_JUMP(cond)     \
+  do {                             \
+    auto skip = PEEK_JMP_OFFSET(); \
+    if (cond) {                    \
+      TAKE_JUMP(skip);             \
+    } else {                       \
+      READ_JMP_OFFSET();           \
+    }                              \
+    DISPATCH_NEXT();               \
+  } while (false)
+
   OP(Jump) : {
     auto skip = PEEK_JMP_OFFSET();
     if (LIKELY(OpJump())) {
-      ip += skip;
+      TAKE_JUMP(skip);
     }
     DISPATCH_NEXT();
   }
 
   OP(JumpIfTrue) : {
     auto cond = frame->LocalAt<bool>(READ_LOCAL_ID());
-    auto skip = PEEK_JMP_OFFSET();
-    if (OpJumpIfTrue(cond)) {
-      ip += skip;
-    } else {
-      READ_JMP_OFFSET();
-    }
-    DISPATCH_NEXT();
+    CONDITIONAL_JUMP(OpJumpIfTrue(cond));
   }
 
   OP(JumpIfFalse) : {
     auto cond = frame->LocalAt<bool>(READ_LOCAL_ID());
-    auto skip = PEEK_JMP_OFFSET();
-    if (OpJumpIfFalse(cond)) {
-      ip += skip;
-    } else {
-      READ_JMP_OFFSET();
-    }
-    DISPATCH_NEXT();
+    CONDITIONAL_JUMP(OpJumpIfFalse(cond));
   }
 
+  // -------------------------------------------------------
+  // Superinstructions ending in a conditional jump
+  // -------------------------------------------------------
+
+#define DO_GEN_COMPARISON_JUMP(op, type)               \
+  OP(JumpIf##op##_##type) : {                          \
+    auto lhs = frame->LocalAt<type>(READ_LOCAL_ID());  \
+    auto rhs = frame->LocalAt<type>(READ_LOCAL_ID());  \
+    CONDITIONAL_JUMP(OpJumpIf##op##_##type(lhs, rhs)); \
+  }
+#define GEN_COMPARISON_JUMP_TYPES(type, ...)     \
+  DO_GEN_COMPARISON_JUMP(GreaterThan, type)      \
+  DO_GEN_COMPARISON_JUMP(GreaterThanEqual, type) \
+  DO_GEN_COMPARISON_JUMP(Equal, type)            \
+  DO_GEN_COMPARISON_JUMP(LessThan, type)         \
+  DO_GEN_COMPARISON_JUMP(LessThanEqual, type)    \
+  DO_GEN_COMPARISON_JUMP(NotEqual, type)
+
+  INT_TYPES(GEN_COMPARISON_JUMP_TYPES)
+#undef GEN_COMPARISON_JUMP_TYPES
+#undef DO_GEN_COMPARISON_JUMP
+
+  OP(JumpIfTruth) : {
+    auto *sql_bool = frame->LocalAt<sql::BoolVal *>(READ_LOCAL_ID());
+    CONDITIONAL_JUMP(OpJumpIfTruth(sql_bool));
+  }
+
+  OP(JumpIfNotTruth) : {
+    auto *sql_bool = frame->LocalAt<sql::BoolVal *>(READ_LOCAL_ID());
+    CONDITIONAL_JUMP(OpJumpIfNotTruth(sql_bool));
+  }
+
+  OP(PCIAdvanceJumpIfHasNext) : {
+    auto *iter = frame->LocalAt<sql::ProjectedColumnsIterator *>(READ_LOCAL_ID());
+    CONDITIONAL_JUMP(OpPCIAdvanceJumpIfHasNext(iter));
+  }
+
+  OP(PCIAdvanceFilteredJumpIfHasNext) : {
+    auto *iter = frame->LocalAt<sql::ProjectedColumnsIterator *>(READ_LOCAL_ID());
+    CONDITIONAL_JUMP(OpPCIAdvanceFilteredJumpIfHasNext(iter));
+  }
+
+#undef CONDITIONAL_JUMP
+#undef TAKE_JUMP
+
   // -------------------------------------------------------
   // Low-level memory operations
   // -------------------------------------------------------
@@ -526,15 +604,35 @@ void VM::Interpret(const uint8_t *ip, Frame *frame) {
     DISPATCH_NEXT();
   }
 
+  OP(TableVectorIteratorSetTopKThreshold) : {
+    auto *iter = frame->LocalAt<sql::TableVectorIterator *>(READ_LOCAL_ID());
+    auto *threshold = frame->LocalAt<const sql::TopKThreshold *>(READ_LOCAL_ID());
+    auto col_idx = frame->LocalAt<uint32_t>(READ_LOCAL_ID());
+    auto col_type = frame->LocalAt<int32_t>(READ_LOCAL_ID());
+    OpTableVectorIteratorSetTopKThreshold(iter, threshold, col_idx, col_type);
+    DISPATCH_NEXT();
+  }
+
+  OP(TableVectorIteratorAddRuntimeFilter) : {
+    auto *iter = frame->LocalAt<sql::TableVectorIterator *>(READ_LOCAL_ID());
+    auto *join_hash_table = frame->LocalAt<sql::JoinHashTable *>(READ_LOCAL_ID());
+    auto col_idx = frame->LocalAt<uint32_t>(READ_LOCAL_ID());
+    auto col_type = frame->LocalAt<int32_t>(READ_LOCAL_ID());
+    OpTableVectorIteratorAddRuntimeFilter(iter, join_hash_table, col_idx, col_type);
+    DISPATCH_NEXT();
+  }
+
   OP(ParallelScanTable) : {
-    auto db_oid = READ_UIMM4();
+    auto exec_ctx = frame->LocalAt<exec::ExecutionContext *>(READ_LOCAL_ID());
     auto table_oid = READ_UIMM4();
+    auto col_oids = frame->LocalAt<uint32_t *>(READ_LOCAL_ID());
+    auto num_oids = READ_UIMM4();
     auto query_state = frame->LocalAt<void *>(READ_LOCAL_ID());
     auto thread_state_container = frame->LocalAt<sql::ThreadStateContainer *>(READ_LOCAL_ID());
     auto scan_fn_id = READ_FUNC_ID();
 
     auto scan_fn = reinterpret_cast<sql::TableVectorIterator::ScanFn>(module_->GetRawFunctionImpl(scan_fn_id));
-    OpParallelScanTable(db_oid, table_oid, query_state, thread_state_container, scan_fn);
+    OpParallelScanTable(exec_ctx, table_oid, col_oids, num_oids, query_state, thread_state_container, scan_fn);
     DISPATCH_NEXT();
   }
 
@@ -642,6 +740,42 @@ void VM::Interpret(const uint8_t *ip, Frame *frame) {
   GEN_PCI_FILTER(NotEqual)
 #undef GEN_PCI_FILTER
 
+  OP(PCIFilterBetween) : {
+    auto *size = frame->LocalAt<uint64_t *>(READ_LOCAL_ID());
+    auto *iter = frame->LocalAt<sql::ProjectedColumnsIterator *>(READ_LOCAL_ID());
+    auto col_idx = READ_UIMM4();
+    auto type = READ_IMM1();
+    auto lo = READ_IMM8();
+    auto hi = READ_IMM8();
+    OpPCIFilterBetween(size, iter, col_idx, type, lo, hi);
+    DISPATCH_NEXT();
+  }
+
+  OP(PCIFilterIn) : {
+    auto *size = frame->LocalAt<uint64_t *>(READ_LOCAL_ID());
+    auto *iter = frame->LocalAt<sql::ProjectedColumnsIterator *>(READ_LOCAL_ID());
+    auto col_idx = READ_UIMM4();
+    auto type = READ_IMM1();
+    auto *vals = frame->LocalAt<const int64_t *>(READ_LOCAL_ID());
+    auto num_vals = READ_UIMM4();
+    OpPCIFilterIn(size, iter, col_idx, type, vals, num_vals);
+    DISPATCH_NEXT();
+  }
+
+#define GEN_PCI_STRING_FILTER(Op)                                                  \
+  OP(PCIFilterString##Op) : {                                                      \
+    auto *size = frame->LocalAt<uint64_t *>(READ_LOCAL_ID());                      \
+    auto *iter = frame->LocalAt<sql::ProjectedColumnsIterator *>(READ_LOCAL_ID()); \
+    auto col_idx = READ_UIMM4();                                                   \
+    auto *data = READ_STATIC_LOCAL();                                              \
+    auto length = READ_UIMM4();                                                    \
+    OpPCIFilterString##Op(size, iter, col_idx, data, length);                      \
+    DISPATCH_NEXT();                                                               \
+  }
+  GEN_PCI_STRING_FILTER(Eq)
+  GEN_PCI_STRING_FILTER(Prefix)
+#undef GEN_PCI_STRING_FILTER
+
   // ------------------------------------------------------
   // Hashing
   // ------------------------------------------------------
@@ -761,7 +895,7 @@ void VM::Interpret(const uint8_t *ip, Frame *frame) {
   OP(InitString) : {
     auto *sql_string = frame->LocalAt<sql::StringVal *>(READ_LOCAL_ID());
     auto length = static_cast<uint64_t>(READ_IMM8());
-    auto data = static_cast<uintptr_t>(READ_IMM8());
+    auto *data = READ_STATIC_LOCAL();
     OpInitString(sql_string, length, data);
     DISPATCH_NEXT();
   }
@@ -1007,6 +1141,79 @@ void VM::Interpret(const uint8_t *ip, Frame *frame) {
     DISPATCH_NEXT();
   }
 
+  OP(DirectMappedAggregationTableInit) : {
+    auto *table = frame->LocalAt<sql::DirectMappedAggregationTable *>(READ_LOCAL_ID());
+    auto *memory = frame->LocalAt<sql::MemoryPool *>(READ_LOCAL_ID());
+    auto payload_size = frame->LocalAt<uint32_t>(READ_LOCAL_ID());
+    auto min_key = frame->LocalAt<int64_t>(READ_LOCAL_ID());
+    auto max_key = frame->LocalAt<int64_t>(READ_LOCAL_ID());
+    OpDirectMappedAggregationTableInit(table, memory, payload_size, min_key, max_key);
+    DISPATCH_NEXT();
+  }
+
+  OP(DirectMappedAggregationTableInDomain) : {
+    auto *result = frame->LocalAt<bool *>(READ_LOCAL_ID());
+    auto *table = frame->LocalAt<sql::DirectMappedAggregationTable *>(READ_LOCAL_ID());
+    auto *key = frame->LocalAt<sql::Integer *>(READ_LOCAL_ID());
+    OpDirectMappedAggregationTableInDomain(result, table, key);
+    DISPATCH_NEXT();
+  }
+
+  OP(DirectMappedAggregationTableLookup) : {
+    auto *result = frame->LocalAt<byte **>(READ_LOCAL_ID());
+    auto *table = frame->LocalAt<sql::DirectMappedAggregationTable *>(READ_LOCAL_ID());
+    auto *key = frame->LocalAt<sql::Integer *>(READ_LOCAL_ID());
+    OpDirectMappedAggregationTableLookup(result, table, key);
+    DISPATCH_NEXT();
+  }
+
+  OP(DirectMappedAggregationTableInsert) : {
+    auto *result = frame->LocalAt<byte **>(READ_LOCAL_ID());
+    auto *table = frame->LocalAt<sql::DirectMappedAggregationTable *>(READ_LOCAL_ID());
+    auto *key = frame->LocalAt<sql::Integer *>(READ_LOCAL_ID());
+    OpDirectMappedAggregationTableInsert(result, table, key);
+    DISPATCH_NEXT();
+  }
+
+  OP(DirectMappedAggregationTableFree) : {
+    auto *table = frame->LocalAt<sql::DirectMappedAggregationTable *>(READ_LOCAL_ID());
+    OpDirectMappedAggregationTableFree(table);
+    DISPATCH_NEXT();
+  }
+
+  OP(DirectMappedAggregationTableIteratorInit) : {
+    auto *iter = frame->LocalAt<sql::DirectMappedAggregationTableIterator *>(READ_LOCAL_ID());
+    auto *table = frame->LocalAt<sql::DirectMappedAggregationTable *>(READ_LOCAL_ID());
+    OpDirectMappedAggregationTableIteratorInit(iter, table);
+    DISPATCH_NEXT();
+  }
+
+  OP(DirectMappedAggregationTableIteratorHasNext) : {
+    auto *has_more = frame->LocalAt<bool *>(READ_LOCAL_ID());
+    auto *iter = frame->LocalAt<sql::DirectMappedAggregationTableIterator *>(READ_LOCAL_ID());
+    OpDirectMappedAggregationTableIteratorHasNext(has_more, iter);
+    DISPATCH_NEXT();
+  }
+
+  OP(DirectMappedAggregationTableIteratorNext) : {
+    auto *iter = frame->LocalAt<sql::DirectMappedAggregationTableIterator *>(READ_LOCAL_ID());
+    OpDirectMappedAggregationTableIteratorNext(iter);
+    DISPATCH_NEXT();
+  }
+
+  OP(DirectMappedAggregationTableIteratorGetRow) : {
+    auto *row = frame->LocalAt<const byte **>(READ_LOCAL_ID());
+    auto *iter = frame->LocalAt<sql::DirectMappedAggregationTableIterator *>(READ_LOCAL_ID());
+    OpDirectMappedAggregationTableIteratorGetRow(row, iter);
+    DISPATCH_NEXT();
+  }
+
+  OP(DirectMappedAggregationTableIteratorFree) : {
+    auto *iter = frame->LocalAt<sql::DirectMappedAggregationTableIterator *>(READ_LOCAL_ID());
+    OpDirectMappedAggregationTableIteratorFree(iter);
+    DISPATCH_NEXT();
+  }
+
   OP(CountAggregateInit) : {
     auto *agg = frame->LocalAt<sql::CountAggregate *>(READ_LOCAL_ID());
     OpCountAggregateInit(agg);
@@ -1233,6 +1440,12 @@ void VM::Interpret(const uint8_t *ip, Frame *frame) {
     DISPATCH_NEXT();
   }
 
+  OP(JoinHashTableBuildBloomFilter) : {
+    auto *join_hash_table = frame->LocalAt<sql::JoinHashTable *>(READ_LOCAL_ID());
+    OpJoinHashTableBuildBloomFilter(join_hash_table);
+    DISPATCH_NEXT();
+  }
+
   OP(JoinHashTableBuildParallel) : {
     auto *join_hash_table = frame->LocalAt<sql::JoinHashTable *>(READ_LOCAL_ID());
     auto *thread_state_container = frame->LocalAt<sql::ThreadStateContainer *>(READ_LOCAL_ID());
@@ -1247,6 +1460,38 @@ void VM::Interpret(const uint8_t *ip, Frame *frame) {
     DISPATCH_NEXT();
   }
 
+  OP(JoinHashTableEnableSpilling) : {
+    auto *join_hash_table = frame->LocalAt<sql::JoinHashTable *>(READ_LOCAL_ID());
+    OpJoinHashTableEnableSpilling(join_hash_table);
+    DISPATCH_NEXT();
+  }
+
+  OP(JoinHashTableIsSpilled) : {
+    auto *result = frame->LocalAt<bool *>(READ_LOCAL_ID());
+    auto *join_hash_table = frame->LocalAt<sql::JoinHashTable *>(READ_LOCAL_ID());
+    auto hash = frame->LocalAt<hash_t>(READ_LOCAL_ID());
+    OpJoinHashTableIsSpilled(result, join_hash_table, hash);
+    DISPATCH_NEXT();
+  }
+
+  OP(JoinHashTableDeferProbeTuple) : {
+    auto *join_hash_table = frame->LocalAt<sql::JoinHashTable *>(READ_LOCAL_ID());
+    auto hash = frame->LocalAt<hash_t>(READ_LOCAL_ID());
+    auto *probe_tuple = frame->LocalAt<const byte *>(READ_LOCAL_ID());
+    auto probe_tuple_size = frame->LocalAt<uint32_t>(READ_LOCAL_ID());
+    OpJoinHashTableDeferProbeTuple(join_hash_table, hash, probe_tuple, probe_tuple_size);
+    DISPATCH_NEXT();
+  }
+
+  OP(JoinHashTableJoinSpilledPartitions) : {
+    auto *join_hash_table = frame->LocalAt<sql::JoinHashTable *>(READ_LOCAL_ID());
+    auto *ctx = frame->LocalAt<void *>(READ_LOCAL_ID());
+    auto probe_fn_id = READ_FUNC_ID();
+    auto probe_fn = reinterpret_cast<sql::JoinHashTable::SpilledProbeFn>(module_->GetRawFunctionImpl(probe_fn_id));
+    OpJoinHashTableJoinSpilledPartitions(join_hash_table, ctx, probe_fn);
+    DISPATCH_NEXT();
+  }
+
   // -------------------------------------------------------
   // Sorting
   // -------------------------------------------------------
@@ -1313,6 +1558,21 @@ void VM::Interpret(const uint8_t *ip, Frame *frame) {
     DISPATCH_NEXT();
   }
 
+  OP(SorterSetTopKThreshold) : {
+    auto *sorter = frame->LocalAt<sql::Sorter *>(READ_LOCAL_ID());
+    auto *threshold = frame->LocalAt<sql::TopKThreshold *>(READ_LOCAL_ID());
+    auto key_offset = frame->LocalAt<uint32_t>(READ_LOCAL_ID());
+    OpSorterSetTopKThreshold(sorter, threshold, key_offset);
+    DISPATCH_NEXT();
+  }
+
+  OP(TopKThresholdInit) : {
+    auto *threshold = frame->LocalAt<sql::TopKThreshold *>(READ_LOCAL_ID());
+    auto ascending = frame->LocalAt<bool>(READ_LOCAL_ID());
+    OpTopKThresholdInit(threshold, ascending);
+    DISPATCH_NEXT();
+  }
+
   OP(SorterIteratorInit) : {
     auto *iter = frame->LocalAt<sql::SorterIterator *>(READ_LOCAL_ID());
     auto *sorter = frame->LocalAt<sql::Sorter *>(READ_LOCAL_ID());
@@ -1669,6 +1929,19 @@ const uint8_t *VM::ExecuteCall(const uint8_t *ip, VM::Frame *caller) {
   // Lookup the function
   const FunctionInfo *func_info = module_->GetFuncInfoById(func_id);
   TERRIER_ASSERT(func_info != nullptr, "Function doesn't exist in module!");
+
+  // If the function has been compiled, run the compiled code instead
+  if (void *compiled = module_->GetTieredImpl(func_id); compiled != nullptr) {
+    uint64_t params[Module::K_MAX_SIMPLE_PARAMS + 1] = {0};
+    for (uint32_t i = 0; i < num_params; i++) {
+      const void *param = caller->LocalAt<void *>(READ_LOCAL_ID());
+      std::memcpy(&params[i], &param, func_info->Locals()[i].Size());
+    }
+    CallCompiled(*func_info, compiled, params);
+    return ip;
+  }
+  module_->RecordHotness(func_id, 1);
+
   const std::size_t frame_size = func_info->FrameSize();
 
   // Get some space for the function's frame
@@ -1697,7 +1970,7 @@ const uint8_t *VM::ExecuteCall(const uint8_t *ip, VM::Frame *caller) {
   const uint8_t *bytecode = module_->GetBytecodeModule()->GetBytecodeForFunction(*func_info);
   TERRIER_ASSERT(bytecode != nullptr, "Bytecode cannot be null");
   VM::Frame callee(raw_frame, func_info->FrameSize());
-  Interpret(bytecode, &callee);
+  Interpret(bytecode, &callee, func_id);
 
   if (used_heap) {
     std::free(raw_frame);
@@ -1706,4 +1979,19 @@ const uint8_t *VM::ExecuteCall(const uint8_t *ip, VM::Frame *caller) {
   return ip;
 }
 
+// static
+void VM::CallCompiled(const FunctionInfo &func_info, void *impl, const uint64_t params[]) {
+  using CompiledFn = uint64_t (*)(uint64_t, uint64_t, uint64_t, uint64_t, uint64_t, uint64_t);
+  const ast::Type *return_type = func_info.FuncType()->ReturnType();
+  const uint32_t first_arg = return_type->IsNilType() ? 0 : 1;
+
+  uint64_t args[Module::K_MAX_SIMPLE_PARAMS] = {0};
+  std::copy(params + first_arg, params + func_info.NumParams(), args);
+  const uint64_t result = reinterpret_cast<CompiledFn>(impl)(args[0], args[1], args[2], args[3], args[4], args[5]);
+
+  if (first_arg != 0) {
+    std::memcpy(reinterpret_cast<void *>(params[0]), &result, return_type->Size());
+  }
+}
+
 }  // namespace terrier::execution::vm
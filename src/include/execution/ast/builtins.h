@@ -23,6 +23,10 @@ namespace terrier::execution::ast {
   F(FilterLe, filterLe)                                               \
   F(FilterLt, filterLt)                                               \
   F(FilterNe, filterNe)                                               \
+  F(FilterBetween, filterBetween)                                     \
+  F(FilterIn, filterIn)                                               \
+  F(FilterStringEq, filterStringEq)                                   \
+  F(FilterStringPrefix, filterStringPrefix)                           \
                                                                       \
   /* Thread State Container */                                        \
   F(ExecutionContextGetMemoryPool, execCtxGetMem)                     \
@@ -38,6 +42,8 @@ namespace terrier::execution::ast {
   F(TableIterGetPCI, tableIterGetPCI)                                 \
   F(TableIterClose, tableIterClose)                                   \
   F(TableIterParallel, iterateTableParallel)                          \
+  F(TableIterSetTopKThreshold, tableIterSetTopKThreshold)             \
+  F(TableIterAddRuntimeFilter, tableIterAddRuntimeFilter)             \
                                                                       \
   /* PCI */                                                           \
   F(PCIIsFiltered, pciIsFiltered)                                     \
@@ -92,6 +98,16 @@ namespace terrier::execution::ast {
   F(AggPartIterNext, aggPartIterNext)                                 \
   F(AggPartIterGetHash, aggPartIterGetHash)                           \
   F(AggPartIterGetRow, aggPartIterGetRow)                             \
+  F(DirectMappedAggTableInit, dmAggTableInit)                         \
+  F(DirectMappedAggTableInDomain, dmAggTableInDomain)                 \
+  F(DirectMappedAggTableLookup, dmAggTableLookup)                     \
+  F(DirectMappedAggTableInsert, dmAggTableInsert)                     \
+  F(DirectMappedAggTableFree, dmAggTableFree)                         \
+  F(DirectMappedAggTableIterInit, dmAggTableIterInit)                 \
+  F(DirectMappedAggTableIterHasNext, dmAggTableIterHasNext)           \
+  F(DirectMappedAggTableIterNext, dmAggTableIterNext)                 \
+  F(DirectMappedAggTableIterGetRow, dmAggTableIterGetRow)             \
+  F(DirectMappedAggTableIterClose, dmAggTableIterClose)               \
   F(AggInit, aggInit)                                                 \
   F(AggAdvance, aggAdvance)                                           \
   F(AggMerge, aggMerge)                                               \
@@ -107,15 +123,24 @@ namespace terrier::execution::ast {
   F(JoinHashTableIterClose, joinHTIterClose)                          \
   F(JoinHashTableBuild, joinHTBuild)                                  \
   F(JoinHashTableBuildParallel, joinHTBuildParallel)                  \
+  F(JoinHashTableBuildBloomFilter, joinHTBuildBloomFilter)            \
   F(JoinHashTableFree, joinHTFree)                                    \
+  F(JoinHashTableEnableSpilling, joinHTEnableSpilling)                \
+  F(JoinHashTableIsSpilled, joinHTIsSpilled)                          \
+  F(JoinHashTableDeferProbe, joinHTDeferProbe)                        \
+  F(JoinHashTableJoinSpilled, joinHTJoinSpilled)                      \
                                                                       \
   /* Sorting */                                                       \
   F(SorterInit, sorterInit)                                           \
   F(SorterInsert, sorterInsert)                                       \
+  F(SorterInsertTopK, sorterInsertTopK)                               \
+  F(SorterInsertTopKFinish, sorterInsertTopKFinish)                   \
   F(SorterSort, sorterSort)                                           \
   F(SorterSortParallel, sorterSortParallel)                           \
   F(SorterSortTopKParallel, sorterSortTopKParallel)                   \
   F(SorterFree, sorterFree)                                           \
+  F(SorterSetTopKThreshold, sorterSetTopKThreshold)                   \
+  F(TopKThresholdInit, topKThresholdInit)                             \
   F(SorterIterInit, sorterIterInit)                                   \
   F(SorterIterHasNext, sorterIterHasNext)                             \
   F(SorterIterNext, sorterIterNext)                                   \
@@ -134,6 +159,7 @@ namespace terrier::execution::ast {
                                                                       \
   /* Generic */                                                       \
   F(SizeOf, sizeOf)                                                   \
+  F(OffsetOf, offsetOf)                                               \
   F(PtrCast, ptrCast)                                                 \
                                                                       \
   /* Output Buffer */                                                 \
@@ -58,6 +58,9 @@ class Context;
   NON_PRIM(AggregationHashTableIterator, terrier::execution::sql::AggregationHashTableIterator) \
   NON_PRIM(AggOverflowPartIter, terrier::execution::sql::AggregationOverflowPartitionIterator)  \
   NON_PRIM(BloomFilter, terrier::execution::sql::BloomFilter)                                   \
+  NON_PRIM(DirectMappedAggregationTable, terrier::execution::sql::DirectMappedAggregationTable) \
+  NON_PRIM(DirectMappedAggregationTableIterator,                                                \
+           terrier::execution::sql::DirectMappedAggregationTableIterator)                       \
   NON_PRIM(ExecutionContext, terrier::execution::exec::ExecutionContext)                        \
   NON_PRIM(FilterManager, terrier::execution::sql::FilterManager)                               \
   NON_PRIM(HashTableEntry, terrier::execution::sql::HashTableEntry)                             \
@@ -69,6 +72,7 @@ class Context;
   NON_PRIM(SorterIterator, terrier::execution::sql::SorterIterator)                             \
   NON_PRIM(TableVectorIterator, terrier::execution::sql::TableVectorIterator)                   \
   NON_PRIM(ThreadStateContainer, terrier::execution::sql::ThreadStateContainer)                 \
+  NON_PRIM(TopKThreshold, terrier::execution::sql::TopKThreshold)                               \
   NON_PRIM(ProjectedColumnsIterator, terrier::execution::sql::ProjectedColumnsIterator)         \
   NON_PRIM(IndexIterator, terrier::execution::sql::IndexIterator)                               \
                                                                                                 \
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <memory>
 #include <random>
 #include <vector>
 
@@ -37,6 +38,13 @@ class Policy {
    */
   virtual ~Policy() = default;
 
+  /**
+   * Create a policy of the given kind with its default hyper-parameters
+   * @param kind The kind of policy
+   * @return The policy
+   */
+  static std::unique_ptr<Policy> Create(Kind kind);
+
   /**
    * Returns the next action according to the policy
    */
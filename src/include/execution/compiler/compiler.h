@@ -0,0 +1,265 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "catalog/catalog_defs.h"
+#include "common/managed_pointer.h"
+#include "parser/expression/abstract_expression.h"
+#include "planner/plannodes/abstract_plan_node.h"
+#include "planner/plannodes/output_schema.h"
+#include "type/type_id.h"
+
+namespace terrier::catalog {
+class CatalogAccessor;
+}  // namespace terrier::catalog
+
+namespace terrier::optimizer {
+class StatsStorage;
+}  // namespace terrier::optimizer
+
+namespace terrier::parser {
+class AggregateExpression;
+}  // namespace terrier::parser
+
+namespace terrier::planner {
+class AggregatePlanNode;
+class HashJoinPlanNode;
+class OrderByPlanNode;
+class ProjectionPlanNode;
+class SeqScanPlanNode;
+}  // namespace terrier::planner
+
+namespace terrier::execution::compiler {
+
+/**
+ * Compiles a tree of physical plan nodes into a TPL program. The plan is split into pipelines at its pipeline
+ * breakers: the build side of a hash join, the input of an aggregation and the input of a sort. Each pipeline becomes a
+ * function that pushes the tuples of a table scan, or of a breaker's materialized state, through every operator up to
+ * the next breaker, one tuple at a time, over the vectors of the scan. Breakers keep their state (an
+ * AggregationHashTable, a JoinHashTable, a Sorter or plain aggregators) in a State struct shared by all pipelines.
+ * A pipeline's function finishes the breaker it feeds, e.g. builds the join hash table, once its loops are done.
+ * main() runs the pipelines in dependency order, sends the root's rows to the execution context's output buffer and
+ * returns the number of rows produced. A caller may instead run the pipelines listed by GetPipelines() itself, on a
+ * State of stateSize() bytes set up by setUpState() and torn down by finishQuery(), which returns the number of rows.
+ * Pipelines that don't depend on each other, such as the build sides of two joins, can then run at the same time.
+ *
+ * The compiler supports sequential scans, projections, limits, plain and hashed aggregations, sorts and inner hash
+ * joins over integer and decimal columns. Scan predicates comparing a non-nullable integer column with a constant are
+ * evaluated with vectorized filters. Groups keyed by a single integer column whose histogram bounds it to a small
+ * domain are kept in a DirectMappedAggregationTable, with keys outside of the domain going to an AggregationHashTable.
+ * Output columns are computed from the output schema's targets, then its direct maps, and are otherwise looked up by
+ * oid among the columns of the node's children. In expressions, a DerivedValueExpression refers to the column at
+ * value_idx of the child at tuple_idx. The children of an aggregation are its group by terms (tuple_idx 0) and its
+ * aggregate terms (tuple_idx 1), which are also its default output.
+ *
+ * Plans that use anything else, such as other node types, strings, dates, NULL constants or DISTINCT aggregates, are
+ * rejected: Compile() returns an empty program and the caller must run the plan some other way. That includes inserts,
+ * updates and deletes, as TPL has no builtins yet to write tuples to a table and maintain its indexes.
+ */
+class Compiler {
+ public:
+  /**
+   * Create a compiler for the given plan
+   * @param plan The root of the plan to compile
+   * @param accessor The catalog accessor used to look up the tables the plan scans
+   * @param db_oid The database of the tables the plan scans
+   * @param stats_storage The statistics of the tables, used to pick operator implementations, or nullptr if there are
+   *                      none
+   */
+  Compiler(const planner::AbstractPlanNode &plan, catalog::CatalogAccessor *accessor,
+           catalog::db_oid_t db_oid = catalog::INVALID_DATABASE_OID,
+           common::ManagedPointer<optimizer::StatsStorage> stats_storage = nullptr)
+      : plan_(plan), accessor_(accessor), db_oid_(db_oid), stats_storage_(stats_storage) {}
+
+  /**
+   * Compile the plan
+   * @return The source of the TPL program executing the plan, or an empty string if the plan isn't supported
+   */
+  std::string Compile();
+
+  /**
+   * @return Why the plan isn't supported, or an empty string if it is
+   */
+  const std::string &GetUnsupportedReason() const { return unsupported_reason_; }
+
+  /**
+   * @return The tables the plan scans, once per scan
+   */
+  const std::vector<catalog::table_oid_t> &GetScannedTables() const { return scanned_tables_; }
+
+  /**
+   * A pipeline of the compiled program
+   */
+  struct PipelineInfo {
+    /**
+     * The name of the function running the pipeline, taking the execution context and a *State
+     */
+    std::string function_;
+    /**
+     * The pipelines that must finish before this one starts, by index in GetPipelines()
+     */
+    std::vector<uint32_t> dependencies_;
+  };
+
+  /**
+   * @return The pipelines of the compiled program, each after the pipelines it depends on
+   */
+  const std::vector<PipelineInfo> &GetPipelines() const { return pipeline_infos_; }
+
+ private:
+  // The SQL type of a value in the generated code
+  enum class SqlType : uint8_t { Integer, Real, Boolean };
+
+  // A value of a row flowing between operators: the TPL expression computing it, its SQL type, whether it may be NULL
+  // and the oid of the column it is, if any, with the oid of the column's table. A column read by a scan also names the
+  // scan's iterator, and its index and type in the scan's projection, until an operator that must see every row of the
+  // scan, such as a limit, is passed.
+  struct Value {
+    std::string expr_;
+    SqlType type_{SqlType::Integer};
+    bool nullable_{false};
+    catalog::col_oid_t oid_{catalog::INVALID_COLUMN_OID};
+    catalog::table_oid_t table_oid_{catalog::INVALID_TABLE_OID};
+    std::string scan_;
+    uint32_t scan_col_idx_{0};
+    type::TypeId scan_col_type_{type::TypeId::INVALID};
+  };
+
+  using Row = std::vector<Value>;
+
+  // Emits the code handling one row of an operator's output in the current pipeline
+  using Consumer = std::function<void(const Row &)>;
+
+  // Emit the code producing the rows of the given node into the current pipeline
+  void Produce(const planner::AbstractPlanNode &node, const Consumer &consume);
+  void ProduceSeqScan(const planner::SeqScanPlanNode &node, const Consumer &consume);
+  void ProduceProjection(const planner::ProjectionPlanNode &node, const Consumer &consume);
+  void ProduceLimit(const planner::AbstractPlanNode &node, uint64_t limit, uint64_t offset, const Consumer &consume);
+  void ProduceAggregate(const planner::AggregatePlanNode &node, const Consumer &consume);
+  void ProducePlainAggregate(const planner::AggregatePlanNode &node, const Consumer &consume);
+  void ProduceHashAggregate(const planner::AggregatePlanNode &node, const Consumer &consume);
+  void ProduceOrderBy(const planner::OrderByPlanNode &node, const Consumer &consume);
+  void ProduceHashJoin(const planner::HashJoinPlanNode &node, const Consumer &consume);
+
+  // Emit the code writing a row of the plan's result to the output buffer
+  void ConsumeOutput(const Row &row);
+
+  // Emit the code handing a row to the consumer if it's past the offset and within the limit
+  void ConsumeLimited(uint64_t limit, uint64_t offset, const Row &row, const Consumer &consume);
+
+  // Compute the output row of a node over the given input rows. Columns without a target or direct map are taken from
+  // the default row if there is one, or looked up by oid in the input rows otherwise.
+  Row ComputeOutput(const planner::OutputSchema &schema, const std::vector<const Row *> &inputs,
+                    const Row *default_row = nullptr);
+
+  // Compile an expression over the given input rows, indexed by tuple index
+  Value CompileExpression(const parser::AbstractExpression &expr, const std::vector<const Row *> &inputs);
+  Value CompileConstant(const parser::AbstractExpression &expr);
+  Value LookupColumn(catalog::col_oid_t oid, const std::vector<const Row *> &inputs);
+
+  // The value an aggregate term is advanced with, and the type of the aggregator computing it
+  Value AggregateInput(const parser::AggregateExpression &term, const std::vector<const Row *> &inputs);
+  std::string AggregatorType(const parser::AggregateExpression &term, SqlType input_type, Value *result);
+
+  // The domain [min_key, max_key] of an integer column according to its histogram, if the column has statistics and
+  // the domain is small enough for a DirectMappedAggregationTable
+  bool SmallKeyDomain(const Value &key, int64_t *min_key, int64_t *max_key) const;
+
+  // Emit a condition testing the given boolean value and open its block
+  void OpenIf(const Value &predicate);
+
+  // Declare a struct with a field per value of the row, named with the given prefix and the value's index
+  void DeclareRowStruct(const std::string &name, const Row &row, const std::string &field_prefix);
+
+  // Add a field to the State struct, returning how to address it in a pipeline
+  std::string AddStateField(const std::string &name, const std::string &type);
+
+  // Run the given statement right after the scan reading the value is initialized, to attach a dynamic filter to it.
+  // Returns false, doing nothing, unless the value is read by a scan whose rows are being consumed.
+  bool AddScanHook(const Value &value, const std::string &statement);
+
+  // Start generating a new pipeline; the pipelines it depends on may be started while it is being generated
+  void BeginPipeline();
+
+  // Finish the current pipeline. Its function runs its finishing statements, then the given statements, after its
+  // loops. main() runs it after all pipelines it depends on. The enclosing pipeline, if any, depends on it.
+  void EndPipeline(const std::vector<std::string> &then);
+
+  // Append a statement to the finish steps of the pipeline that ended as pipelines_[pipeline]
+  void AddFinishStep(std::size_t pipeline, const std::string &statement);
+
+  // Emit a line, a line opening a block or the end of a block into the current pipeline
+  void Line(const std::string &line);
+  void Open(const std::string &line);
+  void Close();
+
+  // Where the header of a loop was emitted, and what it was made of
+  struct Loop {
+    std::size_t pos_;
+    uint32_t depth_;
+    std::string init_;
+    std::string condition_;
+    std::string step_;
+  };
+
+  // The header of a loop of the current pipeline, which also stops once any of the pipeline's stop conditions fails
+  std::string LoopHeader(const std::string &init, const std::string &condition, const std::string &step) const;
+
+  // Open a loop in the current pipeline. The stop conditions are only known once the loop's body is generated, so
+  // CloseLoop() adds them to its header.
+  Loop OpenLoop(const std::string &init, const std::string &condition, const std::string &step);
+  void CloseLoop(const Loop &loop);
+
+  // A new identifier, unique within the program
+  std::string NewName(const std::string &prefix);
+
+  // Reject the plan, keeping the first reason given
+  void Unsupported(const std::string &reason);
+
+  static const char *TypeName(SqlType type);
+
+  // The body of a pipeline function being generated, the statements it runs once its loops are done, before the ones
+  // of the operator that ends it, the conditions its loops must hold to go on, e.g. a LIMIT not yet reached, and the
+  // pipelines that ended while it was generated, which it reads the output of
+  struct Pipeline {
+    std::string body_;
+    uint32_t depth_;
+    std::vector<std::string> finish_;
+    std::vector<std::string> stop_;
+    std::vector<uint32_t> dependencies_;
+  };
+
+  const planner::AbstractPlanNode &plan_;
+  catalog::CatalogAccessor *accessor_;
+  catalog::db_oid_t db_oid_;
+  common::ManagedPointer<optimizer::StatsStorage> stats_storage_;
+  std::string unsupported_reason_;
+  uint32_t next_id_{0};
+
+  // The tables scanned by the plan
+  std::vector<catalog::table_oid_t> scanned_tables_;
+
+  // The types of the columns of the plan's result
+  std::vector<SqlType> output_types_;
+
+  // The top-level declarations of the program
+  std::vector<std::string> structs_;
+  std::vector<std::string> state_fields_;
+  std::vector<std::string> functions_;
+  std::vector<std::string> pipelines_;
+  std::vector<std::string> set_up_;
+  std::vector<std::string> tear_down_;
+  std::vector<std::string> main_steps_;
+  std::vector<PipelineInfo> pipeline_infos_;
+
+  // The pipelines being generated, innermost last
+  std::vector<Pipeline> pipeline_stack_;
+
+  // The statements attaching dynamic filters to the scans whose rows are being consumed, by iterator name
+  std::unordered_map<std::string, std::vector<std::string>> scan_hooks_;
+};
+
+}  // namespace terrier::execution::compiler
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/macros.h"
+#include "execution/ast/context.h"
+#include "execution/compiler/compiler.h"
+#include "execution/sema/error_reporter.h"
+#include "execution/util/region.h"
+#include "execution/vm/module.h"
+#include "planner/plannodes/abstract_plan_node.h"
+
+namespace terrier::execution::exec {
+class ExecutionContext;
+}  // namespace terrier::execution::exec
+
+namespace terrier::execution::compiler {
+
+/**
+ * A plan compiled into a TPL module, ready to run. The plan is compiled by the Compiler, then parsed, type-checked and
+ * turned into bytecode. If the plan can't be compiled, the query isn't compiled and must be run some other way. The
+ * statistics set on the execution context, if any, pick operator implementations and give the module the number of
+ * tuples the query's scans read, from which it chooses how hard to optimize its machine code. The query's pipelines
+ * run on the QueryScheduler, as a query with the priority and degree of parallelism of the execution context.
+ */
+class ExecutableQuery {
+ public:
+  /**
+   * Compile the given plan
+   * @param plan The root of the plan
+   * @param exec_ctx The execution context of the query, used to look up the tables it scans and their statistics
+   */
+  ExecutableQuery(const planner::AbstractPlanNode &plan, exec::ExecutionContext *exec_ctx);
+
+  /**
+   * This class cannot be copied or moved
+   */
+  DISALLOW_COPY_AND_MOVE(ExecutableQuery);
+
+  /**
+   * @return True if the plan was compiled into a module
+   */
+  bool IsCompiled() const { return module_ != nullptr; }
+
+  /**
+   * @return The TPL source the plan was compiled into, empty if the plan isn't supported
+   */
+  const std::string &GetTplSource() const { return tpl_source_; }
+
+  /**
+   * @return The module the plan was compiled into, or nullptr if the plan isn't supported
+   */
+  const vm::Module *GetModule() const { return module_.get(); }
+
+  /**
+   * Run the query, sending its rows to the output buffer of the execution context. The query must be compiled. Every
+   * pipeline is a pipeline of a QueryScheduler query, which starts once the pipelines it depends on finished.
+   * @param exec_ctx The execution context to run the query in
+   * @param mode The mode to run the query's module in
+   * @return The number of rows produced
+   * @throws std::runtime_error If the query goes past the memory limit of the execution context. The query's operators
+   *         are torn down and its state freed before.
+   */
+  int64_t Run(exec::ExecutionContext *exec_ctx, vm::ExecutionMode mode);
+
+ private:
+  std::string tpl_source_;
+  std::vector<Compiler::PipelineInfo> pipelines_;
+  // The module refers to the types in the AST, so the AST must live as long as the module
+  util::Region region_;
+  util::Region error_region_;
+  sema::ErrorReporter error_reporter_;
+  ast::Context ast_ctx_;
+  std::unique_ptr<vm::Module> module_;
+};
+
+}  // namespace terrier::execution::compiler
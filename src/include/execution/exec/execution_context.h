@@ -2,13 +2,20 @@
 #include <memory>
 #include <utility>
 #include "catalog/catalog_accessor.h"
+#include "common/managed_pointer.h"
 #include "execution/exec/output.h"
+#include "execution/exec/query_scheduler.h"
 #include "execution/sql/memory_pool.h"
+#include "execution/sql/memory_tracker.h"
 #include "execution/util/region.h"
 #include "planner/plannodes/output_schema.h"
 #include "transaction/transaction_context.h"
 #include "transaction/transaction_manager.h"
 
+namespace terrier::optimizer {
+class StatsStorage;
+}  // namespace terrier::optimizer
+
 namespace terrier::execution::exec {
 /**
  * Execution Context: Stores information handed in by upper layers.
@@ -63,15 +70,19 @@ class EXPORT ExecutionContext {
    * @param callback callback function for outputting
    * @param schema the schema of the output
    * @param accessor the catalog accessor of this query
+   * @param output_batch_size the number of output tuples to buffer before calling the callback
    */
   ExecutionContext(catalog::db_oid_t db_oid, transaction::TransactionContext *txn, const OutputCallback &callback,
-                   const planner::OutputSchema *schema, std::unique_ptr<catalog::CatalogAccessor> &&accessor)
+                   const planner::OutputSchema *schema, std::unique_ptr<catalog::CatalogAccessor> &&accessor,
+                   uint32_t output_batch_size = OutputBuffer::DEFAULT_BATCH_SIZE)
       : db_oid_(db_oid),
         txn_(txn),
-        mem_pool_(std::make_unique<sql::MemoryPool>(nullptr)),
+        mem_tracker_(std::make_unique<sql::MemoryTracker>()),
+        mem_pool_(std::make_unique<sql::MemoryPool>(mem_tracker_.get())),
         buffer_(schema == nullptr ? nullptr
                                   : std::make_unique<OutputBuffer>(mem_pool_.get(), schema->GetColumns().size(),
-                                                                   ComputeTupleSize(schema), callback)),
+                                                                   ComputeTupleSize(schema), callback,
+                                                                   output_batch_size)),
         accessor_(std::move(accessor)) {}
 
   /**
@@ -89,6 +100,29 @@ class EXPORT ExecutionContext {
    */
   sql::MemoryPool *GetMemoryPool() { return mem_pool_.get(); }
 
+  /**
+   * @return the tracker of the memory the query allocates from its memory pool
+   */
+  sql::MemoryTracker *GetMemoryTracker() { return mem_tracker_.get(); }
+
+  /**
+   * Set the number of bytes the query's operators should try to keep in memory. Operators that can spill write data
+   * to disk once they, or the query as a whole, exceed it.
+   * @param budget The budget in bytes, or zero for no limit.
+   */
+  void SetMemoryBudget(std::size_t budget) { mem_pool_->SetMemoryBudget(budget); }
+
+  /**
+   * @return the memory budget of the query in bytes, or zero if there is none
+   */
+  std::size_t GetMemoryBudget() const { return mem_pool_->GetMemoryBudget(); }
+
+  /**
+   * Set the number of bytes the query may allocate at most. The allocation going past it fails, aborting the query.
+   * @param limit The limit in bytes, or zero for no limit.
+   */
+  void SetMemoryLimit(std::size_t limit) { mem_tracker_->SetLimit(limit); }
+
   /**
    * @return the string allocator
    */
@@ -110,12 +144,51 @@ class EXPORT ExecutionContext {
    */
   catalog::db_oid_t DBOid() { return db_oid_; }
 
+  /**
+   * Set the statistics the compiler consults when choosing operator implementations for this query.
+   * @param stats_storage The statistics, or nullptr if none are available.
+   */
+  void SetStatsStorage(common::ManagedPointer<optimizer::StatsStorage> stats_storage) {
+    stats_storage_ = stats_storage;
+  }
+
+  /**
+   * @return the statistics available to this query, or nullptr if there are none
+   */
+  common::ManagedPointer<optimizer::StatsStorage> GetStatsStorage() const { return stats_storage_; }
+
+  /**
+   * Set the share of the QueryScheduler's workers the query gets relative to other queries.
+   * @param priority The priority, at least one.
+   */
+  void SetPriority(uint32_t priority) { priority_ = priority; }
+
+  /**
+   * @return the priority the query is scheduled with
+   */
+  uint32_t GetPriority() const { return priority_; }
+
+  /**
+   * Set the largest number of threads that run the query's morsels at once.
+   * @param max_dop The degree of parallelism, or zero for no limit.
+   */
+  void SetMaxDop(uint32_t max_dop) { max_dop_ = max_dop; }
+
+  /**
+   * @return the largest number of threads that run the query at once, or zero if there is no limit
+   */
+  uint32_t GetMaxDop() const { return max_dop_; }
+
  private:
   catalog::db_oid_t db_oid_;
   transaction::TransactionContext *txn_;
+  std::unique_ptr<sql::MemoryTracker> mem_tracker_;
   std::unique_ptr<sql::MemoryPool> mem_pool_;
   std::unique_ptr<OutputBuffer> buffer_;
   StringAllocator string_allocator_;
   std::unique_ptr<catalog::CatalogAccessor> accessor_;
+  common::ManagedPointer<optimizer::StatsStorage> stats_storage_{nullptr};
+  uint32_t priority_{QueryScheduler::K_DEFAULT_PRIORITY};
+  uint32_t max_dop_{0};
 };
 }  // namespace terrier::execution::exec
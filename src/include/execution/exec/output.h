@@ -1,6 +1,7 @@
 #pragma once
 
 #pragma once
+#include <functional>
 #include <iostream>
 #include <memory>
 #include <sstream>
@@ -21,14 +22,15 @@ namespace terrier::execution::exec {
 using OutputCallback = std::function<void(byte *, uint32_t, uint32_t)>;
 
 /**
- * A class that buffers the output and makes a callback for every batch.
+ * A class that buffers the output and makes a callback for every batch. Batches are large so that the callback, and
+ * whatever serializes the tuples it's given, run once per thousands of tuples rather than once per few.
  */
 class EXPORT OutputBuffer {
  public:
   /**
-   * Batch size
+   * Default number of tuples in a batch
    */
-  static constexpr uint32_t BATCH_SIZE = 32;
+  static constexpr uint32_t DEFAULT_BATCH_SIZE = 2048;
 
   /**
    * Constructor
@@ -36,20 +38,25 @@ class EXPORT OutputBuffer {
    * @param num_cols number of columns in output tuples
    * @param tuple_size size of output tuples
    * @param callback upper layer callback
+   * @param batch_size number of tuples to buffer before making the callback
    */
-  explicit OutputBuffer(sql::MemoryPool *memory_pool, uint16_t num_cols, uint32_t tuple_size, OutputCallback callback)
+  explicit OutputBuffer(sql::MemoryPool *memory_pool, uint16_t num_cols, uint32_t tuple_size, OutputCallback callback,
+                        uint32_t batch_size = DEFAULT_BATCH_SIZE)
       : memory_pool_(memory_pool),
         num_tuples_(0),
         tuple_size_(tuple_size),
+        batch_size_(batch_size),
         tuples_(
-            reinterpret_cast<byte *>(memory_pool->AllocateAligned(BATCH_SIZE * tuple_size, alignof(uint64_t), true))),
-        callback_(std::move(callback)) {}
+            reinterpret_cast<byte *>(memory_pool->AllocateAligned(batch_size * tuple_size, alignof(uint64_t), true))),
+        callback_(std::move(callback)) {
+    TERRIER_ASSERT(batch_size > 0, "Output batches cannot be empty");
+  }
 
   /**
    * @return an output slot to be written to.
    */
   byte *AllocOutputSlot() {
-    if (num_tuples_ == BATCH_SIZE) {
+    if (num_tuples_ == batch_size_) {
       callback_(tuples_, num_tuples_, tuple_size_);
       num_tuples_ = 0;
     }
@@ -58,6 +65,11 @@ class EXPORT OutputBuffer {
     return tuples_ + tuple_size_ * (num_tuples_ - 1);
   }
 
+  /**
+   * @return the number of tuples in a batch
+   */
+  uint32_t GetBatchSize() const { return batch_size_; }
+
   /**
    * Called at the end of execution to return the final few tuples.
    */
@@ -72,6 +84,7 @@ class EXPORT OutputBuffer {
   sql::MemoryPool *memory_pool_;
   uint32_t num_tuples_;
   uint32_t tuple_size_;
+  uint32_t batch_size_;
   byte *tuples_;
   OutputCallback callback_;
 };
@@ -101,4 +114,57 @@ class OutputPrinter {
   const planner::OutputSchema *schema_;
 };
 
+// Receives serialized output. Params(): bytes, num_bytes
+using OutputSink = std::function<void(const char *, std::size_t)>;
+
+/**
+ * A OutputCallback that serializes batches of tuples into Postgres DataRow messages, in text or binary format.
+ *
+ * The tuples of a batch are serialized a column at a time: a tight loop over the column's type formats its values for
+ * all tuples, then copies them into their messages. All messages of a batch are laid out in one contiguous buffer,
+ * which goes to the sink in a single call, e.g. to append it to a connection's write queue.
+ */
+class EXPORT PostgresOutputWriter {
+ public:
+  /**
+   * Constructor
+   * @param schema final schema to output
+   * @param binary whether to use the binary format instead of the text format
+   * @param sink receives the messages of every batch
+   */
+  PostgresOutputWriter(const planner::OutputSchema *schema, bool binary, OutputSink sink);
+
+  /**
+   * Callback that serializes a batch of tuples and hands it to the sink.
+   * @param tuples batch of tuples
+   * @param num_tuples number of tuples
+   * @param tuple_size size of tuples
+   */
+  void operator()(byte *tuples, uint32_t num_tuples, uint32_t tuple_size);
+
+ private:
+  // The serialized values of a column in a batch
+  struct ColumnValues {
+    // The length of every value, or -1 if it's NULL
+    std::vector<int32_t> lens_;
+    // Where every value is. Strings are read in place, other values are formatted into data_.
+    std::vector<const char *> ptrs_;
+    std::vector<char> data_;
+  };
+
+  // Serialize a column of the batch into values
+  void SerializeColumn(uint16_t col, const byte *tuples, uint32_t num_tuples, uint32_t tuple_size,
+                       ColumnValues *values) const;
+
+  const planner::OutputSchema *schema_;
+  bool binary_;
+  OutputSink sink_;
+  // The offsets of the columns in a tuple
+  std::vector<uint32_t> offsets_;
+  // Per-batch scratch space, kept between batches
+  std::vector<ColumnValues> columns_;
+  std::vector<uint32_t> cursors_;
+  std::vector<char> buffer_;
+};
+
 }  // namespace terrier::execution::exec
@@ -0,0 +1,192 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <condition_variable>  // NOLINT
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/macros.h"
+#include "execution/util/execution_common.h"
+
+namespace terrier::execution::exec {
+
+/**
+ * A pool of worker threads shared by all concurrently running queries. A query is a set of pipelines, each a number of
+ * morsels: independent pieces of work, such as a range of blocks to scan or a thread-local table to merge. A pipeline
+ * can depend on others, the pipeline breakers feeding it, and its morsels don't start before all of them finished.
+ *
+ * Workers are spread over the NUMA nodes of the machine. The morsels of a pipeline are divided among the nodes, and a
+ * worker takes the morsels of its own node before stealing those of other nodes, so that most morsels run where their
+ * data was produced while no worker idles as long as there's work left.
+ *
+ * Queries share the workers in proportion to their priority: a worker picks the query that has had the least service
+ * relative to its priority, then runs morsels of the same pipeline for a time slice, claiming each through an atomic
+ * cursor without taking the scheduler's latch, and accounts for all of them at once. A query never runs on more
+ * workers than its degree of parallelism, which keeps a large query from monopolizing the machine. The thread waiting
+ * for a query helps run it, so queries may be scheduled from inside a morsel of another query without deadlocking.
+ */
+class EXPORT QueryScheduler {
+ public:
+  /**
+   * Function running a morsel of a pipeline, given the morsel's index
+   */
+  using MorselFn = std::function<void(uint64_t)>;
+
+  /**
+   * The default priority of a query
+   */
+  static constexpr uint32_t K_DEFAULT_PRIORITY = 16;
+
+  /**
+   * How long a thread keeps running morsels of the pipeline it picked before it accounts for them and picks again
+   */
+  static constexpr std::chrono::microseconds K_TIME_SLICE{500};
+
+  class Pipeline;
+
+  /**
+   * A query: its pipelines and the dependencies between them. Pipelines are added before the query is submitted.
+   */
+  class EXPORT Query {
+   public:
+    /**
+     * Create a query
+     * @param priority The share of the workers the query gets relative to other queries, at least one
+     * @param max_dop The largest number of threads that run the query at once, zero for no limit
+     */
+    Query(uint32_t priority, uint32_t max_dop);
+
+    /**
+     * This class cannot be copied or moved.
+     */
+    DISALLOW_COPY_AND_MOVE(Query);
+
+    /**
+     * Destructor
+     */
+    ~Query();
+
+    /**
+     * Add a pipeline to the query
+     * @param num_morsels The number of morsels of the pipeline
+     * @param fn The function running a morsel
+     * @param dependencies The pipelines that must finish before this one starts
+     * @return The pipeline's identifier, used to depend on it
+     */
+    uint32_t AddPipeline(uint64_t num_morsels, MorselFn fn, const std::vector<uint32_t> &dependencies = {});
+
+    /**
+     * @return The priority of the query
+     */
+    uint32_t GetPriority() const { return priority_; }
+
+    /**
+     * @return The largest number of threads that run the query at once, zero if there's no limit
+     */
+    uint32_t GetMaxDop() const { return max_dop_; }
+
+    /**
+     * @return True if all pipelines of the query finished
+     */
+    bool IsDone() const { return done_; }
+
+   private:
+    friend class QueryScheduler;
+
+    // Claim the next morsel of a pipeline that can run, preferring those of the given NUMA node. Returns false if
+    // there's none.
+    bool ClaimMorsel(uint32_t node, Pipeline **pipeline, uint64_t *morsel);
+
+    // True if some pipeline that can run has morsels left to claim
+    bool HasUnclaimedMorsels() const;
+
+    const uint32_t priority_;
+    const uint32_t max_dop_;
+    std::vector<std::unique_ptr<Pipeline>> pipelines_;
+    uint32_t num_pending_pipelines_{0};
+    bool done_{false};
+    // The first exception a morsel threw, rethrown to the thread waiting for the query
+    std::exception_ptr error_;
+    // The number of threads running a morsel of the query
+    uint32_t num_active_{0};
+    // Signalled when the threads waiting for the query may be able to run a morsel of it, or when it finished
+    std::condition_variable progress_cv_;
+    // The service the query got, scaled by its priority. The query with the lowest pass runs next.
+    uint64_t pass_{0};
+  };
+
+  /**
+   * @return The scheduler shared by all queries, with a worker per core
+   */
+  static QueryScheduler *Instance();
+
+  /**
+   * Create a scheduler
+   * @param num_workers The number of worker threads
+   */
+  explicit QueryScheduler(uint32_t num_workers);
+
+  /**
+   * This class cannot be copied or moved.
+   */
+  DISALLOW_COPY_AND_MOVE(QueryScheduler);
+
+  /**
+   * Destructor. Waits for the running morsels to finish; morsels that didn't start are dropped.
+   */
+  ~QueryScheduler();
+
+  /**
+   * Start running a query. No pipeline can be added to it from now on.
+   * @param query The query to run
+   */
+  void Submit(std::shared_ptr<Query> query);
+
+  /**
+   * Wait until a submitted query finished, running its morsels on the calling thread in the meantime
+   * @param query The query to wait for
+   * @throws The first exception a morsel of the query threw, if any
+   */
+  void Wait(Query *query);
+
+  /**
+   * Call a function on every index in [0, n) in parallel and wait for all calls to finish. The calls are a query of a
+   * single pipeline with the priority and degree of parallelism of the query the calling thread is running a morsel
+   * of, or the defaults if it isn't.
+   * @param n The number of indexes
+   * @param fn The function to call on every index
+   * @param max_dop The largest number of threads to call the function on at once, zero for no limit beyond the one of
+   *                the calling query
+   */
+  void ParallelFor(uint64_t n, const MorselFn &fn, uint32_t max_dop = 0);
+
+  /**
+   * @return The number of worker threads
+   */
+  uint32_t GetNumWorkers() const { return static_cast<uint32_t>(workers_.size()); }
+
+ private:
+  // The body of a worker thread running on the given NUMA node
+  void RunWorker(uint32_t node);
+
+  // Pick the query the next morsel is taken from, the one with the lowest pass that has morsels to claim and room for
+  // another thread. Must hold the latch.
+  std::shared_ptr<Query> PickQuery() const;
+
+  // Run morsels of the query for a time slice if one can be claimed, and account for them. Must hold the latch, which
+  // is released while the morsels run. Returns false if no morsel could be claimed.
+  bool RunMorsels(Query *query, uint32_t node, std::unique_lock<std::mutex> *lock);
+
+  std::vector<std::thread> workers_;
+  std::mutex latch_;
+  std::condition_variable work_cv_;
+  std::vector<std::shared_ptr<Query>> queries_;
+  bool shutdown_{false};
+};
+
+}  // namespace terrier::execution::exec
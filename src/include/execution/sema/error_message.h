@@ -82,7 +82,7 @@ namespace sema {
   F(MissingArrayLength, "missing array length (either compile-time number or '*')", ())                               \
   F(NotASQLAggregate, "'%0' is not a SQL aggregator type", (ast::Type *))                                             \
   F(BadParallelScanFunction,                                                                                          \
-    "parallel scan function must have type (*ExecutionContext, "                                                      \
+    "parallel scan function must have type (*QueryState, *ThreadState, "                                              \
     "*TableVectorIterator)->nil, received '%0'",                                                                      \
     (ast::Type *))                                                                                                    \
   F(BadArgToOutputSetNull,                                                                                            \
@@ -108,6 +108,9 @@ namespace sema {
     "joinHTGetNext() expects a (void*, void*, void*)->bool function. Received type '%0' in position %1",              \
     (ast::Type *, uint32_t))                                                                                          \
   F(BadPointerForJHTGetNext, "joinHTGetNext() expects a pointer argument type. Received type '%0' in position %1",    \
+    (ast::Type *, uint32_t))                                                                                          \
+  F(BadProbeFunctionForJHTJoinSpilled,                                                                                \
+    "joinHTJoinSpilled() expects a (*, *JoinHashTable, uint64, *)->nil function. Received type '%0' in position %1",  \
     (ast::Type *, uint32_t))
 
 /**
@@ -1,10 +1,13 @@
 #pragma once
 
 #include <functional>
+#include <memory>
+#include <vector>
 
 #include "execution/sql/generic_hash_table.h"
 #include "execution/sql/memory_pool.h"
 #include "execution/sql/projected_columns_iterator.h"
+#include "execution/sql/spill_file.h"
 #include "execution/util/chunked_vector.h"
 
 namespace libcount {
@@ -43,6 +46,21 @@ class EXPORT AggregationHashTable {
    */
   static constexpr uint32_t K_DEFAULT_HLL_PRECISION = 10;
 
+  /**
+   * Number of hash bits used to split a spilled partition that still doesn't fit in memory
+   */
+  static constexpr uint32_t K_SPILL_FANOUT_BITS = 4;
+
+  /**
+   * Number of entries read back from a spill file at a time
+   */
+  static constexpr uint32_t K_SPILL_READ_BATCH_SIZE = 1024;
+
+  /**
+   * Bytes buffered for each piece of a spilled partition that is being split
+   */
+  static constexpr uint32_t K_SPILL_SPLIT_BUFFER_SIZE = 64 * common::Constants::KB;
+
   // -------------------------------------------------------
   // Callback functions to customize aggregations
   // -------------------------------------------------------
@@ -74,6 +92,13 @@ class EXPORT AggregationHashTable {
    */
   using AdvanceAggFn = void (*)(void *, void *);
 
+  /**
+   * Function to initialize the aggregates of a new group created by
+   * @em LookupOrCreateGroups(). The group's key is already written.
+   * Convention: The argument is the payload of the new group.
+   */
+  using InitGroupFn = void (*)(void *);
+
   /**
    * Function to merge a set of overflow partitions into the given aggregation
    * hash table.
@@ -105,6 +130,11 @@ class EXPORT AggregationHashTable {
      * Number of flushes
      */
     uint64_t num_flushes_ = 0;
+
+    /**
+     * Number of times overflow partitions were spilled to disk
+     */
+    uint64_t num_spills_ = 0;
   };
 
   // -------------------------------------------------------
@@ -177,6 +207,25 @@ class EXPORT AggregationHashTable {
   void ProcessBatch(ProjectedColumnsIterator *iters[], HashFn hash_fn, KeyEqFn key_eq_fn, InitAggFn init_agg_fn,
                     AdvanceAggFn advance_agg_fn);
 
+  /**
+   * Find the group of every selected tuple in an input vector, creating the
+   * groups that don't exist yet. This is the fast path for aggregations
+   * grouped by a single fixed-width integer column: keys are hashed and
+   * compared inline rather than through hash and key-equality functions, and
+   * the aggregates of the groups are left to be advanced a whole vector at a
+   * time, e.g., by @em IntegerSumAggregate::AdvanceBatch(). New groups are
+   * initialized, but not yet advanced by the tuple that created them.
+   * @tparam KeyType The type of the grouping column, which must not be NULL.
+   * @param iter The input vector
+   * @param key_col_idx The index of the grouping column in the input vector
+   * @param key_offset The offset of the key in the payload of a group
+   * @param init_group_fn Function to initialize the aggregates of a new group
+   * @param[out] groups The payload of the group of every selected tuple
+   */
+  template <typename KeyType>
+  void LookupOrCreateGroups(const ProjectedColumnsIterator *iter, uint32_t key_col_idx, std::size_t key_offset,
+                            InitGroupFn init_group_fn, byte *groups[]);
+
   /**
    * Transfer all entries and overflow partitions stored in each thread-local
    * aggregation hash table (in the thread state container) into this table.
@@ -203,6 +252,11 @@ class EXPORT AggregationHashTable {
    * scanning of the table will be performed entirely in parallel; hence, the
    * callback function should be thread-safe.
    *
+   * Partitions that were spilled to disk are read back and aggregated one at a
+   * time. If a spilled partition has more groups than the memory budget allows,
+   * it is split into smaller partitions on disk using more bits of the hash,
+   * and the scan callback is invoked once for each of them.
+   *
    * The thread states container is assumed to already have been configured
    * prior to this scan call.
    *
@@ -274,6 +328,11 @@ class EXPORT AggregationHashTable {
   void ComputeHashAndLoadInitialImpl(ProjectedColumnsIterator *iters[], uint32_t num_elems, hash_t hashes[],
                                      HashTableEntry *entries[], HashFn hash_fn) const;
 
+  // Load the chain heads of a vector of hash values, prefetching the ones
+  // further ahead if requested
+  template <bool Prefetch>
+  void LoadChainHeads(uint32_t num_elems, const hash_t hashes[], HashTableEntry *entries[]) const;
+
   // Called from LookupBatch() to follow the entry chain of candidate group
   // entries filtered through group_sel. Follows the chain and uses the key
   // equality function to resolve hash collisions.
@@ -296,6 +355,42 @@ class EXPORT AggregationHashTable {
   // single partition.
   AggregationHashTable *BuildTableOverPartition(void *query_state, uint32_t partition_idx);
 
+  // -------------------------------------------------------
+  // Spilling
+  // -------------------------------------------------------
+
+  // The runs holding the on-disk part of an overflow partition
+  using SpilledRunList = std::vector<SpillRun>;
+
+  // Allocate the spilled run lists of all overflow partitions if unallocated
+  void AllocateSpillPartitions();
+
+  // Does the given overflow partition have entries on disk?
+  bool IsSpilled(uint32_t partition_idx) const {
+    return partition_spills_ != nullptr && !partition_spills_[partition_idx].empty();
+  }
+
+  // Do the entries of the overflow partitions that are in memory take up more
+  // than the memory budget?
+  bool OverflowExceedsBudget() const;
+
+  // Write overflow partitions to disk until the ones left in memory take up at
+  // most half of the memory budget, then compact the remaining entries. This
+  // moves entries, so it may only be called when the hash table is empty and
+  // nobody holds on to an entry.
+  void SpillOverflowPartitions();
+
+  // Read all entries of a spilled run back in batches. The consumer is called
+  // with a chain of entries that is only valid until it returns.
+  template <typename F>
+  void ReadSpilledEntries(const SpillRun &run, const F &consumer);
+
+  // Called during partitioned scan to build and scan the aggregates of an
+  // overflow partition that is partly or wholly on disk. Partitions that still
+  // have too many groups for the memory budget are split further.
+  void ScanSpilledPartition(void *query_state, void *thread_state, ScanPartitionFn scan_fn, HashTableEntry *chain,
+                            const SpilledRunList &runs, libcount::HLL *estimate, uint32_t level);
+
  private:
   // Memory allocator.
   MemoryPool *memory_;
@@ -330,6 +425,18 @@ class EXPORT AggregationHashTable {
   // The aggregation hash table over each partition. The array and each element
   // is allocated from the pool.
   AggregationHashTable **partition_tables_;
+  // The number of entries of each overflow partition that are in memory. The
+  // array is allocated from the pool.
+  uint64_t *partition_sizes_;
+  // The runs holding the on-disk entries of each overflow partition. The
+  // array is allocated from the pool when the table first spills.
+  SpilledRunList *partition_spills_;
+  // The files all spilled runs are in, including the ones taken over from
+  // thread-local tables.
+  MemPoolVector<std::unique_ptr<SpillFile>> spill_files_;
+  // Set by a flush that left the overflow partitions over the memory budget.
+  // The spill itself happens on the next partitioned insert.
+  bool spill_pending_;
   // The number of elements that can be inserted into the main hash table before
   // we flush into the overflow partitions. We size this so that the entries
   // are roughly L2-sized.
@@ -3,12 +3,45 @@
 #include <algorithm>
 #include <limits>
 
+#include "common/container/bitmap.h"
 #include "common/macros.h"
 #include "execution/sql/value.h"
 #include "execution/util/execution_common.h"
 
 namespace terrier::execution::sql {
 
+namespace detail {
+
+// Call fn(agg, val) for the aggregate at offset 'agg_offset' in the group
+// payload of every tuple in a batch, and the tuple's input value, skipping
+// NULL inputs. The input of the i-th tuple is at position sel[i] of 'vals'
+// and 'nulls', or at position i if 'sel' is NULL. 'nulls' is NULL if the input
+// doesn't have NULLs. Each case gets its own loop so the common ones are tight.
+template <typename Agg, typename T, typename F>
+ALWAYS_INLINE inline void AdvanceBatch(const uint32_t num_tuples, byte *const groups[], const std::size_t agg_offset,
+                                       const T vals[], const uint32_t sel[], const common::RawBitmap *const nulls,
+                                       const F &fn) {
+  const auto agg = [&](const uint32_t idx) { return reinterpret_cast<Agg *>(groups[idx] + agg_offset); };
+  if (sel == nullptr && nulls == nullptr) {
+    for (uint32_t idx = 0; idx < num_tuples; idx++) {
+      fn(agg(idx), vals[idx]);
+    }
+  } else if (nulls == nullptr) {
+    for (uint32_t idx = 0; idx < num_tuples; idx++) {
+      fn(agg(idx), vals[sel[idx]]);
+    }
+  } else {
+    for (uint32_t idx = 0; idx < num_tuples; idx++) {
+      const uint32_t pos = (sel == nullptr ? idx : sel[idx]);
+      if (nulls->Test(pos)) {
+        fn(agg(idx), vals[pos]);
+      }
+    }
+  }
+}
+
+}  // namespace detail
+
 // ---------------------------------------------------------
 // Count
 // ---------------------------------------------------------
@@ -33,6 +66,23 @@ class CountAggregate {
    */
   void Advance(const Val &val) { count_ += static_cast<uint64_t>(!val.is_null_); }
 
+  /**
+   * Advance the count of the group of every tuple in a batch by the
+   * NULL-ness of the tuple's input value.
+   * @param num_tuples The number of tuples in the batch.
+   * @param groups The group payload of every tuple.
+   * @param agg_offset The offset of the aggregate in the group payloads.
+   * @param sel The position of every tuple's input, or nullptr if the i-th tuple is at position i.
+   * @param nulls The NULL bitmap of the input, where a set bit means not NULL, or nullptr if there are no NULLs.
+   */
+  static void AdvanceBatch(const uint32_t num_tuples, byte *const groups[], const std::size_t agg_offset,
+                           const uint32_t sel[], const common::RawBitmap *const nulls) {
+    for (uint32_t idx = 0; idx < num_tuples; idx++) {
+      auto *count = reinterpret_cast<CountAggregate *>(groups[idx] + agg_offset);
+      count->count_ += static_cast<uint64_t>(nulls == nullptr || nulls->Test(sel == nullptr ? idx : sel[idx]));
+    }
+  }
+
   /**
    * Merge this count with the @em that count.
    */
@@ -76,6 +126,18 @@ class CountStarAggregate {
    */
   void Advance(UNUSED_ATTRIBUTE const Val &val) { count_++; }
 
+  /**
+   * Advance the count of the group of every tuple in a batch by one.
+   * @param num_tuples The number of tuples in the batch.
+   * @param groups The group payload of every tuple.
+   * @param agg_offset The offset of the aggregate in the group payloads.
+   */
+  static void AdvanceBatch(const uint32_t num_tuples, byte *const groups[], const std::size_t agg_offset) {
+    for (uint32_t idx = 0; idx < num_tuples; idx++) {
+      reinterpret_cast<CountStarAggregate *>(groups[idx] + agg_offset)->count_++;
+    }
+  }
+
   /**
    * Merge this count with the @em that count.
    */
@@ -128,6 +190,27 @@ class IntegerSumAggregate {
     sum_ += val.val_;
   }
 
+  /**
+   * Advance the sum of the group of every tuple in a batch by the tuple's input
+   * value, skipping NULLs.
+   * @tparam T The type of the input values.
+   * @param num_tuples The number of tuples in the batch.
+   * @param groups The group payload of every tuple.
+   * @param agg_offset The offset of the aggregate in the group payloads.
+   * @param vals The input values.
+   * @param sel The position of every tuple's input, or nullptr if the i-th tuple is at position i.
+   * @param nulls The NULL bitmap of the input, where a set bit means not NULL, or nullptr if there are no NULLs.
+   */
+  template <typename T>
+  static void AdvanceBatch(const uint32_t num_tuples, byte *const groups[], const std::size_t agg_offset,
+                           const T vals[], const uint32_t sel[], const common::RawBitmap *const nulls) {
+    const auto advance = [](IntegerSumAggregate *agg, const T val) {
+      agg->null_ = false;
+      agg->sum_ += static_cast<int64_t>(val);
+    };
+    detail::AdvanceBatch<IntegerSumAggregate>(num_tuples, groups, agg_offset, vals, sel, nulls, advance);
+  }
+
   /**
    * Merge a partial sum aggregate into this aggregate.
    */
@@ -187,6 +270,27 @@ class RealSumAggregate {
     sum_ += val.val_;
   }
 
+  /**
+   * Advance the sum of the group of every tuple in a batch by the tuple's input
+   * value, skipping NULLs.
+   * @tparam T The type of the input values.
+   * @param num_tuples The number of tuples in the batch.
+   * @param groups The group payload of every tuple.
+   * @param agg_offset The offset of the aggregate in the group payloads.
+   * @param vals The input values.
+   * @param sel The position of every tuple's input, or nullptr if the i-th tuple is at position i.
+   * @param nulls The NULL bitmap of the input, where a set bit means not NULL, or nullptr if there are no NULLs.
+   */
+  template <typename T>
+  static void AdvanceBatch(const uint32_t num_tuples, byte *const groups[], const std::size_t agg_offset,
+                           const T vals[], const uint32_t sel[], const common::RawBitmap *const nulls) {
+    const auto advance = [](RealSumAggregate *agg, const T val) {
+      agg->null_ = false;
+      agg->sum_ += static_cast<double>(val);
+    };
+    detail::AdvanceBatch<RealSumAggregate>(num_tuples, groups, agg_offset, vals, sel, nulls, advance);
+  }
+
   /**
    * Merge a partial real-typed summation into this aggregate.
    */
@@ -495,6 +599,27 @@ class AvgAggregate {
     count_++;
   }
 
+  /**
+   * Advance the average of the group of every tuple in a batch by the tuple's input
+   * value, skipping NULLs.
+   * @tparam T The type of the input values.
+   * @param num_tuples The number of tuples in the batch.
+   * @param groups The group payload of every tuple.
+   * @param agg_offset The offset of the aggregate in the group payloads.
+   * @param vals The input values.
+   * @param sel The position of every tuple's input, or nullptr if the i-th tuple is at position i.
+   * @param nulls The NULL bitmap of the input, where a set bit means not NULL, or nullptr if there are no NULLs.
+   */
+  template <typename T>
+  static void AdvanceBatch(const uint32_t num_tuples, byte *const groups[], const std::size_t agg_offset,
+                           const T vals[], const uint32_t sel[], const common::RawBitmap *const nulls) {
+    const auto advance = [](AvgAggregate *agg, const T val) {
+      agg->sum_ += static_cast<double>(val);
+      agg->count_++;
+    };
+    detail::AdvanceBatch<AvgAggregate>(num_tuples, groups, agg_offset, vals, sel, nulls, advance);
+  }
+
   /**
    * Merge a partial average aggregate into this aggregate.
    */
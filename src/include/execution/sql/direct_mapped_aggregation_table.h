@@ -0,0 +1,215 @@
+#pragma once
+
+#include <cstdint>
+
+#include "common/macros.h"
+#include "execution/sql/memory_pool.h"
+#include "execution/sql/projected_columns_iterator.h"
+#include "execution/util/bit_util.h"
+#include "execution/util/execution_common.h"
+
+namespace terrier::execution::sql {
+
+// Forward declare
+class DirectMappedAggregationTableIterator;
+class ThreadStateContainer;
+
+/**
+ * An aggregation table for groups keyed by a single integer column whose values are known to lie in a small domain
+ * [min_key, max_key], e.g., from column statistics. Every key in the domain has a slot in a dense array of group
+ * payloads at (key - min_key), so groups are found without hashing, bucket chains or key comparisons. Group payloads
+ * have the same layout as in an AggregationHashTable, so the same aggregates and batch kernels work on both.
+ *
+ * Thread-local tables over the same domain are merged into a global table slot by slot, with disjoint ranges of slots
+ * merged in parallel.
+ */
+class EXPORT DirectMappedAggregationTable {
+ public:
+  /**
+   * The largest number of keys in the domain of a direct-mapped table. Larger domains should be aggregated in an
+   * AggregationHashTable, since most of their slots would likely be empty.
+   */
+  static constexpr uint64_t K_MAX_DOMAIN_SIZE = 64 * 1024;
+
+  /**
+   * Function to initialize the aggregates of a new group. The group's key is already written.
+   * Convention: The argument is the payload of the new group.
+   */
+  using InitGroupFn = void (*)(void *);
+
+  /**
+   * Function to merge a partial group into the group with the same key.
+   * Convention: First argument is the group to merge into, second argument is the partial group.
+   */
+  using MergeGroupFn = void (*)(void *, const void *);
+
+  /**
+   * Can groups with keys in the domain [min_key, max_key] be aggregated in a direct-mapped table?
+   * @param min_key The smallest possible key
+   * @param max_key The largest possible key
+   * @return True if the domain has at most K_MAX_DOMAIN_SIZE keys; false otherwise
+   */
+  static bool IsDomainSmallEnough(const int64_t min_key, const int64_t max_key) noexcept {
+    return min_key <= max_key && static_cast<uint64_t>(max_key) - static_cast<uint64_t>(min_key) < K_MAX_DOMAIN_SIZE;
+  }
+
+  /**
+   * Construct a table for groups with keys in the domain [min_key, max_key]
+   * @param memory The memory pool to allocate the slots from
+   * @param payload_size The size of the payload of a group
+   * @param min_key The smallest possible key
+   * @param max_key The largest possible key
+   */
+  DirectMappedAggregationTable(MemoryPool *memory, std::size_t payload_size, int64_t min_key, int64_t max_key);
+
+  /**
+   * This class cannot be copied or moved
+   */
+  DISALLOW_COPY_AND_MOVE(DirectMappedAggregationTable);
+
+  /**
+   * Destructor
+   */
+  ~DirectMappedAggregationTable();
+
+  /**
+   * @param key A key
+   * @return True if the key is in the domain of the table, i.e., has a slot; false otherwise
+   */
+  bool InDomain(const int64_t key) const noexcept {
+    return key >= min_key_ && static_cast<uint64_t>(key) - static_cast<uint64_t>(min_key_) < num_slots_;
+  }
+
+  /**
+   * Lookup the group with key @em key
+   * @param key The key of the group. It must be in the domain of the table.
+   * @return The payload of the group, or nullptr if there isn't one yet
+   */
+  byte *Lookup(const int64_t key) const {
+    const uint64_t slot = SlotOf(key);
+    return util::BitUtil::Test(occupied_, static_cast<uint32_t>(slot)) ? PayloadAt(slot) : nullptr;
+  }
+
+  /**
+   * Create the group with key @em key, which must not exist yet
+   * @param key The key of the group. It must be in the domain of the table.
+   * @return The payload of the new group, for the caller to initialize
+   */
+  byte *Insert(int64_t key);
+
+  /**
+   * Find the group of every selected tuple in an input vector, creating the groups that don't exist yet. This mirrors
+   * @em AggregationHashTable::LookupOrCreateGroups(). New groups are initialized, but not yet advanced by the tuple
+   * that created them.
+   * @tparam KeyType The type of the grouping column. It must not be NULL, and all its values must be in the domain of
+   *                 the table.
+   * @param iter The input vector
+   * @param key_col_idx The index of the grouping column in the input vector
+   * @param key_offset The offset of the key in the payload of a group
+   * @param init_group_fn Function to initialize the aggregates of a new group
+   * @param[out] groups The payload of the group of every selected tuple
+   */
+  template <typename KeyType>
+  void LookupOrCreateGroups(const ProjectedColumnsIterator *iter, uint32_t key_col_idx, std::size_t key_offset,
+                            InitGroupFn init_group_fn, byte *groups[]);
+
+  /**
+   * Merge the thread-local tables in the given container into this table, in parallel. All tables must have the same
+   * domain and payload size as this one.
+   * @param thread_states The container for all thread-local tables
+   * @param table_offset The offset in the state where the table is
+   * @param merge_group_fn Function to merge a partial group into an existing one
+   */
+  void MergeParallel(const ThreadStateContainer *thread_states, std::size_t table_offset,
+                     MergeGroupFn merge_group_fn);
+
+  /**
+   * @return The number of groups in the table
+   */
+  uint64_t NumGroups() const noexcept { return num_groups_; }
+
+  /**
+   * @return The number of keys in the domain of the table
+   */
+  uint64_t NumSlots() const noexcept { return num_slots_; }
+
+ private:
+  friend class DirectMappedAggregationTableIterator;
+
+  // The slot of the group with the given key
+  uint64_t SlotOf(const int64_t key) const noexcept {
+    TERRIER_ASSERT(InDomain(key), "Key is outside of the table's domain");
+    return static_cast<uint64_t>(key - min_key_);
+  }
+
+  // The payload in the given slot
+  byte *PayloadAt(const uint64_t slot) const noexcept { return payloads_ + slot * payload_size_; }
+
+  // Merge all groups in the given range of slots of the source table into
+  // this one. The range covers whole words of the occupancy bitmap.
+  void MergeSlots(const DirectMappedAggregationTable &source, uint64_t begin_word, uint64_t end_word,
+                  MergeGroupFn merge_group_fn);
+
+ private:
+  // Where the slots are allocated from
+  MemoryPool *memory_;
+  // The size of each slot, i.e., of a group payload
+  std::size_t payload_size_;
+  // The smallest key in the domain, whose group is in the first slot
+  int64_t min_key_;
+  // The number of slots, i.e., of keys in the domain
+  uint64_t num_slots_;
+  // The group payloads
+  byte *payloads_;
+  // A bitmap with the slots that have a group
+  uint32_t *occupied_;
+  // The number of groups
+  uint64_t num_groups_;
+};
+
+/**
+ * An iterator over the groups of a direct-mapped aggregation table, in key order
+ */
+class EXPORT DirectMappedAggregationTableIterator {
+ public:
+  /**
+   * Construct an iterator over the given table
+   * @param table The table to iterate over
+   */
+  explicit DirectMappedAggregationTableIterator(const DirectMappedAggregationTable &table) : table_(table), slot_(0) {
+    SkipEmptySlots();
+  }
+
+  /**
+   * Does this iterator have more groups?
+   */
+  bool HasNext() const { return slot_ < table_.num_slots_; }
+
+  /**
+   * Move to the next group
+   */
+  void Next() {
+    slot_++;
+    SkipEmptySlots();
+  }
+
+  /**
+   * Return the payload of the current group
+   */
+  const byte *GetCurrentAggregateRow() const { return table_.PayloadAt(slot_); }
+
+ private:
+  void SkipEmptySlots() {
+    while (slot_ < table_.num_slots_ && !util::BitUtil::Test(table_.occupied_, static_cast<uint32_t>(slot_))) {
+      slot_++;
+    }
+  }
+
+ private:
+  // The table being iterated
+  const DirectMappedAggregationTable &table_;
+  // The current slot
+  uint64_t slot_;
+};
+
+}  // namespace terrier::execution::sql
@@ -14,7 +14,10 @@ class ProjectedColumnsIterator;
 
 /**
  * An adaptive filter manager that tries to discover the optimal filter
- * configuration.
+ * configuration. Within a clause, a bandit agent picks the flavor to run.
+ * Across the clauses of the conjunction, the manager tracks the cost and
+ * selectivity of every clause and periodically reorders the clauses so that
+ * cheap and selective ones run first.
  */
 class EXPORT FilterManager {
  public:
@@ -24,6 +27,18 @@ class EXPORT FilterManager {
    */
   using MatchFn = uint32_t (*)(ProjectedColumnsIterator *);
 
+  /**
+   * The number of vectors after which the statistics of all clauses are
+   * resampled and the clauses are reordered
+   */
+  static constexpr uint32_t K_RESAMPLE_INTERVAL = 64;
+
+  /**
+   * The weight of a new measurement in the moving averages of the cost and
+   * selectivity of a clause
+   */
+  static constexpr double K_STATS_WEIGHT = 0.25;
+
   /**
    * A clause in a multi-clause filter. Clauses come in multiple flavors.
    * Flavors are logically equivalent, but may differ in implementation, and
@@ -87,10 +102,29 @@ class EXPORT FilterManager {
    */
   uint32_t GetOptimalFlavorForClause(uint32_t clause_index) const;
 
+  /**
+   * Return the order the clauses currently run in, as indexes of the clauses
+   * in the order they were inserted
+   */
+  const std::vector<uint32_t> &GetOptimalClauseOrder() const { return optimal_clause_order_; }
+
  private:
-  // Run a specific clause of the filter
+  // The measured statistics of a clause, as moving averages
+  struct ClauseStats {
+    // The execution time per input tuple, in milliseconds
+    double cost_per_tuple_{0.0};
+    // The fraction of input tuples that pass the clause
+    double selectivity_{1.0};
+    // Has the clause been measured yet?
+    bool sampled_{false};
+  };
+
+  // Run a specific clause of the filter and update its statistics
   void RunFilterClause(ProjectedColumnsIterator *pci, uint32_t clause_index);
 
+  // Reorder the clauses by their measured statistics
+  void ReorderClauses();
+
   // Run the given matching function
   std::pair<uint32_t, double> RunFilterClauseImpl(ProjectedColumnsIterator *pci, FilterManager::MatchFn func);
 
@@ -110,6 +144,10 @@ class EXPORT FilterManager {
   std::unique_ptr<bandit::Policy> policy_;
   // The agents, one per clause
   std::vector<bandit::Agent> agents_;
+  // The statistics, one per clause
+  std::vector<ClauseStats> clause_stats_;
+  // The number of vectors filtered so far
+  uint64_t num_runs_{0};
   // Has the manager's clauses been finalized?
   bool finalized_{false};
 };
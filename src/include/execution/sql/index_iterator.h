@@ -5,9 +5,12 @@
 #include "catalog/catalog_defs.h"
 #include "execution/exec/execution_context.h"
 #include "execution/sql/projected_columns_iterator.h"
+#include "storage/index/index.h"
 #include "storage/storage_defs.h"
 
 namespace terrier::execution::sql {
+class ThreadStateContainer;
+
 /**
  * Allows iteration for indices from TPL.
  */
@@ -39,6 +42,37 @@ class EXPORT IndexIterator {
    */
   void ScanKey();
 
+  /**
+   * Wrapper around the index's ScanAscending, scanning from the key to the high key
+   */
+  void ScanAscending();
+
+  /**
+   * Scan function callback used to scan a sub-range of the index.
+   * Convention: First argument is the opaque query state, second argument is
+   *             the thread state, and last argument is an index iterator
+   *             positioned at the start of the sub-range. The first two
+   *             arguments are void because their types are only known at
+   *             runtime (i.e., defined in generated code).
+   */
+  using ScanFn = void (*)(void *, void *, IndexIterator *iter);
+
+  /**
+   * Perform a parallel ascending scan from the key to the high key. The range is
+   * split into at most @em num_partitions sub-ranges using the index's inner
+   * separators, and each sub-range is handed to @em scan_fn on its own
+   * iterator. This call is blocking, meaning that it only returns after the
+   * whole range has been scanned. The order of the sub-ranges is
+   * non-deterministic, but every sub-range is in ascending key order.
+   * @param query_state the query state
+   * @param thread_states the thread state container
+   * @param scan_fn The callback function invoked for each sub-range
+   * @param num_partitions The maximum number of sub-ranges to split the scan into
+   * @return True if the scan ran; false otherwise
+   */
+  bool ParallelScanAscending(void *query_state, ThreadStateContainer *thread_states, ScanFn scan_fn,
+                             uint32_t num_partitions);
+
   /**
    * Advances the iterator. Return true if successful
    * @return whether the iterator was advanced or not.
@@ -83,8 +117,38 @@ class EXPORT IndexIterator {
     }
   }
 
+  /**
+   * Sets the high key value at the given index, used as the end of range scans
+   * @tparam T type of value
+   * @param col_idx index of the key
+   * @param value value to write
+   * @param null whether the value is null
+   */
+  template <typename T, bool Nullable>
+  void SetHighKey(uint16_t col_idx, T value, bool null) {
+    if constexpr (Nullable) {
+      if (null) {
+        hi_index_pr_->SetNull(static_cast<uint16_t>(col_idx));
+      } else {
+        *reinterpret_cast<T *>(hi_index_pr_->AccessForceNotNull(col_idx)) = value;
+      }
+    } else {  // NOLINT
+      *reinterpret_cast<T *>(hi_index_pr_->AccessForceNotNull(col_idx)) = value;
+    }
+  }
+
  private:
+  // Create an iterator over an index and table that were already looked up in the catalog
+  IndexIterator(exec::ExecutionContext *exec_ctx, catalog::table_oid_t table_oid, catalog::index_oid_t index_oid,
+                std::vector<catalog::col_oid_t> col_oids, common::ManagedPointer<storage::index::Index> index,
+                common::ManagedPointer<storage::SqlTable> table);
+
+  // Scan one of the sub-ranges of a parallel scan
+  void ScanPartition(const storage::index::IndexRangePartitions &partitions, uint32_t partition);
+
   exec::ExecutionContext *exec_ctx_;
+  const catalog::table_oid_t table_oid_;
+  const catalog::index_oid_t index_oid_;
   std::vector<catalog::col_oid_t> col_oids_;
   common::ManagedPointer<storage::index::Index> index_;
   common::ManagedPointer<storage::SqlTable> table_;
@@ -92,7 +156,9 @@ class EXPORT IndexIterator {
   uint32_t curr_index_ = 0;
   void *index_buffer_;
   void *table_buffer_;
+  void *hi_index_buffer_;
   storage::ProjectedRow *index_pr_;
+  storage::ProjectedRow *hi_index_pr_;
   storage::ProjectedRow *table_pr_;
   std::vector<storage::TupleSlot> tuples_{};
 };
@@ -9,6 +9,7 @@
 #include "execution/sql/concise_hash_table.h"
 #include "execution/sql/generic_hash_table.h"
 #include "execution/sql/memory_pool.h"
+#include "execution/sql/spill_file.h"
 #include "execution/util/chunked_vector.h"
 
 namespace libcount {
@@ -28,6 +29,24 @@ class JoinHashTableIterator;
  * The main join hash table. Join hash tables are bulk-loaded through calls to
  * @em AllocInputTuple() and frozen after calling @em Build(). Thus, they're
  * write-once read-many (WORM) structures.
+ *
+ * If spilling was enabled with @em EnableSpilling() and the memory pool has a
+ * memory budget, the table runs a hybrid hash join. Build tuples are
+ * radix-partitioned on the high bits of their hash. When the buffered tuples
+ * exceed the budget, whole partitions are written to a spill file, and every
+ * later build tuple of those partitions follows them. Only the partitions in
+ * memory are indexed by @em Build(). Probes of spilled partitions, identified
+ * by @em IsSpilled(), are written to disk with @em DeferProbeTuple(), and
+ * joined with their build partition one partition at a time by
+ * @em JoinSpilledPartitions() after the probe side is done. A partition that
+ * still exceeds the budget when it's read back is partitioned again on the
+ * next bits of the hash.
+ *
+ * A parallel build whose tuples don't fit in cache is radix-partitioned: the
+ * tuples of all thread-local tables are scattered into partitions on a few
+ * hash bits, and every partition gets a table of its own, small enough to be
+ * built in cache and independently of the others. Lookups route to the
+ * partition's table.
  */
 class EXPORT JoinHashTable {
  public:
@@ -36,6 +55,55 @@ class EXPORT JoinHashTable {
    */
   static constexpr uint32_t K_DEFAULT_HLL_PRECISION = 10;
 
+  /**
+   * Number of hash bits used to radix-partition tuples for spilling
+   */
+  static constexpr uint32_t K_SPILL_PARTITION_BITS = 6;
+
+  /**
+   * Number of spill partitions
+   */
+  static constexpr uint32_t K_NUM_SPILL_PARTITIONS = 1u << K_SPILL_PARTITION_BITS;
+
+  /**
+   * Number of times a spilled partition may be partitioned again. Partitions
+   * at the last level are loaded whole, since their tuples share so many hash
+   * bits that they are most likely duplicates of a few keys.
+   */
+  static constexpr uint32_t K_MAX_SPILL_LEVELS = 4;
+
+  /**
+   * Bytes buffered for each spill partition before they are written out. Wider tuples are written out directly.
+   */
+  static constexpr uint32_t K_SPILL_STAGING_SIZE = 16 * common::Constants::KB;
+
+  /**
+   * Bytes read back from a spill file at a time
+   */
+  static constexpr uint32_t K_SPILL_READ_BATCH_SIZE = 64 * common::Constants::KB;
+
+  /**
+   * Maximum number of hash bits used to radix-partition a parallel build
+   */
+  static constexpr uint32_t K_MAX_BUILD_PARTITION_BITS = 8;
+
+  /**
+   * Minimum number of tuples in a partition of a partitioned build. Directories
+   * of smaller partitions would be smaller than a huge page, and the page
+   * faults of allocating hundreds of them outweigh their better cache fit.
+   */
+  static constexpr uint64_t K_MIN_BUILD_PARTITION_TUPLES = 128 * 1024;
+
+  /**
+   * Function called by @em JoinSpilledPartitions() to probe a deferred probe
+   * tuple.
+   * Convention: First argument is the opaque context provided by the caller,
+   *             the second is the join hash table over the probe tuple's build
+   *             partition, the third is the hash of the probe tuple, and the
+   *             fourth is the probe tuple.
+   */
+  using SpilledProbeFn = void (*)(void *, const JoinHashTable *, hash_t, const byte *);
+
   /**
    * Construct a join hash table. All memory allocations are sourced from the
    * injected @em memory, and thus, are ephemeral.
@@ -91,28 +159,117 @@ class EXPORT JoinHashTable {
 
   /**
    * Merge all thread-local hash tables stored in the state contained into this
-   * table. Perform the merge in parallel.
+   * table, and build it. Perform the merge in parallel. If the tuples don't fit
+   * in cache, or the table is concise, the build is radix-partitioned.
    * @param thread_state_container The container for all thread-local tables
    * @param jht_offset The offset in the state where the hash table is
    */
   void MergeParallel(const ThreadStateContainer *thread_state_container, uint32_t jht_offset);
 
+  /**
+   * Enable or disable the radix-partitioned build of @em MergeParallel(). It's
+   * enabled by default. When disabled, all tuples are inserted into one shared
+   * generic table concurrently.
+   * @param enabled Whether a parallel build may be radix-partitioned
+   */
+  void SetPartitionedBuild(const bool enabled) noexcept { partitioned_build_ = enabled; }
+
+  /**
+   * Let the table spill build partitions to disk once the buffered tuples
+   * exceed the memory budget of its pool. Nothing is spilled if the pool has
+   * no budget. Only callers that defer the probes of spilled partitions with
+   * @em DeferProbeTuple() and finish with @em JoinSpilledPartitions() may
+   * enable it, since lookups don't find the tuples of spilled partitions. Must
+   * be called before any tuple is inserted, on this table and on all
+   * thread-local tables merged into it.
+   */
+  void EnableSpilling();
+
+  /**
+   * Is the build partition of hash value @em hash on disk? Lookups of such
+   * hashes don't find anything. Their probe tuples must be deferred with
+   * @em DeferProbeTuple() instead.
+   * @param hash The hash value of the probe tuple
+   * @return True if the partition was spilled; false otherwise
+   */
+  bool IsSpilled(const hash_t hash) const noexcept {
+    return ((spilled_partitions_ >> SpillPartitionOf(hash)) & 1u) != 0;
+  }
+
+  /**
+   * Does this table have any build partitions on disk?
+   */
+  bool HasSpilledPartitions() const noexcept { return spilled_partitions_ != 0; }
+
+  /**
+   * Write a probe tuple whose build partition is on disk to disk, to be joined
+   * later by @em JoinSpilledPartitions(). Safe to call from multiple threads.
+   * @param hash The hash value of the probe tuple
+   * @param probe_tuple The probe tuple, which is copied
+   * @param probe_tuple_size The size of the probe tuple, the same for all calls
+   */
+  void DeferProbeTuple(hash_t hash, const byte *probe_tuple, uint32_t probe_tuple_size);
+
+  /**
+   * Build a Bloom filter over the hashes of all build tuples, to be pushed into the scans feeding the probe side as
+   * RuntimeFilters. Must be called by a single thread once the table is built, and before it is probed, e.g., in the
+   * finish steps of the build pipeline. Later calls return the same filter.
+   * @return The Bloom filter, or nullptr if build partitions were spilled, since all probe tuples of spilled partitions
+   *         must reach @em DeferProbeTuple()
+   */
+  const BloomFilter *BuildBloomFilter();
+
+  /**
+   * @return The Bloom filter built by @em BuildBloomFilter(), or nullptr if there is none. Safe to call from multiple
+   *         threads.
+   */
+  const BloomFilter *GetBloomFilter() const { return has_bloom_filter_ ? &bloom_filter_ : nullptr; }
+
+  /**
+   * Join every spilled build partition with the probe tuples deferred for it.
+   * The partitions are processed one at a time: the build tuples of the
+   * partition are read back into a new join hash table, and @em probe_fn is
+   * called for every deferred probe tuple of the partition to look it up. The
+   * new table spills too if the partition exceeds the budget, and its spilled
+   * partitions are joined recursively. Should be called once the probe side
+   * has been fully consumed.
+   * @param ctx An opaque context passed to the probe function
+   * @param probe_fn The function to probe a deferred tuple
+   */
+  void JoinSpilledPartitions(void *ctx, SpilledProbeFn probe_fn);
+
   // -------------------------------------------------------
   // Accessors
   // -------------------------------------------------------
 
   /**
-   * Return the amount of memory the buffered tuples occupy
+   * Return the amount of memory the buffered tuples occupy, including tuples
+   * taken over from other tables and tuples staged for spilling
    */
-  uint64_t GetBufferedTupleMemoryUsage() const noexcept { return entries_.size() * entries_.ElementSize(); }
+  uint64_t GetBufferedTupleMemoryUsage() const noexcept {
+    uint64_t num_entries = entries_.size();
+    for (const auto &owned : owned_) {
+      num_entries += owned.size();
+    }
+    const uint64_t staging_size = staging_ != nullptr ? K_NUM_SPILL_PARTITIONS * K_SPILL_STAGING_SIZE : 0;
+    uint64_t partition_size = 0;
+    for (uint32_t part_idx = 0; partition_tables_ != nullptr && part_idx < num_build_partitions_; part_idx++) {
+      partition_size += partition_tables_[part_idx]->GetBufferedTupleMemoryUsage();
+    }
+    return num_entries * entries_.ElementSize() + staging_size + partition_size;
+  }
 
   /**
    * Get the amount of memory used by the join index only (i.e., excluding space
    * used to store materialized build-side tuples)
    */
   uint64_t GetJoinIndexMemoryUsage() const noexcept {
-    return UseConciseHashTable() ? concise_hash_table_.GetTotalMemoryUsage()
-                                 : generic_hash_table_.GetTotalMemoryUsage();
+    uint64_t partition_size = 0;
+    for (uint32_t part_idx = 0; partition_tables_ != nullptr && part_idx < num_build_partitions_; part_idx++) {
+      partition_size += partition_tables_[part_idx]->GetJoinIndexMemoryUsage();
+    }
+    return partition_size + (UseConciseHashTable() ? concise_hash_table_.GetTotalMemoryUsage()
+                                                   : generic_hash_table_.GetTotalMemoryUsage());
   }
 
   /**
@@ -120,6 +277,17 @@ class EXPORT JoinHashTable {
    */
   uint64_t GetTotalMemoryUsage() const noexcept { return GetBufferedTupleMemoryUsage() + GetJoinIndexMemoryUsage(); }
 
+  /**
+   * Return the number of bytes written to disk by spilling
+   */
+  uint64_t GetSpilledBytes() const noexcept {
+    uint64_t bytes = 0;
+    for (const auto &file : spill_files_) {
+      bytes += file->Size();
+    }
+    return bytes;
+  }
+
   /**
    * Return the total number of inserted elements, including duplicates
    */
@@ -181,11 +349,48 @@ class EXPORT JoinHashTable {
   void LookupBatchInConciseHashTableInternal(uint32_t num_tuples, const hash_t hashes[],
                                              const HashTableEntry *results[]) const;
 
+  // Dispatched from LookupBatch() to lookup from the tables of a partitioned
+  // build
+  void LookupBatchInPartitions(uint32_t num_tuples, const hash_t hashes[], const HashTableEntry *results[]) const;
+
   // Merge the source hash table (which isn't built yet) into this one
   template <bool Prefetch, bool Concurrent>
   void MergeIncomplete(JoinHashTable *source);
 
+  // The spill partition of a hash value. Every spill level uses the hash bits
+  // right below the ones of the level above.
+  uint32_t SpillPartitionOf(const hash_t hash) const noexcept {
+    const uint32_t shift = sizeof(hash_t) * 8 - (spill_level_ + 1) * K_SPILL_PARTITION_BITS;
+    return static_cast<uint32_t>((hash >> shift) & (K_NUM_SPILL_PARTITIONS - 1));
+  }
+
+  // Called when the buffered build tuples exceed the budget. Spills the
+  // partitions that are already on disk and the largest ones, until the
+  // tuples left in memory fit in half of the budget.
+  void SpillLargestPartitions();
+
+  // Write the buffered build tuples of the partitions in the bit mask to disk,
+  // and compact the remaining ones. The partitions stay spilled.
+  void SpillPartitions(uint64_t partitions);
+
+  // Write the staged data of a partition to the given spill file as a run
+  void WriteStagedRun(uint32_t part_idx, SpillFile *file, std::vector<SpillRun> *runs);
+
+  // The build partition of a hash value. These are the hash bits right below
+  // the spill partition bits, so that every build partition gets tuples from
+  // all spill partitions left in memory.
+  uint32_t BuildPartitionOf(const hash_t hash) const noexcept {
+    return static_cast<uint32_t>((hash >> build_partition_shift_) & build_partition_mask_);
+  }
+
+  // Scatter the tuples of all thread-local tables into radix partitions, and
+  // build a table for each partition, in parallel
+  void MergeParallelPartitioned(const std::vector<JoinHashTable *> &tl_join_tables, uint64_t num_tuples);
+
  private:
+  // The memory pool
+  MemoryPool *memory_;
+
   // The vector where we store the build-side input
   util::ChunkedVector<MemoryPoolAllocator<byte>> entries_;
 
@@ -200,8 +405,9 @@ class EXPORT JoinHashTable {
   // The concise hash table
   ConciseHashTable concise_hash_table_;
 
-  // The bloom filter
+  // The bloom filter over the build keys, and whether it has been built
   BloomFilter bloom_filter_;
+  bool has_bloom_filter_;
 
   // Estimator of unique elements
   std::unique_ptr<libcount::HLL> hll_estimator_;
@@ -211,6 +417,51 @@ class EXPORT JoinHashTable {
 
   // Should we use a concise hash table?
   bool use_concise_ht_;
+
+  // -------------------------------------------------------
+  // Spilling
+  // -------------------------------------------------------
+
+  // The number of buffered build tuples that triggers a spill
+  uint64_t max_buffered_tuples_;
+  // The number of partitioning passes the tuples went through before this
+  // table, zero unless it joins a spilled partition of another table
+  uint32_t spill_level_;
+  // The number of buffered build tuples in each spill partition
+  uint64_t partition_sizes_[K_NUM_SPILL_PARTITIONS];
+  // Bit mask of the spilled partitions
+  uint64_t spilled_partitions_;
+  // The build and probe runs of every spilled partition
+  std::vector<SpillRun> build_runs_[K_NUM_SPILL_PARTITIONS];
+  std::vector<SpillRun> probe_runs_[K_NUM_SPILL_PARTITIONS];
+  // The files all spilled runs are in, including the ones taken over from
+  // thread-local tables
+  MemPoolVector<std::unique_ptr<SpillFile>> spill_files_;
+  // The file deferred probe tuples are written to
+  SpillFile *probe_file_;
+  // The size of deferred probe tuples
+  uint32_t probe_tuple_size_;
+  // Per-partition staging buffers for spilled build tuples and deferred probe
+  // tuples, allocated from the pool when first needed
+  byte *staging_;
+  uint32_t staged_bytes_[K_NUM_SPILL_PARTITIONS];
+  // Protects deferring probe tuples
+  common::SpinLatch probe_latch_;
+
+  // -------------------------------------------------------
+  // Radix-partitioned build
+  // -------------------------------------------------------
+
+  // Can a parallel build be partitioned?
+  bool partitioned_build_;
+  // The number of build partitions, and the shift and mask that extract the
+  // partition from a hash value
+  uint32_t num_build_partitions_;
+  uint32_t build_partition_shift_;
+  uint64_t build_partition_mask_;
+  // The table of every build partition, or nullptr if the build wasn't
+  // partitioned
+  JoinHashTable **partition_tables_;
 };
 
 /**
@@ -263,6 +514,9 @@ class EXPORT JoinHashTableIterator {
  */
 template <>
 inline JoinHashTableIterator JoinHashTable::Lookup<false>(const hash_t hash) const {
+  if (partition_tables_ != nullptr) {
+    return partition_tables_[BuildPartitionOf(hash)]->Lookup<false>(hash);
+  }
   HashTableEntry *entry = generic_hash_table_.FindChainHead(hash);
   while (entry != nullptr && entry->hash_ != hash) {
     entry = entry->next_;
@@ -275,6 +529,9 @@ inline JoinHashTableIterator JoinHashTable::Lookup<false>(const hash_t hash) con
  */
 template <>
 inline JoinHashTableIterator JoinHashTable::Lookup<true>(const hash_t hash) const {
+  if (partition_tables_ != nullptr) {
+    return partition_tables_[BuildPartitionOf(hash)]->Lookup<true>(hash);
+  }
   // NOLINTNEXTLINE
   const auto [found, idx] = concise_hash_table_.Lookup(hash);
   auto *entry = (found ? EntryAt(idx) : nullptr);
@@ -13,7 +13,15 @@ namespace terrier::execution::sql {
 class MemoryTracker;
 
 /**
- * A memory pool
+ * A memory pool, holding the runtime state of a query. Small and medium allocations, such as the chunks of
+ * ChunkedVectors and sort buffers, are carved from slabs by a per-thread arena: every allocation is rounded up to one
+ * of a few size classes, and freed blocks are kept for the next allocation of their class. When the pool is destroyed,
+ * all its slabs are released in one go to a cache shared by all pools, so the next query reuses them rather than going
+ * back to the system allocator. Allocations of at least a huge page are mapped and backed by huge pages.
+ *
+ * Arena blocks are aligned to a cache line. Small allocations needing a larger alignment are served by the system
+ * allocator instead. Memory must be freed with the size it was allocated with, which debug builds check, and blocks
+ * before the pool is destroyed.
  */
 class EXPORT MemoryPool {
  public:
@@ -28,6 +36,11 @@ class EXPORT MemoryPool {
    */
   DISALLOW_COPY_AND_MOVE(MemoryPool);
 
+  /**
+   * Destructor. Releases the pool's slabs, and with them all arena blocks that weren't freed.
+   */
+  ~MemoryPool();
+
   /**
    * Allocate @em size bytes of memory from this pool.
    * @param size The number of bytes to allocate.
@@ -106,10 +119,36 @@ class EXPORT MemoryPool {
    */
   MemoryTracker *GetTracker() { return tracker_; }
 
+  /**
+   * Set the number of bytes that operators allocating from this pool should try to keep in memory. Operators that
+   * can spill (e.g., partitioned aggregations) write data to disk once they exceed it.
+   * @param budget The budget in bytes, or zero for no limit.
+   */
+  void SetMemoryBudget(std::size_t budget) { budget_ = budget; }
+
+  /**
+   * @return The memory budget in bytes, or zero if there is no limit.
+   */
+  std::size_t GetMemoryBudget() const { return budget_; }
+
+  /**
+   * @return True if the memory allocated from the tracker of this pool, by all operators of the query, is over the
+   *         memory budget. Operators that can spill check this in addition to their own size.
+   */
+  bool ExceedsMemoryBudget() const;
+
  private:
+  class Arena;
+
   // Metadata tracker for memory allocations
   MemoryTracker *tracker_;
 
+  // The per-thread arenas serving small and medium allocations
+  std::unique_ptr<Arena> arena_;
+
+  // The memory budget for operators that can spill, zero if unlimited
+  std::size_t budget_{0};
+
   //
   static std::atomic<uint64_t> k_mmap_threshold;
 };
@@ -162,7 +201,7 @@ class MemoryPoolAllocator {
    * @param ptr array to deallocate
    * @param n size of the array
    */
-  void deallocate(T *ptr, std::size_t n) { memory_->Deallocate(ptr, n); }  // NOLINT
+  void deallocate(T *ptr, std::size_t n) { memory_->DeallocateArray(ptr, n); }  // NOLINT
 
   /**
    * Equality comparison for two memory pools
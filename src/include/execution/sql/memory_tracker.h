@@ -1,18 +1,131 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+
+#include "common/macros.h"
+#include "execution/util/execution_common.h"
 #include "tbb/enumerable_thread_specific.h"
 
 namespace terrier::execution::sql {
 
 /**
- * TODO: track memory usage
+ * Tracks the memory a query allocates from its memory pools. Every thread counts its own allocations, so the hot path
+ * never touches shared state: a thread only publishes its net allocation to the query-wide counter once it changed by
+ * more than K_FLUSH_BYTES. The query-wide counter, and the peak computed from it, can be read at any time; they're
+ * accurate to within K_FLUSH_BYTES per thread. The exact totals sum the threads' counters and should be read once the
+ * query's threads are done allocating.
+ *
+ * A query may be given a limit. An allocation that takes the query-wide counter past it isn't counted and throws,
+ * stopping a runaway query before it takes the whole node down.
  */
-class MemoryTracker {
+class EXPORT MemoryTracker {
  public:
-  // TODO(pmenon): Fill me in
+  /**
+   * The number of bytes a thread allocates or frees before publishing them to the query-wide counter
+   */
+  static constexpr int64_t K_FLUSH_BYTES = 64 * 1024;
+
+  /**
+   * Create a tracker with no allocations and no limit
+   */
+  MemoryTracker() = default;
+
+  /**
+   * This class cannot be copied or moved.
+   */
+  DISALLOW_COPY_AND_MOVE(MemoryTracker);
+
+  /**
+   * Account for an allocation of @em size bytes on the calling thread.
+   * @param size The number of bytes allocated.
+   * @throws std::runtime_error If the allocation takes the query past its limit.
+   */
+  void Increment(const std::size_t size) {
+    Stats &stats = stats_.local();
+    // The limit is only checked when the query-wide counter changes
+    if (Add(&stats, static_cast<int64_t>(size)) && limit_ != 0 && GetApproxAllocatedSize() > limit_) {
+      Add(&stats, -static_cast<int64_t>(size));
+      ThrowOverLimit(size);
+    }
+    stats.num_allocations_.store(stats.num_allocations_.load(std::memory_order_relaxed) + 1,
+                                 std::memory_order_relaxed);
+  }
+
+  /**
+   * Account for freeing @em size bytes on the calling thread. Memory may be freed by another thread than the one that
+   * allocated it.
+   * @param size The number of bytes freed.
+   */
+  void Decrement(const std::size_t size) { Add(&stats_.local(), -static_cast<int64_t>(size)); }
+
+  /**
+   * @return The number of bytes currently allocated, summed over all threads.
+   */
+  std::size_t GetAllocatedSize() const;
+
+  /**
+   * @return The number of allocations made so far, summed over all threads.
+   */
+  uint64_t GetNumAllocations() const;
+
+  /**
+   * @return The number of bytes currently allocated, as last published by the threads.
+   */
+  std::size_t GetApproxAllocatedSize() const {
+    return static_cast<std::size_t>(std::max(int64_t{0}, allocated_.load(std::memory_order_relaxed)));
+  }
+
+  /**
+   * @return The largest number of bytes the query had allocated at once, as published by the threads.
+   */
+  std::size_t GetPeakAllocatedSize() const {
+    return static_cast<std::size_t>(std::max(int64_t{0}, peak_.load(std::memory_order_relaxed)));
+  }
+
+  /**
+   * Set the number of bytes the query may allocate at most.
+   * @param limit The limit in bytes, or zero for no limit.
+   */
+  void SetLimit(const std::size_t limit) { limit_ = limit; }
+
+  /**
+   * @return The number of bytes the query may allocate at most, or zero if there is no limit.
+   */
+  std::size_t GetLimit() const { return limit_; }
+
  private:
-  struct Stats {};
+  // The counters of a thread. They're only written by their thread, but read by any thread aggregating them.
+  struct Stats {
+    // The net number of bytes allocated by the thread
+    std::atomic<int64_t> allocated_{0};
+    // The part of allocated_ not yet published to the query-wide counter
+    int64_t unflushed_{0};
+    std::atomic<uint64_t> num_allocations_{0};
+  };
+
+  // Count bytes allocated, or freed if negative, on a thread. Returns true if they were published.
+  bool Add(Stats *const stats, const int64_t delta) {
+    stats->allocated_.store(stats->allocated_.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    stats->unflushed_ += delta;
+    if (stats->unflushed_ >= K_FLUSH_BYTES || stats->unflushed_ <= -K_FLUSH_BYTES) {
+      Flush(stats);
+      return true;
+    }
+    return false;
+  }
+
+  // Publish a thread's unflushed bytes to the query-wide counter
+  void Flush(Stats *stats);
+
+  // Fail an allocation of the given size that would take the query past its limit
+  [[noreturn]] void ThrowOverLimit(std::size_t size) const;
+
   tbb::enumerable_thread_specific<Stats> stats_;
+  std::atomic<int64_t> allocated_{0};
+  std::atomic<int64_t> peak_{0};
+  std::size_t limit_{0};
 };
 
 }  // namespace terrier::execution::sql
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstring>
 #include <limits>
 #include <type_traits>
 #include "storage/projected_columns.h"
@@ -10,6 +11,9 @@
 #include "type/type_id.h"
 
 namespace terrier::execution::sql {
+
+class BloomFilter;
+
 /**
  * An iterator over projections. A ProjectedColumnsIterator allows both
  * tuple-at-a-time iteration over a vector projection and vector-at-a-time
@@ -22,6 +26,12 @@ class EXPORT ProjectedColumnsIterator {
   static constexpr const uint32_t K_INVALID_POS = std::numeric_limits<uint32_t>::max();
 
  public:
+  /**
+   * The longest list of values @em FilterColIn() accepts. The list is converted to the type of the column in a buffer
+   * on the stack, for every vector filtered.
+   */
+  static constexpr const uint32_t K_MAX_IN_LIST_SIZE = 256;
+
   /**
    * Create an empty iterator over an empty projection
    */
@@ -113,6 +123,12 @@ class EXPORT ProjectedColumnsIterator {
    */
   void ResetFiltered();
 
+  /**
+   * Select every tuple of an unfiltered vector projection, so that it can be iterated over as a filtered one. Does
+   * nothing if the projection is filtered already.
+   */
+  void SelectAll();
+
   /**
    * Run a function over each active tuple in the projection. This is a
    * read-only function (despite it being non-const), meaning the callback must
@@ -161,11 +177,19 @@ class EXPORT ProjectedColumnsIterator {
      * an int64_t filter value
      */
     int64_t bi_;
+    /**
+     * a date filter value
+     */
+    uint32_t date_;
+    /**
+     * a double filter value
+     */
+    double real_;
   };
 
   /**
    * Creates a filter value according to the given type.
-   * @param val filter value
+   * @param val filter value. For DECIMAL, the bits of the double value.
    * @param type type of the value
    * @return filter val of the given type
    */
@@ -179,6 +203,13 @@ class EXPORT ProjectedColumnsIterator {
         return FilterVal{.i_ = static_cast<int32_t>(val)};
       case type::TypeId::BIGINT:
         return FilterVal{.bi_ = static_cast<int64_t>(val)};
+      case type::TypeId::DATE:
+        return FilterVal{.date_ = static_cast<uint32_t>(val)};
+      case type::TypeId::DECIMAL: {
+        FilterVal result{.real_ = 0.0};
+        std::memcpy(&result.real_, &val, sizeof(double));
+        return result;
+      }
       default:
         throw std::runtime_error("Filter not supported on type");
     }
@@ -186,9 +217,11 @@ class EXPORT ProjectedColumnsIterator {
 
   /**
    * Filter the column at index @em col_idx by the given constant value @em val.
+   * NULLs never pass.
    * @tparam Op The filtering operator.
    * @param col_idx The index of the column in the projection to filter.
-   * @param type The type of the column.
+   * @param type The type of the column: TINYINT, SMALLINT, INTEGER, BIGINT,
+   *             DATE or DECIMAL.
    * @param val The value to filter on.
    * @return The number of selected elements.
    */
@@ -197,7 +230,7 @@ class EXPORT ProjectedColumnsIterator {
 
   /**
    * Filter the column at index @em col_idx_1 with the contents of the column
-   * at index @em col_idx_2.
+   * at index @em col_idx_2. NULLs never pass.
    * @tparam Op The filtering operator.
    * @param col_idx_1 The index of the first column to compare.
    * @param type_1 the Type of the first column.
@@ -208,11 +241,97 @@ class EXPORT ProjectedColumnsIterator {
   template <template <typename> typename Op>
   uint32_t FilterColByCol(uint32_t col_idx_1, type::TypeId type_1, uint32_t col_idx_2, type::TypeId type_2);
 
+  /**
+   * Filter the column at index @em col_idx by the range [@em lo, @em hi], i.e.,
+   * BETWEEN lo AND hi, in a single pass. NULLs never pass.
+   * @param col_idx The index of the column in the projection to filter.
+   * @param type The type of the column: TINYINT, SMALLINT, INTEGER, BIGINT,
+   *             DATE or DECIMAL.
+   * @param lo The inclusive lower bound.
+   * @param hi The inclusive upper bound.
+   * @return The number of selected elements.
+   */
+  uint32_t FilterColBetween(uint32_t col_idx, type::TypeId type, FilterVal lo, FilterVal hi);
+
+  /**
+   * Filter the column at index @em col_idx by a list of values, i.e.,
+   * IN (vals...). NULLs never pass.
+   * @param col_idx The index of the column in the projection to filter.
+   * @param type The type of the column: TINYINT, SMALLINT, INTEGER, BIGINT or
+   *             DATE.
+   * @param vals The list of values, which are converted to the type of the
+   *             column.
+   * @param num_vals The number of values in the list, at most
+   *                 @em K_MAX_IN_LIST_SIZE.
+   * @return The number of selected elements.
+   */
+  uint32_t FilterColIn(uint32_t col_idx, type::TypeId type, const int64_t *vals, uint32_t num_vals);
+
+  /**
+   * Filter the VARCHAR column at index @em col_idx by equality with the given
+   * string. NULLs never pass.
+   * @param col_idx The index of the column in the projection to filter.
+   * @param val The string to compare with.
+   * @param val_len The length of the string.
+   * @return The number of selected elements.
+   */
+  uint32_t FilterColStringEq(uint32_t col_idx, const byte *val, uint32_t val_len);
+
+  /**
+   * Filter the VARCHAR column at index @em col_idx by the given prefix, i.e.,
+   * LIKE 'prefix%'. NULLs never pass.
+   * @param col_idx The index of the column in the projection to filter.
+   * @param prefix The prefix.
+   * @param prefix_len The length of the prefix.
+   * @return The number of selected elements.
+   */
+  uint32_t FilterColStringPrefix(uint32_t col_idx, const byte *prefix, uint32_t prefix_len);
+
+  /**
+   * Filter the column at index @em col_idx by probing the given Bloom filter with the hash of every selected value.
+   * Values are widened to 64 bits and hashed as the hash of a SQL integer is, so that a filter built from the hashes
+   * of a join's build keys drops the probe tuples that certainly have no join partner. NULLs never pass.
+   * @param col_idx The index of the column in the projection to filter.
+   * @param type The type of the column: TINYINT, SMALLINT, INTEGER or BIGINT.
+   * @param bloom_filter The Bloom filter to probe.
+   * @return The number of selected elements.
+   */
+  uint32_t FilterColByBloomFilter(uint32_t col_idx, type::TypeId type, const BloomFilter *bloom_filter);
+
   /**
    * Return the number of selected tuples after any filters have been applied
    */
   uint32_t NumSelected() const { return num_selected_; }
 
+  /**
+   * Return the positions of the selected tuples in the projection, or nullptr
+   * if the projection isn't filtered, i.e., the i-th selected tuple is at
+   * position i.
+   */
+  const uint32_t *GetSelectionVector() const { return IsFiltered() ? selection_vector_ : nullptr; }
+
+  /**
+   * Get the raw data of the column at index @em col_idx, for all tuples in the
+   * projection, selected or not
+   * @tparam T The data type stored in the column
+   * @param col_idx The index of the column
+   * @return The column's values
+   */
+  template <typename T>
+  const T *GetColumnData(uint32_t col_idx) const {
+    return reinterpret_cast<const T *>(projected_column_->ColumnStart(static_cast<uint16_t>(col_idx)));
+  }
+
+  /**
+   * Get the NULL bitmap of the column at index @em col_idx. A set bit means
+   * the value at that position is not NULL.
+   * @param col_idx The index of the column
+   * @return The column's NULL bitmap
+   */
+  const common::RawBitmap *GetColumnNullBitmap(uint32_t col_idx) const {
+    return projected_column_->ColumnNullBitmap(static_cast<uint16_t>(col_idx));
+  }
+
  private:
   // Filter a column by a constant value
   template <typename T, template <typename> typename Op>
@@ -222,6 +341,24 @@ class EXPORT ProjectedColumnsIterator {
   template <typename T, template <typename> typename Op>
   uint32_t FilterColByColImpl(uint32_t col_idx_1, uint32_t col_idx_2);
 
+  // Filter a column by a Bloom filter
+  template <typename T>
+  uint32_t FilterColByBloomFilterImpl(uint32_t col_idx, const BloomFilter *bloom_filter);
+
+  // Filter a column by a range
+  template <typename T>
+  uint32_t FilterColBetweenImpl(uint32_t col_idx, T lo, T hi);
+
+  // Filter a column by a list of values
+  template <typename T>
+  uint32_t FilterColInImpl(uint32_t col_idx, const int64_t *vals, uint32_t num_vals);
+
+  // Does the column have NULLs in the projection?
+  bool ColumnHasNulls(uint32_t col_idx) const;
+
+  // Remove the tuples that are NULL in the column from the selection
+  void FilterNulls(uint32_t col_idx);
+
  private:
   // The selection vector used to filter the ProjectedColumns
   alignas(common::Constants::CACHELINE_SIZE) uint32_t selection_vector_[common::Constants::K_DEFAULT_VECTOR_SIZE];
@@ -302,6 +439,17 @@ inline void ProjectedColumnsIterator::ResetFiltered() {
   selection_vector_write_idx_ = 0;
 }
 
+inline void ProjectedColumnsIterator::SelectAll() {
+  if (IsFiltered()) {
+    return;
+  }
+  for (uint32_t idx = 0; idx < num_selected_; idx++) {
+    selection_vector_[idx] = idx;
+  }
+  selection_vector_write_idx_ = num_selected_;
+  ResetFiltered();
+}
+
 template <typename F>
 inline void ProjectedColumnsIterator::ForEach(const F &fn) {
   // Ensure function conforms to expected form
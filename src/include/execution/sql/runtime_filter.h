@@ -0,0 +1,94 @@
+#pragma once
+
+#include <memory>
+
+#include "common/macros.h"
+#include "execution/bandit/agent.h"
+#include "execution/bandit/policy.h"
+#include "execution/util/execution_common.h"
+#include "type/type_id.h"
+
+namespace terrier::execution::sql {
+
+class BloomFilter;
+class ProjectedColumnsIterator;
+
+/**
+ * A filter passed sideways from the build side of a hash join into the scan feeding its probe side. Once the build is
+ * done, the Bloom filter over the hashes of its keys (see @em JoinHashTable::BuildBloomFilter()) drops the probe tuples
+ * that certainly have no join partner, before they are hashed, probed, materialized or exchanged. Only inner and semi
+ * joins on a single integer key can be filtered this way.
+ *
+ * Whether the filter pays off depends on how many probe tuples it drops, which isn't known up front and may change
+ * during the scan. A bandit agent decides for every vector whether to apply or skip the filter. Applying it costs the
+ * time it takes plus the estimated downstream cost of the tuples it lets through. Skipping it costs the estimated
+ * downstream cost of all tuples.
+ *
+ * A runtime filter isn't thread-safe: every scan needs its own, but they can share the Bloom filter.
+ */
+class EXPORT RuntimeFilter {
+ public:
+  /**
+   * The actions of the agent
+   */
+  enum Action : uint32_t {
+    Apply = 0,
+    Skip = 1,
+  };
+
+  /**
+   * Default estimate of the cost in nanoseconds of processing a probe tuple after the scan: hashing it, probing the
+   * join hash table out of cache, and comparing keys
+   */
+  static constexpr double K_DEFAULT_PROBE_COST_NS = 50.0;
+
+  /**
+   * Construct a runtime filter on the column at index @em col_idx of the scanned vectors
+   * @param bloom_filter The Bloom filter over the hashes of the join's build keys
+   * @param col_idx The index of the probe key column in the projection
+   * @param col_type The type of the probe key column: TINYINT, SMALLINT, INTEGER or BIGINT
+   * @param policy_kind The policy of the agent deciding whether to apply the filter
+   * @param probe_cost_ns The estimated cost in nanoseconds of processing a probe tuple after the scan
+   */
+  RuntimeFilter(const BloomFilter *bloom_filter, uint32_t col_idx, type::TypeId col_type,
+                bandit::Policy::Kind policy_kind = bandit::Policy::Kind::EpsilonGreedy,
+                double probe_cost_ns = K_DEFAULT_PROBE_COST_NS);
+
+  /**
+   * This class cannot be copied or moved
+   */
+  DISALLOW_COPY_AND_MOVE(RuntimeFilter);
+
+  /**
+   * Filter the given vector, unless the agent decides to skip the filter this time
+   * @param pci The input vector
+   * @return The number of selected tuples
+   */
+  uint32_t Run(ProjectedColumnsIterator *pci);
+
+  /**
+   * @return True if the agent currently believes applying the filter pays off; false otherwise
+   */
+  bool IsEnabled() const { return agent_.GetCurrentOptimalAction() == Action::Apply; }
+
+  /**
+   * @return The number of tuples the filter dropped so far
+   */
+  uint64_t NumFiltered() const noexcept { return num_filtered_; }
+
+ private:
+  // The Bloom filter over the build keys
+  const BloomFilter *bloom_filter_;
+  // The probe key column
+  uint32_t col_idx_;
+  type::TypeId col_type_;
+  // The estimated downstream cost of a probe tuple, in milliseconds
+  double probe_cost_ms_;
+  // The policy and the agent choosing between applying and skipping
+  std::unique_ptr<bandit::Policy> policy_;
+  bandit::Agent agent_;
+  // The number of tuples dropped
+  uint64_t num_filtered_;
+};
+
+}  // namespace terrier::execution::sql
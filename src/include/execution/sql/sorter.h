@@ -1,17 +1,94 @@
 #pragma once
 
+#include <atomic>
+#include <cstring>
+#include <limits>
+#include <memory>
 #include <vector>
 
+#include "common/constants.h"
 #include "common/macros.h"
 #include "execution/sql/memory_pool.h"
+#include "execution/sql/spill_file.h"
 #include "execution/util/chunked_vector.h"
 
 namespace terrier::execution::sql {
 
+class SortedRunMerger;
 class ThreadStateContainer;
 
+/**
+ * The bound on the leading sort key of the tuples that can still make it into the result of a Top-K. Thread-local
+ * Top-K sorters tighten the bound every time their heap changes: once a heap holds K tuples, no tuple ordered after its
+ * K-th tuple can be in the global top K. Scans read the bound to drop such tuples before they reach the sorter.
+ *
+ * Tuples whose key equals the bound may still be in the top K, since ties are broken on the remaining sort keys.
+ */
+class EXPORT TopKThreshold {
+ public:
+  /**
+   * Construct a threshold that doesn't filter anything yet
+   * @param ascending True if the leading sort key is in ascending order; false if it is in descending order
+   */
+  explicit TopKThreshold(const bool ascending)
+      : ascending_(ascending),
+        bound_(ascending ? std::numeric_limits<int64_t>::max() : std::numeric_limits<int64_t>::min()) {}
+
+  /**
+   * This class cannot be copied or moved
+   */
+  DISALLOW_COPY_AND_MOVE(TopKThreshold);
+
+  /**
+   * Tighten the bound to @em key, unless the bound is tighter already. Safe to call concurrently.
+   * @param key The leading sort key of the K-th tuple of a Top-K heap
+   */
+  void Tighten(const int64_t key) noexcept {
+    int64_t bound = bound_.load(std::memory_order_relaxed);
+    while (ascending_ ? key < bound : key > bound) {
+      if (bound_.compare_exchange_weak(bound, key, std::memory_order_relaxed)) {
+        break;
+      }
+    }
+  }
+
+  /**
+   * @return True if the leading sort key is in ascending order; false if it is in descending order
+   */
+  bool IsAscending() const noexcept { return ascending_; }
+
+  /**
+   * @return True if any sorter has published a bound yet
+   */
+  bool IsSet() const noexcept {
+    return GetBound() != (ascending_ ? std::numeric_limits<int64_t>::max() : std::numeric_limits<int64_t>::min());
+  }
+
+  /**
+   * @return The current bound on the leading sort key
+   */
+  int64_t GetBound() const noexcept { return bound_.load(std::memory_order_relaxed); }
+
+  /**
+   * Can a tuple with the given leading sort key still be in the top K?
+   * @param key The leading sort key of the tuple
+   * @return True if the tuple may be in the top K; false if it certainly isn't
+   */
+  bool CanQualify(const int64_t key) const noexcept { return ascending_ ? key <= GetBound() : key >= GetBound(); }
+
+ private:
+  // The order of the leading sort key
+  const bool ascending_;
+  // The bound, or the key ordered last if there's none yet
+  std::atomic<int64_t> bound_;
+};
+
 /**
  * Sorters
+ *
+ * If the memory pool has a budget, the sorter switches to an external merge sort once its buffered tuples exceed the
+ * budget: the buffered tuples are sorted and written to a spill file as a sorted run. Iterating a sorter with spilled
+ * runs performs a k-way merge over the runs on disk and the tuples left in memory.
  */
 class EXPORT Sorter {
  public:
@@ -20,6 +97,11 @@ class EXPORT Sorter {
    */
   using ComparisonFunction = int32_t (*)(const void *lhs, const void *rhs);
 
+  /**
+   * Bytes of every spilled run read into memory at a time when merging
+   */
+  static constexpr const uint32_t K_MERGE_BUFFER_SIZE = 64 * common::Constants::KB;
+
   /**
    * Construct a sorter using @em memory as the memory allocator, storing tuples
    * @em tuple_size size in bytes, and using the comparison function @em cmp_fn.
@@ -61,6 +143,29 @@ class EXPORT Sorter {
    */
   void AllocInputTupleTopKFinish(uint64_t top_k);
 
+  /**
+   * Publish the leading sort key of the K-th tuple of this sorter's Top-K heap to @em threshold whenever the heap
+   * changes. Thread-local sorters of a parallel Top-K share one threshold.
+   * @param threshold The threshold to tighten, or nullptr to stop publishing
+   * @param key_offset The offset of the leading sort key in a tuple. The key is stored as a 64-bit integer.
+   */
+  void SetTopKThreshold(TopKThreshold *const threshold, const uint32_t key_offset) noexcept {
+    TERRIER_ASSERT(threshold == nullptr || key_offset + sizeof(int64_t) <= tuple_size_, "Key must be in the tuple");
+    top_k_threshold_ = threshold;
+    top_k_key_offset_ = key_offset;
+  }
+
+  /**
+   * Declare that the first @em key_size bytes of every tuple hold a normalized sort key, i.e., comparing the keys of
+   * two tuples with memcmp() orders them the same way as the comparison function does, unless the keys are equal.
+   * Sorting and merging then compare keys with memcmp() and only call the comparison function to break ties.
+   * @param key_size The size of the normalized key in bytes. Zero disables normalized keys.
+   */
+  void SetNormalizedKeySize(const uint32_t key_size) noexcept {
+    TERRIER_ASSERT(key_size <= tuple_size_, "Normalized key cannot be larger than the tuple");
+    key_size_ = key_size;
+  }
+
   /**
    * Sort all inserted entries
    */
@@ -83,6 +188,8 @@ class EXPORT Sorter {
    * state container object. Each thread-local sorter instance is assumed (but
    * not required) to be unsorted. Once sorting completes, this sorter instance
    * will take ownership of all data owned by each thread-local instances.
+   * Thread-local sorters that were filled as Top-K heaps hold at most K tuples
+   * each, so only the top K of their union are selected and sorted.
    * @param thread_state_container The container holding all thread-local sorter
    *                               instances.
    * @param sorter_offset The offset into the container where the sorter
@@ -92,16 +199,46 @@ class EXPORT Sorter {
   void SortTopKParallel(const ThreadStateContainer *thread_state_container, uint32_t sorter_offset, uint64_t top_k);
 
   /**
-   * Return the number of tuples currently in this sorter
+   * Return the number of tuples currently in this sorter, including those spilled to disk
    */
-  uint64_t NumTuples() const { return tuples_.size(); }
+  uint64_t NumTuples() const { return tuples_.size() + num_spilled_tuples_; }
 
   /**
    * Has this sorter's contents been sorted?
    */
   bool IsSorted() const { return sorted_; }
 
+  /**
+   * Has this sorter written sorted runs to disk?
+   */
+  bool HasSpilledRuns() const noexcept { return !runs_.empty(); }
+
  private:
+  friend class SortedRunMerger;
+
+  // Allocate space for a tuple, without spilling
+  byte *AppendTuple();
+
+  // Compare two tuples, first by their normalized keys, if any
+  int32_t CompareTuples(const byte *lhs, const byte *rhs) const {
+    if (key_size_ != 0) {
+      if (const int32_t cmp = std::memcmp(lhs, rhs, key_size_); cmp != 0) {
+        return cmp;
+      }
+    }
+    return cmp_fn_(lhs, rhs);
+  }
+
+  // Sort the buffered tuples in memory
+  void SortBufferedTuples();
+
+  // Sort the buffered tuples and write them out as a run, releasing their
+  // memory
+  void SpillSortedRun();
+
+  // Parallel sort of thread-local sorters whose tuples don't fit in memory
+  void SortParallelExternal(const std::vector<Sorter *> &tl_sorters);
+
   // Build a max heap from the tuples currently stored in the sorter instance
   void BuildHeap();
 
@@ -109,9 +246,24 @@ class EXPORT Sorter {
   // property
   void HeapSiftDown();
 
+  // Publish the key of the tuple at the root of the Top-K heap, if a
+  // threshold is attached
+  void PublishTopKThreshold() noexcept {
+    if (top_k_threshold_ != nullptr) {
+      top_k_threshold_->Tighten(*reinterpret_cast<const int64_t *>(tuples_.front() + top_k_key_offset_));
+    }
+  }
+
  private:
   friend class SorterIterator;
 
+  // The memory pool
+  MemoryPool *memory_;
+
+  // The size of each tuple and of its normalized key
+  uint32_t tuple_size_;
+  uint32_t key_size_;
+
   // Vector of entries
   util::ChunkedVector<MemoryPoolAllocator<byte>> tuple_storage_;
 
@@ -126,10 +278,131 @@ class EXPORT Sorter {
 
   // Flag indicating if the contents of the sorter have been sorted
   bool sorted_;
+
+  // The number of tuples to buffer before a run is spilled
+  uint64_t max_buffered_tuples_;
+
+  // The sorted runs on disk, the files holding them, and their total number
+  // of tuples
+  MemPoolVector<SpillRun> runs_;
+  MemPoolVector<std::unique_ptr<SpillFile>> spill_files_;
+  uint64_t num_spilled_tuples_;
+
+  // The number of tuples a merge of the spilled runs produces
+  uint64_t merge_limit_;
+
+  // The storage of the tuple the Top-K heap dropped last, reused by the next
+  // Top-K allocation
+  byte *top_k_free_slot_;
+
+  // The threshold the Top-K heap publishes to, and where the key is in a tuple
+  TopKThreshold *top_k_threshold_;
+  uint32_t top_k_key_offset_;
+};
+
+/**
+ * A k-way merge over the sorted runs of a sorter that spilled, and over its buffered tuples. The runs are merged with a
+ * loser tree, so producing a tuple takes about log2(k) comparisons. Each run on disk is read through a buffer of its
+ * own, and the OS is asked to read ahead the next block of a run while the current block is consumed.
+ */
+class EXPORT SortedRunMerger {
+ public:
+  /**
+   * Create a merger over the runs of the given sorter. The sorter must have been sorted.
+   * @param sorter The sorter whose runs to merge.
+   */
+  explicit SortedRunMerger(const Sorter *sorter);
+
+  /**
+   * Destructor
+   */
+  ~SortedRunMerger();
+
+  /**
+   * This class cannot be copied or moved
+   */
+  DISALLOW_COPY_AND_MOVE(SortedRunMerger);
+
+  /**
+   * Start the merge over, positioning it at the smallest tuple
+   * @throw std::runtime_error on an I/O error
+   */
+  void Reset();
+
+  /**
+   * @return True if the merge has more tuples; false otherwise.
+   */
+  bool HasNext() const noexcept { return remaining_ > 0 && current_ != nullptr; }
+
+  /**
+   * @return The current tuple. It remains valid until the merge is advanced.
+   */
+  const byte *Current() const noexcept { return current_; }
+
+  /**
+   * Advance to the next tuple in sort order
+   * @throw std::runtime_error on an I/O error
+   */
+  void Next();
+
+ private:
+  // A position in one sorted run
+  struct Cursor {
+    // The current tuple, or nullptr if the run is exhausted
+    const byte *tuple_;
+    // The remaining tuples of the in-memory run
+    const byte *const *next_;
+    const byte *const *end_;
+    // The run on disk, or nullptr for the in-memory run
+    const SpillRun *run_;
+    // The number of bytes of the run read so far
+    uint64_t read_pos_;
+    // The read buffer, its size, and the position of the next tuple and the
+    // end of the data in it
+    byte *buffer_;
+    uint32_t buffer_size_;
+    uint32_t buffer_pos_;
+    uint32_t buffer_end_;
+  };
+
+  // Move the cursor to the next tuple of its run
+  void Advance(Cursor *cursor);
+
+  // Is the current tuple of the run at cursor index 'lhs' smaller than that of
+  // 'rhs'? Exhausted runs are larger than all others.
+  bool Less(uint32_t lhs, uint32_t rhs) const {
+    const byte *lhs_tuple = cursors_[lhs].tuple_, *rhs_tuple = cursors_[rhs].tuple_;
+    if (lhs_tuple == nullptr || rhs_tuple == nullptr) {
+      return rhs_tuple == nullptr && lhs_tuple != nullptr;
+    }
+    return sorter_->CompareTuples(lhs_tuple, rhs_tuple) < 0;
+  }
+
+  // Play the matches in the subtree rooted at the given node, returning the
+  // winner
+  uint32_t BuildTree(uint32_t node);
+
+ private:
+  // The sorter
+  const Sorter *sorter_;
+  // The largest size of a read buffer
+  uint32_t buffer_size_;
+  // One cursor per run
+  MemPoolVector<Cursor> cursors_;
+  // The loser tree. The leaves are implicit: leaf 'i' is node 'k + i'. Inner
+  // node 'n' holds the loser of the match between its children '2n' and
+  // '2n + 1', and node 0 holds the overall winner.
+  MemPoolVector<uint32_t> tree_;
+  // The current tuple
+  const byte *current_;
+  // The number of tuples left to produce
+  uint64_t remaining_;
 };
 
 /**
- * An iterator over the elements in a sorter instance
+ * An iterator over the elements in a sorter instance. If the sorter has spilled runs, every iterator merges them on its
+ * own, so several iterators can be open on the same sorter at once. Merged rows are copied into a buffer owned by the
+ * iterator, which keeps the current and the previous row valid while the merge moves on.
  */
 class EXPORT SorterIterator {
   /**
@@ -142,20 +415,53 @@ class EXPORT SorterIterator {
    * Constructor
    * @param sorter sorter to iterate over
    */
-  explicit SorterIterator(Sorter *sorter) noexcept : iter_(sorter->tuples_.begin()), end_(sorter->tuples_.end()) {}
+  explicit SorterIterator(Sorter *sorter)
+      : iter_(sorter->tuples_.begin()),
+        end_(sorter->tuples_.end()),
+        memory_(sorter->memory_),
+        tuple_size_(sorter->tuple_size_),
+        rows_(nullptr),
+        row_(nullptr) {
+    if (sorter->HasSpilledRuns()) {
+      TERRIER_ASSERT(sorter->IsSorted(), "A sorter with spilled runs must be sorted before it is iterated");
+      merger_ = std::make_unique<SortedRunMerger>(sorter);
+      merger_->Reset();
+      rows_ = reinterpret_cast<byte *>(memory_->Allocate(2 * tuple_size_, false));
+      CopyMergedRow();
+    }
+  }
+
+  /**
+   * Destructor
+   */
+  ~SorterIterator() {
+    if (rows_ != nullptr) {
+      memory_->Deallocate(rows_, 2 * tuple_size_);
+    }
+  }
+
+  /**
+   * This class cannot be copied or moved
+   */
+  DISALLOW_COPY_AND_MOVE(SorterIterator);
 
   /**
    * Dereference operator
    * @return A pointer to the current iteration row
    */
-  const byte *operator*() const noexcept { return *iter_; }
+  const byte *operator*() const noexcept { return merger_ == nullptr ? *iter_ : row_; }
 
   /**
    * Pre-increment the iterator
    * @return A reference to this iterator after it's been advanced one row
    */
-  SorterIterator &operator++() noexcept {
-    ++iter_;
+  SorterIterator &operator++() {
+    if (merger_ == nullptr) {
+      ++iter_;
+    } else {
+      merger_->Next();
+      CopyMergedRow();
+    }
     return *this;
   }
 
@@ -163,7 +469,7 @@ class EXPORT SorterIterator {
    * Does this iterate have more data
    * @return True if the iterator has more data; false otherwise
    */
-  bool HasNext() const { return iter_ != end_; }
+  bool HasNext() const { return merger_ == nullptr ? iter_ != end_ : merger_->HasNext(); }
 
   /**
    * Advance the iterator
@@ -175,7 +481,7 @@ class EXPORT SorterIterator {
    * iterator is valid.
    */
   const byte *GetRow() const {
-    TERRIER_ASSERT(iter_ != end_, "Invalid iterator");
+    TERRIER_ASSERT(HasNext(), "Invalid iterator");
     return this->operator*();
   }
 
@@ -188,11 +494,29 @@ class EXPORT SorterIterator {
     return reinterpret_cast<const T *>(GetRow());
   }
 
+ private:
+  // Copy the merge's current row into the half of the row buffer not holding
+  // the previous row
+  void CopyMergedRow() {
+    if (merger_->HasNext()) {
+      row_ = row_ == rows_ ? rows_ + tuple_size_ : rows_;
+      std::memcpy(row_, merger_->Current(), tuple_size_);
+    }
+  }
+
  private:
   // The current iterator position
   IteratorType iter_;
   // The ending iterator position
   const IteratorType end_;
+  // The merge of the sorter's runs, if it spilled
+  std::unique_ptr<SortedRunMerger> merger_;
+  // The pool the row buffer comes from, and the size of a row
+  MemoryPool *memory_;
+  uint32_t tuple_size_;
+  // The buffer holding the last two merged rows, and the current one
+  byte *rows_;
+  byte *row_;
 };
 
 }  // namespace terrier::execution::sql
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <algorithm>
+#include <memory>
+
+#include "common/constants.h"
+#include "common/macros.h"
+#include "common/strong_typedef.h"
+#include "execution/util/execution_common.h"
+
+namespace terrier::execution::sql {
+
+/**
+ * A temporary file that operators write data to when it no longer fits in their memory budget. The file is unlinked
+ * right after it is created, so it never outlives the process, and its space is returned when the SpillFile is
+ * destroyed.
+ *
+ * Data is appended through a write buffer, and read back by offset. Appending is not thread-safe, but once the data
+ * has been flushed, any number of threads may read from the file at the same time.
+ */
+class EXPORT SpillFile {
+ public:
+  /**
+   * Size of the write buffer
+   */
+  static constexpr const uint32_t K_BUFFER_SIZE = 256 * common::Constants::KB;
+
+  /**
+   * Create an empty spill file in the directory named by the TMPDIR environment variable, or /tmp if it isn't set.
+   * @throw std::runtime_error if the file cannot be created
+   */
+  SpillFile();
+
+  /**
+   * This class cannot be copied or moved
+   */
+  DISALLOW_COPY_AND_MOVE(SpillFile);
+
+  /**
+   * Close the file, releasing its disk space
+   */
+  ~SpillFile();
+
+  /**
+   * Append @em size bytes to the end of the file. The data may stay in the write buffer until the next flush.
+   * @param data The data to write.
+   * @param size The number of bytes to write.
+   * @return The offset in the file the data was written to.
+   * @throw std::runtime_error on an I/O error
+   */
+  uint64_t Append(const void *data, std::size_t size);
+
+  /**
+   * Write out everything in the write buffer, making it visible to reads.
+   * @throw std::runtime_error on an I/O error
+   */
+  void Flush();
+
+  /**
+   * Read @em size bytes at offset @em offset. The data must have been flushed. Safe to call from multiple threads.
+   * @param offset The offset in the file to read from.
+   * @param[out] data Where to read the data into.
+   * @param size The number of bytes to read.
+   * @throw std::runtime_error on an I/O error, or if the file is shorter than requested
+   */
+  void Read(uint64_t offset, void *data, std::size_t size) const;
+
+  /**
+   * Hint that @em size bytes at offset @em offset will be read soon, so that the OS can read them in the background.
+   * @param offset The offset in the file that will be read.
+   * @param size The number of bytes that will be read.
+   */
+  void Prefetch(uint64_t offset, std::size_t size) const;
+
+  /**
+   * @return The number of bytes appended to this file.
+   */
+  uint64_t Size() const noexcept { return size_; }
+
+ private:
+  // The file descriptor
+  int fd_;
+  // The write buffer
+  std::unique_ptr<byte[]> buffer_;
+  // The number of bytes in the write buffer
+  uint32_t buffer_size_;
+  // The total number of bytes appended
+  uint64_t size_;
+};
+
+/**
+ * A contiguous range of bytes in a spill file, e.g., the tuples of one partition written out in one go
+ */
+struct SpillRun {
+  /**
+   * The file holding the run
+   */
+  SpillFile *file_;
+
+  /**
+   * The offset of the run in the file
+   */
+  uint64_t offset_;
+
+  /**
+   * The size of the run in bytes
+   */
+  uint64_t size_;
+};
+
+/**
+ * Read the fixed-size records of a spilled run back in batches that fit into the given buffer.
+ * @tparam F The type of the consumer, invocable as consumer(byte *records, std::size_t num_records)
+ * @param run The run to read. Its data must have been flushed.
+ * @param record_size The size of each record in bytes.
+ * @param buffer The buffer to read batches into.
+ * @param buffer_size The size of the buffer, which must hold at least one record.
+ * @param consumer Called with every batch of records. The records are only valid until it returns.
+ */
+template <typename F>
+void ReadSpillRun(const SpillRun &run, const std::size_t record_size, byte *const buffer, const std::size_t buffer_size,
+                  const F &consumer) {
+  const std::size_t batch_size = buffer_size / record_size * record_size;
+  TERRIER_ASSERT(batch_size > 0, "Read buffer cannot hold a single record");
+  TERRIER_ASSERT(run.size_ % record_size == 0, "Spilled run holds a partial record");
+  for (uint64_t pos = 0; pos < run.size_; pos += batch_size) {
+    const auto read_size = static_cast<std::size_t>(std::min<uint64_t>(batch_size, run.size_ - pos));
+    run.file_->Read(run.offset_ + pos, buffer, read_size);
+    consumer(buffer, read_size / record_size);
+  }
+}
+
+}  // namespace terrier::execution::sql
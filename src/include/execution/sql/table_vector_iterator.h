@@ -6,9 +6,13 @@
 #include "execution/exec/execution_context.h"
 #include "execution/sql/projected_columns_iterator.h"
 #include "storage/sql_table.h"
+#include "type/type_id.h"
 
 namespace terrier::execution::sql {
+class BloomFilter;
+class RuntimeFilter;
 class ThreadStateContainer;
+class TopKThreshold;
 
 /**
  * An iterator over a table's data in vector-wise fashion.
@@ -53,6 +57,42 @@ class EXPORT TableVectorIterator {
    */
   bool Advance();
 
+  /**
+   * Use the bound of a Top-K the scanned tuples feed as a dynamic filter on the column at index @em col_idx, the
+   * leading sort key of the Top-K. Every vector is filtered by the bound the moment it is read, and vectors in which no
+   * tuple can make it into the top K are skipped. The PCI is always filtered once any dynamic filter was attached.
+   * @param threshold The Top-K's threshold, or nullptr to stop filtering
+   * @param col_idx The index of the sort key column in the projection. It must not be NULL.
+   * @param col_type The type of the sort key column: SMALLINT, INTEGER or BIGINT
+   */
+  void SetTopKThreshold(const TopKThreshold *const threshold, const uint32_t col_idx, const type::TypeId col_type) {
+    top_k_threshold_ = threshold;
+    top_k_col_idx_ = col_idx;
+    top_k_col_type_ = col_type;
+    has_dynamic_filters_ = true;
+  }
+
+  /**
+   * Filter every vector read by the given filter from the build side of a join the scanned tuples probe. Vectors in
+   * which no tuple is left are skipped. Filters run in the order they are added, after the Top-K threshold, if any. The
+   * PCI is always filtered once any dynamic filter was attached.
+   * @param filter The runtime filter. It must outlive the iterator, and not be used by any other scan.
+   */
+  void AddRuntimeFilter(RuntimeFilter *const filter) {
+    runtime_filters_.push_back(filter);
+    has_dynamic_filters_ = true;
+  }
+
+  /**
+   * Filter every vector read by a runtime filter over the given Bloom filter, owned by the iterator
+   * @param bloom_filter The Bloom filter over the hashes of the join's build keys. It must outlive the iterator. If
+   *                     it is nullptr, as for a join whose build side spilled, nothing is filtered, but the PCI is
+   *                     filtered all the same.
+   * @param col_idx The index of the probe key column in the projection
+   * @param col_type The type of the probe key column: TINYINT, SMALLINT, INTEGER or BIGINT
+   */
+  void AddRuntimeFilter(const BloomFilter *bloom_filter, uint32_t col_idx, type::TypeId col_type);
+
   /**
    * @return the iterator over the current active projection
    */
@@ -73,15 +113,33 @@ class EXPORT TableVectorIterator {
    * callback function @em scanner on each input vector projection from the
    * source table. This call is blocking, meaning that it only returns after
    * the whole table has been scanned. Iteration order is non-deterministic.
-   * @param db_oid The ID of the database containing the table
+   * The table is split into ranges of @em min_grain_size blocks, each a
+   * morsel of a pipeline run by the QueryScheduler with the priority and
+   * degree of parallelism of the execution context. Every range is scanned
+   * through its own iterator, handed to the callback with the state of the
+   * thread running it.
+   * @param exec_ctx The execution context of the query
    * @param table_oid The ID of the table
+   * @param col_oids The oids of the columns to scan
+   * @param num_oids The number of columns to scan
    * @param query_state the query state
    * @param thread_states the thread state container
    * @param scan_fn The callback function invoked for vectors of table input
    * @param min_grain_size The minimum number of blocks to give a scan task
+   * @return False if the table doesn't exist; true once the table was scanned
    */
-  static bool ParallelScan(uint32_t db_oid, uint32_t table_oid, void *query_state, ThreadStateContainer *thread_states,
-                           ScanFn scan_fn, uint32_t min_grain_size = K_MIN_BLOCK_RANGE_SIZE);
+  static bool ParallelScan(exec::ExecutionContext *exec_ctx, uint32_t table_oid, uint32_t *col_oids,
+                           uint32_t num_oids, void *query_state, ThreadStateContainer *thread_states, ScanFn scan_fn,
+                           uint32_t min_grain_size = K_MIN_BLOCK_RANGE_SIZE);
+
+ private:
+  // Filter the current vector by the Top-K threshold, if there is one.
+  // Returns false if no tuple is left.
+  bool FilterByTopKThreshold();
+
+  // Filter the current vector by the runtime filters. Returns false if no
+  // tuple is left.
+  bool FilterByRuntimeFilters();
 
  private:
   exec::ExecutionContext *exec_ctx_;
@@ -96,8 +154,22 @@ class EXPORT TableVectorIterator {
   storage::ProjectedColumns *projected_columns_ = nullptr;
   // Iterator of the slots in the PC
   std::unique_ptr<storage::DataTable::SlotIterator> iter_ = nullptr;
+  // The end of the range of blocks a parallel scan gave the iterator, or nullptr to scan up to the end of the table
+  std::unique_ptr<storage::DataTable::SlotIterator> range_end_ = nullptr;
 
   bool initialized_ = false;
+
+  // The Top-K threshold used as a dynamic filter, and the column it filters
+  const TopKThreshold *top_k_threshold_ = nullptr;
+  uint32_t top_k_col_idx_ = 0;
+  type::TypeId top_k_col_type_ = type::TypeId::INVALID;
+
+  // The filters pushed down from the build sides of joins, and those of them the iterator owns
+  std::vector<RuntimeFilter *> runtime_filters_;
+  std::vector<std::unique_ptr<RuntimeFilter>> owned_runtime_filters_;
+
+  // Whether any dynamic filter was attached, which keeps the PCI filtered
+  bool has_dynamic_filters_ = false;
 };
 
 }  // namespace terrier::execution::sql
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 #include "common/macros.h"
 #include "execution/util/bit_util.h"
@@ -58,6 +59,18 @@ class CpuInfo {
    */
   uint32_t GetNumCores() const noexcept { return num_cores_; }
 
+  /**
+   * Return the number of NUMA nodes in the system
+   */
+  uint32_t GetNumNumaNodes() const noexcept { return num_numa_nodes_; }
+
+  /**
+   * Return the NUMA node logical core \a core belongs to
+   */
+  uint32_t GetNumaNodeOfCore(uint32_t core) const noexcept {
+    return core < core_numa_nodes_.size() ? core_numa_nodes_[core] : 0;
+  }
+
   /**
    * Return the size of the cache at level \a level in bytes
    */
@@ -83,6 +96,8 @@ class CpuInfo {
   void InitCpuInfo();
   // Initialize cache info
   void InitCacheInfo();
+  // Initialize the NUMA node of every core
+  void InitNumaInfo();
   // Parse cpu flags
   void ParseCpuFlags(llvm::StringRef flags);
 
@@ -96,6 +111,8 @@ class CpuInfo {
   double cpu_mhz_;
   uint32_t cache_sizes_[K_NUM_CACHE_LEVELS];
   uint32_t cache_line_sizes_[K_NUM_CACHE_LEVELS];
+  uint32_t num_numa_nodes_;
+  std::vector<uint32_t> core_numa_nodes_;
   util::InlinedBitVector<64> hardware_flags_;
 };
 
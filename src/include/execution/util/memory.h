@@ -1,7 +1,10 @@
 #pragma once
 
 #include <sys/mman.h>
+#include <unistd.h>
 #include <cstddef>
+#include <cstdint>
+#include <cstdlib>
 #include <cstring>
 
 #include "common/macros.h"
@@ -18,15 +21,39 @@ namespace terrier::execution::util {
 // Allocations
 // ---------------------------------------------------------
 
+/**
+ * The size of a (transparent) huge page
+ */
+constexpr std::size_t K_HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
 inline void *MallocHuge(std::size_t size) {
+  // Huge pages only back aligned ranges, so allocations spanning one are mapped
+  // with room to spare and trimmed to a huge page boundary
+  const std::size_t slack = size >= K_HUGE_PAGE_SIZE ? K_HUGE_PAGE_SIZE : 0;
+
   // Attempt to map
-  void *ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  void *ptr = mmap(nullptr, size + slack, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
 
   // If failed, return null. Let client worry.
   if (ptr == MAP_FAILED) {
     return nullptr;
   }
 
+  if (slack != 0) {
+    static const auto page_size = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+    const auto start = reinterpret_cast<uintptr_t>(ptr);
+    const uintptr_t end = (start + size + slack + page_size - 1) & ~(page_size - 1);
+    const uintptr_t aligned = (start + slack - 1) & ~(slack - 1);
+    const uintptr_t aligned_end = (aligned + size + page_size - 1) & ~(page_size - 1);
+    if (aligned != start) {
+      munmap(reinterpret_cast<void *>(start), aligned - start);
+    }
+    if (aligned_end != end) {
+      munmap(reinterpret_cast<void *>(aligned_end), end - aligned_end);
+    }
+    ptr = reinterpret_cast<void *>(aligned);
+  }
+
   // All good, advise to use huge pages
 #if !defined(__APPLE__)
   madvise(ptr, size, MADV_HUGEPAGE);
@@ -55,6 +82,29 @@ inline void FreeHugeArray(T *ptr, std::size_t num_elems) {
   FreeHuge(static_cast<void *>(ptr), sizeof(T) * num_elems);
 }
 
+/**
+ * Allocate zeroed memory for a table, e.g., a hash table directory. Tables spanning a huge page are mapped and backed
+ * by huge pages, smaller ones come from the heap rather than paying for a mapping of their own.
+ * @param size The size of the table in bytes.
+ * @return The zeroed table, to be freed with FreeHugeIfLarge() and the same size.
+ */
+inline void *MallocHugeIfLarge(const std::size_t size) {
+  return size >= K_HUGE_PAGE_SIZE ? MallocHuge(size) : std::calloc(size, 1);
+}
+
+/**
+ * Free a table allocated with MallocHugeIfLarge().
+ * @param ptr The table.
+ * @param size The size of the table in bytes, as allocated.
+ */
+inline void FreeHugeIfLarge(void *const ptr, const std::size_t size) {
+  if (size >= K_HUGE_PAGE_SIZE) {
+    FreeHuge(ptr, size);
+  } else {
+    std::free(ptr);
+  }
+}
+
 inline void *MallocAligned(const std::size_t size, const std::size_t alignment) {
   TERRIER_ASSERT(alignment % sizeof(void *) == 0, "Alignment must be a multiple of sizeof(void*)");
   TERRIER_ASSERT((alignment & (alignment - 1)) == 0, "Alignment must be a power of two");
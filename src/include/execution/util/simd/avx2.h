@@ -598,6 +598,10 @@ ALWAYS_INLINE inline Vec8Mask operator&(const Vec8Mask &a, const Vec8Mask &b) {
   return Vec8Mask(Vec256b(a) & Vec256b(b));
 }
 
+ALWAYS_INLINE inline Vec8Mask operator|(const Vec8Mask &a, const Vec8Mask &b) {
+  return Vec8Mask(Vec256b(a) | Vec256b(b));
+}
+
 // ---------------------------------------------------------
 // Vec4Mask
 // ---------------------------------------------------------
@@ -606,6 +610,10 @@ ALWAYS_INLINE inline Vec4Mask operator&(const Vec4Mask &a, const Vec4Mask &b) {
   return Vec4Mask(Vec256b(a) & Vec256b(b));
 }
 
+ALWAYS_INLINE inline Vec4Mask operator|(const Vec4Mask &a, const Vec4Mask &b) {
+  return Vec4Mask(Vec256b(a) | Vec256b(b));
+}
+
 // ---------------------------------------------------------
 // Vec4 - Comparison Operations
 // ---------------------------------------------------------
@@ -706,10 +714,7 @@ ALWAYS_INLINE inline Vec8Mask operator>(const Vec8 &a, const Vec8 &b) { return V
 
 ALWAYS_INLINE inline Vec8Mask operator==(const Vec8 &a, const Vec8 &b) { return Vec8Mask(_mm256_cmpeq_epi32(a, b)); }
 
-ALWAYS_INLINE inline Vec8Mask operator>=(const Vec8 &a, const Vec8 &b) {
-  __m256i max_a_b = _mm256_max_epu32(a, b);
-  return Vec8Mask(_mm256_cmpeq_epi32(a, max_a_b));
-}
+ALWAYS_INLINE inline Vec8Mask operator>=(const Vec8 &a, const Vec8 &b) { return Vec8Mask(~Vec256b(b > a)); }
 
 ALWAYS_INLINE inline Vec8Mask operator<(const Vec8 &a, const Vec8 &b) { return b > a; }
 
@@ -960,4 +965,69 @@ static inline uint32_t FilterVectorByVector(const T *RESTRICT in_1, const T *RES
   return out_pos;
 }
 
+template <typename T>
+static inline uint32_t FilterVectorBetween(const T *RESTRICT in, uint32_t in_count, T lo, T hi, uint32_t *RESTRICT out,
+                                           const uint32_t *RESTRICT sel, uint32_t *RESTRICT in_pos) {
+  using Vec = typename FilterVecSizer<T>::Vec;
+  using VecMask = typename FilterVecSizer<T>::VecMask;
+
+  const Vec xlo(lo), xhi(hi);
+
+  uint32_t out_pos = 0;
+
+  if (sel == nullptr) {
+    Vec in_vec;
+    for (*in_pos = 0; *in_pos + Vec::Size() < in_count; *in_pos += Vec::Size()) {
+      in_vec.Load(in + *in_pos);
+      VecMask mask = (in_vec >= xlo) & (in_vec <= xhi);
+      out_pos += mask.ToPositions(out + out_pos, *in_pos);
+    }
+  } else {
+    Vec in_vec, sel_vec;
+    for (*in_pos = 0; *in_pos + Vec::Size() < in_count; *in_pos += Vec::Size()) {
+      sel_vec.Load(sel + *in_pos);
+      in_vec.Gather(in, sel_vec);
+      VecMask mask = (in_vec >= xlo) & (in_vec <= xhi);
+      out_pos += mask.ToPositions(out + out_pos, sel_vec);
+    }
+  }
+
+  return out_pos;
+}
+
+template <typename T>
+static inline uint32_t FilterVectorIn(const T *RESTRICT in, uint32_t in_count, const T *RESTRICT vals,
+                                      uint32_t num_vals, uint32_t *RESTRICT out, const uint32_t *RESTRICT sel,
+                                      uint32_t *RESTRICT in_pos) {
+  using Vec = typename FilterVecSizer<T>::Vec;
+  using VecMask = typename FilterVecSizer<T>::VecMask;
+
+  uint32_t out_pos = 0;
+
+  if (sel == nullptr) {
+    Vec in_vec;
+    for (*in_pos = 0; *in_pos + Vec::Size() < in_count; *in_pos += Vec::Size()) {
+      in_vec.Load(in + *in_pos);
+      VecMask mask = (in_vec == Vec(vals[0]));
+      for (uint32_t i = 1; i < num_vals; i++) {
+        mask = mask | (in_vec == Vec(vals[i]));
+      }
+      out_pos += mask.ToPositions(out + out_pos, *in_pos);
+    }
+  } else {
+    Vec in_vec, sel_vec;
+    for (*in_pos = 0; *in_pos + Vec::Size() < in_count; *in_pos += Vec::Size()) {
+      sel_vec.Load(sel + *in_pos);
+      in_vec.Gather(in, sel_vec);
+      VecMask mask = (in_vec == Vec(vals[0]));
+      for (uint32_t i = 1; i < num_vals; i++) {
+        mask = mask | (in_vec == Vec(vals[i]));
+      }
+      out_pos += mask.ToPositions(out + out_pos, sel_vec);
+    }
+  }
+
+  return out_pos;
+}
+
 }  // namespace terrier::execution::util::simd
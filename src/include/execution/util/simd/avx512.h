@@ -632,6 +632,26 @@ ALWAYS_INLINE inline Vec512b operator|(const Vec512b &a, const Vec512b &b) { ret
 
 ALWAYS_INLINE inline Vec512b operator^(const Vec512b &a, const Vec512b &b) { return Vec512b(_mm512_xor_si512(a, b)); }
 
+// ---------------------------------------------------------
+// Vec8Mask and Vec16Mask Bitwise Operations
+// ---------------------------------------------------------
+
+ALWAYS_INLINE inline Vec8Mask operator&(const Vec8Mask &a, const Vec8Mask &b) {
+  return Vec8Mask(static_cast<__mmask8>(static_cast<__mmask8>(a) & static_cast<__mmask8>(b)));
+}
+
+ALWAYS_INLINE inline Vec8Mask operator|(const Vec8Mask &a, const Vec8Mask &b) {
+  return Vec8Mask(static_cast<__mmask8>(static_cast<__mmask8>(a) | static_cast<__mmask8>(b)));
+}
+
+ALWAYS_INLINE inline Vec16Mask operator&(const Vec16Mask &a, const Vec16Mask &b) {
+  return Vec16Mask(static_cast<__mmask16>(static_cast<__mmask16>(a) & static_cast<__mmask16>(b)));
+}
+
+ALWAYS_INLINE inline Vec16Mask operator|(const Vec16Mask &a, const Vec16Mask &b) {
+  return Vec16Mask(static_cast<__mmask16>(static_cast<__mmask16>(a) | static_cast<__mmask16>(b)));
+}
+
 // ---------------------------------------------------------
 // Vec8 Comparison Operations
 // ---------------------------------------------------------
@@ -1042,4 +1062,69 @@ static inline uint32_t FilterVectorByVector(const T *RESTRICT in_1, const T *RES
   return out_pos;
 }
 
+template <typename T>
+static inline uint32_t FilterVectorBetween(const T *RESTRICT in, uint32_t in_count, T lo, T hi, uint32_t *RESTRICT out,
+                                           const uint32_t *RESTRICT sel, uint32_t *RESTRICT in_pos) {
+  using Vec = typename FilterVecSizer<T>::Vec;
+  using VecMask = typename FilterVecSizer<T>::VecMask;
+
+  const Vec xlo(lo), xhi(hi);
+
+  uint32_t out_pos = 0;
+
+  if (sel == nullptr) {
+    Vec in_vec;
+    for (*in_pos = 0; *in_pos + Vec::Size() < in_count; *in_pos += Vec::Size()) {
+      in_vec.Load(in + *in_pos);
+      VecMask mask = (in_vec >= xlo) & (in_vec <= xhi);
+      out_pos += mask.ToPositions(out + out_pos, *in_pos);
+    }
+  } else {
+    Vec in_vec, sel_vec;
+    for (*in_pos = 0; *in_pos + Vec::Size() < in_count; *in_pos += Vec::Size()) {
+      sel_vec.Load(sel + *in_pos);
+      in_vec.Gather(in, sel_vec);
+      VecMask mask = (in_vec >= xlo) & (in_vec <= xhi);
+      out_pos += mask.ToPositions(out + out_pos, sel_vec);
+    }
+  }
+
+  return out_pos;
+}
+
+template <typename T>
+static inline uint32_t FilterVectorIn(const T *RESTRICT in, uint32_t in_count, const T *RESTRICT vals,
+                                      uint32_t num_vals, uint32_t *RESTRICT out, const uint32_t *RESTRICT sel,
+                                      uint32_t *RESTRICT in_pos) {
+  using Vec = typename FilterVecSizer<T>::Vec;
+  using VecMask = typename FilterVecSizer<T>::VecMask;
+
+  uint32_t out_pos = 0;
+
+  if (sel == nullptr) {
+    Vec in_vec;
+    for (*in_pos = 0; *in_pos + Vec::Size() < in_count; *in_pos += Vec::Size()) {
+      in_vec.Load(in + *in_pos);
+      VecMask mask = (in_vec == Vec(vals[0]));
+      for (uint32_t i = 1; i < num_vals; i++) {
+        mask = mask | (in_vec == Vec(vals[i]));
+      }
+      out_pos += mask.ToPositions(out + out_pos, *in_pos);
+    }
+  } else {
+    Vec in_vec, sel_vec;
+    for (*in_pos = 0; *in_pos + Vec::Size() < in_count; *in_pos += Vec::Size()) {
+      sel_vec.Load(sel + *in_pos);
+      in_vec.Gather(in, sel_vec);
+      VecMask mask = (in_vec == Vec(vals[0]));
+      for (uint32_t i = 1; i < num_vals; i++) {
+        mask = mask | (in_vec == Vec(vals[i]));
+      }
+      out_pos += mask.ToPositions(out + out_pos, sel_vec);
+    }
+  }
+
+  return out_pos;
+}
+
 }  // namespace terrier::execution::util::simd
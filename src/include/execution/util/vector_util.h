@@ -1,9 +1,13 @@
 #pragma once
 
+#include <algorithm>
+#include <cstring>
 #include <functional>
+#include <type_traits>
 
 #include "execution/util/execution_common.h"
 #include "execution/util/simd.h"
+#include "storage/storage_defs.h"
 
 namespace terrier::execution::util {
 
@@ -20,7 +24,8 @@ class VectorUtil {
   /**
    * Filter an input vector by a constant value and store the indexes of valid
    * elements in the output vector. If a selection vector is provided, only
-   * vector elements from the selection vector will be read.
+   * vector elements from the selection vector will be read. Integer vectors are
+   * filtered with SIMD instructions, floating-point vectors without branches.
    * @tparam T The data type of the elements stored in the input vector.
    * @tparam Op The filter comparison operation.
    * @param in The input vector.
@@ -37,10 +42,11 @@ class VectorUtil {
     static_assert(std::is_same_v<bool, std::invoke_result_t<Op<T>, T, T>>);
 
     uint32_t in_pos = 0;
-#if defined(__AVX2__) || defined(__AVX512F__)
-    uint32_t out_pos = simd::FilterVectorByVal<T, Op>(in, in_count, val, out, sel, &in_pos);
-#else
     uint32_t out_pos = 0;
+#if defined(__AVX2__) || defined(__AVX512F__)
+    if constexpr (std::is_integral_v<T>) {
+      out_pos = simd::FilterVectorByVal<T, Op>(in, in_count, val, out, sel, &in_pos);
+    }
 #endif
 
     if (sel == nullptr) {
@@ -81,10 +87,11 @@ class VectorUtil {
     static_assert(std::is_same_v<bool, std::invoke_result_t<Op<T>, T, T>>);
 
     uint32_t in_pos = 0;
-#if defined(__AVX2__) || defined(__AVX512F__)
-    uint32_t out_pos = simd::FilterVectorByVector<T, Op>(in_1, in_2, in_count, out, sel, &in_pos);
-#else
     uint32_t out_pos = 0;
+#if defined(__AVX2__) || defined(__AVX512F__)
+    if constexpr (std::is_integral_v<T>) {
+      out_pos = simd::FilterVectorByVector<T, Op>(in_1, in_2, in_count, out, sel, &in_pos);
+    }
 #endif
 
     if (sel == nullptr) {
@@ -104,6 +111,163 @@ class VectorUtil {
     return out_pos;
   }
 
+  /**
+   * Filter an input vector by a range, and store the indexes of the elements in
+   * [lo, hi] in the output vector. Both bounds are checked in a single pass.
+   * If a selection vector is provided, only vector elements from the selection
+   * vector will be read.
+   * @tparam T The data type of the elements stored in the input vector.
+   * @param in The input vector.
+   * @param in_count The number of elements in the input (or selection) vector.
+   * @param lo The inclusive lower bound.
+   * @param hi The inclusive upper bound.
+   * @param[out] out The vector storing indexes of valid input elements.
+   * @param sel The selection vector used to read input values.
+   * @return The number of elements that pass the filter.
+   */
+  template <typename T>
+  static uint32_t FilterVectorBetween(const T *RESTRICT in, const uint32_t in_count, const T lo, const T hi,
+                                      uint32_t *RESTRICT out, const uint32_t *RESTRICT sel) {
+    uint32_t in_pos = 0;
+    uint32_t out_pos = 0;
+#if defined(__AVX2__) || defined(__AVX512F__)
+    if constexpr (std::is_integral_v<T>) {
+      out_pos = simd::FilterVectorBetween<T>(in, in_count, lo, hi, out, sel, &in_pos);
+    }
+#endif
+
+    if (sel == nullptr) {
+      for (; in_pos < in_count; in_pos++) {
+        const T val = in[in_pos];
+        out[out_pos] = in_pos;
+        out_pos += static_cast<uint32_t>(lo <= val) & static_cast<uint32_t>(val <= hi);
+      }
+    } else {
+      for (; in_pos < in_count; in_pos++) {
+        const T val = in[sel[in_pos]];
+        out[out_pos] = sel[in_pos];
+        out_pos += static_cast<uint32_t>(lo <= val) & static_cast<uint32_t>(val <= hi);
+      }
+    }
+
+    return out_pos;
+  }
+
+  /**
+   * Filter an input vector by a list of values, and store the indexes of the
+   * elements equal to any of them in the output vector. Every element is
+   * compared with every value, so the list should be short. If a selection
+   * vector is provided, only vector elements from the selection vector will be
+   * read.
+   * @tparam T The data type of the elements stored in the input vector.
+   * @param in The input vector.
+   * @param in_count The number of elements in the input (or selection) vector.
+   * @param vals The list of values.
+   * @param num_vals The number of values in the list.
+   * @param[out] out The vector storing indexes of valid input elements.
+   * @param sel The selection vector used to read input values.
+   * @return The number of elements that pass the filter.
+   */
+  template <typename T>
+  static uint32_t FilterVectorIn(const T *RESTRICT in, const uint32_t in_count, const T *RESTRICT vals,
+                                 const uint32_t num_vals, uint32_t *RESTRICT out, const uint32_t *RESTRICT sel) {
+    if (num_vals == 0) {
+      return 0;
+    }
+
+    uint32_t in_pos = 0;
+    uint32_t out_pos = 0;
+#if defined(__AVX2__) || defined(__AVX512F__)
+    if constexpr (std::is_integral_v<T>) {
+      out_pos = simd::FilterVectorIn<T>(in, in_count, vals, num_vals, out, sel, &in_pos);
+    }
+#endif
+
+    for (; in_pos < in_count; in_pos++) {
+      const uint32_t pos = (sel == nullptr ? in_pos : sel[in_pos]);
+      uint32_t match = 0;
+      for (uint32_t i = 0; i < num_vals; i++) {
+        match |= static_cast<uint32_t>(in[pos] == vals[i]);
+      }
+      out[out_pos] = pos;
+      out_pos += match;
+    }
+
+    return out_pos;
+  }
+
+  /**
+   * Filter an input vector by a bitmap, and store the indexes of the elements
+   * whose bit is set in the output vector. Bits are numbered from the least
+   * significant bit of the first byte on, as in the NULL bitmaps of a
+   * ProjectedColumns. If a selection vector is provided, only the bits of the
+   * elements in the selection vector will be read.
+   * @param bitmap The bitmap.
+   * @param in_count The number of elements in the input (or selection) vector.
+   * @param[out] out The vector storing indexes of valid input elements.
+   * @param sel The selection vector used to read bits.
+   * @return The number of elements that pass the filter.
+   */
+  static uint32_t FilterByBitmap(const uint8_t *RESTRICT bitmap, const uint32_t in_count, uint32_t *RESTRICT out,
+                                 const uint32_t *RESTRICT sel) {
+    uint32_t out_pos = 0;
+    if (sel == nullptr) {
+      for (uint32_t in_pos = 0; in_pos < in_count; in_pos++) {
+        out[out_pos] = in_pos;
+        out_pos += static_cast<uint32_t>(bitmap[in_pos / 8] >> (in_pos % 8)) & 1u;
+      }
+    } else {
+      for (uint32_t in_pos = 0; in_pos < in_count; in_pos++) {
+        const uint32_t pos = sel[in_pos];
+        out[out_pos] = pos;
+        out_pos += static_cast<uint32_t>(bitmap[pos / 8] >> (pos % 8)) & 1u;
+      }
+    }
+    return out_pos;
+  }
+
+  /**
+   * Filter an input vector of strings by a constant string, and store the
+   * indexes of the equal strings in the output vector. The sizes and the
+   * prefixes stored in the varlen entries are compared first, so only the
+   * contents of the few strings that match them are read. If a selection
+   * vector is provided, only vector elements from the selection vector will be
+   * read.
+   * @param in The input vector.
+   * @param in_count The number of elements in the input (or selection) vector.
+   * @param val The constant string.
+   * @param val_len The length of the constant string.
+   * @param[out] out The vector storing indexes of valid input elements.
+   * @param sel The selection vector used to read input values.
+   * @return The number of elements that pass the filter.
+   */
+  static uint32_t FilterStringEq(const storage::VarlenEntry *RESTRICT in, const uint32_t in_count,
+                                 const byte *RESTRICT val, const uint32_t val_len, uint32_t *RESTRICT out,
+                                 const uint32_t *RESTRICT sel) {
+    return FilterStringByPrefix<true>(in, in_count, val, val_len, out, sel);
+  }
+
+  /**
+   * Filter an input vector of strings by a constant prefix, i.e., LIKE 'abc%',
+   * and store the indexes of the strings starting with it in the output
+   * vector. The sizes and the prefixes stored in the varlen entries are
+   * compared first, so only the contents of the few strings that match them are
+   * read. If a selection vector is provided, only vector elements from the
+   * selection vector will be read.
+   * @param in The input vector.
+   * @param in_count The number of elements in the input (or selection) vector.
+   * @param prefix The constant prefix.
+   * @param prefix_len The length of the constant prefix.
+   * @param[out] out The vector storing indexes of valid input elements.
+   * @param sel The selection vector used to read input values.
+   * @return The number of elements that pass the filter.
+   */
+  static uint32_t FilterStringPrefix(const storage::VarlenEntry *RESTRICT in, const uint32_t in_count,
+                                     const byte *RESTRICT prefix, const uint32_t prefix_len, uint32_t *RESTRICT out,
+                                     const uint32_t *RESTRICT sel) {
+    return FilterStringByPrefix<false>(in, in_count, prefix, prefix_len, out, sel);
+  }
+
   /**
    * Gather potentially non-contiguous indexes from an input vector and store
    * them into an output vector. Only elements whose indexes are stored in the
@@ -181,6 +345,51 @@ class VectorUtil {
                             uint32_t *RESTRICT sel) -> std::enable_if_t<std::is_pointer_v<T>, uint32_t> {
     return FilterNe(reinterpret_cast<const intptr_t *>(in), in_count, intptr_t(0), out, sel);
   }
+
+ private:
+  // Filter strings by equality with (Exact = true) or by starting with
+  // (Exact = false) the given string. The first pass only reads the varlen
+  // entries: the size and the first PrefixSize() bytes of every string, which
+  // the entry stores inline. The second pass compares the remaining bytes of
+  // the strings that passed the first one.
+  template <bool Exact>
+  static uint32_t FilterStringByPrefix(const storage::VarlenEntry *RESTRICT in, const uint32_t in_count,
+                                       const byte *RESTRICT val, const uint32_t val_len, uint32_t *RESTRICT out,
+                                       const uint32_t *RESTRICT sel) {
+    constexpr uint32_t prefix_size = storage::VarlenEntry::PrefixSize();
+    static_assert(prefix_size == sizeof(uint32_t), "Prefixes are compared as 32-bit words");
+
+    // The prefix bytes of short strings past their end are undefined, so only
+    // the bytes of the constant's prefix are compared
+    const uint32_t cmp_len = std::min(val_len, prefix_size);
+    uint32_t val_prefix = 0;
+    std::memcpy(&val_prefix, val, cmp_len);
+    const uint32_t prefix_mask = (cmp_len == prefix_size ? ~0u : (1u << (cmp_len * 8)) - 1);
+
+    uint32_t out_pos = 0;
+    for (uint32_t in_pos = 0; in_pos < in_count; in_pos++) {
+      const uint32_t pos = (sel == nullptr ? in_pos : sel[in_pos]);
+      uint32_t entry_prefix;
+      std::memcpy(&entry_prefix, in[pos].Prefix(), prefix_size);
+      const uint32_t size = in[pos].Size();
+      const bool size_match = Exact ? size == val_len : size >= val_len;
+      out[out_pos] = pos;
+      out_pos += static_cast<uint32_t>(size_match) & static_cast<uint32_t>((entry_prefix & prefix_mask) == val_prefix);
+    }
+
+    if (val_len <= prefix_size) {
+      return out_pos;
+    }
+
+    uint32_t num_selected = 0;
+    for (uint32_t idx = 0; idx < out_pos; idx++) {
+      const uint32_t pos = out[idx];
+      const bool match = std::memcmp(in[pos].Content() + prefix_size, val + prefix_size, val_len - prefix_size) == 0;
+      out[num_selected] = pos;
+      num_selected += static_cast<uint32_t>(match);
+    }
+    return num_selected;
+  }
 };
 
 }  // namespace terrier::execution::util
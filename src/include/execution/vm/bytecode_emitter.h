@@ -322,8 +322,8 @@ class BytecodeEmitter {
   /**
    * Emit a parallel table scan
    */
-  void EmitParallelTableScan(uint32_t db_oid, uint32_t table_oid, LocalVar ctx, LocalVar thread_states,
-                             FunctionId scan_fn);
+  void EmitParallelTableScan(LocalVar exec_ctx, uint32_t table_oid, LocalVar col_oids, uint32_t num_oids,
+                             LocalVar query_state, LocalVar thread_states, FunctionId scan_fn);
 
   // Reading integer values from an iterator
   /**
@@ -347,6 +347,42 @@ class BytecodeEmitter {
   void EmitPCIVectorFilter(Bytecode bytecode, LocalVar selected, LocalVar pci, uint32_t col_idx, int8_t type,
                            int64_t val);
 
+  /**
+   * Filter a column in the iterator by a range of constant values
+   * @param selected output variable for the number of selected values
+   * @param pci PCI to filter
+   * @param col_idx index of the iterator to filter
+   * @param type type of the column
+   * @param lo inclusive lower bound
+   * @param hi inclusive upper bound
+   */
+  void EmitPCIVectorFilterBetween(LocalVar selected, LocalVar pci, uint32_t col_idx, int8_t type, int64_t lo,
+                                  int64_t hi);
+
+  /**
+   * Filter a column in the iterator by a list of constant values
+   * @param selected output variable for the number of selected values
+   * @param pci PCI to filter
+   * @param col_idx index of the iterator to filter
+   * @param type type of the column
+   * @param vals array of values
+   * @param num_vals number of values
+   */
+  void EmitPCIVectorFilterIn(LocalVar selected, LocalVar pci, uint32_t col_idx, int8_t type, LocalVar vals,
+                             uint32_t num_vals);
+
+  /**
+   * Filter a string column in the iterator by a constant string
+   * @param bytecode filter bytecode to emit
+   * @param selected output variable for the number of selected values
+   * @param pci PCI to filter
+   * @param col_idx index of the iterator to filter
+   * @param data offset of the string in the module's static data
+   * @param length length of the string
+   */
+  void EmitPCIStringFilter(Bytecode bytecode, LocalVar selected, LocalVar pci, uint32_t col_idx, uint32_t data,
+                           uint32_t length);
+
   /**
    * Insert a filter flavor into the filter manager builder
    */
@@ -380,6 +416,11 @@ class BytecodeEmitter {
   void EmitJoinHashTableIterHasNext(LocalVar has_more, LocalVar iterator, FunctionId key_eq, LocalVar opaque_ctx,
                                     LocalVar probe_tuple);
 
+  /**
+   * Emit code to join the spilled partitions of a join hash table
+   */
+  void EmitJoinHashTableJoinSpilledPartitions(LocalVar join_hash_table, LocalVar ctx, FunctionId probe_fn);
+
   /**
    * Initialize a sorter instance
    */
@@ -459,9 +500,9 @@ class BytecodeEmitter {
    * @param bytecode bytecode to emit
    * @param out where to store the result
    * @param length length of the string
-   * @param data pointer to the char array
+   * @param data offset of the char array in the module's static data
    */
-  void EmitInitString(Bytecode bytecode, LocalVar out, uint64_t length, uintptr_t data);
+  void EmitInitString(Bytecode bytecode, LocalVar out, uint64_t length, uint32_t data);
 
   /**
    * Copy a scalar immediate value into the bytecode stream
@@ -44,10 +44,11 @@ class BytecodeGenerator : public ast::AstVisitor<BytecodeGenerator> {
    * @param root root of the ast to compile
    * @param exec_ctx execution context of this query
    * @param name name of the module
+   * @param optimize whether to run the BytecodeOptimizer over the generated bytecode
    * @return compiled module
    */
   static std::unique_ptr<BytecodeModule> Compile(ast::AstNode *root, exec::ExecutionContext *exec_ctx,
-                                                 const std::string &name);
+                                                 const std::string &name, bool optimize = true);
 
  private:
   // Private constructor to force users to call Compile()
@@ -74,6 +75,8 @@ class BytecodeGenerator : public ast::AstVisitor<BytecodeGenerator> {
   void VisitBuiltinAggHashTableCall(ast::CallExpr *call, ast::Builtin builtin);
   void VisitBuiltinAggHashTableIterCall(ast::CallExpr *call, ast::Builtin builtin);
   void VisitBuiltinAggPartIterCall(ast::CallExpr *call, ast::Builtin builtin);
+  void VisitBuiltinDirectMappedAggTableCall(ast::CallExpr *call, ast::Builtin builtin);
+  void VisitBuiltinDirectMappedAggTableIterCall(ast::CallExpr *call, ast::Builtin builtin);
   void VisitBuiltinAggregatorCall(ast::CallExpr *call, ast::Builtin builtin);
   void VisitBuiltinJoinHashTableCall(ast::CallExpr *call, ast::Builtin builtin);
   void VisitBuiltinSorterCall(ast::CallExpr *call, ast::Builtin builtin);
@@ -81,6 +84,7 @@ class BytecodeGenerator : public ast::AstVisitor<BytecodeGenerator> {
   void VisitExecutionContextCall(ast::CallExpr *call, ast::Builtin builtin);
   void VisitBuiltinThreadStateContainerCall(ast::CallExpr *call, ast::Builtin builtin);
   void VisitBuiltinSizeOfCall(ast::CallExpr *call);
+  void VisitBuiltinOffsetOfCall(ast::CallExpr *call);
   void VisitBuiltinTrigCall(ast::CallExpr *call, ast::Builtin builtin);
   void VisitBuiltinOutputCall(ast::CallExpr *call, ast::Builtin builtin);
   void VisitBuiltinIndexIteratorCall(ast::CallExpr *call, ast::Builtin builtin);
@@ -138,6 +142,9 @@ class BytecodeGenerator : public ast::AstVisitor<BytecodeGenerator> {
 
   Bytecode GetIntTypedBytecode(Bytecode bytecode, ast::Type *type);
 
+  // Copy a string literal into the module's static data, and return its offset there
+  uint32_t NewStaticString(ast::Identifier string);
+
  public:
   /**
    * @return the bytecode emitter
@@ -162,6 +169,10 @@ class BytecodeGenerator : public ast::AstVisitor<BytecodeGenerator> {
   // The bytecode generated during compilation
   std::vector<uint8_t> bytecode_;
 
+  // Constant data the bytecode refers to, and the offsets of the string literals in it
+  std::vector<uint8_t> static_data_;
+  std::unordered_map<std::string, uint32_t> static_strings_;
+
   // Information about all generated functions
   std::vector<FunctionInfo> functions_;
 
@@ -10,6 +10,7 @@
 #include "execution/exec/execution_context.h"
 #include "execution/sql/aggregation_hash_table.h"
 #include "execution/sql/aggregators.h"
+#include "execution/sql/direct_mapped_aggregation_table.h"
 #include "execution/sql/filter_manager.h"
 #include "execution/sql/functions/arithmetic_functions.h"
 #include "execution/sql/functions/comparison_functions.h"
@@ -170,6 +171,37 @@ VM_OP_HOT bool OpJumpIfTrue(bool cond) { return cond; }
 
 VM_OP_HOT bool OpJumpIfFalse(bool cond) { return !cond; }
 
+// ---------------------------------------------------------
+// Superinstructions ending in a conditional jump. Each returns whether the
+// jump is taken.
+// ---------------------------------------------------------
+
+#define COMPARISON_JUMPS(type, ...)                                                           \
+  VM_OP_HOT bool OpJumpIfGreaterThan##_##type(type lhs, type rhs) { return lhs > rhs; }       \
+  VM_OP_HOT bool OpJumpIfGreaterThanEqual##_##type(type lhs, type rhs) { return lhs >= rhs; } \
+  VM_OP_HOT bool OpJumpIfEqual##_##type(type lhs, type rhs) { return lhs == rhs; }            \
+  VM_OP_HOT bool OpJumpIfLessThan##_##type(type lhs, type rhs) { return lhs < rhs; }          \
+  VM_OP_HOT bool OpJumpIfLessThanEqual##_##type(type lhs, type rhs) { return lhs <= rhs; }    \
+  VM_OP_HOT bool OpJumpIfNotEqual##_##type(type lhs, type rhs) { return lhs != rhs; }
+
+INT_TYPES(COMPARISON_JUMPS);
+
+#undef COMPARISON_JUMPS
+
+VM_OP_HOT bool OpJumpIfTruth(const terrier::execution::sql::BoolVal *input) { return input->ForceTruth(); }
+
+VM_OP_HOT bool OpJumpIfNotTruth(const terrier::execution::sql::BoolVal *input) { return !input->ForceTruth(); }
+
+VM_OP_HOT bool OpPCIAdvanceJumpIfHasNext(terrier::execution::sql::ProjectedColumnsIterator *pci) {
+  pci->Advance();
+  return pci->HasNext();
+}
+
+VM_OP_HOT bool OpPCIAdvanceFilteredJumpIfHasNext(terrier::execution::sql::ProjectedColumnsIterator *pci) {
+  pci->AdvanceFiltered();
+  return pci->HasNextFiltered();
+}
+
 VM_OP_HOT void OpCall(UNUSED_ATTRIBUTE uint16_t func_id, UNUSED_ATTRIBUTE uint16_t num_args) {}
 
 VM_OP_HOT void OpReturn() {}
@@ -222,10 +254,21 @@ VM_OP_HOT void OpTableVectorIteratorGetPCI(terrier::execution::sql::ProjectedCol
   *pci = iter->GetProjectedColumnsIterator();
 }
 
-VM_OP_HOT void OpParallelScanTable(const uint32_t db_oid, const uint32_t table_oid, void *const query_state,
+VM_OP void OpTableVectorIteratorSetTopKThreshold(terrier::execution::sql::TableVectorIterator *iter,
+                                                 const terrier::execution::sql::TopKThreshold *threshold,
+                                                 uint32_t col_idx, int32_t col_type);
+
+VM_OP void OpTableVectorIteratorAddRuntimeFilter(terrier::execution::sql::TableVectorIterator *iter,
+                                                 terrier::execution::sql::JoinHashTable *join_hash_table,
+                                                 uint32_t col_idx, int32_t col_type);
+
+VM_OP_HOT void OpParallelScanTable(terrier::execution::exec::ExecutionContext *const exec_ctx,
+                                   const uint32_t table_oid, uint32_t *const col_oids, const uint32_t num_oids,
+                                   void *const query_state,
                                    terrier::execution::sql::ThreadStateContainer *const thread_states,
                                    const terrier::execution::sql::TableVectorIterator::ScanFn scanner) {
-  terrier::execution::sql::TableVectorIterator::ParallelScan(db_oid, table_oid, query_state, thread_states, scanner);
+  terrier::execution::sql::TableVectorIterator::ParallelScan(exec_ctx, table_oid, col_oids, num_oids, query_state,
+                                                             thread_states, scanner);
 }
 
 VM_OP_HOT void OpPCIIsFiltered(bool *is_filtered, terrier::execution::sql::ProjectedColumnsIterator *pci) {
@@ -470,6 +513,22 @@ VM_OP void OpPCIFilterLessThanEqual(uint64_t *size, terrier::execution::sql::Pro
 VM_OP void OpPCIFilterNotEqual(uint64_t *size, terrier::execution::sql::ProjectedColumnsIterator *iter,
                                uint32_t col_idx, int8_t type, int64_t val);
 
+VM_OP void OpPCIFilterBetween(uint64_t *size, terrier::execution::sql::ProjectedColumnsIterator *iter, uint32_t col_idx,
+                              int8_t type, int64_t lo, int64_t hi);
+
+VM_OP void OpPCIFilterIn(uint64_t *size, terrier::execution::sql::ProjectedColumnsIterator *iter, uint32_t col_idx,
+                         int8_t type, const int64_t *vals, uint32_t num_vals);
+
+VM_OP_HOT void OpPCIFilterStringEq(uint64_t *size, terrier::execution::sql::ProjectedColumnsIterator *iter,
+                                   uint32_t col_idx, const uint8_t *data, uint32_t length) {
+  *size = iter->FilterColStringEq(col_idx, reinterpret_cast<const terrier::byte *>(data), length);
+}
+
+VM_OP_HOT void OpPCIFilterStringPrefix(uint64_t *size, terrier::execution::sql::ProjectedColumnsIterator *iter,
+                                       uint32_t col_idx, const uint8_t *data, uint32_t length) {
+  *size = iter->FilterColStringPrefix(col_idx, reinterpret_cast<const terrier::byte *>(data), length);
+}
+
 // ---------------------------------------------------------
 // Hashing
 // ---------------------------------------------------------
@@ -540,8 +599,8 @@ VM_OP_HOT void OpInitDate(terrier::execution::sql::Date *result, int16_t year, u
   result->ymd_ = date::year(year) / month / day;
 }
 
-VM_OP_HOT void OpInitString(terrier::execution::sql::StringVal *result, uint64_t length, uintptr_t data) {
-  *result = terrier::execution::sql::StringVal(reinterpret_cast<char *>(data), static_cast<uint32_t>(length));
+VM_OP_HOT void OpInitString(terrier::execution::sql::StringVal *result, uint64_t length, const uint8_t *data) {
+  *result = terrier::execution::sql::StringVal(reinterpret_cast<const char *>(data), static_cast<uint32_t>(length));
 }
 
 VM_OP_HOT void OpInitVarlen(terrier::execution::sql::StringVal *result, uintptr_t data) {
@@ -748,6 +807,56 @@ VM_OP_HOT void OpAggregationOverflowPartitionIteratorGetRow(
   *row = iter->GetPayload();
 }
 
+// ---------------------------------------------------------
+// Direct-Mapped Aggregation Table
+// ---------------------------------------------------------
+
+VM_OP void OpDirectMappedAggregationTableInit(terrier::execution::sql::DirectMappedAggregationTable *table,
+                                              terrier::execution::sql::MemoryPool *memory, uint32_t payload_size,
+                                              int64_t min_key, int64_t max_key);
+
+VM_OP_HOT void OpDirectMappedAggregationTableInDomain(bool *result,
+                                                      terrier::execution::sql::DirectMappedAggregationTable *table,
+                                                      const terrier::execution::sql::Integer *key) {
+  *result = table->InDomain(key->val_);
+}
+
+VM_OP_HOT void OpDirectMappedAggregationTableLookup(terrier::byte **result,
+                                                    terrier::execution::sql::DirectMappedAggregationTable *table,
+                                                    const terrier::execution::sql::Integer *key) {
+  *result = table->Lookup(key->val_);
+}
+
+VM_OP_HOT void OpDirectMappedAggregationTableInsert(terrier::byte **result,
+                                                    terrier::execution::sql::DirectMappedAggregationTable *table,
+                                                    const terrier::execution::sql::Integer *key) {
+  *result = table->Insert(key->val_);
+}
+
+VM_OP void OpDirectMappedAggregationTableFree(terrier::execution::sql::DirectMappedAggregationTable *table);
+
+VM_OP void OpDirectMappedAggregationTableIteratorInit(
+    terrier::execution::sql::DirectMappedAggregationTableIterator *iter,
+    terrier::execution::sql::DirectMappedAggregationTable *table);
+
+VM_OP_HOT void OpDirectMappedAggregationTableIteratorHasNext(
+    bool *has_more, terrier::execution::sql::DirectMappedAggregationTableIterator *iter) {
+  *has_more = iter->HasNext();
+}
+
+VM_OP_HOT void OpDirectMappedAggregationTableIteratorNext(
+    terrier::execution::sql::DirectMappedAggregationTableIterator *iter) {
+  iter->Next();
+}
+
+VM_OP_HOT void OpDirectMappedAggregationTableIteratorGetRow(
+    const terrier::byte **row, terrier::execution::sql::DirectMappedAggregationTableIterator *iter) {
+  *row = iter->GetCurrentAggregateRow();
+}
+
+VM_OP void OpDirectMappedAggregationTableIteratorFree(
+    terrier::execution::sql::DirectMappedAggregationTableIterator *iter);
+
 //
 // COUNT
 //
@@ -1019,6 +1128,8 @@ VM_OP_HOT void OpJoinHashTableAllocTuple(terrier::byte **result,
 
 VM_OP void OpJoinHashTableBuild(terrier::execution::sql::JoinHashTable *join_hash_table);
 
+VM_OP void OpJoinHashTableBuildBloomFilter(terrier::execution::sql::JoinHashTable *join_hash_table);
+
 VM_OP void OpJoinHashTableBuildParallel(terrier::execution::sql::JoinHashTable *join_hash_table,
                                         terrier::execution::sql::ThreadStateContainer *thread_state_container,
                                         uint32_t jht_offset);
@@ -1045,6 +1156,19 @@ VM_OP_HOT void OpJoinHashTableIterClose(terrier::execution::sql::JoinHashTableIt
 
 VM_OP void OpJoinHashTableFree(terrier::execution::sql::JoinHashTable *join_hash_table);
 
+VM_OP void OpJoinHashTableEnableSpilling(terrier::execution::sql::JoinHashTable *join_hash_table);
+
+VM_OP_HOT void OpJoinHashTableIsSpilled(bool *result, terrier::execution::sql::JoinHashTable *join_hash_table,
+                                        terrier::hash_t hash) {
+  *result = join_hash_table->IsSpilled(hash);
+}
+
+VM_OP void OpJoinHashTableDeferProbeTuple(terrier::execution::sql::JoinHashTable *join_hash_table, terrier::hash_t hash,
+                                          const terrier::byte *probe_tuple, uint32_t probe_tuple_size);
+
+VM_OP void OpJoinHashTableJoinSpilledPartitions(terrier::execution::sql::JoinHashTable *join_hash_table, void *ctx,
+                                                terrier::execution::sql::JoinHashTable::SpilledProbeFn probe_fn);
+
 // ---------------------------------------------------------
 // Sorting
 // ---------------------------------------------------------
@@ -1076,6 +1200,11 @@ VM_OP void OpSorterSortTopKParallel(terrier::execution::sql::Sorter *sorter,
 
 VM_OP void OpSorterFree(terrier::execution::sql::Sorter *sorter);
 
+VM_OP void OpSorterSetTopKThreshold(terrier::execution::sql::Sorter *sorter,
+                                    terrier::execution::sql::TopKThreshold *threshold, uint32_t key_offset);
+
+VM_OP void OpTopKThresholdInit(terrier::execution::sql::TopKThreshold *threshold, bool ascending);
+
 VM_OP void OpSorterIteratorInit(terrier::execution::sql::SorterIterator *iter, terrier::execution::sql::Sorter *sorter);
 
 VM_OP_HOT void OpSorterIteratorHasNext(bool *has_more, terrier::execution::sql::SorterIterator *iter) {
@@ -126,6 +126,14 @@ class BytecodeIterator {
    */
   uint16_t GetFunctionIdOperand(uint32_t operand_index) const;
 
+  /**
+   * Get the operand at @a operand_index for the current bytecode as an offset
+   * into the static data of the module
+   * @param operand_index The index of the operand to read
+   * @return The offset into the module's static data
+   */
+  uint32_t GetStaticLocalOperand(uint32_t operand_index) const;
+
   /**
    * Return the total size in bytes of the bytecode instruction the iterator is
    * currently pointing to. This size includes variable length arguments.
@@ -20,9 +20,11 @@ class BytecodeModule {
    * functions are available for execution.
    * @param name The name of the module
    * @param code The bytecode that makes up the module
+   * @param static_data The constant data the bytecode refers to, like string literals
    * @param functions The functions within the module
    */
-  BytecodeModule(std::string name, std::vector<uint8_t> &&code, std::vector<FunctionInfo> &&functions);
+  BytecodeModule(std::string name, std::vector<uint8_t> &&code, std::vector<uint8_t> &&static_data,
+                 std::vector<FunctionInfo> &&functions);
 
   /**
    * This class cannot be copied or moved
@@ -78,6 +80,24 @@ class BytecodeModule {
    */
   const std::vector<FunctionInfo> &Functions() const { return functions_; }
 
+  /**
+   * Return the bytecode of all functions in this module
+   */
+  const std::vector<uint8_t> &Code() const { return code_; }
+
+  /**
+   * Return the constant data that StaticLocal operands of the bytecode are offsets into
+   */
+  const std::vector<uint8_t> &StaticData() const { return static_data_; }
+
+  /**
+   * Return the address of the static data at the given offset
+   */
+  const uint8_t *AccessStaticData(const uint32_t offset) const {
+    TERRIER_ASSERT(offset < static_data_.size(), "Invalid static data offset");
+    return &static_data_[offset];
+  }
+
   /**
    * Return the number of bytecode instructions in this module
    */
@@ -101,6 +121,7 @@ class BytecodeModule {
  private:
   const std::string name_;
   const std::vector<uint8_t> code_;
+  const std::vector<uint8_t> static_data_;
   const std::vector<FunctionInfo> functions_;
 };
 
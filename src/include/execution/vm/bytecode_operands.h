@@ -26,7 +26,8 @@ enum class OperandSize : uint8_t { None = 0, Byte = 1, Short = 2, Int = 4, Long
   V(JumpOffset, true, OperandSize::Int)    \
   V(Local, false, OperandSize::Int)        \
   V(LocalCount, false, OperandSize::Short) \
-  V(FunctionId, false, OperandSize::Short)
+  V(FunctionId, false, OperandSize::Short) \
+  V(StaticLocal, false, OperandSize::Int)
 
 /**
  * This enumeration lists all possible types of operands to any bytecode
@@ -79,6 +80,12 @@ class OperandTypes {
    */
   static constexpr bool IsLocalCount(OperandType operand_type) { return operand_type == OperandType::LocalCount; }
 
+  /**
+   * @param operand_type operand to check
+   * @return whether the operand is an offset into the module's static data
+   */
+  static constexpr bool IsStaticLocal(OperandType operand_type) { return operand_type == OperandType::StaticLocal; }
+
   /**
    * @return the maximum jump offset
    */
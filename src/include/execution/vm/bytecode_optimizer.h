@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "execution/vm/bytecode_function_info.h"
+
+namespace terrier::execution::vm {
+
+/**
+ * An optimization pass over the bytecode of a module, run after the BytecodeGenerator is done with it and before the
+ * module is created. The generator emits one bytecode per AST operation, into a fresh temporary local per
+ * intermediate result. The interpreter pays for a dispatch per bytecode and every local takes room in the frame. The
+ * optimizer cuts both, function by function:
+ *
+ * 1. Jump threading. Jumps to unconditional jumps go to their final target, and conditional jumps to a conditional
+ *    jump on the same condition go to where that one leads. Jumps to a return become returns, jumps to the next
+ *    instruction are removed. The jump back to the head of a loop is replaced by a copy of the loop's test, inverted
+ *    to jump back into the body, so every iteration runs one jump instead of two. Unreachable code is then removed.
+ * 2. Superinstructions. Common sequences are combined into a single bytecode: a primitive comparison and the
+ *    conditional jump on its result, forcing the truth of a SQL boolean and the conditional jump on it, and advancing
+ *    a ProjectedColumnsIterator, checking for more tuples and jumping back into the loop. A temporary computed only
+ *    to be copied elsewhere is computed there directly.
+ * 3. Dead local elimination. Instructions that only compute a temporary no one reads are removed, and locals no
+ *    instruction refers to anymore are dropped from the frame.
+ * 4. Local slot coalescing. Locals of the same type whose lifetimes don't overlap share a slot in the frame.
+ *
+ * The analyses behind passes 2 to 4 only consider locals whose address is never taken, other than to write a
+ * primitive value into them in full. The memory of all other locals may be read or written behind the optimizer's
+ * back, so they are left alone. Parameters are never touched and keep their position in the frame.
+ */
+class BytecodeOptimizer {
+ public:
+  /**
+   * Optimize the bytecode of all the given functions. On return, both the bytecode and the functions are updated.
+   * @param code The bytecode of the module
+   * @param functions The functions of the module
+   */
+  static void Optimize(std::vector<uint8_t> *code, std::vector<FunctionInfo> *functions);
+};
+
+}  // namespace terrier::execution::vm
@@ -62,6 +62,17 @@ namespace terrier::execution::vm {
   F(Jump, OperandType::JumpOffset)                                                                                    \
   F(JumpIfTrue, OperandType::Local, OperandType::JumpOffset)                                                          \
   F(JumpIfFalse, OperandType::Local, OperandType::JumpOffset)                                                         \
+  /* Superinstructions ending in a conditional jump, see BytecodeOptimizer. These must follow the other jumps. */     \
+  CREATE_FOR_INT_TYPES(F, JumpIfGreaterThan, OperandType::Local, OperandType::Local, OperandType::JumpOffset)         \
+  CREATE_FOR_INT_TYPES(F, JumpIfGreaterThanEqual, OperandType::Local, OperandType::Local, OperandType::JumpOffset)    \
+  CREATE_FOR_INT_TYPES(F, JumpIfEqual, OperandType::Local, OperandType::Local, OperandType::JumpOffset)               \
+  CREATE_FOR_INT_TYPES(F, JumpIfLessThan, OperandType::Local, OperandType::Local, OperandType::JumpOffset)            \
+  CREATE_FOR_INT_TYPES(F, JumpIfLessThanEqual, OperandType::Local, OperandType::Local, OperandType::JumpOffset)       \
+  CREATE_FOR_INT_TYPES(F, JumpIfNotEqual, OperandType::Local, OperandType::Local, OperandType::JumpOffset)            \
+  F(JumpIfTruth, OperandType::Local, OperandType::JumpOffset)                                                         \
+  F(JumpIfNotTruth, OperandType::Local, OperandType::JumpOffset)                                                      \
+  F(PCIAdvanceJumpIfHasNext, OperandType::Local, OperandType::JumpOffset)                                             \
+  F(PCIAdvanceFilteredJumpIfHasNext, OperandType::Local, OperandType::JumpOffset)                                     \
                                                                                                                       \
   /* Memory/pointer operations */                                                                                     \
   F(IsNullPtr, OperandType::Local, OperandType::Local)                                                                \
@@ -105,8 +116,12 @@ namespace terrier::execution::vm {
   F(TableVectorIteratorNext, OperandType::Local, OperandType::Local)                                                  \
   F(TableVectorIteratorFree, OperandType::Local)                                                                      \
   F(TableVectorIteratorGetPCI, OperandType::Local, OperandType::Local)                                                \
-  F(ParallelScanTable, OperandType::UImm4, OperandType::UImm4, OperandType::Local, OperandType::Local,                \
-    OperandType::FunctionId)                                                                                          \
+  F(TableVectorIteratorSetTopKThreshold, OperandType::Local, OperandType::Local, OperandType::Local,                  \
+    OperandType::Local)                                                                                               \
+  F(TableVectorIteratorAddRuntimeFilter, OperandType::Local, OperandType::Local, OperandType::Local,                  \
+    OperandType::Local)                                                                                               \
+  F(ParallelScanTable, OperandType::Local, OperandType::UImm4, OperandType::Local, OperandType::UImm4,                \
+    OperandType::Local, OperandType::Local, OperandType::FunctionId)                                                  \
                                                                                                                       \
   /* ProjectedColumns Iterator (PCI) */                                                                               \
   F(PCIIsFiltered, OperandType::Local, OperandType::Local)                                                            \
@@ -146,6 +161,14 @@ namespace terrier::execution::vm {
     OperandType::Imm8)                                                                                                \
   F(PCIFilterNotEqual, OperandType::Local, OperandType::Local, OperandType::UImm4, OperandType::Imm1,                 \
     OperandType::Imm8)                                                                                                \
+  F(PCIFilterBetween, OperandType::Local, OperandType::Local, OperandType::UImm4, OperandType::Imm1, OperandType::Imm8,\
+    OperandType::Imm8)                                                                                                \
+  F(PCIFilterIn, OperandType::Local, OperandType::Local, OperandType::UImm4, OperandType::Imm1, OperandType::Local,   \
+    OperandType::UImm4)                                                                                               \
+  F(PCIFilterStringEq, OperandType::Local, OperandType::Local, OperandType::UImm4, OperandType::StaticLocal,          \
+    OperandType::UImm4)                                                                                               \
+  F(PCIFilterStringPrefix, OperandType::Local, OperandType::Local, OperandType::UImm4, OperandType::StaticLocal,      \
+    OperandType::UImm4)                                                                                               \
                                                                                                                       \
   /* Filter Manager */                                                                                                \
   F(FilterManagerInit, OperandType::Local)                                                                            \
@@ -161,7 +184,7 @@ namespace terrier::execution::vm {
   F(InitInteger, OperandType::Local, OperandType::Local)                                                              \
   F(InitReal, OperandType::Local, OperandType::Local)                                                                 \
   F(InitDate, OperandType::Local, OperandType::Local, OperandType::Local, OperandType::Local)                         \
-  F(InitString, OperandType::Local, OperandType::Imm8, OperandType::Imm8)                                             \
+  F(InitString, OperandType::Local, OperandType::Imm8, OperandType::StaticLocal)                                      \
   F(InitVarlen, OperandType::Local, OperandType::Local)                                                               \
   F(LessThanInteger, OperandType::Local, OperandType::Local, OperandType::Local)                                      \
   F(LessThanEqualInteger, OperandType::Local, OperandType::Local, OperandType::Local)                                 \
@@ -232,6 +255,17 @@ namespace terrier::execution::vm {
   F(AggregationOverflowPartitionIteratorNext, OperandType::Local)                                                     \
   F(AggregationOverflowPartitionIteratorGetHash, OperandType::Local, OperandType::Local)                              \
   F(AggregationOverflowPartitionIteratorGetRow, OperandType::Local, OperandType::Local)                               \
+  F(DirectMappedAggregationTableInit, OperandType::Local, OperandType::Local, OperandType::Local, OperandType::Local, \
+    OperandType::Local)                                                                                               \
+  F(DirectMappedAggregationTableInDomain, OperandType::Local, OperandType::Local, OperandType::Local)                 \
+  F(DirectMappedAggregationTableLookup, OperandType::Local, OperandType::Local, OperandType::Local)                   \
+  F(DirectMappedAggregationTableInsert, OperandType::Local, OperandType::Local, OperandType::Local)                   \
+  F(DirectMappedAggregationTableFree, OperandType::Local)                                                             \
+  F(DirectMappedAggregationTableIteratorInit, OperandType::Local, OperandType::Local)                                 \
+  F(DirectMappedAggregationTableIteratorHasNext, OperandType::Local, OperandType::Local)                              \
+  F(DirectMappedAggregationTableIteratorNext, OperandType::Local)                                                     \
+  F(DirectMappedAggregationTableIteratorGetRow, OperandType::Local, OperandType::Local)                               \
+  F(DirectMappedAggregationTableIteratorFree, OperandType::Local)                                                     \
   /* Aggregates */                                                                                                    \
   F(CountAggregateInit, OperandType::Local)                                                                           \
   F(CountAggregateAdvance, OperandType::Local, OperandType::Local)                                                    \
@@ -299,17 +333,24 @@ namespace terrier::execution::vm {
   F(JoinHashTableIterClose, OperandType::Local)                                                                       \
   F(JoinHashTableBuild, OperandType::Local)                                                                           \
   F(JoinHashTableBuildParallel, OperandType::Local, OperandType::Local, OperandType::Local)                           \
+  F(JoinHashTableBuildBloomFilter, OperandType::Local)                                                                \
   F(JoinHashTableFree, OperandType::Local)                                                                            \
+  F(JoinHashTableEnableSpilling, OperandType::Local)                                                                  \
+  F(JoinHashTableIsSpilled, OperandType::Local, OperandType::Local, OperandType::Local)                               \
+  F(JoinHashTableDeferProbeTuple, OperandType::Local, OperandType::Local, OperandType::Local, OperandType::Local)     \
+  F(JoinHashTableJoinSpilledPartitions, OperandType::Local, OperandType::Local, OperandType::FunctionId)              \
                                                                                                                       \
   /* Sorting */                                                                                                       \
   F(SorterInit, OperandType::Local, OperandType::Local, OperandType::FunctionId, OperandType::Local)                  \
   F(SorterAllocTuple, OperandType::Local, OperandType::Local)                                                         \
-  F(SorterAllocTupleTopK, OperandType::Local, OperandType::Local)                                                     \
+  F(SorterAllocTupleTopK, OperandType::Local, OperandType::Local, OperandType::Local)                                 \
   F(SorterAllocTupleTopKFinish, OperandType::Local, OperandType::Local)                                               \
   F(SorterSort, OperandType::Local)                                                                                   \
   F(SorterSortParallel, OperandType::Local, OperandType::Local, OperandType::Local)                                   \
   F(SorterSortTopKParallel, OperandType::Local, OperandType::Local, OperandType::Local, OperandType::Local)           \
   F(SorterFree, OperandType::Local)                                                                                   \
+  F(SorterSetTopKThreshold, OperandType::Local, OperandType::Local, OperandType::Local)                               \
+  F(TopKThresholdInit, OperandType::Local, OperandType::Local)                                                        \
   F(SorterIteratorInit, OperandType::Local, OperandType::Local)                                                       \
   F(SorterIteratorGetRow, OperandType::Local, OperandType::Local)                                                     \
   F(SorterIteratorHasNext, OperandType::Local, OperandType::Local)                                                    \
@@ -526,7 +567,25 @@ class Bytecodes {
    * @return whether the given bytecode is a jump bytecode.
    */
   static constexpr bool IsJump(Bytecode bytecode) {
-    return (bytecode == Bytecode::Jump || bytecode == Bytecode::JumpIfFalse || bytecode == Bytecode::JumpIfTrue);
+    // All jumps are listed together, up to the last superinstruction
+    return bytecode >= Bytecode::Jump && bytecode <= Bytecode::PCIAdvanceFilteredJumpIfHasNext;
+  }
+
+  /**
+   * Checks whether the given bytecode is a conditional jump bytecode, i.e., a jump that can fall through
+   * @param bytecode bytecode to check
+   * @return whether the given bytecode is a conditional jump bytecode.
+   */
+  static constexpr bool IsConditionalJump(Bytecode bytecode) { return IsJump(bytecode) && bytecode != Bytecode::Jump; }
+
+  /**
+   * The jump offset of a jump bytecode is always its last operand
+   * @param bytecode jump bytecode for which the index of the jump offset is needed
+   * @return the index of the jump offset operand of the given jump bytecode
+   */
+  static uint32_t GetJumpOffsetOperandIndex(Bytecode bytecode) {
+    TERRIER_ASSERT(IsJump(bytecode), "Bytecode is not a jump");
+    return NumOperands(bytecode) - 1;
   }
 
   /**
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+
+#include "llvm/Support/MemoryBuffer.h"
+
+#include "common/constants.h"
+#include "common/macros.h"
+#include "execution/util/hash.h"
+#include "execution/vm/llvm_engine.h"
+
+namespace terrier::execution::vm {
+
+class BytecodeModule;
+
+/**
+ * A cache of the object code LLVM generates for bytecode modules. Generating the code of a module is usually far more
+ * expensive than running it for small queries, and queries are often run many times. When a module's object code is
+ * found in the cache, the engine loads and links it directly, skipping IR generation, optimization and code
+ * generation entirely.
+ *
+ * Entries are keyed by the module's fingerprint: its bytecode and the layout of its functions, together with
+ * everything else the generated code depends on: the CPU features, the LLVM version and the bitcode of the bytecode
+ * handlers. Two modules with the same fingerprint compile to the same code. The whole fingerprint is stored with each
+ * entry and compared on lookup, so hash collisions can't return the wrong code.
+ *
+ * The cache has two levels. The in-memory level holds up to a fixed number of bytes of object code and evicts the
+ * least recently used entries beyond that. The optional on-disk level writes every entry to a file in a directory,
+ * keeping at most a fixed number of files, and survives restarts: a disk hit is promoted to memory.
+ *
+ * The cache is thread-safe.
+ */
+class EXPORT CompiledModuleCache {
+ public:
+  /**
+   * Default maximum size of the object code kept in memory
+   */
+  static constexpr const uint64_t K_DEFAULT_MAX_MEMORY = 64 * common::Constants::MB;
+
+  /**
+   * Default maximum number of files kept on disk
+   */
+  static constexpr const uint32_t K_DEFAULT_MAX_DISK_ENTRIES = 256;
+
+  /**
+   * Create a cache.
+   * @param max_memory The maximum number of bytes of object code to keep in memory.
+   * @param disk_dir The directory to keep the on-disk level in, created if it doesn't exist. If empty, the cache only
+   *                 lives in memory.
+   * @param max_disk_entries The maximum number of files to keep in @em disk_dir.
+   */
+  explicit CompiledModuleCache(uint64_t max_memory = K_DEFAULT_MAX_MEMORY, std::string disk_dir = "",
+                               uint32_t max_disk_entries = K_DEFAULT_MAX_DISK_ENTRIES);
+
+  /**
+   * This class cannot be copied or moved
+   */
+  DISALLOW_COPY_AND_MOVE(CompiledModuleCache);
+
+  /**
+   * The cache shared by all modules of the process. It only lives in memory, unless the environment variable
+   * TERRIER_CODE_CACHE_DIR names a directory for the on-disk level.
+   */
+  static CompiledModuleCache *Instance();
+
+  /**
+   * Compute the fingerprint of the given module, when compiled with the given options
+   * @param module The module
+   * @param options The compiler options
+   * @return The fingerprint, a binary string
+   */
+  static std::string Fingerprint(const BytecodeModule &module, const LLVMEngine::CompilerOptions &options);
+
+  /**
+   * Look up the object code of a module
+   * @param fingerprint The module's fingerprint
+   * @return A copy of the object code if it is cached; null otherwise
+   */
+  std::unique_ptr<llvm::MemoryBuffer> Lookup(const std::string &fingerprint);
+
+  /**
+   * Store the object code of a module, replacing any code stored under the same fingerprint
+   * @param fingerprint The module's fingerprint
+   * @param object_code The module's object code
+   */
+  void Insert(const std::string &fingerprint, const llvm::MemoryBuffer &object_code);
+
+  /**
+   * Remove all entries from memory and from disk. The counters are kept.
+   */
+  void Clear();
+
+  /**
+   * @return The number of lookups served from memory
+   */
+  uint64_t NumHits() const noexcept { return num_hits_.load(std::memory_order_relaxed); }
+
+  /**
+   * @return The number of lookups served from disk
+   */
+  uint64_t NumDiskHits() const noexcept { return num_disk_hits_.load(std::memory_order_relaxed); }
+
+  /**
+   * @return The number of lookups that found nothing
+   */
+  uint64_t NumMisses() const noexcept { return num_misses_.load(std::memory_order_relaxed); }
+
+  /**
+   * @return The number of entries evicted from memory
+   */
+  uint64_t NumEvictions() const noexcept { return num_evictions_.load(std::memory_order_relaxed); }
+
+  /**
+   * @return The number of entries in memory
+   */
+  uint32_t NumEntries() const;
+
+  /**
+   * @return The number of bytes the entries in memory take
+   */
+  uint64_t MemoryUsage() const;
+
+ private:
+  struct Entry {
+    std::string fingerprint;
+    std::string object_code;
+  };
+
+  // The 64-bit key of a fingerprint, also used to name its file
+  static hash_t Key(const std::string &fingerprint);
+
+  // Add an entry to memory, evicting others if needed. The mutex must be held.
+  void InsertInMemory(hash_t key, const std::string &fingerprint, std::string object_code);
+  // Remove an entry from memory. The mutex must be held.
+  void RemoveFromMemory(std::list<Entry>::iterator iter);
+
+  // The path of the file of an entry
+  std::string DiskPath(hash_t key) const;
+  // Read the object code of an entry from disk. Returns false if it isn't there.
+  bool ReadFromDisk(hash_t key, const std::string &fingerprint, std::string *object_code) const;
+  // Write an entry to disk, then remove the oldest files beyond the limit
+  void WriteToDisk(hash_t key, const std::string &fingerprint, const std::string &object_code) const;
+
+ private:
+  const uint64_t max_memory_;
+  const std::string disk_dir_;
+  const uint32_t max_disk_entries_;
+
+  // The entries in memory, most recently used first, and an index on their keys
+  mutable std::mutex mutex_;
+  std::list<Entry> entries_;
+  std::unordered_map<hash_t, std::list<Entry>::iterator> index_;
+  uint64_t memory_usage_;
+
+  std::atomic<uint64_t> num_hits_;
+  std::atomic<uint64_t> num_disk_hits_;
+  std::atomic<uint64_t> num_misses_;
+  std::atomic<uint64_t> num_evictions_;
+};
+
+}  // namespace terrier::execution::vm
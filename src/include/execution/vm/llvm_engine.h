@@ -1,13 +1,19 @@
 #pragma once
 
+#include <algorithm>
+#include <functional>
+#include <limits>
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "llvm/Support/MemoryBuffer.h"
 
 #include "common/macros.h"
 #include "execution/util/execution_common.h"
+#include "execution/vm/bytecode_function_info.h"
 #include "execution/vm/bytecodes.h"
 
 namespace terrier::execution::ast {
@@ -17,8 +23,7 @@ class Type;
 namespace terrier::execution::vm {
 
 class BytecodeModule;
-class FunctionInfo;
-class LocalVar;
+class CompiledModuleCache;
 
 /**
  * The interface to LLVM to JIT compile TPL bytecode
@@ -36,6 +41,24 @@ class LLVMEngine {
   class CompiledModule;
   class CompiledModuleBuilder;
 
+  /**
+   * How much effort goes into optimizing and generating code. Higher levels generate faster code, but take longer to
+   * compile.
+   */
+  enum class OptimizationLevel : uint8_t {
+    // Only inline the bytecode handlers, and select instructions quickly
+    Fast,
+    // Clean up each function on its own with cheap scalar optimizations
+    Light,
+    // Inline functions into each other and run the full optimization pipeline
+    Full
+  };
+
+  /**
+   * The number of tuples to pass to ChooseOptimizationLevel() when no plan estimates it
+   */
+  static constexpr const uint64_t K_UNKNOWN_CARDINALITY = std::numeric_limits<uint64_t>::max();
+
   // -------------------------------------------------------
   // Public API
   // -------------------------------------------------------
@@ -58,6 +81,18 @@ class LLVMEngine {
    */
   static std::unique_ptr<CompiledModule> Compile(const BytecodeModule &module, const CompilerOptions &options);
 
+  /**
+   * Choose the optimization level at which compiling and then running the given module is expected to take the least
+   * time. The module's work is estimated from its instructions, those in loops weighted by the number of tuples the
+   * query processes if the plan estimates it, and by how deeply the loops nest otherwise. It is weighed against the
+   * cost of compiling those instructions at each level.
+   * @param module The module to compile
+   * @param num_tuples The estimated number of tuples the query processes, or K_UNKNOWN_CARDINALITY
+   * @return The optimization level to compile the module at
+   */
+  static OptimizationLevel ChooseOptimizationLevel(const BytecodeModule &module,
+                                                   uint64_t num_tuples = K_UNKNOWN_CARDINALITY);
+
   // -------------------------------------------------------
   // Compiler Options
   // -------------------------------------------------------
@@ -118,15 +153,99 @@ class LLVMEngine {
      */
     const std::string &GetOutputObjectFileName() const { return output_file_name_; }
 
+    /**
+     * Set the most threads to optimize and generate code on. Modules with enough code are split by function into
+     * partitions, which are optimized and compiled in parallel, then linked together when the module is loaded.
+     * @param num_threads The number of threads, or zero to use as many as there are hardware threads
+     * @return the updated object
+     */
+    CompilerOptions &SetCompileThreads(uint32_t num_threads) {
+      compile_threads_ = num_threads;
+      return *this;
+    }
+
+    /**
+     * @return the most threads to optimize and generate code on, or zero to use as many as there are hardware threads
+     */
+    uint32_t GetCompileThreads() const { return compile_threads_; }
+
+    /**
+     * Set the optimization level to compile at
+     * @param level The optimization level
+     * @return the updated object
+     */
+    CompilerOptions &SetOptimizationLevel(OptimizationLevel level) {
+      opt_level_ = level;
+      return *this;
+    }
+
+    /**
+     * @return the optimization level to compile at
+     */
+    OptimizationLevel GetOptimizationLevel() const { return opt_level_; }
+
     /**
      * @return the path to the bytecode handlers bitcode file.
      */
     std::string GetBytecodeHandlersBcPath() const { return "./bytecode_handlers_ir.bc"; }
 
+    /**
+     * Set the cache to look up the module's object code in before compiling it, and to store it in after compiling it.
+     * Modules whose object file is persisted are always compiled.
+     * @param cache The cache, or null to not use any
+     * @return the updated object
+     */
+    CompilerOptions &SetModuleCache(CompiledModuleCache *cache) {
+      module_cache_ = cache;
+      return *this;
+    }
+
+    /**
+     * @return the module cache, or null if none is used
+     */
+    CompiledModuleCache *GetModuleCache() const { return module_cache_; }
+
+    /**
+     * Compile only the given functions of the module. The other functions are left undefined: calls to them, and
+     * references to them, go to the addresses the resolver returns when the compiled module is loaded. By default, all
+     * functions are compiled.
+     * @param functions The IDs of the functions to compile
+     * @param resolver Returns the address of the implementation of a function that isn't compiled
+     * @return the updated object
+     */
+    CompilerOptions &SetFunctions(std::vector<FunctionId> functions, std::function<void *(FunctionId)> resolver) {
+      std::sort(functions.begin(), functions.end());
+      functions_ = std::move(functions);
+      resolver_ = std::move(resolver);
+      return *this;
+    }
+
+    /**
+     * @return the IDs of the functions to compile, in order, or an empty vector if all are compiled
+     */
+    const std::vector<FunctionId> &GetFunctions() const { return functions_; }
+
+    /**
+     * @return whether the function with the given ID is compiled
+     */
+    bool ShouldCompileFunction(FunctionId func_id) const {
+      return functions_.empty() || std::binary_search(functions_.begin(), functions_.end(), func_id);
+    }
+
+    /**
+     * @return the address of the implementation of a function that isn't compiled
+     */
+    void *ResolveFunction(FunctionId func_id) const { return resolver_(func_id); }
+
    private:
     bool debug_{false};
     bool write_obj_file_{false};
     std::string output_file_name_;
+    uint32_t compile_threads_{0};
+    OptimizationLevel opt_level_{OptimizationLevel::Full};
+    CompiledModuleCache *module_cache_{nullptr};
+    std::vector<FunctionId> functions_;
+    std::function<void *(FunctionId)> resolver_;
   };
 
   // -------------------------------------------------------
@@ -148,7 +267,8 @@ class LLVMEngine {
 
     /**
      * Construct a compiled module using the provided shared object file.
-     * @param object_code The object file containing code for this module.
+     * @param object_code The object file containing code for this module, or an archive of the object files of its
+     *                    partitions if it was compiled in parallel.
      */
     explicit CompiledModule(std::unique_ptr<llvm::MemoryBuffer> object_code);
 
@@ -174,6 +294,18 @@ class LLVMEngine {
      */
     std::size_t GetModuleObjectCodeSizeInBytes() const { return object_code_->getBufferSize(); }
 
+    /**
+     * Return the module's object code, or null if it hasn't been generated or loaded yet.
+     */
+    const llvm::MemoryBuffer *GetObjectCode() const { return object_code_.get(); }
+
+    /**
+     * Resolve calls to the symbol @em name to @em address when this module is
+     * loaded, instead of searching the process for it. Must be called before
+     * @em Load().
+     */
+    void AddExternalSymbol(const std::string &name, void *address);
+
     /**
      * Load the given module @em module into memory. If this module has already
      * been loaded, it will not be reloaded.
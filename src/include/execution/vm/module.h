@@ -1,9 +1,12 @@
 #pragma once
 
 #include <atomic>
+#include <condition_variable>  // NOLINT
 #include <memory>
+#include <mutex>  // NOLINT
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "llvm/Support/Memory.h"
 
@@ -23,9 +26,9 @@ namespace terrier::execution::vm {
 enum class ExecutionMode : uint8_t {
   // Always execute in interpreted mode
   Interpret,
-  // Execute in interpreted mode, but trigger a compilation asynchronously. As
-  // compiled code becomes available, seamlessly swap it in and execute mixed
-  // interpreter and compiled code.
+  // Execute in interpreted mode, but compile the functions that turn out to be
+  // hot in the background. As compiled code becomes available, seamlessly swap
+  // it in and execute mixed interpreter and compiled code.
   Adaptive,
   // Compile and generate all machine code before executing the function
   Compiled
@@ -38,10 +41,24 @@ enum class ExecutionMode : uint8_t {
  * bytecode and their implementations, along with compiled machine-code versions
  * of TPL functions.
  *
+ * In adaptive mode, functions are compiled one at a time, or in small groups,
+ * when they become hot. The VM counts the invocations and loop back-edges of
+ * every function it interprets. When a function's count reaches a threshold,
+ * it is compiled in the background together with the functions it calls that
+ * must be compiled with it, and its entry in the function table is swapped to
+ * the compiled code. Short queries are never compiled, and the hot functions
+ * of long ones get native code quickly.
+ *
  * Modules are thread-safe.
  */
 class Module {
  public:
+  /**
+   * Default number of invocations and loop back-edges after which a function
+   * is compiled in adaptive mode
+   */
+  static constexpr const uint32_t K_DEFAULT_HOTNESS_THRESHOLD = 10000;
+
   /**
    * Create a TPL module using the given bytecode module as the only
    * implementation.
@@ -61,6 +78,11 @@ class Module {
    */
   DISALLOW_COPY_AND_MOVE(Module);
 
+  /**
+   * Destroy the module, waiting for background compilations to finish.
+   */
+  ~Module();
+
   /**
    * Look up a TPL function in this module by its ID
    * @return A pointer to the function's info if it exists; null otherwise
@@ -110,13 +132,66 @@ class Module {
    */
   const BytecodeModule *GetBytecodeModule() const { return bytecode_module_.get(); }
 
+  /**
+   * Set the number of tuples the plan estimates the query processes. When the
+   * module is compiled in full, the optimization level is chosen to match the
+   * work this implies. Without an estimate, the work is judged from the
+   * nesting of the module's loops.
+   */
+  void SetEstimatedCardinality(const uint64_t num_tuples) { estimated_cardinality_ = num_tuples; }
+
+  /**
+   * @return The number of tuples the plan estimates the query processes, or
+   *         LLVMEngine::K_UNKNOWN_CARDINALITY if there is no estimate
+   */
+  uint64_t GetEstimatedCardinality() const { return estimated_cardinality_; }
+
+  /**
+   * Set the number of invocations and loop back-edges after which a function
+   * is compiled in adaptive mode.
+   */
+  void SetHotnessThreshold(const uint32_t threshold) { hotness_threshold_ = threshold; }
+
+  /**
+   * Return the number of invocations and loop back-edges counted for the
+   * function with ID @em func_id. Functions are only counted in adaptive mode,
+   * until they are queued for compilation.
+   */
+  uint32_t GetHotness(const FunctionId func_id) const {
+    return tier_state_[func_id].hotness_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Return true if the function with ID @em func_id has been compiled in
+   * adaptive mode.
+   */
+  bool IsTieredUp(const FunctionId func_id) const {
+    return tier_state_[func_id].compiled_.load(std::memory_order_acquire) != nullptr;
+  }
+
  private:
   friend class VM;
-  friend class AsyncCompileTask;
+  friend class TieredCompileTask;
   friend class test::BytecodeTrampolineTest;
 
-  // This class encapsulates the ability to asynchronously JIT compile a module.
-  class AsyncCompileTask;
+  // This class encapsulates the ability to JIT compile some functions of a
+  // module in the background.
+  class TieredCompileTask;
+
+  // The tiering state of a function
+  struct TierState {
+    // The number of invocations and loop back-edges counted so far
+    std::atomic<uint32_t> hotness_{0};
+    // Whether the function was queued for compilation
+    std::atomic<bool> queued_{false};
+    // The compiled implementation, once available
+    std::atomic<void *> compiled_{nullptr};
+    // Whether the function has a simple signature
+    bool simple_{false};
+  };
+
+  // The maximum number of arguments of a function with a simple signature
+  static constexpr const uint32_t K_MAX_SIMPLE_PARAMS = 6;
 
   // A trampoline is a stub function that serves as a landing point for all
   // functions executed in interpreted mode. The purpose of the trampoline is
@@ -165,9 +240,33 @@ class Module {
   // Compile this module into machine code. This is a blocking call.
   void CompileToMachineCode();
 
-  // Compile this module into machine code. This is a non-blocking call that
-  // triggers a compilation in the background.
-  void CompileToMachineCodeAsync();
+  // Start counting the hotness of functions, compiling the hot ones
+  void EnableTiering() { tiering_enabled_.store(true, std::memory_order_relaxed); }
+
+  // Add @em count invocations or loop back-edges to the hotness of the function
+  // with ID @em func_id, queueing it for compilation if it becomes hot. Called
+  // by the VM.
+  void RecordHotness(FunctionId func_id, uint32_t count) const;
+
+  // Return the compiled implementation of the function with ID @em func_id if
+  // the VM may call it directly; null otherwise. Called by the VM.
+  void *GetTieredImpl(const FunctionId func_id) const {
+    const TierState &state = tier_state_[func_id];
+    return state.simple_ ? state.compiled_.load(std::memory_order_acquire) : nullptr;
+  }
+
+  // Does the function have a signature that both the trampolines and the VM
+  // can call natively? Only integer, boolean and pointer arguments and return
+  // values are supported.
+  bool HasSimpleSignature(FunctionId func_id) const;
+
+  // Collect the functions to compile together with the hot function with ID
+  // @em func_id, and mark them queued
+  std::vector<FunctionId> CollectTierGroup(FunctionId func_id) const;
+
+  // Compile the given functions into machine code and swap them in. This is a
+  // blocking call.
+  void CompileFunctions(const std::vector<FunctionId> &func_ids);
 
  private:
   // The module containing all TBC (i.e., bytecode) for the TPL program.
@@ -183,6 +282,18 @@ class Module {
   // Compilation flag used to ensure compilation occurs only once, even under
   // concurrent invocations.
   std::once_flag compiled_flag_;
+  // The number of tuples the plan estimates the query processes, if known
+  uint64_t estimated_cardinality_{LLVMEngine::K_UNKNOWN_CARDINALITY};
+  // The tiering state of all functions, and the threshold to compile at
+  std::unique_ptr<TierState[]> tier_state_;
+  std::atomic<bool> tiering_enabled_{false};
+  uint32_t hotness_threshold_{K_DEFAULT_HOTNESS_THRESHOLD};
+  // The compiled modules holding the code of the functions compiled in
+  // adaptive mode, and the number of compilations still running
+  mutable std::mutex tier_mutex_;
+  mutable std::condition_variable tier_cv_;
+  mutable uint32_t num_pending_compiles_{0};
+  std::vector<std::unique_ptr<LLVMEngine::CompiledModule>> tier_modules_;
 };
 
 // ---------------------------------------------------------
@@ -223,7 +334,7 @@ inline bool Module::GetFunction(const std::string &name, const ExecutionMode exe
 
   switch (exec_mode) {
     case ExecutionMode::Adaptive: {
-      CompileToMachineCodeAsync();
+      EnableTiering();
       TERRIER_FALLTHROUGH;
     }
     case ExecutionMode::Interpret: {
@@ -236,18 +347,18 @@ inline bool Module::GetFunction(const std::string &name, const ExecutionMode exe
 
           // Invoke and finish
           VM::InvokeFunction(this, func_info->Id(), arg_buffer);
-          return;
-        }
-        // The return value
-        Ret rv{};
+        } else {
+          // The return value
+          Ret rv{};
 
-        // Create a temporary on-stack buffer and copy all arguments
-        uint8_t arg_buffer[sizeof(Ret *) + (0ul + ... + sizeof(args))];
-        detail::CopyAll(arg_buffer, &rv, args...);
+          // Create a temporary on-stack buffer and copy all arguments
+          uint8_t arg_buffer[sizeof(Ret *) + (0ul + ... + sizeof(args))];
+          detail::CopyAll(arg_buffer, &rv, args...);
 
-        // Invoke and finish
-        VM::InvokeFunction(this, func_info->Id(), arg_buffer);
-        return rv;
+          // Invoke and finish
+          VM::InvokeFunction(this, func_info->Id(), arg_buffer);
+          return rv;
+        }
       };
       break;
     }
@@ -31,12 +31,18 @@ class VM {
   // Forward declare the frame
   class Frame;
 
-  // Interpret the given instruction stream using the given execution frame
-  void Interpret(const uint8_t *ip, Frame *frame);
+  // Interpret the given instruction stream of the function with the given ID
+  // using the given execution frame
+  void Interpret(const uint8_t *ip, Frame *frame, FunctionId func_id);
 
   // Execute a call instruction
   const uint8_t *ExecuteCall(const uint8_t *ip, Frame *caller);
 
+  // Call the compiled implementation of a function with a simple signature.
+  // The parameters are laid out as in the function's frame, each widened to 64
+  // bits, including the pointer to the return value if the function has one.
+  static void CallCompiled(const FunctionInfo &func_info, void *impl, const uint64_t params[]);
+
  private:
   // The module
   const Module *module_;
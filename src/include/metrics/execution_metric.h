@@ -0,0 +1,104 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>  //NOLINT
+#include <fstream>
+#include <list>
+#include <utility>
+#include <vector>
+
+#include "catalog/catalog_defs.h"
+#include "metrics/abstract_metric.h"
+#include "metrics/metrics_util.h"
+
+namespace terrier::metrics {
+
+/**
+ * Raw data object for holding stats collected at query execution level
+ */
+class ExecutionMetricRawData : public AbstractRawData {
+ public:
+  void Aggregate(AbstractRawData *const other) override {
+    auto other_db_metric = dynamic_cast<ExecutionMetricRawData *>(other);
+    if (!other_db_metric->query_data_.empty()) {
+      query_data_.splice(query_data_.cbegin(), other_db_metric->query_data_);
+    }
+  }
+
+  /**
+   * @return the type of the metric this object is holding the data for
+   */
+  MetricsComponent GetMetricType() const override { return MetricsComponent::EXECUTION; }
+
+  /**
+   * Writes the data out to ofstreams
+   * @param outfiles vector of ofstreams to write to that have been opened by the MetricsManager
+   */
+  void ToCSV(std::vector<std::ofstream> *const outfiles) final {
+    TERRIER_ASSERT(outfiles->size() == FILES.size(), "Number of files passed to metric is wrong.");
+    TERRIER_ASSERT(std::count_if(outfiles->cbegin(), outfiles->cend(),
+                                 [](const std::ofstream &outfile) { return !outfile.is_open(); }) == 0,
+                   "Not all files are open.");
+
+    for (const auto &data : query_data_) {
+      ((*outfiles)[0]) << data.now_ << "," << data.elapsed_us_ << "," << data.peak_bytes_ << ","
+                       << data.allocated_bytes_ << "," << data.num_allocations_ << "," << data.budget_bytes_
+                       << std::endl;
+    }
+    query_data_.clear();
+  }
+
+  /**
+   * Files to use for writing to CSV.
+   */
+  static constexpr std::array<std::string_view, 1> FILES = {"./execution_query.csv"};
+
+  /**
+   * Columns to use for writing to CSV.
+   */
+  static constexpr std::array<std::string_view, 1> COLUMNS = {
+      "now,elapsed_us,peak_bytes,allocated_bytes,num_allocations,budget_bytes"};
+
+ private:
+  friend class ExecutionMetric;
+  FRIEND_TEST(MetricsTests, ExecutionCSVTest);
+
+  void RecordQueryData(const uint64_t elapsed_us, const uint64_t peak_bytes, const uint64_t allocated_bytes,
+                       const uint64_t num_allocations, const uint64_t budget_bytes) {
+    query_data_.emplace_front(elapsed_us, peak_bytes, allocated_bytes, num_allocations, budget_bytes);
+  }
+
+  struct QueryData {
+    QueryData(const uint64_t elapsed_us, const uint64_t peak_bytes, const uint64_t allocated_bytes,
+              const uint64_t num_allocations, const uint64_t budget_bytes)
+        : now_(MetricsUtil::Now()),
+          elapsed_us_(elapsed_us),
+          peak_bytes_(peak_bytes),
+          allocated_bytes_(allocated_bytes),
+          num_allocations_(num_allocations),
+          budget_bytes_(budget_bytes) {}
+    const uint64_t now_;
+    const uint64_t elapsed_us_;
+    const uint64_t peak_bytes_;
+    // Bytes still allocated when the query finished, released with its execution context
+    const uint64_t allocated_bytes_;
+    const uint64_t num_allocations_;
+    const uint64_t budget_bytes_;
+  };
+
+  std::list<QueryData> query_data_;
+};
+
+/**
+ * Metrics for query execution: currently the memory every query allocated while it ran
+ */
+class ExecutionMetric : public AbstractMetric<ExecutionMetricRawData> {
+ private:
+  friend class MetricsStore;
+
+  void RecordQueryData(const uint64_t elapsed_us, const uint64_t peak_bytes, const uint64_t allocated_bytes,
+                       const uint64_t num_allocations, const uint64_t budget_bytes) {
+    GetRawData()->RecordQueryData(elapsed_us, peak_bytes, allocated_bytes, num_allocations, budget_bytes);
+  }
+};
+}  // namespace terrier::metrics
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>  //NOLINT
+#include <fstream>
+#include <list>
+#include <utility>
+#include <vector>
+
+#include "catalog/catalog_defs.h"
+#include "metrics/abstract_metric.h"
+#include "metrics/metrics_util.h"
+#include "storage/index/index_defs.h"
+
+namespace terrier::metrics {
+
+/**
+ * Raw data object for holding stats collected at garbage collection level
+ */
+class GarbageCollectionMetricRawData : public AbstractRawData {
+ public:
+  void Aggregate(AbstractRawData *const other) override {
+    auto other_db_metric = dynamic_cast<GarbageCollectionMetricRawData *>(other);
+    if (!other_db_metric->index_data_.empty()) {
+      index_data_.splice(index_data_.cbegin(), other_db_metric->index_data_);
+    }
+  }
+
+  /**
+   * @return the type of the metric this object is holding the data for
+   */
+  MetricsComponent GetMetricType() const override { return MetricsComponent::GARBAGECOLLECTION; }
+
+  /**
+   * Writes the data out to ofstreams
+   * @param outfiles vector of ofstreams to write to that have been opened by the MetricsManager
+   */
+  void ToCSV(std::vector<std::ofstream> *const outfiles) final {
+    TERRIER_ASSERT(outfiles->size() == FILES.size(), "Number of files passed to metric is wrong.");
+    TERRIER_ASSERT(std::count_if(outfiles->cbegin(), outfiles->cend(),
+                                 [](const std::ofstream &outfile) { return !outfile.is_open(); }) == 0,
+                   "Not all files are open.");
+
+    for (const auto &data : index_data_) {
+      ((*outfiles)[0]) << data.now_ << "," << data.index_ << "," << static_cast<char>(data.index_type_) << ","
+                       << data.elapsed_us_ << "," << data.num_deletes_ << "," << data.dead_entries_ << ","
+                       << data.consolidated_ << std::endl;
+    }
+    index_data_.clear();
+  }
+
+  /**
+   * Files to use for writing to CSV.
+   */
+  static constexpr std::array<std::string_view, 1> FILES = {"./gc_index.csv"};
+
+  /**
+   * Columns to use for writing to CSV.
+   */
+  static constexpr std::array<std::string_view, 1> COLUMNS = {
+      "now,index,index_type,elapsed_us,num_deletes,dead_entries,consolidated"};
+
+ private:
+  friend class GarbageCollectionMetric;
+  FRIEND_TEST(MetricsTests, GarbageCollectionCSVTest);
+
+  void RecordIndexData(const uintptr_t index, const storage::index::IndexType index_type, const uint64_t elapsed_us,
+                       const uint64_t num_deletes, const uint64_t dead_entries, const bool consolidated) {
+    index_data_.emplace_front(index, index_type, elapsed_us, num_deletes, dead_entries, consolidated);
+  }
+
+  struct IndexData {
+    IndexData(const uintptr_t index, const storage::index::IndexType index_type, const uint64_t elapsed_us,
+              const uint64_t num_deletes, const uint64_t dead_entries, const bool consolidated)
+        : now_(MetricsUtil::Now()),
+          index_(index),
+          index_type_(index_type),
+          elapsed_us_(elapsed_us),
+          num_deletes_(num_deletes),
+          dead_entries_(dead_entries),
+          consolidated_(consolidated) {}
+    const uint64_t now_;
+    const uintptr_t index_;
+    const storage::index::IndexType index_type_;
+    const uint64_t elapsed_us_;
+    const uint64_t num_deletes_;
+    const uint64_t dead_entries_;
+    const bool consolidated_;
+  };
+
+  std::list<IndexData> index_data_;
+};
+
+/**
+ * Metrics for the garbage collector: currently the index maintenance it performs per index on every run
+ */
+class GarbageCollectionMetric : public AbstractMetric<GarbageCollectionMetricRawData> {
+ private:
+  friend class MetricsStore;
+
+  void RecordIndexData(const uintptr_t index, const storage::index::IndexType index_type, const uint64_t elapsed_us,
+                       const uint64_t num_deletes, const uint64_t dead_entries, const bool consolidated) {
+    GetRawData()->RecordIndexData(index, index_type, elapsed_us, num_deletes, dead_entries, consolidated);
+  }
+};
+}  // namespace terrier::metrics
@@ -8,6 +8,8 @@
 #include "common/managed_pointer.h"
 #include "metrics/abstract_metric.h"
 #include "metrics/abstract_raw_data.h"
+#include "metrics/execution_metric.h"
+#include "metrics/garbage_collection_metric.h"
 #include "metrics/logging_metric.h"
 #include "metrics/metrics_defs.h"
 #include "metrics/transaction_metric.h"
@@ -74,6 +76,37 @@ class MetricsStore {
     txn_metric_->RecordCommitData(elapsed_us, txn_start);
   }
 
+  /**
+   * Record metrics for the index maintenance done by the garbage collector
+   * @param index first entry of gc datapoint
+   * @param index_type second entry of gc datapoint
+   * @param elapsed_us third entry of gc datapoint
+   * @param num_deletes fourth entry of gc datapoint
+   * @param dead_entries fifth entry of gc datapoint
+   * @param consolidated sixth entry of gc datapoint
+   */
+  void RecordIndexGCData(const uintptr_t index, const storage::index::IndexType index_type, const uint64_t elapsed_us,
+                         const uint64_t num_deletes, const uint64_t dead_entries, const bool consolidated) {
+    TERRIER_ASSERT(ComponentEnabled(MetricsComponent::GARBAGECOLLECTION), "GarbageCollectionMetric not enabled.");
+    TERRIER_ASSERT(gc_metric_ != nullptr, "GarbageCollectionMetric not allocated. Check MetricsStore constructor.");
+    gc_metric_->RecordIndexData(index, index_type, elapsed_us, num_deletes, dead_entries, consolidated);
+  }
+
+  /**
+   * Record metrics for the memory a query allocated while it executed
+   * @param elapsed_us first entry of query datapoint
+   * @param peak_bytes second entry of query datapoint
+   * @param allocated_bytes third entry of query datapoint
+   * @param num_allocations fourth entry of query datapoint
+   * @param budget_bytes fifth entry of query datapoint
+   */
+  void RecordQueryData(const uint64_t elapsed_us, const uint64_t peak_bytes, const uint64_t allocated_bytes,
+                       const uint64_t num_allocations, const uint64_t budget_bytes) {
+    TERRIER_ASSERT(ComponentEnabled(MetricsComponent::EXECUTION), "ExecutionMetric not enabled.");
+    TERRIER_ASSERT(execution_metric_ != nullptr, "ExecutionMetric not allocated. Check MetricsStore constructor.");
+    execution_metric_->RecordQueryData(elapsed_us, peak_bytes, allocated_bytes, num_allocations, budget_bytes);
+  }
+
   /**
    * @param component metrics component to test
    * @return true if metrics enabled for this component, false otherwise
@@ -99,6 +132,8 @@ class MetricsStore {
 
   std::unique_ptr<LoggingMetric> logging_metric_;
   std::unique_ptr<TransactionMetric> txn_metric_;
+  std::unique_ptr<GarbageCollectionMetric> gc_metric_;
+  std::unique_ptr<ExecutionMetric> execution_metric_;
 
   const std::bitset<NUM_COMPONENTS> &enabled_metrics_;
 };
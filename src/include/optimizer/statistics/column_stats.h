@@ -64,6 +64,12 @@ class ColumnStats {
    */
   double &GetCardinality() { return this->cardinality_; }
 
+  /**
+   * Gets the histogram bucket boundaries of the column, in ascending order
+   * @return the histogram bounds
+   */
+  const std::vector<double> &GetHistogramBounds() const { return this->histogram_bounds_; }
+
   /**
    * Serializes a column stats object
    * @return column stats object serialized to json
@@ -46,7 +46,7 @@ class AbstractJoinPlanNode : public AbstractPlanNode {
     /**
      * Join predicate
      */
-    common::ManagedPointer<parser::AbstractExpression> join_predicate_;
+    common::ManagedPointer<parser::AbstractExpression> join_predicate_{nullptr};
   };
 
   /**
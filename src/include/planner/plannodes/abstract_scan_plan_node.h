@@ -70,7 +70,7 @@ class AbstractScanPlanNode : public AbstractPlanNode {
     /**
      * Scan predicate
      */
-    common::ManagedPointer<parser::AbstractExpression> scan_predicate_;
+    common::ManagedPointer<parser::AbstractExpression> scan_predicate_{nullptr};
     /**
      * Is scan for update
      */
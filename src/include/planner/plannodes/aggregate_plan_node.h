@@ -44,6 +44,15 @@ class AggregatePlanNode : public AbstractPlanNode {
       return *this;
     }
 
+    /**
+     * @param term group by term to be added
+     * @return builder object
+     */
+    Builder &AddGroupByTerm(common::ManagedPointer<parser::AbstractExpression> term) {
+      group_by_terms_.emplace_back(term);
+      return *this;
+    }
+
     /**
      * @param predicate having clause predicate to use for aggregate term
      * @return builder object
@@ -69,18 +78,22 @@ class AggregatePlanNode : public AbstractPlanNode {
     std::unique_ptr<AggregatePlanNode> Build() {
       return std::unique_ptr<AggregatePlanNode>(
           new AggregatePlanNode(std::move(children_), std::move(output_schema_), having_clause_predicate_,
-                                std::move(aggregate_terms_), aggregate_strategy_));
+                                std::move(aggregate_terms_), std::move(group_by_terms_), aggregate_strategy_));
     }
 
    protected:
     /**
      * Predicate for having clause if it exists
      */
-    common::ManagedPointer<parser::AbstractExpression> having_clause_predicate_;
+    common::ManagedPointer<parser::AbstractExpression> having_clause_predicate_{nullptr};
     /**
      * List of aggregate terms for aggregation
      */
     std::vector<AggregateTerm> aggregate_terms_;
+    /**
+     * List of group by terms, the keys the input is grouped on
+     */
+    std::vector<common::ManagedPointer<parser::AbstractExpression>> group_by_terms_;
     /**
      * Strategy to use for aggregation
      */
@@ -93,15 +106,19 @@ class AggregatePlanNode : public AbstractPlanNode {
    * @param output_schema Schema representing the structure of the output of this plan node
    * @param having_clause_predicate unique pointer to possible having clause predicate
    * @param aggregate_terms vector of aggregate terms for the aggregation
+   * @param group_by_terms vector of group by terms for the aggregation
    * @param aggregate_strategy aggregation strategy to be used
    */
   AggregatePlanNode(std::vector<std::unique_ptr<AbstractPlanNode>> &&children,
                     std::unique_ptr<OutputSchema> output_schema,
                     common::ManagedPointer<parser::AbstractExpression> having_clause_predicate,
-                    std::vector<AggregateTerm> aggregate_terms, AggregateStrategyType aggregate_strategy)
+                    std::vector<AggregateTerm> aggregate_terms,
+                    std::vector<common::ManagedPointer<parser::AbstractExpression>> group_by_terms,
+                    AggregateStrategyType aggregate_strategy)
       : AbstractPlanNode(std::move(children), std::move(output_schema)),
         having_clause_predicate_(having_clause_predicate),
         aggregate_terms_(std::move(aggregate_terms)),
+        group_by_terms_(std::move(group_by_terms)),
         aggregate_strategy_(aggregate_strategy) {}
 
  public:
@@ -128,6 +145,13 @@ class AggregatePlanNode : public AbstractPlanNode {
    */
   const std::vector<AggregateTerm> &GetAggregateTerms() const { return aggregate_terms_; }
 
+  /**
+   * @return vector of group by terms
+   */
+  const std::vector<common::ManagedPointer<parser::AbstractExpression>> &GetGroupByTerms() const {
+    return group_by_terms_;
+  }
+
   /**
    * @return aggregation strategy
    */
@@ -151,6 +175,7 @@ class AggregatePlanNode : public AbstractPlanNode {
  private:
   common::ManagedPointer<parser::AbstractExpression> having_clause_predicate_;
   std::vector<AggregateTerm> aggregate_terms_;
+  std::vector<common::ManagedPointer<parser::AbstractExpression>> group_by_terms_;
   AggregateStrategyType aggregate_strategy_;
 };
 DEFINE_JSON_DECLARATIONS(AggregatePlanNode);
@@ -372,6 +372,16 @@ class OutputSchema {
    */
   const std::vector<Column> &GetColumns() const { return columns_; }
 
+  /**
+   * @return the derived columns, computed from an expression, that are part of this schema
+   */
+  const std::vector<DerivedTarget> &GetTargets() const { return targets_; }
+
+  /**
+   * @return the columns of this schema that are copied directly from a column of a child's schema
+   */
+  const std::vector<DirectMap> &GetDirectMapList() const { return direct_map_list_; }
+
   /**
    * Make a copy of this OutputSchema
    * @return unique pointer to the copy
@@ -382,7 +392,6 @@ class OutputSchema {
       columns.emplace_back(col.Copy());
     }
 
-    // TODO(WAN): there are no getters for these members? why?
     std::vector<DerivedTarget> targets;
     for (const auto &target : targets_) {
       targets.emplace_back(target.Copy());
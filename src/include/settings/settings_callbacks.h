@@ -85,5 +85,25 @@ class Callbacks {
    */
   static void MetricsTransaction(void *old_value, void *new_value, DBMain *db_main,
                                  const std::shared_ptr<common::ActionContext> &action_context);
+
+  /**
+   * Enable or disable metrics collection for GarbageCollector component
+   * @param old_value old settings value
+   * @param new_value new settings value
+   * @param db_main pointer to db_main
+   * @param action_context pointer to the action context for this settings change
+   */
+  static void MetricsGC(void *old_value, void *new_value, DBMain *db_main,
+                        const std::shared_ptr<common::ActionContext> &action_context);
+
+  /**
+   * Enable or disable metrics collection for Execution component
+   * @param old_value old settings value
+   * @param new_value new settings value
+   * @param db_main pointer to db_main
+   * @param action_context pointer to the action context for this settings change
+   */
+  static void MetricsExecution(void *old_value, void *new_value, DBMain *db_main,
+                               const std::shared_ptr<common::ActionContext> &action_context);
 };
 }  // namespace terrier::settings
@@ -123,3 +123,19 @@ SETTING_bool(
     true,
     terrier::settings::Callbacks::MetricsTransaction
 )
+
+SETTING_bool(
+    metrics_gc,
+    "Metrics collection for the GarbageCollector component.",
+    false,
+    true,
+    terrier::settings::Callbacks::MetricsGC
+)
+
+SETTING_bool(
+    metrics_execution,
+    "Metrics collection for the Execution component.",
+    false,
+    true,
+    terrier::settings::Callbacks::MetricsExecution
+)
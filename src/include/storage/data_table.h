@@ -150,6 +150,29 @@ class DataTable {
    */
   void Scan(transaction::TransactionContext *txn, SlotIterator *start_pos, ProjectedColumns *out_buffer) const;
 
+  /**
+   * Sequentially scans the table like Scan() above, but stops at the given end of a range of the table instead of at
+   * the end of the table.
+   *
+   * @param txn the calling transaction
+   * @param start_pos iterator to the starting location for the sequential scan
+   * @param end_pos iterator one past the last slot to scan, e.g. a boundary returned by BlockRangeBoundaries()
+   * @param out_buffer output buffer. The object should already contain projection list information. This buffer is
+   *                   always cleared of old values.
+   */
+  void Scan(transaction::TransactionContext *txn, SlotIterator *start_pos, const SlotIterator &end_pos,
+            ProjectedColumns *out_buffer) const;
+
+  /**
+   * Splits the blocks of the table into ranges of consecutive blocks, which can be scanned independently, e.g. in
+   * parallel. Range i spans the slots in [boundaries[i], boundaries[i + 1]). The last boundary is end(), so the
+   * last range also covers whatever is inserted into its blocks meanwhile.
+   *
+   * @param blocks_per_range the number of blocks in each range but the last, at least one
+   * @return the boundaries of the ranges, a single one if the table has no blocks
+   */
+  std::vector<SlotIterator> BlockRangeBoundaries(uint32_t blocks_per_range) const;
+
   /**
    * @return the first tuple slot contained in the data table
    */
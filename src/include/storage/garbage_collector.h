@@ -1,6 +1,7 @@
 #pragma once
 
 #include <queue>
+#include <unordered_map>
 #include <unordered_set>
 #include <utility>
 #include "common/shared_latch.h"
@@ -12,6 +13,18 @@
 
 namespace terrier::storage {
 
+/**
+ * Number of entries the GC must remove from a registered index before it invokes the index's own (potentially
+ * expensive) garbage collection, e.g. BwTree epoch cleanup.
+ */
+constexpr uint32_t INDEX_GC_DEAD_ENTRIES_THRESHOLD = 1024;
+
+/**
+ * Maximum number of GC runs a registered index can go without having its own garbage collection invoked. Insert-only
+ * workloads never accumulate dead entries, but their structural changes still leave epoch garbage behind.
+ */
+constexpr uint32_t INDEX_GC_MAX_DEFERRED_RUNS = 64;
+
 /**
  * The garbage collector is responsible for processing a queue of completed transactions from the transaction manager.
  * Based on the contents of this queue, it unlinks the UndoRecords from their version chains when no running
@@ -97,8 +110,36 @@ class GarbageCollector {
 
   void TruncateVersionChain(DataTable *table, TupleSlot slot, transaction::timestamp_t oldest) const;
 
+  /**
+   * Stage the index deletes of an unlinked txn into the per-index batches
+   */
+  void CollectIndexDeletes(transaction::TransactionContext *txn);
+
+  /**
+   * Apply the batched index deletes collected by the unlink pass. This must happen before the txns owning the staged
+   * keys are deallocated, and before deferred actions get a chance to free the indexes.
+   */
+  void ProcessIndexDeletes();
+
+  /**
+   * Invoke the garbage collection of registered indexes that have accumulated enough dead entries
+   */
   void ProcessIndexes();
 
+  /**
+   * GC work counters for a registered index
+   */
+  struct IndexGCStats {
+    // entries removed since the index's own garbage collection was last invoked
+    uint64_t dead_entries_ = 0;
+    // entries removed by the current GC run
+    uint32_t num_deletes_ = 0;
+    // time spent removing entries in the current GC run
+    uint64_t elapsed_us_ = 0;
+    // GC runs since the index's own garbage collection was last invoked
+    uint32_t deferred_runs_ = 0;
+  };
+
   transaction::TimestampManager *timestamp_manager_;
   transaction::DeferredActionManager *deferred_action_manager_;
   transaction::TransactionManager *const txn_manager_;
@@ -110,7 +151,11 @@ class GarbageCollector {
   // queue of txns that need to be unlinked
   transaction::TransactionQueue txns_to_unlink_;
 
-  std::unordered_set<common::ManagedPointer<index::Index>> indexes_;
+  // deletes collected from unlinked txns, batched per index. Reused across GC runs to avoid reallocating the batches.
+  std::unordered_map<common::ManagedPointer<index::Index>, index::IndexDeleteBatch> index_delete_batches_;
+
+  // registered indexes and their GC work counters
+  std::unordered_map<common::ManagedPointer<index::Index>, IndexGCStats> indexes_;
   common::SharedLatch indexes_latch_;
 };
 
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <algorithm>
+#include <cstring>
 #include <functional>
 #include <memory>
 #include <utility>
@@ -27,6 +29,16 @@ class BwTreeIndex final : public Index {
 
   const std::unique_ptr<third_party::bwtree::BwTree<KeyType, TupleSlot>> bwtree_;
 
+  static void AppendBoundary(IndexRangePartitions *const partitions, const KeyType &key) {
+    const auto *const key_image = reinterpret_cast<const byte *>(&key);
+    partitions->emplace_back(key_image, key_image + sizeof(KeyType));
+  }
+
+  static void ReadBoundary(const IndexRangePartitions &partitions, const uint32_t boundary, KeyType *const key) {
+    TERRIER_ASSERT(partitions[boundary].size() == sizeof(KeyType), "Boundary is not an image of this index's keys.");
+    std::memcpy(reinterpret_cast<void *>(key), partitions[boundary].data(), sizeof(KeyType));
+  }
+
  public:
   IndexType Type() const final { return IndexType::BWTREE; }
 
@@ -93,13 +105,28 @@ class BwTreeIndex final : public Index {
                        !(location.GetBlock()->data_table_->IsVisible(*txn, location)),
                    "Called index delete on a TupleSlot that has a conflict with this txn or is still visible.");
 
-    // Register a deferred action for the GC with txn manager. See base function comment.
-    txn->RegisterCommitAction([=](transaction::DeferredActionManager *deferred_action_manager) {
-      deferred_action_manager->RegisterDeferredAction([=]() {
-        const bool UNUSED_ATTRIBUTE result = bwtree_->Delete(index_key, location);
-        TERRIER_ASSERT(result, "Deferred delete on the index failed.");
-      });
-    });
+    // Stage the delete for the GC on the txn. See base function comment.
+    StageDelete(txn, index_key, location);
+  }
+
+  uint32_t DeleteBatch(const IndexDeleteBatch &batch) final {
+    std::vector<std::pair<KeyType, TupleSlot>> entries(batch.size());
+    for (uint32_t i = 0; i < batch.size(); i++) {
+      std::memcpy(reinterpret_cast<void *>(&entries[i].first), batch[i].first, sizeof(KeyType));
+      entries[i].second = batch[i].second;
+    }
+
+    // Removing in key order means consecutive deletes traverse the same inner nodes and mostly hit the same leaves
+    std::sort(entries.begin(), entries.end(),
+              [this](const std::pair<KeyType, TupleSlot> &lhs, const std::pair<KeyType, TupleSlot> &rhs) {
+                return bwtree_->KeyCmpLess(lhs.first, rhs.first);
+              });
+
+    for (const auto &entry : entries) {
+      const bool UNUSED_ATTRIBUTE result = bwtree_->Delete(entry.first, entry.second);
+      TERRIER_ASSERT(result, "Deferred delete on the index failed.");
+    }
+    return static_cast<uint32_t>(entries.size());
   }
 
   void ScanKey(const transaction::TransactionContext &txn, const ProjectedRow &key,
@@ -145,6 +172,49 @@ class BwTreeIndex final : public Index {
     }
   }
 
+  bool PartitionRange(const ProjectedRow &low_key, const ProjectedRow &high_key, const uint32_t num_partitions,
+                      IndexRangePartitions *const partitions) final {
+    TERRIER_ASSERT(num_partitions > 0, "Must ask for at least one partition.");
+
+    // Build search keys
+    KeyType index_low_key, index_high_key;
+    index_low_key.SetFromProjectedRow(low_key, metadata_);
+    index_high_key.SetFromProjectedRow(high_key, metadata_);
+
+    // Inner node separators make for sub-ranges that span a similar number of leaves
+    std::vector<KeyType> separators;
+    bwtree_->GetRangeSeparators(index_low_key, index_high_key, num_partitions, &separators);
+
+    partitions->clear();
+    partitions->reserve(separators.size() + 2);
+    AppendBoundary(partitions, index_low_key);
+    for (const auto &separator : separators) AppendBoundary(partitions, separator);
+    AppendBoundary(partitions, index_high_key);
+    return true;
+  }
+
+  void ScanAscendingPartition(const transaction::TransactionContext &txn, const IndexRangePartitions &partitions,
+                              const uint32_t partition, std::vector<TupleSlot> *value_list) final {
+    TERRIER_ASSERT(value_list->empty(), "Result set should begin empty.");
+    TERRIER_ASSERT(partition + 1 < partitions.size(), "Partition index out of range.");
+
+    // Recover the boundary keys
+    KeyType index_low_key, index_high_key;
+    ReadBoundary(partitions, partition, &index_low_key);
+    ReadBoundary(partitions, partition + 1, &index_high_key);
+    // Only the last sub-range includes its upper boundary, the others leave it to the next sub-range
+    const bool last = partition + 2 == partitions.size();
+
+    // Perform lookup in BwTree
+    auto scan_itr = bwtree_->Begin(index_low_key);
+    while (!scan_itr.IsEnd() && (last ? bwtree_->KeyCmpLessEqual(scan_itr->first, index_high_key)
+                                      : bwtree_->KeyCmpLess(scan_itr->first, index_high_key))) {
+      // Perform visibility check on result
+      if (IsVisible(txn, scan_itr->second)) value_list->emplace_back(scan_itr->second);
+      scan_itr++;
+    }
+  }
+
   void ScanDescending(const transaction::TransactionContext &txn, const ProjectedRow &low_key,
                       const ProjectedRow &high_key, std::vector<TupleSlot> *value_list) final {
     TERRIER_ASSERT(value_list->empty(), "Result set should begin empty.");
@@ -6,6 +6,7 @@
 
 #include "portable_endian/portable_endian.h"
 #include "storage/index/index_metadata.h"
+#include "storage/projected_columns.h"
 #include "storage/projected_row.h"
 #include "storage/storage_defs.h"
 #include "xxHash/xxh3.h"
@@ -55,13 +56,12 @@ class CompactIntsKey {
    * CompactIntsKey
    */
   void SetFromProjectedRow(const storage::ProjectedRow &from, const IndexMetadata &metadata) {
-    const auto &attr_sizes = metadata.GetAttributeSizes();
-    const auto &compact_ints_offsets = metadata.GetCompactIntsOffsets();
+    const auto &attrs = metadata.GetCompactIntsAttrs();
 
-    TERRIER_ASSERT(attr_sizes.size() == from.NumColumns(), "attr_sizes and ProjectedRow must be equal in size.");
-    TERRIER_ASSERT(attr_sizes.size() == compact_ints_offsets.size(),
-                   "attr_sizes and attr_offsets must be equal in size.");
-    TERRIER_ASSERT(!attr_sizes.empty(), "attr_sizes has too few values.");
+    TERRIER_ASSERT(!attrs.empty(), "attrs has too few values.");
+    TERRIER_ASSERT(metadata.HasCompactIntsLayout(from),
+                   "ProjectedRow should be built by the index's ProjectedRowInitializer.");
+    TERRIER_ASSERT(metadata.KeySize() <= KeySize, "out of bounds");
 
     // NOLINTNEXTLINE (Matt): tidy thinks this has side-effects. I disagree.
     TERRIER_ASSERT(std::invoke([&]() -> bool {
@@ -82,22 +82,72 @@ class CompactIntsKey {
                    "There should not be any NULL attributes in this schema.");
 
     // we hash and compare KeySize bytes in all of our operations. Since there might be over-provisioned bytes, we want
-    // to make sure the entire key is memset to 0
-    std::memset(key_data_, 0, KeySize);
+    // to make sure they are memset to 0. The attributes themselves are packed from the start of the key.
+    std::memset(key_data_ + metadata.KeySize(), 0, KeySize - metadata.KeySize());
 
-    for (uint8_t i = 0; i < from.NumColumns(); i++) {
-      TERRIER_ASSERT(compact_ints_offsets[i] + attr_sizes[i] <= KeySize, "out of bounds");
-      CopyAttrFromProjection(from, static_cast<uint16_t>(from.ColumnIds()[i]), attr_sizes[i], compact_ints_offsets[i]);
+    // The value offsets were precomputed from the index's ProjectedRow layout when the index was created
+    const auto *const values = reinterpret_cast<const byte *>(&from);
+    for (const auto &attr : attrs) {
+      CopyAttr(values + attr.value_offset_, attr.size_, attr.key_offset_);
+    }
+  }
+
+  /**
+   * Set a batch of CompactIntsKeys from the tuples of a ProjectedColumns. Keys are built one attribute column at a
+   * time, so the dispatch on the attribute size happens once per column rather than once per value.
+   * @param[out] keys array of at least from->NumTuples() keys to set
+   * @param from ProjectedColumns holding the key attributes, none of them NULL
+   * @param column_offsets projection list index in from of each key attribute (key schema order)
+   * @param metadata index information, primarily attribute sizes and the precomputed offsets into CompactIntsKey
+   */
+  static void SetFromProjectedColumns(CompactIntsKey *const keys, ProjectedColumns *const from,
+                                      const std::vector<uint16_t> &column_offsets, const IndexMetadata &metadata) {
+    const auto &attrs = metadata.GetCompactIntsAttrs();
+    TERRIER_ASSERT(column_offsets.size() == attrs.size(), "column_offsets should have one entry per key attribute.");
+    TERRIER_ASSERT(metadata.KeySize() <= KeySize, "out of bounds");
+
+    const uint32_t num_tuples = from->NumTuples();
+    for (uint32_t i = 0; i < num_tuples; i++) {
+      std::memset(keys[i].key_data_ + metadata.KeySize(), 0, KeySize - metadata.KeySize());
+    }
+
+    for (uint16_t i = 0; i < attrs.size(); i++) {
+      TERRIER_ASSERT(from->AttrSizeForColumn(column_offsets[i]) == attrs[i].size_,
+                     "ProjectedColumns attribute should have the same size as the key attribute.");
+      // NOLINTNEXTLINE (Matt): tidy thinks this has side-effects. I disagree.
+      TERRIER_ASSERT(std::invoke([&]() -> bool {
+                       const auto *const nulls = from->ColumnNullBitmap(column_offsets[i]);
+                       for (uint32_t j = 0; j < num_tuples; j++) {
+                         if (!nulls->Test(j)) return false;
+                       }
+                       return true;
+                     }),
+                     "There should not be any NULL attributes in this key.");
+      const byte *const column = from->ColumnStart(column_offsets[i]);
+      switch (attrs[i].size_) {
+        case sizeof(int8_t):
+          CopyColumn<int8_t>(keys, column, num_tuples, attrs[i].key_offset_);
+          break;
+        case sizeof(int16_t):
+          CopyColumn<int16_t>(keys, column, num_tuples, attrs[i].key_offset_);
+          break;
+        case sizeof(int32_t):
+          CopyColumn<int32_t>(keys, column, num_tuples, attrs[i].key_offset_);
+          break;
+        case sizeof(int64_t):
+          CopyColumn<int64_t>(keys, column, num_tuples, attrs[i].key_offset_);
+          break;
+        default:
+          throw std::runtime_error("Invalid attribute size.");
+      }
     }
   }
 
  private:
   byte key_data_[KeySize];
 
-  void CopyAttrFromProjection(const storage::ProjectedRow &from, const uint16_t projection_list_offset,
-                              const uint8_t attr_size, const uint8_t compact_ints_offset) {
-    const byte *const stored_attr = from.AccessWithNullCheck(projection_list_offset);
-    TERRIER_ASSERT(stored_attr != nullptr, "Cannot index a nullable attribute with CompactIntsKey.");
+  void CopyAttr(const byte *const stored_attr, const uint8_t attr_size, const uint8_t compact_ints_offset) {
+    TERRIER_ASSERT(compact_ints_offset + attr_size <= KeySize, "out of bounds");
     switch (attr_size) {
       case sizeof(int8_t): {
         int8_t data = *reinterpret_cast<const int8_t *>(stored_attr);
@@ -124,6 +174,15 @@ class CompactIntsKey {
     }
   }
 
+  template <typename IntType>
+  static void CopyColumn(CompactIntsKey *const keys, const byte *const column, const uint32_t num_tuples,
+                         const uint8_t compact_ints_offset) {
+    const auto *const values = reinterpret_cast<const IntType *>(column);
+    for (uint32_t i = 0; i < num_tuples; i++) {
+      keys[i].template AddInteger<IntType>(values[i], compact_ints_offset);
+    }
+  }
+
   /*
    * TwoBytesToBigEndian() - Change 2 bytes to big endian
    *
@@ -1,9 +1,11 @@
 #pragma once
 
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 #include "catalog/catalog_defs.h"
+#include "common/managed_pointer.h"
 #include "common/performance_counter.h"
 #include "storage/data_table.h"
 #include "storage/index/index_defs.h"
@@ -13,6 +15,19 @@
 
 namespace terrier::storage::index {
 
+/**
+ * A batch of index entries to be removed by the GarbageCollector. Each element is a pointer to the raw image of an
+ * index key (as staged by Index::StageDelete) and the TupleSlot that was associated with it.
+ */
+using IndexDeleteBatch = std::vector<std::pair<const byte *, TupleSlot>>;
+
+/**
+ * Boundaries of the sub-ranges of a parallel index scan, each one the raw image of an index key. Produced by
+ * Index::PartitionRange and consumed by Index::ScanAscendingPartition. Sub-range i covers [boundary i, boundary i + 1),
+ * except for the last one which also includes the high key of the scan.
+ */
+using IndexRangePartitions = std::vector<std::vector<byte>>;
+
 /**
  * Wrapper class for the various types of indexes in our system. Semantically, we expect updates on indexed attributes
  * to be modeled as a delete and an insert (see bwtree_index_test.cpp CommitUpdate1, CommitUpdate2, etc.). This
@@ -50,6 +65,22 @@ class Index {
    */
   explicit Index(IndexMetadata metadata) : metadata_(std::move(metadata)) {}
 
+  /**
+   * Stage the removal of a key-value pair on the calling txn. The GarbageCollector collects staged deletes from the
+   * txns it unlinks and hands them back to the index in batches through DeleteBatch, at which point no running txn can
+   * see the deleted tuple anymore.
+   * @tparam KeyType the type of keys stored in the index, must be trivially copyable
+   * @param txn txn context for the calling txn
+   * @param index_key key to remove
+   * @param location value to remove
+   */
+  template <typename KeyType>
+  void StageDelete(transaction::TransactionContext *const txn, const KeyType &index_key, const TupleSlot location) {
+    static_assert(std::is_trivially_copyable_v<KeyType>, "Index keys are staged on the txn as raw bytes.");
+    txn->StageIndexDelete(common::ManagedPointer(this), location, reinterpret_cast<const byte *>(&index_key),
+                          sizeof(KeyType));
+  }
+
  public:
   virtual ~Index() = default;
 
@@ -64,6 +95,14 @@ class Index {
    */
   virtual void PerformGarbageCollection() {}
 
+  /**
+   * Removes a batch of key-value pairs whose deletes are no longer visible to any running txn. Implementations are
+   * free to reorder the batch (i.e. sort it by key) to improve the locality of the removals.
+   * @param batch raw key images and values staged by StageDelete
+   * @return number of key-value pairs removed
+   */
+  virtual uint32_t DeleteBatch(const IndexDeleteBatch &batch) = 0;
+
   /**
    * Inserts a new key-value pair into the index, used for non-unique key indexes.
    * @param txn txn context for the calling txn, used to register abort actions
@@ -84,9 +123,9 @@ class Index {
   virtual bool InsertUnique(transaction::TransactionContext *txn, const ProjectedRow &tuple, TupleSlot location) = 0;
 
   /**
-   * Doesn't immediately call delete on the index. Registers a commit action in the txn that will eventually register a
-   * deferred action for the GC to safely call delete on the index when no more transactions need to access the key.
-   * @param txn txn context for the calling txn, used to register commit actions for deferred GC actions
+   * Doesn't immediately call delete on the index. Stages the key on the txn, and the GC will remove it in a batch with
+   * other deletes on this index once the txn has committed and no more transactions need to access the key.
+   * @param txn txn context for the calling txn, used to stage the delete for the GC
    * @param tuple key
    * @param location value
    */
@@ -113,6 +152,34 @@ class Index {
     TERRIER_ASSERT(false, "You called a method on an index type that hasn't implemented it.");
   }
 
+  /**
+   * Splits the key range between the given keys into sub-ranges of roughly equal size that can be scanned in
+   * parallel. There may be fewer sub-ranges than requested, i.e. if the index is small.
+   * @param low_key the key to start at
+   * @param high_key the key to end at
+   * @param num_partitions upper bound on the number of sub-ranges
+   * @param[out] partitions boundaries of the sub-ranges, one more than the number of sub-ranges
+   * @return true if the range was split, false if the index type cannot split ranges, in which case the range must be
+   * scanned with ScanAscending
+   */
+  virtual bool PartitionRange(const ProjectedRow &low_key, const ProjectedRow &high_key, uint32_t num_partitions,
+                              IndexRangePartitions *partitions) {
+    return false;
+  }
+
+  /**
+   * Finds all the values in one of the sub-ranges produced by PartitionRange, sorted in ascending order.
+   * @param txn txn context for the calling txn, used for visibility checks
+   * @param partitions boundaries of the sub-ranges
+   * @param partition index of the sub-range to scan
+   * @param[out] value_list the values associated with the keys
+   */
+  virtual void ScanAscendingPartition(const transaction::TransactionContext &txn,
+                                      const IndexRangePartitions &partitions, uint32_t partition,
+                                      std::vector<TupleSlot> *value_list) {
+    TERRIER_ASSERT(false, "You called a method on an index type that hasn't implemented it.");
+  }
+
   /**
    * Finds all the values between the given keys in our index, sorted in descending order.
    * @param txn txn context for the calling txn, used for visibility checks
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <utility>
 #include <vector>
 #include "catalog/catalog_defs.h"
@@ -12,6 +13,7 @@
 #include "storage/index/index.h"
 #include "storage/index/index_defs.h"
 #include "storage/index/index_metadata.h"
+#include "storage/index/string_key.h"
 #include "storage/projected_row.h"
 
 namespace terrier::storage::index {
@@ -36,21 +38,29 @@ class IndexBuilder {
     const auto &key_cols = key_schema_.GetColumns();
 
     // Check if it's a simple key: that is all attributes are integral and not NULL-able. Simple keys are compatible
-    // with CompactIntsKey and HashKey. Otherwise we fall back to GenericKey.
+    // with CompactIntsKey and HashKey. Keys with VARLEN attributes use StringKey if their encoding is small enough.
+    // Otherwise we fall back to GenericKey.
     bool simple_key = true;
     for (uint16_t i = 0; simple_key && i < key_cols.size(); i++) {
       const auto &attr = key_cols[i];
       simple_key = simple_key && !attr.Nullable();
       simple_key = simple_key && (std::count(NUMERIC_KEY_TYPES.cbegin(), NUMERIC_KEY_TYPES.cend(), attr.Type()) > 0);
     }
+    const bool string_key =
+        metadata.StringKeySize() + sizeof(uint16_t) <= STRINGKEY_MAX_SIZE &&
+        std::any_of(key_cols.cbegin(), key_cols.cend(), [](const catalog::IndexSchema::Column &attr) -> bool {
+          return attr.Type() == type::TypeId::VARCHAR || attr.Type() == type::TypeId::VARBINARY;
+        });
 
     switch (key_schema_.Type()) {
       case IndexType::BWTREE: {
         if (simple_key && metadata.KeySize() <= COMPACTINTSKEY_MAX_SIZE) return BuildBwTreeIntsKey(std::move(metadata));
+        if (string_key) return BuildBwTreeStringKey(std::move(metadata));
         return BuildBwTreeGenericKey(std::move(metadata));
       }
       case IndexType::HASHMAP: {
         if (simple_key && metadata.KeySize() <= HASHKEY_MAX_SIZE) return BuildHashIntsKey(std::move(metadata));
+        if (string_key) return BuildHashStringKey(std::move(metadata));
         return BuildHashGenericKey(std::move(metadata));
       }
       default:
@@ -107,6 +117,30 @@ class IndexBuilder {
     return index;
   }
 
+  Index *BuildBwTreeStringKey(IndexMetadata metadata) const {
+    metadata.SetKeyKind(IndexKeyKind::STRINGKEY);
+    const auto key_size = metadata.StringKeySize() + sizeof(uint16_t);  // account for the size of the length field
+    TERRIER_ASSERT(key_size <= STRINGKEY_MAX_SIZE, "Key size exceeds maximum for this key type.");
+    Index *index = nullptr;
+    if (key_size <= 32) {
+      index = new BwTreeIndex<StringKey<32>>(std::move(metadata));
+    } else if (key_size <= 48) {
+      index = new BwTreeIndex<StringKey<48>>(std::move(metadata));
+    } else if (key_size <= 64) {
+      index = new BwTreeIndex<StringKey<64>>(std::move(metadata));
+    } else if (key_size <= 80) {
+      index = new BwTreeIndex<StringKey<80>>(std::move(metadata));
+    } else if (key_size <= 96) {
+      index = new BwTreeIndex<StringKey<96>>(std::move(metadata));
+    } else if (key_size <= 128) {
+      index = new BwTreeIndex<StringKey<128>>(std::move(metadata));
+    } else if (key_size <= 256) {
+      index = new BwTreeIndex<StringKey<256>>(std::move(metadata));
+    }
+    TERRIER_ASSERT(index != nullptr, "Failed to create a StringKey index.");
+    return index;
+  }
+
   Index *BuildHashIntsKey(IndexMetadata metadata) const {
     metadata.SetKeyKind(IndexKeyKind::HASHKEY);
     const auto key_size = metadata.KeySize();
@@ -148,6 +182,30 @@ class IndexBuilder {
     TERRIER_ASSERT(index != nullptr, "Failed to create an IntsKey index.");
     return index;
   }
+
+  Index *BuildHashStringKey(IndexMetadata metadata) const {
+    metadata.SetKeyKind(IndexKeyKind::STRINGKEY);
+    const auto key_size = metadata.StringKeySize() + sizeof(uint16_t);  // account for the size of the length field
+    TERRIER_ASSERT(key_size <= STRINGKEY_MAX_SIZE, "Key size exceeds maximum for this key type.");
+    Index *index = nullptr;
+    if (key_size <= 32) {
+      index = new HashIndex<StringKey<32>>(std::move(metadata));
+    } else if (key_size <= 48) {
+      index = new HashIndex<StringKey<48>>(std::move(metadata));
+    } else if (key_size <= 64) {
+      index = new HashIndex<StringKey<64>>(std::move(metadata));
+    } else if (key_size <= 80) {
+      index = new HashIndex<StringKey<80>>(std::move(metadata));
+    } else if (key_size <= 96) {
+      index = new HashIndex<StringKey<96>>(std::move(metadata));
+    } else if (key_size <= 128) {
+      index = new HashIndex<StringKey<128>>(std::move(metadata));
+    } else if (key_size <= 256) {
+      index = new HashIndex<StringKey<256>>(std::move(metadata));
+    }
+    TERRIER_ASSERT(index != nullptr, "Failed to create a StringKey index.");
+    return index;
+  }
 };
 
 }  // namespace terrier::storage::index
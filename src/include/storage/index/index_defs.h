@@ -12,7 +12,7 @@ enum class IndexType : char { BWTREE = 'B', HASHMAP = 'H' };
 /**
  * Internal enum to stash with the index to represent its key type. We don't need to persist this.
  */
-enum class IndexKeyKind : uint8_t { COMPACTINTSKEY, GENERICKEY, HASHKEY };
+enum class IndexKeyKind : uint8_t { COMPACTINTSKEY, GENERICKEY, HASHKEY, STRINGKEY };
 
 /**
  * Types that can be used in simple keys, i.e. CompactIntsKey and HashKey
@@ -6,6 +6,7 @@
 #include <utility>
 #include <vector>
 #include "catalog/index_schema.h"
+#include "common/allocator.h"
 #include "common/macros.h"
 #include "storage/index/index_defs.h"
 #include "storage/projected_row.h"
@@ -14,6 +15,33 @@
 
 namespace terrier::storage::index {
 
+/**
+ * Where to read one attribute of a CompactIntsKey from, and where to write it to, precomputed for the key schema so
+ * that building a key needs no null bitmap or offset lookups in the ProjectedRow.
+ */
+struct CompactIntsAttr {
+  /**
+   * byte offset of the attribute's value from the start of a ProjectedRow built by the index's initializer
+   */
+  uint32_t value_offset_;
+  /**
+   * column id of the attribute in the index's ProjectedRow
+   */
+  col_id_t col_id_;
+  /**
+   * projection list index of the attribute in a ProjectedRow built by the index's initializer
+   */
+  uint16_t pr_index_;
+  /**
+   * byte offset to write into in the CompactIntsKey
+   */
+  uint8_t key_offset_;
+  /**
+   * size of the attribute in bytes
+   */
+  uint8_t size_;
+};
+
 /**
  * Precomputes index-related metadata that can be used to optimize the operations of the various index key types.
  */
@@ -32,7 +60,9 @@ class IndexMetadata {
         key_oid_to_offset_(std::move(other.key_oid_to_offset_)),
         initializer_(std::move(other.initializer_)),
         inlined_initializer_(std::move(other.inlined_initializer_)),
+        compact_ints_attrs_(std::move(other.compact_ints_attrs_)),
         key_size_(other.key_size_),
+        string_key_size_(other.string_key_size_),
         key_kind_(other.key_kind_) {}
 
   /**
@@ -50,7 +80,10 @@ class IndexMetadata {
             ProjectedRowInitializer::Create(GetRealAttrSizes(attr_sizes_), ComputePROffsets(inlined_attr_sizes_))),
         inlined_initializer_(
             ProjectedRowInitializer::Create(inlined_attr_sizes_, ComputePROffsets(inlined_attr_sizes_))),
-        key_size_(ComputeKeySize(key_schema_)) {}
+        compact_ints_attrs_(
+            ComputeCompactIntsAttrs(attr_sizes_, compact_ints_offsets_, inlined_attr_sizes_, initializer_)),
+        key_size_(ComputeKeySize(key_schema_)),
+        string_key_size_(ComputeStringKeySize(key_schema_)) {}
 
   /**
    * @return index key schema
@@ -77,6 +110,26 @@ class IndexMetadata {
    */
   const std::vector<uint8_t> &GetCompactIntsOffsets() const { return compact_ints_offsets_; }
 
+  /**
+   * @return where to copy each attribute of a CompactIntsKey from and to (key schema order), empty if there are varlens
+   */
+  const std::vector<CompactIntsAttr> &GetCompactIntsAttrs() const { return compact_ints_attrs_; }
+
+  /**
+   * CompactIntsKeys read their attributes at the offsets in GetCompactIntsAttrs(), which only hold for rows built by the
+   * index's initializer. Meant for assertions, as it compares the column ids of the row.
+   * @param row the ProjectedRow to build a CompactIntsKey from
+   * @return true if the row has the layout of the index's ProjectedRows
+   */
+  bool HasCompactIntsLayout(const ProjectedRow &row) const {
+    if (row.NumColumns() != compact_ints_attrs_.size()) return false;
+    if (row.Size() != initializer_.ProjectedRowSize()) return false;
+    for (const auto &attr : compact_ints_attrs_) {
+      if (row.ColumnIds()[attr.pr_index_] != attr.col_id_) return false;
+    }
+    return true;
+  }
+
   /**
    * @return mapping from key oid to projected row offset
    */
@@ -99,6 +152,11 @@ class IndexMetadata {
    */
   uint16_t KeySize() const { return key_size_; }
 
+  /**
+   * @return upper bound on the number of bytes of a StringKey encoding of this key schema
+   */
+  uint32_t StringKeySize() const { return string_key_size_; }
+
   /**
    * @return IndexKeyKind selected by the IndexBuilder at index construction
    */
@@ -125,7 +183,9 @@ class IndexMetadata {
   std::unordered_map<catalog::indexkeycol_oid_t, uint16_t> key_oid_to_offset_;  // for execution layer
   ProjectedRowInitializer initializer_;                                         // user-facing initializer
   ProjectedRowInitializer inlined_initializer_;                                 // for GenericKey, internal only
+  std::vector<CompactIntsAttr> compact_ints_attrs_;                             // for CompactIntsKey
   uint16_t key_size_;                                                           // for IndexBuilder
+  uint32_t string_key_size_;                                                    // for StringKey
   IndexKeyKind key_kind_;                                                       // for testing
 
   /**
@@ -156,6 +216,31 @@ class IndexMetadata {
     return key_size;
   }
 
+  /**
+   * Computes the upper bound on the StringKey encoding size. NULLable attributes take an extra byte for the NULL
+   * indicator, and a VARLEN that is not the last attribute may double in size from escaping plus a 2-byte terminator.
+   * e.g.   if key_schema is {INTEGER, VARCHAR(8), NULLable VARCHAR(20)}
+   *        then the StringKey size returned is 4 + (2 * 8 + 2) + (1 + 20) = 43
+   */
+  static uint32_t ComputeStringKeySize(const catalog::IndexSchema &key_schema) {
+    uint32_t key_size = 0;
+    const auto &key_cols = key_schema.GetColumns();
+    for (uint16_t i = 0; i < key_cols.size(); i++) {
+      const auto &key = key_cols[i];
+      if (key.Nullable()) key_size++;
+      switch (key.Type()) {
+        case type::TypeId::VARBINARY:
+        case type::TypeId::VARCHAR:
+          key_size += i == key_cols.size() - 1 ? key.MaxVarlenSize() : 2 * key.MaxVarlenSize() + 2;
+          break;
+        default:
+          key_size += type::TypeUtil::GetTypeSize(key.Type());
+          break;
+      }
+    }
+    return key_size;
+  }
+
   /**
    * Computes the attribute sizes as given by the key schema if everything were inlined.
    * Note varchars are inlined as VarlenEntry if they fit, and as (4 bytes of size + varlen content) otherwise.
@@ -219,6 +304,33 @@ class IndexMetadata {
     return scan;
   }
 
+  /**
+   * Computes where each attribute of a CompactIntsKey lives in a ProjectedRow built by the given initializer, and where
+   * it goes in the key. The value offsets are taken from a scratch ProjectedRow since they only depend on the layout.
+   * e.g.   if attr_sizes {4, 4, 8, 1, 2}
+   *        then key offsets are {0, 4, 8, 16, 17} and value offsets point at PR offsets {1, 2, 0, 4, 3}
+   */
+  static std::vector<CompactIntsAttr> ComputeCompactIntsAttrs(const std::vector<uint8_t> &attr_sizes,
+                                                              const std::vector<uint8_t> &compact_ints_offsets,
+                                                              const std::vector<uint16_t> &inlined_attr_sizes,
+                                                              const ProjectedRowInitializer &initializer) {
+    std::vector<CompactIntsAttr> attrs;
+    if (std::find(attr_sizes.cbegin(), attr_sizes.cend(), VARLEN_COLUMN) != attr_sizes.cend()) return attrs;
+
+    const auto pr_offsets = ComputePROffsets(inlined_attr_sizes);
+    byte *const buffer = common::AllocationUtil::AllocateAligned(initializer.ProjectedRowSize());
+    auto *const pr = initializer.InitializeRow(buffer);
+    TERRIER_ASSERT(pr->NumColumns() == attr_sizes.size(), "The index's ProjectedRow should hold exactly the key.");
+    attrs.reserve(attr_sizes.size());
+    for (uint16_t i = 0; i < attr_sizes.size(); i++) {
+      const auto value_offset = static_cast<uint32_t>(pr->AccessForceNotNull(pr_offsets[i]) - buffer);
+      attrs.push_back(
+          {value_offset, pr->ColumnIds()[pr_offsets[i]], pr_offsets[i], compact_ints_offsets[i], attr_sizes[i]});
+    }
+    delete[] buffer;
+    return attrs;
+  }
+
   /**
    * Computes the projected row offsets given the attribute sizes.
    * e.g.   if attr_sizes is {4, 4, 8, 1, 2}
@@ -0,0 +1,572 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+#include <vector>
+
+#include "common/allocator.h"
+#include "common/constants.h"
+#include "common/macros.h"
+#include "common/spin_latch.h"
+
+namespace terrier::storage::index {
+
+/**
+ * A concurrent hash multimap built for HashIndex. It maps each key to a small set of values and differs from
+ * libcuckoo's cuckoohash_map in three ways:
+ *
+ * 1. Values are kept in an inline small-vector in the slot. A key only allocates once it has more than INLINE_VALUES
+ *    values, and then it allocates one flat array instead of a std::unordered_set.
+ * 2. Keys are spread over NUM_PARTITIONS independent open-addressing tables. When a table fills up, its partition
+ *    allocates a bigger one and every later write to the partition moves MIGRATION_BATCH_SIZE slots over. No write
+ *    ever has to stop and rehash the whole map, and only one partition ever has to wait for a rehash at a time.
+ * 3. Readers take no latches. A slot's hash and key never change once published, and its values are protected by a
+ *    per-slot sequence lock that readers validate optimistically, retrying if a writer got in the way.
+ *
+ * Writers serialize per partition on a SpinLatch. Since readers may still be looking at memory that a writer replaced
+ * (an old table after a resize, or a value array that grew), writers never free that memory themselves. They append it
+ * to a RetiredList instead, and the caller frees it once no reader can still hold a reference, e.g. through the
+ * DeferredActionManager. Erase never retires memory, so it can be called without a RetiredList.
+ *
+ * @tparam KeyType the type of keys stored in the map, must be trivially copyable
+ * @tparam ValueType the type of values stored in the map, must be trivially copyable and equality comparable
+ * @tparam Hasher hash function for KeyType
+ * @tparam KeyEqual equality function for KeyType
+ */
+template <typename KeyType, typename ValueType, typename Hasher = std::hash<KeyType>,
+          typename KeyEqual = std::equal_to<KeyType>>
+class PartitionedHashMap {
+ public:
+  static_assert(std::is_trivially_copyable_v<KeyType>, "Keys are copied into slots with memcpy.");
+  static_assert(std::is_trivially_copyable_v<ValueType>, "Values are copied by optimistic readers.");
+
+  /**
+   * Memory that a writer replaced but that readers may still be accessing. Must be freed with delete[].
+   */
+  using RetiredList = std::vector<byte *>;
+
+  /**
+   * Number of independent tables. Must be a power of 2.
+   */
+  static constexpr uint32_t NUM_PARTITIONS = 32;
+
+  /**
+   * Number of values for a key that are stored in the slot itself before spilling to a heap array
+   */
+  static constexpr uint32_t INLINE_VALUES = 2;
+
+  /**
+   * Number of slots of an old table that each write to a partition moves to the partition's new table
+   */
+  static constexpr uint32_t MIGRATION_BATCH_SIZE = 16;
+
+  /**
+   * @param initial_capacity number of slots to start with, split across all of the partitions
+   */
+  explicit PartitionedHashMap(const uint64_t initial_capacity) {
+    uint64_t partition_capacity = MIN_TABLE_CAPACITY;
+    while (partition_capacity * NUM_PARTITIONS < initial_capacity) partition_capacity *= 2;
+    for (auto &partition : partitions_) {
+      partition.table_.store(NewTable(partition_capacity), std::memory_order_relaxed);
+    }
+  }
+
+  /**
+   * Frees all of the tables and value arrays still owned by the map. Retired memory belongs to the caller.
+   */
+  ~PartitionedHashMap() {
+    for (auto &partition : partitions_) {
+      DeleteTable(partition.old_table_.load(std::memory_order_relaxed));
+      DeleteTable(partition.table_.load(std::memory_order_relaxed));
+    }
+  }
+
+  DISALLOW_COPY_AND_MOVE(PartitionedHashMap)
+
+  /**
+   * Adds a value for the key
+   * @param key key to add the value for
+   * @param value value to add
+   * @param retired memory the map stopped using, for the caller to free when it is safe
+   * @return true if the value was added, false if the key already had this value
+   */
+  bool Insert(const KeyType &key, const ValueType &value, RetiredList *const retired) {
+    return InsertIf(key, value, [](const ValueType & /*unused*/) -> bool { return false; }, retired);
+  }
+
+  /**
+   * Adds a value for the key, unless the key has an existing value that conflicts with it. The predicate is evaluated
+   * while holding the key's partition latch, so it serves as an atomic uniqueness check.
+   * @tparam Predicate callable with signature bool(const ValueType &)
+   * @param key key to add the value for
+   * @param value value to add
+   * @param conflict returns true if an existing value for the key prevents the insert
+   * @param retired memory the map stopped using, for the caller to free when it is safe
+   * @return true if the value was added, false if an existing value conflicted or the key already had this value
+   */
+  template <typename Predicate>
+  bool InsertIf(const KeyType &key, const ValueType &value, Predicate conflict, RetiredList *const retired) {
+    TERRIER_ASSERT(retired != nullptr, "Inserts may retire memory.");
+    const uint64_t hash = Hash(key);
+    Partition *const partition = &partitions_[PartitionOf(hash)];
+    common::SpinLatch::ScopedSpinLatch guard(&partition->latch_);
+
+    MigrateBatch(partition, retired);
+    Slot *slot = FindForWrite(partition, hash, key, retired);
+
+    if (slot == nullptr) {
+      // new key: make room for it, then publish it to readers with its first value already in place
+      ReserveSlot(partition, retired);
+      Table *table = partition->table_.load(std::memory_order_relaxed);
+      slot = ClaimSlot(table, hash);
+      if (slot == nullptr) {
+        // ReserveSlot should have left room, but a full table must never be probed forever
+        Resize(partition, 2 * (table->mask_ + 1), retired);
+        table = partition->table_.load(std::memory_order_relaxed);
+        slot = ClaimSlot(table, hash);
+        TERRIER_ASSERT(slot != nullptr, "A freshly resized table must have room for a new key.");
+      }
+      slot->hash_ = hash;
+      std::memcpy(reinterpret_cast<void *>(&slot->key_), &key, sizeof(KeyType));
+      slot->num_values_ = 1;
+      slot->overflowed_ = false;
+      slot->values_.inline_[0] = value;
+      slot->state_.store(FULL, std::memory_order_release);
+      table->used_++;
+      partition->num_keys_.fetch_add(1, std::memory_order_relaxed);
+      return true;
+    }
+
+    const bool was_full = slot->state_.load(std::memory_order_relaxed) == FULL;
+    if (was_full) {
+      const ValueType *const values = Values(slot);
+      for (uint32_t i = 0; i < slot->num_values_; i++) {
+        if (values[i] == value || conflict(values[i])) return false;
+      }
+    }
+
+    BeginWrite(slot);
+    if (!was_full) {
+      // revive the tombstone, its key is identical so readers comparing it are unaffected
+      TERRIER_ASSERT(slot->num_values_ == 0, "Tombstones should not have values.");
+      slot->state_.store(FULL, std::memory_order_relaxed);
+      partition->num_keys_.fetch_add(1, std::memory_order_relaxed);
+    }
+    AppendValue(slot, value, retired);
+    EndWrite(slot);
+    return true;
+  }
+
+  /**
+   * Removes a value for the key
+   * @param key key to remove the value for
+   * @param value value to remove
+   * @return true if the value was removed, false if the key didn't have this value
+   */
+  bool Erase(const KeyType &key, const ValueType &value) {
+    const uint64_t hash = Hash(key);
+    Partition *const partition = &partitions_[PartitionOf(hash)];
+    common::SpinLatch::ScopedSpinLatch guard(&partition->latch_);
+
+    Slot *const slot = FindForWrite(partition, hash, key, nullptr);
+    if (slot == nullptr || slot->state_.load(std::memory_order_relaxed) != FULL) return false;
+
+    ValueType *const values = Values(slot);
+    const uint32_t num_values = slot->num_values_;
+    const auto *const it = std::find(values, values + num_values, value);
+    if (it == values + num_values) return false;
+
+    BeginWrite(slot);
+    values[it - values] = values[num_values - 1];
+    slot->num_values_ = num_values - 1;
+    if (num_values == 1) {
+      // leave a tombstone so that probe sequences running through this slot stay intact until the next resize
+      slot->state_.store(DELETED, std::memory_order_relaxed);
+      partition->num_keys_.fetch_sub(1, std::memory_order_relaxed);
+    }
+    EndWrite(slot);
+    return true;
+  }
+
+  /**
+   * Appends all of the key's values to the given vector. Takes no latches.
+   * @param key key to look up
+   * @param[out] values vector to append the key's values to
+   * @return true if the key was found
+   */
+  bool Find(const KeyType &key, std::vector<ValueType> *const values) const {
+    const uint64_t hash = Hash(key);
+    const Partition &partition = partitions_[PartitionOf(hash)];
+    while (true) {
+      // The current table must be loaded before the old one. See StartResize.
+      const Table *const table = partition.table_.load(std::memory_order_acquire);
+      const Table *const old_table = partition.old_table_.load(std::memory_order_acquire);
+
+      // keys that haven't been migrated yet are in the old table, and moved or new keys are in the current one
+      if (old_table != nullptr) {
+        const LookupResult old_result = Lookup(old_table, hash, key, values);
+        if (old_result == LookupResult::FOUND) return true;
+        if (old_result == LookupResult::DELETED) return false;
+      }
+
+      switch (Lookup(table, hash, key, values)) {
+        case LookupResult::FOUND:
+          return true;
+        case LookupResult::DELETED:
+        case LookupResult::ABSENT:
+          return false;
+        case LookupResult::MOVED:
+          // the table was migrated while we were looking, start over from the partition's current tables
+          break;
+      }
+    }
+  }
+
+  /**
+   * @return number of keys with at least one value. Only exact while there are no concurrent writers.
+   */
+  uint64_t Size() const {
+    uint64_t size = 0;
+    for (const auto &partition : partitions_) size += partition.num_keys_.load(std::memory_order_relaxed);
+    return size;
+  }
+
+  /**
+   * @param key key to hash
+   * @return the hash the map uses for the key. Exposed so that batches of operations can be grouped by partition.
+   */
+  uint64_t Hash(const KeyType &key) const {
+    // finalizer from MurmurHash3, since Hasher may be as weak as the identity function
+    auto hash = static_cast<uint64_t>(hasher_(key));
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+    return hash;
+  }
+
+ private:
+  static constexpr uint64_t MIN_TABLE_CAPACITY = 8;
+  static constexpr uint32_t PARTITION_BITS = 5;
+  static_assert(NUM_PARTITIONS == 1U << PARTITION_BITS);
+
+  // Slot states. Only the transitions EMPTY -> FULL, FULL <-> DELETED, and FULL/DELETED -> MOVED are possible.
+  static constexpr uint8_t EMPTY = 0;
+  static constexpr uint8_t FULL = 1;
+  static constexpr uint8_t DELETED = 2;
+  static constexpr uint8_t MOVED = 3;
+
+  enum class LookupResult : uint8_t { FOUND, DELETED, ABSENT, MOVED };
+
+  struct Overflow {
+    uint64_t capacity_;
+    ValueType *Values() { return reinterpret_cast<ValueType *>(this + 1); }
+    const ValueType *Values() const { return reinterpret_cast<const ValueType *>(this + 1); }
+  };
+
+  struct Slot {
+    std::atomic<uint32_t> version_;  // sequence lock, odd while a writer is modifying the slot
+    std::atomic<uint8_t> state_;
+    bool overflowed_;      // protected by version_
+    uint32_t num_values_;  // protected by version_
+    uint64_t hash_;        // immutable once published
+    KeyType key_;          // immutable once published
+    union {
+      ValueType inline_[INLINE_VALUES];
+      Overflow *overflow_;
+    } values_;  // protected by version_
+  };
+
+  struct Table {
+    uint64_t mask_;  // capacity - 1
+    uint64_t used_;  // slots that are not EMPTY, only accessed by writers
+    Slot *Slots() { return reinterpret_cast<Slot *>(this + 1); }
+    const Slot *Slots() const { return reinterpret_cast<const Slot *>(this + 1); }
+  };
+  static_assert(alignof(Slot) <= sizeof(Table), "Slots must be aligned after the table header.");
+
+  struct alignas(common::Constants::CACHELINE_SIZE) Partition {
+    common::SpinLatch latch_;  // writers only
+    std::atomic<Table *> table_{nullptr};
+    std::atomic<Table *> old_table_{nullptr};  // table being migrated to table_, nullptr if none
+    uint64_t migration_cursor_ = 0;            // next slot of old_table_ to migrate
+    uint64_t unmigrated_ = 0;                  // slots of old_table_ that may still be moved to table_
+    std::atomic<uint64_t> num_keys_{0};
+  };
+
+  std::array<Partition, NUM_PARTITIONS> partitions_;
+  Hasher hasher_;
+  KeyEqual key_equal_;
+
+  static uint32_t PartitionOf(const uint64_t hash) { return static_cast<uint32_t>(hash >> (64 - PARTITION_BITS)); }
+
+  static Table *NewTable(const uint64_t capacity) {
+    TERRIER_ASSERT((capacity & (capacity - 1)) == 0, "Table capacity must be a power of 2.");
+    const uint64_t size = sizeof(Table) + capacity * sizeof(Slot);
+    auto *const table = reinterpret_cast<Table *>(common::AllocationUtil::AllocateAligned(size));
+    std::memset(reinterpret_cast<void *>(table), 0, size);
+    table->mask_ = capacity - 1;
+    return table;
+  }
+
+  static void DeleteTable(Table *const table) {
+    if (table == nullptr) return;
+    for (uint64_t i = 0; i <= table->mask_; i++) {
+      // moved slots share their value array with the slot they were moved to
+      Slot *const slot = &table->Slots()[i];
+      const uint8_t state = slot->state_.load(std::memory_order_relaxed);
+      if ((state == FULL || state == DELETED) && slot->overflowed_) {
+        delete[] reinterpret_cast<byte *>(slot->values_.overflow_);
+      }
+    }
+    delete[] reinterpret_cast<byte *>(table);
+  }
+
+  static Overflow *NewOverflow(const uint64_t capacity) {
+    auto *const overflow = reinterpret_cast<Overflow *>(
+        common::AllocationUtil::AllocateAligned(sizeof(Overflow) + capacity * sizeof(ValueType)));
+    overflow->capacity_ = capacity;
+    return overflow;
+  }
+
+  static ValueType *Values(Slot *const slot) {
+    return slot->overflowed_ ? slot->values_.overflow_->Values() : slot->values_.inline_;
+  }
+
+  static void BeginWrite(Slot *const slot) {
+    slot->version_.store(slot->version_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+  }
+
+  static void EndWrite(Slot *const slot) {
+    slot->version_.store(slot->version_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+  }
+
+  /**
+   * Probes the table for the key and, if found, appends its values under the slot's sequence lock
+   */
+  LookupResult Lookup(const Table *const table, const uint64_t hash, const KeyType &key,
+                      std::vector<ValueType> *const values) const {
+    for (uint64_t i = hash & table->mask_, probes = 0; probes <= table->mask_; i = (i + 1) & table->mask_, probes++) {
+      const Slot &slot = table->Slots()[i];
+      if (slot.state_.load(std::memory_order_acquire) == EMPTY) return LookupResult::ABSENT;
+      if (slot.hash_ != hash || !key_equal_(slot.key_, key)) continue;
+      return ReadValues(slot, values);
+    }
+    return LookupResult::ABSENT;
+  }
+
+  static LookupResult ReadValues(const Slot &slot, std::vector<ValueType> *const values) {
+    const auto original_size = values->size();
+    while (true) {
+      const uint32_t version = slot.version_.load(std::memory_order_acquire);
+      if (version % 2 == 1) continue;  // a writer is in the middle of modifying the slot
+
+      const uint8_t state = slot.state_.load(std::memory_order_relaxed);
+      if (state == FULL) {
+        const uint32_t num_values = slot.num_values_;
+        if (!slot.overflowed_) {
+          const ValueType *const begin = slot.values_.inline_;
+          values->insert(values->end(), begin, begin + std::min(num_values, INLINE_VALUES));
+        } else {
+          const Overflow *const overflow = slot.values_.overflow_;
+          // the pointer has to be validated before it is safe to dereference
+          std::atomic_thread_fence(std::memory_order_acquire);
+          if (slot.version_.load(std::memory_order_relaxed) != version) continue;
+          const ValueType *const begin = overflow->Values();
+          values->insert(values->end(), begin, begin + std::min<uint64_t>(num_values, overflow->capacity_));
+        }
+      }
+
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (slot.version_.load(std::memory_order_relaxed) == version) {
+        switch (state) {
+          case FULL:
+            return LookupResult::FOUND;
+          case DELETED:
+            return LookupResult::DELETED;
+          default:
+            return LookupResult::MOVED;
+        }
+      }
+      values->resize(original_size);
+    }
+  }
+
+  /**
+   * @return the slot holding the key in the table regardless of its state, nullptr if there is none
+   */
+  Slot *FindSlot(Table *const table, const uint64_t hash, const KeyType &key) const {
+    for (uint64_t i = hash & table->mask_, probes = 0; probes <= table->mask_; i = (i + 1) & table->mask_, probes++) {
+      Slot *const slot = &table->Slots()[i];
+      if (slot->state_.load(std::memory_order_relaxed) == EMPTY) return nullptr;
+      if (slot->hash_ == hash && key_equal_(slot->key_, key)) return slot;
+    }
+    return nullptr;
+  }
+
+  /**
+   * @return the first EMPTY slot on the hash's probe sequence, nullptr if the table is full
+   */
+  static Slot *ClaimSlot(Table *const table, const uint64_t hash) {
+    for (uint64_t i = hash & table->mask_, probes = 0; probes <= table->mask_; i = (i + 1) & table->mask_, probes++) {
+      Slot *const slot = &table->Slots()[i];
+      if (slot->state_.load(std::memory_order_relaxed) == EMPTY) return slot;
+    }
+    return nullptr;
+  }
+
+  /**
+   * Writers only ever modify the current table, so a key that is still in the old table is moved over first.
+   * @return the FULL or DELETED slot for the key in the current table, nullptr if the key isn't in the map
+   */
+  Slot *FindForWrite(Partition *const partition, const uint64_t hash, const KeyType &key,
+                     RetiredList *const retired) const {
+    Table *const old_table = partition->old_table_.load(std::memory_order_relaxed);
+    if (old_table != nullptr) {
+      Slot *const old_slot = FindSlot(old_table, hash, key);
+      if (old_slot != nullptr && old_slot->state_.load(std::memory_order_relaxed) != MOVED) {
+        MoveSlot(partition, old_slot, retired);
+      }
+    }
+    return FindSlot(partition->table_.load(std::memory_order_relaxed), hash, key);
+  }
+
+  /**
+   * Copies the slot from the old table into the current table, then marks it as MOVED so readers look there instead.
+   * Tombstones and value arrays that have become small enough to inline are dropped, but only if there is a
+   * RetiredList to hand the value array to.
+   */
+  static void MoveSlot(Partition *const partition, Slot *const old_slot, RetiredList *const retired) {
+    const uint8_t state = old_slot->state_.load(std::memory_order_relaxed);
+    const bool shrink = retired != nullptr && old_slot->overflowed_ && old_slot->num_values_ <= INLINE_VALUES;
+
+    if (state == FULL || retired == nullptr) {
+      Table *const table = partition->table_.load(std::memory_order_relaxed);
+      Slot *const new_slot = ClaimSlot(table, old_slot->hash_);
+      TERRIER_ASSERT(new_slot != nullptr, "ReserveSlot keeps room for every slot that still has to be moved.");
+      new_slot->hash_ = old_slot->hash_;
+      std::memcpy(reinterpret_cast<void *>(&new_slot->key_), &old_slot->key_, sizeof(KeyType));
+      new_slot->num_values_ = old_slot->num_values_;
+      if (shrink) {
+        std::memcpy(reinterpret_cast<void *>(new_slot->values_.inline_), old_slot->values_.overflow_->Values(),
+                    old_slot->num_values_ * sizeof(ValueType));
+        new_slot->overflowed_ = false;
+      } else {
+        // a value array changes owners, the old slot stops owning it once it is MOVED
+        std::memcpy(reinterpret_cast<void *>(&new_slot->values_), &old_slot->values_, sizeof(old_slot->values_));
+        new_slot->overflowed_ = old_slot->overflowed_;
+      }
+      new_slot->state_.store(state, std::memory_order_release);
+      table->used_++;
+    }
+    if (retired != nullptr && old_slot->overflowed_ && (state == DELETED || shrink)) {
+      retired->emplace_back(reinterpret_cast<byte *>(old_slot->values_.overflow_));
+    }
+
+    BeginWrite(old_slot);
+    old_slot->state_.store(MOVED, std::memory_order_relaxed);
+    EndWrite(old_slot);
+    partition->unmigrated_--;
+  }
+
+  /**
+   * Moves the next MIGRATION_BATCH_SIZE slots of the old table, if there is one, and retires it when it is empty
+   */
+  void MigrateBatch(Partition *const partition, RetiredList *const retired) const {
+    Table *const old_table = partition->old_table_.load(std::memory_order_relaxed);
+    if (old_table == nullptr) return;
+
+    for (uint32_t i = 0; i < MIGRATION_BATCH_SIZE && partition->migration_cursor_ <= old_table->mask_; i++) {
+      Slot *const slot = &old_table->Slots()[partition->migration_cursor_++];
+      const uint8_t state = slot->state_.load(std::memory_order_relaxed);
+      if (state == FULL || state == DELETED) MoveSlot(partition, slot, retired);
+    }
+
+    if (partition->migration_cursor_ > old_table->mask_) {
+      TERRIER_ASSERT(partition->unmigrated_ == 0, "Every slot of the old table should have been moved.");
+      partition->old_table_.store(nullptr, std::memory_order_release);
+      retired->emplace_back(reinterpret_cast<byte *>(old_table));
+    }
+  }
+
+  /**
+   * Makes sure the current table has room for one more key, starting a resize if it is too full
+   */
+  void ReserveSlot(Partition *const partition, RetiredList *const retired) const {
+    Table *const table = partition->table_.load(std::memory_order_relaxed);
+    const uint64_t capacity = table->mask_ + 1;
+    // keep the load factor, including tombstones and the old table's slots that may still be moved over, at or below
+    // 3/4. This also guarantees that moving a slot always finds an EMPTY one.
+    if ((table->used_ + partition->unmigrated_ + 1) * 4 <= capacity * 3) return;
+
+    // only one migration can be in flight per partition, so finish the previous one first
+    FinishMigration(partition, retired);
+    if ((table->used_ + 1) * 4 <= capacity * 3) return;
+
+    // size the new table so that it starts out at most half full, it may also just purge tombstones
+    Resize(partition, capacity, retired);
+  }
+
+  /**
+   * Finishes the partition's migration, if any, and starts migrating to a new table with at least the given capacity
+   */
+  void Resize(Partition *const partition, const uint64_t min_capacity, RetiredList *const retired) const {
+    FinishMigration(partition, retired);
+    uint64_t new_capacity = min_capacity;
+    while (partition->num_keys_.load(std::memory_order_relaxed) * 2 >= new_capacity) new_capacity *= 2;
+    StartResize(partition, NewTable(new_capacity));
+  }
+
+  void FinishMigration(Partition *const partition, RetiredList *const retired) const {
+    while (partition->old_table_.load(std::memory_order_relaxed) != nullptr) MigrateBatch(partition, retired);
+  }
+
+  static void StartResize(Partition *const partition, Table *const new_table) {
+    partition->migration_cursor_ = 0;
+    partition->unmigrated_ = partition->table_.load(std::memory_order_relaxed)->used_;
+    // Readers load table_ before old_table_, so old_table_ must be published first. Otherwise a reader could see the
+    // new (still mostly empty) table without the old table that holds the keys that haven't been migrated yet.
+    partition->old_table_.store(partition->table_.load(std::memory_order_relaxed), std::memory_order_release);
+    partition->table_.store(new_table, std::memory_order_release);
+  }
+
+  /**
+   * Adds the value to the slot's small-vector, spilling or growing the heap array as needed. Must be called between
+   * BeginWrite and EndWrite.
+   */
+  static void AppendValue(Slot *const slot, const ValueType &value, RetiredList *const retired) {
+    const uint32_t num_values = slot->num_values_;
+    if (!slot->overflowed_) {
+      if (num_values < INLINE_VALUES) {
+        slot->values_.inline_[num_values] = value;
+      } else {
+        Overflow *const overflow = NewOverflow(2 * INLINE_VALUES);
+        std::memcpy(reinterpret_cast<void *>(overflow->Values()), slot->values_.inline_,
+                    num_values * sizeof(ValueType));
+        overflow->Values()[num_values] = value;
+        slot->values_.overflow_ = overflow;
+        slot->overflowed_ = true;
+      }
+    } else {
+      Overflow *const overflow = slot->values_.overflow_;
+      if (num_values < overflow->capacity_) {
+        overflow->Values()[num_values] = value;
+      } else {
+        Overflow *const grown = NewOverflow(2 * overflow->capacity_);
+        std::memcpy(reinterpret_cast<void *>(grown->Values()), overflow->Values(), num_values * sizeof(ValueType));
+        grown->Values()[num_values] = value;
+        slot->values_.overflow_ = grown;
+        retired->emplace_back(reinterpret_cast<byte *>(overflow));
+      }
+    }
+    slot->num_values_ = num_values + 1;
+  }
+};
+
+}  // namespace terrier::storage::index
@@ -0,0 +1,222 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+
+#include "common/macros.h"
+#include "storage/index/index_metadata.h"
+#include "storage/projected_row.h"
+#include "storage/storage_defs.h"
+#include "xxHash/xxh3.h"
+
+namespace terrier::storage::index {
+
+// This is the maximum number of bytes to pack into a single StringKey template, including the 2-byte length field. Keys
+// whose encoding could be longer than this fall back to GenericKey.
+constexpr uint16_t STRINGKEY_MAX_SIZE = 256;
+
+/**
+ * StringKey is a key type for index key schemas with VARLEN attributes. Rather than storing a ProjectedRow and
+ * interpreting it column by column like GenericKey, every attribute is serialized into an order-preserving binary
+ * encoding so that the whole key can be compared with a single std::memcmp and hashed as one run of bytes. Only the
+ * bytes actually used by the encoding are compared and hashed, so short strings in a wide VARCHAR column are cheap.
+ *
+ * The encoding, per key column in key schema order:
+ * - NULLable columns get a 1-byte prefix, 0x00 for NULL and 0x01 otherwise, so NULLs sort first like in GenericKey
+ * - integers are written big-endian with the sign bit flipped, DATE and TIMESTAMP big-endian as unsigned
+ * - DECIMAL has the sign bit flipped for positive values and all bits flipped for negative values, then big-endian
+ * - VARLENs are written raw if they are the last column; otherwise every 0x00 byte is escaped as 0x00 0xFF and the
+ *   value is terminated with 0x00 0x00, which keeps the shorter of two prefix-equal strings first
+ * @tparam KeySize number of bytes for the key, including the length field
+ */
+template <uint16_t KeySize>
+class StringKey {
+ public:
+  static_assert(KeySize > sizeof(uint16_t) && KeySize <= STRINGKEY_MAX_SIZE);
+
+  /**
+   * Capacity of the key's internal buffer
+   */
+  static constexpr uint16_t CAPACITY = KeySize - sizeof(uint16_t);
+
+  /**
+   * Set the StringKey's data based on a ProjectedRow and associated index metadata
+   * @param from ProjectedRow to generate StringKey representation of
+   * @param metadata index information, key_schema used to interpret PR data correctly
+   */
+  void SetFromProjectedRow(const storage::ProjectedRow &from, const IndexMetadata &metadata) {
+    TERRIER_ASSERT(from.NumColumns() == metadata.GetSchema().GetColumns().size(),
+                   "ProjectedRow should have the same number of columns at the original key schema.");
+    TERRIER_ASSERT(metadata.StringKeySize() <= CAPACITY, "Encoded key may not fit in this StringKey.");
+    size_ = 0;
+
+    const auto &key_cols = metadata.GetSchema().GetColumns();
+    for (uint16_t i = 0; i < key_cols.size(); i++) {
+      const auto offset = static_cast<uint16_t>(from.ColumnIds()[i]);
+      const byte *const attr = from.AccessWithNullCheck(offset);
+      if (key_cols[i].Nullable()) {
+        Append(static_cast<uint8_t>(attr == nullptr ? 0x00 : 0x01));
+        if (attr == nullptr) continue;
+      }
+      TERRIER_ASSERT(attr != nullptr, "NULL value in a non-NULLable key column.");
+
+      switch (key_cols[i].Type()) {
+        case type::TypeId::BOOLEAN:
+        case type::TypeId::TINYINT:
+          AppendSigned(*reinterpret_cast<const int8_t *>(attr));
+          break;
+        case type::TypeId::SMALLINT:
+          AppendSigned(*reinterpret_cast<const int16_t *>(attr));
+          break;
+        case type::TypeId::INTEGER:
+          AppendSigned(*reinterpret_cast<const int32_t *>(attr));
+          break;
+        case type::TypeId::BIGINT:
+          AppendSigned(*reinterpret_cast<const int64_t *>(attr));
+          break;
+        case type::TypeId::DATE:
+          AppendUnsigned(*reinterpret_cast<const uint32_t *>(attr));
+          break;
+        case type::TypeId::TIMESTAMP:
+          AppendUnsigned(*reinterpret_cast<const uint64_t *>(attr));
+          break;
+        case type::TypeId::DECIMAL: {
+          // -0.0 and 0.0 compare as equal, so they must produce the same bytes
+          double value = *reinterpret_cast<const double *>(attr);
+          if (value == 0.0) value = 0.0;
+          uint64_t bits;
+          std::memcpy(&bits, &value, sizeof(bits));
+          constexpr uint64_t sign_bit = static_cast<uint64_t>(1) << 63;
+          AppendUnsigned((bits & sign_bit) != 0 ? ~bits : bits ^ sign_bit);
+          break;
+        }
+        case type::TypeId::VARCHAR:
+        case type::TypeId::VARBINARY: {
+          const auto *const varlen = reinterpret_cast<const VarlenEntry *>(attr);
+          TERRIER_ASSERT(varlen->Size() <= key_cols[i].MaxVarlenSize(), "VARLEN is larger than the key schema allows.");
+          AppendVarlen(varlen->Content(), varlen->Size(), i == key_cols.size() - 1);
+          break;
+        }
+        default:
+          throw std::runtime_error("Unknown TypeId in terrier::storage::index::StringKey.");
+      }
+    }
+  }
+
+  /**
+   * @return number of bytes of the encoding in use
+   */
+  uint16_t Size() const { return size_; }
+
+  /**
+   * @return pointer to the encoded key, exposed for hasher and comparators
+   */
+  const byte *Data() const { return key_data_; }
+
+  /**
+   * @param lhs first key to be compared
+   * @param rhs second key to be compared
+   * @return std::memcmp semantics: < 0 means first is less than second, 0 means equal, > 0 means first is greater
+   * than second
+   */
+  static int Compare(const StringKey &lhs, const StringKey &rhs) {
+    const int result = std::memcmp(lhs.key_data_, rhs.key_data_, std::min(lhs.size_, rhs.size_));
+    return result != 0 ? result : static_cast<int>(lhs.size_) - static_cast<int>(rhs.size_);
+  }
+
+ private:
+  void Append(const uint8_t value) {
+    TERRIER_ASSERT(size_ < CAPACITY, "StringKey will write out of bounds.");
+    key_data_[size_++] = static_cast<byte>(value);
+  }
+
+  template <typename Unsigned>
+  void AppendUnsigned(const Unsigned value) {
+    for (int32_t shift = static_cast<int32_t>(sizeof(Unsigned) - 1) * 8; shift >= 0; shift -= 8) {
+      Append(static_cast<uint8_t>(value >> shift));
+    }
+  }
+
+  template <typename Signed>
+  void AppendSigned(const Signed value) {
+    using Unsigned = std::make_unsigned_t<Signed>;
+    constexpr auto sign_bit = static_cast<Unsigned>(static_cast<Unsigned>(1) << (sizeof(Signed) * 8 - 1));
+    AppendUnsigned(static_cast<Unsigned>(static_cast<Unsigned>(value) ^ sign_bit));
+  }
+
+  void AppendVarlen(const byte *const content, const uint32_t size, const bool last) {
+    if (last) {
+      TERRIER_ASSERT(size_ + size <= CAPACITY, "StringKey will write out of bounds.");
+      std::memcpy(key_data_ + size_, content, size);
+      size_ = static_cast<uint16_t>(size_ + size);
+      return;
+    }
+    for (uint32_t i = 0; i < size; i++) {
+      const auto value = static_cast<uint8_t>(content[i]);
+      Append(value);
+      if (value == 0x00) Append(0xFF);
+    }
+    Append(0x00);
+    Append(0x00);
+  }
+
+  uint16_t size_ = 0;
+  byte key_data_[CAPACITY];
+};
+
+}  // namespace terrier::storage::index
+
+namespace std {
+
+/**
+ * Implements std::hash for StringKey. Allows the class to be used with STL containers and the BwTree index.
+ * @tparam KeySize number of bytes for the key
+ */
+template <uint16_t KeySize>
+struct hash<terrier::storage::index::StringKey<KeySize>> {
+ public:
+  /**
+   * @param key key to be hashed
+   * @return hash of the key's encoding
+   */
+  size_t operator()(terrier::storage::index::StringKey<KeySize> const &key) const {
+    return XXH3_64bits(reinterpret_cast<const void *>(key.Data()), key.Size());
+  }
+};
+
+/**
+ * Implements std::equal_to for StringKey. Allows the class to be used with containers that expect STL interface.
+ * @tparam KeySize number of bytes for the key
+ */
+template <uint16_t KeySize>
+struct equal_to<terrier::storage::index::StringKey<KeySize>> {
+  /**
+   * @param lhs first key to be compared
+   * @param rhs second key to be compared
+   * @return true if first key is equal to the second key
+   */
+  bool operator()(const terrier::storage::index::StringKey<KeySize> &lhs,
+                  const terrier::storage::index::StringKey<KeySize> &rhs) const {
+    return lhs.Size() == rhs.Size() && std::memcmp(lhs.Data(), rhs.Data(), lhs.Size()) == 0;
+  }
+};
+
+/**
+ * Implements std::less for StringKey. Allows the class to be used with containers that expect STL interface.
+ * @tparam KeySize number of bytes for the key
+ */
+template <uint16_t KeySize>
+struct less<terrier::storage::index::StringKey<KeySize>> {
+  /**
+   * @param lhs first key to be compared
+   * @param rhs second key to be compared
+   * @return true if first key is less than the second key
+   */
+  bool operator()(const terrier::storage::index::StringKey<KeySize> &lhs,
+                  const terrier::storage::index::StringKey<KeySize> &rhs) const {
+    return terrier::storage::index::StringKey<KeySize>::Compare(lhs, rhs) < 0;
+  }
+};
+}  // namespace std
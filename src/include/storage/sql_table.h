@@ -148,6 +148,30 @@ class SqlTable {
     return table_.data_table_->Scan(txn, start_pos, out_buffer);
   }
 
+  /**
+   * Sequentially scans the table like Scan() above, but stops at the given end of a range of the table instead of at
+   * the end of the table.
+   *
+   * @param txn the calling transaction
+   * @param start_pos iterator to the starting location for the sequential scan
+   * @param end_pos iterator one past the last slot to scan, e.g. a boundary returned by BlockRangeBoundaries()
+   * @param out_buffer output buffer. The object should already contain projection list information. This buffer is
+   *                   always cleared of old values.
+   */
+  void Scan(transaction::TransactionContext *const txn, DataTable::SlotIterator *const start_pos,
+            const DataTable::SlotIterator &end_pos, ProjectedColumns *const out_buffer) const {
+    return table_.data_table_->Scan(txn, start_pos, end_pos, out_buffer);
+  }
+
+  /**
+   * Splits the blocks of the underlying DataTable into ranges of consecutive blocks
+   * @param blocks_per_range the number of blocks in each range but the last, at least one
+   * @return the boundaries of the ranges, the last one being end()
+   */
+  std::vector<DataTable::SlotIterator> BlockRangeBoundaries(const uint32_t blocks_per_range) const {
+    return table_.data_table_->BlockRangeBoundaries(blocks_per_range);
+  }
+
   /**
    * @return the first tuple slot contained in the underlying DataTable
    */
@@ -9,6 +9,19 @@
 #include "traffic_cop/sqlite.h"
 #include "traffic_cop/statement.h"
 
+namespace terrier::execution {
+namespace exec {
+class ExecutionContext;
+}  // namespace exec
+namespace vm {
+enum class ExecutionMode : uint8_t;
+}  // namespace vm
+}  // namespace terrier::execution
+
+namespace terrier::planner {
+class AbstractPlanNode;
+}  // namespace terrier::planner
+
 namespace terrier::trafficcop {
 
 /**
@@ -35,6 +48,18 @@ class TrafficCop {
    */
   SqliteEngine *GetExecutionEngine() { return &sqlite_engine_; }
 
+  /**
+   * Execute a physical plan by compiling it into a TPL module. Statements are only run by the SqliteEngine when their
+   * plan can't be compiled. Nothing plans SQL text yet, so the statements clients send still all go to the
+   * SqliteEngine; this is the entry point for plans once they do.
+   * @param plan the root of the plan to execute
+   * @param exec_ctx the execution context to run the plan in, its output buffer receives the plan's rows
+   * @param mode the mode to run the compiled module in
+   * @return true if the plan was compiled and executed, false if it isn't supported and must run in the SqliteEngine
+   */
+  bool ExecutePlan(const planner::AbstractPlanNode &plan, execution::exec::ExecutionContext *exec_ctx,
+                   execution::vm::ExecutionMode mode);
+
   /**
    * Hands a buffer of logs to replication
    * @param buffer buffer containing logs
@@ -1,6 +1,8 @@
 #pragma once
+#include <cstring>
 #include <vector>
 #include "common/macros.h"
+#include "common/managed_pointer.h"
 #include "common/object_pool.h"
 #include "common/strong_typedef.h"
 #include "storage/data_table.h"
@@ -20,6 +22,9 @@ class SqlTable;
 class WriteAheadLoggingTests;
 class RecoveryManager;
 class RecoveryTests;
+namespace index {
+class Index;
+}  // namespace index
 }  // namespace terrier::storage
 
 namespace terrier::transaction {
@@ -150,7 +155,7 @@ class TransactionContext {
   /**
    * @return whether the transaction is read-only
    */
-  bool IsReadOnly() const { return undo_buffer_.Empty() && loose_ptrs_.empty(); }
+  bool IsReadOnly() const { return undo_buffer_.Empty() && loose_ptrs_.empty() && index_deletes_.empty(); }
 
   /**
    * Defers an action to be called if and only if the transaction aborts.  Actions executed LIFO.
@@ -199,6 +204,7 @@ class TransactionContext {
   friend class storage::WriteAheadLoggingTests;  // Needs access to redo buffer
   friend class storage::RecoveryManager;         // Needs access to StageRecoveryUpdate
   friend class storage::RecoveryTests;           // Needs access to redo buffer
+  friend class storage::index::Index;            // Needs access to StageIndexDelete
   const timestamp_t start_time_;
   std::atomic<timestamp_t> finish_time_;
   storage::UndoBuffer undo_buffer_;
@@ -207,6 +213,19 @@ class TransactionContext {
   //
   std::vector<const byte *> loose_ptrs_;
 
+  /**
+   * An index delete staged on this txn. The key's raw image lives in index_delete_keys_ at key_offset_.
+   */
+  struct IndexDeleteRecord {
+    common::ManagedPointer<storage::index::Index> index_;
+    storage::TupleSlot slot_;
+    uint32_t key_offset_;
+  };
+  // Index deletes are not applied at commit. The GC collects them when it unlinks this txn and removes them from each
+  // index in batches.
+  std::vector<IndexDeleteRecord> index_deletes_;
+  std::vector<byte> index_delete_keys_;
+
   // These actions will be triggered (not deferred) at abort/commit.
   std::forward_list<TransactionEndAction> abort_actions_;
   std::forward_list<TransactionEndAction> commit_actions_;
@@ -220,6 +239,21 @@ class TransactionContext {
   // conflicts) and checked in Commit().
   bool must_abort_ = false;
 
+  /**
+   * Copy an index key into this txn so the GC can remove it from the index after this txn is unlinked
+   * @param index the index to remove the key from
+   * @param slot the value associated with the key
+   * @param key raw image of the index key
+   * @param key_size size of the index key in bytes
+   */
+  void StageIndexDelete(const common::ManagedPointer<storage::index::Index> index, const storage::TupleSlot slot,
+                        const byte *const key, const uint32_t key_size) {
+    const auto key_offset = static_cast<uint32_t>(index_delete_keys_.size());
+    index_delete_keys_.resize(key_offset + key_size);
+    std::memcpy(&index_delete_keys_[key_offset], key, key_size);
+    index_deletes_.push_back({index, slot, key_offset});
+  }
+
   /**
    * @warning This method is ONLY for recovery
    * Copy the log record into the transaction's redo buffer.
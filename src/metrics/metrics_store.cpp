@@ -2,6 +2,8 @@
 #include <bitset>
 #include <memory>
 #include <vector>
+#include "metrics/execution_metric.h"
+#include "metrics/garbage_collection_metric.h"
 #include "metrics/logging_metric.h"
 #include "metrics/metrics_defs.h"
 
@@ -12,6 +14,8 @@ MetricsStore::MetricsStore(const common::ManagedPointer<metrics::MetricsManager>
     : metrics_manager_(metrics_manager), enabled_metrics_{enabled_metrics} {
   logging_metric_ = std::make_unique<LoggingMetric>();
   txn_metric_ = std::make_unique<TransactionMetric>();
+  gc_metric_ = std::make_unique<GarbageCollectionMetric>();
+  execution_metric_ = std::make_unique<ExecutionMetric>();
 }
 
 std::array<std::unique_ptr<AbstractRawData>, NUM_COMPONENTS> MetricsStore::GetDataToAggregate() {
@@ -34,6 +38,20 @@ std::array<std::unique_ptr<AbstractRawData>, NUM_COMPONENTS> MetricsStore::GetDa
           result[component] = txn_metric_->Swap();
           break;
         }
+        case MetricsComponent::GARBAGECOLLECTION: {
+          TERRIER_ASSERT(
+              gc_metric_ != nullptr,
+              "GarbageCollectionMetric cannot be a nullptr. Check the MetricsStore constructor that it was allocated.");
+          result[component] = gc_metric_->Swap();
+          break;
+        }
+        case MetricsComponent::EXECUTION: {
+          TERRIER_ASSERT(
+              execution_metric_ != nullptr,
+              "ExecutionMetric cannot be a nullptr. Check the MetricsStore constructor that it was allocated.");
+          result[component] = execution_metric_->Swap();
+          break;
+        }
       }
     }
   }
@@ -19,6 +19,11 @@ common::hash_t AggregatePlanNode::Hash() const {
     hash = common::HashUtil::CombineHashes(hash, aggregate_term->Hash());
   }
 
+  // Group By Terms
+  for (auto &group_by_term : group_by_terms_) {
+    hash = common::HashUtil::CombineHashes(hash, group_by_term->Hash());
+  }
+
   // Aggregate Strategy
   hash = common::HashUtil::CombineHashes(hash, common::HashUtil::Hash(aggregate_strategy_));
 
@@ -46,6 +51,12 @@ bool AggregatePlanNode::operator==(const AbstractPlanNode &rhs) const {
     if (left_term != nullptr && *left_term != *right_term) return false;
   }
 
+  // Group By Terms
+  if (group_by_terms_.size() != other.GetGroupByTerms().size()) return false;
+  for (size_t i = 0; i < group_by_terms_.size(); i++) {
+    if (*group_by_terms_[i] != *other.group_by_terms_[i]) return false;
+  }
+
   // Aggregate Strategy
   return (aggregate_strategy_ == other.aggregate_strategy_);
 }
@@ -59,6 +70,12 @@ nlohmann::json AggregatePlanNode::ToJson() const {
     agg_terms.emplace_back(agg->ToJson());
   }
   j["aggregate_terms"] = agg_terms;
+  std::vector<nlohmann::json> group_by_terms;
+  group_by_terms.reserve(group_by_terms_.size());
+  for (const auto &term : group_by_terms_) {
+    group_by_terms.emplace_back(term->ToJson());
+  }
+  j["group_by_terms"] = group_by_terms;
   j["aggregate_strategy"] = aggregate_strategy_;
   return j;
 }
@@ -86,6 +103,16 @@ std::vector<std::unique_ptr<parser::AbstractExpression>> AggregatePlanNode::From
                  std::make_move_iterator(deserialized.non_owned_exprs_.end()));
   }
 
+  // Deserialize group by terms
+  auto group_by_term_jsons = j.at("group_by_terms").get<std::vector<nlohmann::json>>();
+  for (const auto &json : group_by_term_jsons) {
+    auto deserialized = parser::DeserializeExpression(json);
+    group_by_terms_.emplace_back(common::ManagedPointer(deserialized.result_));
+    exprs.emplace_back(std::move(deserialized.result_));
+    exprs.insert(exprs.end(), std::make_move_iterator(deserialized.non_owned_exprs_.begin()),
+                 std::make_move_iterator(deserialized.non_owned_exprs_.end()));
+  }
+
   aggregate_strategy_ = j.at("aggregate_strategy").get<AggregateStrategyType>();
 
   return exprs;
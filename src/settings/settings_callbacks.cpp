@@ -69,4 +69,26 @@ void Callbacks::MetricsTransaction(void *const old_value, void *const new_value,
   action_context->SetState(common::ActionState::SUCCESS);
 }
 
+void Callbacks::MetricsGC(void *const old_value, void *const new_value, DBMain *const db_main,
+                          const std::shared_ptr<common::ActionContext> &action_context) {
+  action_context->SetState(common::ActionState::IN_PROGRESS);
+  bool new_status = *static_cast<bool *>(new_value);
+  if (new_status)
+    db_main->metrics_manager_->EnableMetric(metrics::MetricsComponent::GARBAGECOLLECTION);
+  else
+    db_main->metrics_manager_->DisableMetric(metrics::MetricsComponent::GARBAGECOLLECTION);
+  action_context->SetState(common::ActionState::SUCCESS);
+}
+
+void Callbacks::MetricsExecution(void *const old_value, void *const new_value, DBMain *const db_main,
+                                 const std::shared_ptr<common::ActionContext> &action_context) {
+  action_context->SetState(common::ActionState::IN_PROGRESS);
+  bool new_status = *static_cast<bool *>(new_value);
+  if (new_status)
+    db_main->metrics_manager_->EnableMetric(metrics::MetricsComponent::EXECUTION);
+  else
+    db_main->metrics_manager_->DisableMetric(metrics::MetricsComponent::EXECUTION);
+  action_context->SetState(common::ActionState::SUCCESS);
+}
+
 }  // namespace terrier::settings
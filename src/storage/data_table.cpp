@@ -3,6 +3,7 @@
 #include <cstring>
 #include <list>
 #include <unordered_map>
+#include <vector>
 #include "common/allocator.h"
 #include "storage/block_access_controller.h"
 #include "storage/storage_util.h"
@@ -59,6 +60,37 @@ void DataTable::Scan(transaction::TransactionContext *const txn, SlotIterator *c
   out_buffer->SetNumTuples(filled);
 }
 
+void DataTable::Scan(transaction::TransactionContext *const txn, SlotIterator *const start_pos,
+                     const SlotIterator &end_pos, ProjectedColumns *const out_buffer) const {
+  uint32_t filled = 0;
+  while (filled < out_buffer->MaxTuples() && *start_pos != end_pos) {
+    ProjectedColumns::RowView row = out_buffer->InterpretAsRow(filled);
+    const TupleSlot slot = **start_pos;
+    // Only fill the buffer with valid, visible tuples
+    if (SelectIntoBuffer(txn, slot, &row)) {
+      out_buffer->TupleSlots()[filled] = slot;
+      filled++;
+    }
+    ++(*start_pos);
+  }
+  out_buffer->SetNumTuples(filled);
+}
+
+std::vector<DataTable::SlotIterator> DataTable::BlockRangeBoundaries(const uint32_t blocks_per_range) const {
+  TERRIER_ASSERT(blocks_per_range > 0, "A range must have at least one block.");
+  std::vector<SlotIterator> boundaries;
+  {
+    common::SpinLatch::ScopedSpinLatch guard(&blocks_latch_);
+    uint32_t num_blocks = 0;
+    for (auto block = blocks_.begin(); block != blocks_.end(); ++block, ++num_blocks) {
+      if (num_blocks % blocks_per_range == 0) boundaries.push_back({this, block, 0});
+    }
+  }
+  // end() takes the latch itself. Blocks appended meanwhile fall into the last range.
+  boundaries.push_back(end());
+  return boundaries;
+}
+
 DataTable::SlotIterator &DataTable::SlotIterator::operator++() {
   common::SpinLatch::ScopedSpinLatch guard(&table_->blocks_latch_);
   // Jump to the next block if already the last slot in the block.
@@ -2,7 +2,10 @@
 #include <unordered_set>
 #include <utility>
 #include "common/macros.h"
+#include "common/scoped_timer.h"
+#include "common/thread_context.h"
 #include "loggers/storage_logger.h"
+#include "metrics/metrics_store.h"
 #include "storage/data_table.h"
 #include "transaction/deferred_action_manager.h"
 #include "transaction/transaction_context.h"
@@ -27,6 +30,7 @@ std::pair<uint32_t, uint32_t> GarbageCollector::PerformGarbageCollection() {
   }
   STORAGE_LOG_TRACE("GarbageCollector::PerformGarbageCollection(): last_unlinked_: {}",
                     static_cast<uint64_t>(last_unlinked_));
+  ProcessIndexDeletes();
   ProcessDeferredActions(oldest_txn);
   ProcessIndexes();
   return std::make_pair(txns_deallocated, txns_unlinked);
@@ -92,6 +96,8 @@ uint32_t GarbageCollector::ProcessUnlinkQueue(transaction::timestamp_t oldest_tx
         }
         if (observer_ != nullptr) observer_->ObserveWrite(undo_record.Slot().GetBlock());
       }
+      // An aborted txn's index deletes never took effect, so there is nothing to remove from the indexes
+      if (!txn->Aborted()) CollectIndexDeletes(txn);
       txns_to_deallocate_.push_front(txn);
       txns_processed++;
     } else {
@@ -192,11 +198,45 @@ void GarbageCollector::ReclaimBufferIfVarlen(transaction::TransactionContext *co
   }
 }
 
+void GarbageCollector::CollectIndexDeletes(transaction::TransactionContext *const txn) {
+  for (const auto &record : txn->index_deletes_) {
+    // The key images stay valid until the txn is deallocated, which cannot happen before the end of this GC run
+    index_delete_batches_[record.index_].emplace_back(&txn->index_delete_keys_[record.key_offset_], record.slot_);
+  }
+}
+
+void GarbageCollector::ProcessIndexDeletes() {
+  common::SharedLatch::ScopedSharedLatch guard(&indexes_latch_);
+  for (auto it = index_delete_batches_.begin(); it != index_delete_batches_.end();) {
+    auto &batch = it->second;
+    if (batch.empty()) {
+      // No deletes for this index since the last run, stop tracking it so that dropped indexes don't pile up
+      it = index_delete_batches_.erase(it);
+      continue;
+    }
+    uint64_t elapsed_us = 0;
+    uint32_t num_deletes;
+    {
+      common::ScopedTimer<std::chrono::microseconds> timer(&elapsed_us);
+      num_deletes = it->first->DeleteBatch(batch);
+    }
+    STORAGE_LOG_TRACE("GarbageCollector::ProcessIndexDeletes(): num_deletes: {}", num_deletes);
+    const auto stats = indexes_.find(it->first);
+    if (stats != indexes_.end()) {
+      stats->second.dead_entries_ += num_deletes;
+      stats->second.num_deletes_ += num_deletes;
+      stats->second.elapsed_us_ += elapsed_us;
+    }
+    batch.clear();
+    ++it;
+  }
+}
+
 void GarbageCollector::RegisterIndexForGC(const common::ManagedPointer<index::Index> index) {
   TERRIER_ASSERT(index != nullptr, "Index cannot be nullptr.");
   common::SharedLatch::ScopedExclusiveLatch guard(&indexes_latch_);
   TERRIER_ASSERT(indexes_.count(index) == 0, "Trying to register an index that has already been registered.");
-  indexes_.insert(index);
+  indexes_.emplace(index, IndexGCStats());
 }
 
 void GarbageCollector::UnregisterIndexForGC(const common::ManagedPointer<index::Index> index) {
@@ -207,8 +247,36 @@ void GarbageCollector::UnregisterIndexForGC(const common::ManagedPointer<index::
 }
 
 void GarbageCollector::ProcessIndexes() {
+  const bool metrics_enabled =
+      common::thread_context.metrics_store_ != nullptr &&
+      common::thread_context.metrics_store_->ComponentEnabled(metrics::MetricsComponent::GARBAGECOLLECTION);
   common::SharedLatch::ScopedSharedLatch guard(&indexes_latch_);
-  for (const auto &index : indexes_) index->PerformGarbageCollection();
+  for (auto &index_and_stats : indexes_) {
+    const auto &index = index_and_stats.first;
+    auto &stats = index_and_stats.second;
+    // Only pay for the index's own cleanup once it has accumulated enough garbage to be worth it
+    const bool consolidate = stats.dead_entries_ >= INDEX_GC_DEAD_ENTRIES_THRESHOLD ||
+                             ++stats.deferred_runs_ >= INDEX_GC_MAX_DEFERRED_RUNS;
+    if (consolidate) {
+      uint64_t elapsed_us = 0;
+      {
+        common::ScopedTimer<std::chrono::microseconds> timer(&elapsed_us);
+        index->PerformGarbageCollection();
+      }
+      stats.elapsed_us_ += elapsed_us;
+    }
+    if (metrics_enabled && (consolidate || stats.num_deletes_ > 0)) {
+      common::thread_context.metrics_store_->RecordIndexGCData(reinterpret_cast<uintptr_t>(index.Get()), index->Type(),
+                                                               stats.elapsed_us_, stats.num_deletes_,
+                                                               stats.dead_entries_, consolidate);
+    }
+    if (consolidate) {
+      stats.dead_entries_ = 0;
+      stats.deferred_runs_ = 0;
+    }
+    stats.num_deletes_ = 0;
+    stats.elapsed_us_ = 0;
+  }
 }
 
 }  // namespace terrier::storage
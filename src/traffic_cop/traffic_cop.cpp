@@ -0,0 +1,16 @@
+#include "traffic_cop/traffic_cop.h"
+
+#include "execution/compiler/executable_query.h"
+#include "execution/exec/execution_context.h"
+
+namespace terrier::trafficcop {
+
+bool TrafficCop::ExecutePlan(const planner::AbstractPlanNode &plan, execution::exec::ExecutionContext *exec_ctx,
+                             const execution::vm::ExecutionMode mode) {
+  execution::compiler::ExecutableQuery query(plan, exec_ctx);
+  if (!query.IsCompiled()) return false;
+  query.Run(exec_ctx, mode);
+  return true;
+}
+
+}  // namespace terrier::trafficcop
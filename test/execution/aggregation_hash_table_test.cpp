@@ -1,5 +1,7 @@
 #include <atomic>
+#include <cstddef>
 #include <memory>
+#include <mutex>  // NOLINT
 #include <random>
 #include <unordered_map>
 #include <utility>
@@ -13,6 +15,7 @@
 #include "catalog/schema.h"
 #include "execution/exec/execution_context.h"
 #include "execution/sql/aggregation_hash_table.h"
+#include "execution/sql/aggregators.h"
 #include "execution/sql/projected_columns_iterator.h"
 #include "execution/sql/thread_state_container.h"
 #include "execution/util/hash.h"
@@ -293,6 +296,71 @@ TEST_F(AggregationHashTableTest, BatchProcessTest) {
   FreeProjectedColumns();
 }
 
+// NOLINTNEXTLINE
+TEST_F(AggregationHashTableTest, VectorizedBatchProcessTest) {
+  struct GroupTuple {
+    int32_t key_;
+    CountStarAggregate count_;
+    IntegerSumAggregate sum_;
+  };
+
+  // More groups than the table's initial size, so that it has to grow
+  const int32_t num_groups = 5000;
+
+  const auto init_group = [](void *group) {
+    auto *group_tuple = reinterpret_cast<GroupTuple *>(group);
+    new (&group_tuple->count_) CountStarAggregate();
+    new (&group_tuple->sum_) IntegerSumAggregate();
+  };
+
+  auto *projected_columns = MakeProjectedColumns();
+  auto *keys = reinterpret_cast<int32_t *>(projected_columns->ColumnStart(0));
+  auto *vals = reinterpret_cast<int32_t *>(projected_columns->ColumnStart(1));
+
+  AggregationHashTable agg_table(Memory(), sizeof(GroupTuple));
+  std::unordered_map<int32_t, std::pair<int64_t, int64_t>> ref_agg_table;
+  std::mt19937 generator;
+  std::uniform_int_distribution<int32_t> distribution(0, num_groups - 1);
+  alignas(common::Constants::CACHELINE_SIZE) byte *groups[common::Constants::K_DEFAULT_VECTOR_SIZE];
+
+  for (uint32_t run = 0; run < 20; run++) {
+    for (uint32_t idx = 0; idx < common::Constants::K_DEFAULT_VECTOR_SIZE; idx++) {
+      keys[idx] = distribution(generator);
+      vals[idx] = static_cast<int32_t>(idx);
+    }
+
+    // Every other vector is filtered down to the tuples with even values
+    ProjectedColumnsIterator pci(projected_columns);
+    if (run % 2 == 1) {
+      pci.RunFilter([&pci]() { return *pci.Get<int32_t, false>(1, nullptr) % 2 == 0; });
+    }
+    pci.ForEach([&]() {
+      auto &ref = ref_agg_table[*pci.Get<int32_t, false>(0, nullptr)];
+      ref.first++;
+      ref.second += *pci.Get<int32_t, false>(1, nullptr);
+    });
+
+    agg_table.LookupOrCreateGroups<int32_t>(&pci, 0, offsetof(GroupTuple, key_), init_group, groups);
+    CountStarAggregate::AdvanceBatch(pci.NumSelected(), groups, offsetof(GroupTuple, count_));
+    IntegerSumAggregate::AdvanceBatch(pci.NumSelected(), groups, offsetof(GroupTuple, sum_), vals,
+                                      pci.GetSelectionVector(), nullptr);
+  }
+
+  // Every group should be found exactly once with the right aggregates
+  uint32_t num_groups_found = 0;
+  for (AggregationHashTableIterator iter(agg_table); iter.HasNext(); iter.Next()) {
+    auto *group_tuple = reinterpret_cast<const GroupTuple *>(iter.GetCurrentAggregateRow());
+    auto ref_iter = ref_agg_table.find(group_tuple->key_);
+    ASSERT_NE(ref_agg_table.end(), ref_iter);
+    EXPECT_EQ(ref_iter->second.first, group_tuple->count_.GetCountResult().val_);
+    EXPECT_EQ(ref_iter->second.second, group_tuple->sum_.GetResultSum().val_);
+    num_groups_found++;
+  }
+  EXPECT_EQ(ref_agg_table.size(), num_groups_found);
+
+  FreeProjectedColumns();
+}
+
 // NOLINTNEXTLINE
 TEST_F(AggregationHashTableTest, OverflowPartitonIteratorTest) {
   struct Data {
@@ -465,4 +533,114 @@ TEST_F(AggregationHashTableTest, ParallelAggregationTest) {
   EXPECT_EQ(num_aggs, qstate.row_count_.load(std::memory_order_seq_cst));
 }
 
+// NOLINTNEXTLINE
+TEST_F(AggregationHashTableTest, ParallelAggregationWithSpillingTest) {
+  //
+  // The same aggregation as above, but with many more groups than the memory
+  // budget can hold. Overflow partitions get spilled to disk during the build,
+  // and the budget is small enough that spilled partitions have to be split
+  // again when they are read back.
+  //
+
+  const uint32_t num_aggs = 200000;
+  const uint32_t num_inserts_per_thread = 100000;
+  const uint32_t num_threads = 4;
+  exec_ctx_->GetMemoryPool()->SetMemoryBudget(8 * common::Constants::KB);
+
+  auto init_ht = [](void *ctx, void *aht) {
+    auto exec_ctx = reinterpret_cast<exec::ExecutionContext *>(ctx);
+    new (aht) AggregationHashTable(exec_ctx->GetMemoryPool(), sizeof(AggTuple));
+  };
+
+  auto destroy_ht = [](void *ctx, void *aht) {
+    reinterpret_cast<AggregationHashTable *>(aht)->~AggregationHashTable();
+  };
+
+  auto build_agg_table = [&](AggregationHashTable *agg_table, uint32_t thread_idx) {
+    std::mt19937 generator(thread_idx);
+    std::uniform_int_distribution<uint64_t> distribution(0, num_aggs - 1);
+
+    for (uint32_t idx = 0; idx < num_inserts_per_thread; idx++) {
+      InputTuple input(distribution(generator), 1);
+      auto *existing = reinterpret_cast<AggTuple *>(
+          agg_table->Lookup(input.Hash(), AggTupleKeyEq, reinterpret_cast<const void *>(&input)));
+      if (existing != nullptr) {
+        existing->Advance(input);
+      } else {
+        auto *new_agg = agg_table->InsertPartitioned(input.Hash());
+        new (new_agg) AggTuple(input);
+      }
+    }
+  };
+
+  auto merge = [](void *ctx, AggregationHashTable *table, AggregationOverflowPartitionIterator *iter) {
+    for (; iter->HasNext(); iter->Next()) {
+      auto *partial_agg = iter->GetPayloadAs<AggTuple>();
+      auto *existing = reinterpret_cast<AggTuple *>(table->Lookup(iter->GetHash(), AggAggKeyEq, partial_agg));
+      if (existing != nullptr) {
+        existing->Merge(*partial_agg);
+      } else {
+        auto *new_agg = table->Insert(iter->GetHash());
+        new (new_agg) AggTuple(*partial_agg);
+      }
+    }
+  };
+
+  struct QS {
+    std::mutex mutex_;
+    std::unordered_map<uint64_t, uint64_t> counts_;
+    bool duplicate_group_{false};
+  };
+
+  auto scan = [](void *query_state, void *thread_state, const AggregationHashTable *agg_table) {
+    auto *qs = reinterpret_cast<QS *>(query_state);
+    std::lock_guard<std::mutex> lock(qs->mutex_);
+    for (AggregationHashTableIterator iter(*agg_table); iter.HasNext(); iter.Next()) {
+      auto *agg = reinterpret_cast<const AggTuple *>(iter.GetCurrentAggregateRow());
+      qs->duplicate_group_ |= !qs->counts_.emplace(agg->key_, agg->count1_).second;
+    }
+  };
+
+  // The expected result
+  std::unordered_map<uint64_t, uint64_t> expected;
+  for (uint32_t thread_idx = 0; thread_idx < num_threads; thread_idx++) {
+    std::mt19937 generator(thread_idx);
+    std::uniform_int_distribution<uint64_t> distribution(0, num_aggs - 1);
+    for (uint32_t idx = 0; idx < num_inserts_per_thread; idx++) {
+      expected[distribution(generator)]++;
+    }
+  }
+
+  QS qstate;
+  ThreadStateContainer container(exec_ctx_->GetMemoryPool());
+
+  // Build thread-local tables
+  container.Reset(sizeof(AggregationHashTable), init_ht, destroy_ht, exec_ctx_.get());
+  tbb::task_scheduler_init sched;
+  tbb::parallel_for(0u, num_threads, [&](const uint32_t thread_idx) {
+    auto aht = container.AccessThreadStateOfCurrentThreadAs<AggregationHashTable>();
+    build_agg_table(aht, thread_idx);
+  });
+
+  // The thread-local tables should have spilled
+  std::vector<AggregationHashTable *> thread_tables;
+  container.CollectThreadLocalStateElementsAs(&thread_tables, 0);
+  uint64_t num_spills = 0;
+  for (auto *table : thread_tables) num_spills += table->GetStats()->num_spills_;
+  EXPECT_GT(num_spills, 0u);
+
+  AggregationHashTable main_table(exec_ctx_->GetMemoryPool(), sizeof(AggTuple));
+
+  // Move memory
+  main_table.TransferMemoryAndPartitions(&container, 0, merge);
+  container.Clear();
+
+  // Scan
+  main_table.ExecuteParallelPartitionedScan(&qstate, &container, scan);
+
+  // Check
+  EXPECT_FALSE(qstate.duplicate_group_);
+  EXPECT_EQ(expected, qstate.counts_);
+}
+
 }  // namespace terrier::execution::sql::test
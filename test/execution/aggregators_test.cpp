@@ -1,3 +1,6 @@
+#include <cstddef>
+#include <utility>
+
 #include "execution/tpl_test.h"
 
 #include "execution/sql/aggregators.h"
@@ -489,4 +492,72 @@ TEST_F(AggregatorsTest, Avg) {
   EXPECT_DOUBLE_EQ(0.0, avg1.GetResultAvg().val_);
 }
 
+// NOLINTNEXTLINE
+TEST_F(AggregatorsTest, AdvanceBatch) {
+  struct Group {
+    CountAggregate count_;
+    CountStarAggregate count_star_;
+    IntegerSumAggregate sum_;
+    RealSumAggregate real_sum_;
+    AvgAggregate avg_;
+  };
+
+  constexpr uint32_t num_vals = 100;
+  int32_t vals[num_vals];
+  byte *groups[num_vals];
+  auto *nulls = common::RawBitmap::Allocate(num_vals);
+
+  //
+  // Tuples alternate between two groups, and every third input is NULL. The
+  // batch results should match advancing the aggregates one tuple at a time.
+  //
+
+  Group group_1, group_2, ref_group_1, ref_group_2;
+  for (uint32_t i = 0; i < num_vals; i++) {
+    vals[i] = static_cast<int32_t>(i);
+    nulls->Set(i, i % 3 != 0);
+    groups[i] = reinterpret_cast<byte *>(i % 2 == 0 ? &group_1 : &group_2);
+
+    Group &ref_group = (i % 2 == 0 ? ref_group_1 : ref_group_2);
+    const Integer val = (i % 3 != 0 ? Integer(vals[i]) : Integer::Null());
+    ref_group.count_.Advance(val);
+    ref_group.count_star_.Advance(val);
+    ref_group.sum_.Advance(val);
+    ref_group.real_sum_.Advance(val.is_null_ ? Real::Null() : Real(static_cast<double>(vals[i])));
+    ref_group.avg_.Advance(val);
+  }
+
+  CountAggregate::AdvanceBatch(num_vals, groups, offsetof(Group, count_), nullptr, nulls);
+  CountStarAggregate::AdvanceBatch(num_vals, groups, offsetof(Group, count_star_));
+  IntegerSumAggregate::AdvanceBatch(num_vals, groups, offsetof(Group, sum_), vals, nullptr, nulls);
+  RealSumAggregate::AdvanceBatch(num_vals, groups, offsetof(Group, real_sum_), vals, nullptr, nulls);
+  AvgAggregate::AdvanceBatch(num_vals, groups, offsetof(Group, avg_), vals, nullptr, nulls);
+
+  const std::pair<Group *, Group *> checks[] = {{&group_1, &ref_group_1}, {&group_2, &ref_group_2}};
+  for (const auto &[group, ref_group] : checks) {
+    EXPECT_EQ(ref_group->count_.GetCountResult().val_, group->count_.GetCountResult().val_);
+    EXPECT_EQ(ref_group->count_star_.GetCountResult().val_, group->count_star_.GetCountResult().val_);
+    EXPECT_EQ(ref_group->sum_.GetResultSum().val_, group->sum_.GetResultSum().val_);
+    EXPECT_DOUBLE_EQ(ref_group->real_sum_.GetResultSum().val_, group->real_sum_.GetResultSum().val_);
+    EXPECT_DOUBLE_EQ(ref_group->avg_.GetResultAvg().val_, group->avg_.GetResultAvg().val_);
+  }
+
+  //
+  // Only the tuples at the positions in a selection vector, without NULLs
+  //
+
+  Group group_3;
+  const uint32_t sel[] = {1, 5, 42, 99};
+  for (uint32_t i = 0; i < 4; i++) {
+    groups[i] = reinterpret_cast<byte *>(&group_3);
+  }
+  CountAggregate::AdvanceBatch(4, groups, offsetof(Group, count_), sel, nullptr);
+  IntegerSumAggregate::AdvanceBatch(4, groups, offsetof(Group, sum_), vals, sel, nullptr);
+  EXPECT_EQ(4, group_3.count_.GetCountResult().val_);
+  EXPECT_FALSE(group_3.sum_.GetResultSum().is_null_);
+  EXPECT_EQ(1 + 5 + 42 + 99, group_3.sum_.GetResultSum().val_);
+
+  common::RawBitmap::Deallocate(nulls);
+}
+
 }  // namespace terrier::execution::sql::test
@@ -0,0 +1,134 @@
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "execution/tpl_test.h"
+
+// From test
+#include "execution/vm/module.h"
+#include "execution/vm/module_compiler.h"
+
+namespace terrier::execution::vm::test {
+
+class BytecodeOptimizerTest : public TplTest {
+ public:
+  // Compile the source into a bytecode module, with or without optimizing it
+  std::unique_ptr<BytecodeModule> Compile(const std::string &src, const bool optimize) {
+    auto *ast = compiler_.CompileToAst(src);
+    if (compiler_.HasErrors()) return nullptr;
+    return BytecodeGenerator::Compile(ast, nullptr, "test", optimize);
+  }
+
+  // Does the function with the given name use the given bytecode?
+  static bool Uses(const BytecodeModule &module, const std::string &name, const Bytecode bytecode) {
+    for (auto iter = module.BytecodeForFunction(*module.GetFuncInfoByName(name)); !iter.Done(); iter.Advance()) {
+      if (iter.CurrentBytecode() == bytecode) return true;
+    }
+    return false;
+  }
+
+ private:
+  ModuleCompiler compiler_;
+};
+
+// NOLINTNEXTLINE
+TEST_F(BytecodeOptimizerTest, LoopTest) {
+  auto src = R"(
+    fun sum(n: int32) -> int32 {
+      var s: int32 = 0
+      for (var i: int32 = 0; i < n; i = i + 1) {
+        s = s + i
+      }
+      return s
+    })";
+
+  auto unoptimized = Compile(src, false);
+  auto optimized = Compile(src, true);
+  ASSERT_TRUE(unoptimized != nullptr);
+  ASSERT_TRUE(optimized != nullptr);
+
+  // The comparison and the branch on it are fused, and the loop's test is rotated to its end
+  EXPECT_TRUE(Uses(*unoptimized, "sum", Bytecode::Jump));
+  EXPECT_TRUE(Uses(*unoptimized, "sum", Bytecode::LessThan_int32_t));
+  EXPECT_FALSE(Uses(*optimized, "sum", Bytecode::Jump));
+  EXPECT_FALSE(Uses(*optimized, "sum", Bytecode::LessThan_int32_t));
+  EXPECT_TRUE(Uses(*optimized, "sum", Bytecode::JumpIfLessThan_int32_t));
+
+  // Temporaries are removed or share slots
+  EXPECT_LT(optimized->GetFuncInfoByName("sum")->FrameSize(), unoptimized->GetFuncInfoByName("sum")->FrameSize());
+
+  Module unoptimized_module(std::move(unoptimized));
+  Module optimized_module(std::move(optimized));
+  std::function<int32_t(int32_t)> unoptimized_sum, optimized_sum;
+  EXPECT_TRUE(unoptimized_module.GetFunction("sum", ExecutionMode::Interpret, &unoptimized_sum));
+  EXPECT_TRUE(optimized_module.GetFunction("sum", ExecutionMode::Interpret, &optimized_sum));
+  for (int32_t n : {-1, 0, 1, 2, 10, 1000}) {
+    EXPECT_EQ(unoptimized_sum(n), optimized_sum(n));
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(BytecodeOptimizerTest, ShortCircuitTest) {
+  auto src = R"(
+    fun test(a: int32, b: int32, c: int32) -> int32 {
+      var r: int32 = 0
+      if ((a < b and b < c) or a == c) {
+        r = r + 1
+      }
+      if (a >= b or (b != c and a <= c)) {
+        r = r + 10
+      }
+      if (!(a > c)) {
+        r = r + 100
+      }
+      return r
+    })";
+
+  auto unoptimized = Compile(src, false);
+  auto optimized = Compile(src, true);
+  ASSERT_TRUE(unoptimized != nullptr);
+  ASSERT_TRUE(optimized != nullptr);
+  EXPECT_LT(optimized->InstructionCount(), unoptimized->InstructionCount());
+
+  Module unoptimized_module(std::move(unoptimized));
+  Module optimized_module(std::move(optimized));
+  std::function<int32_t(int32_t, int32_t, int32_t)> unoptimized_test, optimized_test;
+  EXPECT_TRUE(unoptimized_module.GetFunction("test", ExecutionMode::Interpret, &unoptimized_test));
+  EXPECT_TRUE(optimized_module.GetFunction("test", ExecutionMode::Interpret, &optimized_test));
+  for (int32_t a = 0; a < 3; a++) {
+    for (int32_t b = 0; b < 3; b++) {
+      for (int32_t c = 0; c < 3; c++) {
+        EXPECT_EQ(unoptimized_test(a, b, c), optimized_test(a, b, c)) << a << " " << b << " " << c;
+      }
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(BytecodeOptimizerTest, AddressTakenTest) {
+  // Locals whose address escapes must keep their own slot and all their writes
+  auto src = R"(
+    fun inc(p: *int32) -> nil {
+      *p = *p + 1
+    }
+    fun test(n: int32) -> int32 {
+      var x: int32 = n
+      var y: int32 = n * 2
+      inc(&x)
+      var z: int32 = x + y
+      inc(&z)
+      return z
+    })";
+
+  auto optimized = Compile(src, true);
+  ASSERT_TRUE(optimized != nullptr);
+
+  Module module(std::move(optimized));
+  std::function<int32_t(int32_t)> test;
+  EXPECT_TRUE(module.GetFunction("test", ExecutionMode::Interpret, &test));
+  EXPECT_EQ(3 * 5 + 2, test(5));
+  EXPECT_EQ(2, test(0));
+}
+
+}  // namespace terrier::execution::vm::test
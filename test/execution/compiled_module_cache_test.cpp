@@ -0,0 +1,191 @@
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "llvm/Support/FileSystem.h"
+
+#include "execution/tpl_test.h"
+
+#include "execution/vm/bytecode_module.h"
+#include "execution/vm/compiled_module_cache.h"
+#include "execution/vm/module_compiler.h"
+
+namespace terrier::execution::vm::test {
+
+class CompiledModuleCacheTest : public TplTest {
+ public:
+  // A module with a single function without locals, and the given bytecode and static data
+  static std::unique_ptr<BytecodeModule> MakeModule(const std::string &name, std::vector<uint8_t> code,
+                                                    std::vector<uint8_t> static_data = {}) {
+    std::vector<FunctionInfo> functions;
+    functions.emplace_back(0, "main", nullptr);
+    return std::make_unique<BytecodeModule>(name, std::move(code), std::move(static_data), std::move(functions));
+  }
+
+  // Object code of the given size, filled with the given byte
+  static std::unique_ptr<llvm::MemoryBuffer> MakeObjectCode(const std::size_t size, const char fill) {
+    return llvm::MemoryBuffer::getMemBufferCopy(std::string(size, fill));
+  }
+};
+
+// NOLINTNEXTLINE
+TEST_F(CompiledModuleCacheTest, FingerprintTest) {
+  LLVMEngine::CompilerOptions options;
+
+  // The name of a module doesn't matter, its code does
+  auto module = MakeModule("a", {1, 2, 3, 4});
+  EXPECT_EQ(CompiledModuleCache::Fingerprint(*module, options),
+            CompiledModuleCache::Fingerprint(*MakeModule("b", {1, 2, 3, 4}), options));
+  EXPECT_NE(CompiledModuleCache::Fingerprint(*module, options),
+            CompiledModuleCache::Fingerprint(*MakeModule("a", {1, 2, 3, 5}), options));
+  EXPECT_NE(CompiledModuleCache::Fingerprint(*module, options),
+            CompiledModuleCache::Fingerprint(*MakeModule("a", {1, 2, 3, 4}, {'a', 0}), options));
+
+  // So do the options it is compiled with
+  options.SetDebug(true);
+  EXPECT_NE(CompiledModuleCache::Fingerprint(*module, options),
+            CompiledModuleCache::Fingerprint(*module, LLVMEngine::CompilerOptions()));
+  EXPECT_NE(CompiledModuleCache::Fingerprint(*module, LLVMEngine::CompilerOptions()),
+            CompiledModuleCache::Fingerprint(
+                *module, LLVMEngine::CompilerOptions().SetOptimizationLevel(LLVMEngine::OptimizationLevel::Fast)));
+}
+
+// NOLINTNEXTLINE
+TEST_F(CompiledModuleCacheTest, StringLiteralTest) {
+  // A function comparing two copies of the same literal
+  const auto source = [](const std::string &literal) {
+    return "fun main() -> int64 {\n  var str = @stringToSql(\"" + literal + "\")\n  var copy = @stringToSql(\"" +
+           literal + "\")\n  if (str != copy) {\n    return 1\n  }\n  return 0\n}";
+  };
+
+  // The literals are copied into each module, not referred to by address, so both compilations have one fingerprint
+  ModuleCompiler first_compiler, second_compiler, other_compiler;
+  auto first = first_compiler.CompileToModule(source("literal"));
+  auto second = second_compiler.CompileToModule(source("literal"));
+  auto other = other_compiler.CompileToModule(source("lateral"));
+  ASSERT_NE(nullptr, first);
+  ASSERT_NE(nullptr, second);
+  ASSERT_NE(nullptr, other);
+
+  LLVMEngine::CompilerOptions options;
+  const auto fingerprint = CompiledModuleCache::Fingerprint(*first->GetBytecodeModule(), options);
+  EXPECT_EQ(fingerprint, CompiledModuleCache::Fingerprint(*second->GetBytecodeModule(), options));
+  EXPECT_NE(fingerprint, CompiledModuleCache::Fingerprint(*other->GetBytecodeModule(), options));
+
+  // So the code compiled for the first is found for the second
+  CompiledModuleCache cache;
+  EXPECT_EQ(nullptr, cache.Lookup(fingerprint));
+  cache.Insert(fingerprint, *MakeObjectCode(100, 'a'));
+  EXPECT_NE(nullptr, cache.Lookup(CompiledModuleCache::Fingerprint(*second->GetBytecodeModule(), options)));
+  EXPECT_EQ(1u, cache.NumHits());
+
+  // Equal literals share their static data, which the bytecode reads
+  EXPECT_EQ(std::strlen("literal") + 1, first->GetBytecodeModule()->StaticData().size());
+  std::function<int64_t()> main;
+  ASSERT_TRUE(second->GetFunction("main", ExecutionMode::Interpret, &main));
+  EXPECT_EQ(0, main());
+}
+
+// NOLINTNEXTLINE
+TEST_F(CompiledModuleCacheTest, LookupTest) {
+  CompiledModuleCache cache;
+
+  EXPECT_EQ(nullptr, cache.Lookup("a"));
+  EXPECT_EQ(1u, cache.NumMisses());
+
+  cache.Insert("a", *MakeObjectCode(100, 'a'));
+  cache.Insert("b", *MakeObjectCode(200, 'b'));
+  EXPECT_EQ(2u, cache.NumEntries());
+  EXPECT_EQ(302u, cache.MemoryUsage());
+
+  auto object_code = cache.Lookup("a");
+  ASSERT_NE(nullptr, object_code);
+  EXPECT_EQ(std::string(100, 'a'), object_code->getBuffer().str());
+  EXPECT_EQ(1u, cache.NumHits());
+
+  // Replacing an entry doesn't add one
+  cache.Insert("a", *MakeObjectCode(50, 'c'));
+  EXPECT_EQ(2u, cache.NumEntries());
+  EXPECT_EQ(252u, cache.MemoryUsage());
+  EXPECT_EQ(std::string(50, 'c'), cache.Lookup("a")->getBuffer().str());
+
+  cache.Clear();
+  EXPECT_EQ(0u, cache.NumEntries());
+  EXPECT_EQ(0u, cache.MemoryUsage());
+  EXPECT_EQ(nullptr, cache.Lookup("b"));
+  EXPECT_EQ(2u, cache.NumHits());
+  EXPECT_EQ(2u, cache.NumMisses());
+}
+
+// NOLINTNEXTLINE
+TEST_F(CompiledModuleCacheTest, EvictionTest) {
+  // Room for three entries of 100 bytes
+  CompiledModuleCache cache(3 * 101);
+  cache.Insert("a", *MakeObjectCode(100, 'a'));
+  cache.Insert("b", *MakeObjectCode(100, 'b'));
+  cache.Insert("c", *MakeObjectCode(100, 'c'));
+
+  // Using "a" makes "b" the least recently used entry
+  EXPECT_NE(nullptr, cache.Lookup("a"));
+  cache.Insert("d", *MakeObjectCode(100, 'd'));
+  EXPECT_EQ(3u, cache.NumEntries());
+  EXPECT_EQ(1u, cache.NumEvictions());
+  EXPECT_EQ(nullptr, cache.Lookup("b"));
+  EXPECT_NE(nullptr, cache.Lookup("a"));
+  EXPECT_NE(nullptr, cache.Lookup("c"));
+  EXPECT_NE(nullptr, cache.Lookup("d"));
+
+  // Code that never fits isn't kept, and doesn't evict anything
+  cache.Insert("e", *MakeObjectCode(1000, 'e'));
+  EXPECT_EQ(3u, cache.NumEntries());
+  EXPECT_EQ(1u, cache.NumEvictions());
+  EXPECT_EQ(nullptr, cache.Lookup("e"));
+}
+
+// NOLINTNEXTLINE
+TEST_F(CompiledModuleCacheTest, DiskTest) {
+  llvm::SmallString<128> dir;
+  ASSERT_FALSE(llvm::sys::fs::createUniqueDirectory("compiled-module-cache-test", dir));
+
+  {
+    CompiledModuleCache cache(CompiledModuleCache::K_DEFAULT_MAX_MEMORY, dir.str().str(), 2);
+    cache.Insert("a", *MakeObjectCode(100, 'a'));
+  }
+
+  // A new cache on the same directory finds the code on disk, then in memory
+  {
+    CompiledModuleCache cache(CompiledModuleCache::K_DEFAULT_MAX_MEMORY, dir.str().str(), 2);
+    auto object_code = cache.Lookup("a");
+    ASSERT_NE(nullptr, object_code);
+    EXPECT_EQ(std::string(100, 'a'), object_code->getBuffer().str());
+    EXPECT_EQ(1u, cache.NumDiskHits());
+    EXPECT_NE(nullptr, cache.Lookup("a"));
+    EXPECT_EQ(1u, cache.NumHits());
+    EXPECT_EQ(nullptr, cache.Lookup("b"));
+
+    // Only two files are kept
+    cache.Insert("b", *MakeObjectCode(100, 'b'));
+    cache.Insert("c", *MakeObjectCode(100, 'c'));
+    uint32_t num_files = 0;
+    std::error_code error;
+    for (llvm::sys::fs::directory_iterator iter(dir, error), end; iter != end && !error; iter.increment(error)) {
+      num_files++;
+    }
+    EXPECT_EQ(2u, num_files);
+
+    cache.Clear();
+  }
+
+  {
+    CompiledModuleCache cache(CompiledModuleCache::K_DEFAULT_MAX_MEMORY, dir.str().str(), 2);
+    EXPECT_EQ(nullptr, cache.Lookup("b"));
+    EXPECT_EQ(nullptr, cache.Lookup("c"));
+  }
+
+  llvm::sys::fs::remove_directories(dir);
+}
+
+}  // namespace terrier::execution::vm::test
@@ -0,0 +1,615 @@
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "execution/sql_test.h"
+
+#include "catalog/catalog_accessor.h"
+#include "execution/compiler/compiler.h"
+#include "execution/compiler/executable_query.h"
+#include "execution/sql/memory_tracker.h"
+#include "execution/sql/table_vector_iterator.h"
+#include "execution/sql/value.h"
+#include "optimizer/statistics/stats_storage.h"
+#include "parser/expression/aggregate_expression.h"
+#include "parser/expression/column_value_expression.h"
+#include "parser/expression/comparison_expression.h"
+#include "parser/expression/conjunction_expression.h"
+#include "parser/expression/constant_value_expression.h"
+#include "parser/expression/derived_value_expression.h"
+#include "parser/expression/operator_expression.h"
+#include "parser/expression/star_expression.h"
+#include "planner/plannodes/aggregate_plan_node.h"
+#include "planner/plannodes/hash_join_plan_node.h"
+#include "planner/plannodes/insert_plan_node.h"
+#include "planner/plannodes/limit_plan_node.h"
+#include "planner/plannodes/order_by_plan_node.h"
+#include "planner/plannodes/seq_scan_plan_node.h"
+#include "traffic_cop/traffic_cop.h"
+#include "type/transient_value_factory.h"
+
+namespace terrier::execution::compiler::test {
+
+class CompilerTest : public SqlBasedTest {
+ public:
+  using Expr = std::unique_ptr<parser::AbstractExpression>;
+  using Rows = std::vector<std::vector<int64_t>>;
+
+  void SetUp() override {
+    SqlBasedTest::SetUp();
+    auto exec_ctx = MakeExecCtx();
+    GenerateTestTables(exec_ctx.get());
+    auto *accessor = exec_ctx->GetAccessor();
+    table_oid_ = accessor->GetTableOid(NSOid(), "test_1");
+    const auto &schema = accessor->GetSchema(table_oid_);
+    col_a_ = schema.GetColumn("colA").Oid();
+    col_b_ = schema.GetColumn("colB").Oid();
+    col_c_ = schema.GetColumn("colC").Oid();
+
+    // colA is serial, but doesn't start at zero when the tables were generated before in this process
+    std::array<uint32_t, 1> col_oids{!col_a_};
+    sql::TableVectorIterator iter(exec_ctx.get(), !table_oid_, col_oids.data(), 1);
+    iter.Init();
+    ASSERT_TRUE(iter.Advance());
+    first_a_ = *iter.GetProjectedColumnsIterator()->Get<int32_t, false>(0, nullptr);
+  }
+
+  // Run a plan whose output columns are all integers, returning its rows. A nonzero memory budget makes the operators
+  // that can spill do so.
+  Rows Run(const planner::AbstractPlanNode &plan, const uint64_t memory_budget = 0) {
+    Rows rows;
+    const auto num_cols = plan.GetOutputSchema()->GetColumns().size();
+    exec::OutputCallback callback = [&](byte *tuples, uint32_t num_tuples, uint32_t tuple_size) {
+      for (uint32_t i = 0; i < num_tuples; i++) {
+        auto *vals = reinterpret_cast<sql::Integer *>(tuples + i * tuple_size);
+        rows.emplace_back();
+        for (uint32_t col = 0; col < num_cols; col++) {
+          rows.back().push_back(vals[col].val_);
+        }
+      }
+    };
+    auto exec_ctx = MakePlanExecCtx(std::move(callback), plan);
+    exec_ctx->GetMemoryPool()->SetMemoryBudget(memory_budget);
+    ExecutableQuery query(plan, exec_ctx.get());
+    EXPECT_TRUE(query.IsCompiled());
+    tpl_source_ = query.GetTplSource();
+    if (query.IsCompiled()) {
+      const auto num_rows = query.Run(exec_ctx.get(), vm::ExecutionMode::Interpret);
+      EXPECT_EQ(rows.size(), num_rows);
+    }
+    return rows;
+  }
+
+  // An execution context to compile and run a plan in, with the statistics the test added
+  std::unique_ptr<exec::ExecutionContext> MakePlanExecCtx(exec::OutputCallback &&callback,
+                                                          const planner::AbstractPlanNode &plan) {
+    auto exec_ctx = MakeExecCtx(std::move(callback), plan.GetOutputSchema().Get());
+    exec_ctx->SetStatsStorage(common::ManagedPointer<optimizer::StatsStorage>(&stats_storage_));
+    return exec_ctx;
+  }
+
+  // Give test_1 statistics with the given number of rows, and a histogram with the given bounds for colB
+  void AddColBStats(std::vector<double> histogram_bounds, const size_t num_rows = sql::TEST1_SIZE) {
+    std::vector<optimizer::ColumnStats> column_stats;
+    column_stats.emplace_back(DBOid(), table_oid_, col_b_, num_rows, 10, 0, std::vector<double>{},
+                              std::vector<double>{}, std::move(histogram_bounds), true);
+    stats_storage_.DeleteTableStats(DBOid(), table_oid_);
+    stats_storage_.InsertTableStats(DBOid(), table_oid_,
+                                    optimizer::TableStats(DBOid(), table_oid_, num_rows, true, column_stats));
+  }
+
+  // SELECT colB, COUNT(*), SUM(colA) FROM test_1 GROUP BY colB HAVING COUNT(*) > 0
+  std::unique_ptr<planner::AbstractPlanNode> GroupByColB() {
+    auto having = Own(Cmp(parser::ExpressionType::COMPARE_GREATER_THAN,
+                          std::make_unique<parser::DerivedValueExpression>(type::TypeId::INTEGER, 1, 0), Int(0)));
+    planner::AggregatePlanNode::Builder builder;
+    return builder.SetOutputSchema(IntSchema({col_b_, catalog::col_oid_t(100), catalog::col_oid_t(101)}))
+        .AddChild(Scan({col_a_, col_b_}, nullptr))
+        .SetAggregateStrategyType(planner::AggregateStrategyType::HASH)
+        .AddGroupByTerm(Own(Col(col_b_)))
+        .AddAggregateTerm(CountStar())
+        .AddAggregateTerm(Agg(parser::ExpressionType::AGGREGATE_SUM, Col(col_a_)))
+        .SetHavingClausePredicate(having)
+        .Build();
+  }
+
+  // Check the result of GroupByColB()
+  void CheckGroupByColB(const Rows &rows) {
+    EXPECT_EQ(10, rows.size());
+    std::vector<bool> seen(10, false);
+    int64_t count = 0, sum = 0;
+    for (const auto &row : rows) {
+      ASSERT_GE(row[0], 0);
+      ASSERT_LE(row[0], 9);
+      EXPECT_FALSE(seen[row[0]]);
+      seen[row[0]] = true;
+      count += row[1];
+      sum += row[2];
+    }
+    EXPECT_EQ(sql::TEST1_SIZE, count);
+    EXPECT_EQ(int64_t{first_a_} * sql::TEST1_SIZE + int64_t{sql::TEST1_SIZE - 1} * sql::TEST1_SIZE / 2, sum);
+  }
+
+  // An output schema of integer columns with the given oids
+  static std::unique_ptr<planner::OutputSchema> IntSchema(const std::vector<catalog::col_oid_t> &oids) {
+    std::vector<planner::OutputSchema::Column> columns;
+    for (const auto oid : oids) {
+      columns.emplace_back("col" + std::to_string(!oid), type::TypeId::INTEGER, false, oid);
+    }
+    return std::make_unique<planner::OutputSchema>(std::move(columns));
+  }
+
+  // A sequential scan of test_1 reading the given columns
+  std::unique_ptr<planner::AbstractPlanNode> Scan(const std::vector<catalog::col_oid_t> &oids,
+                                                  common::ManagedPointer<parser::AbstractExpression> predicate) {
+    planner::SeqScanPlanNode::Builder builder;
+    return builder.SetOutputSchema(IntSchema(oids)).SetTableOid(table_oid_).SetScanPredicate(predicate).Build();
+  }
+
+  Expr Col(catalog::col_oid_t oid) {
+    return std::make_unique<parser::ColumnValueExpression>(catalog::INVALID_DATABASE_OID, table_oid_, oid);
+  }
+
+  static Expr Int(int32_t val) {
+    return std::make_unique<parser::ConstantValueExpression>(type::TransientValueFactory::GetInteger(val));
+  }
+
+  static Expr Cmp(parser::ExpressionType type, Expr left, Expr right) {
+    return std::make_unique<parser::ComparisonExpression>(type, Children(std::move(left), std::move(right)));
+  }
+
+  static Expr And(Expr left, Expr right) {
+    return std::make_unique<parser::ConjunctionExpression>(parser::ExpressionType::CONJUNCTION_AND,
+                                                           Children(std::move(left), std::move(right)));
+  }
+
+  static Expr Op(parser::ExpressionType type, Expr left, Expr right) {
+    return std::make_unique<parser::OperatorExpression>(type, type::TypeId::INTEGER,
+                                                        Children(std::move(left), std::move(right)));
+  }
+
+  // An aggregate term owned by the test
+  common::ManagedPointer<parser::AggregateExpression> Agg(parser::ExpressionType type, Expr child) {
+    std::vector<Expr> children;
+    children.push_back(std::move(child));
+    return Own(std::make_unique<parser::AggregateExpression>(type, std::move(children), false))
+        .CastManagedPointerTo<parser::AggregateExpression>();
+  }
+
+  common::ManagedPointer<parser::AggregateExpression> CountStar() {
+    return Agg(parser::ExpressionType::AGGREGATE_COUNT, std::make_unique<parser::StarExpression>());
+  }
+
+  // Keep an expression alive as long as the test
+  common::ManagedPointer<parser::AbstractExpression> Own(Expr expr) {
+    exprs_.push_back(std::move(expr));
+    return common::ManagedPointer(exprs_.back());
+  }
+
+ protected:
+  catalog::table_oid_t table_oid_;
+  catalog::col_oid_t col_a_, col_b_, col_c_;
+  // The smallest value of colA, first in the queries below
+  int32_t first_a_;
+  // The TPL program of the last plan run
+  std::string tpl_source_;
+
+ private:
+  // Makes the protected insertion of statistics public
+  class TestStatsStorage : public optimizer::StatsStorage {
+   public:
+    using StatsStorage::DeleteTableStats;
+    using StatsStorage::InsertTableStats;
+  };
+
+  static std::vector<Expr> Children(Expr left, Expr right) {
+    std::vector<Expr> children;
+    children.push_back(std::move(left));
+    children.push_back(std::move(right));
+    return children;
+  }
+
+  std::vector<Expr> exprs_;
+  TestStatsStorage stats_storage_;
+};
+
+// NOLINTNEXTLINE
+TEST_F(CompilerTest, SeqScanTest) {
+  // SELECT colA, colB FROM test_1 WHERE colA < first + 500 AND colA % 2 = first % 2
+  auto predicate =
+      Own(And(Cmp(parser::ExpressionType::COMPARE_LESS_THAN, Col(col_a_), Int(first_a_ + 500)),
+              Cmp(parser::ExpressionType::COMPARE_EQUAL, Op(parser::ExpressionType::OPERATOR_MOD, Col(col_a_), Int(2)),
+                  Int(first_a_ % 2))));
+  auto scan = Scan({col_a_, col_b_}, predicate);
+
+  auto rows = Run(*scan);
+  EXPECT_EQ(250, rows.size());
+  for (const auto &row : rows) {
+    EXPECT_LT(row[0], first_a_ + 500);
+    EXPECT_EQ(first_a_ % 2, row[0] % 2);
+    EXPECT_GE(row[1], 0);
+    EXPECT_LE(row[1], 9);
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(CompilerTest, PlainAggregateTest) {
+  // SELECT COUNT(*), MIN(colA), MAX(colA), SUM(colA) FROM test_1 WHERE colA >= first + 100
+  auto predicate = Own(Cmp(parser::ExpressionType::COMPARE_GREATER_THAN_OR_EQUAL_TO, Col(col_a_), Int(first_a_ + 100)));
+  planner::AggregatePlanNode::Builder builder;
+  auto agg = builder.SetOutputSchema(IntSchema({catalog::col_oid_t(100), catalog::col_oid_t(101),
+                                                catalog::col_oid_t(102), catalog::col_oid_t(103)}))
+                 .AddChild(Scan({col_a_}, predicate))
+                 .SetAggregateStrategyType(planner::AggregateStrategyType::PLAIN)
+                 .AddAggregateTerm(CountStar())
+                 .AddAggregateTerm(Agg(parser::ExpressionType::AGGREGATE_MIN, Col(col_a_)))
+                 .AddAggregateTerm(Agg(parser::ExpressionType::AGGREGATE_MAX, Col(col_a_)))
+                 .AddAggregateTerm(Agg(parser::ExpressionType::AGGREGATE_SUM, Col(col_a_)))
+                 .Build();
+
+  auto rows = Run(*agg);
+  ASSERT_EQ(1, rows.size());
+  EXPECT_EQ(sql::TEST1_SIZE - 100, rows[0][0]);
+  EXPECT_EQ(first_a_ + 100, rows[0][1]);
+  EXPECT_EQ(first_a_ + sql::TEST1_SIZE - 1, rows[0][2]);
+  const int64_t sum = int64_t{sql::TEST1_SIZE - 1} * sql::TEST1_SIZE / 2 - 99 * 100 / 2;
+  EXPECT_EQ(int64_t{first_a_} * (sql::TEST1_SIZE - 100) + sum, rows[0][3]);
+}
+
+// NOLINTNEXTLINE
+TEST_F(CompilerTest, HashAggregateTest) {
+  // Without statistics, the groups are kept in a hash table
+  auto agg = GroupByColB();
+  CheckGroupByColB(Run(*agg));
+  EXPECT_EQ(std::string::npos, tpl_source_.find("@dmAggTableInit("));
+}
+
+// NOLINTNEXTLINE
+TEST_F(CompilerTest, DirectMappedAggregateTest) {
+  // colB is in [0, 9], so its groups are kept in a direct-mapped table
+  AddColBStats({0, 1, 2, 3, 4, 5, 6, 7, 8, 9});
+  auto agg = GroupByColB();
+  CheckGroupByColB(Run(*agg));
+  EXPECT_NE(std::string::npos, tpl_source_.find("@dmAggTableInit("));
+}
+
+// NOLINTNEXTLINE
+TEST_F(CompilerTest, DirectMappedAggregateStaleStatsTest) {
+  // Statistics missing the keys above 4 still give the right groups, the others going to the hash table
+  AddColBStats({0, 2, 4});
+  auto agg = GroupByColB();
+  CheckGroupByColB(Run(*agg));
+  EXPECT_NE(std::string::npos, tpl_source_.find("@dmAggTableInit("));
+}
+
+// NOLINTNEXTLINE
+TEST_F(CompilerTest, LargeDomainAggregateTest) {
+  // A domain too large to map directly keeps the groups in a hash table
+  AddColBStats({0, 1e6});
+  auto agg = GroupByColB();
+  CheckGroupByColB(Run(*agg));
+  EXPECT_EQ(std::string::npos, tpl_source_.find("@dmAggTableInit("));
+}
+
+// NOLINTNEXTLINE
+TEST_F(CompilerTest, EstimatedCardinalityTest) {
+  // SELECT colA, colB FROM test_1 WHERE colA < first + 10
+  auto predicate = Own(Cmp(parser::ExpressionType::COMPARE_LESS_THAN, Col(col_a_), Int(first_a_ + 10)));
+  auto scan = Scan({col_a_, col_b_}, predicate);
+
+  // Without statistics, the module has no estimate
+  {
+    auto exec_ctx = MakePlanExecCtx(nullptr, *scan);
+    ExecutableQuery query(*scan, exec_ctx.get());
+    ASSERT_TRUE(query.IsCompiled());
+    EXPECT_EQ(vm::LLVMEngine::K_UNKNOWN_CARDINALITY, query.GetModule()->GetEstimatedCardinality());
+  }
+
+  // A small table isn't worth optimizing the query for, a large one is
+  const std::array<std::pair<size_t, vm::LLVMEngine::OptimizationLevel>, 2> cases{
+      {{10, vm::LLVMEngine::OptimizationLevel::Fast}, {1000000000, vm::LLVMEngine::OptimizationLevel::Full}}};
+  for (const auto &[num_rows, level] : cases) {
+    AddColBStats({0, 9}, num_rows);
+    auto exec_ctx = MakePlanExecCtx(nullptr, *scan);
+    ExecutableQuery query(*scan, exec_ctx.get());
+    ASSERT_TRUE(query.IsCompiled());
+    const auto *module = query.GetModule();
+    EXPECT_EQ(num_rows, module->GetEstimatedCardinality());
+    EXPECT_EQ(level, vm::LLVMEngine::ChooseOptimizationLevel(*module->GetBytecodeModule(),
+                                                             module->GetEstimatedCardinality()));
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(CompilerTest, OrderByTest) {
+  // SELECT colA, colB FROM test_1 WHERE colA < first + 1000 ORDER BY colB DESC, colA LIMIT 100 OFFSET 10
+  auto predicate = Own(Cmp(parser::ExpressionType::COMPARE_LESS_THAN, Col(col_a_), Int(first_a_ + 1000)));
+  planner::OrderByPlanNode::Builder builder;
+  auto order_by = builder.SetOutputSchema(IntSchema({col_a_, col_b_}))
+                      .AddChild(Scan({col_a_, col_b_}, predicate))
+                      .AddSortKey(col_b_, optimizer::OrderByOrderingType::DESC)
+                      .AddSortKey(col_a_, optimizer::OrderByOrderingType::ASC)
+                      .SetLimit(100)
+                      .SetOffset(10)
+                      .Build();
+
+  auto rows = Run(*order_by);
+  ASSERT_EQ(100, rows.size());
+  for (uint32_t i = 1; i < rows.size(); i++) {
+    EXPECT_TRUE(rows[i - 1][1] > rows[i][1] || (rows[i - 1][1] == rows[i][1] && rows[i - 1][0] < rows[i][0]));
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(CompilerTest, TopKTest) {
+  // SELECT colA FROM test_1 ORDER BY colA DESC LIMIT 20 OFFSET 5
+  planner::OrderByPlanNode::Builder builder;
+  auto order_by = builder.SetOutputSchema(IntSchema({col_a_}))
+                      .AddChild(Scan({col_a_}, nullptr))
+                      .AddSortKey(col_a_, optimizer::OrderByOrderingType::DESC)
+                      .SetLimit(20)
+                      .SetOffset(5)
+                      .Build();
+
+  // The sorter keeps the top 25 rows, and the scan skips the rows below the 25th largest key it has seen
+  auto exec_ctx = MakeExecCtx();
+  ExecutableQuery query(*order_by, exec_ctx.get());
+  const auto &src = query.GetTplSource();
+  EXPECT_NE(std::string::npos, src.find("@sorterInsertTopK("));
+  EXPECT_NE(std::string::npos, src.find("@tableIterSetTopKThreshold("));
+  EXPECT_NE(std::string::npos, src.find("@pciHasNextFiltered("));
+
+  auto rows = Run(*order_by);
+  ASSERT_EQ(20, rows.size());
+  for (uint32_t i = 0; i < rows.size(); i++) {
+    EXPECT_EQ(first_a_ + sql::TEST1_SIZE - 1 - 5 - i, rows[i][0]);
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(CompilerTest, HashJoinTest) {
+  // SELECT t1.colA, t2.colA, t2.colC FROM test_1 AS t1, test_1 AS t2
+  // WHERE t1.colA = t2.colA AND t1.colA < first + 100 AND t2.colA < first + 200
+  auto left_predicate = Own(Cmp(parser::ExpressionType::COMPARE_LESS_THAN, Col(col_a_), Int(first_a_ + 100)));
+  auto right_predicate = Own(Cmp(parser::ExpressionType::COMPARE_LESS_THAN, Col(col_a_), Int(first_a_ + 200)));
+  std::vector<planner::OutputSchema::DirectMap> direct_maps = {{0, {0, 0}}, {1, {1, 0}}, {2, {1, 1}}};
+  std::vector<planner::OutputSchema::Column> columns;
+  for (uint32_t i = 0; i < 3; i++) {
+    columns.emplace_back("col" + std::to_string(i), type::TypeId::INTEGER, false, catalog::col_oid_t(100 + i));
+  }
+  planner::HashJoinPlanNode::Builder builder;
+  auto join = builder
+                  .SetOutputSchema(std::make_unique<planner::OutputSchema>(
+                      std::move(columns), std::vector<planner::OutputSchema::DerivedTarget>(), std::move(direct_maps)))
+                  .AddChild(Scan({col_a_}, left_predicate))
+                  .AddChild(Scan({col_a_, col_c_}, right_predicate))
+                  .SetJoinType(planner::LogicalJoinType::INNER)
+                  .AddLeftHashKey(Own(Col(col_a_)))
+                  .AddRightHashKey(Own(Col(col_a_)))
+                  .Build();
+
+  auto rows = Run(*join);
+  EXPECT_EQ(100, rows.size());
+  for (const auto &row : rows) {
+    EXPECT_LT(row[0], first_a_ + 100);
+    EXPECT_EQ(row[0], row[1]);
+    EXPECT_LE(row[2], 9999);
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(CompilerTest, RuntimeFilterHashJoinTest) {
+  // SELECT t1.colA, t2.colA FROM test_1 AS t1, test_1 AS t2 WHERE t1.colA = t2.colA AND t2.colA < first + 100
+  auto right_predicate = Own(Cmp(parser::ExpressionType::COMPARE_LESS_THAN, Col(col_a_), Int(first_a_ + 100)));
+  std::vector<planner::OutputSchema::DirectMap> direct_maps = {{0, {0, 0}}, {1, {1, 0}}};
+  std::vector<planner::OutputSchema::Column> columns;
+  for (uint32_t i = 0; i < 2; i++) {
+    columns.emplace_back("col" + std::to_string(i), type::TypeId::INTEGER, false, catalog::col_oid_t(100 + i));
+  }
+  planner::HashJoinPlanNode::Builder builder;
+  auto join = builder
+                  .SetOutputSchema(std::make_unique<planner::OutputSchema>(
+                      std::move(columns), std::vector<planner::OutputSchema::DerivedTarget>(), std::move(direct_maps)))
+                  .AddChild(Scan({col_a_}, nullptr))
+                  .AddChild(Scan({col_a_}, right_predicate))
+                  .SetJoinType(planner::LogicalJoinType::INNER)
+                  .AddLeftHashKey(Own(Col(col_a_)))
+                  .AddRightHashKey(Own(Col(col_a_)))
+                  .Build();
+
+  // The probe side's scan is filtered by a Bloom filter over the build keys, which the build pipeline builds once the
+  // table is built
+  auto exec_ctx = MakeExecCtx();
+  ExecutableQuery query(*join, exec_ctx.get());
+  const auto &src = query.GetTplSource();
+  EXPECT_NE(std::string::npos, src.find("@tableIterAddRuntimeFilter("));
+  ASSERT_NE(std::string::npos, src.find("@joinHTBuildBloomFilter("));
+  EXPECT_LT(src.find("@joinHTBuild("), src.find("@joinHTBuildBloomFilter("));
+
+  auto rows = Run(*join);
+  ASSERT_EQ(100, rows.size());
+  std::sort(rows.begin(), rows.end());
+  for (uint32_t i = 0; i < rows.size(); i++) {
+    EXPECT_EQ(first_a_ + i, rows[i][0]);
+    EXPECT_EQ(rows[i][0], rows[i][1]);
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(CompilerTest, SpillingHashJoinTest) {
+  // SELECT t1.colA, t2.colA, t2.colC FROM test_1 AS t1, test_1 AS t2 WHERE t1.colA = t2.colA
+  // The build side doesn't fit in the budget, so most probe rows are joined from disk.
+  std::vector<planner::OutputSchema::DirectMap> direct_maps = {{0, {0, 0}}, {1, {1, 0}}, {2, {1, 1}}};
+  std::vector<planner::OutputSchema::Column> columns;
+  for (uint32_t i = 0; i < 3; i++) {
+    columns.emplace_back("col" + std::to_string(i), type::TypeId::INTEGER, false, catalog::col_oid_t(100 + i));
+  }
+  planner::HashJoinPlanNode::Builder builder;
+  auto join = builder
+                  .SetOutputSchema(std::make_unique<planner::OutputSchema>(
+                      std::move(columns), std::vector<planner::OutputSchema::DerivedTarget>(), std::move(direct_maps)))
+                  .AddChild(Scan({col_a_}, nullptr))
+                  .AddChild(Scan({col_a_, col_c_}, nullptr))
+                  .SetJoinType(planner::LogicalJoinType::INNER)
+                  .AddLeftHashKey(Own(Col(col_a_)))
+                  .AddRightHashKey(Own(Col(col_a_)))
+                  .Build();
+
+  const auto expected = Run(*join);
+  ASSERT_FALSE(expected.empty());
+  auto rows = Run(*join, 16 * common::Constants::KB);
+  ASSERT_EQ(expected.size(), rows.size());
+  std::sort(rows.begin(), rows.end());
+  auto sorted = expected;
+  std::sort(sorted.begin(), sorted.end());
+  EXPECT_EQ(sorted, rows);
+  for (const auto &row : rows) {
+    EXPECT_EQ(row[0], row[1]);
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(CompilerTest, MemoryLimitTest) {
+  // SELECT colA, COUNT(*) FROM test_1 GROUP BY colA
+  // A group per row doesn't fit in the limit, so the query fails, but without leaving its hash table behind.
+  planner::AggregatePlanNode::Builder builder;
+  auto agg = builder.SetOutputSchema(IntSchema({col_a_, catalog::col_oid_t(100)}))
+                 .AddChild(Scan({col_a_}, nullptr))
+                 .SetAggregateStrategyType(planner::AggregateStrategyType::HASH)
+                 .AddGroupByTerm(Own(Col(col_a_)))
+                 .AddAggregateTerm(CountStar())
+                 .Build();
+  uint64_t num_output = 0;
+  auto exec_ctx = MakePlanExecCtx([&](byte *, uint32_t num_tuples, uint32_t) { num_output += num_tuples; }, *agg);
+  ExecutableQuery query(*agg, exec_ctx.get());
+  ASSERT_TRUE(query.IsCompiled());
+
+  // The limit is checked as the threads publish their allocations, every K_FLUSH_BYTES
+  auto *const tracker = exec_ctx->GetMemoryTracker();
+  const auto allocated = tracker->GetAllocatedSize();
+  exec_ctx->SetMemoryLimit(allocated + sql::MemoryTracker::K_FLUSH_BYTES);
+  EXPECT_THROW(query.Run(exec_ctx.get(), vm::ExecutionMode::Interpret), std::runtime_error);
+  EXPECT_EQ(allocated, tracker->GetAllocatedSize());
+  EXPECT_EQ(0, num_output);
+
+  // Without the limit, the same query runs to the end, and frees what it allocated too
+  exec_ctx->SetMemoryLimit(0);
+  EXPECT_EQ(sql::TEST1_SIZE, query.Run(exec_ctx.get(), vm::ExecutionMode::Interpret));
+  EXPECT_EQ(allocated, tracker->GetAllocatedSize());
+}
+
+// NOLINTNEXTLINE
+TEST_F(CompilerTest, PipelineDependencyTest) {
+  // SELECT t1.colA, t2.colA, t3.colA FROM test_1 AS t1, (SELECT t2.colA, t3.colA FROM test_1 AS t2, test_1 AS t3
+  // WHERE t2.colA = t3.colA) WHERE t1.colA = t2.colA AND t1.colA < first + 100
+  std::vector<planner::OutputSchema::Column> inner_columns;
+  for (uint32_t i = 0; i < 2; i++) {
+    inner_columns.emplace_back("col" + std::to_string(i), type::TypeId::INTEGER, false, catalog::col_oid_t(100 + i));
+  }
+  std::vector<planner::OutputSchema::DirectMap> inner_maps = {{0, {0, 0}}, {1, {1, 0}}};
+  planner::HashJoinPlanNode::Builder inner_builder;
+  auto inner = inner_builder
+                   .SetOutputSchema(std::make_unique<planner::OutputSchema>(
+                       std::move(inner_columns), std::vector<planner::OutputSchema::DerivedTarget>(),
+                       std::move(inner_maps)))
+                   .AddChild(Scan({col_a_}, nullptr))
+                   .AddChild(Scan({col_a_}, nullptr))
+                   .SetJoinType(planner::LogicalJoinType::INNER)
+                   .AddLeftHashKey(Own(Col(col_a_)))
+                   .AddRightHashKey(Own(Col(col_a_)))
+                   .Build();
+
+  auto left_predicate = Own(Cmp(parser::ExpressionType::COMPARE_LESS_THAN, Col(col_a_), Int(first_a_ + 100)));
+  std::vector<planner::OutputSchema::Column> columns;
+  for (uint32_t i = 0; i < 3; i++) {
+    columns.emplace_back("col" + std::to_string(i), type::TypeId::INTEGER, false, catalog::col_oid_t(200 + i));
+  }
+  std::vector<planner::OutputSchema::DirectMap> direct_maps = {{0, {0, 0}}, {1, {1, 0}}, {2, {1, 1}}};
+  planner::HashJoinPlanNode::Builder builder;
+  auto join = builder
+                  .SetOutputSchema(std::make_unique<planner::OutputSchema>(
+                      std::move(columns), std::vector<planner::OutputSchema::DerivedTarget>(), std::move(direct_maps)))
+                  .AddChild(Scan({col_a_}, left_predicate))
+                  .AddChild(std::move(inner))
+                  .SetJoinType(planner::LogicalJoinType::INNER)
+                  .AddLeftHashKey(Own(Col(col_a_)))
+                  .AddRightHashKey(Own(Col(catalog::col_oid_t(100))))
+                  .Build();
+
+  // The build sides of both joins don't depend on each other, only the pipeline probing both depends on them
+  auto exec_ctx = MakeExecCtx();
+  Compiler compiler(*join, exec_ctx->GetAccessor());
+  ASSERT_FALSE(compiler.Compile().empty());
+  const auto &pipelines = compiler.GetPipelines();
+  ASSERT_EQ(3, pipelines.size());
+  EXPECT_TRUE(pipelines[0].dependencies_.empty());
+  EXPECT_TRUE(pipelines[1].dependencies_.empty());
+  EXPECT_EQ((std::vector<uint32_t>{0, 1}), pipelines[2].dependencies_);
+
+  auto rows = Run(*join);
+  ASSERT_EQ(100, rows.size());
+  for (const auto &row : rows) {
+    EXPECT_LT(row[0], first_a_ + 100);
+    EXPECT_EQ(row[0], row[1]);
+    EXPECT_EQ(row[1], row[2]);
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(CompilerTest, LimitTest) {
+  // SELECT colA FROM test_1 WHERE colA >= first + 20 LIMIT 5 OFFSET 3
+  auto predicate = Own(Cmp(parser::ExpressionType::COMPARE_GREATER_THAN_OR_EQUAL_TO, Col(col_a_), Int(first_a_ + 20)));
+  planner::LimitPlanNode::Builder builder;
+  auto limit =
+      builder.SetOutputSchema(IntSchema({col_a_})).AddChild(Scan({col_a_}, predicate)).SetLimit(5).SetOffset(3).Build();
+
+  // The scan stops once the limit has its 8 rows
+  auto exec_ctx = MakeExecCtx();
+  ExecutableQuery query(*limit, exec_ctx.get());
+  const auto &src = query.GetTplSource();
+  EXPECT_NE(std::string::npos, src.find(" < 8 and @tableIterAdvance("));
+  EXPECT_NE(std::string::npos, src.find(" < 8 and @pciHasNext"));
+
+  auto rows = Run(*limit);
+  ASSERT_EQ(5, rows.size());
+  for (const auto &row : rows) {
+    EXPECT_GE(row[0], first_a_ + 20);
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(CompilerTest, UnsupportedTest) {
+  // NULL constants aren't supported, the plan must be run by the SqliteEngine
+  auto predicate = Own(Cmp(parser::ExpressionType::COMPARE_LESS_THAN, Col(col_a_),
+                           std::make_unique<parser::ConstantValueExpression>(
+                               type::TransientValueFactory::GetNull(type::TypeId::INTEGER))));
+  auto scan = Scan({col_a_}, predicate);
+
+  auto exec_ctx = MakeExecCtx(nullptr, scan->GetOutputSchema().Get());
+  ExecutableQuery query(*scan, exec_ctx.get());
+  EXPECT_FALSE(query.IsCompiled());
+  EXPECT_TRUE(query.GetTplSource().empty());
+
+  trafficcop::TrafficCop tcop;
+  EXPECT_FALSE(tcop.ExecutePlan(*scan, exec_ctx.get(), vm::ExecutionMode::Interpret));
+
+  // Neither are inserts
+  std::vector<type::TransientValue> values;
+  values.emplace_back(type::TransientValueFactory::GetInteger(0));
+  planner::InsertPlanNode::Builder builder;
+  auto insert = builder.SetDatabaseOid(DBOid())
+                    .SetNamespaceOid(NSOid())
+                    .SetTableOid(table_oid_)
+                    .AddValues(std::move(values))
+                    .AddParameterInfo(col_a_)
+                    .Build();
+  Compiler compiler(*insert, exec_ctx->GetAccessor(), DBOid());
+  EXPECT_TRUE(compiler.Compile().empty());
+  EXPECT_NE(std::string::npos, compiler.GetUnsupportedReason().find("modifying"));
+}
+
+}  // namespace terrier::execution::compiler::test
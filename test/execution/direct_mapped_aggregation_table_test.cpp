@@ -0,0 +1,222 @@
+#include <cstddef>
+#include <limits>
+#include <random>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "execution/tpl_test.h"
+
+#include <tbb/tbb.h>  // NOLINT
+
+#include "execution/sql/aggregators.h"
+#include "execution/sql/direct_mapped_aggregation_table.h"
+#include "execution/sql/projected_columns_iterator.h"
+#include "execution/sql/thread_state_container.h"
+#include "storage/projected_columns.h"
+
+namespace terrier::execution::sql::test {
+
+/**
+ * The payload of a group
+ */
+struct GroupTuple {
+  int64_t key_;
+  CountStarAggregate count_;
+  IntegerSumAggregate sum_;
+};
+
+static void InitGroup(void *group) {
+  auto *group_tuple = reinterpret_cast<GroupTuple *>(group);
+  new (&group_tuple->count_) CountStarAggregate();
+  new (&group_tuple->sum_) IntegerSumAggregate();
+}
+
+static void MergeGroup(void *group, const void *partial_group) {
+  auto *group_tuple = reinterpret_cast<GroupTuple *>(group);
+  auto *partial_group_tuple = reinterpret_cast<const GroupTuple *>(partial_group);
+  group_tuple->count_.Merge(partial_group_tuple->count_);
+  group_tuple->sum_.Merge(partial_group_tuple->sum_);
+}
+
+class DirectMappedAggregationTableTest : public TplTest {
+ public:
+  DirectMappedAggregationTableTest() : memory_(nullptr) {}
+
+  MemoryPool *Memory() { return &memory_; }
+
+ private:
+  MemoryPool memory_;
+};
+
+// NOLINTNEXTLINE
+TEST_F(DirectMappedAggregationTableTest, DomainSizeTest) {
+  EXPECT_TRUE(DirectMappedAggregationTable::IsDomainSmallEnough(1, 10));
+  EXPECT_TRUE(DirectMappedAggregationTable::IsDomainSmallEnough(-5, -5));
+  EXPECT_TRUE(DirectMappedAggregationTable::IsDomainSmallEnough(
+      0, static_cast<int64_t>(DirectMappedAggregationTable::K_MAX_DOMAIN_SIZE) - 1));
+  EXPECT_FALSE(DirectMappedAggregationTable::IsDomainSmallEnough(
+      0, static_cast<int64_t>(DirectMappedAggregationTable::K_MAX_DOMAIN_SIZE)));
+  EXPECT_FALSE(DirectMappedAggregationTable::IsDomainSmallEnough(10, 1));
+  EXPECT_FALSE(DirectMappedAggregationTable::IsDomainSmallEnough(std::numeric_limits<int64_t>::min(),
+                                                                 std::numeric_limits<int64_t>::max()));
+}
+
+// NOLINTNEXTLINE
+TEST_F(DirectMappedAggregationTableTest, InsertAndLookupTest) {
+  DirectMappedAggregationTable agg_table(Memory(), sizeof(GroupTuple), -10, 10);
+  EXPECT_EQ(21u, agg_table.NumSlots());
+  EXPECT_EQ(0u, agg_table.NumGroups());
+
+  // Insert groups for the odd keys, in reverse
+  for (int64_t key = 9; key >= -9; key -= 2) {
+    EXPECT_EQ(nullptr, agg_table.Lookup(key));
+    auto *group = reinterpret_cast<GroupTuple *>(agg_table.Insert(key));
+    group->key_ = key;
+    InitGroup(group);
+  }
+  EXPECT_EQ(10u, agg_table.NumGroups());
+
+  for (int64_t key = -10; key <= 10; key++) {
+    auto *group = reinterpret_cast<GroupTuple *>(agg_table.Lookup(key));
+    if (key % 2 == 0) {
+      EXPECT_EQ(nullptr, group);
+    } else {
+      ASSERT_NE(nullptr, group);
+      EXPECT_EQ(key, group->key_);
+    }
+  }
+
+  // Iteration only visits the groups, in key order
+  std::vector<int64_t> keys;
+  for (DirectMappedAggregationTableIterator iter(agg_table); iter.HasNext(); iter.Next()) {
+    keys.push_back(reinterpret_cast<const GroupTuple *>(iter.GetCurrentAggregateRow())->key_);
+  }
+  EXPECT_EQ((std::vector<int64_t>{-9, -7, -5, -3, -1, 1, 3, 5, 7, 9}), keys);
+}
+
+// NOLINTNEXTLINE
+TEST_F(DirectMappedAggregationTableTest, BatchProcessTest) {
+  const int64_t min_key = 1000, max_key = 1099;
+
+  // Vectors with a key and a value column
+  const storage::BlockLayout layout({8, 8, 8});
+  const std::vector<storage::col_id_t> col_ids{storage::col_id_t(1), storage::col_id_t(2)};
+  storage::ProjectedColumnsInitializer pc_initializer(layout, col_ids, common::Constants::K_DEFAULT_VECTOR_SIZE);
+  auto *buffer = common::AllocationUtil::AllocateAligned(pc_initializer.ProjectedColumnsSize());
+  auto *projected_columns = pc_initializer.Initialize(buffer);
+  projected_columns->SetNumTuples(common::Constants::K_DEFAULT_VECTOR_SIZE);
+  auto *keys = reinterpret_cast<int64_t *>(projected_columns->ColumnStart(0));
+  auto *vals = reinterpret_cast<int64_t *>(projected_columns->ColumnStart(1));
+
+  DirectMappedAggregationTable agg_table(Memory(), sizeof(GroupTuple), min_key, max_key);
+  std::unordered_map<int64_t, std::pair<int64_t, int64_t>> ref_agg_table;
+  std::mt19937 generator;
+  std::uniform_int_distribution<int64_t> distribution(min_key, max_key);
+  byte *groups[common::Constants::K_DEFAULT_VECTOR_SIZE];
+
+  for (uint32_t run = 0; run < 10; run++) {
+    for (uint32_t idx = 0; idx < common::Constants::K_DEFAULT_VECTOR_SIZE; idx++) {
+      keys[idx] = distribution(generator);
+      vals[idx] = idx;
+    }
+
+    // Every other vector is filtered down to the tuples with even values
+    ProjectedColumnsIterator pci(projected_columns);
+    if (run % 2 == 1) {
+      pci.RunFilter([&pci]() { return *pci.Get<int64_t, false>(1, nullptr) % 2 == 0; });
+    }
+    pci.ForEach([&]() {
+      auto &ref = ref_agg_table[*pci.Get<int64_t, false>(0, nullptr)];
+      ref.first++;
+      ref.second += *pci.Get<int64_t, false>(1, nullptr);
+    });
+
+    agg_table.LookupOrCreateGroups<int64_t>(&pci, 0, offsetof(GroupTuple, key_), InitGroup, groups);
+    CountStarAggregate::AdvanceBatch(pci.NumSelected(), groups, offsetof(GroupTuple, count_));
+    IntegerSumAggregate::AdvanceBatch(pci.NumSelected(), groups, offsetof(GroupTuple, sum_), vals,
+                                      pci.GetSelectionVector(), nullptr);
+  }
+
+  EXPECT_EQ(ref_agg_table.size(), agg_table.NumGroups());
+  for (DirectMappedAggregationTableIterator iter(agg_table); iter.HasNext(); iter.Next()) {
+    auto *group_tuple = reinterpret_cast<const GroupTuple *>(iter.GetCurrentAggregateRow());
+    auto ref_iter = ref_agg_table.find(group_tuple->key_);
+    ASSERT_NE(ref_agg_table.end(), ref_iter);
+    EXPECT_EQ(ref_iter->second.first, group_tuple->count_.GetCountResult().val_);
+    EXPECT_EQ(ref_iter->second.second, group_tuple->sum_.GetResultSum().val_);
+  }
+
+  delete[] buffer;
+}
+
+// NOLINTNEXTLINE
+TEST_F(DirectMappedAggregationTableTest, ParallelMergeTest) {
+  // More slots than fit in one merge task, and keys spread over all of them
+  const int64_t min_key = -5000, max_key = 4999;
+  const uint32_t num_threads = 4, num_tuples_per_thread = 100000;
+
+  ThreadStateContainer container(Memory());
+  std::pair<MemoryPool *, std::pair<int64_t, int64_t>> args{Memory(), {min_key, max_key}};
+  container.Reset(
+      sizeof(DirectMappedAggregationTable),
+      [](void *ctx, void *table) {
+        auto *args = reinterpret_cast<std::pair<MemoryPool *, std::pair<int64_t, int64_t>> *>(ctx);
+        new (table)
+            DirectMappedAggregationTable(args->first, sizeof(GroupTuple), args->second.first, args->second.second);
+      },
+      [](UNUSED_ATTRIBUTE void *ctx, void *table) {
+        reinterpret_cast<DirectMappedAggregationTable *>(table)->~DirectMappedAggregationTable();
+      },
+      &args);
+
+  // Thread t only aggregates keys that are equal to t modulo 3, so some groups
+  // are only in one thread-local table
+  tbb::task_scheduler_init sched(num_threads);
+  tbb::parallel_for(0u, num_threads, [&](const uint32_t thread_id) {
+    auto *agg_table = container.AccessThreadStateOfCurrentThreadAs<DirectMappedAggregationTable>();
+    std::mt19937 generator(thread_id);
+    std::uniform_int_distribution<int64_t> distribution(min_key, max_key);
+    for (uint32_t i = 0; i < num_tuples_per_thread; i++) {
+      const int64_t key = distribution(generator);
+      if ((key - min_key) % 3 != thread_id % 3) {
+        continue;
+      }
+      auto *group = reinterpret_cast<GroupTuple *>(agg_table->Lookup(key));
+      if (group == nullptr) {
+        group = reinterpret_cast<GroupTuple *>(agg_table->Insert(key));
+        group->key_ = key;
+        InitGroup(group);
+      }
+      group->count_.Advance(Integer(key));
+      group->sum_.Advance(Integer(key));
+    }
+  });
+
+  // Count what each thread-local table holds
+  std::vector<DirectMappedAggregationTable *> tl_tables;
+  container.CollectThreadLocalStateElementsAs(&tl_tables, 0);
+  std::unordered_map<int64_t, int64_t> ref_counts;
+  for (auto *table : tl_tables) {
+    for (DirectMappedAggregationTableIterator iter(*table); iter.HasNext(); iter.Next()) {
+      auto *group_tuple = reinterpret_cast<const GroupTuple *>(iter.GetCurrentAggregateRow());
+      ref_counts[group_tuple->key_] += group_tuple->count_.GetCountResult().val_;
+    }
+  }
+
+  DirectMappedAggregationTable agg_table(Memory(), sizeof(GroupTuple), min_key, max_key);
+  agg_table.MergeParallel(&container, 0, MergeGroup);
+
+  EXPECT_EQ(ref_counts.size(), agg_table.NumGroups());
+  uint64_t num_groups = 0;
+  for (DirectMappedAggregationTableIterator iter(agg_table); iter.HasNext(); iter.Next()) {
+    auto *group_tuple = reinterpret_cast<const GroupTuple *>(iter.GetCurrentAggregateRow());
+    ASSERT_EQ(1u, ref_counts.count(group_tuple->key_));
+    EXPECT_EQ(ref_counts[group_tuple->key_], group_tuple->count_.GetCountResult().val_);
+    EXPECT_EQ(ref_counts[group_tuple->key_] * group_tuple->key_, group_tuple->sum_.GetResultSum().val_);
+    num_groups++;
+  }
+  EXPECT_EQ(agg_table.NumGroups(), num_groups);
+}
+
+}  // namespace terrier::execution::sql::test
@@ -47,6 +47,15 @@ uint32_t HobbledTaaTLt500(ProjectedColumnsIterator *pci) {
   return TaaTLt500(pci);
 }
 
+uint32_t SlowTaaTGe0(ProjectedColumnsIterator *pci) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  pci->RunFilter([pci]() -> bool {
+    auto cola = *pci->Get<int32_t, false>(Col::A, nullptr);
+    return cola >= 0;
+  });
+  return pci->NumSelected();
+}
+
 uint32_t VectorizedLt500(ProjectedColumnsIterator *pci) {
   ProjectedColumnsIterator::FilterVal param{.i_ = 500};
   return pci->FilterColByVal<std::less>(Col::A, type::TypeId ::INTEGER, param);
@@ -103,4 +112,51 @@ TEST_F(FilterManagerTest, AdaptiveFilterManagerTest) {
   EXPECT_EQ(1u, filter.GetOptimalFlavorForClause(0));
 }
 
+// NOLINTNEXTLINE
+TEST_F(FilterManagerTest, ClauseReorderingTest) {
+  // A slow clause that filters nothing comes before a cheap and selective one
+  FilterManager filter(bandit::Policy::Kind::FixedAction);
+  filter.StartNewClause();
+  filter.InsertClauseFlavor(SlowTaaTGe0);
+  filter.StartNewClause();
+  filter.InsertClauseFlavor(VectorizedLt500);
+  filter.Finalize();
+  EXPECT_EQ((std::vector<uint32_t>{0, 1}), filter.GetOptimalClauseOrder());
+
+  auto table_oid = exec_ctx_->GetAccessor()->GetTableOid(NSOid(), "test_1");
+  std::array<uint32_t, 1> col_oids{1};
+
+  // colA is serial, but doesn't start at zero when the tables were generated before in this process
+  uint32_t expected_tuples = 0;
+  {
+    TableVectorIterator tvi(exec_ctx_.get(), !table_oid, col_oids.data(), static_cast<uint32_t>(col_oids.size()));
+    for (tvi.Init(); tvi.Advance();) {
+      auto *pci = tvi.GetProjectedColumnsIterator();
+      pci->ForEach([pci, &expected_tuples]() { expected_tuples += *pci->Get<int32_t, false>(Col::A, nullptr) < 500; });
+    }
+  }
+
+  for (uint32_t scan = 0; scan < 10; scan++) {
+    uint32_t num_tuples = 0;
+    TableVectorIterator tvi(exec_ctx_.get(), !table_oid, col_oids.data(), static_cast<uint32_t>(col_oids.size()));
+    for (tvi.Init(); tvi.Advance();) {
+      auto *pci = tvi.GetProjectedColumnsIterator();
+
+      // Run the filters
+      filter.RunFilters(pci);
+
+      // Check
+      pci->ForEach([pci, &num_tuples]() {
+        auto cola = *pci->Get<int32_t, false>(Col::A, nullptr);
+        EXPECT_LT(cola, 500);
+        num_tuples++;
+      });
+    }
+    EXPECT_EQ(expected_tuples, num_tuples);
+  }
+
+  // The selective clause must have moved first
+  EXPECT_EQ((std::vector<uint32_t>{1, 0}), filter.GetOptimalClauseOrder());
+}
+
 }  // namespace terrier::execution::sql::test
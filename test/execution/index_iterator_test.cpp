@@ -1,4 +1,5 @@
 #include <array>
+#include <limits>
 #include <memory>
 
 #include "execution/sql_test.h"
@@ -6,6 +7,7 @@
 #include "catalog/catalog_defs.h"
 #include "execution/sql/index_iterator.h"
 #include "execution/sql/table_vector_iterator.h"
+#include "execution/sql/thread_state_container.h"
 #include "execution/util/timer.h"
 
 namespace terrier::execution::sql::test {
@@ -59,4 +61,63 @@ TEST_F(IndexIteratorTest, SimpleIndexIteratorTest) {
   }
 }
 
+// NOLINTNEXTLINE
+TEST_F(IndexIteratorTest, ParallelIndexIteratorTest) {
+  //
+  // Scan the whole index in parallel, and check that every key is seen
+  // exactly once, in ascending order within each sub-range
+  //
+
+  auto table_oid = exec_ctx_->GetAccessor()->GetTableOid(NSOid(), "test_1");
+  auto index_oid = exec_ctx_->GetAccessor()->GetIndexOid(NSOid(), "index_1");
+  std::array<uint32_t, 1> col_oids{1};
+  IndexIterator index_iter{exec_ctx_.get(), !table_oid, !index_oid, col_oids.data(),
+                           static_cast<uint32_t>(col_oids.size())};
+  index_iter.Init();
+  index_iter.SetKey<int32_t, false>(0, std::numeric_limits<int32_t>::min(), false);
+  index_iter.SetHighKey<int32_t, false>(0, std::numeric_limits<int32_t>::max(), false);
+
+  // The serial range scan sees every row in ascending order
+  index_iter.ScanAscending();
+  int64_t serial_count = 0, serial_sum = 0;
+  while (index_iter.Advance()) {
+    auto *val = index_iter.Get<int32_t, false>(0, nullptr);
+    serial_count++;
+    serial_sum += *val;
+  }
+  EXPECT_EQ(sql::TEST1_SIZE, serial_count);
+
+  struct ScanState {
+    int64_t count_;
+    int64_t sum_;
+  };
+  MemoryPool memory(nullptr);
+  ThreadStateContainer thread_states(&memory);
+  thread_states.Reset(
+      sizeof(ScanState), [](UNUSED_ATTRIBUTE auto *_, auto *s) { new (s) ScanState{0, 0}; }, nullptr, nullptr);
+
+  auto scan_fn = [](UNUSED_ATTRIBUTE void *query_state, void *thread_state, IndexIterator *iter) {
+    auto *state = reinterpret_cast<ScanState *>(thread_state);
+    bool first = true;
+    int32_t prev = 0;
+    while (iter->Advance()) {
+      auto *val = iter->Get<int32_t, false>(0, nullptr);
+      EXPECT_TRUE(first || prev < *val);
+      first = false;
+      prev = *val;
+      state->count_++;
+      state->sum_ += *val;
+    }
+  };
+  EXPECT_TRUE(index_iter.ParallelScanAscending(nullptr, &thread_states, scan_fn, 8));
+
+  int64_t count = 0, sum = 0;
+  thread_states.ForEach<ScanState>([&](ScanState *state) {
+    count += state->count_;
+    sum += state->sum_;
+  });
+  EXPECT_EQ(serial_count, count);
+  EXPECT_EQ(serial_sum, sum);
+}
+
 }  // namespace terrier::execution::sql::test
@@ -1,3 +1,4 @@
+#include <cstring>
 #include <random>
 #include <vector>
 
@@ -173,7 +174,10 @@ TEST_F(JoinHashTableTest, ParallelBuildTest) {
 
   container.Reset(
       sizeof(JoinHashTable),
-      [](auto *ctx, auto *s) { new (s) JoinHashTable(reinterpret_cast<MemoryPool *>(ctx), sizeof(Tuple)); },
+      [](auto *ctx, auto *s) {
+        new (s) JoinHashTable(reinterpret_cast<MemoryPool *>(ctx), sizeof(Tuple));
+        reinterpret_cast<JoinHashTable *>(s)->EnableSpilling();
+      },
       [](auto *ctx, auto *s) { reinterpret_cast<JoinHashTable *>(s)->~JoinHashTable(); }, &memory);
 
   // Parallel populate hash tables
@@ -189,6 +193,253 @@ TEST_F(JoinHashTableTest, ParallelBuildTest) {
   main_jht.MergeParallel(&container, 0);
 }
 
+/**
+ * Build a table in parallel from four thread-local tables holding all keys in [0, num_tuples) each, and check that
+ * every key finds four matches
+ */
+template <bool UseConciseHashTable>
+void ParallelBuildAndProbeTest(const uint32_t num_tuples, const bool partitioned_build) {
+  MemoryPool memory(nullptr);
+  ThreadStateContainer container(&memory);
+
+  container.Reset(
+      sizeof(JoinHashTable),
+      [](auto *ctx, auto *s) {
+        new (s) JoinHashTable(reinterpret_cast<MemoryPool *>(ctx), sizeof(Tuple), UseConciseHashTable);
+      },
+      [](auto *ctx, auto *s) { reinterpret_cast<JoinHashTable *>(s)->~JoinHashTable(); }, &memory);
+
+  tbb::task_scheduler_init sched;
+  tbb::blocked_range<std::size_t> block_range(0, 4, 1);
+  tbb::parallel_for(block_range, [&](const auto &range) {
+    for (auto r = range.begin(); r != range.end(); r++) {
+      PopulateJoinHashTable(container.AccessThreadStateOfCurrentThreadAs<JoinHashTable>(), num_tuples, 1);
+    }
+  });
+
+  JoinHashTable main_jht(&memory, sizeof(Tuple), UseConciseHashTable);
+  main_jht.SetPartitionedBuild(partitioned_build);
+  main_jht.MergeParallel(&container, 0);
+  EXPECT_TRUE(main_jht.IsBuilt());
+
+  std::vector<hash_t> hashes(num_tuples);
+  for (uint32_t i = 0; i < num_tuples; i++) {
+    auto hash_val = util::Hasher::Hash(reinterpret_cast<const uint8_t *>(&i), sizeof(i));
+    hashes[i] = hash_val;
+    Tuple probe_tuple = {i, 0, 0, 0};
+    uint32_t count = 0;
+    for (auto iter = main_jht.Lookup<UseConciseHashTable>(hash_val);
+         iter.HasNext(TupleKeyEq, nullptr, reinterpret_cast<void *>(&probe_tuple));) {
+      EXPECT_EQ(i, reinterpret_cast<const Tuple *>(iter.NextMatch()->payload_)->a_);
+      count++;
+    }
+    EXPECT_EQ(4u, count) << "key [" << i << "]";
+  }
+
+  // Batched lookups find the same entries
+  std::vector<const HashTableEntry *> results(common::Constants::K_DEFAULT_VECTOR_SIZE);
+  for (uint32_t start = 0; start < num_tuples; start += common::Constants::K_DEFAULT_VECTOR_SIZE) {
+    const auto batch_size = std::min(num_tuples - start, common::Constants::K_DEFAULT_VECTOR_SIZE);
+    main_jht.LookupBatch(batch_size, &hashes[start], results.data());
+    for (uint32_t i = 0; i < batch_size; i++) {
+      EXPECT_NE(nullptr, results[i]);
+    }
+  }
+
+  // The Bloom filter covers the tuples wherever the merge put them
+  EXPECT_EQ(nullptr, main_jht.GetBloomFilter());
+  const BloomFilter *bloom_filter = main_jht.BuildBloomFilter();
+  ASSERT_NE(nullptr, bloom_filter);
+  EXPECT_EQ(bloom_filter, main_jht.BuildBloomFilter());
+  EXPECT_EQ(bloom_filter, main_jht.GetBloomFilter());
+  for (const hash_t hash : hashes) {
+    EXPECT_TRUE(bloom_filter->Contains(hash));
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(JoinHashTableTest, PartitionedParallelBuildTest) {
+  ParallelBuildAndProbeTest<false>(100000, true);
+  ParallelBuildAndProbeTest<false>(100000, false);
+}
+
+// NOLINTNEXTLINE
+TEST_F(JoinHashTableTest, PartitionedParallelConciseBuildTest) { ParallelBuildAndProbeTest<true>(100000, true); }
+
+/**
+ * Probe every key in [0, num_tuples) once, deferring the probes of spilled partitions, and return the total number of
+ * matches found, both in memory and on disk
+ */
+uint32_t ProbeWithSpilling(JoinHashTable *jht, uint32_t num_tuples) {
+  uint32_t count = 0;
+  const auto count_matches = [](void *ctx, const JoinHashTable *table, hash_t hash, const byte *probe_tuple) {
+    auto *tuple = const_cast<byte *>(probe_tuple);
+    for (auto iter = table->Lookup<false>(hash); iter.HasNext(TupleKeyEq, nullptr, tuple);) {
+      auto *matched = reinterpret_cast<const Tuple *>(iter.NextMatch()->payload_);
+      EXPECT_EQ(reinterpret_cast<const Tuple *>(probe_tuple)->a_, matched->a_);
+      (*reinterpret_cast<uint32_t *>(ctx))++;
+    }
+  };
+
+  for (uint32_t i = 0; i < num_tuples; i++) {
+    auto hash_val = util::Hasher::Hash(reinterpret_cast<const uint8_t *>(&i), sizeof(i));
+    Tuple probe_tuple = {i, 0, 0, 0};
+    if (jht->IsSpilled(hash_val)) {
+      jht->DeferProbeTuple(hash_val, reinterpret_cast<const byte *>(&probe_tuple), sizeof(Tuple));
+    } else {
+      count_matches(&count, jht, hash_val, reinterpret_cast<const byte *>(&probe_tuple));
+    }
+  }
+  jht->JoinSpilledPartitions(&count, count_matches);
+  return count;
+}
+
+// NOLINTNEXTLINE
+TEST_F(JoinHashTableTest, SpillingBuildTest) {
+  const uint32_t num_tuples = 100000;
+  const uint32_t dup_scale_factor = 3;
+
+  // Room for about a tenth of the input
+  MemoryPool memory(nullptr);
+  memory.SetMemoryBudget(num_tuples * dup_scale_factor * (sizeof(HashTableEntry) + sizeof(Tuple)) / 10);
+
+  JoinHashTable join_hash_table(&memory, sizeof(Tuple), false);
+  join_hash_table.EnableSpilling();
+  PopulateJoinHashTable(&join_hash_table, num_tuples, dup_scale_factor);
+  join_hash_table.Build();
+
+  EXPECT_TRUE(join_hash_table.HasSpilledPartitions());
+  EXPECT_GT(join_hash_table.GetSpilledBytes(), 0u);
+  EXPECT_EQ(nullptr, join_hash_table.BuildBloomFilter());
+  EXPECT_EQ(nullptr, join_hash_table.GetBloomFilter());
+  EXPECT_LT(join_hash_table.NumElements(), num_tuples * dup_scale_factor);
+  EXPECT_EQ(num_tuples * dup_scale_factor, ProbeWithSpilling(&join_hash_table, num_tuples));
+}
+
+// NOLINTNEXTLINE
+TEST_F(JoinHashTableTest, SpillingParallelBuildTest) {
+  const uint32_t num_tuples = 100000;
+  const uint32_t num_threads = 4;
+
+  MemoryPool memory(nullptr);
+  memory.SetMemoryBudget(num_tuples * (sizeof(HashTableEntry) + sizeof(Tuple)) / 4);
+  ThreadStateContainer container(&memory);
+
+  container.Reset(
+      sizeof(JoinHashTable),
+      [](auto *ctx, auto *s) {
+        new (s) JoinHashTable(reinterpret_cast<MemoryPool *>(ctx), sizeof(Tuple));
+        reinterpret_cast<JoinHashTable *>(s)->EnableSpilling();
+      },
+      [](auto *ctx, auto *s) { reinterpret_cast<JoinHashTable *>(s)->~JoinHashTable(); }, &memory);
+
+  // Every thread inserts all keys, so each key has one match per thread
+  tbb::task_scheduler_init sched;
+  tbb::blocked_range<std::size_t> block_range(0, num_threads, 1);
+  tbb::parallel_for(block_range, [&](const auto &range) {
+    for (auto r = range.begin(); r != range.end(); r++) {
+      auto *jht = container.AccessThreadStateOfCurrentThreadAs<JoinHashTable>();
+      PopulateJoinHashTable(jht, num_tuples, 1);
+    }
+  });
+
+  JoinHashTable main_jht(&memory, sizeof(Tuple), false);
+  main_jht.EnableSpilling();
+  main_jht.MergeParallel(&container, 0);
+
+  EXPECT_TRUE(main_jht.HasSpilledPartitions());
+  EXPECT_EQ(num_tuples * num_threads, ProbeWithSpilling(&main_jht, num_tuples));
+}
+
+// NOLINTNEXTLINE
+TEST_F(JoinHashTableTest, RecursiveSpillingTest) {
+  const uint32_t num_tuples = 100000;
+  const uint32_t dup_scale_factor = 2;
+
+  // Room for a fraction of a single spill partition, so that spilled
+  // partitions have to be partitioned again when they're read back
+  MemoryPool memory(nullptr);
+  const uint64_t partition_size =
+      num_tuples * dup_scale_factor / JoinHashTable::K_NUM_SPILL_PARTITIONS * (sizeof(HashTableEntry) + sizeof(Tuple));
+  memory.SetMemoryBudget(partition_size / 8);
+
+  JoinHashTable join_hash_table(&memory, sizeof(Tuple), false);
+  join_hash_table.EnableSpilling();
+  PopulateJoinHashTable(&join_hash_table, num_tuples, dup_scale_factor);
+  join_hash_table.Build();
+
+  EXPECT_TRUE(join_hash_table.HasSpilledPartitions());
+  EXPECT_EQ(num_tuples * dup_scale_factor, ProbeWithSpilling(&join_hash_table, num_tuples));
+}
+
+// NOLINTNEXTLINE
+TEST_F(JoinHashTableTest, WideTupleSpillingTest) {
+  // Tuples wider than the staging buffer of a partition, and than a read batch, are spilled and read back whole
+  const uint32_t num_tuples = 200;
+  const uint32_t tuple_size = JoinHashTable::K_SPILL_READ_BATCH_SIZE + sizeof(Tuple);
+
+  MemoryPool memory(nullptr);
+  memory.SetMemoryBudget(num_tuples * (sizeof(HashTableEntry) + tuple_size) / 4);
+
+  // The key is followed by a byte pattern particular to it, which a torn tuple wouldn't match
+  const auto fill = [&](byte *tuple, uint32_t i) {
+    reinterpret_cast<Tuple *>(tuple)->a_ = i;
+    std::memset(tuple + sizeof(uint64_t), static_cast<int>(i & 0xff), tuple_size - sizeof(uint64_t));
+  };
+
+  JoinHashTable join_hash_table(&memory, tuple_size, false);
+  join_hash_table.EnableSpilling();
+  for (uint32_t i = 0; i < num_tuples; i++) {
+    auto hash_val = util::Hasher::Hash(reinterpret_cast<const uint8_t *>(&i), sizeof(i));
+    fill(join_hash_table.AllocInputTuple(hash_val), i);
+  }
+  join_hash_table.Build();
+  EXPECT_TRUE(join_hash_table.HasSpilledPartitions());
+
+  struct ProbeState {
+    uint32_t tuple_size_;
+    uint32_t count_;
+  } probe_state{tuple_size, 0};
+  const auto count_matches = [](void *ctx, const JoinHashTable *table, hash_t hash, const byte *probe_tuple) {
+    auto *state = reinterpret_cast<ProbeState *>(ctx);
+    auto *tuple = const_cast<byte *>(probe_tuple);
+    for (auto iter = table->Lookup<false>(hash); iter.HasNext(TupleKeyEq, nullptr, tuple);) {
+      const byte *matched = iter.NextMatch()->payload_;
+      EXPECT_EQ(0, std::memcmp(probe_tuple, matched, state->tuple_size_));
+      state->count_++;
+    }
+  };
+
+  std::vector<byte> probe_tuple(tuple_size);
+  for (uint32_t i = 0; i < num_tuples; i++) {
+    auto hash_val = util::Hasher::Hash(reinterpret_cast<const uint8_t *>(&i), sizeof(i));
+    fill(probe_tuple.data(), i);
+    if (join_hash_table.IsSpilled(hash_val)) {
+      join_hash_table.DeferProbeTuple(hash_val, probe_tuple.data(), tuple_size);
+    } else {
+      count_matches(&probe_state, &join_hash_table, hash_val, probe_tuple.data());
+    }
+  }
+  join_hash_table.JoinSpilledPartitions(&probe_state, count_matches);
+  EXPECT_EQ(num_tuples, probe_state.count_);
+}
+
+// NOLINTNEXTLINE
+TEST_F(JoinHashTableTest, SpillingDisabledTest) {
+  const uint32_t num_tuples = 10000;
+
+  // A budget alone doesn't make the table spill
+  MemoryPool memory(nullptr);
+  memory.SetMemoryBudget(num_tuples * (sizeof(HashTableEntry) + sizeof(Tuple)) / 10);
+
+  JoinHashTable join_hash_table(&memory, sizeof(Tuple), false);
+  PopulateJoinHashTable(&join_hash_table, num_tuples, 1);
+  join_hash_table.Build();
+
+  EXPECT_FALSE(join_hash_table.HasSpilledPartitions());
+  EXPECT_EQ(num_tuples, join_hash_table.NumElements());
+}
+
 // NOLINTNEXTLINE
 TEST_F(JoinHashTableTest, DISABLED_PerfTest) {
   const uint32_t num_tuples = 10000000;
@@ -0,0 +1,67 @@
+#include <memory>
+#include <string>
+
+#include "execution/tpl_test.h"
+
+// From test
+#include "execution/vm/bytecode_generator.h"
+#include "execution/vm/llvm_engine.h"
+#include "execution/vm/module_compiler.h"
+
+namespace terrier::execution::vm::test {
+
+class LLVMEngineTest : public TplTest {
+ public:
+  // Compile the source into a bytecode module
+  std::unique_ptr<BytecodeModule> Compile(const std::string &src) {
+    auto *ast = compiler_.CompileToAst(src);
+    if (compiler_.HasErrors()) return nullptr;
+    return BytecodeGenerator::Compile(ast, nullptr, "test");
+  }
+
+ private:
+  ModuleCompiler compiler_;
+};
+
+// NOLINTNEXTLINE
+TEST_F(LLVMEngineTest, ChooseOptimizationLevelTest) {
+  // Code that runs once isn't worth optimizing
+  auto straight = Compile(R"(
+    fun main() -> int64 {
+      var x: int64 = 1
+      var y = x * 2 + 3
+      return x + y
+    })");
+  ASSERT_TRUE(straight != nullptr);
+  EXPECT_EQ(LLVMEngine::OptimizationLevel::Fast, LLVMEngine::ChooseOptimizationLevel(*straight));
+
+  // Nested loops are
+  auto nested = Compile(R"(
+    fun main() -> int64 {
+      var s: int64 = 0
+      for (var i: int64 = 0; i < 100; i = i + 1) {
+        for (var j: int64 = 0; j < 100; j = j + 1) {
+          s = s + i * j
+        }
+      }
+      return s
+    })");
+  ASSERT_TRUE(nested != nullptr);
+  EXPECT_EQ(LLVMEngine::OptimizationLevel::Full, LLVMEngine::ChooseOptimizationLevel(*nested));
+
+  // The plan's estimate decides how much a loop runs
+  auto loop = Compile(R"(
+    fun main() -> int64 {
+      var s: int64 = 0
+      for (var i: int64 = 0; i < 100; i = i + 1) {
+        s = s + i
+      }
+      return s
+    })");
+  ASSERT_TRUE(loop != nullptr);
+  EXPECT_EQ(LLVMEngine::OptimizationLevel::Fast, LLVMEngine::ChooseOptimizationLevel(*loop, 10));
+  EXPECT_EQ(LLVMEngine::OptimizationLevel::Light, LLVMEngine::ChooseOptimizationLevel(*loop, 20000));
+  EXPECT_EQ(LLVMEngine::OptimizationLevel::Full, LLVMEngine::ChooseOptimizationLevel(*loop, 100000000));
+}
+
+}  // namespace terrier::execution::vm::test
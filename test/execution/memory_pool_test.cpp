@@ -0,0 +1,159 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "execution/tpl_test.h"
+
+#include "common/constants.h"
+#include "execution/sql/memory_pool.h"
+#include "execution/util/memory.h"
+
+namespace terrier::execution::sql::test {
+
+class MemoryPoolTest : public TplTest {};
+
+// NOLINTNEXTLINE
+TEST_F(MemoryPoolTest, ReuseTest) {
+  MemoryPool pool(nullptr);
+
+  // A freed block is handed out again for the next allocation of its size class
+  auto *first = pool.Allocate(1000, false);
+  pool.Deallocate(first, 1000);
+  auto *second = pool.Allocate(900, false);
+  EXPECT_EQ(first, second);
+
+  // Recycled blocks are cleared on request
+  std::memset(second, 0xff, 900);
+  pool.Deallocate(second, 900);
+  auto *third = static_cast<uint8_t *>(pool.Allocate(1000, true));
+  EXPECT_TRUE(std::all_of(third, third + 1000, [](const uint8_t b) { return b == 0; }));
+  pool.Deallocate(third, 1000);
+
+  // A different size class doesn't reuse it
+  auto *other = pool.Allocate(4000, false);
+  EXPECT_NE(first, other);
+  pool.Deallocate(other, 4000);
+}
+
+// NOLINTNEXTLINE
+TEST_F(MemoryPoolTest, AlignmentTest) {
+  MemoryPool pool(nullptr);
+  std::vector<std::pair<void *, std::size_t>> allocs;
+  for (std::size_t size = 1; size < 100000; size = size * 3 / 2 + 1) {
+    auto *ptr = pool.AllocateAligned(size, common::Constants::CACHELINE_SIZE, false);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(ptr) % common::Constants::CACHELINE_SIZE);
+    // Blocks don't overlap
+    std::memset(ptr, static_cast<int>(allocs.size()), size);
+    allocs.emplace_back(ptr, size);
+  }
+  for (uint32_t i = 0; i < allocs.size(); i++) {
+    auto *bytes = static_cast<uint8_t *>(allocs[i].first);
+    EXPECT_TRUE(std::all_of(bytes, bytes + allocs[i].second, [&](const uint8_t b) { return b == (i & 0xff); }));
+    pool.Deallocate(allocs[i].first, allocs[i].second);
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(MemoryPoolTest, OverAlignedTest) {
+  MemoryPool pool(nullptr);
+
+  // Small allocations aligned beyond a cache line don't come from the arena
+  std::vector<void *> ptrs;
+  for (std::size_t alignment = 128; alignment <= 4096; alignment *= 2) {
+    auto *ptr = static_cast<uint8_t *>(pool.AllocateAligned(100, alignment, true));
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(ptr) % alignment);
+    EXPECT_TRUE(std::all_of(ptr, ptr + 100, [](const uint8_t b) { return b == 0; }));
+    ptrs.push_back(ptr);
+  }
+  for (auto *ptr : ptrs) {
+    pool.Deallocate(ptr, 100);
+  }
+
+  // Arena blocks are still recycled afterwards
+  auto *first = pool.Allocate(100, false);
+  pool.Deallocate(first, 100);
+  EXPECT_EQ(first, pool.Allocate(100, false));
+  pool.Deallocate(first, 100);
+}
+
+#ifndef NDEBUG
+// NOLINTNEXTLINE
+TEST_F(MemoryPoolTest, SizeMismatchTest) {
+  MemoryPool pool(nullptr);
+  auto *ptr = pool.Allocate(100, false);
+  EXPECT_DEATH(pool.Deallocate(ptr, 1000), "size it was allocated with");
+  pool.Deallocate(ptr, 100);
+}
+#endif
+
+// NOLINTNEXTLINE
+TEST_F(MemoryPoolTest, LargeAllocationTest) {
+  MemoryPool pool(nullptr);
+
+  // Allocations of a huge page or more are aligned so that huge pages can back them
+  const std::size_t size = 3 * util::K_HUGE_PAGE_SIZE + 100;
+  auto *huge = static_cast<uint8_t *>(pool.Allocate(size, true));
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(huge) % util::K_HUGE_PAGE_SIZE);
+  EXPECT_TRUE(std::all_of(huge, huge + size, [](const uint8_t b) { return b == 0; }));
+  huge[size - 1] = 1;
+  pool.Deallocate(huge, size);
+
+  // Between the arena and huge pages
+  auto *medium = static_cast<uint8_t *>(pool.Allocate(common::Constants::MB, true));
+  EXPECT_EQ(0, medium[common::Constants::MB - 1]);
+  pool.Deallocate(medium, common::Constants::MB);
+}
+
+// NOLINTNEXTLINE
+TEST_F(MemoryPoolTest, MultiThreadedTest) {
+  MemoryPool pool(nullptr);
+
+  // Threads allocate from their own arenas and free each other's blocks
+  constexpr uint32_t num_threads = 4, num_allocs = 10000;
+  std::vector<std::vector<uint64_t *>> allocs(num_threads);
+  std::vector<std::thread> threads;
+  for (uint32_t t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t] {
+      for (uint32_t i = 0; i < num_allocs; i++) {
+        const uint32_t num_elems = 1 + i % 100;
+        auto *ptr = pool.AllocateArray<uint64_t>(num_elems, false);
+        std::fill(ptr, ptr + num_elems, t * num_allocs + i);
+        allocs[t].push_back(ptr);
+      }
+    });
+  }
+  for (auto &thread : threads) thread.join();
+  threads.clear();
+
+  for (uint32_t t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t] {
+      const uint32_t owner = (t + 1) % num_threads;
+      for (uint32_t i = 0; i < num_allocs; i++) {
+        const uint32_t num_elems = 1 + i % 100;
+        auto *ptr = allocs[owner][i];
+        EXPECT_TRUE(std::all_of(ptr, ptr + num_elems, [&](const uint64_t v) { return v == owner * num_allocs + i; }));
+        pool.DeallocateArray(ptr, num_elems);
+      }
+    });
+  }
+  for (auto &thread : threads) thread.join();
+}
+
+// NOLINTNEXTLINE
+TEST_F(MemoryPoolTest, BulkReleaseTest) {
+  // Blocks that are never freed go away with the pool, and its slabs serve the next pool
+  void *block;
+  {
+    MemoryPool pool(nullptr);
+    block = pool.Allocate(64 * common::Constants::KB, false);
+    std::memset(block, 0xff, 64 * common::Constants::KB);
+  }
+  MemoryPool pool(nullptr);
+  auto *next = pool.Allocate(64 * common::Constants::KB, false);
+  EXPECT_EQ(block, next);
+  pool.Deallocate(next, 64 * common::Constants::KB);
+}
+
+}  // namespace terrier::execution::sql::test
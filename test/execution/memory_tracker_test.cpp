@@ -0,0 +1,122 @@
+#include <cstdlib>
+#include <stdexcept>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "execution/tpl_test.h"
+
+#include "execution/sql/memory_pool.h"
+#include "execution/sql/memory_tracker.h"
+
+namespace terrier::execution::sql::test {
+
+class MemoryTrackerTest : public TplTest {};
+
+// NOLINTNEXTLINE
+TEST_F(MemoryTrackerTest, AccountingTest) {
+  MemoryTracker tracker;
+  MemoryPool pool(&tracker);
+
+  // Small allocations are charged for the 128 byte arena blocks they take
+  auto *small = pool.Allocate(100, false);
+  auto *array = pool.AllocateArray<uint64_t>(10, true);
+  EXPECT_EQ(256, tracker.GetAllocatedSize());
+  EXPECT_EQ(2, tracker.GetNumAllocations());
+  // Too little to be published yet
+  EXPECT_EQ(0, tracker.GetApproxAllocatedSize());
+
+  const std::size_t large_size = 2 * MemoryTracker::K_FLUSH_BYTES;
+  auto *large = pool.Allocate(large_size, false);
+  EXPECT_EQ(large_size + 256, tracker.GetAllocatedSize());
+  EXPECT_EQ(large_size + 256, tracker.GetApproxAllocatedSize());
+  EXPECT_EQ(large_size + 256, tracker.GetPeakAllocatedSize());
+
+  pool.Deallocate(large, large_size);
+  pool.DeallocateArray(array, 10);
+  pool.Deallocate(small, 100);
+  EXPECT_EQ(0, tracker.GetAllocatedSize());
+  // The small frees aren't published yet
+  EXPECT_EQ(256, tracker.GetApproxAllocatedSize());
+  EXPECT_EQ(large_size + 256, tracker.GetPeakAllocatedSize());
+  EXPECT_EQ(3, tracker.GetNumAllocations());
+}
+
+// NOLINTNEXTLINE
+TEST_F(MemoryTrackerTest, AllocatorTest) {
+  // Containers allocating from a pool are accounted in bytes, not elements
+  MemoryTracker tracker;
+  MemoryPool pool(&tracker);
+  {
+    MemPoolVector<uint64_t> vec(1024, &pool);
+    EXPECT_EQ(1024 * sizeof(uint64_t), tracker.GetAllocatedSize());
+  }
+  EXPECT_EQ(0, tracker.GetAllocatedSize());
+}
+
+// NOLINTNEXTLINE
+TEST_F(MemoryTrackerTest, MultiThreadedTest) {
+  MemoryTracker tracker;
+  MemoryPool pool(&tracker);
+
+  // Every thread frees half of what it allocates, some of it allocated by another thread
+  constexpr uint32_t num_threads = 4, num_allocs = 1000, alloc_size = 1024;
+  std::vector<std::vector<void *>> allocs(num_threads);
+  std::vector<std::thread> threads;
+  for (uint32_t t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t] {
+      for (uint32_t i = 0; i < num_allocs; i++) {
+        allocs[t].push_back(pool.Allocate(alloc_size, false));
+      }
+    });
+  }
+  for (auto &thread : threads) thread.join();
+  threads.clear();
+  EXPECT_EQ(num_threads * num_allocs * alloc_size, tracker.GetAllocatedSize());
+  EXPECT_EQ(num_threads * num_allocs, tracker.GetNumAllocations());
+
+  for (uint32_t t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t] {
+      auto &victims = allocs[(t + 1) % num_threads];
+      for (uint32_t i = 0; i < num_allocs / 2; i++) {
+        pool.Deallocate(victims.back(), alloc_size);
+        victims.pop_back();
+      }
+    });
+  }
+  for (auto &thread : threads) thread.join();
+  EXPECT_EQ(num_threads * num_allocs / 2 * alloc_size, tracker.GetAllocatedSize());
+
+  // What a thread didn't publish yet is off by less than the flush threshold
+  const auto expected = static_cast<int64_t>(tracker.GetAllocatedSize());
+  EXPECT_LT(std::abs(static_cast<int64_t>(tracker.GetApproxAllocatedSize()) - expected),
+            num_threads * MemoryTracker::K_FLUSH_BYTES);
+  EXPECT_GE(tracker.GetPeakAllocatedSize(), tracker.GetApproxAllocatedSize());
+
+  for (auto &thread_allocs : allocs) {
+    for (auto *ptr : thread_allocs) pool.Deallocate(ptr, alloc_size);
+  }
+  EXPECT_EQ(0, tracker.GetAllocatedSize());
+}
+
+// NOLINTNEXTLINE
+TEST_F(MemoryTrackerTest, LimitTest) {
+  MemoryTracker tracker;
+  MemoryPool pool(&tracker);
+  const std::size_t limit = 4 * MemoryTracker::K_FLUSH_BYTES;
+  tracker.SetLimit(limit);
+
+  auto *first = pool.Allocate(limit / 2, false);
+  EXPECT_THROW(pool.Allocate(limit, false), std::runtime_error);
+
+  // The failed allocation isn't counted, and the query can still allocate within its limit
+  EXPECT_EQ(limit / 2, tracker.GetAllocatedSize());
+  EXPECT_EQ(1, tracker.GetNumAllocations());
+  auto *second = pool.Allocate(limit / 4, false);
+  EXPECT_EQ(3 * limit / 4, tracker.GetAllocatedSize());
+
+  pool.Deallocate(second, limit / 4);
+  pool.Deallocate(first, limit / 2);
+  EXPECT_EQ(0, tracker.GetAllocatedSize());
+}
+
+}  // namespace terrier::execution::sql::test
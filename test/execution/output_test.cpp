@@ -0,0 +1,230 @@
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "execution/tpl_test.h"
+
+#include "execution/exec/execution_context.h"
+#include "execution/exec/output.h"
+#include "execution/sql/memory_pool.h"
+#include "execution/sql/value.h"
+#include "portable_endian/portable_endian.h"
+
+namespace terrier::execution::exec::test {
+
+class OutputTest : public TplTest {
+ public:
+  // Parse DataRow messages into rows of values, std::nullopt standing for NULL
+  static std::vector<std::vector<std::optional<std::string>>> ParseDataRows(const std::string &bytes) {
+    std::vector<std::vector<std::optional<std::string>>> rows;
+    std::size_t pos = 0;
+    while (pos < bytes.size()) {
+      EXPECT_EQ('D', bytes[pos]);
+      const auto message_size = ReadInt32(bytes, pos + 1);
+      const std::size_t end = pos + 1 + message_size;
+      const auto num_cols = static_cast<int16_t>(be16toh(Read<uint16_t>(bytes, pos + 5)));
+      pos += 7;
+      rows.emplace_back();
+      for (int16_t col = 0; col < num_cols; col++) {
+        const auto len = ReadInt32(bytes, pos);
+        pos += sizeof(int32_t);
+        if (len < 0) {
+          rows.back().emplace_back(std::nullopt);
+        } else {
+          rows.back().emplace_back(bytes.substr(pos, len));
+          pos += len;
+        }
+      }
+      EXPECT_EQ(end, pos);
+    }
+    return rows;
+  }
+
+  template <typename T>
+  static T Read(const std::string &bytes, const std::size_t pos) {
+    T val;
+    std::memcpy(&val, bytes.data() + pos, sizeof(T));
+    return val;
+  }
+
+  static int32_t ReadInt32(const std::string &bytes, const std::size_t pos) {
+    return static_cast<int32_t>(be32toh(Read<uint32_t>(bytes, pos)));
+  }
+
+  // The value of a big endian integer sent in the binary format
+  template <typename T>
+  static std::string BigEndian(T val) {
+    if constexpr (sizeof(T) == 2) {
+      val = static_cast<T>(htobe16(static_cast<uint16_t>(val)));
+    } else if constexpr (sizeof(T) == 4) {
+      val = static_cast<T>(htobe32(static_cast<uint32_t>(val)));
+    } else {
+      val = static_cast<T>(htobe64(static_cast<uint64_t>(val)));
+    }
+    return std::string(reinterpret_cast<const char *>(&val), sizeof(T));
+  }
+
+  // An output schema of a smallint, a boolean, a decimal, a date and a varchar
+  static std::unique_ptr<planner::OutputSchema> MixedSchema() {
+    std::vector<planner::OutputSchema::Column> columns;
+    columns.emplace_back("a", type::TypeId::SMALLINT, true, catalog::col_oid_t(1));
+    columns.emplace_back("b", type::TypeId::BOOLEAN, true, catalog::col_oid_t(2));
+    columns.emplace_back("c", type::TypeId::DECIMAL, true, catalog::col_oid_t(3));
+    columns.emplace_back("d", type::TypeId::DATE, true, catalog::col_oid_t(4));
+    columns.emplace_back("e", type::TypeId::VARCHAR, true, catalog::col_oid_t(5));
+    return std::make_unique<planner::OutputSchema>(std::move(columns));
+  }
+
+  // Write a tuple of the mixed schema into its slot. A negative number makes every value of the tuple NULL.
+  static void WriteMixedTuple(byte *slot, const int64_t num, const char *str) {
+    const uint32_t int_size = sql::ValUtil::GetSqlSize(type::TypeId::SMALLINT);
+    const uint32_t bool_size = sql::ValUtil::GetSqlSize(type::TypeId::BOOLEAN);
+    const uint32_t real_size = sql::ValUtil::GetSqlSize(type::TypeId::DECIMAL);
+    const uint32_t date_size = sql::ValUtil::GetSqlSize(type::TypeId::DATE);
+    if (num < 0) {
+      new (slot) sql::Integer(sql::Integer::Null());
+      new (slot + int_size) sql::BoolVal(sql::BoolVal::Null());
+      new (slot + int_size + bool_size) sql::Real(sql::Real::Null());
+      new (slot + int_size + bool_size + real_size) sql::Date(sql::Date::Null());
+      new (slot + int_size + bool_size + real_size + date_size) sql::StringVal(sql::StringVal::Null());
+      return;
+    }
+    new (slot) sql::Integer(num);
+    new (slot + int_size) sql::BoolVal(num % 2 == 0);
+    new (slot + int_size + bool_size) sql::Real(static_cast<double>(num) + 0.5);
+    const auto day = static_cast<uint8_t>(1 + num % 28);
+    new (slot + int_size + bool_size + real_size) sql::Date(static_cast<int16_t>(2000 + num), 3, day);
+    new (slot + int_size + bool_size + real_size + date_size) sql::StringVal(str, std::strlen(str));
+  }
+};
+
+// NOLINTNEXTLINE
+TEST_F(OutputTest, BatchingTest) {
+  sql::MemoryPool pool(nullptr);
+  std::vector<uint32_t> batches;
+  std::vector<int64_t> values;
+  OutputCallback callback = [&](byte *tuples, uint32_t num_tuples, uint32_t tuple_size) {
+    batches.push_back(num_tuples);
+    for (uint32_t i = 0; i < num_tuples; i++) {
+      values.push_back(reinterpret_cast<sql::Integer *>(tuples + i * tuple_size)->val_);
+    }
+  };
+
+  // Tuples are handed over once a batch is full, and the rest when the output is finalized
+  const uint32_t tuple_size = sql::ValUtil::GetSqlSize(type::TypeId::INTEGER);
+  OutputBuffer buffer(&pool, 1, tuple_size, callback, 100);
+  EXPECT_EQ(100u, buffer.GetBatchSize());
+  for (int64_t i = 0; i < 250; i++) {
+    new (buffer.AllocOutputSlot()) sql::Integer(i);
+  }
+  EXPECT_EQ(std::vector<uint32_t>({100, 100}), batches);
+  buffer.Finalize();
+  EXPECT_EQ(std::vector<uint32_t>({100, 100, 50}), batches);
+  ASSERT_EQ(250u, values.size());
+  for (int64_t i = 0; i < 250; i++) {
+    EXPECT_EQ(i, values[i]);
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(OutputTest, TextDataRowTest) {
+  auto schema = MixedSchema();
+  std::string bytes;
+  uint32_t num_sinks = 0;
+  PostgresOutputWriter writer(schema.get(), false, [&](const char *data, std::size_t size) {
+    bytes.append(data, size);
+    num_sinks++;
+  });
+
+  sql::MemoryPool pool(nullptr);
+  const std::string long_str(100, 'x');
+  OutputBuffer buffer(&pool, 5, ExecutionContext::ComputeTupleSize(schema.get()), writer, 16);
+  for (int64_t i = 0; i < 20; i++) {
+    WriteMixedTuple(buffer.AllocOutputSlot(), i == 3 ? -1 : i, i % 2 == 0 ? "abc" : long_str.c_str());
+  }
+  buffer.Finalize();
+
+  // One call to the sink per batch
+  EXPECT_EQ(2u, num_sinks);
+  const auto rows = ParseDataRows(bytes);
+  ASSERT_EQ(20u, rows.size());
+  for (int64_t i = 0; i < 20; i++) {
+    ASSERT_EQ(5u, rows[i].size());
+    if (i == 3) {
+      for (const auto &val : rows[i]) EXPECT_FALSE(val.has_value());
+      continue;
+    }
+    EXPECT_EQ(std::to_string(i), rows[i][0]);
+    EXPECT_EQ(i % 2 == 0 ? "t" : "f", rows[i][1]);
+    EXPECT_EQ(std::to_string(i) + ".5", rows[i][2]);
+    EXPECT_EQ(sql::ValUtil::DateToString(sql::Date(static_cast<int16_t>(2000 + i), 3, static_cast<uint8_t>(1 + i))),
+              rows[i][3]);
+    EXPECT_EQ(i % 2 == 0 ? "abc" : long_str, rows[i][4]);
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(OutputTest, TextEdgeValuesTest) {
+  std::vector<planner::OutputSchema::Column> columns;
+  columns.emplace_back("a", type::TypeId::BIGINT, true, catalog::col_oid_t(1));
+  columns.emplace_back("b", type::TypeId::DECIMAL, true, catalog::col_oid_t(2));
+  planner::OutputSchema schema(std::move(columns));
+  std::string bytes;
+  PostgresOutputWriter writer(&schema, false, [&](const char *data, std::size_t size) { bytes.append(data, size); });
+
+  const std::vector<int64_t> ints{0, -7, std::numeric_limits<int64_t>::max(), std::numeric_limits<int64_t>::min()};
+  const std::vector<double> reals{0.1, -2.0, std::numeric_limits<double>::quiet_NaN(),
+                                  std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity()};
+  const uint32_t int_size = sql::ValUtil::GetSqlSize(type::TypeId::BIGINT);
+  const uint32_t tuple_size = ExecutionContext::ComputeTupleSize(&schema);
+  std::vector<byte> tuples(reals.size() * tuple_size);
+  for (uint32_t i = 0; i < reals.size(); i++) {
+    new (tuples.data() + i * tuple_size) sql::Integer(ints[i % ints.size()]);
+    new (tuples.data() + i * tuple_size + int_size) sql::Real(reals[i]);
+  }
+  writer(tuples.data(), static_cast<uint32_t>(reals.size()), tuple_size);
+
+  const auto rows = ParseDataRows(bytes);
+  ASSERT_EQ(reals.size(), rows.size());
+  EXPECT_EQ("0", rows[0][0]);
+  EXPECT_EQ("-7", rows[1][0]);
+  EXPECT_EQ("9223372036854775807", rows[2][0]);
+  EXPECT_EQ("-9223372036854775808", rows[3][0]);
+  EXPECT_EQ("0.10000000000000001", rows[0][1]);
+  EXPECT_EQ("-2", rows[1][1]);
+  EXPECT_EQ("NaN", rows[2][1]);
+  EXPECT_EQ("Infinity", rows[3][1]);
+  EXPECT_EQ("-Infinity", rows[4][1]);
+}
+
+// NOLINTNEXTLINE
+TEST_F(OutputTest, BinaryDataRowTest) {
+  auto schema = MixedSchema();
+  std::string bytes;
+  PostgresOutputWriter writer(schema.get(), true,
+                              [&](const char *data, std::size_t size) { bytes.append(data, size); });
+
+  const uint32_t tuple_size = ExecutionContext::ComputeTupleSize(schema.get());
+  std::vector<byte> tuples(2 * tuple_size);
+  WriteMixedTuple(tuples.data(), 8, "hello");
+  WriteMixedTuple(tuples.data() + tuple_size, -1, nullptr);
+  writer(tuples.data(), 2, tuple_size);
+
+  const auto rows = ParseDataRows(bytes);
+  ASSERT_EQ(2u, rows.size());
+  EXPECT_EQ(BigEndian<int16_t>(8), rows[0][0]);
+  EXPECT_EQ(std::string(1, '\1'), rows[0][1]);
+  double real = 8.5;
+  uint64_t real_bits;
+  std::memcpy(&real_bits, &real, sizeof(real));
+  EXPECT_EQ(BigEndian<uint64_t>(real_bits), rows[0][2]);
+  // 2008-03-09 is 2990 days after 2000-01-01
+  EXPECT_EQ(BigEndian<int32_t>(2990), rows[0][3]);
+  EXPECT_EQ("hello", rows[0][4]);
+  for (const auto &val : rows[1]) EXPECT_FALSE(val.has_value());
+}
+
+}  // namespace terrier::execution::exec::test
@@ -126,7 +126,7 @@ class ProjectedColumnsIteratorTest : public SqlBasedTest {
         }
       } else {
         // Set all rows to non-null.
-        std::memset(projected_columns_->ColumnNullBitmap(col_offset), 0,
+        std::memset(projected_columns_->ColumnNullBitmap(col_offset), 0xFF,
                     num_tuples / common::Constants::K_BITS_PER_BYTE);
       }
       // Fill up the values.
@@ -450,4 +450,130 @@ TEST_F(ProjectedColumnsIteratorTest, MultipleVectorizedFilterTest) {
   EXPECT_LE(count, 10u);
 }
 
+// NOLINTNEXTLINE
+TEST_F(ProjectedColumnsIteratorTest, BetweenFilterTest) {
+  //
+  // Check col_c BETWEEN 100 AND 500, where both bounds are inclusive
+  //
+
+  ProjectedColumnsIterator iter(GetProjectedColumn());
+  SetSize(common::Constants::K_DEFAULT_VECTOR_SIZE);
+
+  // Compute expected result
+  uint32_t expected = 0;
+  for (; iter.HasNext(); iter.Advance()) {
+    auto val = *iter.Get<int32_t, false>(GetColOffset(ColId::col_c), nullptr);
+    if (val >= 100 && val <= 500) {
+      expected++;
+    }
+  }
+
+  // Filter
+  iter.FilterColBetween(GetColOffset(ColId::col_c), type::TypeId::INTEGER,
+                        ProjectedColumnsIterator::FilterVal{.i_ = 100}, ProjectedColumnsIterator::FilterVal{.i_ = 500});
+
+  // Check
+  uint32_t count = 0;
+  for (; iter.HasNextFiltered(); iter.AdvanceFiltered()) {
+    auto val = *iter.Get<int32_t, false>(GetColOffset(ColId::col_c), nullptr);
+    EXPECT_GE(val, 100);
+    EXPECT_LE(val, 500);
+    count++;
+  }
+
+  EXPECT_EQ(expected, count);
+}
+
+// NOLINTNEXTLINE
+TEST_F(ProjectedColumnsIteratorTest, InFilterTest) {
+  //
+  // Check col_a IN (1, 10, 100, 1000, 10000). col_a is monotonically
+  // increasing from 0, so all but the last value are found.
+  //
+
+  ProjectedColumnsIterator iter(GetProjectedColumn());
+  SetSize(common::Constants::K_DEFAULT_VECTOR_SIZE);
+
+  const int64_t vals[] = {1, 10, 100, 1000, 10000};
+  iter.FilterColIn(GetColOffset(ColId::col_a), type::TypeId::SMALLINT, vals, 5);
+
+  std::vector<int16_t> selected;
+  for (; iter.HasNextFiltered(); iter.AdvanceFiltered()) {
+    selected.push_back(*iter.Get<int16_t, false>(GetColOffset(ColId::col_a), nullptr));
+  }
+
+  EXPECT_EQ((std::vector<int16_t>{1, 10, 100, 1000}), selected);
+}
+
+// NOLINTNEXTLINE
+TEST_F(ProjectedColumnsIteratorTest, LongInFilterTest) {
+  //
+  // Check col_a IN (0, 2, 4, ...) with the longest list of values accepted
+  //
+
+  ProjectedColumnsIterator iter(GetProjectedColumn());
+  SetSize(common::Constants::K_DEFAULT_VECTOR_SIZE);
+
+  std::vector<int64_t> vals;
+  std::vector<int16_t> expected;
+  for (uint32_t i = 0; i < ProjectedColumnsIterator::K_MAX_IN_LIST_SIZE; i++) {
+    vals.push_back(2 * i);
+    expected.push_back(static_cast<int16_t>(2 * i));
+  }
+  iter.FilterColIn(GetColOffset(ColId::col_a), type::TypeId::SMALLINT, vals.data(),
+                   static_cast<uint32_t>(vals.size()));
+
+  std::vector<int16_t> selected;
+  for (; iter.HasNextFiltered(); iter.AdvanceFiltered()) {
+    selected.push_back(*iter.Get<int16_t, false>(GetColOffset(ColId::col_a), nullptr));
+  }
+
+  EXPECT_EQ(expected, selected);
+}
+
+// NOLINTNEXTLINE
+TEST_F(ProjectedColumnsIteratorTest, NullAwareFilterTest) {
+  //
+  // NULLs never pass a filter. Every non-NULL value of col_b passes
+  // col_b >= INT32_MIN, and every non-NULL value of col_d passes
+  // col_d BETWEEN INT64_MIN AND INT64_MAX.
+  //
+
+  ProjectedColumnsIterator iter(GetProjectedColumn());
+  SetSize(common::Constants::K_DEFAULT_VECTOR_SIZE);
+
+  const auto int32_min = std::numeric_limits<int32_t>::min();
+  iter.FilterColByVal<std::greater_equal>(GetColOffset(ColId::col_b), type::TypeId::INTEGER,
+                                          ProjectedColumnsIterator::FilterVal{.i_ = int32_min});
+  EXPECT_EQ(NumTuples() - ColumnData(ColId::col_b).num_nulls_, iter.NumSelected());
+  for (; iter.HasNextFiltered(); iter.AdvanceFiltered()) {
+    bool null = false;
+    iter.Get<int32_t, true>(GetColOffset(ColId::col_b), &null);
+    EXPECT_FALSE(null);
+  }
+
+  // Both filters apply
+  iter.FilterColBetween(GetColOffset(ColId::col_d), type::TypeId::BIGINT,
+                        ProjectedColumnsIterator::FilterVal{.bi_ = std::numeric_limits<int64_t>::min()},
+                        ProjectedColumnsIterator::FilterVal{.bi_ = std::numeric_limits<int64_t>::max()});
+  uint32_t count = 0;
+  for (; iter.HasNextFiltered(); iter.AdvanceFiltered()) {
+    bool null_b = false, null_d = false;
+    iter.Get<int32_t, true>(GetColOffset(ColId::col_b), &null_b);
+    iter.Get<int64_t, true>(GetColOffset(ColId::col_d), &null_d);
+    EXPECT_FALSE(null_b);
+    EXPECT_FALSE(null_d);
+    count++;
+  }
+  EXPECT_EQ(count, iter.NumSelected());
+
+  // The bitmaps used to generate the data have a set bit for every NULL
+  uint32_t expected = 0;
+  for (uint32_t i = 0; i < NumTuples(); i++) {
+    expected += static_cast<uint32_t>(!util::BitUtil::Test(ColumnData(ColId::col_b).nulls_.get(), i) &&
+                                      !util::BitUtil::Test(ColumnData(ColId::col_d).nulls_.get(), i));
+  }
+  EXPECT_EQ(expected, count);
+}
+
 }  // namespace terrier::execution::sql::test
@@ -0,0 +1,201 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <condition_variable>  // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
+#include <stdexcept>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "execution/tpl_test.h"
+
+#include "execution/exec/query_scheduler.h"
+
+namespace terrier::execution::exec::test {
+
+class QuerySchedulerTest : public TplTest {};
+
+// NOLINTNEXTLINE
+TEST_F(QuerySchedulerTest, ParallelForTest) {
+  QueryScheduler scheduler(4);
+  std::vector<std::atomic<uint32_t>> calls(1000);
+  scheduler.ParallelFor(calls.size(), [&](const uint64_t idx) { calls[idx]++; });
+  for (const auto &count : calls) {
+    EXPECT_EQ(1, count);
+  }
+
+  // Nothing to do, or a single call
+  scheduler.ParallelFor(0, [](uint64_t) { FAIL(); });
+  uint32_t single = 0;
+  scheduler.ParallelFor(1, [&](uint64_t) { single++; });
+  EXPECT_EQ(1, single);
+}
+
+// NOLINTNEXTLINE
+TEST_F(QuerySchedulerTest, NestedParallelForTest) {
+  // Morsels waiting for queries of their own run them instead of blocking the workers
+  QueryScheduler scheduler(2);
+  std::atomic<uint32_t> calls{0};
+  scheduler.ParallelFor(8, [&](uint64_t) { scheduler.ParallelFor(100, [&](uint64_t) { calls++; }); });
+  EXPECT_EQ(800, calls);
+}
+
+// NOLINTNEXTLINE
+TEST_F(QuerySchedulerTest, PipelineDependencyTest) {
+  // Two pipelines feed a third, which feeds a fourth
+  QueryScheduler scheduler(4);
+  std::atomic<uint32_t> build_left{0}, build_right{0}, probe{0}, output{0};
+  std::atomic<bool> out_of_order{false};
+
+  auto query = std::make_shared<QueryScheduler::Query>(QueryScheduler::K_DEFAULT_PRIORITY, 0);
+  const auto left = query->AddPipeline(100, [&](uint64_t) { build_left++; });
+  const auto right = query->AddPipeline(50, [&](uint64_t) { build_right++; });
+  const auto join = query->AddPipeline(
+      200,
+      [&](uint64_t) {
+        if (build_left != 100 || build_right != 50) out_of_order = true;
+        probe++;
+      },
+      {left, right});
+  query->AddPipeline(
+      10,
+      [&](uint64_t) {
+        if (probe != 200) out_of_order = true;
+        output++;
+      },
+      {join});
+  scheduler.Submit(query);
+  scheduler.Wait(query.get());
+
+  EXPECT_TRUE(query->IsDone());
+  EXPECT_FALSE(out_of_order);
+  EXPECT_EQ(10, output);
+}
+
+// NOLINTNEXTLINE
+TEST_F(QuerySchedulerTest, MaxDopTest) {
+  QueryScheduler scheduler(4);
+  std::atomic<uint32_t> running{0}, max_running{0};
+
+  auto query = std::make_shared<QueryScheduler::Query>(QueryScheduler::K_DEFAULT_PRIORITY, 2);
+  query->AddPipeline(40, [&](uint64_t) {
+    const uint32_t now = ++running;
+    uint32_t max = max_running;
+    while (now > max && !max_running.compare_exchange_weak(max, now)) {
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    running--;
+  });
+  scheduler.Submit(query);
+  scheduler.Wait(query.get());
+
+  EXPECT_LE(max_running, 2);
+}
+
+// NOLINTNEXTLINE
+TEST_F(QuerySchedulerTest, ParallelForMaxDopTest) {
+  QueryScheduler scheduler(4);
+  std::atomic<uint32_t> running{0}, max_running{0};
+  const auto fn = [&](uint64_t) {
+    const uint32_t now = ++running;
+    uint32_t max = max_running;
+    while (now > max && !max_running.compare_exchange_weak(max, now)) {
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    running--;
+  };
+
+  scheduler.ParallelFor(40, fn, 2);
+  EXPECT_LE(max_running, 2);
+
+  // A single thread runs every call on the calling thread
+  max_running = 0;
+  scheduler.ParallelFor(10, fn, 1);
+  EXPECT_EQ(1, max_running);
+
+  // Calls from a query never use more threads than the query may
+  max_running = 0;
+  auto query = std::make_shared<QueryScheduler::Query>(QueryScheduler::K_DEFAULT_PRIORITY, 2);
+  query->AddPipeline(1, [&](uint64_t) { scheduler.ParallelFor(40, fn, 3); });
+  scheduler.Submit(query);
+  scheduler.Wait(query.get());
+  EXPECT_LE(max_running, 2);
+}
+
+// NOLINTNEXTLINE
+TEST_F(QuerySchedulerTest, PriorityTest) {
+  // A single worker, held by a first query until the others are submitted
+  QueryScheduler scheduler(1);
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool gated = false;
+  bool released = false;
+  auto gate = std::make_shared<QueryScheduler::Query>(QueryScheduler::K_DEFAULT_PRIORITY, 0);
+  gate->AddPipeline(1, [&](uint64_t) {
+    std::unique_lock<std::mutex> lock(mutex);
+    gated = true;
+    cv.notify_all();
+    cv.wait(lock, [&] { return released; });
+  });
+  scheduler.Submit(gate);
+  {
+    // The worker must be held before the other queries arrive, or it may pick one of them first
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [&] { return gated; });
+  }
+
+  // The worker alone runs both queries, recording the order their morsels ran in. Every morsel takes a whole time
+  // slice, so the worker picks a query again after each one.
+  constexpr uint32_t num_morsels = 100;
+  std::vector<uint32_t> order;
+  auto high = std::make_shared<QueryScheduler::Query>(4, 0);
+  auto low = std::make_shared<QueryScheduler::Query>(1, 0);
+  high->AddPipeline(num_morsels, [&](uint64_t) {
+    std::this_thread::sleep_for(QueryScheduler::K_TIME_SLICE);
+    std::lock_guard<std::mutex> lock(mutex);
+    order.push_back(4);
+    cv.notify_all();
+  });
+  low->AddPipeline(num_morsels, [&](uint64_t) {
+    std::this_thread::sleep_for(QueryScheduler::K_TIME_SLICE);
+    std::lock_guard<std::mutex> lock(mutex);
+    order.push_back(1);
+    cv.notify_all();
+  });
+  scheduler.Submit(high);
+  scheduler.Submit(low);
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    released = true;
+    cv.notify_all();
+    cv.wait(lock, [&] { return order.size() == 2 * num_morsels; });
+  }
+  scheduler.Wait(gate.get());
+  scheduler.Wait(high.get());
+  scheduler.Wait(low.get());
+
+  // While both queries had work, the one with four times the priority got about four times the morsels. Which query
+  // runs first when their passes are level is an implementation detail, which the band leaves room for.
+  const auto high_morsels = std::count(order.begin(), order.begin() + 50, 4);
+  EXPECT_GE(high_morsels, 38);
+  EXPECT_LE(high_morsels, 42);
+}
+
+// NOLINTNEXTLINE
+TEST_F(QuerySchedulerTest, ExceptionTest) {
+  QueryScheduler scheduler(2);
+  std::atomic<uint32_t> dependent_calls{0};
+  auto query = std::make_shared<QueryScheduler::Query>(QueryScheduler::K_DEFAULT_PRIORITY, 0);
+  const auto failing = query->AddPipeline(10, [](const uint64_t morsel) {
+    if (morsel == 3) throw std::runtime_error("morsel failed");
+  });
+  query->AddPipeline(10, [&](uint64_t) { dependent_calls++; }, {failing});
+  scheduler.Submit(query);
+
+  EXPECT_THROW(scheduler.Wait(query.get()), std::runtime_error);
+  EXPECT_TRUE(query->IsDone());
+  EXPECT_EQ(0, dependent_calls);
+}
+
+}  // namespace terrier::execution::exec::test
@@ -0,0 +1,127 @@
+#include <vector>
+
+#include "execution/tpl_test.h"
+
+#include "execution/sql/bloom_filter.h"
+#include "execution/sql/projected_columns_iterator.h"
+#include "execution/sql/runtime_filter.h"
+#include "execution/util/hash.h"
+#include "storage/projected_columns.h"
+
+namespace terrier::execution::sql::test {
+
+class RuntimeFilterTest : public TplTest {
+ public:
+  RuntimeFilterTest() : memory_(nullptr) {}
+
+  void SetUp() override {
+    TplTest::SetUp();
+
+    // A vector with a BIGINT key column whose values are their positions
+    const storage::BlockLayout layout({8, 8});
+    const std::vector<storage::col_id_t> col_ids{storage::col_id_t(1)};
+    storage::ProjectedColumnsInitializer pc_initializer(layout, col_ids, common::Constants::K_DEFAULT_VECTOR_SIZE);
+    buffer_ = common::AllocationUtil::AllocateAligned(pc_initializer.ProjectedColumnsSize());
+    projected_columns_ = pc_initializer.Initialize(buffer_);
+    projected_columns_->SetNumTuples(common::Constants::K_DEFAULT_VECTOR_SIZE);
+    auto *keys = reinterpret_cast<int64_t *>(projected_columns_->ColumnStart(0));
+    for (uint32_t idx = 0; idx < common::Constants::K_DEFAULT_VECTOR_SIZE; idx++) {
+      keys[idx] = idx;
+      projected_columns_->ColumnNullBitmap(0)->Set(idx, true);
+    }
+  }
+
+  void TearDown() override {
+    delete[] buffer_;
+    TplTest::TearDown();
+  }
+
+  MemoryPool *Memory() { return &memory_; }
+
+  storage::ProjectedColumns *Vector() { return projected_columns_; }
+
+  // A Bloom filter over the keys in [0, num_keys) that are multiples of step,
+  // hashed as a join build would hash them
+  void BuildBloomFilter(BloomFilter *bloom_filter, const int64_t num_keys, const int64_t step) {
+    bloom_filter->Init(Memory(), static_cast<uint32_t>(num_keys / step));
+    for (int64_t key = 0; key < num_keys; key += step) {
+      bloom_filter->Add(util::Hasher::Hash<util::HashMethod::Crc>(key));
+    }
+  }
+
+ private:
+  MemoryPool memory_;
+  byte *buffer_{nullptr};
+  storage::ProjectedColumns *projected_columns_{nullptr};
+};
+
+// NOLINTNEXTLINE
+TEST_F(RuntimeFilterTest, FilterTest) {
+  BloomFilter bloom_filter;
+  BuildBloomFilter(&bloom_filter, common::Constants::K_DEFAULT_VECTOR_SIZE, 2);
+
+  // Every tenth key is NULL
+  for (uint32_t idx = 0; idx < common::Constants::K_DEFAULT_VECTOR_SIZE; idx += 10) {
+    Vector()->ColumnNullBitmap(0)->Set(idx, false);
+  }
+
+  // The filter is always applied
+  RuntimeFilter filter(&bloom_filter, 0, type::TypeId::BIGINT, bandit::Policy::Kind::FixedAction);
+  ProjectedColumnsIterator pci(Vector());
+  const uint32_t num_selected = filter.Run(&pci);
+  EXPECT_EQ(num_selected, pci.NumSelected());
+  EXPECT_EQ(common::Constants::K_DEFAULT_VECTOR_SIZE - num_selected, filter.NumFiltered());
+
+  // No key with a match is dropped, NULLs never pass, and few keys without a
+  // match pass
+  std::vector<bool> selected(common::Constants::K_DEFAULT_VECTOR_SIZE, false);
+  pci.ForEach([&]() { selected[*pci.Get<int64_t, false>(0, nullptr)] = true; });
+  uint32_t num_false_positives = 0;
+  for (uint32_t key = 0; key < common::Constants::K_DEFAULT_VECTOR_SIZE; key++) {
+    if (key % 10 == 0) {
+      EXPECT_FALSE(selected[key]);
+    } else if (key % 2 == 0) {
+      EXPECT_TRUE(selected[key]);
+    } else {
+      num_false_positives += static_cast<uint32_t>(selected[key]);
+    }
+  }
+  EXPECT_LT(num_false_positives, common::Constants::K_DEFAULT_VECTOR_SIZE / 20);
+}
+
+// NOLINTNEXTLINE
+TEST_F(RuntimeFilterTest, AdaptiveTest) {
+  // Downstream work is expensive enough that timing noise doesn't matter
+  const double probe_cost_ns = 1000.0;
+  const uint32_t num_vectors = 200;
+
+  // A filter that drops almost every tuple is applied
+  {
+    BloomFilter bloom_filter;
+    BuildBloomFilter(&bloom_filter, 64, 1);
+    RuntimeFilter filter(&bloom_filter, 0, type::TypeId::BIGINT, bandit::Policy::Kind::EpsilonGreedy, probe_cost_ns);
+    ProjectedColumnsIterator pci;
+    for (uint32_t vec = 0; vec < num_vectors; vec++) {
+      pci.SetProjectedColumn(Vector());
+      filter.Run(&pci);
+    }
+    EXPECT_TRUE(filter.IsEnabled());
+    EXPECT_GT(filter.NumFiltered(), 0u);
+  }
+
+  // A filter that lets every tuple through is skipped
+  {
+    BloomFilter bloom_filter;
+    BuildBloomFilter(&bloom_filter, common::Constants::K_DEFAULT_VECTOR_SIZE, 1);
+    RuntimeFilter filter(&bloom_filter, 0, type::TypeId::BIGINT, bandit::Policy::Kind::EpsilonGreedy, probe_cost_ns);
+    ProjectedColumnsIterator pci;
+    for (uint32_t vec = 0; vec < num_vectors; vec++) {
+      pci.SetProjectedColumn(Vector());
+      EXPECT_EQ(common::Constants::K_DEFAULT_VECTOR_SIZE, filter.Run(&pci));
+    }
+    EXPECT_FALSE(filter.IsEnabled());
+    EXPECT_EQ(0u, filter.NumFiltered());
+  }
+}
+
+}  // namespace terrier::execution::sql::test
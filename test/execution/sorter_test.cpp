@@ -1,9 +1,12 @@
 #include <algorithm>
+#include <atomic>
+#include <cstddef>
 #include <functional>
 #include <limits>
 #include <memory>
 #include <queue>
 #include <random>
+#include <tuple>
 #include <utility>
 #include <vector>
 
@@ -167,9 +170,10 @@ struct TestTuple {
 };
 
 // Generic function to perform a parallel sort. The input parameter indicates
-// the sizes_ of each thread-local sorter that will be created.
+// the sizes_ of each thread-local sorter that will be created. A non-zero
+// memory budget makes the sorters spill.
 template <uint32_t N>
-void TestParallelSort(const std::vector<uint32_t> &sorter_sizes_) {
+void TestParallelSort(const std::vector<uint32_t> &sorter_sizes_, const uint64_t memory_budget = 0) {
   // Comparison function
   static const auto cmp_fn = [](const void *left, const void *right) {
     const auto *l = reinterpret_cast<const TestTuple<N> *>(left);
@@ -185,6 +189,7 @@ void TestParallelSort(const std::vector<uint32_t> &sorter_sizes_) {
 
   // Create container
   exec::ExecutionContext exec_ctx(catalog::INVALID_DATABASE_OID, nullptr, nullptr, nullptr, nullptr);
+  exec_ctx.GetMemoryPool()->SetMemoryBudget(memory_budget);
   ThreadStateContainer container(exec_ctx.GetMemoryPool());
 
   container.Reset(sizeof(Sorter), init_sorter, destroy_sorter, &exec_ctx);
@@ -210,14 +215,91 @@ void TestParallelSort(const std::vector<uint32_t> &sorter_sizes_) {
   EXPECT_EQ(expected_total_size, main.NumTuples());
 
   // Ensure sortedness
+  uint32_t num_rows = 0;
   const TestTuple<N> *prev = nullptr;
-  for (SorterIterator iter(&main); iter.HasNext(); iter.Next()) {
+  for (SorterIterator iter(&main); iter.HasNext(); iter.Next(), num_rows++) {
     auto *curr = iter.GetRowAs<TestTuple<N>>();
     if (prev != nullptr) {
       EXPECT_LE(cmp_fn(prev, curr), 0);
     }
     prev = curr;
   }
+  EXPECT_EQ(expected_total_size, num_rows);
+}
+
+/**
+ * A tuple whose first eight bytes are a normalized key: the big-endian encoding of its key
+ */
+struct NormalizedKeyTuple {
+  uint64_t normalized_key_;
+  uint64_t key_;
+  uint64_t seq_;
+};
+
+// NOLINTNEXTLINE
+TEST_F(SorterTest, ExternalSortTest) {
+  const uint32_t num_elems = 200000;
+  const auto cmp_fn = [](const void *a, const void *b) -> int32_t {
+    const auto *l = reinterpret_cast<const NormalizedKeyTuple *>(a);
+    const auto *r = reinterpret_cast<const NormalizedKeyTuple *>(b);
+    if (l->key_ != r->key_) return l->key_ < r->key_ ? -1 : 1;
+    return l->seq_ < r->seq_ ? -1 : (l->seq_ == r->seq_ ? 0 : 1);
+  };
+
+  // Keys collide often, so that ties are broken by the comparison function
+  std::uniform_int_distribution<uint64_t> rng(0, num_elems / 4);
+  std::vector<std::pair<uint64_t, uint64_t>> reference;
+  for (uint64_t i = 0; i < num_elems; i++) {
+    reference.emplace_back(rng(generator_), i);
+  }
+
+  for (const uint32_t key_size : {0u, 8u}) {
+    // Room for about a tenth of the input
+    MemoryPool memory(nullptr);
+    memory.SetMemoryBudget(num_elems * sizeof(NormalizedKeyTuple) / 10);
+    Sorter sorter(&memory, cmp_fn, sizeof(NormalizedKeyTuple));
+    sorter.SetNormalizedKeySize(key_size);
+
+    for (const auto &[key, seq] : reference) {
+      auto *elem = reinterpret_cast<NormalizedKeyTuple *>(sorter.AllocInputTuple());
+      elem->normalized_key_ = __builtin_bswap64(key);
+      elem->key_ = key;
+      elem->seq_ = seq;
+    }
+    sorter.Sort();
+
+    EXPECT_TRUE(sorter.HasSpilledRuns());
+    EXPECT_EQ(num_elems, sorter.NumTuples());
+
+    // Two iterators open at once merge independently, one of them twice as fast
+    std::vector<std::pair<uint64_t, uint64_t>> expected = reference;
+    std::sort(expected.begin(), expected.end());
+    SorterIterator slow(&sorter), fast(&sorter);
+    uint32_t i = 0;
+    for (; fast.HasNext(); fast.Next(), i++) {
+      ASSERT_LT(i, num_elems);
+      const auto *row = fast.GetRowAs<NormalizedKeyTuple>();
+      EXPECT_EQ(expected[i].first, row->key_);
+      EXPECT_EQ(expected[i].second, row->seq_);
+      if (i % 2 == 0) {
+        ASSERT_TRUE(slow.HasNext());
+        const auto *slow_row = slow.GetRowAs<NormalizedKeyTuple>();
+        EXPECT_EQ(expected[i / 2].first, slow_row->key_);
+        EXPECT_EQ(expected[i / 2].second, slow_row->seq_);
+        slow.Next();
+      }
+    }
+    EXPECT_EQ(num_elems, i);
+    EXPECT_TRUE(slow.HasNext());
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(SorterTest, ExternalParallelSortTest) {
+  TestParallelSort<2>({100000}, 64 * common::Constants::KB);
+  TestParallelSort<2>({100000, 0, 1000, 50000}, 64 * common::Constants::KB);
+  // Every sorter fits, but not all of them together
+  TestParallelSort<2>({1000, 1000, 1000, 1000}, 40 * common::Constants::KB);
 }
 
 // NOLINTNEXTLINE
@@ -249,4 +331,140 @@ TEST_F(SorterTest, UnbalancedParallelSortTest) {
   }
 }
 
+/**
+ * A tuple of a parallel Top-K, and its comparison functions in both orders
+ */
+struct TopKTuple {
+  int64_t key_;
+  uint64_t thread_id_;
+
+  static int32_t CompareAscending(const void *left, const void *right) {
+    const int64_t l = reinterpret_cast<const TopKTuple *>(left)->key_;
+    const int64_t r = reinterpret_cast<const TopKTuple *>(right)->key_;
+    return l < r ? -1 : (l == r ? 0 : 1);
+  }
+
+  static int32_t CompareDescending(const void *left, const void *right) { return CompareAscending(right, left); }
+};
+
+// NOLINTNEXTLINE
+TEST_F(SorterTest, ParallelTopKThresholdTest) {
+  const uint32_t num_threads = 4, num_tuples_per_thread = 50000;
+  const uint64_t top_k = 100;
+
+  for (const bool ascending : {true, false}) {
+    const Sorter::ComparisonFunction cmp_fn = ascending ? TopKTuple::CompareAscending : TopKTuple::CompareDescending;
+    TopKThreshold threshold(ascending);
+    EXPECT_FALSE(threshold.IsSet());
+
+    // Every thread-local sorter publishes to the same threshold
+    exec::ExecutionContext exec_ctx(catalog::INVALID_DATABASE_OID, nullptr, nullptr, nullptr, nullptr);
+    ThreadStateContainer container(exec_ctx.GetMemoryPool());
+    std::tuple<MemoryPool *, Sorter::ComparisonFunction, TopKThreshold *> args{exec_ctx.GetMemoryPool(), cmp_fn,
+                                                                              &threshold};
+    container.Reset(
+        sizeof(Sorter),
+        [](void *ctx, void *s) {
+          auto [memory, cmp, threshold] =
+              *reinterpret_cast<std::tuple<MemoryPool *, Sorter::ComparisonFunction, TopKThreshold *> *>(ctx);
+          auto *sorter = new (s) Sorter(memory, cmp, sizeof(TopKTuple));
+          sorter->SetTopKThreshold(threshold, offsetof(TopKTuple, key_));
+        },
+        [](UNUSED_ATTRIBUTE void *ctx, void *s) { reinterpret_cast<Sorter *>(s)->~Sorter(); }, &args);
+
+    // Tuples that can't make it into the top-K anymore are dropped before
+    // they reach the sorter, like a scan filtered by the threshold would
+    std::vector<std::vector<int64_t>> keys(num_threads);
+    std::atomic<uint64_t> num_pruned{0};
+    tbb::task_scheduler_init sched(num_threads);
+    tbb::parallel_for(0u, num_threads, [&](const uint32_t thread_id) {
+      auto *sorter = container.AccessThreadStateOfCurrentThreadAs<Sorter>();
+      std::mt19937 generator(thread_id);
+      std::uniform_int_distribution<int64_t> distribution(-1000000, 1000000);
+      for (uint32_t i = 0; i < num_tuples_per_thread; i++) {
+        const int64_t key = distribution(generator);
+        keys[thread_id].push_back(key);
+        if (!threshold.CanQualify(key)) {
+          num_pruned++;
+          continue;
+        }
+        auto *tuple = reinterpret_cast<TopKTuple *>(sorter->AllocInputTupleTopK(top_k));
+        tuple->key_ = key;
+        tuple->thread_id_ = thread_id;
+        sorter->AllocInputTupleTopKFinish(top_k);
+      }
+    });
+
+    Sorter main(exec_ctx.GetMemoryPool(), cmp_fn, sizeof(TopKTuple));
+    main.SortTopKParallel(&container, 0, top_k);
+
+    std::vector<int64_t> expected;
+    for (const auto &thread_keys : keys) {
+      expected.insert(expected.end(), thread_keys.begin(), thread_keys.end());
+    }
+    if (ascending) {
+      std::sort(expected.begin(), expected.end());
+    } else {
+      std::sort(expected.begin(), expected.end(), std::greater<>());
+    }
+
+    // The bound is never tighter than the true K-th key
+    EXPECT_TRUE(threshold.IsSet());
+    EXPECT_TRUE(threshold.CanQualify(expected[top_k - 1]));
+    EXPECT_LT(0u, num_pruned.load());
+
+    EXPECT_TRUE(main.IsSorted());
+    EXPECT_EQ(top_k, main.NumTuples());
+    uint32_t i = 0;
+    for (SorterIterator iter(&main); iter.HasNext(); iter.Next(), i++) {
+      EXPECT_EQ(expected[i], iter.GetRowAs<TopKTuple>()->key_);
+    }
+    EXPECT_EQ(top_k, i);
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(SorterTest, ParallelTopKWithoutHeapsTest) {
+  const std::vector<uint32_t> sorter_sizes = {5000, 20, 3000, 7000};
+  const uint64_t top_k = 100;
+
+  // Thread-local sorters filled with plain inserts hold more than K tuples each
+  exec::ExecutionContext exec_ctx(catalog::INVALID_DATABASE_OID, nullptr, nullptr, nullptr, nullptr);
+  ThreadStateContainer container(exec_ctx.GetMemoryPool());
+  container.Reset(
+      sizeof(Sorter),
+      [](void *ctx, void *s) {
+        new (s) Sorter(reinterpret_cast<MemoryPool *>(ctx), TopKTuple::CompareAscending, sizeof(TopKTuple));
+      },
+      [](UNUSED_ATTRIBUTE void *ctx, void *s) { reinterpret_cast<Sorter *>(s)->~Sorter(); }, exec_ctx.GetMemoryPool());
+
+  tbb::task_scheduler_init sched;
+  tbb::parallel_for_each(sorter_sizes.begin(), sorter_sizes.end(), [&container](const uint32_t sorter_size) {
+    auto *sorter = container.AccessThreadStateOfCurrentThreadAs<Sorter>();
+    for (uint32_t i = 0; i < sorter_size; i++) {
+      auto *tuple = reinterpret_cast<TopKTuple *>(sorter->AllocInputTuple());
+      tuple->key_ = static_cast<int64_t>(sorter_size) - i;
+    }
+  });
+
+  Sorter main(exec_ctx.GetMemoryPool(), TopKTuple::CompareAscending, sizeof(TopKTuple));
+  main.SortTopKParallel(&container, 0, top_k);
+
+  std::vector<int64_t> expected;
+  for (const uint32_t sorter_size : sorter_sizes) {
+    for (uint32_t i = 0; i < sorter_size; i++) {
+      expected.push_back(static_cast<int64_t>(sorter_size) - i);
+    }
+  }
+  std::sort(expected.begin(), expected.end());
+
+  EXPECT_TRUE(main.IsSorted());
+  EXPECT_EQ(top_k, main.NumTuples());
+  uint32_t i = 0;
+  for (SorterIterator iter(&main); iter.HasNext(); iter.Next(), i++) {
+    EXPECT_EQ(expected[i], iter.GetRowAs<TopKTuple>()->key_);
+  }
+  EXPECT_EQ(top_k, i);
+}
+
 }  // namespace terrier::execution::sql::test
@@ -0,0 +1,51 @@
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+#include "execution/tpl_test.h"
+
+#include "execution/sql/spill_file.h"
+
+namespace terrier::execution::sql::test {
+
+class SpillFileTest : public TplTest {};
+
+// NOLINTNEXTLINE
+TEST_F(SpillFileTest, AppendAndRead) {
+  SpillFile file;
+  EXPECT_EQ(0u, file.Size());
+
+  // Write more than the buffer holds, in pieces of different sizes
+  std::vector<uint32_t> data(SpillFile::K_BUFFER_SIZE / sizeof(uint32_t) * 3 + 17);
+  std::iota(data.begin(), data.end(), 0);
+  std::vector<uint64_t> offsets;
+  for (uint32_t pos = 0, piece = 1; pos < data.size(); pos += piece, piece = piece * 2 % 100003) {
+    piece = std::min(piece, static_cast<uint32_t>(data.size()) - pos);
+    offsets.push_back(file.Append(&data[pos], piece * sizeof(uint32_t)));
+    EXPECT_EQ(pos * sizeof(uint32_t), offsets.back());
+  }
+  file.Flush();
+  EXPECT_EQ(data.size() * sizeof(uint32_t), file.Size());
+
+  // Read everything back at once
+  std::vector<uint32_t> read(data.size());
+  file.Read(0, read.data(), read.size() * sizeof(uint32_t));
+  EXPECT_EQ(data, read);
+
+  // And a few values from the middle
+  uint32_t values[4];
+  file.Read(offsets[offsets.size() / 2], values, sizeof(values));
+  for (uint32_t i = 0; i < 4; i++) {
+    EXPECT_EQ(offsets[offsets.size() / 2] / sizeof(uint32_t) + i, values[i]);
+  }
+
+  // Appends after a flush go to the end
+  const uint32_t last = 15721;
+  EXPECT_EQ(data.size() * sizeof(uint32_t), file.Append(&last, sizeof(last)));
+  file.Flush();
+  uint32_t value = 0;
+  file.Read(data.size() * sizeof(uint32_t), &value, sizeof(value));
+  EXPECT_EQ(last, value);
+}
+
+}  // namespace terrier::execution::sql::test
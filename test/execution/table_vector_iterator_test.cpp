@@ -5,7 +5,9 @@
 #include "execution/sql_test.h"
 
 #include "catalog/catalog_defs.h"
+#include "execution/sql/sorter.h"
 #include "execution/sql/table_vector_iterator.h"
+#include "execution/sql/thread_state_container.h"
 #include "execution/util/timer.h"
 
 namespace terrier::execution::sql::test {
@@ -129,4 +131,118 @@ TEST_F(TableVectorIteratorTest, IteratorColOidsTest) {
   EXPECT_EQ(sql::TEST2_SIZE, num_tuples);
 }
 
+// NOLINTNEXTLINE
+TEST_F(TableVectorIteratorTest, TopKThresholdFilterTest) {
+  //
+  // Ensure a scan feeding a Top-K only produces the tuples whose sort key can
+  // still make it into the top K, and skips the vectors without any
+  //
+
+  auto table_oid = exec_ctx_->GetAccessor()->GetTableOid(NSOid(), "test_1");
+  std::array<uint32_t, 1> col_oids{1};
+
+  // The serial column doesn't restart at zero when the tables are regenerated, so bound it relative to its first value
+  int32_t first_val;
+  {
+    TableVectorIterator iter(exec_ctx_.get(), !table_oid, col_oids.data(), static_cast<uint32_t>(col_oids.size()));
+    iter.Init();
+    ASSERT_TRUE(iter.Advance());
+    first_val = *iter.GetProjectedColumnsIterator()->Get<int32_t, false>(0, nullptr);
+  }
+
+  for (const bool ascending : {true, false}) {
+    TopKThreshold threshold(ascending);
+    const int32_t bound = first_val + (ascending ? 99 : sql::TEST1_SIZE - 100);
+    threshold.Tighten(bound);
+
+    TableVectorIterator iter(exec_ctx_.get(), !table_oid, col_oids.data(), static_cast<uint32_t>(col_oids.size()));
+    iter.Init();
+    iter.SetTopKThreshold(&threshold, 0, type::TypeId::INTEGER);
+    ProjectedColumnsIterator *pci = iter.GetProjectedColumnsIterator();
+
+    uint32_t num_tuples = 0, num_vectors = 0;
+    while (iter.Advance()) {
+      EXPECT_TRUE(pci->IsFiltered());
+      pci->ForEach([&]() {
+        auto val = *pci->Get<int32_t, false>(0, nullptr);
+        EXPECT_TRUE(ascending ? val <= bound : val >= bound);
+        num_tuples++;
+      });
+      num_vectors++;
+    }
+    EXPECT_EQ(100u, num_tuples);
+    EXPECT_EQ(1u, num_vectors);
+  }
+
+  // Before a bound is published, nothing is filtered out, but the PCI is still filtered
+  TopKThreshold threshold(true);
+  TableVectorIterator iter(exec_ctx_.get(), !table_oid, col_oids.data(), static_cast<uint32_t>(col_oids.size()));
+  iter.Init();
+  iter.SetTopKThreshold(&threshold, 0, type::TypeId::INTEGER);
+  ProjectedColumnsIterator *pci = iter.GetProjectedColumnsIterator();
+  uint32_t num_tuples = 0;
+  while (iter.Advance()) {
+    EXPECT_TRUE(pci->IsFiltered());
+    for (; pci->HasNextFiltered(); pci->AdvanceFiltered()) {
+      num_tuples++;
+    }
+  }
+  EXPECT_EQ(sql::TEST1_SIZE, num_tuples);
+}
+
+// NOLINTNEXTLINE
+TEST_F(TableVectorIteratorTest, ParallelScanTest) {
+  //
+  // Scan the table in ranges of a single block on the query scheduler, and check that the thread states saw every
+  // tuple exactly once
+  //
+
+  auto table_oid = exec_ctx_->GetAccessor()->GetTableOid(NSOid(), "test_1");
+  std::array<uint32_t, 1> col_oids{1};
+
+  int64_t serial_sum = 0;
+  {
+    TableVectorIterator iter(exec_ctx_.get(), !table_oid, col_oids.data(), static_cast<uint32_t>(col_oids.size()));
+    iter.Init();
+    ProjectedColumnsIterator *pci = iter.GetProjectedColumnsIterator();
+    while (iter.Advance()) {
+      for (; pci->HasNext(); pci->Advance()) {
+        serial_sum += *pci->Get<int32_t, false>(0, nullptr);
+      }
+      pci->Reset();
+    }
+  }
+
+  struct ScanState {
+    int64_t count_;
+    int64_t sum_;
+  };
+  ThreadStateContainer thread_states(exec_ctx_->GetMemoryPool());
+  thread_states.Reset(
+      sizeof(ScanState), [](UNUSED_ATTRIBUTE auto *_, auto *s) { new (s) ScanState{0, 0}; }, nullptr, nullptr);
+
+  auto scan_fn = [](UNUSED_ATTRIBUTE void *query_state, void *thread_state, TableVectorIterator *iter) {
+    auto *state = reinterpret_cast<ScanState *>(thread_state);
+    ProjectedColumnsIterator *pci = iter->GetProjectedColumnsIterator();
+    while (iter->Advance()) {
+      for (; pci->HasNext(); pci->Advance()) {
+        state->count_++;
+        state->sum_ += *pci->Get<int32_t, false>(0, nullptr);
+      }
+      pci->Reset();
+    }
+  };
+  EXPECT_TRUE(TableVectorIterator::ParallelScan(exec_ctx_.get(), !table_oid, col_oids.data(),
+                                                static_cast<uint32_t>(col_oids.size()), nullptr, &thread_states,
+                                                scan_fn, 1));
+
+  int64_t count = 0, sum = 0;
+  thread_states.ForEach<ScanState>([&](ScanState *state) {
+    count += state->count_;
+    sum += state->sum_;
+  });
+  EXPECT_EQ(static_cast<int64_t>(sql::TEST1_SIZE), count);
+  EXPECT_EQ(serial_sum, sum);
+}
+
 }  // namespace terrier::execution::sql::test
@@ -0,0 +1,58 @@
+#include <functional>
+#include <limits>
+
+#include "execution/tpl_test.h"
+
+#include "execution/vm/module.h"
+#include "execution/vm/module_compiler.h"
+
+namespace terrier::execution::vm::test {
+
+class TieringTest : public TplTest {};
+
+// NOLINTNEXTLINE
+TEST_F(TieringTest, HotnessTest) {
+  auto src = R"(
+    fun sum(n: int32) -> int32 {
+      var s: int32 = 0
+      for (var i: int32 = 0; i < n; i = i + 1) {
+        s = s + i
+      }
+      return s
+    }
+    fun test() -> int32 {
+      return sum(1000)
+    })";
+  auto compiler = ModuleCompiler();
+  auto module = compiler.CompileToModule(src);
+  ASSERT_TRUE(module != nullptr);
+
+  // Never compile anything
+  module->SetHotnessThreshold(std::numeric_limits<uint32_t>::max());
+  const FunctionId sum_id = module->GetFuncInfoByName("sum")->Id();
+  const FunctionId test_id = module->GetFuncInfoByName("test")->Id();
+
+  // Nothing is counted when interpreting only
+  std::function<int32_t(int32_t)> sum;
+  EXPECT_TRUE(module->GetFunction("sum", ExecutionMode::Interpret, &sum));
+  EXPECT_EQ(45, sum(10));
+  EXPECT_EQ(0u, module->GetHotness(sum_id));
+
+  // In adaptive mode, the call and the loop's back-edges are counted, in batches. The loop's test is rotated to its
+  // end, so all iterations but the first take a back-edge.
+  EXPECT_TRUE(module->GetFunction("sum", ExecutionMode::Adaptive, &sum));
+  EXPECT_EQ(1025 * 1024 / 2, sum(1025));
+  EXPECT_EQ(1u + 1024u, module->GetHotness(sum_id));
+
+  // Calls from bytecode count as well
+  std::function<int32_t()> test;
+  EXPECT_TRUE(module->GetFunction("test", ExecutionMode::Adaptive, &test));
+  EXPECT_EQ(1000 * 999 / 2, test());
+  EXPECT_EQ(1u, module->GetHotness(test_id));
+  EXPECT_EQ(1u + 1024u + 1u + 768u, module->GetHotness(sum_id));
+
+  EXPECT_FALSE(module->IsTieredUp(sum_id));
+  EXPECT_FALSE(module->IsTieredUp(test_id));
+}
+
+}  // namespace terrier::execution::vm::test
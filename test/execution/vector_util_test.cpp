@@ -1,6 +1,8 @@
 #include <sys/mman.h>
 #include <algorithm>
+#include <numeric>
 #include <random>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -9,6 +11,7 @@
 #include "execution/sql/memory_pool.h"
 #include "execution/util/timer.h"
 #include "execution/util/vector_util.h"
+#include "storage/storage_defs.h"
 
 namespace terrier::execution::util::test {
 
@@ -500,4 +503,172 @@ TEST_F(VectorUtilTest, GatherTest) {
   }
 }
 
+template <typename T>
+void SmallScaleBetweenTest() {
+  constexpr const uint32_t num_elems = 4400;
+  constexpr const uint32_t chunk_size = 1024;
+  constexpr const T lo = 10;
+  constexpr const T hi = 50;
+
+  std::vector<T> arr(num_elems);
+
+  uint32_t actual_count = 0, actual_even_count = 0;
+
+  // Load
+  {
+    std::mt19937 gen;
+    std::uniform_int_distribution<int32_t> dist(0, 100);
+    for (uint32_t i = 0; i < num_elems; i++) {
+      arr[i] = static_cast<T>(dist(gen));
+      if (arr[i] >= lo && arr[i] <= hi) {
+        actual_count++;
+        actual_even_count += static_cast<uint32_t>(i % 2 == 0);
+      }
+    }
+  }
+
+  alignas(common::Constants::CACHELINE_SIZE) uint32_t out[chunk_size] = {0};
+  alignas(common::Constants::CACHELINE_SIZE) uint32_t sel[chunk_size] = {0};
+
+  uint32_t count = 0, even_count = 0;
+  for (uint32_t offset = 0; offset < num_elems; offset += chunk_size) {
+    auto size = std::min(chunk_size, num_elems - offset);
+
+    // Unfiltered
+    auto found = VectorUtil::FilterVectorBetween(&arr[offset], size, lo, hi, out, nullptr);
+    count += found;
+    for (uint32_t i = 0; i < found; i++) {
+      EXPECT_GE(arr[offset + out[i]], lo);
+      EXPECT_LE(arr[offset + out[i]], hi);
+    }
+
+    // Only the even positions
+    uint32_t num_sel = 0;
+    for (uint32_t i = 0; i < size; i += 2) {
+      sel[num_sel++] = i;
+    }
+    even_count += VectorUtil::FilterVectorBetween(&arr[offset], num_sel, lo, hi, out, sel);
+  }
+
+  EXPECT_EQ(actual_count, count);
+  EXPECT_EQ(actual_even_count, even_count);
+}
+
+// NOLINTNEXTLINE
+TEST_F(VectorUtilTest, BetweenFilterTest) {
+  SmallScaleBetweenTest<int8_t>();
+  SmallScaleBetweenTest<uint8_t>();
+  SmallScaleBetweenTest<int16_t>();
+  SmallScaleBetweenTest<uint16_t>();
+  SmallScaleBetweenTest<int32_t>();
+  SmallScaleBetweenTest<uint32_t>();
+  SmallScaleBetweenTest<int64_t>();
+  SmallScaleBetweenTest<uint64_t>();
+  SmallScaleBetweenTest<double>();
+}
+
+// NOLINTNEXTLINE
+TEST_F(VectorUtilTest, InFilterTest) {
+  const uint32_t num_elems = common::Constants::K_DEFAULT_VECTOR_SIZE;
+
+  std::vector<int32_t> arr(num_elems);
+  std::iota(arr.begin(), arr.end(), 0);
+
+  alignas(common::Constants::CACHELINE_SIZE) uint32_t out[common::Constants::K_DEFAULT_VECTOR_SIZE] = {0};
+
+  // Values that aren't in the input are never found, and duplicates are found once
+  const int32_t vals[] = {-1, 7, 1000, 7, 2047, 5000};
+  auto found = VectorUtil::FilterVectorIn(arr.data(), num_elems, vals, 6, out, nullptr);
+  EXPECT_EQ(3u, found);
+  EXPECT_EQ((std::vector<uint32_t>{7, 1000, 2047}), std::vector<uint32_t>(out, out + found));
+
+  // An empty list selects nothing
+  EXPECT_EQ(0u, VectorUtil::FilterVectorIn(arr.data(), num_elems, vals, 0, out, nullptr));
+
+  // With a selection vector
+  const uint32_t sel[] = {0, 7, 8, 2047};
+  found = VectorUtil::FilterVectorIn(arr.data(), 4, vals, 6, out, sel);
+  EXPECT_EQ(2u, found);
+  EXPECT_EQ(7u, out[0]);
+  EXPECT_EQ(2047u, out[1]);
+}
+
+// NOLINTNEXTLINE
+TEST_F(VectorUtilTest, BitmapFilterTest) {
+  const uint32_t num_elems = 1000;
+
+  // Every third bit is set
+  std::vector<uint8_t> bitmap((num_elems + 7) / 8, 0);
+  for (uint32_t i = 0; i < num_elems; i += 3) {
+    bitmap[i / 8] |= static_cast<uint8_t>(1u << (i % 8));
+  }
+
+  alignas(common::Constants::CACHELINE_SIZE) uint32_t out[common::Constants::K_DEFAULT_VECTOR_SIZE] = {0};
+  alignas(common::Constants::CACHELINE_SIZE) uint32_t sel[common::Constants::K_DEFAULT_VECTOR_SIZE] = {0};
+
+  auto found = VectorUtil::FilterByBitmap(bitmap.data(), num_elems, out, nullptr);
+  EXPECT_EQ((num_elems + 2) / 3, found);
+  for (uint32_t i = 0; i < found; i++) {
+    EXPECT_EQ(i * 3, out[i]);
+  }
+
+  // Only the even positions, in place
+  uint32_t num_sel = 0;
+  for (uint32_t i = 0; i < num_elems; i += 2) {
+    sel[num_sel++] = i;
+  }
+  found = VectorUtil::FilterByBitmap(bitmap.data(), num_sel, sel, sel);
+  EXPECT_EQ((num_elems + 5) / 6, found);
+  for (uint32_t i = 0; i < found; i++) {
+    EXPECT_EQ(i * 6, sel[i]);
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(VectorUtilTest, StringFilterTest) {
+  // Inlined and out-of-line strings, sharing prefixes of various lengths
+  std::vector<std::string> strings = {"",       "a",          "ab",           "abc",          "abcd",
+                                      "abcde",  "abcdefghijkl", "abcdefghijklm", "abcdefghijklmn", "abcdefghijklmx",
+                                      "abce",   "xbcdefghijklm", "b",            "abcdefghijkm"};
+  std::vector<storage::VarlenEntry> entries;
+  for (const auto &str : strings) {
+    const auto *content = reinterpret_cast<const byte *>(str.data());
+    const auto size = static_cast<uint32_t>(str.size());
+    entries.push_back(size <= storage::VarlenEntry::InlineThreshold()
+                          ? storage::VarlenEntry::CreateInline(content, size)
+                          : storage::VarlenEntry::Create(const_cast<byte *>(content), size, false));
+  }
+  const auto num_elems = static_cast<uint32_t>(entries.size());
+
+  alignas(common::Constants::CACHELINE_SIZE) uint32_t out[common::Constants::K_DEFAULT_VECTOR_SIZE] = {0};
+
+  // Compare with scalar versions
+  for (const auto &val : strings) {
+    const auto *val_content = reinterpret_cast<const byte *>(val.data());
+    const auto val_len = static_cast<uint32_t>(val.size());
+
+    std::vector<uint32_t> expected_eq, expected_prefix;
+    for (uint32_t i = 0; i < num_elems; i++) {
+      if (strings[i] == val) {
+        expected_eq.push_back(i);
+      }
+      if (strings[i].compare(0, val.size(), val) == 0) {
+        expected_prefix.push_back(i);
+      }
+    }
+
+    auto found = VectorUtil::FilterStringEq(entries.data(), num_elems, val_content, val_len, out, nullptr);
+    EXPECT_EQ(expected_eq, std::vector<uint32_t>(out, out + found)) << "= '" << val << "'";
+
+    found = VectorUtil::FilterStringPrefix(entries.data(), num_elems, val_content, val_len, out, nullptr);
+    EXPECT_EQ(expected_prefix, std::vector<uint32_t>(out, out + found)) << "LIKE '" << val << "%'";
+  }
+
+  // With a selection vector
+  const uint32_t sel[] = {3, 4, 5, 10};
+  const auto *prefix = reinterpret_cast<const byte *>("abcd");
+  auto found = VectorUtil::FilterStringPrefix(entries.data(), 4, prefix, 4, out, sel);
+  EXPECT_EQ((std::vector<uint32_t>{4, 5}), std::vector<uint32_t>(out, out + found));
+}
+
 }  // namespace terrier::execution::util::test
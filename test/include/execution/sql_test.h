@@ -50,6 +50,8 @@ class SqlBasedTest : public TplTest {
     gc_->PerformGarbageCollection();
   }
 
+  catalog::db_oid_t DBOid() { return test_db_oid_; }
+
   catalog::namespace_oid_t NSOid() { return test_ns_oid_; }
 
   storage::BlockStore *BlockStore() { return block_store_.get(); }
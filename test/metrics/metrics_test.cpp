@@ -4,13 +4,20 @@
 #include <thread>  //NOLINT
 #include <unordered_map>
 #include <utility>
+#include "common/constants.h"
+#include "common/thread_context.h"
+#include "execution/sql/memory_pool.h"
+#include "execution/sql/memory_tracker.h"
 #include "main/db_main.h"
 #include "metrics/metrics_manager.h"
 #include "metrics/metrics_store.h"
 #include "settings/settings_callbacks.h"
 #include "settings/settings_manager.h"
+#include "storage/garbage_collector.h"
+#include "storage/index/index_builder.h"
 #include "storage/sql_table.h"
 #include "test_util/catalog_test_util.h"
+#include "test_util/storage_test_util.h"
 #include "test_util/test_harness.h"
 #include "transaction/transaction_defs.h"
 #include "transaction/transaction_manager.h"
@@ -184,4 +191,127 @@ TEST_F(MetricsTests, TransactionCSVTest) {
 
   metrics_manager_->UnregisterThread();
 }
+
+/**
+ *  Testing execution metric stats collection and persistence, single thread
+ */
+// NOLINTNEXTLINE
+TEST_F(MetricsTests, ExecutionCSVTest) {
+  for (const auto &file : metrics::ExecutionMetricRawData::FILES) unlink(std::string(file).c_str());
+  const settings::setter_callback_fn setter_callback = MetricsTests::EmptySetterCallback;
+  std::shared_ptr<common::ActionContext> action_context =
+      std::make_shared<common::ActionContext>(common::action_id_t(1));
+  settings_manager_->SetBool(settings::Param::metrics_execution, true, action_context, setter_callback);
+
+  metrics_manager_->RegisterThread();
+
+  // A query's memory is recorded once it finished executing
+  execution::sql::MemoryTracker tracker;
+  execution::sql::MemoryPool pool(&tracker);
+  pool.SetMemoryBudget(common::Constants::MB);
+  const std::size_t size = 2 * execution::sql::MemoryTracker::K_FLUSH_BYTES;
+  auto *buf = pool.Allocate(size, false);
+  pool.Deallocate(buf, size);
+  common::thread_context.metrics_store_->RecordQueryData(10, tracker.GetPeakAllocatedSize(),
+                                                         tracker.GetAllocatedSize(), tracker.GetNumAllocations(),
+                                                         pool.GetMemoryBudget());
+
+  metrics_manager_->Aggregate();
+  const auto aggregated_data = reinterpret_cast<ExecutionMetricRawData *>(
+      metrics_manager_->AggregatedMetrics().at(static_cast<uint8_t>(MetricsComponent::EXECUTION)).get());
+  EXPECT_NE(aggregated_data, nullptr);
+  EXPECT_EQ(aggregated_data->query_data_.size(), 1);  // 1 query recorded
+  EXPECT_EQ(aggregated_data->query_data_.begin()->peak_bytes_, size);
+  EXPECT_EQ(aggregated_data->query_data_.begin()->allocated_bytes_, 0);
+  EXPECT_EQ(aggregated_data->query_data_.begin()->num_allocations_, 1);
+  EXPECT_EQ(aggregated_data->query_data_.begin()->budget_bytes_, common::Constants::MB);
+  metrics_manager_->ToCSV();
+  EXPECT_EQ(aggregated_data->query_data_.size(), 0);
+
+  metrics_manager_->UnregisterThread();
+}
+
+/**
+ *  Testing garbage collection metric stats collection and persistence, single thread
+ */
+// NOLINTNEXTLINE
+TEST_F(MetricsTests, GarbageCollectionCSVTest) {
+  for (const auto &file : metrics::GarbageCollectionMetricRawData::FILES) unlink(std::string(file).c_str());
+  const settings::setter_callback_fn setter_callback = MetricsTests::EmptySetterCallback;
+  std::shared_ptr<common::ActionContext> action_context =
+      std::make_shared<common::ActionContext>(common::action_id_t(1));
+  settings_manager_->SetBool(settings::Param::metrics_gc, true, action_context, setter_callback);
+
+  metrics_manager_->RegisterThread();
+
+  // Drive our own GC on this thread so the metrics land in this thread's MetricsStore
+  transaction::TimestampManager timestamp_manager;
+  transaction::DeferredActionManager deferred_action_manager(&timestamp_manager);
+  storage::RecordBufferSegmentPool buffer_pool{10000, 10000};
+  transaction::TransactionManager txn_manager(&timestamp_manager, &deferred_action_manager, &buffer_pool, true,
+                                             DISABLED);
+  storage::GarbageCollector gc(&timestamp_manager, &deferred_action_manager, &txn_manager, DISABLED);
+
+  std::vector<catalog::IndexSchema::Column> keycols;
+  keycols.emplace_back("", type::TypeId::INTEGER, false,
+                       parser::ColumnValueExpression(CatalogTestUtil::TEST_DB_OID, CatalogTestUtil::TEST_TABLE_OID,
+                                                     catalog::col_oid_t(0)));
+  StorageTestUtil::ForceOid(&(keycols[0]), catalog::indexkeycol_oid_t(1));
+  const catalog::IndexSchema index_schema(keycols, storage::index::IndexType::BWTREE, false, false, false, true);
+  auto *const index = (storage::index::IndexBuilder().SetKeySchema(index_schema)).Build();
+  gc.RegisterIndexForGC(common::ManagedPointer(index));
+
+  auto *const key_buffer =
+      common::AllocationUtil::AllocateAligned(index->GetProjectedRowInitializer().ProjectedRowSize());
+  auto *const key = index->GetProjectedRowInitializer().InitializeRow(key_buffer);
+
+  // Deleting enough keys should make the GC both remove them and invoke the index's own garbage collection
+  const auto num_keys = static_cast<int32_t>(storage::INDEX_GC_DEAD_ENTRIES_THRESHOLD);
+  std::vector<storage::TupleSlot> slots;
+  auto *const insert_txn = txn_manager.BeginTransaction();
+  for (int32_t i = 0; i < num_keys; i++) {
+    auto *const insert_redo =
+        insert_txn->StageWrite(CatalogTestUtil::TEST_DB_OID, CatalogTestUtil::TEST_TABLE_OID, tuple_initializer_);
+    *reinterpret_cast<int32_t *>(insert_redo->Delta()->AccessForceNotNull(0)) = i;
+    slots.emplace_back(sql_table_->Insert(insert_txn, insert_redo));
+    *reinterpret_cast<int32_t *>(key->AccessForceNotNull(0)) = i;
+    EXPECT_TRUE(index->Insert(insert_txn, *key, slots.back()));
+  }
+  txn_manager.Commit(insert_txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+
+  auto *const delete_txn = txn_manager.BeginTransaction();
+  for (int32_t i = 0; i < num_keys; i++) {
+    delete_txn->StageDelete(CatalogTestUtil::TEST_DB_OID, CatalogTestUtil::TEST_TABLE_OID, slots[i]);
+    EXPECT_TRUE(sql_table_->Delete(delete_txn, slots[i]));
+    *reinterpret_cast<int32_t *>(key->AccessForceNotNull(0)) = i;
+    index->Delete(delete_txn, *key, slots[i]);
+  }
+  txn_manager.Commit(delete_txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+
+  gc.PerformGarbageCollection();
+
+  metrics_manager_->Aggregate();
+  const auto aggregated_data = reinterpret_cast<GarbageCollectionMetricRawData *>(
+      metrics_manager_->AggregatedMetrics().at(static_cast<uint8_t>(MetricsComponent::GARBAGECOLLECTION)).get());
+  EXPECT_NE(aggregated_data, nullptr);
+  EXPECT_EQ(aggregated_data->index_data_.size(), 1);  // 1 index had GC work
+  EXPECT_EQ(aggregated_data->index_data_.begin()->num_deletes_, num_keys);
+  EXPECT_TRUE(aggregated_data->index_data_.begin()->consolidated_);
+  metrics_manager_->ToCSV();
+  EXPECT_EQ(aggregated_data->index_data_.size(), 0);
+
+  // Nothing left to remove, and not enough runs have passed to force the index's own garbage collection
+  gc.PerformGarbageCollection();
+
+  metrics_manager_->Aggregate();
+  EXPECT_EQ(aggregated_data->index_data_.size(), 0);
+
+  gc.UnregisterIndexForGC(common::ManagedPointer(index));
+  gc.PerformGarbageCollection();
+  gc.PerformGarbageCollection();
+  delete[] key_buffer;
+  delete index;
+
+  metrics_manager_->UnregisterThread();
+}
 }  // namespace terrier::metrics
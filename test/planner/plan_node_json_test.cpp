@@ -123,12 +123,15 @@ TEST(PlanNodeJsonTest, AggregatePlanNodeJsonTest) {
   auto agg_term = std::make_unique<parser::AggregateExpression>(parser::ExpressionType::AGGREGATE_COUNT,
                                                                 std::move(children), false);
   auto plan_predicate = PlanNodeJsonTest::BuildDummyPredicate();
+  auto group_by_term = std::make_unique<parser::ColumnValueExpression>("table", "column");
   AggregatePlanNode::Builder builder;
-  auto plan_node = builder.SetOutputSchema(PlanNodeJsonTest::BuildDummyOutputSchema())
-                       .SetAggregateStrategyType(AggregateStrategyType::HASH)
-                       .SetHavingClausePredicate(common::ManagedPointer(plan_predicate))
-                       .AddAggregateTerm(common::ManagedPointer(agg_term))
-                       .Build();
+  auto plan_node =
+      builder.SetOutputSchema(PlanNodeJsonTest::BuildDummyOutputSchema())
+          .SetAggregateStrategyType(AggregateStrategyType::HASH)
+          .SetHavingClausePredicate(common::ManagedPointer(plan_predicate))
+          .AddAggregateTerm(common::ManagedPointer(agg_term))
+          .AddGroupByTerm(common::ManagedPointer(group_by_term).CastManagedPointerTo<parser::AbstractExpression>())
+          .Build();
 
   // Serialize to Json
   auto json = plan_node->ToJson();
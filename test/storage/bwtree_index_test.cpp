@@ -3,6 +3,7 @@
 #include <limits>
 #include <map>
 #include <random>
+#include <utility>
 #include <vector>
 #include "parser/expression/column_value_expression.h"
 #include "portable_endian/portable_endian.h"
@@ -332,6 +333,67 @@ TEST_F(BwTreeIndexTests, ScanAscending) {
   txn_manager_->Commit(scan_txn, transaction::TransactionUtil::EmptyCallback, nullptr);
 }
 
+/**
+ * Tests that splitting a key range into sub-ranges and scanning each of them returns the same results, in the same
+ * order, as one ascending scan over the whole range
+ */
+// NOLINTNEXTLINE
+TEST_F(BwTreeIndexTests, ScanAscendingPartition) {
+  // populate index with enough even keys to have several levels of inner nodes
+  const int32_t num_keys = 100000;
+  auto *const insert_txn = txn_manager_->BeginTransaction();
+  for (int32_t i = 0; i < 2 * num_keys; i += 2) {
+    auto *const insert_redo =
+        insert_txn->StageWrite(CatalogTestUtil::TEST_DB_OID, CatalogTestUtil::TEST_TABLE_OID, tuple_initializer_);
+    auto *const insert_tuple = insert_redo->Delta();
+    *reinterpret_cast<int32_t *>(insert_tuple->AccessForceNotNull(0)) = i;
+    const auto tuple_slot = sql_table_->Insert(insert_txn, insert_redo);
+
+    auto *const insert_key = default_index_->GetProjectedRowInitializer().InitializeRow(key_buffer_1_);
+    *reinterpret_cast<int32_t *>(insert_key->AccessForceNotNull(0)) = i;
+
+    EXPECT_TRUE(default_index_->Insert(insert_txn, *insert_key, tuple_slot));
+  }
+  txn_manager_->Commit(insert_txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+
+  auto *const scan_txn = txn_manager_->BeginTransaction();
+
+  std::vector<storage::TupleSlot> expected, results, partition_results;
+  IndexRangePartitions partitions;
+
+  auto *const low_key_pr = default_index_->GetProjectedRowInitializer().InitializeRow(key_buffer_1_);
+  auto *const high_key_pr = default_index_->GetProjectedRowInitializer().InitializeRow(key_buffer_2_);
+
+  for (const auto &range : std::vector<std::pair<int32_t, int32_t>>{{-1, 2 * num_keys}, {1001, 150000}, {8, 12}}) {
+    *reinterpret_cast<int32_t *>(low_key_pr->AccessForceNotNull(0)) = range.first;
+    *reinterpret_cast<int32_t *>(high_key_pr->AccessForceNotNull(0)) = range.second;
+    expected.clear();
+    default_index_->ScanAscending(*scan_txn, *low_key_pr, *high_key_pr, &expected);
+
+    for (const uint32_t num_partitions : {1, 4, 16}) {
+      EXPECT_TRUE(default_index_->PartitionRange(*low_key_pr, *high_key_pr, num_partitions, &partitions));
+      EXPECT_GE(partitions.size(), 2);
+      EXPECT_LE(partitions.size(), num_partitions + 1);
+
+      results.clear();
+      for (uint32_t partition = 0; partition + 1 < partitions.size(); partition++) {
+        partition_results.clear();
+        default_index_->ScanAscendingPartition(*scan_txn, partitions, partition, &partition_results);
+        results.insert(results.end(), partition_results.begin(), partition_results.end());
+      }
+      EXPECT_EQ(expected, results);
+    }
+  }
+
+  // a tree this large has enough separators to split the whole key range as many ways as asked
+  *reinterpret_cast<int32_t *>(low_key_pr->AccessForceNotNull(0)) = 0;
+  *reinterpret_cast<int32_t *>(high_key_pr->AccessForceNotNull(0)) = 2 * num_keys;
+  EXPECT_TRUE(default_index_->PartitionRange(*low_key_pr, *high_key_pr, 16, &partitions));
+  EXPECT_EQ(partitions.size(), 17);
+
+  txn_manager_->Commit(scan_txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+}
+
 /**
  * Tests basic scan behavior using various windows to scan over (some out of of bounds of keyspace, some matching
  * exactly, etc.)
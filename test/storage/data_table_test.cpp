@@ -138,6 +138,14 @@ class RandomDataTableTestObject {
     table_.Scan(txn, begin, buffer);
   }
 
+  void Scan(storage::DataTable::SlotIterator *begin, const storage::DataTable::SlotIterator &end,
+            const transaction::timestamp_t timestamp, storage::ProjectedColumns *buffer,
+            storage::RecordBufferSegmentPool *buffer_pool) {
+    auto *txn = new transaction::TransactionContext(timestamp, timestamp, buffer_pool, DISABLED);
+    loose_txns_.push_back(txn);
+    table_.Scan(txn, begin, end, buffer);
+  }
+
   storage::DataTable &GetTable() { return table_; }
 
  private:
@@ -228,6 +236,57 @@ TEST_F(DataTableTests, SimpleSequentialScan) {
   }
 }
 
+// Insert a few blocks worth of tuples, split the table into ranges of blocks and scan every range on its own. Every
+// tuple is scanned exactly once, from the range holding its block.
+// NOLINTNEXTLINE
+TEST_F(DataTableTests, BlockRangeScan) {
+  const uint32_t num_iterations = 10;
+  const uint16_t max_columns = 20;
+  for (uint32_t iteration = 0; iteration < num_iterations; ++iteration) {
+    RandomDataTableTestObject tested(&block_store_, max_columns, null_ratio_(generator_), &generator_);
+    const uint32_t num_slots = tested.Layout().NumSlots();
+    // The first iteration fills its last block, the others leave it partly empty
+    const uint32_t num_inserts =
+        3 * num_slots + (iteration == 0 ? num_slots : std::uniform_int_distribution<uint32_t>(1, num_slots)(generator_));
+    // bypass the test object to be more efficient with buffers
+    transaction::timestamp_t timestamp(0);
+    auto *txn = new transaction::TransactionContext(timestamp, timestamp, &buffer_pool_, DISABLED);
+    for (uint32_t i = 0; i < num_inserts; ++i) tested.InsertRandomTuple(txn, &generator_, &buffer_pool_);
+
+    std::vector<storage::col_id_t> all_cols = StorageTestUtil::ProjectionListAllColumns(tested.Layout());
+    storage::ProjectedColumnsInitializer initializer(tested.Layout(), all_cols, num_slots);
+    auto *buffer = common::AllocationUtil::AllocateAligned(initializer.ProjectedColumnsSize());
+    storage::ProjectedColumns *columns = initializer.Initialize(buffer);
+
+    for (const uint32_t blocks_per_range : {1u, 3u}) {
+      const auto boundaries = tested.GetTable().BlockRangeBoundaries(blocks_per_range);
+      EXPECT_EQ((4 + blocks_per_range - 1) / blocks_per_range + 1, boundaries.size());
+      EXPECT_EQ(tested.GetTable().begin(), boundaries.front());
+      EXPECT_EQ(tested.GetTable().end(), boundaries.back());
+
+      std::unordered_map<storage::TupleSlot, uint32_t> scanned;
+      for (uint32_t range = 0; range + 1 < boundaries.size(); range++) {
+        auto it = boundaries[range];
+        while (it != boundaries[range + 1]) {
+          tested.Scan(&it, boundaries[range + 1], transaction::timestamp_t(1), columns, &buffer_pool_);
+          for (uint32_t i = 0; i < columns->NumTuples(); i++) {
+            const storage::TupleSlot slot = columns->TupleSlots()[i];
+            // A range only holds the tuples of its own blocks
+            EXPECT_EQ(range, scanned.size() / (blocks_per_range * num_slots));
+            EXPECT_TRUE(scanned.emplace(slot, range).second);
+            storage::ProjectedColumns::RowView stored = columns->InterpretAsRow(i);
+            const storage::ProjectedRow *ref = tested.GetReferenceVersionedTuple(slot, transaction::timestamp_t(1));
+            EXPECT_TRUE(StorageTestUtil::ProjectionListEqualShallow(tested.Layout(), &stored, ref));
+          }
+        }
+      }
+      EXPECT_EQ(num_inserts, scanned.size());
+    }
+    delete[] buffer;
+    delete txn;
+  }
+}
+
 // Generates a random table layout and coin flip bias for an attribute being null, inserts 1 random tuple into an empty
 // DataTable. Then, randomly updates the tuple num_updates times. Finally, Selects at each timestamp to verify that the
 // delta chain produces the correct tuple. Repeats for num_iterations.
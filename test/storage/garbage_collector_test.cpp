@@ -1,11 +1,17 @@
 #include "storage/garbage_collector.h"
 #include <cstring>
+#include <map>
 #include <unordered_map>
 #include <utility>
 #include <vector>
+#include "catalog/index_schema.h"
 #include "common/object_pool.h"
+#include "parser/expression/column_value_expression.h"
 #include "storage/data_table.h"
+#include "storage/index/index_builder.h"
+#include "storage/sql_table.h"
 #include "storage/storage_util.h"
+#include "test_util/catalog_test_util.h"
 #include "test_util/data_table_test_util.h"
 #include "test_util/storage_test_util.h"
 #include "test_util/test_harness.h"
@@ -79,12 +85,91 @@ class GarbageCollectorDataTableTestObject {
   bool select_result_;
 };
 
+// An index over a single INTEGER key that ignores visibility, so that tests can see exactly which entries the GC
+// removed from it, and that counts how often its own garbage collection is invoked
+class GarbageCollectorTestIndex : public storage::index::Index {
+ public:
+  explicit GarbageCollectorTestIndex(catalog::IndexSchema key_schema)
+      : storage::index::Index(storage::index::IndexMetadata(std::move(key_schema))) {}
+
+  storage::index::IndexType Type() const override { return storage::index::IndexType::HASHMAP; }
+
+  void PerformGarbageCollection() override { num_consolidations_++; }
+
+  uint32_t DeleteBatch(const storage::index::IndexDeleteBatch &batch) override {
+    num_batches_++;
+    uint32_t num_deletes = 0;
+    for (const auto &entry : batch) {
+      int32_t key;
+      std::memcpy(&key, entry.first, sizeof(int32_t));
+      const auto range = entries_.equal_range(key);
+      for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == entry.second) {
+          entries_.erase(it);
+          num_deletes++;
+          break;
+        }
+      }
+    }
+    return num_deletes;
+  }
+
+  bool Insert(transaction::TransactionContext *const txn, const storage::ProjectedRow &tuple,
+              const storage::TupleSlot location) override {
+    entries_.emplace(Key(tuple), location);
+    return true;
+  }
+
+  bool InsertUnique(transaction::TransactionContext *const txn, const storage::ProjectedRow &tuple,
+                    const storage::TupleSlot location) override {
+    return Insert(txn, tuple, location);
+  }
+
+  void Delete(transaction::TransactionContext *const txn, const storage::ProjectedRow &tuple,
+              const storage::TupleSlot location) override {
+    StageDelete(txn, Key(tuple), location);
+  }
+
+  void ScanKey(const transaction::TransactionContext &txn, const storage::ProjectedRow &key,
+               std::vector<storage::TupleSlot> *value_list) override {
+    const auto range = entries_.equal_range(Key(key));
+    for (auto it = range.first; it != range.second; ++it) value_list->push_back(it->second);
+  }
+
+  uint32_t num_batches_ = 0;
+  uint32_t num_consolidations_ = 0;
+
+ private:
+  static int32_t Key(const storage::ProjectedRow &tuple) {
+    return *reinterpret_cast<const int32_t *>(tuple.AccessWithNullCheck(0));
+  }
+
+  std::multimap<int32_t, storage::TupleSlot> entries_;
+};
+
 struct GarbageCollectorTests : public ::terrier::TerrierTest {
   storage::BlockStore block_store_{100, 100};
   storage::RecordBufferSegmentPool buffer_pool_{10000, 10000};
   std::default_random_engine generator_;
   const uint32_t num_iterations_ = 100;
   const uint16_t max_columns_ = 100;
+
+  // An index schema over a single INTEGER column
+  static catalog::IndexSchema IntegerKeySchema(const storage::index::IndexType type) {
+    std::vector<catalog::IndexSchema::Column> keycols;
+    keycols.emplace_back("", type::TypeId::INTEGER, false,
+                         parser::ColumnValueExpression(CatalogTestUtil::TEST_DB_OID, CatalogTestUtil::TEST_TABLE_OID,
+                                                       catalog::col_oid_t(1)));
+    StorageTestUtil::ForceOid(&(keycols[0]), catalog::indexkeycol_oid_t(1));
+    return catalog::IndexSchema(keycols, type, false, false, false, true);
+  }
+
+  // Set the key of an index ProjectedRow over a single INTEGER column
+  static storage::ProjectedRow *IntegerKey(const storage::index::Index &index, byte *const buffer, const int32_t key) {
+    auto *const pr = index.GetProjectedRowInitializer().InitializeRow(buffer);
+    *reinterpret_cast<int32_t *>(pr->AccessForceNotNull(0)) = key;
+    return pr;
+  }
 };
 
 // Run a single txn that performs an Insert. Confirm that it takes 2 GC cycles to process this tuple.
@@ -674,4 +759,192 @@ TEST_F(GarbageCollectorTests, InsertUpdate1) {
     EXPECT_EQ(std::make_pair(2U, 0U), gc.PerformGarbageCollection());
   }
 }
+
+// Commit index deletes, and confirm that the GC removes them from the index in one batch once it unlinks the txn
+// NOLINTNEXTLINE
+TEST_F(GarbageCollectorTests, CommitIndexDelete) {
+  transaction::TimestampManager timestamp_manager;
+  transaction::TransactionManager txn_manager(&timestamp_manager, DISABLED, &buffer_pool_, true, DISABLED);
+  storage::GarbageCollector gc(&timestamp_manager, DISABLED, &txn_manager, DISABLED);
+  GarbageCollectorTestIndex index(IntegerKeySchema(storage::index::IndexType::HASHMAP));
+  auto *const key_buffer =
+      common::AllocationUtil::AllocateAligned(index.GetProjectedRowInitializer().ProjectedRowSize());
+  const uint32_t num_keys = 10;
+
+  auto *txn0 = txn_manager.BeginTransaction();
+  for (uint32_t i = 0; i < num_keys; i++) {
+    index.Insert(txn0, *IntegerKey(index, key_buffer, i), storage::TupleSlot(nullptr, i));
+  }
+  txn_manager.Commit(txn0, transaction::TransactionUtil::EmptyCallback, nullptr);
+
+  // Delete the even keys
+  auto *txn1 = txn_manager.BeginTransaction();
+  for (uint32_t i = 0; i < num_keys; i += 2) {
+    index.Delete(txn1, *IntegerKey(index, key_buffer, i), storage::TupleSlot(nullptr, i));
+  }
+
+  // Only the inserting txn is unlinked (and freed right away, as it wrote no undo records), nothing can be removed
+  // before the deleting txn commits
+  EXPECT_EQ(std::make_pair(0U, 1U), gc.PerformGarbageCollection());
+  EXPECT_EQ(0, index.num_batches_);
+  std::vector<storage::TupleSlot> results;
+  index.ScanKey(*txn1, *IntegerKey(index, key_buffer, 0), &results);
+  EXPECT_EQ(1, results.size());
+  results.clear();
+
+  txn_manager.Commit(txn1, transaction::TransactionUtil::EmptyCallback, nullptr);
+
+  // Unlinking the deleting txn removes its deletes in a single batch
+  EXPECT_EQ(std::make_pair(0U, 1U), gc.PerformGarbageCollection());
+  EXPECT_EQ(1, index.num_batches_);
+  EXPECT_EQ(std::make_pair(1U, 0U), gc.PerformGarbageCollection());
+  EXPECT_EQ(1, index.num_batches_);
+
+  auto *txn2 = txn_manager.BeginTransaction();
+  for (uint32_t i = 0; i < num_keys; i++) {
+    index.ScanKey(*txn2, *IntegerKey(index, key_buffer, i), &results);
+    EXPECT_EQ(i % 2 == 0 ? 0 : 1, results.size());
+    results.clear();
+  }
+  txn_manager.Commit(txn2, transaction::TransactionUtil::EmptyCallback, nullptr);
+  gc.PerformGarbageCollection();
+  delete[] key_buffer;
+}
+
+// Abort index deletes, and confirm that the GC drops them without touching the index
+// NOLINTNEXTLINE
+TEST_F(GarbageCollectorTests, AbortIndexDelete) {
+  transaction::TimestampManager timestamp_manager;
+  transaction::TransactionManager txn_manager(&timestamp_manager, DISABLED, &buffer_pool_, true, DISABLED);
+  storage::GarbageCollector gc(&timestamp_manager, DISABLED, &txn_manager, DISABLED);
+  GarbageCollectorTestIndex index(IntegerKeySchema(storage::index::IndexType::HASHMAP));
+  auto *const key_buffer =
+      common::AllocationUtil::AllocateAligned(index.GetProjectedRowInitializer().ProjectedRowSize());
+
+  auto *txn0 = txn_manager.BeginTransaction();
+  index.Insert(txn0, *IntegerKey(index, key_buffer, 15721), storage::TupleSlot(nullptr, 1));
+  txn_manager.Commit(txn0, transaction::TransactionUtil::EmptyCallback, nullptr);
+
+  auto *txn1 = txn_manager.BeginTransaction();
+  index.Delete(txn1, *IntegerKey(index, key_buffer, 15721), storage::TupleSlot(nullptr, 1));
+  txn_manager.Abort(txn1);
+
+  // Both txns are unlinked, but the aborted txn's staged delete never reaches the index
+  EXPECT_EQ(std::make_pair(0U, 2U), gc.PerformGarbageCollection());
+  EXPECT_EQ(std::make_pair(1U, 0U), gc.PerformGarbageCollection());
+  EXPECT_EQ(0, index.num_batches_);
+
+  auto *txn2 = txn_manager.BeginTransaction();
+  std::vector<storage::TupleSlot> results;
+  index.ScanKey(*txn2, *IntegerKey(index, key_buffer, 15721), &results);
+  ASSERT_EQ(1, results.size());
+  EXPECT_EQ(storage::TupleSlot(nullptr, 1), results[0]);
+  txn_manager.Commit(txn2, transaction::TransactionUtil::EmptyCallback, nullptr);
+  gc.PerformGarbageCollection();
+  delete[] key_buffer;
+}
+
+// Confirm that a registered index has its own garbage collection invoked once it has accumulated
+// INDEX_GC_DEAD_ENTRIES_THRESHOLD dead entries, or after INDEX_GC_MAX_DEFERRED_RUNS GC runs without it
+// NOLINTNEXTLINE
+TEST_F(GarbageCollectorTests, IndexConsolidation) {
+  transaction::TimestampManager timestamp_manager;
+  transaction::TransactionManager txn_manager(&timestamp_manager, DISABLED, &buffer_pool_, true, DISABLED);
+  storage::GarbageCollector gc(&timestamp_manager, DISABLED, &txn_manager, DISABLED);
+  GarbageCollectorTestIndex index(IntegerKeySchema(storage::index::IndexType::HASHMAP));
+  gc.RegisterIndexForGC(common::ManagedPointer<storage::index::Index>(&index));
+  auto *const key_buffer =
+      common::AllocationUtil::AllocateAligned(index.GetProjectedRowInitializer().ProjectedRowSize());
+
+  auto *txn = txn_manager.BeginTransaction();
+  for (int32_t i = 0; i < static_cast<int32_t>(storage::INDEX_GC_DEAD_ENTRIES_THRESHOLD); i++) {
+    index.Insert(txn, *IntegerKey(index, key_buffer, i), storage::TupleSlot(nullptr, 0));
+  }
+  txn_manager.Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+  gc.PerformGarbageCollection();
+  EXPECT_EQ(0, index.num_consolidations_);
+
+  // One dead entry short of the threshold
+  txn = txn_manager.BeginTransaction();
+  for (int32_t i = 1; i < static_cast<int32_t>(storage::INDEX_GC_DEAD_ENTRIES_THRESHOLD); i++) {
+    index.Delete(txn, *IntegerKey(index, key_buffer, i), storage::TupleSlot(nullptr, 0));
+  }
+  txn_manager.Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+  gc.PerformGarbageCollection();
+  EXPECT_EQ(0, index.num_consolidations_);
+
+  // The last dead entry reaches the threshold
+  txn = txn_manager.BeginTransaction();
+  index.Delete(txn, *IntegerKey(index, key_buffer, 0), storage::TupleSlot(nullptr, 0));
+  txn_manager.Commit(txn, transaction::TransactionUtil::EmptyCallback, nullptr);
+  gc.PerformGarbageCollection();
+  EXPECT_EQ(1, index.num_consolidations_);
+
+  // Without dead entries, the index is consolidated on every INDEX_GC_MAX_DEFERRED_RUNS-th run
+  for (uint32_t i = 1; i < storage::INDEX_GC_MAX_DEFERRED_RUNS; i++) {
+    gc.PerformGarbageCollection();
+  }
+  EXPECT_EQ(1, index.num_consolidations_);
+  gc.PerformGarbageCollection();
+  EXPECT_EQ(2, index.num_consolidations_);
+
+  gc.UnregisterIndexForGC(common::ManagedPointer<storage::index::Index>(&index));
+  delete[] key_buffer;
+}
+
+// Delete tuples from a table and its BwTree index, and confirm that the GC removes the index entries once no txn can
+// see the tuples anymore
+// NOLINTNEXTLINE
+TEST_F(GarbageCollectorTests, BwTreeIndexDelete) {
+  transaction::TimestampManager timestamp_manager;
+  transaction::TransactionManager txn_manager(&timestamp_manager, DISABLED, &buffer_pool_, true, DISABLED);
+  storage::GarbageCollector gc(&timestamp_manager, DISABLED, &txn_manager, DISABLED);
+
+  auto col = catalog::Schema::Column(
+      "attribute", type::TypeId::INTEGER, false,
+      parser::ConstantValueExpression(type::TransientValueFactory::GetNull(type::TypeId::INTEGER)));
+  StorageTestUtil::ForceOid(&(col), catalog::col_oid_t(1));
+  storage::SqlTable sql_table(&block_store_, catalog::Schema({col}));
+  const auto tuple_initializer = sql_table.InitializerForProjectedRow({catalog::col_oid_t(1)});
+  auto *const index =
+      (storage::index::IndexBuilder().SetKeySchema(IntegerKeySchema(storage::index::IndexType::BWTREE))).Build();
+  auto *const key_buffer =
+      common::AllocationUtil::AllocateAligned(index->GetProjectedRowInitializer().ProjectedRowSize());
+  const int32_t num_keys = 100;
+
+  std::vector<storage::TupleSlot> slots;
+  auto *txn0 = txn_manager.BeginTransaction();
+  for (int32_t i = 0; i < num_keys; i++) {
+    auto *redo = txn0->StageWrite(CatalogTestUtil::TEST_DB_OID, CatalogTestUtil::TEST_TABLE_OID, tuple_initializer);
+    *reinterpret_cast<int32_t *>(redo->Delta()->AccessForceNotNull(0)) = i;
+    slots.push_back(sql_table.Insert(txn0, redo));
+    EXPECT_TRUE(index->Insert(txn0, *IntegerKey(*index, key_buffer, i), slots.back()));
+  }
+  txn_manager.Commit(txn0, transaction::TransactionUtil::EmptyCallback, nullptr);
+
+  // Delete the keys in descending order, the batch removes them in key order
+  auto *txn1 = txn_manager.BeginTransaction();
+  for (int32_t i = num_keys - 1; i >= 0; i--) {
+    txn1->StageDelete(CatalogTestUtil::TEST_DB_OID, CatalogTestUtil::TEST_TABLE_OID, slots[i]);
+    EXPECT_TRUE(sql_table.Delete(txn1, slots[i]));
+    index->Delete(txn1, *IntegerKey(*index, key_buffer, i), slots[i]);
+  }
+  txn_manager.Commit(txn1, transaction::TransactionUtil::EmptyCallback, nullptr);
+
+  // Every removal of the batch is checked by the index
+  EXPECT_EQ(std::make_pair(0U, 2U), gc.PerformGarbageCollection());
+  EXPECT_EQ(std::make_pair(2U, 0U), gc.PerformGarbageCollection());
+
+  auto *txn2 = txn_manager.BeginTransaction();
+  std::vector<storage::TupleSlot> results;
+  for (int32_t i = 0; i < num_keys; i++) {
+    index->ScanKey(*txn2, *IntegerKey(*index, key_buffer, i), &results);
+    EXPECT_TRUE(results.empty());
+  }
+  txn_manager.Commit(txn2, transaction::TransactionUtil::EmptyCallback, nullptr);
+  gc.PerformGarbageCollection();
+
+  delete[] key_buffer;
+  delete index;
+}
 }  // namespace terrier
@@ -247,6 +247,19 @@ TEST_F(HashIndexTests, DefaultInsert) {
   txn_manager_->Commit(scan_txn, transaction::TransactionUtil::EmptyCallback, nullptr);
 }
 
+// Verifies that a hash index reports that it cannot split key ranges for parallel scans
+// NOLINTNEXTLINE
+TEST_F(HashIndexTests, PartitionRangeUnsupported) {
+  auto *const low_key_pr = default_index_->GetProjectedRowInitializer().InitializeRow(key_buffer_1_);
+  auto *const high_key_pr = default_index_->GetProjectedRowInitializer().InitializeRow(key_buffer_2_);
+  *reinterpret_cast<int32_t *>(low_key_pr->AccessForceNotNull(0)) = 0;
+  *reinterpret_cast<int32_t *>(high_key_pr->AccessForceNotNull(0)) = 100;
+
+  IndexRangePartitions partitions;
+  EXPECT_FALSE(default_index_->PartitionRange(*low_key_pr, *high_key_pr, 4, &partitions));
+  EXPECT_TRUE(partitions.empty());
+}
+
 // Verifies that primary key insert fails on write-write conflict
 // NOLINTNEXTLINE
 TEST_F(HashIndexTests, UniqueKey1) {
@@ -4,6 +4,7 @@
 #include <limits>
 #include <map>
 #include <random>
+#include <string>
 #include <vector>
 #include "catalog/index_schema.h"
 #include "portable_endian/portable_endian.h"
@@ -12,6 +13,8 @@
 #include "storage/index/generic_key.h"
 #include "storage/index/hash_key.h"
 #include "storage/index/index_builder.h"
+#include "storage/index/string_key.h"
+#include "storage/projected_columns.h"
 #include "storage/projected_row.h"
 #include "storage/sql_table.h"
 #include "test_util/catalog_test_util.h"
@@ -1220,6 +1223,112 @@ TEST_F(IndexKeyTests, GenericKeyNonInlineVarlenComparisons) {
   delete[] pr_buffer;
 }
 
+// Verify that building CompactIntsKeys from ProjectedColumns matches building them one ProjectedRow at a time
+// NOLINTNEXTLINE
+TEST_F(IndexKeyTests, CompactIntsKeyFromProjectedColumnsTest) {
+  const uint32_t num_iterations = 100;
+  const uint32_t num_tuples = 100;
+
+  for (uint32_t i = 0; i < num_iterations; i++) {
+    const auto key_schema = StorageTestUtil::RandomSimpleKeySchema(&generator_, COMPACTINTSKEY_MAX_SIZE);
+    const IndexMetadata metadata(key_schema);
+    const auto &key_cols = key_schema.GetColumns();
+    const auto &oid_offset_map = metadata.GetKeyOidToOffsetMap();
+
+    // a table with one column per key attribute, which the BlockLayout will reorder by size
+    std::vector<uint8_t> attr_sizes{8};
+    for (const auto &key : key_cols) attr_sizes.emplace_back(type::TypeUtil::GetTypeSize(key.Type()));
+    const BlockLayout layout(attr_sizes);
+    std::vector<col_id_t> col_ids;
+    for (uint16_t j = 1; j < layout.NumColumns(); j++) col_ids.emplace_back(j);
+    ProjectedColumnsInitializer pc_initializer(layout, col_ids, num_tuples);
+    auto *const pc_buffer = common::AllocationUtil::AllocateAligned(pc_initializer.ProjectedColumnsSize());
+    auto *const pc = pc_initializer.Initialize(pc_buffer);
+    pc->SetNumTuples(num_tuples);
+
+    // find a column of the right size for every key attribute
+    std::vector<uint16_t> column_offsets;
+    std::vector<bool> taken(col_ids.size(), false);
+    for (const auto &key : key_cols) {
+      for (uint16_t j = 0; j < col_ids.size(); j++) {
+        if (!taken[j] && pc->AttrSizeForColumn(j) == type::TypeUtil::GetTypeSize(key.Type())) {
+          taken[j] = true;
+          column_offsets.emplace_back(j);
+          break;
+        }
+      }
+    }
+    ASSERT_EQ(column_offsets.size(), key_cols.size());
+
+    const auto &initializer = metadata.GetProjectedRowInitializer();
+    auto *const pr_buffer = common::AllocationUtil::AllocateAligned(initializer.ProjectedRowSize());
+    auto *const pr = initializer.InitializeRow(pr_buffer);
+
+    std::vector<CompactIntsKey<COMPACTINTSKEY_MAX_SIZE>> expected(num_tuples), keys(num_tuples);
+    for (uint32_t row = 0; row < num_tuples; row++) {
+      // copy the random key into the ProjectedColumns too
+      FillProjectedRowWithRandomCompactInts(metadata, pr, &generator_);
+      auto row_view = pc->InterpretAsRow(row);
+      for (uint16_t j = 0; j < key_cols.size(); j++) {
+        std::memcpy(row_view.AccessForceNotNull(column_offsets[j]),
+                    pr->AccessWithNullCheck(oid_offset_map.at(key_cols[j].Oid())),
+                    type::TypeUtil::GetTypeSize(key_cols[j].Type()));
+      }
+      expected[row].SetFromProjectedRow(*pr, metadata);
+    }
+
+    CompactIntsKey<COMPACTINTSKEY_MAX_SIZE>::SetFromProjectedColumns(keys.data(), pc, column_offsets, metadata);
+    for (uint32_t row = 0; row < num_tuples; row++) {
+      EXPECT_TRUE(std::equal_to<CompactIntsKey<COMPACTINTSKEY_MAX_SIZE>>()(expected[row], keys[row]));
+    }
+
+    delete[] pr_buffer;
+    delete[] pc_buffer;
+  }
+}
+
+// Verify that building a CompactIntsKey from a ProjectedRow with a different layout than the index's is caught, as the
+// precomputed offsets only hold for the index's own layout
+// NOLINTNEXTLINE
+TEST_F(IndexKeyTests, CompactIntsKeyFromOtherLayoutTest) {
+  const auto key_schema = StorageTestUtil::RandomSimpleKeySchema(&generator_, COMPACTINTSKEY_MAX_SIZE);
+  const IndexMetadata metadata(key_schema);
+  const auto &key_cols = key_schema.GetColumns();
+  const auto &oid_offset_map = metadata.GetKeyOidToOffsetMap();
+
+  const auto &initializer = metadata.GetProjectedRowInitializer();
+  auto *const pr_buffer = common::AllocationUtil::AllocateAligned(initializer.ProjectedRowSize());
+  auto *const pr = initializer.InitializeRow(pr_buffer);
+  FillProjectedRowWithRandomCompactInts(metadata, pr, &generator_);
+  EXPECT_TRUE(metadata.HasCompactIntsLayout(*pr));
+
+  // the same key columns plus a trailing one the index does not know about, so the values land at other offsets
+  std::vector<uint8_t> attr_sizes;
+  std::vector<uint16_t> pr_offsets;
+  for (const auto &key : key_cols) {
+    attr_sizes.emplace_back(type::TypeUtil::GetTypeSize(key.Type()));
+    pr_offsets.emplace_back(oid_offset_map.at(key.Oid()));
+  }
+  attr_sizes.emplace_back(sizeof(int8_t));
+  pr_offsets.emplace_back(static_cast<uint16_t>(key_cols.size()));
+  const auto other_initializer = ProjectedRowInitializer::Create(attr_sizes, pr_offsets);
+  auto *const other_buffer = common::AllocationUtil::AllocateAligned(other_initializer.ProjectedRowSize());
+  auto *const other = other_initializer.InitializeRow(other_buffer);
+  for (uint16_t j = 0; j < attr_sizes.size(); j++) {
+    std::memset(other->AccessForceNotNull(pr_offsets[j]), 0, attr_sizes[j]);
+  }
+  EXPECT_FALSE(metadata.HasCompactIntsLayout(*other));
+
+  // NOTE: We only do this for debug builds
+#ifndef NDEBUG
+  CompactIntsKey<COMPACTINTSKEY_MAX_SIZE> key;
+  EXPECT_DEATH(key.SetFromProjectedRow(*other, metadata), "ProjectedRowInitializer");
+#endif
+
+  delete[] other_buffer;
+  delete[] pr_buffer;
+}
+
 // NOLINTNEXTLINE
 TEST_F(IndexKeyTests, CompactIntsKeyBuilderTest) {
   const uint32_t num_iters = 100;
@@ -1249,10 +1358,17 @@ TEST_F(IndexKeyTests, GenericKeyBuilderTest) {
   for (uint32_t i = 0; i < num_iters; i++) {
     const auto key_schema = StorageTestUtil::RandomGenericKeySchema(10, generic_key_types, &generator_);
 
+    // keys with a VARLEN attribute are small enough for StringKey, everything else should be a GenericKey
+    const auto &key_cols = key_schema.GetColumns();
+    const bool has_varlen = std::any_of(key_cols.cbegin(), key_cols.cend(), [](const auto &col) -> bool {
+      return col.Type() == type::TypeId::VARCHAR || col.Type() == type::TypeId::VARBINARY;
+    });
+
     IndexBuilder builder;
     builder.SetKeySchema(key_schema);
     auto *index = builder.Build();
-    EXPECT_EQ(index->KeyKind(), storage::index::IndexKeyKind::GENERICKEY);
+    EXPECT_EQ(index->KeyKind(),
+              has_varlen ? storage::index::IndexKeyKind::STRINGKEY : storage::index::IndexKeyKind::GENERICKEY);
     BasicOps(index);
 
     delete index;
@@ -1278,6 +1394,166 @@ TEST_F(IndexKeyTests, HashKeyBuilderTest) {
   }
 }
 
+// NOLINTNEXTLINE
+TEST_F(IndexKeyTests, StringKeyBuilderTest) {
+  const uint32_t num_iters = 100;
+
+  const std::vector<type::TypeId> string_key_types{type::TypeId::INTEGER, type::TypeId::VARCHAR,
+                                                   type::TypeId::VARBINARY};
+
+  for (uint32_t i = 0; i < num_iters; i++) {
+    auto key_schema = StorageTestUtil::RandomGenericKeySchema(4, string_key_types, &generator_);
+    const auto &key_cols = key_schema.GetColumns();
+    if (std::none_of(key_cols.cbegin(), key_cols.cend(),
+                     [](const auto &col) -> bool { return col.Type() != type::TypeId::INTEGER; })) {
+      continue;
+    }
+
+    for (const auto index_type : {storage::index::IndexType::BWTREE, storage::index::IndexType::HASHMAP}) {
+      key_schema.SetType(index_type);
+
+      IndexBuilder builder;
+      builder.SetKeySchema(key_schema);
+      auto *index = builder.Build();
+      EXPECT_EQ(index->KeyKind(), storage::index::IndexKeyKind::STRINGKEY);
+      BasicOps(index);
+
+      delete index;
+    }
+  }
+}
+
+/**
+ * StringKey must order and compare keys exactly like GenericKey does, only faster. DECIMAL is left out because random
+ * bit patterns produce NaNs, which GenericKey can't order.
+ */
+// NOLINTNEXTLINE
+TEST_F(IndexKeyTests, StringKeyMatchesGenericKeyTest) {
+  const uint32_t num_iters = 1000;
+
+  const std::vector<type::TypeId> key_types{type::TypeId::BOOLEAN,   type::TypeId::TINYINT, type::TypeId::SMALLINT,
+                                            type::TypeId::INTEGER,   type::TypeId::BIGINT,  type::TypeId::TIMESTAMP,
+                                            type::TypeId::DATE,      type::TypeId::VARCHAR, type::TypeId::VARBINARY};
+  std::bernoulli_distribution null_coin(0.2);
+
+  for (uint32_t i = 0; i < num_iters; i++) {
+    const IndexMetadata metadata(StorageTestUtil::RandomGenericKeySchema(4, key_types, &generator_));
+    const auto &key_cols = metadata.GetSchema().GetColumns();
+    const auto &initializer = metadata.GetProjectedRowInitializer();
+
+    auto *const pr_buffer_a = common::AllocationUtil::AllocateAligned(initializer.ProjectedRowSize());
+    auto *const pr_buffer_b = common::AllocationUtil::AllocateAligned(initializer.ProjectedRowSize());
+    auto *const pr_a = initializer.InitializeRow(pr_buffer_a);
+    auto *const pr_b = initializer.InitializeRow(pr_buffer_b);
+    delete[] FillProjectedRow(metadata, pr_a, &generator_);
+    delete[] FillProjectedRow(metadata, pr_b, &generator_);
+
+    // sprinkle in some NULLs, and make the keys share a prefix of attributes so that later columns are compared too
+    for (uint16_t j = 0; j < key_cols.size(); j++) {
+      const auto offset = static_cast<uint16_t>(pr_a->ColumnIds()[j]);
+      if (key_cols[j].Nullable() && null_coin(generator_)) pr_a->SetNull(offset);
+      if (key_cols[j].Nullable() && null_coin(generator_)) pr_b->SetNull(offset);
+    }
+    const auto shared_prefix = std::uniform_int_distribution<uint16_t>(
+        0, static_cast<uint16_t>(key_cols.size()))(generator_);
+    for (uint16_t j = 0; j < shared_prefix; j++) {
+      const auto offset = static_cast<uint16_t>(pr_a->ColumnIds()[j]);
+      const byte *const attr = pr_a->AccessWithNullCheck(offset);
+      if (attr == nullptr) {
+        pr_b->SetNull(offset);
+      } else {
+        std::memcpy(pr_b->AccessForceNotNull(offset), attr, type::TypeUtil::GetTypeSize(key_cols[j].Type()) & INT8_MAX);
+      }
+    }
+
+    GenericKey<256> generic_a, generic_b;
+    StringKey<256> string_a, string_b, string_a_copy;
+    generic_a.SetFromProjectedRow(*pr_a, metadata);
+    generic_b.SetFromProjectedRow(*pr_b, metadata);
+    string_a.SetFromProjectedRow(*pr_a, metadata);
+    string_b.SetFromProjectedRow(*pr_b, metadata);
+    string_a_copy.SetFromProjectedRow(*pr_a, metadata);
+
+    EXPECT_LE(string_a.Size(), metadata.StringKeySize());
+    EXPECT_LE(string_b.Size(), metadata.StringKeySize());
+
+    EXPECT_EQ(std::equal_to<StringKey<256>>()(string_a, string_b),
+              std::equal_to<GenericKey<256>>()(generic_a, generic_b));
+    EXPECT_EQ(std::less<StringKey<256>>()(string_a, string_b), std::less<GenericKey<256>>()(generic_a, generic_b));
+    EXPECT_EQ(std::less<StringKey<256>>()(string_b, string_a), std::less<GenericKey<256>>()(generic_b, generic_a));
+
+    EXPECT_TRUE(std::equal_to<StringKey<256>>()(string_a, string_a_copy));
+    EXPECT_FALSE(std::less<StringKey<256>>()(string_a, string_a_copy));
+    EXPECT_EQ(std::hash<StringKey<256>>()(string_a), std::hash<StringKey<256>>()(string_a_copy));
+
+    delete[] pr_buffer_a;
+    delete[] pr_buffer_b;
+  }
+}
+
+/**
+ * Exercises the escaped encoding of a VARLEN that is not the last key attribute, including embedded zero bytes and
+ * strings that are prefixes of each other.
+ */
+// NOLINTNEXTLINE
+TEST_F(IndexKeyTests, StringKeyEscapedVarlenComparisons) {
+  std::vector<catalog::IndexSchema::Column> key_cols;
+  key_cols.emplace_back("", type::TypeId::VARCHAR, 20, true,
+                        parser::ConstantValueExpression(type::TransientValueFactory::GetNull(type::TypeId::VARCHAR)));
+  StorageTestUtil::ForceOid(&(key_cols.back()), catalog::indexkeycol_oid_t(0));
+  key_cols.emplace_back("", type::TypeId::INTEGER, false,
+                        parser::ConstantValueExpression(type::TransientValueFactory::GetNull(type::TypeId::INTEGER)));
+  StorageTestUtil::ForceOid(&(key_cols.back()), catalog::indexkeycol_oid_t(1));
+
+  const IndexMetadata metadata(
+      catalog::IndexSchema(key_cols, storage::index::IndexType::BWTREE, false, false, false, true));
+  EXPECT_EQ(metadata.StringKeySize(), (1 + 2 * 20 + 2) + 4);
+  const auto &initializer = metadata.GetProjectedRowInitializer();
+  const auto &oid_offset_map = metadata.GetKeyOidToOffsetMap();
+  const auto varlen_offset = oid_offset_map.at(catalog::indexkeycol_oid_t(0));
+  const auto int_offset = oid_offset_map.at(catalog::indexkeycol_oid_t(1));
+
+  auto *const pr_buffer = common::AllocationUtil::AllocateAligned(initializer.ProjectedRowSize());
+  auto *const pr = initializer.InitializeRow(pr_buffer);
+
+  // NULL sorts first, then the strings in byte order, ties broken by the INTEGER attribute
+  std::vector<std::string> strings{std::string(""),          std::string("\0", 1),   std::string("\0\0", 2),
+                                         std::string("\0\x01", 2), std::string("ab"),        std::string("ab\0", 3),
+                                         std::string("ab\0c", 4),  std::string("ab\x01", 3), std::string("abc"),
+                                         std::string("johnny_johnny_johnn")};
+  std::vector<StringKey<64>> keys;
+  for (int32_t value : {-1, 1}) {
+    pr->SetNull(varlen_offset);
+    *reinterpret_cast<int32_t *>(pr->AccessForceNotNull(int_offset)) = value;
+    keys.emplace_back();
+    keys.back().SetFromProjectedRow(*pr, metadata);
+  }
+  for (auto &string : strings) {
+    for (int32_t value : {-1, 1}) {
+      *reinterpret_cast<VarlenEntry *>(pr->AccessForceNotNull(varlen_offset)) =
+          string.size() <= VarlenEntry::InlineThreshold()
+              ? VarlenEntry::CreateInline(reinterpret_cast<const byte *>(string.data()),
+                                          static_cast<uint32_t>(string.size()))
+              : VarlenEntry::Create(reinterpret_cast<byte *>(string.data()), static_cast<uint32_t>(string.size()),
+                                    false);
+      *reinterpret_cast<int32_t *>(pr->AccessForceNotNull(int_offset)) = value;
+      keys.emplace_back();
+      keys.back().SetFromProjectedRow(*pr, metadata);
+    }
+  }
+
+  const auto string_eq = std::equal_to<StringKey<64>>();  // NOLINT transparent functors can't deduce template
+  const auto string_lt = std::less<StringKey<64>>();      // NOLINT transparent functors can't deduce template
+  for (uint32_t i = 0; i < keys.size(); i++) {
+    for (uint32_t j = 0; j < keys.size(); j++) {
+      EXPECT_EQ(string_eq(keys[i], keys[j]), i == j);
+      EXPECT_EQ(string_lt(keys[i], keys[j]), i < j);
+    }
+  }
+
+  delete[] pr_buffer;
+}
+
 /**
  * This test exercises an edge case detected while incorporating the catalog that had a VARCHAR(63) attribute. The
  * IndexBuilder was looking at the user-facing PR size rather than the inlined PR size, so the computation of the key
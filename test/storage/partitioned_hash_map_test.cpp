@@ -0,0 +1,237 @@
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include <vector>
+#include "storage/index/partitioned_hash_map.h"
+#include "test_util/multithread_test_util.h"
+#include "test_util/test_harness.h"
+
+namespace terrier::storage::index {
+
+class PartitionedHashMapTests : public TerrierTest {
+ public:
+  using HashMap = PartitionedHashMap<int64_t, int64_t>;
+
+  /**
+   * Retired memory can be freed whenever the test knows that no reader is running
+   */
+  static void FreeRetired(HashMap::RetiredList *const retired) {
+    for (byte *const ptr : *retired) delete[] ptr;
+    retired->clear();
+  }
+
+  static std::vector<int64_t> Find(const HashMap &map, const int64_t key) {
+    std::vector<int64_t> values;
+    map.Find(key, &values);
+    std::sort(values.begin(), values.end());
+    return values;
+  }
+
+  const uint32_t num_threads_ =
+      MultiThreadTestUtil::HardwareConcurrency() + (MultiThreadTestUtil::HardwareConcurrency() % 2);
+};
+
+// Inserts enough keys to force every partition through several resizes, then erases them all
+// NOLINTNEXTLINE
+TEST_F(PartitionedHashMapTests, InsertFindErase) {
+  const int64_t num_keys = 100000;
+  HashMap map(16);
+  HashMap::RetiredList retired;
+
+  for (int64_t i = 0; i < num_keys; i++) {
+    EXPECT_TRUE(map.Insert(i, i, &retired));
+    // the same value for the same key is rejected
+    EXPECT_FALSE(map.Insert(i, i, &retired));
+  }
+  EXPECT_EQ(map.Size(), num_keys);
+  EXPECT_FALSE(retired.empty());
+
+  for (int64_t i = 0; i < num_keys; i++) {
+    EXPECT_EQ(Find(map, i), std::vector<int64_t>{i});
+  }
+  EXPECT_TRUE(Find(map, num_keys).empty());
+
+  for (int64_t i = 0; i < num_keys; i += 2) {
+    EXPECT_TRUE(map.Erase(i, i));
+    EXPECT_FALSE(map.Erase(i, i));
+  }
+  EXPECT_EQ(map.Size(), num_keys / 2);
+
+  for (int64_t i = 0; i < num_keys; i++) {
+    EXPECT_EQ(Find(map, i).size(), static_cast<size_t>(i % 2));
+  }
+
+  // reinserting revives the tombstones, and the inserts keep migrating partitions that are in the middle of resizing
+  for (int64_t i = 0; i < num_keys; i += 2) {
+    EXPECT_TRUE(map.Insert(i, -i, &retired));
+  }
+  EXPECT_EQ(map.Size(), num_keys);
+  for (int64_t i = 0; i < num_keys; i++) {
+    EXPECT_EQ(Find(map, i), std::vector<int64_t>{i % 2 == 0 ? -i : i});
+  }
+
+  FreeRetired(&retired);
+}
+
+// Keeps inserting and erasing new keys, and erasing erased keys again, so that the tables fill up with tombstones that
+// are purged by resizes which don't grow the table. Every insert and every slot moved by a migration must still find
+// an EMPTY slot.
+// NOLINTNEXTLINE
+TEST_F(PartitionedHashMapTests, TombstoneChurn) {
+  const int64_t num_rounds = 200;
+  const int64_t keys_per_round = 100;
+  HashMap map(16);
+  HashMap::RetiredList retired;
+
+  for (int64_t round = 0; round < num_rounds; round++) {
+    const int64_t first = round * keys_per_round;
+    for (int64_t i = first; i < first + keys_per_round; i++) {
+      EXPECT_TRUE(map.Insert(i, i, &retired));
+    }
+    for (int64_t i = first; i < first + keys_per_round; i++) {
+      EXPECT_TRUE(map.Erase(i, i));
+      // erasing the previous round's keys again moves their tombstones out of tables that are being migrated
+      if (round > 0) EXPECT_FALSE(map.Erase(i - keys_per_round, i - keys_per_round));
+    }
+    EXPECT_EQ(map.Size(), 0);
+  }
+  for (int64_t i = 0; i < num_rounds * keys_per_round; i++) {
+    EXPECT_TRUE(Find(map, i).empty());
+  }
+
+  FreeRetired(&retired);
+}
+
+// Grows a key's values past the inline small-vector and back down again
+// NOLINTNEXTLINE
+TEST_F(PartitionedHashMapTests, DuplicateValues) {
+  const int64_t num_values = 1000;
+  HashMap map(16);
+  HashMap::RetiredList retired;
+
+  std::vector<int64_t> expected;
+  for (int64_t i = 0; i < num_values; i++) {
+    EXPECT_TRUE(map.Insert(15721, i, &retired));
+    expected.emplace_back(i);
+    if (i < 10 || i % 100 == 0) EXPECT_EQ(Find(map, 15721), expected);
+  }
+  EXPECT_EQ(map.Size(), 1);
+
+  for (int64_t i = 0; i < num_values - 1; i++) {
+    EXPECT_TRUE(map.Erase(15721, i));
+  }
+  EXPECT_EQ(Find(map, 15721), std::vector<int64_t>{num_values - 1});
+  EXPECT_EQ(map.Size(), 1);
+
+  EXPECT_TRUE(map.Erase(15721, num_values - 1));
+  EXPECT_TRUE(Find(map, 15721).empty());
+  EXPECT_EQ(map.Size(), 0);
+
+  FreeRetired(&retired);
+}
+
+// InsertIf rejects the insert as soon as any existing value conflicts
+// NOLINTNEXTLINE
+TEST_F(PartitionedHashMapTests, InsertIf) {
+  HashMap map(16);
+  HashMap::RetiredList retired;
+
+  const auto conflicts_with_odd = [](const int64_t value) -> bool { return value % 2 == 1; };
+  EXPECT_TRUE(map.InsertIf(1, 2, conflicts_with_odd, &retired));
+  EXPECT_TRUE(map.InsertIf(1, 3, conflicts_with_odd, &retired));
+  EXPECT_FALSE(map.InsertIf(1, 4, conflicts_with_odd, &retired));
+  EXPECT_EQ(Find(map, 1), (std::vector<int64_t>{2, 3}));
+
+  EXPECT_TRUE(map.Erase(1, 3));
+  EXPECT_TRUE(map.InsertIf(1, 4, conflicts_with_odd, &retired));
+  EXPECT_EQ(Find(map, 1), (std::vector<int64_t>{2, 4}));
+
+  FreeRetired(&retired);
+}
+
+// Half of the threads insert disjoint key ranges while the other half keep reading keys that were already inserted,
+// which must stay visible while their partitions resize underneath the readers
+// NOLINTNEXTLINE
+TEST_F(PartitionedHashMapTests, ConcurrentInsertAndFind) {
+  const int64_t keys_per_thread = 100000;
+  const uint32_t num_writers = std::max(num_threads_ / 2, 1U);
+  HashMap map(16);
+  std::vector<HashMap::RetiredList> retired(num_writers);
+  std::vector<std::atomic<int64_t>> progress(num_writers);
+  for (auto &p : progress) p.store(0);
+  std::atomic<uint32_t> writers_done = 0;
+
+  common::WorkerPool thread_pool(num_threads_, {});
+  auto workload = [&](uint32_t id) {
+    if (id < num_writers) {
+      for (int64_t i = 0; i < keys_per_thread; i++) {
+        const int64_t key = i * num_writers + id;
+        EXPECT_TRUE(map.Insert(key, key, &retired[id]));
+        progress[id].store(i + 1, std::memory_order_release);
+      }
+      writers_done.fetch_add(1);
+      return;
+    }
+
+    std::default_random_engine generator(id);
+    std::vector<int64_t> values;
+    while (writers_done.load() < num_writers) {
+      const auto writer = std::uniform_int_distribution<uint32_t>(0, num_writers - 1)(generator);
+      const int64_t inserted = progress[writer].load(std::memory_order_acquire);
+      if (inserted == 0) continue;
+      const int64_t key = std::uniform_int_distribution<int64_t>(0, inserted - 1)(generator) * num_writers + writer;
+      values.clear();
+      EXPECT_TRUE(map.Find(key, &values));
+      EXPECT_EQ(values, std::vector<int64_t>{key});
+    }
+  };
+  MultiThreadTestUtil::RunThreadsUntilFinish(&thread_pool, num_threads_, workload);
+
+  EXPECT_EQ(map.Size(), keys_per_thread * num_writers);
+  for (int64_t key = 0; key < static_cast<int64_t>(keys_per_thread * num_writers); key++) {
+    EXPECT_EQ(Find(map, key), std::vector<int64_t>{key});
+  }
+  for (auto &list : retired) FreeRetired(&list);
+}
+
+// Concurrent inserts and erases on a small set of keys with many values each
+// NOLINTNEXTLINE
+TEST_F(PartitionedHashMapTests, ConcurrentDuplicates) {
+  const int64_t num_keys = 64;
+  const int64_t values_per_thread = 10000;
+  HashMap map(16);
+  std::vector<HashMap::RetiredList> retired(num_threads_);
+
+  common::WorkerPool thread_pool(num_threads_, {});
+  auto workload = [&](uint32_t id) {
+    // every thread inserts its own values, then erases every other one
+    for (int64_t i = 0; i < values_per_thread; i++) {
+      const int64_t value = i * num_threads_ + id;
+      EXPECT_TRUE(map.Insert(value % num_keys, value, &retired[id]));
+    }
+    for (int64_t i = 0; i < values_per_thread; i += 2) {
+      const int64_t value = i * num_threads_ + id;
+      EXPECT_TRUE(map.Erase(value % num_keys, value));
+    }
+  };
+  MultiThreadTestUtil::RunThreadsUntilFinish(&thread_pool, num_threads_, workload);
+
+  std::vector<int64_t> all_values;
+  for (int64_t key = 0; key < num_keys; key++) {
+    const auto values = Find(map, key);
+    for (const auto value : values) EXPECT_EQ(value % num_keys, key);
+    all_values.insert(all_values.end(), values.begin(), values.end());
+  }
+  std::sort(all_values.begin(), all_values.end());
+
+  std::vector<int64_t> expected;
+  for (uint32_t id = 0; id < num_threads_; id++) {
+    for (int64_t i = 1; i < values_per_thread; i += 2) expected.emplace_back(i * num_threads_ + id);
+  }
+  std::sort(expected.begin(), expected.end());
+  EXPECT_EQ(all_values, expected);
+
+  for (auto &list : retired) FreeRetired(&list);
+}
+
+}  // namespace terrier::storage::index
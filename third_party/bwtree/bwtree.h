@@ -6769,6 +6769,91 @@ class BwTree : public BwTreeBase {
     return value_set;
   }
 
+  /*
+   * GetRangeSeparators() - Split a key range into sub-ranges of roughly equal
+   *                        size using separators from the inner nodes
+   *
+   * This function walks down the inner levels of the tree one level at a
+   * time, collecting the separators of every node whose key range overlaps
+   * [low_key, high_key], until a level has enough separators to produce
+   * num_partitions sub-ranges or the next level is the leaf level. Evenly
+   * spaced separators from the deepest level visited are then copied into
+   * the output in ascending order. Nodes at the same level span roughly the
+   * same number of keys, so the sub-ranges are roughly equal in size.
+   *
+   * Only the base node at the end of each delta chain is read. Delta records
+   * may have added or removed separators since, but any key is a valid
+   * boundary, so this only affects how balanced the sub-ranges are. The
+   * output contains at most (num_partitions - 1) keys strictly between
+   * low_key and high_key, and may be empty if the tree is a single leaf.
+   */
+  void GetRangeSeparators(const KeyType &low_key, const KeyType &high_key, const uint32_t num_partitions,
+                          std::vector<KeyType> *separators) {
+    INDEX_LOG_TRACE("GetRangeSeparators()");
+    separators->clear();
+    if (num_partitions <= 1 || !KeyCmpLess(low_key, high_key)) return;
+
+    EpochNode *epoch_node_p = epoch_manager.JoinEpoch();
+
+    std::vector<NodeID> level{root_id.load()};
+    std::vector<NodeID> next_level;
+    std::vector<KeyType> level_separators;
+
+    while (!level.empty()) {
+      level_separators.clear();
+      next_level.clear();
+
+      bool leaf_level = false;
+      for (const NodeID node_id : level) {
+        const BaseNode *node_p = GetNode(node_id);
+        if (node_p->IsOnLeafDeltaChain()) {
+          leaf_level = true;
+          break;
+        }
+
+        // Skip to the base node of the delta chain
+        while (node_p->IsDeltaNode()) node_p = static_cast<const DeltaNode *>(node_p)->child_node_p;
+        const auto *inner_node_p = static_cast<const InnerNode *>(node_p);
+
+        // The first item only carries the low key's NodeID, its key is never a separator
+        const int size = inner_node_p->GetSize();
+        for (int i = 0; i < size; i++) {
+          const KeyNodeIDPair &item = inner_node_p->At(i);
+          if (i > 0) {
+            if (KeyCmpGreater(item.first, high_key)) break;
+            if (KeyCmpGreater(item.first, low_key)) level_separators.push_back(item.first);
+          }
+          // Child i covers [item i, item i + 1)
+          if (i == size - 1 || KeyCmpGreater(inner_node_p->At(i + 1).first, low_key)) next_level.push_back(item.second);
+        }
+      }
+
+      if (leaf_level) break;
+
+      separators->swap(level_separators);
+      if (separators->size() + 1 >= num_partitions) break;
+      level.swap(next_level);
+    }
+
+    epoch_manager.LeaveEpoch(epoch_node_p);
+
+    // A base node that has been split but not yet updated in its parent can repeat separators from its sibling
+    std::sort(separators->begin(), separators->end(),
+              [this](const KeyType &lhs, const KeyType &rhs) { return KeyCmpLess(lhs, rhs); });
+    separators->erase(std::unique(separators->begin(), separators->end(),
+                                  [this](const KeyType &lhs, const KeyType &rhs) { return KeyCmpEqual(lhs, rhs); }),
+                      separators->end());
+
+    // Keep evenly spaced separators
+    const uint64_t num_separators = separators->size();
+    if (num_separators + 1 > num_partitions) {
+      for (uint64_t i = 1; i < num_partitions; i++) {
+        (*separators)[i - 1] = (*separators)[i * (num_separators + 1) / num_partitions - 1];
+      }
+      separators->resize(num_partitions - 1);
+    }
+  }
+
   ///////////////////////////////////////////////////////////////////
   // Garbage Collection Interface
   ///////////////////////////////////////////////////////////////////